@@ -71,7 +71,7 @@ static OSStatus callback(void *userData, AudioUnitRenderActionFlags *actionFlags
     size_t n = [_ringBuffer readBuffer:buffer length:totalBytes];
     
     if (n < totalBytes) {
-        printf("underflow (%zu bytes)\n", totalBytes - n);
+        /* Counted in _ringBuffer.underruns; no logging from the real-time thread. */
         memset(buffer + n, 0, totalBytes - n);
     }
     
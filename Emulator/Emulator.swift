@@ -78,6 +78,11 @@ import UIKit
         return true
     }
     
+    // write changes kept in memory to their files
+    open func flush() {
+        send(event: .flush)
+    }
+    
     // trigger cartridge freeze function
     open func freeze() {
         send(event: .freeze)
@@ -33,6 +33,7 @@ import Foundation
 
 public enum Event {
     case attach(unit: Int, image: DiskImage?)
+    case flush
     case freeze
     case joystick(port: Int, buttons: JoystickButtons, oldButtons: JoystickButtons)
     case key(_ key: Key, pressed: Bool)
@@ -31,20 +31,19 @@
 
 #import <Foundation/Foundation.h>
 
-#include <pthread.h>
+struct ring_buffer;
 
+/* Lock free, for one writing and one reading thread; see ring_buffer.h. */
 @interface RingBuffer : NSObject {
-    pthread_mutex_t mutex;
-    uint8_t * _Nonnull _end;
-    uint8_t * _Nonnull _read_position;
-    uint8_t * _Nonnull _write_position;
+    struct ring_buffer * _Nonnull _ring;
 }
 
-@property (readonly) uint8_t * _Nonnull buffer;
 @property (readonly) size_t size;
 @property (readonly) BOOL isEmpty;
 @property (readonly) size_t bytesReadable;
 @property (readonly) size_t bytesWritable;
+@property (readonly) uint64_t underruns;
+@property (readonly) uint64_t overruns;
 
 -(instancetype _Nonnull)initSize: (size_t)size;
 
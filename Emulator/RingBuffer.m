@@ -31,120 +31,63 @@
 
 #include "RingBuffer.h"
 
+#include "ring_buffer.h"
+
 @implementation RingBuffer
 
 -(instancetype)initSize: (size_t)size {
-    pthread_mutex_init(&mutex, NULL);
-    _size = size;
-    _buffer = (uint8_t *)malloc(size);
-    _end = _buffer + size;
-    _read_position = _buffer;
-    _write_position = _buffer;
-    _isEmpty = false;
+    if ((self = [super init]) == nil) {
+        return nil;
+    }
+    if ((_ring = ring_buffer_new(size)) == NULL) {
+        return nil;
+    }
     return self;
 }
 
 
 - (void)dealloc {
-    pthread_mutex_destroy(&mutex);
-    free(_buffer);
+    ring_buffer_free(_ring);
 }
 
 
-- (size_t)bytesReadable {
-    size_t ret;
-    pthread_mutex_lock(&mutex);
+- (size_t)size {
+    return ring_buffer_size(_ring);
+}
 
-    if (_isEmpty) {
-        ret = 0;
-    }
-    else {
-        ret = (_write_position - _read_position + _size) % _size;
-    }
 
-    pthread_mutex_unlock(&mutex);
-    return ret;
+- (BOOL)isEmpty {
+    return ring_buffer_readable(_ring) == 0;
+}
+
+
+- (size_t)bytesReadable {
+    return ring_buffer_readable(_ring);
 }
 
 
 - (size_t)bytesWritable {
-    size_t ret;
-    pthread_mutex_lock(&mutex);
-    
-    if (_isEmpty) {
-        ret =  _size;
-    }
-    else {
-        ret = (_read_position - _write_position + _size) % _size;
-    }
-    
-    pthread_mutex_unlock(&mutex);
-    return ret;
+    return ring_buffer_writable(_ring);
+}
+
+
+- (uint64_t)underruns {
+    return ring_buffer_underruns(_ring);
 }
 
+
+- (uint64_t)overruns {
+    return ring_buffer_overruns(_ring);
+}
+
+
 -(size_t)readBuffer: (uint8_t *)buffer length: (size_t)length {
-    pthread_mutex_lock(&mutex);
-
-    size_t offset = 0;
-    
-    if (!_isEmpty) {
-        if (_read_position >= _write_position) {
-            size_t n = MIN(_end - _read_position, length);
-            memcpy(buffer, _read_position, n);
-            offset = n;
-            _read_position += n;
-            if (_read_position == _end) {
-                _read_position = _buffer;
-            }
-        }
-        
-        if (offset < length) {
-            size_t n = MIN(_write_position - _read_position, length - offset);
-            memcpy(buffer + offset, _read_position, n);
-            offset += n;
-            _read_position += n;
-        }
-    
-        if (_read_position == _write_position) {
-            _isEmpty = YES;
-            _read_position = _buffer;
-            _write_position = _buffer;
-        }
-    }
-    
-    pthread_mutex_unlock(&mutex);
-    return offset;
+    return ring_buffer_read(_ring, buffer, length);
 }
 
 
 -(size_t)writeBuffer: (const uint8_t *)buffer length: (size_t)length {
-    pthread_mutex_lock(&mutex);
-    
-    size_t offset = 0;
-    
-    if ((_isEmpty || _write_position != _read_position) && length > 0) {
-        if (_write_position >= _read_position) {
-            size_t n = MIN(_end - _write_position, length);
-            memcpy(_write_position, buffer, n);
-            offset = n;
-            _write_position += n;
-            if (_write_position == _end) {
-                _write_position = _buffer;
-            }
-        }
-        
-        if (offset < length) {
-            size_t n = MIN(_read_position - _write_position, length - offset);
-            memcpy(_write_position, buffer + offset, n);
-            offset += n;
-            _write_position += n;
-        }
-
-        _isEmpty = NO;
-    }
-    
-    pthread_mutex_unlock(&mutex);
-    return offset;
+    return ring_buffer_write(_ring, buffer, length);
 }
 
 @end
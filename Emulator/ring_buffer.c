@@ -0,0 +1,264 @@
+/*
+ ring_buffer.c -- Lock-Free Single Producer Single Consumer Ring Buffer
+ Copyright (C) 2020 Dieter Baron
+
+ This file is part of Ready, a home computer emulator for iPad.
+ The authors can be contacted at <ready@tpau.group>.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ 1. Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+
+ 2. The names of the authors may not be used to endorse or promote
+ products derived from this software without specific prior
+ written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+ OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ring_buffer.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE_SIZE 64
+
+/*
+ Read and write positions count bytes since creation and are never wrapped; the offset into the buffer is position & mask.  write_position - read_position is the number of bytes buffered, also when the counters overflow.
+
+ Each side keeps its own position and the statistics it updates on a separate cache line, together with its last known value of the other side's position, so it only has to load the other position when the cached one doesn't suffice.
+ */
+
+struct ring_buffer {
+    uint8_t *data;
+    size_t mask;
+    size_t size;
+
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t write_position;
+    size_t cached_read_position;
+    _Atomic uint64_t overruns;
+    _Atomic uint64_t overrun_bytes;
+
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t read_position;
+    size_t cached_write_position;
+    _Atomic uint64_t underruns;
+    _Atomic uint64_t underrun_bytes;
+};
+
+
+static void add_counter(_Atomic uint64_t *counter, uint64_t value) {
+    /* Only one thread updates each counter, so no read-modify-write is needed. */
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value, memory_order_relaxed);
+}
+
+
+static size_t get_regions(const ring_buffer_t *ring, size_t position, size_t length, ring_buffer_region_t regions[2]) {
+    size_t offset = position & ring->mask;
+    size_t first = ring->mask + 1 - offset;
+
+    if (first > length) {
+        first = length;
+    }
+
+    regions[0].data = ring->data + offset;
+    regions[0].length = first;
+    regions[1].data = ring->data;
+    regions[1].length = length - first;
+
+    return length;
+}
+
+
+ring_buffer_t *ring_buffer_new(size_t size) {
+    ring_buffer_t *ring;
+    size_t capacity = 1;
+
+    if (size == 0) {
+        return NULL;
+    }
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+
+    /* aligned_alloc() requires the size to be a multiple of the alignment. */
+    if ((ring = aligned_alloc(CACHE_LINE_SIZE, (sizeof(*ring) + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1))) == NULL) {
+        return NULL;
+    }
+    if ((ring->data = malloc(capacity)) == NULL) {
+        free(ring);
+        return NULL;
+    }
+
+    ring->mask = capacity - 1;
+    ring->size = size;
+    atomic_init(&ring->write_position, 0);
+    ring->cached_read_position = 0;
+    atomic_init(&ring->overruns, 0);
+    atomic_init(&ring->overrun_bytes, 0);
+    atomic_init(&ring->read_position, 0);
+    ring->cached_write_position = 0;
+    atomic_init(&ring->underruns, 0);
+    atomic_init(&ring->underrun_bytes, 0);
+
+    return ring;
+}
+
+
+void ring_buffer_free(ring_buffer_t *ring) {
+    if (ring == NULL) {
+        return;
+    }
+    free(ring->data);
+    free(ring);
+}
+
+
+size_t ring_buffer_size(const ring_buffer_t *ring) {
+    return ring->size;
+}
+
+
+size_t ring_buffer_readable(const ring_buffer_t *ring) {
+    size_t read_position = atomic_load_explicit(&((ring_buffer_t *)ring)->read_position, memory_order_acquire);
+    size_t write_position = atomic_load_explicit(&((ring_buffer_t *)ring)->write_position, memory_order_acquire);
+
+    return write_position - read_position;
+}
+
+
+size_t ring_buffer_writable(const ring_buffer_t *ring) {
+    return ring->size - ring_buffer_readable(ring);
+}
+
+
+size_t ring_buffer_write_acquire(ring_buffer_t *ring, ring_buffer_region_t regions[2]) {
+    size_t write_position = atomic_load_explicit(&ring->write_position, memory_order_relaxed);
+    size_t length = ring->size - (write_position - ring->cached_read_position);
+
+    if (length == 0) {
+        ring->cached_read_position = atomic_load_explicit(&ring->read_position, memory_order_acquire);
+        length = ring->size - (write_position - ring->cached_read_position);
+    }
+
+    return get_regions(ring, write_position, length, regions);
+}
+
+
+void ring_buffer_write_commit(ring_buffer_t *ring, size_t length) {
+    size_t write_position = atomic_load_explicit(&ring->write_position, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->write_position, write_position + length, memory_order_release);
+}
+
+
+size_t ring_buffer_read_acquire(ring_buffer_t *ring, ring_buffer_region_t regions[2]) {
+    size_t read_position = atomic_load_explicit(&ring->read_position, memory_order_relaxed);
+
+    ring->cached_write_position = atomic_load_explicit(&ring->write_position, memory_order_acquire);
+
+    return get_regions(ring, read_position, ring->cached_write_position - read_position, regions);
+}
+
+
+void ring_buffer_read_commit(ring_buffer_t *ring, size_t length) {
+    size_t read_position = atomic_load_explicit(&ring->read_position, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->read_position, read_position + length, memory_order_release);
+}
+
+
+size_t ring_buffer_write(ring_buffer_t *ring, const void *buffer, size_t length) {
+    ring_buffer_region_t regions[2];
+    size_t n = ring_buffer_write_acquire(ring, regions);
+
+    if (n < length) {
+        /* Only go back to the other side's position when the cached one is too old. */
+        ring->cached_read_position = atomic_load_explicit(&ring->read_position, memory_order_acquire);
+        n = ring_buffer_write_acquire(ring, regions);
+    }
+
+    if (n > length) {
+        n = length;
+    }
+    if (n <= regions[0].length) {
+        memcpy(regions[0].data, buffer, n);
+    }
+    else {
+        memcpy(regions[0].data, buffer, regions[0].length);
+        memcpy(regions[1].data, (const uint8_t *)buffer + regions[0].length, n - regions[0].length);
+    }
+
+    ring_buffer_write_commit(ring, n);
+
+    if (n < length) {
+        add_counter(&ring->overruns, 1);
+        add_counter(&ring->overrun_bytes, length - n);
+    }
+
+    return n;
+}
+
+
+size_t ring_buffer_read(ring_buffer_t *ring, void *buffer, size_t length) {
+    ring_buffer_region_t regions[2];
+    size_t n = ring_buffer_read_acquire(ring, regions);
+
+    if (n > length) {
+        n = length;
+    }
+    if (n <= regions[0].length) {
+        memcpy(buffer, regions[0].data, n);
+    }
+    else {
+        memcpy(buffer, regions[0].data, regions[0].length);
+        memcpy((uint8_t *)buffer + regions[0].length, regions[1].data, n - regions[0].length);
+    }
+
+    ring_buffer_read_commit(ring, n);
+
+    if (n < length) {
+        add_counter(&ring->underruns, 1);
+        add_counter(&ring->underrun_bytes, length - n);
+    }
+
+    return n;
+}
+
+
+void ring_buffer_clear(ring_buffer_t *ring) {
+    atomic_store_explicit(&ring->read_position, atomic_load_explicit(&ring->write_position, memory_order_acquire), memory_order_release);
+}
+
+
+uint64_t ring_buffer_underruns(const ring_buffer_t *ring) {
+    return atomic_load_explicit(&((ring_buffer_t *)ring)->underruns, memory_order_relaxed);
+}
+
+
+uint64_t ring_buffer_underrun_bytes(const ring_buffer_t *ring) {
+    return atomic_load_explicit(&((ring_buffer_t *)ring)->underrun_bytes, memory_order_relaxed);
+}
+
+
+uint64_t ring_buffer_overruns(const ring_buffer_t *ring) {
+    return atomic_load_explicit(&((ring_buffer_t *)ring)->overruns, memory_order_relaxed);
+}
+
+
+uint64_t ring_buffer_overrun_bytes(const ring_buffer_t *ring) {
+    return atomic_load_explicit(&((ring_buffer_t *)ring)->overrun_bytes, memory_order_relaxed);
+}
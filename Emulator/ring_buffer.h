@@ -0,0 +1,95 @@
+/*
+ ring_buffer.h -- Lock-Free Single Producer Single Consumer Ring Buffer
+ Copyright (C) 2020 Dieter Baron
+
+ This file is part of Ready, a home computer emulator for iPad.
+ The authors can be contacted at <ready@tpau.group>.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ 1. Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+
+ 2. The names of the authors may not be used to endorse or promote
+ products derived from this software without specific prior
+ written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+ OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HAD_RING_BUFFER_H
+#define HAD_RING_BUFFER_H
+
+/*
+ One thread writes (the emulator), one thread reads (the audio callback).
+ Neither ever blocks or waits for the other: all functions are wait-free.
+ Functions marked producer may only be called from the writing thread,
+ functions marked consumer only from the reading thread.
+
+ Storage is rounded up to a power of two, but at most `size` bytes are
+ ever buffered, so the latency is that of the requested size.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ring_buffer ring_buffer_t;
+
+typedef struct {
+    uint8_t *data;
+    size_t length;
+} ring_buffer_region_t;
+
+ring_buffer_t *ring_buffer_new(size_t size);
+void ring_buffer_free(ring_buffer_t *ring);
+
+size_t ring_buffer_size(const ring_buffer_t *ring);
+
+/* Safe to call from either thread; the answer may be outdated by the time it is used. */
+size_t ring_buffer_readable(const ring_buffer_t *ring);
+size_t ring_buffer_writable(const ring_buffer_t *ring);
+
+/* Producer: copy up to `length` bytes in, return number of bytes written.  Bytes that don't fit are dropped and counted as overrun. */
+size_t ring_buffer_write(ring_buffer_t *ring, const void *buffer, size_t length);
+
+/* Consumer: copy up to `length` bytes out, return number of bytes read.  Reading less than requested counts as underrun. */
+size_t ring_buffer_read(ring_buffer_t *ring, void *buffer, size_t length);
+
+/* Producer: get up to two regions to write into directly, return their total length.  Make the first `length` bytes visible to the consumer with ring_buffer_write_commit(). */
+size_t ring_buffer_write_acquire(ring_buffer_t *ring, ring_buffer_region_t regions[2]);
+void ring_buffer_write_commit(ring_buffer_t *ring, size_t length);
+
+/* Consumer: get up to two regions holding the readable data, return their total length.  Release the first `length` bytes with ring_buffer_read_commit(). */
+size_t ring_buffer_read_acquire(ring_buffer_t *ring, ring_buffer_region_t regions[2]);
+void ring_buffer_read_commit(ring_buffer_t *ring, size_t length);
+
+/* Consumer: drop all buffered data. */
+void ring_buffer_clear(ring_buffer_t *ring);
+
+/* Number of short reads and writes, and the bytes missing or dropped. */
+uint64_t ring_buffer_underruns(const ring_buffer_t *ring);
+uint64_t ring_buffer_underrun_bytes(const ring_buffer_t *ring);
+uint64_t ring_buffer_overruns(const ring_buffer_t *ring);
+uint64_t ring_buffer_overrun_bytes(const ring_buffer_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAD_RING_BUFFER_H */
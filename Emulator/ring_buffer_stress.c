@@ -0,0 +1,300 @@
+/*
+ ring_buffer_stress.c -- Stress Test for Lock-Free Ring Buffer
+ Copyright (C) 2020 Dieter Baron
+
+ This file is part of Ready, a home computer emulator for iPad.
+ The authors can be contacted at <ready@tpau.group>.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ 1. Redistributions of source code must retain the above copyright
+ notice, this list of conditions and the following disclaimer.
+
+ 2. The names of the authors may not be used to endorse or promote
+ products derived from this software without specific prior
+ written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS
+ OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY
+ DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ Not part of the app.  Build and run on Linux (or macOS) with
+
+   cc -std=c11 -O2 -pthread ring_buffer.c ring_buffer_stress.c -o ring_buffer_stress
+   ./ring_buffer_stress [seconds] [size]
+
+ A producer thread writes 16 byte records (sequence number and time stamp) and a consumer thread reads them back, both in random sized pieces and alternating between the copying and the zero-copy functions.  The consumer checks that every byte arrives exactly once and in order, and measures how long records spent in the buffer as well as the time taken by each read and write call.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ring_buffer.h"
+
+#define RECORD_SIZE 16
+#define LATENCY_BUCKETS 64
+
+typedef struct {
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} call_stats_t;
+
+static ring_buffer_t *ring;
+static atomic_int done;
+static atomic_int producer_done;
+static uint64_t records_written;
+static uint64_t records_read;
+static int errors;
+
+static call_stats_t write_stats, read_stats;
+
+/* Record latencies, bucket i counts latencies in [2^i, 2^(i+1)) ns. */
+static uint64_t latency_histogram[LATENCY_BUCKETS];
+static uint64_t latency_max;
+
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+
+static void record_call(call_stats_t *stats, uint64_t start) {
+    uint64_t ns = now_ns() - start;
+
+    stats->calls++;
+    stats->total_ns += ns;
+    if (ns > stats->max_ns) {
+        stats->max_ns = ns;
+    }
+}
+
+
+static void encode_record(uint8_t *record, uint64_t sequence) {
+    uint64_t stamp = now_ns();
+
+    memcpy(record, &sequence, 8);
+    memcpy(record + 8, &stamp, 8);
+}
+
+
+static void copy_to_regions(ring_buffer_region_t regions[2], const uint8_t *data, size_t length) {
+    size_t first = length < regions[0].length ? length : regions[0].length;
+
+    memcpy(regions[0].data, data, first);
+    memcpy(regions[1].data, data + first, length - first);
+}
+
+
+static void copy_from_regions(uint8_t *data, ring_buffer_region_t regions[2], size_t length) {
+    size_t first = length < regions[0].length ? length : regions[0].length;
+
+    memcpy(data, regions[0].data, first);
+    memcpy(data + first, regions[1].data, length - first);
+}
+
+
+static void *producer(void *arg) {
+    unsigned int seed = 1;
+    uint8_t pending[RECORD_SIZE * 64];
+    size_t pending_length = 0, pending_offset = 0;
+
+    /* Finish the last batch after being told to stop, so all records written arrive. */
+    while (!atomic_load(&done) || pending_offset < pending_length) {
+        size_t length, n;
+        uint64_t start;
+
+        if (pending_offset == pending_length) {
+            /* Produce a batch of records, like a frame of audio. */
+            size_t i, count = 1 + rand_r(&seed) % 64;
+
+            for (i = 0; i < count; i++) {
+                encode_record(pending + i * RECORD_SIZE, records_written++);
+            }
+            pending_length = count * RECORD_SIZE;
+            pending_offset = 0;
+        }
+
+        /* Write in random pieces that don't line up with records. */
+        length = 1 + rand_r(&seed) % (pending_length - pending_offset);
+
+        start = now_ns();
+        if (rand_r(&seed) & 1) {
+            n = ring_buffer_writable(ring);
+            if (n > length) {
+                n = length;
+            }
+            n = ring_buffer_write(ring, pending + pending_offset, n);
+        }
+        else {
+            ring_buffer_region_t regions[2];
+
+            n = ring_buffer_write_acquire(ring, regions);
+            if (n > length) {
+                n = length;
+            }
+            copy_to_regions(regions, pending + pending_offset, n);
+            ring_buffer_write_commit(ring, n);
+        }
+        record_call(&write_stats, start);
+
+        pending_offset += n;
+        if (n == 0) {
+            sched_yield();
+        }
+    }
+
+    atomic_store(&producer_done, 1);
+    return NULL;
+}
+
+
+static void check_record(const uint8_t *record) {
+    uint64_t sequence, stamp, latency;
+    int bucket = 0;
+
+    memcpy(&sequence, record, 8);
+    memcpy(&stamp, record + 8, 8);
+
+    if (sequence != records_read) {
+        if (errors++ < 10) {
+            fprintf(stderr, "record %llu out of order, expected %llu\n", (unsigned long long)sequence, (unsigned long long)records_read);
+        }
+        records_read = sequence;
+    }
+    records_read++;
+
+    latency = now_ns() - stamp;
+    if (latency > latency_max) {
+        latency_max = latency;
+    }
+    while (bucket < LATENCY_BUCKETS - 1 && latency >> (bucket + 1)) {
+        bucket++;
+    }
+    latency_histogram[bucket]++;
+}
+
+
+static void *consumer(void *arg) {
+    unsigned int seed = 2;
+    uint8_t buffer[4096];
+    uint8_t record[RECORD_SIZE];
+    size_t record_length = 0;
+
+    while (!atomic_load(&producer_done) || ring_buffer_readable(ring) > 0) {
+        size_t length = 1 + rand_r(&seed) % sizeof(buffer);
+        size_t n, i;
+        uint64_t start = now_ns();
+
+        if (rand_r(&seed) & 1) {
+            n = ring_buffer_readable(ring);
+            if (n > length) {
+                n = length;
+            }
+            n = ring_buffer_read(ring, buffer, n);
+        }
+        else {
+            ring_buffer_region_t regions[2];
+
+            n = ring_buffer_read_acquire(ring, regions);
+            if (n > length) {
+                n = length;
+            }
+            copy_from_regions(buffer, regions, n);
+            ring_buffer_read_commit(ring, n);
+        }
+        record_call(&read_stats, start);
+
+        for (i = 0; i < n; i++) {
+            record[record_length++] = buffer[i];
+            if (record_length == RECORD_SIZE) {
+                check_record(record);
+                record_length = 0;
+            }
+        }
+        if (n == 0) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+
+static uint64_t percentile(double fraction) {
+    uint64_t total = 0, sum = 0;
+    int i;
+
+    for (i = 0; i < LATENCY_BUCKETS; i++) {
+        total += latency_histogram[i];
+    }
+    for (i = 0; i < LATENCY_BUCKETS; i++) {
+        sum += latency_histogram[i];
+        if (sum >= total * fraction) {
+            return (uint64_t)2 << i;
+        }
+    }
+    return 0;
+}
+
+
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 5.0;
+    size_t size = argc > 2 ? (size_t)atol(argv[2]) : 4 * 882;
+    struct timespec duration;
+    pthread_t producer_thread, consumer_thread;
+
+    if ((ring = ring_buffer_new(size)) == NULL) {
+        fprintf(stderr, "can't create ring buffer of %zu bytes\n", size);
+        return 1;
+    }
+
+    pthread_create(&consumer_thread, NULL, consumer, NULL);
+    pthread_create(&producer_thread, NULL, producer, NULL);
+
+    duration.tv_sec = (time_t)seconds;
+    duration.tv_nsec = (long)((seconds - (double)duration.tv_sec) * 1e9);
+    nanosleep(&duration, NULL);
+
+    atomic_store(&done, 1);
+    pthread_join(producer_thread, NULL);
+    pthread_join(consumer_thread, NULL);
+
+    printf("ring buffer of %zu bytes, %.1f seconds\n", size, seconds);
+    printf("records: %llu written, %llu read, %.1f MB/s\n", (unsigned long long)records_written, (unsigned long long)records_read, records_read * RECORD_SIZE / seconds / 1e6);
+    printf("write: %llu calls, %.0f ns average, %llu ns max\n", (unsigned long long)write_stats.calls, (double)write_stats.total_ns / write_stats.calls, (unsigned long long)write_stats.max_ns);
+    printf("read: %llu calls, %.0f ns average, %llu ns max\n", (unsigned long long)read_stats.calls, (double)read_stats.total_ns / read_stats.calls, (unsigned long long)read_stats.max_ns);
+    printf("latency: median < %llu ns, 99%% < %llu ns, max %llu ns\n", (unsigned long long)percentile(0.5), (unsigned long long)percentile(0.99), (unsigned long long)latency_max);
+    printf("underruns: %llu (%llu bytes), overruns: %llu (%llu bytes)\n", (unsigned long long)ring_buffer_underruns(ring), (unsigned long long)ring_buffer_underrun_bytes(ring), (unsigned long long)ring_buffer_overruns(ring), (unsigned long long)ring_buffer_overrun_bytes(ring));
+
+    if (records_read != records_written || errors > 0) {
+        printf("FAILED: %d errors\n", errors);
+        ring_buffer_free(ring);
+        return 1;
+    }
+
+    ring_buffer_free(ring);
+    return 0;
+}
@@ -52,7 +52,7 @@
 
 @interface FuseThread : EmulatorThread
 
-@property Audio * _Nullable audio;
+@property BufferedAudio * _Nullable audio;
 
 - (void)runEmulator;
 
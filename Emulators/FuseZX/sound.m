@@ -42,7 +42,6 @@
 
 
 #include "settings.h"
-#include "sound/sfifo.h"
 #include "sound.h"
 #include "ui/ui.h"
 
@@ -50,10 +49,6 @@
 
 #undef DEBUG_FUSE_AUDIO
 
-sfifo_t sound_fifo;
-
-static int sample_size;
-
 /* Number of Spectrum frames audio latency to use */
 #define NUM_FRAMES 3
 
@@ -62,35 +57,6 @@ static int sample_size;
 #define MIN(a,b)    (((a) < (b)) ? (a) : (b))
 #endif
 
-static OSStatus audio_render_callback(void *userData, AudioUnitRenderActionFlags *actionFlags, const AudioTimeStamp *audioTimeStamp, UInt32 busNumber, UInt32 numFrames, AudioBufferList *buffers) {
-    uint8_t *inputFrames = (uint8_t *)(buffers->mBuffers->mData);
-    int length = numFrames * sample_size;
-
-    /* Only read complete samples */
-    int fifo_length = MIN(length, sfifo_used(&sound_fifo));
-    fifo_length -= fifo_length % sample_size;
-    
-#ifdef DEBUG_FUSE_AUDIO
-    printf("fuse sound getting %d bytes", length);
-    if (fifo_length < length) {
-        printf(", fifo short by %d", (length - fifo_length));
-    }
-    printf("\n");
-#endif
-
-    int n = 0;
-    int i;
-    while (n < fifo_length && (i = sfifo_read(&sound_fifo, inputFrames + n, fifo_length - n)) > 0) {
-        n += i;
-    }
-
-    if (n < length) {
-        memset(inputFrames + n, 0, length - n);
-    }
-    
-    return noErr;
-}
-    
 int sound_lowlevel_init(const char *device, int *freqptr, int *stereoptr) {
     int channels = *stereoptr ? 2 : 1;
 
@@ -102,18 +68,9 @@ int sound_lowlevel_init(const char *device, int *freqptr, int *stereoptr) {
     /* Size of audio data we will get from running a single Spectrum frame */
     int sound_framesize = ( float )*freqptr / hz;
 
-    sample_size = sizeof(int16_t) * channels;
-    
-    if (sfifo_init(&sound_fifo, NUM_FRAMES * channels * sound_framesize + 1 )) {
-        printf("can't init sfifo\n");
-        return 1;
-    }
-
-    fuseThread.audio = [[Audio alloc] initSampleRate:*freqptr channels:channels samplesPerBuffer:sound_framesize callback:audio_render_callback userData:NULL];
+    fuseThread.audio = [[BufferedAudio alloc] initSampleRate:*freqptr channels:channels samplesPerBuffer:sound_framesize numberOfBuffers:NUM_FRAMES];
 
     if (fuseThread.audio == nil) {
-        sfifo_flush(&sound_fifo);
-        sfifo_close(&sound_fifo);
         return -1;
     }
     
@@ -127,14 +84,10 @@ void sound_lowlevel_end(void) {
     printf("fuse sound ending\n");
 #endif
     fuseThread.audio = nil;
-    sfifo_flush(&sound_fifo);
-    sfifo_close(&sound_fifo);
 }
 
-/* Copy data to fifo */
+/* Copy data to ring buffer */
 void sound_lowlevel_frame(libspectrum_signed_word *data, int len) {
-    int i = 0;
-
 #ifdef DEBUG_FUSE_AUDIO
     bool silence = true;
     for (int x = 0; x < len; x++) {
@@ -150,17 +103,15 @@ void sound_lowlevel_frame(libspectrum_signed_word *data, int len) {
     libspectrum_signed_byte* bytes = (libspectrum_signed_byte*)data;
     len *= 2;
 
+    /* Wait for the audio callback to make room rather than dropping samples */
     while (len) {
-        if ((i = sfifo_write(&sound_fifo, bytes, len)) < 0) {
-            break;
-        }
-        else if (i == 0) {
+        size_t n = MIN((size_t)len, [fuseThread.audio bytesWritable]);
+        if (n == 0) {
             usleep(10000);
+            continue;
         }
-        bytes += i;
-        len -= i;
-    }
-    if (i < 0) {
-        printf("can't write to sfifo\n");
+        [fuseThread.audio write:bytes length:n];
+        bytes += n;
+        len -= n;
     }
 }
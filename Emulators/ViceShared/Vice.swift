@@ -282,6 +282,9 @@ extension JoystickButtons {
                 // TODO: detach image
             }
             
+        case .flush:
+            disk_image_flush_all()
+            
         case .freeze:
             cartridge_trigger_freeze()
             
@@ -52,6 +52,8 @@ extern void cartridge_trigger_freeze(void);
 
 extern int file_system_attach_disk(unsigned int unit, unsigned int drive, const char *filename);
 
+extern void disk_image_flush_all(void);
+
 void joystick_set_value_absolute(unsigned int joyport, uint32_t value);
 void joystick_set_value_or(unsigned int joyport, uint32_t value);
 void joystick_set_value_and(unsigned int joyport, uint32_t value);
@@ -297,6 +297,7 @@ class EmulatorViewController: FullScreenViewController, KeyboardViewDelegate, Se
         
         NotificationCenter.default.addObserver(self, selector: #selector(controllerWasConnected(_:)), name: .GCControllerDidConnect, object: nil)
         NotificationCenter.default.addObserver(self, selector: #selector(controllerWasDisconnected(_:)), name: .GCControllerDidDisconnect, object: nil)
+        NotificationCenter.default.addObserver(self, selector: #selector(applicationWillResignActive(_:)), name: UIApplication.willResignActiveNotification, object: nil)
 
         machine.connect(inputDevice: TouchInputDevice(view: controllerView))
         
@@ -640,6 +641,12 @@ extension EmulatorViewController {
         
         disconnect(controller: controller)
     }
+    
+    @objc
+    func applicationWillResignActive(_ notification: Notification) {
+        // The app may be suspended and killed in the background, write back disk images kept in memory.
+        emulator?.flush()
+    }
 }
 
 extension EmulatorViewController: KeyPressTranslatorDelegate {
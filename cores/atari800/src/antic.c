@@ -51,9 +51,9 @@
 #define LCHOP 3			/* do not build leftmost 0..3 characters in wide mode */
 #define RCHOP 3			/* do not build rightmost 0..3 characters in wide mode */
 
-int ANTIC_break_ypos = 999;
+THREAD_LOCAL int ANTIC_break_ypos = 999;
 #if !defined(BASIC) && !defined(CURSES_BASIC)
-static int gtia_bug_active = FALSE; /* The GTIA bug mode is active */
+static THREAD_LOCAL int gtia_bug_active = FALSE; /* The GTIA bug mode is active */
 #endif
 #ifdef NEW_CYCLE_EXACT
 static void draw_partial_scanline(int l,int r);
@@ -70,7 +70,7 @@ static UBYTE need_load;
 static int dmactl_bug_chdata;
 #endif /* NEW_CYCLE_EXACT */
 #ifndef NO_SIMPLE_PAL_BLENDING
-int ANTIC_pal_blending = 0;
+THREAD_LOCAL int ANTIC_pal_blending = 0;
 #endif /* NO_SIMPLE_PAL_BLENDING */
 
 /* Video memory access is hidden behind these macros. It allows to track dirty video memory
@@ -221,20 +221,20 @@ void ANTIC_VideoPutByte(UBYTE *ptr, UBYTE val)
 
 /* ANTIC Registers --------------------------------------------------------- */
 
-UBYTE ANTIC_DMACTL;
-UBYTE ANTIC_CHACTL;
-UWORD ANTIC_dlist;
-UBYTE ANTIC_HSCROL;
-UBYTE ANTIC_VSCROL;
-UBYTE ANTIC_PMBASE;
-UBYTE ANTIC_CHBASE;
-UBYTE ANTIC_NMIEN;
-UBYTE ANTIC_NMIST;
+THREAD_LOCAL UBYTE ANTIC_DMACTL;
+THREAD_LOCAL UBYTE ANTIC_CHACTL;
+THREAD_LOCAL UWORD ANTIC_dlist;
+THREAD_LOCAL UBYTE ANTIC_HSCROL;
+THREAD_LOCAL UBYTE ANTIC_VSCROL;
+THREAD_LOCAL UBYTE ANTIC_PMBASE;
+THREAD_LOCAL UBYTE ANTIC_CHBASE;
+THREAD_LOCAL UBYTE ANTIC_NMIEN;
+THREAD_LOCAL UBYTE ANTIC_NMIST;
 
 /* ANTIC Memory ------------------------------------------------------------ */
 
 #if !defined(BASIC) && !defined(CURSES_BASIC)
-static UBYTE antic_memory[52];
+static THREAD_LOCAL UBYTE antic_memory[52];
 #define ANTIC_margin 4
 /* It's number of bytes in antic_memory, which are never loaded, but may be
    read in wide playfield mode. These bytes are uninitialized, because on
@@ -246,7 +246,7 @@ static UBYTE antic_memory[52];
    This allows special optimisations under certain conditions.
    ------------------------------------------------------------------------ */
 
-static UWORD *scrn_ptr;
+static THREAD_LOCAL UWORD *scrn_ptr;
 #endif /* !defined(BASIC) && !defined(CURSES_BASIC) */
 
 /* Separate access to XE extended memory ----------------------------------- */
@@ -261,13 +261,13 @@ static UWORD *scrn_ptr;
 /* Pointer to 16 KB seen by ANTIC in 0x4000-0x7fff.
    If it's the same what the CPU sees (and what's in MEMORY_mem[0x4000..0x7fff],
    then NULL. */
-const UBYTE *ANTIC_xe_ptr = NULL;
+THREAD_LOCAL const UBYTE *ANTIC_xe_ptr = NULL;
 
 /* ANTIC Timing --------------------------------------------------------------
 
 NOTE: this information was written before NEW_CYCLE_EXACT was introduced!
 
-I've introduced global variable ANTIC_xpos, which contains current number of cycle
+THREAD_LOCAL I've introduced global variable ANTIC_xpos, which contains current number of cycle
 in a line. This simplifies ANTIC/CPU timing much. The CPU_GO() function which
 emulates CPU is now void and is called with ANTIC_xpos limit, below which CPU can go.
 
@@ -409,7 +409,7 @@ These are all cases:
 #define SCR_C	28
 #define VSCOF_C	112
 
-unsigned int ANTIC_screenline_cpu_clock = 0;
+THREAD_LOCAL unsigned int ANTIC_screenline_cpu_clock = 0;
 
 #ifdef NEW_CYCLE_EXACT
 #define UPDATE_DMACTL do{if (dmactl_changed) { \
@@ -438,16 +438,16 @@ unsigned int ANTIC_screenline_cpu_clock = 0;
 #define GOEOL CPU_GO(ANTIC_LINE_C); ANTIC_xpos -= ANTIC_LINE_C; ANTIC_screenline_cpu_clock += ANTIC_LINE_C; UPDATE_DMACTL; ANTIC_ypos++; UPDATE_GTIA_BUG
 #define OVERSCREEN_LINE	ANTIC_xpos += ANTIC_DMAR; GOEOL
 
-int ANTIC_xpos = 0;
-int ANTIC_xpos_limit;
-int ANTIC_wsync_halt = FALSE;
+THREAD_LOCAL int ANTIC_xpos = 0;
+THREAD_LOCAL int ANTIC_xpos_limit;
+THREAD_LOCAL int ANTIC_wsync_halt = FALSE;
 
-int ANTIC_ypos;						/* Line number - lines 8..247 are on screen */
+THREAD_LOCAL int ANTIC_ypos;						/* Line number - lines 8..247 are on screen */
 
 /* Timing in first line of modes 2-5
 In these modes ANTIC takes more bytes than cycles. Despite this, it would be
 possible that SCR_C + cycles_taken > ANTIC_WSYNC_C. To avoid this we must take some
-cycles before SCR_C. before_cycles contains number of them, while extra_cycles
+THREAD_LOCAL cycles before SCR_C. before_cycles contains number of them, while extra_cycles
 contains difference between bytes taken and cycles taken plus before_cycles. */
 
 #define BEFORE_CYCLES (SCR_C - 28)
@@ -456,22 +456,22 @@ contains difference between bytes taken and cycles taken plus before_cycles. */
 
 /* Light pen support ------------------------------------------------------- */
 
-static UBYTE PENH;
-static UBYTE PENV;
-UBYTE ANTIC_PENH_input = 0x00;
-UBYTE ANTIC_PENV_input = 0xff;
+static THREAD_LOCAL UBYTE PENH;
+static THREAD_LOCAL UBYTE PENV;
+THREAD_LOCAL UBYTE ANTIC_PENH_input = 0x00;
+THREAD_LOCAL UBYTE ANTIC_PENV_input = 0xff;
 
 #ifndef BASIC
 
 /* Internal ANTIC registers ------------------------------------------------ */
 
-static UWORD screenaddr;		/* Screen Pointer */
-static UBYTE IR;				/* Instruction Register */
-static UBYTE anticmode;			/* Antic mode */
-static UBYTE dctr;				/* Delta Counter */
-static UBYTE lastline;			/* dctr limit */
-static UBYTE need_dl;			/* boolean: fetch DL next line */
-static UBYTE vscrol_off;		/* boolean: displaying line ending VSC */
+static THREAD_LOCAL UWORD screenaddr;		/* Screen Pointer */
+static THREAD_LOCAL UBYTE IR;				/* Instruction Register */
+static THREAD_LOCAL UBYTE anticmode;			/* Antic mode */
+static THREAD_LOCAL UBYTE dctr;				/* Delta Counter */
+static THREAD_LOCAL UBYTE lastline;			/* dctr limit */
+static THREAD_LOCAL UBYTE need_dl;			/* boolean: fetch DL next line */
+static THREAD_LOCAL UBYTE vscrol_off;		/* boolean: displaying line ending VSC */
 
 #endif
 
@@ -485,20 +485,20 @@ static UBYTE vscrol_off;		/* boolean: displaying line ending VSC */
 #define SCROLL0 3				/* modes 2,3,4,5,0xd,0xe,0xf with HSC */
 #define SCROLL1 4				/* modes 6,7,0xa,0xb,0xc with HSC */
 #define SCROLL2 5				/* modes 8,9 with HSC */
-static int md;					/* current mode NORMAL0..SCROLL2 */
+static THREAD_LOCAL int md;					/* current mode NORMAL0..SCROLL2 */
 /* tables for modes NORMAL0..SCROLL2 */
-static int chars_read[6];
-static int chars_displayed[6];
-static int x_min[6];
-static int ch_offset[6];
-static int load_cycles[6];
-static int font_cycles[6];
-static int before_cycles[6];
-static int extra_cycles[6];
+static THREAD_LOCAL int chars_read[6];
+static THREAD_LOCAL int chars_displayed[6];
+static THREAD_LOCAL int x_min[6];
+static THREAD_LOCAL int ch_offset[6];
+static THREAD_LOCAL int load_cycles[6];
+static THREAD_LOCAL int font_cycles[6];
+static THREAD_LOCAL int before_cycles[6];
+static THREAD_LOCAL int extra_cycles[6];
 
 /* border parameters for current display width */
-static int left_border_chars;
-static int right_border_start;
+static THREAD_LOCAL int left_border_chars;
+static THREAD_LOCAL int right_border_start;
 #ifdef NEW_CYCLE_EXACT
 static int left_border_start = LCHOP * 4;
 static int right_border_end = (48 - RCHOP) * 4;
@@ -510,23 +510,23 @@ static int right_border_end = (48 - RCHOP) * 4;
 #endif /* NEW_CYCLE_EXACT */
 
 /* set with CHBASE *and* CHACTL - bits 0..2 set if flip on */
-static UWORD chbase_20;			/* CHBASE for 20 character mode */
+static THREAD_LOCAL UWORD chbase_20;			/* CHBASE for 20 character mode */
 
 /* set with CHACTL */
-static UBYTE invert_mask;
-static int blank_mask;
+static THREAD_LOCAL UBYTE invert_mask;
+static THREAD_LOCAL int blank_mask;
 
 /* A scanline of AN0 and AN1 signals as transmitted from ANTIC to GTIA.
    In every byte, bit 0 is AN0 and bit 1 is AN1 */
-static UBYTE an_scanline[Screen_WIDTH / 2 + 8];
+static THREAD_LOCAL UBYTE an_scanline[Screen_WIDTH / 2 + 8];
 
 /* lookup tables */
-static UBYTE blank_lookup[256];
-static UWORD lookup2[256];
-ULONG ANTIC_lookup_gtia9[16];
-ULONG ANTIC_lookup_gtia11[16];
-static UBYTE playfield_lookup[257];
-static UBYTE mode_e_an_lookup[256];
+static THREAD_LOCAL UBYTE blank_lookup[256];
+static THREAD_LOCAL UWORD lookup2[256];
+THREAD_LOCAL ULONG ANTIC_lookup_gtia9[16];
+THREAD_LOCAL ULONG ANTIC_lookup_gtia11[16];
+static THREAD_LOCAL UBYTE playfield_lookup[257];
+static THREAD_LOCAL UBYTE mode_e_an_lookup[256];
 
 /* Colour lookup table
    This single table replaces 4 previously used: cl_word, cur_prior,
@@ -556,7 +556,7 @@ static UBYTE mode_e_an_lookup[256];
    PF3 if (PRIOR & 0x1f) == 0x10, PF0 or PF1 otherwise.
    Additional column 'colls' holds collisions of playfields with PMG. */
 
-UWORD ANTIC_cl[128];
+THREAD_LOCAL UWORD ANTIC_cl[128];
 
 #define C_PM0	0x01
 #define C_PM1	0x02
@@ -675,14 +675,14 @@ UWORD ANTIC_cl[128];
 #define HIRES_LUM_10	0x000f
 #endif
 
-static UWORD hires_lookup_n[128];
-static UWORD hires_lookup_m[128];
+static THREAD_LOCAL UWORD hires_lookup_n[128];
+static THREAD_LOCAL UWORD hires_lookup_m[128];
 #define hires_norm(x)	hires_lookup_n[(x) >> 1]
 #define hires_mask(x)	hires_lookup_m[(x) >> 1]
 
 #ifndef USE_COLOUR_TRANSLATION_TABLE
-int ANTIC_artif_new = FALSE; /* New type of artifacting */
-UWORD ANTIC_hires_lookup_l[128];	/* accessed in gtia.c */
+THREAD_LOCAL int ANTIC_artif_new = FALSE; /* New type of artifacting */
+THREAD_LOCAL UWORD ANTIC_hires_lookup_l[128];	/* accessed in gtia.c */
 #define hires_lum(x)	ANTIC_hires_lookup_l[(x) >> 1]
 #endif
 
@@ -694,21 +694,21 @@ UWORD ANTIC_hires_lookup_l[128];	/* accessed in gtia.c */
 #define PF3PM (*(UBYTE *) &ANTIC_cl[C_PF3 | C_COLLS])
 #define PF_COLLS(x) (((UBYTE *) &ANTIC_cl)[(x) + L_COLLS])
 
-static int singleline;
-int ANTIC_player_dma_enabled;
-int ANTIC_player_gra_enabled;
-int ANTIC_missile_dma_enabled;
-int ANTIC_missile_gra_enabled;
-int ANTIC_player_flickering;
-int ANTIC_missile_flickering;
+static THREAD_LOCAL int singleline;
+THREAD_LOCAL int ANTIC_player_dma_enabled;
+THREAD_LOCAL int ANTIC_player_gra_enabled;
+THREAD_LOCAL int ANTIC_missile_dma_enabled;
+THREAD_LOCAL int ANTIC_missile_gra_enabled;
+THREAD_LOCAL int ANTIC_player_flickering;
+THREAD_LOCAL int ANTIC_missile_flickering;
 
-static UWORD pmbase_s;
-static UWORD pmbase_d;
+static THREAD_LOCAL UWORD pmbase_s;
+static THREAD_LOCAL UWORD pmbase_d;
 
 /* PMG lookup tables */
-static UBYTE pm_lookup_table[20][256];
+static THREAD_LOCAL UBYTE pm_lookup_table[20][256];
 /* current PMG lookup table */
-static const UBYTE *pm_lookup_ptr;
+static THREAD_LOCAL const UBYTE *pm_lookup_ptr;
 
 #define PL_00	0	/* 0x00,0x01,0x02,0x03,0x04,0x06,0x08,0x09,0x0a,0x0b */
 #define PL_05	1	/* 0x05,0x07,0x0c,0x0d,0x0e,0x0f */
@@ -879,32 +879,33 @@ static void pmg_dma(void)
 
 /* Artifacting ------------------------------------------------------------ */
 
-int ANTIC_artif_mode;
+THREAD_LOCAL int ANTIC_artif_mode;
 
-static UWORD art_lookup_new[64];
-static UWORD art_colour1_new;
-static UWORD art_colour2_new;
+static THREAD_LOCAL UWORD art_lookup_new[64];
+static THREAD_LOCAL UWORD art_colour1_new;
+static THREAD_LOCAL UWORD art_colour2_new;
 
-static ULONG art_lookup_normal[256];
-static ULONG art_lookup_reverse[256];
-static ULONG art_bkmask_normal[256];
-static ULONG art_lummask_normal[256];
-static ULONG art_bkmask_reverse[256];
-static ULONG art_lummask_reverse[256];
+static THREAD_LOCAL ULONG art_lookup_normal[256];
+static THREAD_LOCAL ULONG art_lookup_reverse[256];
+static THREAD_LOCAL ULONG art_bkmask_normal[256];
+static THREAD_LOCAL ULONG art_lummask_normal[256];
+static THREAD_LOCAL ULONG art_bkmask_reverse[256];
+static THREAD_LOCAL ULONG art_lummask_reverse[256];
 
-static ULONG *art_curtable = art_lookup_normal;
-static ULONG *art_curbkmask = art_bkmask_normal;
-static ULONG *art_curlummask = art_lummask_normal;
+/* Thread local addresses aren't constant, so these are set in ANTIC_Initialise(). */
+static THREAD_LOCAL ULONG *art_curtable;
+static THREAD_LOCAL ULONG *art_curbkmask;
+static THREAD_LOCAL ULONG *art_curlummask;
+static THREAD_LOCAL UWORD *art_colpf1_save;
+static THREAD_LOCAL UWORD *art_colpf2_save;
 
-static UWORD art_normal_colpf1_save;
-static UWORD art_normal_colpf2_save;
-static UWORD art_reverse_colpf1_save;
-static UWORD art_reverse_colpf2_save;
+static THREAD_LOCAL UWORD art_normal_colpf1_save;
+static THREAD_LOCAL UWORD art_normal_colpf2_save;
+static THREAD_LOCAL UWORD art_reverse_colpf1_save;
+static THREAD_LOCAL UWORD art_reverse_colpf2_save;
 
 static void setup_art_colours(void)
 {
-	static UWORD *art_colpf1_save = &art_normal_colpf1_save;
-	static UWORD *art_colpf2_save = &art_normal_colpf2_save;
 	UWORD curlum = ANTIC_cl[C_PF1] & 0x0f0f;
 
 	if (curlum != *art_colpf1_save || ANTIC_cl[C_PF2] != *art_colpf2_save) {
@@ -979,6 +980,11 @@ int ANTIC_Initialise(int *argc, char *argv[])
 	}
 	*argc = j;
 
+	art_curtable = art_lookup_normal;
+	art_curbkmask = art_bkmask_normal;
+	art_curlummask = art_lummask_normal;
+	art_colpf1_save = &art_normal_colpf1_save;
+	art_colpf2_save = &art_normal_colpf2_save;
 	ANTIC_UpdateArtifacting();
 
 	playfield_lookup[0x00] = L_BAK;
@@ -2601,7 +2607,7 @@ static void draw_antic_f_gtia_bug(int nchars, const UBYTE *antic_memptr, UWORD *
 typedef void (*draw_antic_function)(int nchars, const UBYTE *antic_memptr, UWORD *ptr, const ULONG *t_pm_scanline_ptr);
 
 /* tables for all GTIA and ANTIC modes */
-static draw_antic_function draw_antic_table[4][16] = {
+static THREAD_LOCAL draw_antic_function draw_antic_table[4][16] = {
 /* normal */
 		{ NULL,			NULL,			draw_antic_2,	draw_antic_2,
 		draw_antic_4,	draw_antic_4,	draw_antic_6,	draw_antic_6,
@@ -2624,12 +2630,12 @@ static draw_antic_function draw_antic_table[4][16] = {
 		draw_antic_9_gtia11,	draw_antic_e_gtia11,	draw_antic_e_gtia11,	draw_antic_f_gtia11}};
 
 /* pointer to current GTIA/ANTIC mode routine */
-static draw_antic_function draw_antic_ptr = draw_antic_8;
+static THREAD_LOCAL draw_antic_function draw_antic_ptr = draw_antic_8;
 #ifdef NEW_CYCLE_EXACT
 static draw_antic_function saved_draw_antic_ptr;
 #endif
 /* pointer to current GTIA mode blank drawing routine */
-static void (*draw_antic_0_ptr)(void) = draw_antic_0;
+static THREAD_LOCAL void (*draw_antic_0_ptr)(void) = draw_antic_0;
 
 #ifdef NEW_CYCLE_EXACT
 /* wrapper for antic_0, for dmactl bugs */
@@ -3064,7 +3070,7 @@ void ANTIC_Frame(int draw_display)
 		}
 #ifndef NO_YPOS_BREAK_FLICKER
 #define YPOS_BREAK_FLICKER do{if (ANTIC_ypos == ANTIC_break_ypos - 1000) {\
-				static int toggle;\
+				static THREAD_LOCAL int toggle;\
 				if (toggle == 1) {\
 					FILL_VIDEO(scrn_ptr + LBORDER_START, 0x0f0f, (RBORDER_END - LBORDER_START) * 2);\
 				}\
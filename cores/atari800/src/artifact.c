@@ -39,10 +39,10 @@
 #include "videomode.h"
 #endif /* SUPPORTS_CHANGE_VIDEOMODE */
 
-ARTIFACT_t ARTIFACT_mode = ARTIFACT_NONE;
+THREAD_LOCAL ARTIFACT_t ARTIFACT_mode = ARTIFACT_NONE;
 
-static ARTIFACT_t mode_ntsc = ARTIFACT_NONE;
-static ARTIFACT_t mode_pal = ARTIFACT_NONE;
+static THREAD_LOCAL ARTIFACT_t mode_ntsc = ARTIFACT_NONE;
+static THREAD_LOCAL ARTIFACT_t mode_pal = ARTIFACT_NONE;
 
 static char const * const mode_cfg_strings[ARTIFACT_SIZE] = {
 	"NONE",
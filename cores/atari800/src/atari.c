@@ -149,29 +149,29 @@
 #include "win32\main.h"
 #endif
 
-int Atari800_machine_type = Atari800_MACHINE_XLXE;
+THREAD_LOCAL int Atari800_machine_type = Atari800_MACHINE_XLXE;
 
-int Atari800_builtin_basic = TRUE;
-int Atari800_keyboard_leds = FALSE;
-int Atari800_f_keys = FALSE;
-int Atari800_jumper;
-int Atari800_builtin_game = FALSE;
-int Atari800_keyboard_detached = FALSE;
+THREAD_LOCAL int Atari800_builtin_basic = TRUE;
+THREAD_LOCAL int Atari800_keyboard_leds = FALSE;
+THREAD_LOCAL int Atari800_f_keys = FALSE;
+THREAD_LOCAL int Atari800_jumper;
+THREAD_LOCAL int Atari800_builtin_game = FALSE;
+THREAD_LOCAL int Atari800_keyboard_detached = FALSE;
 
-int Atari800_tv_mode = Atari800_TV_PAL;
-int Atari800_disable_basic = TRUE;
+THREAD_LOCAL int Atari800_tv_mode = Atari800_TV_PAL;
+THREAD_LOCAL int Atari800_disable_basic = TRUE;
 
-int Atari800_os_version = -1;
+THREAD_LOCAL int Atari800_os_version = -1;
 
-int verbose = FALSE;
+THREAD_LOCAL int verbose = FALSE;
 
-int Atari800_display_screen = FALSE;
-int Atari800_nframes = 0;
-int Atari800_refresh_rate = 1;
-int Atari800_collisions_in_skipped_frames = FALSE;
-int Atari800_turbo = FALSE;
-int Atari800_start_in_monitor = FALSE;
-int Atari800_auto_frameskip = FALSE;
+THREAD_LOCAL int Atari800_display_screen = FALSE;
+THREAD_LOCAL int Atari800_nframes = 0;
+THREAD_LOCAL int Atari800_refresh_rate = 1;
+THREAD_LOCAL int Atari800_collisions_in_skipped_frames = FALSE;
+THREAD_LOCAL int Atari800_turbo = FALSE;
+THREAD_LOCAL int Atari800_start_in_monitor = FALSE;
+THREAD_LOCAL int Atari800_auto_frameskip = FALSE;
 
 #ifdef BENCHMARK
 static double benchmark_start_time;
@@ -1017,8 +1017,8 @@ void Atari800_ErrExit(void)
 #ifndef __PLUS
 static void autoframeskip(double curtime, double lasttime)
 {
-	static int afs_lastframe = 0, afs_discard = 0;
-	static double afs_lasttime = 0.0, afs_sleeptime = 0.0;
+	static THREAD_LOCAL int afs_lastframe = 0, afs_discard = 0;
+	static THREAD_LOCAL double afs_lasttime = 0.0, afs_sleeptime = 0.0;
 	double afs_speedpct, afs_sleeppct, afs_ataritime, afs_realtime;
 
 	if (lasttime - curtime > 0)
@@ -1051,7 +1051,7 @@ static void autoframeskip(double curtime, double lasttime)
 
 void Atari800_Sync(void)
 {
-	static double lasttime = 0;
+	static THREAD_LOCAL double lasttime = 0;
 	double deltatime = 1.0 / ((Atari800_tv_mode == Atari800_TV_PAL) ? Atari800_FPS_PAL : Atari800_FPS_NTSC);
 	double curtime;
 
@@ -1227,7 +1227,7 @@ static void basic_frame(void)
 void Atari800_Frame(void)
 {
 #ifndef BASIC
-	static int refresh_counter = 0;
+	static THREAD_LOCAL int refresh_counter = 0;
 
 #ifdef CTRL_C_HANDLER
 	if (sigint_flag) {
@@ -1341,7 +1341,7 @@ void Atari800_Frame(void)
 		if (Atari800_turbo) {
 			/* No need to draw Atari frames with frequency higher than display
 			   refresh rate. */
-			static double last_display_screen_time = 0.0;
+			static THREAD_LOCAL double last_display_screen_time = 0.0;
 			static double const limit = 1.0 / 60.0; /* refresh every 1/60 s */
 			/* TODO Actually sync the limit with the display refresh rate. */
 			double cur_time = Util_time();
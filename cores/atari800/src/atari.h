@@ -33,6 +33,21 @@
 /* Note: in various parts of the emulator we assume that char is 1 byte
    and int is 4 bytes. */
 
+/* Storage class of all emulator state.  libatari800 keeps the state of the
+   emulator in thread local storage, so that each thread can run its own
+   emulated Atari. */
+#ifdef LIBATARI800
+#ifdef __GNUC__
+/* The initial-exec model can't be relaxed for all the instructions GCC
+   generates for it, so use the general model and let the linker relax that. */
+#define THREAD_LOCAL __thread __attribute__((tls_model("global-dynamic")))
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+#else
+#define THREAD_LOCAL
+#endif
+
 
 /* Public interface ------------------------------------------------------ */
 
@@ -45,37 +60,37 @@ enum {
 	Atari800_MACHINE_SIZE
 };
 /* Don't change this variable directly; use Atari800_SetMachineType() instead. */
-extern int Atari800_machine_type;
+extern THREAD_LOCAL int Atari800_machine_type;
 void Atari800_SetMachineType(int type);
 
 /* Always call Atari800_InitialiseMachine() after changing Atari800_machine_type
    or MEMORY_ram_size! */
 
 /* Indicates if machine has BASIC built in. */
-extern int Atari800_builtin_basic;
+extern THREAD_LOCAL int Atari800_builtin_basic;
 
 /* Indicates existence of 1200XL's two keyboard LEDs.
    Used only for Atari800_MACHINE_XLXE. */
-extern int Atari800_keyboard_leds;
+extern THREAD_LOCAL int Atari800_keyboard_leds;
 
 /* Indicates existence of F1-F4 keys.
    Used only for Atari800_MACHINE_XLXE. */
-extern int Atari800_f_keys;
+extern THREAD_LOCAL int Atari800_f_keys;
 
 /* State of the J1 jumper on the 1200XL board.
    Used only for Atari800_MACHINE_XLXE. Always call
    Atari800_UpdateJumper() after changing this variable. */
-extern int Atari800_jumper;
+extern THREAD_LOCAL int Atari800_jumper;
 void Atari800_UpdateJumper(void);
 
 /* Indicates existence of XEGS' built-in game.
    Used only for Atari800_MACHINE_XLXE. */
-extern int Atari800_builtin_game;
+extern THREAD_LOCAL int Atari800_builtin_game;
 
 /* TRUE if the XEGS keyboard is detached.
    Used only for Atari800_MACHINE_XLXE. Always call
    Atari800_UpdateKeyboardDetached() after changing this variable. */
-extern int Atari800_keyboard_detached;
+extern THREAD_LOCAL int Atari800_keyboard_detached;
 void Atari800_UpdateKeyboardDetached(void);
 
 /* Video system. */
@@ -89,38 +104,38 @@ void Atari800_UpdateKeyboardDetached(void);
 
 /* Video system / Number of scanlines per frame. Do not set this variable
    directly; instead use Atari800_SetTVMode(). */
-extern int Atari800_tv_mode;
+extern THREAD_LOCAL int Atari800_tv_mode;
 
 /* TRUE to disable Atari BASIC when booting Atari (hold Option in XL/XE). */
-extern int Atari800_disable_basic;
+extern THREAD_LOCAL int Atari800_disable_basic;
 
 /* OS ROM version currently used by the emulator. Can be -1 for missing ROM, or
    a value from the SYSROM enumerator. */
-extern int Atari800_os_version;
+extern THREAD_LOCAL int Atari800_os_version;
 
 /* If Atari800_Frame() sets it to TRUE, then the current contents
    of Screen_atari should be displayed. */
-extern int Atari800_display_screen;
+extern THREAD_LOCAL int Atari800_display_screen;
 
 /* Simply incremented by Atari800_Frame(). */
-extern int Atari800_nframes;
+extern THREAD_LOCAL int Atari800_nframes;
 
 /* How often the screen is updated (1 = every Atari frame). */
-extern int Atari800_refresh_rate;
+extern THREAD_LOCAL int Atari800_refresh_rate;
 
 /* If TRUE, will try to maintain the emulation speed to 100% */
-extern int Atari800_auto_frameskip;
+extern THREAD_LOCAL int Atari800_auto_frameskip;
 
 /* Set to TRUE for faster emulation with Atari800_refresh_rate > 1.
    Set to FALSE for accurate emulation with Atari800_refresh_rate > 1. */
-extern int Atari800_collisions_in_skipped_frames;
+extern THREAD_LOCAL int Atari800_collisions_in_skipped_frames;
 
 /* Set to TRUE to run emulated Atari as fast as possible */
-extern int Atari800_turbo;
+extern THREAD_LOCAL int Atari800_turbo;
 
 /* Set to TRUE to start in the monitor. It's up to each port's
 	main.c to implement this (initially only SDL supports it). */
-extern int Atari800_start_in_monitor;
+extern THREAD_LOCAL int Atari800_start_in_monitor;
 
 /* Initializes Atari800 emulation core. */
 int Atari800_Initialise(int *argc, char *argv[]);
@@ -34,24 +34,24 @@
 #include "memory.h"
 #include "sio.h"
 
-int BINLOAD_start_binloading = FALSE;
-int BINLOAD_loading_basic = 0;
-int BINLOAD_slow_xex_loading = FALSE;
-FILE *BINLOAD_bin_file = NULL;
+THREAD_LOCAL int BINLOAD_start_binloading = FALSE;
+THREAD_LOCAL int BINLOAD_loading_basic = 0;
+THREAD_LOCAL int BINLOAD_slow_xex_loading = FALSE;
+THREAD_LOCAL FILE *BINLOAD_bin_file = NULL;
 
 /* These variables are for slow XEX loading only. */
 
 /* Number of CPU instructions elapsed since last loaded byte. */
-static unsigned int instr_elapsed = 0;
-int BINLOAD_wait_active=FALSE;
+static THREAD_LOCAL unsigned int instr_elapsed = 0;
+THREAD_LOCAL int BINLOAD_wait_active=FALSE;
 /* Start and end address of the currently loaded segment. */
-static UWORD from = 0;
-static UWORD to = 0;
+static THREAD_LOCAL UWORD from = 0;
+static THREAD_LOCAL UWORD to = 0;
 /* Inticates that the next call to loader_cont will overwrite INITAD. */
-static int init2e3 = FALSE;
+static THREAD_LOCAL int init2e3 = FALSE;
 /* Indicates that we are currently not during loading of a segment. */
-static int segfinished = TRUE;
-int BINLOAD_pause_loading;
+static THREAD_LOCAL int segfinished = TRUE;
+THREAD_LOCAL int BINLOAD_pause_loading;
 
 /* Read a word from file */
 static int read_word(void)
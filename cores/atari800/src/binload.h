@@ -4,20 +4,20 @@
 #include <stdio.h> /* FILE */
 #include "atari.h" /* UBYTE */
 
-extern FILE *BINLOAD_bin_file;
+extern THREAD_LOCAL FILE *BINLOAD_bin_file;
 
 int BINLOAD_Loader(const char *filename);
-extern int BINLOAD_start_binloading;
-extern int BINLOAD_loading_basic;
+extern THREAD_LOCAL int BINLOAD_start_binloading;
+extern THREAD_LOCAL int BINLOAD_loading_basic;
 
 /* Set to TRUE to enable loading of XEX with approximate disk speed */
-extern int BINLOAD_slow_xex_loading;
+extern THREAD_LOCAL int BINLOAD_slow_xex_loading;
 
 /* Indicates that a DOS file is being currently slowly loaded. */
-extern int BINLOAD_wait_active;
+extern THREAD_LOCAL int BINLOAD_wait_active;
 
 /* Set it to TRUE to pause the current loading of a DOS file. */
-extern int BINLOAD_pause_loading;
+extern THREAD_LOCAL int BINLOAD_pause_loading;
 
 #define BINLOAD_LOADING_BASIC_SAVED              1
 #define BINLOAD_LOADING_BASIC_LISTED             2
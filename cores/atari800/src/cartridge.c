@@ -124,7 +124,7 @@ int const CARTRIDGE_kb[CARTRIDGE_LAST_SUPPORTED + 1] = {
 	64        /* CARTRIDGE_ADAWLIAH_64 */
 };
 
-int CARTRIDGE_autoreboot = TRUE;
+THREAD_LOCAL int CARTRIDGE_autoreboot = TRUE;
 
 static int CartIsFor5200(int type)
 {
@@ -148,13 +148,14 @@ static int CartIsPassthrough(int type)
 	       type == CARTRIDGE_ATRAX_SDX_64 || type == CARTRIDGE_ATRAX_SDX_128;
 }
 
-CARTRIDGE_image_t CARTRIDGE_main = { CARTRIDGE_NONE, 0, 0, NULL, "" }; /* Left/Right cartridge */
-CARTRIDGE_image_t CARTRIDGE_piggyback = { CARTRIDGE_NONE, 0, 0, NULL, "" }; /* Pass through cartridge for SpartaDOSX */
+THREAD_LOCAL CARTRIDGE_image_t CARTRIDGE_main = { CARTRIDGE_NONE, 0, 0, NULL, "" }; /* Left/Right cartridge */
+THREAD_LOCAL CARTRIDGE_image_t CARTRIDGE_piggyback = { CARTRIDGE_NONE, 0, 0, NULL, "" }; /* Pass through cartridge for SpartaDOSX */
 
 /* The currently active cartridge in the left slot - normally points to
    CARTRIDGE_main but can be switched to CARTRIDGE_piggyback if the main
-   cartridge is a SpartaDOS X. */
-static CARTRIDGE_image_t *active_cart = &CARTRIDGE_main;
+   cartridge is a SpartaDOS X. Set in CARTRIDGE_Initialise(), since thread
+   local addresses aren't constant. */
+static THREAD_LOCAL CARTRIDGE_image_t *active_cart;
 
 /* DB_32, XEGS_32, XEGS_07_64, XEGS_128, XEGS_256, XEGS_512, XEGS_1024,
    SWXEGS_32, SWXEGS_64, SWXEGS_128, SWXEGS_256, SWXEGS_512, SWXEGS_1024 */
@@ -1251,7 +1252,7 @@ static void PreprocessCart(CARTRIDGE_image_t *cart)
 		unsigned int addr[17]; /* Mapping of address (+ bank select) lines */
 		unsigned char data[8]; /* Mapping of data lines */
 	};
-	static struct cross_map_t cross_maps[2] = {
+	static THREAD_LOCAL struct cross_map_t cross_maps[2] = {
 		/* Atrax games cartridge */
 		{ /* cartridge port + bank select <-> EPROM */
 			{ 0x0020,              /*  A0 <->  A5 */
@@ -1636,6 +1637,8 @@ int CARTRIDGE_Initialise(int *argc, char *argv[])
 	int type_from_commandline = FALSE;
 	int type2_from_commandline = FALSE;
 
+	active_cart = &CARTRIDGE_main;
+
 	for (i = j = 1; i < *argc; i++) {
 		int i_a = (i + 1 < *argc); /* is argument available? */
 		int a_m = FALSE; /* error, argument missing! */
@@ -7,14 +7,14 @@
 
 #define CASSETTE_DESCRIPTION_MAX 256
 
-extern char CASSETTE_filename[FILENAME_MAX];
-extern char CASSETTE_description[CASSETTE_DESCRIPTION_MAX];
+extern THREAD_LOCAL char CASSETTE_filename[FILENAME_MAX];
+extern THREAD_LOCAL char CASSETTE_description[CASSETTE_DESCRIPTION_MAX];
 typedef enum {
 	CASSETTE_STATUS_NONE,
 	CASSETTE_STATUS_READ_ONLY,
 	CASSETTE_STATUS_READ_WRITE
 } CASSETTE_status_t;
-extern CASSETTE_status_t CASSETTE_status;
+extern THREAD_LOCAL CASSETTE_status_t CASSETTE_status;
 
 /* Used in Atari800_Initialise during emulator initialisation */
 int CASSETTE_Initialise(int *argc, char *argv[]);
@@ -31,17 +31,17 @@ void CASSETTE_Remove(void);
    Returns TRUE on success, FALSE otherwise. */
 int CASSETTE_CreateCAS(char const *filename, char const *description);
 
-extern int CASSETTE_hold_start;
-extern int CASSETTE_hold_start_on_reboot; /* preserve hold_start after reboot */
-extern int CASSETTE_press_space;
+extern THREAD_LOCAL int CASSETTE_hold_start;
+extern THREAD_LOCAL int CASSETTE_hold_start_on_reboot; /* preserve hold_start after reboot */
+extern THREAD_LOCAL int CASSETTE_press_space;
 
 /* Is cassette file write-protected? Don't change directly, use CASSETTE_ToggleWriteProtect(). */
-extern int CASSETTE_write_protect;
+extern THREAD_LOCAL int CASSETTE_write_protect;
 /* Switches RO/RW. Fails with FALSE if the tape cannot be switched to RW. */
 int CASSETTE_ToggleWriteProtect(void);
 
  /* Is cassette record button pressed? Don't change directly, use CASSETTE_ToggleRecord(). */
-extern int CASSETTE_record;
+extern THREAD_LOCAL int CASSETTE_record;
 /* If tape is mounted, switches recording on/off (otherwise return FALSE).
    Recording operations would fail if the tape is read-only. In such
    situation, when switching recording on the function returns FALSE. */
@@ -87,9 +87,9 @@ void CASSETTE_LeaderSave(void);
 
 /* Indicates whether the tape can be read from, ie. it's mounted and not on its
    end. */
-extern int CASSETTE_readable;
+extern THREAD_LOCAL int CASSETTE_readable;
 /* Indicates whether the tape can be written to, ie. it's mounted and not
    read-only. */
-extern int CASSETTE_writable;
+extern THREAD_LOCAL int CASSETTE_writable;
 
 #endif /* CASSETTE_H_ */
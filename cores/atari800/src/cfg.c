@@ -46,6 +46,7 @@
 #include "bit3.h"
 #endif
 #include "platform.h"
+#include "mzpokeysnd.h"
 #include "pokeysnd.h"
 #include "ui.h"
 #include "util.h"
@@ -63,7 +64,7 @@
 #include "sound.h"
 #endif
 
-int CFG_save_on_exit = FALSE;
+THREAD_LOCAL int CFG_save_on_exit = FALSE;
 
 /* If another default path config path is defined use it
    otherwise use the default one */
@@ -207,6 +208,11 @@ int CFG_LoadConfig(const char *alternate_config_filename)
 			else if (strcmp(string, "ENABLE_NEW_POKEY") == 0) {
 #ifdef SOUND
 				POKEYSND_enable_new_pokey = Util_sscanbool(ptr);
+#endif /* SOUND */
+			}
+			else if (strcmp(string, "BLOCK_RESAMPLER") == 0) {
+#ifdef SOUND
+				MZPOKEYSND_resampler = Util_sscanbool(ptr) ? MZPOKEYSND_RESAMPLER_BLOCK : MZPOKEYSND_RESAMPLER_EXACT;
 #endif /* SOUND */
 			}
 			else if (strcmp(string, "STEREO_POKEY") == 0) {
@@ -431,6 +437,7 @@ int CFG_WriteConfig(void)
 
 #ifdef SOUND
 	fprintf(fp, "ENABLE_NEW_POKEY=%d\n", POKEYSND_enable_new_pokey);
+	fprintf(fp, "BLOCK_RESAMPLER=%d\n", MZPOKEYSND_resampler == MZPOKEYSND_RESAMPLER_BLOCK);
 #ifdef STEREO_SOUND
 	fprintf(fp, "STEREO_POKEY=%d\n", POKEYSND_stereo_enabled);
 #endif
@@ -10,9 +10,9 @@
 #endif
 
 /* NTSC palette's current setup - generic controls. */
-extern Colours_setup_t COLOURS_NTSC_setup;
+extern THREAD_LOCAL Colours_setup_t COLOURS_NTSC_setup;
 /* External NTSC palette. */
-extern COLOURS_EXTERNAL_t COLOURS_NTSC_external;
+extern THREAD_LOCAL COLOURS_EXTERNAL_t COLOURS_NTSC_external;
 
 /* Updates the NTSC palette - should be called after changing palette setup
    or loading/unloading an external palette. */
@@ -35,7 +35,7 @@
 #define M_PI		3.14159265358979323846
 #endif
 
-Colours_setup_t COLOURS_PAL_setup;
+THREAD_LOCAL Colours_setup_t COLOURS_PAL_setup;
 
 /* PAL-specific default setup. */
 static struct {
@@ -44,7 +44,7 @@ static struct {
 	23.2, /* chosen by eye to give a smooth rainbow */
 };
 
-COLOURS_EXTERNAL_t COLOURS_PAL_external = { "", FALSE, FALSE };
+THREAD_LOCAL COLOURS_EXTERNAL_t COLOURS_PAL_external = { "", FALSE, FALSE };
 
 /* Fills YUV_TABLE from external palette. External palette is not adjusted if
    COLOURS_PAL_external.adjust is false. */
@@ -5,9 +5,9 @@
 #include "colours_external.h"
 
 /* PAL palette's current setup. */
-extern Colours_setup_t COLOURS_PAL_setup;
+extern THREAD_LOCAL Colours_setup_t COLOURS_PAL_setup;
 /* External PAL palette. */
-extern COLOURS_EXTERNAL_t COLOURS_PAL_external;
+extern THREAD_LOCAL COLOURS_EXTERNAL_t COLOURS_PAL_external;
 
 /* Updates the PAL palette - should be called after changing palette setup
    or loading/unloading an external palette. */
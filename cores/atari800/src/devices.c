@@ -111,7 +111,7 @@
 
 #ifdef HAVE_WINDOWS_H
 
-static char dir_path[FILENAME_MAX];
+static THREAD_LOCAL char dir_path[FILENAME_MAX];
 static WIN32_FIND_DATA wfd;
 static HANDLE dh = INVALID_HANDLE_VALUE;
 
@@ -232,9 +232,9 @@ static int match(const char *pattern, const char *filename)
 	}
 }
 
-static char dir_path[FILENAME_MAX];
-static char filename_pattern[FILENAME_MAX];
-static DIR *dp = NULL;
+static THREAD_LOCAL char dir_path[FILENAME_MAX];
+static THREAD_LOCAL char filename_pattern[FILENAME_MAX];
+static THREAD_LOCAL DIR *dp = NULL;
 
 static int Devices_OpenDir(const char *filename)
 {
@@ -330,7 +330,7 @@ static int Devices_ReadDir(char *fullpath, char *filename, int *isdir,
 
 #elif defined(PS2)
 
-extern char dir_path[FILENAME_MAX];
+extern THREAD_LOCAL char dir_path[FILENAME_MAX];
 
 int Atari_OpenDir(const char *filename);
 
@@ -483,62 +483,67 @@ static UBYTE Devices_RemoveDirectory(const char *filename)
 #define DEFAULT_H_PATH  "H1:>DOS;>DOS"
 
 /* emulator debugging mode */
-static int devbug = FALSE;
+static THREAD_LOCAL int devbug = FALSE;
 
 /* host path for each H: unit */
-char Devices_atari_h_dir[4][FILENAME_MAX];
+THREAD_LOCAL char Devices_atari_h_dir[4][FILENAME_MAX];
 
 /* read only mode for H: device */
-int Devices_h_read_only = TRUE;
+THREAD_LOCAL int Devices_h_read_only = TRUE;
 
 /* ';'-separated list of Atari paths checked by the "load executable"
    command. if a path does not start with "Hn:", then the selected device
    is used. */
-char Devices_h_exe_path[FILENAME_MAX] = DEFAULT_H_PATH;
+THREAD_LOCAL char Devices_h_exe_path[FILENAME_MAX] = DEFAULT_H_PATH;
 
 /* Devices_h_current_dir must be empty or terminated with Util_DIR_SEP_CHAR;
    only Util_DIR_SEP_CHAR can be used as a directory separator here */
-char Devices_h_current_dir[4][FILENAME_MAX];
+THREAD_LOCAL char Devices_h_current_dir[4][FILENAME_MAX];
 
 /* stream open via H: device per IOCB */
-static FILE *h_fp[8] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+static THREAD_LOCAL FILE *h_fp[8] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+/* binary file being loaded via H: device, usually binfile; thread local
+   addresses aren't constant, so binf is set in Devices_Initialise() */
+static THREAD_LOCAL FILE *binfile = NULL;
+static THREAD_LOCAL FILE **binf;
 
 /* H: text mode per IOCB */
-static int h_textmode[8];
+static THREAD_LOCAL int h_textmode[8];
 
 /* H: last read character per IOCB */
-static int h_lastbyte[8];
+static THREAD_LOCAL int h_lastbyte[8];
 
 /* last read character was CR, per IOCB */
-static int h_wascr[8];
+static THREAD_LOCAL int h_wascr[8];
 
 /* last operation: 'o': open, 'r': read, 'w': write, 'p': point, 'b': binary
    load, per IOCB. This is needed to apply fseek(fp, 0, SEEK_CUR) between reads
    and writes in update (12) mode, and to support the read-ahead of 1 byte
    in Devices_h_read. */
-static char h_lastop[8];
+static THREAD_LOCAL char h_lastop[8];
 
 Util_tmpbufdef(static, h_tmpbuf[8])
 
 /* IOCB #, 0-7 */
-static int h_iocb;
+static THREAD_LOCAL int h_iocb;
 
 /* H: device number, 0-3 */
-static int h_devnum;
+static THREAD_LOCAL int h_devnum;
 
 /* filename as specified after "Hn:" */
-static char atari_filename[FILENAME_MAX];
+static THREAD_LOCAL char atari_filename[FILENAME_MAX];
 
 #ifdef DO_RENAME
 /* new filename (no directories!) */
-static char new_filename[FILENAME_MAX];
+static THREAD_LOCAL char new_filename[FILENAME_MAX];
 #endif
 
 /* atari_filename applied to H:'s current dir, with Util_DIR_SEP_CHARs only */
-static char atari_path[FILENAME_MAX];
+static THREAD_LOCAL char atari_path[FILENAME_MAX];
 
 /* full filename for the current operation */
-static char host_path[FILENAME_MAX];
+static THREAD_LOCAL char host_path[FILENAME_MAX];
 
 int Devices_H_CountOpen(void)
 {
@@ -630,6 +635,7 @@ int Devices_Initialise(int *argc, char *argv[])
 		}
 	}
 	*argc = j;
+	binf = &binfile;
 	Devices_H_Init();
 
 	return TRUE;
@@ -1386,10 +1392,8 @@ static void Devices_H_Point(void)
 	}
 }
 
-static FILE *binfile = NULL;
-static FILE **binf = &binfile;
-static int runBinFile;
-static int initBinFile;
+static THREAD_LOCAL int runBinFile;
+static THREAD_LOCAL int initBinFile;
 
 /* Read a word from file */
 static int Devices_H_BinReadWord(void)
@@ -1696,7 +1700,7 @@ static void Devices_H_ChangeDirectory(void)
 
 static void Devices_H_DiskInfo(void)
 {
-	static UBYTE info[16] = {
+	static THREAD_LOCAL UBYTE info[16] = {
 		0x20,                                                  /* disk version: Sparta >= 2.0 */
 		0x00,                                                  /* sector size: 0x100 */
 		0xff, 0xff,                                            /* total sectors: 0xffff */
@@ -1836,7 +1840,7 @@ static void Devices_H_Special(void)
 
 /* P: device emulation --------------------------------------------------- */
 
-char Devices_print_command[256] = "lpr %s";
+THREAD_LOCAL char Devices_print_command[256] = "lpr %s";
 
 int Devices_SetPrintCommand(const char *command)
 {
@@ -1860,8 +1864,8 @@ int Devices_SetPrintCommand(const char *command)
 
 #ifdef HAVE_SYSTEM
 
-static FILE *phf = NULL;
-static char spool_file[FILENAME_MAX];
+static THREAD_LOCAL FILE *phf = NULL;
+static THREAD_LOCAL char spool_file[FILENAME_MAX];
 
 static void Devices_P_Close(void)
 {
@@ -2047,7 +2051,7 @@ static void Devices_K_Read(void)
  * browser access.
  */
 
-struct DEV_B dev_b_status;
+THREAD_LOCAL struct DEV_B dev_b_status;
 
 static void Devices_B_Open(void)
 {
@@ -2130,10 +2134,10 @@ static void Devices_B_Init(void)
 
 /* Atari BASIC loader ---------------------------------------------------- */
 
-static UWORD ehopen_addr = 0;
-static UWORD ehclos_addr = 0;
-static UWORD ehread_addr = 0;
-static UWORD ehwrit_addr = 0;
+static THREAD_LOCAL UWORD ehopen_addr = 0;
+static THREAD_LOCAL UWORD ehclos_addr = 0;
+static THREAD_LOCAL UWORD ehread_addr = 0;
+static THREAD_LOCAL UWORD ehwrit_addr = 0;
 
 static void Devices_IgnoreReady(void);
 static void Devices_GetBasicCommand(void);
@@ -2185,9 +2189,9 @@ static void Devices_InstallIgnoreReady(void)
 
 static const UBYTE * const ready_prompt = (const UBYTE *) "\x9bREADY\x9b";
 
-static const UBYTE *ready_ptr = NULL;
+static THREAD_LOCAL const UBYTE *ready_ptr = NULL;
 
-static const UBYTE *basic_command_ptr = NULL;
+static THREAD_LOCAL const UBYTE *basic_command_ptr = NULL;
 
 static void Devices_IgnoreReady(void)
 {
@@ -2377,10 +2381,10 @@ static void Devices_CloseBasicFile(void)
 
 /* Patches management ---------------------------------------------------- */
 
-int Devices_enable_h_patch = TRUE;
-int Devices_enable_p_patch = TRUE;
-int Devices_enable_r_patch = FALSE;
-int Devices_enable_b_patch = FALSE;
+THREAD_LOCAL int Devices_enable_h_patch = TRUE;
+THREAD_LOCAL int Devices_enable_p_patch = TRUE;
+THREAD_LOCAL int Devices_enable_r_patch = FALSE;
+THREAD_LOCAL int Devices_enable_b_patch = FALSE;
 
 /* Devices_PatchOS is called by ESC_PatchOS to modify standard device
    handlers in Atari OS. It puts escape codes at beginnings of OS routines,
@@ -2554,11 +2558,11 @@ void Devices_RemoveHATABSEntry(char device, UWORD entry_address,
 	}
 }
 
-static UWORD h_entry_address = 0;
+static THREAD_LOCAL UWORD h_entry_address = 0;
 #ifdef R_IO_DEVICE
-static UWORD r_entry_address = 0;
+static THREAD_LOCAL UWORD r_entry_address = 0;
 #endif
-static UWORD b_entry_address = 0;
+static THREAD_LOCAL UWORD b_entry_address = 0;
 
 #define H_DEVICE_BEGIN  0xd140
 #define H_TABLE_ADDRESS 0xd140
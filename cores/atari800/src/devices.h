@@ -12,22 +12,22 @@ void Devices_UpdatePatches(void);
 
 UWORD Devices_SkipDeviceName(void);
 
-extern int Devices_enable_h_patch;
-extern int Devices_enable_p_patch;
-extern int Devices_enable_r_patch;
-extern int Devices_enable_b_patch;
+extern THREAD_LOCAL int Devices_enable_h_patch;
+extern THREAD_LOCAL int Devices_enable_p_patch;
+extern THREAD_LOCAL int Devices_enable_r_patch;
+extern THREAD_LOCAL int Devices_enable_b_patch;
 
-extern char Devices_atari_h_dir[4][FILENAME_MAX];
-extern int Devices_h_read_only;
+extern THREAD_LOCAL char Devices_atari_h_dir[4][FILENAME_MAX];
+extern THREAD_LOCAL int Devices_h_read_only;
 
-extern char Devices_h_exe_path[FILENAME_MAX];
+extern THREAD_LOCAL char Devices_h_exe_path[FILENAME_MAX];
 
-extern char Devices_h_current_dir[4][FILENAME_MAX];
+extern THREAD_LOCAL char Devices_h_current_dir[4][FILENAME_MAX];
 
 int Devices_H_CountOpen(void);
 void Devices_H_CloseAll(void);
 
-extern char Devices_print_command[256];
+extern THREAD_LOCAL char Devices_print_command[256];
 
 int Devices_SetPrintCommand(const char *command);
 
@@ -37,7 +37,7 @@ struct DEV_B
 	int  pos;
 	int  ready;
 };
-extern struct DEV_B dev_b_status;
+extern THREAD_LOCAL struct DEV_B dev_b_status;
 
 
 #define	Devices_ICHIDZ	0x0020
@@ -2,7 +2,7 @@
 #define ESC_H_
 
 /* TRUE to enable patched (fast) Serial I/O. */
-extern int ESC_enable_sio_patch;
+extern THREAD_LOCAL int ESC_enable_sio_patch;
 
 /* Escape codes used to mark places in 6502 code that must
    be handled specially by the emulator. An escape sequence
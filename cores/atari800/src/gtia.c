@@ -39,53 +39,53 @@
 
 /* GTIA Registers ---------------------------------------------------------- */
 
-UBYTE GTIA_M0PL;
-UBYTE GTIA_M1PL;
-UBYTE GTIA_M2PL;
-UBYTE GTIA_M3PL;
-UBYTE GTIA_P0PL;
-UBYTE GTIA_P1PL;
-UBYTE GTIA_P2PL;
-UBYTE GTIA_P3PL;
-UBYTE GTIA_HPOSP0;
-UBYTE GTIA_HPOSP1;
-UBYTE GTIA_HPOSP2;
-UBYTE GTIA_HPOSP3;
-UBYTE GTIA_HPOSM0;
-UBYTE GTIA_HPOSM1;
-UBYTE GTIA_HPOSM2;
-UBYTE GTIA_HPOSM3;
-UBYTE GTIA_SIZEP0;
-UBYTE GTIA_SIZEP1;
-UBYTE GTIA_SIZEP2;
-UBYTE GTIA_SIZEP3;
-UBYTE GTIA_SIZEM;
-UBYTE GTIA_GRAFP0;
-UBYTE GTIA_GRAFP1;
-UBYTE GTIA_GRAFP2;
-UBYTE GTIA_GRAFP3;
-UBYTE GTIA_GRAFM;
-UBYTE GTIA_COLPM0;
-UBYTE GTIA_COLPM1;
-UBYTE GTIA_COLPM2;
-UBYTE GTIA_COLPM3;
-UBYTE GTIA_COLPF0;
-UBYTE GTIA_COLPF1;
-UBYTE GTIA_COLPF2;
-UBYTE GTIA_COLPF3;
-UBYTE GTIA_COLBK;
-UBYTE GTIA_PRIOR;
-UBYTE GTIA_VDELAY;
-UBYTE GTIA_GRACTL;
+THREAD_LOCAL UBYTE GTIA_M0PL;
+THREAD_LOCAL UBYTE GTIA_M1PL;
+THREAD_LOCAL UBYTE GTIA_M2PL;
+THREAD_LOCAL UBYTE GTIA_M3PL;
+THREAD_LOCAL UBYTE GTIA_P0PL;
+THREAD_LOCAL UBYTE GTIA_P1PL;
+THREAD_LOCAL UBYTE GTIA_P2PL;
+THREAD_LOCAL UBYTE GTIA_P3PL;
+THREAD_LOCAL UBYTE GTIA_HPOSP0;
+THREAD_LOCAL UBYTE GTIA_HPOSP1;
+THREAD_LOCAL UBYTE GTIA_HPOSP2;
+THREAD_LOCAL UBYTE GTIA_HPOSP3;
+THREAD_LOCAL UBYTE GTIA_HPOSM0;
+THREAD_LOCAL UBYTE GTIA_HPOSM1;
+THREAD_LOCAL UBYTE GTIA_HPOSM2;
+THREAD_LOCAL UBYTE GTIA_HPOSM3;
+THREAD_LOCAL UBYTE GTIA_SIZEP0;
+THREAD_LOCAL UBYTE GTIA_SIZEP1;
+THREAD_LOCAL UBYTE GTIA_SIZEP2;
+THREAD_LOCAL UBYTE GTIA_SIZEP3;
+THREAD_LOCAL UBYTE GTIA_SIZEM;
+THREAD_LOCAL UBYTE GTIA_GRAFP0;
+THREAD_LOCAL UBYTE GTIA_GRAFP1;
+THREAD_LOCAL UBYTE GTIA_GRAFP2;
+THREAD_LOCAL UBYTE GTIA_GRAFP3;
+THREAD_LOCAL UBYTE GTIA_GRAFM;
+THREAD_LOCAL UBYTE GTIA_COLPM0;
+THREAD_LOCAL UBYTE GTIA_COLPM1;
+THREAD_LOCAL UBYTE GTIA_COLPM2;
+THREAD_LOCAL UBYTE GTIA_COLPM3;
+THREAD_LOCAL UBYTE GTIA_COLPF0;
+THREAD_LOCAL UBYTE GTIA_COLPF1;
+THREAD_LOCAL UBYTE GTIA_COLPF2;
+THREAD_LOCAL UBYTE GTIA_COLPF3;
+THREAD_LOCAL UBYTE GTIA_COLBK;
+THREAD_LOCAL UBYTE GTIA_PRIOR;
+THREAD_LOCAL UBYTE GTIA_VDELAY;
+THREAD_LOCAL UBYTE GTIA_GRACTL;
 
 /* Internal GTIA state ----------------------------------------------------- */
 
-int GTIA_speaker;
-int GTIA_consol_override = 0;
-static UBYTE consol;
-UBYTE consol_mask;
-UBYTE GTIA_TRIG[4];
-UBYTE GTIA_TRIG_latch[4];
+THREAD_LOCAL int GTIA_speaker;
+THREAD_LOCAL int GTIA_consol_override = 0;
+static THREAD_LOCAL UBYTE consol;
+THREAD_LOCAL UBYTE consol_mask;
+THREAD_LOCAL UBYTE GTIA_TRIG[4];
+THREAD_LOCAL UBYTE GTIA_TRIG_latch[4];
 
 #if defined(BASIC) || defined(CURSES_BASIC)
 
@@ -105,10 +105,10 @@ void set_prior(UBYTE byte);			/* in antic.c */
 /* Player/Missile stuff ---------------------------------------------------- */
 
 /* change to 0x00 to disable collisions */
-UBYTE GTIA_collisions_mask_missile_playfield = 0x0f;
-UBYTE GTIA_collisions_mask_player_playfield = 0x0f;
-UBYTE GTIA_collisions_mask_missile_player = 0x0f;
-UBYTE GTIA_collisions_mask_player_player = 0x0f;
+THREAD_LOCAL UBYTE GTIA_collisions_mask_missile_playfield = 0x0f;
+THREAD_LOCAL UBYTE GTIA_collisions_mask_player_playfield = 0x0f;
+THREAD_LOCAL UBYTE GTIA_collisions_mask_missile_player = 0x0f;
+THREAD_LOCAL UBYTE GTIA_collisions_mask_player_player = 0x0f;
 
 #ifdef NEW_CYCLE_EXACT
 /* temporary collision registers for the current scanline only */
@@ -138,13 +138,13 @@ int hitclr_pos;
 #define M3PL_T GTIA_M3PL
 #endif /* NEW_CYCLE_EXACT */
 
-static UBYTE *hposp_ptr[4];
-static UBYTE *hposm_ptr[4];
-static ULONG hposp_mask[4];
+static THREAD_LOCAL UBYTE *hposp_ptr[4];
+static THREAD_LOCAL UBYTE *hposm_ptr[4];
+static THREAD_LOCAL ULONG hposp_mask[4];
 
-static ULONG grafp_lookup[4][256];
-static ULONG *grafp_ptr[4];
-static int global_sizem[4];
+static THREAD_LOCAL ULONG grafp_lookup[4][256];
+static THREAD_LOCAL ULONG *grafp_ptr[4];
+static THREAD_LOCAL int global_sizem[4];
 
 static const int PM_Width[4] = {1, 2, 1, 4};
 
@@ -159,8 +159,8 @@ bit 6 - Missile 2
 bit 7 - Missile 3
 */
 
-UBYTE GTIA_pm_scanline[Screen_WIDTH / 2 + 8];	/* there's a byte for every *pair* of pixels */
-int GTIA_pm_dirty = TRUE;
+THREAD_LOCAL UBYTE GTIA_pm_scanline[Screen_WIDTH / 2 + 8];	/* there's a byte for every *pair* of pixels */
+THREAD_LOCAL int GTIA_pm_dirty = TRUE;
 
 #define C_PM0	0x01
 #define C_PM1	0x02
@@ -87,11 +87,11 @@
 #  define PRId64 "lld"
 #endif
 
-int IDE_enabled = 0, IDE_debug = 0;
+THREAD_LOCAL int IDE_enabled = 0, IDE_debug = 0;
 
-struct ide_device device;
+THREAD_LOCAL struct ide_device device;
 
-static int count = 0;     /* for debug stuff */
+static THREAD_LOCAL int count = 0;     /* for debug stuff */
 
 static inline void padstr(uint8_t *str, const char *src, int len) {
     int i;
@@ -0,0 +1,290 @@
+/*
+ * libatari800/batch_runner.c - run a directory of images on parallel emulators
+ *
+ * Copyright (C) 2020 Atari800 development team (see DOC/CREDITS)
+ *
+ * This file is part of the Atari800 emulator project which emulates
+ * the Atari 400, 800, 800XL, 130XE, and 5200 8-bit computers.
+ *
+ * Atari800 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Atari800 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Atari800; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/* Usage: batch_runner [-threads n] [-frames n] [-scaling] directory [-- atari800 options]
+
+   Runs every image in the directory for the given number of frames, each on
+   a freshly initialised emulator.  libatari800 keeps the emulator state in
+   thread local storage, so every worker thread runs its own emulator.
+
+   For each image it prints the number of frames run, the error that stopped
+   it, if any, and a hash of the final screen, which doesn't depend on the
+   number of threads.  At the end it prints the aggregate frames per second.
+   With -scaling, the batch is run with 1, 2, 4, ... threads up to the given
+   number, and the speedup over one thread is reported for each. */
+
+#include <ctype.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libatari800.h"
+
+#define SCREEN_SIZE (384 * 240)
+#define MAX_ARGS 64
+
+typedef struct {
+	char *path;
+	int frames;
+	const char *error;
+	unsigned long screen_hash;
+	double seconds;
+} image_t;
+
+static const char *extensions[] = {
+	"atr", "atx", "xfd", "dcm", "xex", "com", "exe", "car", "rom", "cas", NULL
+};
+
+static image_t *images;
+static int num_images;
+static int next_image;
+static pthread_mutex_t next_image_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int frames_per_image = 600;
+static char **extra_args;
+static int num_extra_args;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int has_image_extension(const char *name)
+{
+	const char *dot = strrchr(name, '.');
+	char ext[8];
+	int i;
+
+	if (dot == NULL || strlen(dot + 1) >= sizeof(ext))
+		return 0;
+	for (i = 0; dot[i + 1] != '\0'; i++)
+		ext[i] = tolower((unsigned char) dot[i + 1]);
+	ext[i] = '\0';
+	for (i = 0; extensions[i] != NULL; i++) {
+		if (strcmp(ext, extensions[i]) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+static int compare_images(const void *a, const void *b)
+{
+	return strcmp(((const image_t *) a)->path, ((const image_t *) b)->path);
+}
+
+static int read_directory(const char *directory)
+{
+	DIR *dir;
+	struct dirent *entry;
+	int size = 0;
+
+	if ((dir = opendir(directory)) == NULL) {
+		perror(directory);
+		return 0;
+	}
+	while ((entry = readdir(dir)) != NULL) {
+		if (!has_image_extension(entry->d_name))
+			continue;
+		if (num_images == size) {
+			size = size ? size * 2 : 64;
+			images = realloc(images, size * sizeof(image_t));
+		}
+		images[num_images].path = malloc(strlen(directory) + strlen(entry->d_name) + 2);
+		sprintf(images[num_images].path, "%s/%s", directory, entry->d_name);
+		num_images++;
+	}
+	closedir(dir);
+
+	/* Sorted, so the report is in the same order on every run. */
+	qsort(images, num_images, sizeof(image_t), compare_images);
+	return 1;
+}
+
+static unsigned long hash_screen(void)
+{
+	const UBYTE *screen = libatari800_get_screen_ptr();
+	unsigned long hash = 5381;
+	int i;
+
+	for (i = 0; i < SCREEN_SIZE; i++)
+		hash = hash * 33 + screen[i];
+	return hash;
+}
+
+static void run_image(image_t *image)
+{
+	char *args[MAX_ARGS];
+	int argc = 0;
+	int i;
+	input_template_t input;
+	double start = now();
+
+	args[argc++] = "atari800";
+	for (i = 0; i < num_extra_args && argc < MAX_ARGS - 2; i++)
+		args[argc++] = extra_args[i];
+	args[argc++] = image->path;
+	args[argc] = NULL;
+
+	image->frames = 0;
+	image->error = NULL;
+	if (!libatari800_init(argc, args)) {
+		image->error = "initialisation failed";
+	}
+	else {
+		libatari800_clear_input_array(&input);
+		while (image->frames < frames_per_image) {
+			image->frames++;
+			/* The display list is also missing while the OS boots, so only
+			   stop on a crash. */
+			if (!libatari800_next_frame(&input)
+			    && libatari800_error_code != LIBATARI800_DLIST_ERROR) {
+				image->error = libatari800_error_message();
+				break;
+			}
+		}
+	}
+	image->screen_hash = hash_screen();
+	image->seconds = now() - start;
+}
+
+static void *worker(void *arg)
+{
+	for (;;) {
+		int i;
+
+		pthread_mutex_lock(&next_image_mutex);
+		i = next_image++;
+		pthread_mutex_unlock(&next_image_mutex);
+
+		if (i >= num_images)
+			break;
+		run_image(&images[i]);
+	}
+	return NULL;
+}
+
+/* Run all images on the given number of threads, return total frames. */
+static long run_batch(int num_threads, double *seconds)
+{
+	pthread_t *threads = malloc(num_threads * sizeof(pthread_t));
+	double start = now();
+	long frames = 0;
+	int i;
+
+	next_image = 0;
+	for (i = 0; i < num_threads; i++)
+		pthread_create(&threads[i], NULL, worker, NULL);
+	for (i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+	*seconds = now() - start;
+	free(threads);
+
+	for (i = 0; i < num_images; i++)
+		frames += images[i].frames;
+	return frames;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-threads n] [-frames n] [-scaling] directory [-- atari800 options]\n", name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	int num_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	int scaling = 0;
+	const char *directory = NULL;
+	double seconds;
+	long frames;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc)
+			num_threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+			frames_per_image = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-scaling") == 0)
+			scaling = 1;
+		else if (strcmp(argv[i], "--") == 0) {
+			extra_args = argv + i + 1;
+			num_extra_args = argc - i - 1;
+			break;
+		}
+		else if (argv[i][0] != '-' && directory == NULL)
+			directory = argv[i];
+		else
+			usage(argv[0]);
+	}
+	if (directory == NULL || num_threads < 1 || frames_per_image < 1)
+		usage(argv[0]);
+
+	if (!read_directory(directory))
+		return 1;
+	if (num_images == 0) {
+		fprintf(stderr, "%s: no images found\n", directory);
+		return 1;
+	}
+
+	if (scaling) {
+		double base = 0;
+		int n;
+
+		printf("%7s %9s %11s %8s %10s\n", "threads", "seconds", "frames/sec", "speedup", "efficiency");
+		for (n = 1; ; n = n * 2 < num_threads ? n * 2 : num_threads) {
+			double fps;
+
+			frames = run_batch(n, &seconds);
+			fps = frames / seconds;
+			if (n == 1)
+				base = fps;
+			printf("%7d %9.2f %11.0f %8.2f %9.0f%%\n", n, seconds, fps, fps / base, fps / base / n * 100);
+			if (n == num_threads)
+				break;
+		}
+	}
+	else
+		frames = run_batch(num_threads, &seconds);
+
+	for (i = 0; i < num_images; i++) {
+		image_t *image = &images[i];
+		printf("%s: %d frames, %.0f frames/sec, screen %08lx%s%s\n", image->path, image->frames,
+		       image->frames / image->seconds, image->screen_hash & 0xffffffff,
+		       image->error ? ", stopped: " : "", image->error ? image->error : "");
+	}
+	printf("%d images, %ld frames in %.2f seconds on %d threads: %.0f frames/sec\n",
+	       num_images, frames, seconds, num_threads, frames / seconds);
+
+	return 0;
+}
+
+/*
+vim:ts=4:sw=4:
+*/
@@ -35,9 +35,9 @@
 #include "pokey.h"
 #include "libatari800/statesav.h"
 
-static int lastkey = -1, key_control = 0;
+static THREAD_LOCAL int lastkey = -1, key_control = 0;
 
-input_template_t *LIBATARI800_Input_array = NULL;
+THREAD_LOCAL input_template_t *LIBATARI800_Input_array = NULL;
 
 
 int PLATFORM_Keyboard(void)
@@ -176,7 +176,11 @@ typedef struct {
     int Base_mult[4];
 } pokey_state_t;
 
-extern int libatari800_error_code;
+/* Each thread has its own emulator: all functions operate on the emulator
+   of the calling thread. Like errno, libatari800_error_code is the error
+   code of the calling thread's emulator. */
+int *libatari800_error_code_location(void);
+#define libatari800_error_code (*libatari800_error_code_location())
 #define LIBATARI800_UNIDENTIFIED_CART_TYPE 1
 #define LIBATARI800_CPU_CRASH 2
 #define LIBATARI800_BRK_INSTRUCTION 3
@@ -64,7 +64,7 @@
 #include "votraxsnd.h"
 #endif
 
-extern int debug_sound;
+extern THREAD_LOCAL int debug_sound;
 
 int PLATFORM_Configure(char *option, char *parameters)
 {
@@ -152,7 +152,12 @@ void LIBATARI800_Frame(void)
 
 /* Stub routines to replace text-based UI */
 
-int libatari800_error_code;
+static THREAD_LOCAL int error_code;
+
+int *libatari800_error_code_location(void)
+{
+	return &error_code;
+}
 
 int UI_SelectCartType(int k) {
 	libatari800_error_code = LIBATARI800_UNIDENTIFIED_CART_TYPE;
@@ -163,14 +168,18 @@ void UI_Run(void) {
 	;
 }
 
-int UI_is_active;
-int UI_alt_function;
-int UI_current_function;
-char UI_atari_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
-char UI_saved_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
-int UI_n_atari_files_dir;
-int UI_n_saved_files_dir;
-int UI_show_hidden_files = FALSE;
+int UI_Initialise(int *argc, char *argv[]) {
+	return TRUE;
+}
+
+THREAD_LOCAL int UI_is_active;
+THREAD_LOCAL int UI_alt_function;
+THREAD_LOCAL int UI_current_function;
+THREAD_LOCAL char UI_atari_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
+THREAD_LOCAL char UI_saved_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
+THREAD_LOCAL int UI_n_atari_files_dir;
+THREAD_LOCAL int UI_n_saved_files_dir;
+THREAD_LOCAL int UI_show_hidden_files = FALSE;
 
 /* User visible routines */
 
@@ -209,7 +218,7 @@ void libatari800_clear_input_array(input_template_t *input)
 }
 
 #ifdef HAVE_SETJMP
-jmp_buf libatari800_cpu_crash;
+THREAD_LOCAL jmp_buf libatari800_cpu_crash;
 #endif
 
 int libatari800_next_frame(input_template_t *input)
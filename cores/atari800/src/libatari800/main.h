@@ -7,7 +7,7 @@
 
 #ifdef HAVE_SETJMP
 #include <setjmp.h>
-extern jmp_buf libatari800_cpu_crash;
+extern THREAD_LOCAL jmp_buf libatari800_cpu_crash;
 #endif /* HAVE_SETJMP */
 
 #include "libatari800/libatari800.h"
@@ -0,0 +1,185 @@
+/*
+ * libatari800/pokey_benchmark.c - compare the speed and output of the POKEY resamplers
+ *
+ * Copyright (C) 2020 Atari800 development team (see DOC/CREDITS)
+ *
+ * This file is part of the Atari800 emulator project which emulates
+ * the Atari 400, 800, 800XL, 130XE, and 5200 8-bit computers.
+ *
+ * Atari800 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Atari800 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Atari800; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/* Usage: pokey_benchmark [seconds]
+
+   Plays the same pseudo random register writes on two POKEYs (stereo) at
+   44.1 and 48 kHz with each resampler of mzpokeysnd, and reports the time
+   taken, the largest difference of the block resampler to the exact one in
+   16-bit sample units, and how many 16-bit output samples differ.
+
+   The "music" writes use all dividers and clocks; the "high" ones use small
+   dividers and the 1.79 MHz clock, which keeps the event queue long. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "atari.h"
+#include "mzpokeysnd.h"
+#include "pokey.h"
+#include "pokeysnd.h"
+
+#define WRITES_PER_FRAME 16
+
+typedef struct {
+	const char *name;
+	UBYTE audctl_set;	/* bits set in every AUDCTL write */
+	UBYTE audf_mask;	/* bits kept in every AUDF write */
+} workload_t;
+
+static const workload_t workloads[] = {
+	{ "music", 0x00, 0xff },
+	{ "high", 0x60, 0x3f }
+};
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* The register writes must not depend on rand(), which does the dithering. */
+static unsigned int random_state;
+
+static unsigned int next_random(void)
+{
+	random_state = random_state * 1103515245 + 12345;
+	return random_state >> 16;
+}
+
+static void write_register(const workload_t *workload, unsigned int r)
+{
+	static const UBYTE distortions[] = { 0xa0, 0xa0, 0xc0, 0x20, 0x80, 0x00 };
+	UBYTE chip = (r >> 8) & 1;
+	UBYTE channel = (r >> 9) & 3;
+	UBYTE val = (UBYTE) r;
+
+	switch ((r >> 11) & 7) {
+	case 0:
+		POKEYSND_Update_ptr(POKEY_OFFSET_AUDCTL, (val & 0x7f) | workload->audctl_set, chip, 0);
+		break;
+	case 1:
+	case 2:
+	case 3:
+		POKEYSND_Update_ptr(POKEY_OFFSET_AUDC1 + 2 * channel, distortions[val % 6] | (val & 0x0f), chip, 0);
+		break;
+	default:
+		POKEYSND_Update_ptr(POKEY_OFFSET_AUDF1 + 2 * channel, val & workload->audf_mask, chip, 0);
+		break;
+	}
+}
+
+/* Generates the given number of frames with the given resampler; if output is
+   not NULL, stores the samples there. Returns the time taken. */
+static double run(const workload_t *workload, int rate, int resampler, int frames, SWORD *output, size_t *count)
+{
+	unsigned int ticks_per_frame = Atari800_tv_mode * 114;
+	double start;
+	int frame, i;
+
+	POKEYSND_Init(POKEYSND_FREQ_17_EXACT, rate, 2, POKEYSND_BIT16);
+	MZPOKEYSND_resampler = resampler;
+	MZPOKEYSND_resampler_max_error = 0.0;
+	random_state = 1;
+	srand(1);
+	/* Take both POKEYs out of the reset state. */
+	POKEYSND_Update_ptr(POKEY_OFFSET_SKCTL, 3, 0, 0);
+	POKEYSND_Update_ptr(POKEY_OFFSET_SKCTL, 3, 1, 0);
+	*count = 0;
+
+	start = now();
+	for (frame = 0; frame < frames; frame++) {
+		unsigned int tick = 0;
+
+		POKEYSND_process_buffer_fill = 0;
+		for (i = 0; i < WRITES_PER_FRAME; i++) {
+			unsigned int next = ticks_per_frame * (i + 1) / (WRITES_PER_FRAME + 1);
+
+			POKEYSND_GenerateSync(next - tick);
+			tick = next;
+			write_register(workload, next_random());
+		}
+		POKEYSND_GenerateSync(ticks_per_frame - tick);
+		if (output != NULL) {
+			memcpy(output + *count, POKEYSND_process_buffer, POKEYSND_process_buffer_fill);
+		}
+		*count += POKEYSND_process_buffer_fill / 2;
+	}
+	return now() - start;
+}
+
+static void bench(const workload_t *workload, int rate, int frames)
+{
+	size_t samples = (size_t) frames * (rate / 49 + 2) * 2;
+	SWORD *exact = calloc(samples, sizeof(SWORD));
+	SWORD *block = calloc(samples, sizeof(SWORD));
+	double exact_time, block_time;
+	size_t i, count, differ = 0;
+
+	exact_time = run(workload, rate, MZPOKEYSND_RESAMPLER_EXACT, frames, exact, &count);
+	block_time = run(workload, rate, MZPOKEYSND_RESAMPLER_BLOCK, frames, block, &count);
+	MZPOKEYSND_resampler_check = TRUE;
+	run(workload, rate, MZPOKEYSND_RESAMPLER_BLOCK, frames, NULL, &count);
+	MZPOKEYSND_resampler_check = FALSE;
+
+	for (i = 0; i < count; i++) {
+		if (exact[i] != block[i])
+			differ++;
+	}
+	printf("%-6s %6d %10.2f %10.2f %8.2f %10.4f %7.3f%%\n", workload->name, rate, exact_time, block_time,
+	       exact_time / block_time, MZPOKEYSND_resampler_max_error, 100.0 * differ / count);
+	free(exact);
+	free(block);
+}
+
+int main(int argc, char **argv)
+{
+	static const int rates[] = { 44100, 48000 };
+	double seconds = argc > 1 ? atof(argv[1]) : 30.0;
+	int frames = (int) (seconds * Atari800_FPS_PAL);
+	int w, r;
+
+	if (frames < 1) {
+		fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+		return 1;
+	}
+	Atari800_tv_mode = Atari800_TV_PAL;
+
+	printf("%d frames of two POKEYs\n", frames);
+	printf("%-6s %6s %10s %10s %8s %10s %8s\n", "writes", "rate", "exact s", "block s", "speedup", "max error", "differ");
+	for (w = 0; w < (int) (sizeof(workloads) / sizeof(workloads[0])); w++) {
+		for (r = 0; r < (int) (sizeof(rates) / sizeof(rates[0])); r++)
+			bench(&workloads[w], rates[r], frames);
+	}
+
+	return 0;
+}
+
+/*
+vim:ts=4:sw=4:
+*/
@@ -33,11 +33,11 @@
 #include "sound.h"
 #include "util.h"
 
-int debug_sound;
+THREAD_LOCAL int debug_sound;
 
-UBYTE *LIBATARI800_Sound_array;
+THREAD_LOCAL UBYTE *LIBATARI800_Sound_array;
 
-static unsigned int hw_buffer_size = 0;
+static THREAD_LOCAL unsigned int hw_buffer_size = 0;
 
 int PLATFORM_SoundSetup(Sound_setup_t *setup)
 {
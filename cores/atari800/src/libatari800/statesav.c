@@ -30,8 +30,8 @@
 #include "libatari800/statesav.h"
 #include "libatari800/init.h"
 
-UBYTE *LIBATARI800_StateSav_buffer = NULL;
-statesav_tags_t *LIBATARI800_StateSav_tags = NULL;
+THREAD_LOCAL UBYTE *LIBATARI800_StateSav_buffer = NULL;
+THREAD_LOCAL statesav_tags_t *LIBATARI800_StateSav_tags = NULL;
 
 
 void LIBATARI800_StateSave(UBYTE *buffer, statesav_tags_t *tags) {
@@ -9,8 +9,8 @@
 #include "../statesav.h"
 #include "libatari800/libatari800.h"
 
-extern UBYTE *LIBATARI800_StateSav_buffer;
-extern statesav_tags_t *LIBATARI800_StateSav_tags;
+extern THREAD_LOCAL UBYTE *LIBATARI800_StateSav_buffer;
+extern THREAD_LOCAL statesav_tags_t *LIBATARI800_StateSav_tags;
 
 void LIBATARI800_StateSave(UBYTE *buffer, statesav_tags_t *tags);
 void LIBATARI800_StateLoad(UBYTE *buffer);
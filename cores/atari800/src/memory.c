@@ -44,13 +44,13 @@
 #include "statesav.h"
 #endif
 
-UBYTE MEMORY_mem[65536 + 2];
+THREAD_LOCAL UBYTE MEMORY_mem[65536 + 2];
 
-int MEMORY_ram_size = 64;
+THREAD_LOCAL int MEMORY_ram_size = 64;
 
 #ifndef PAGED_ATTRIB
 
-UBYTE MEMORY_attrib[65536];
+THREAD_LOCAL UBYTE MEMORY_attrib[65536];
 
 #else /* PAGED_ATTRIB */
 
@@ -74,48 +74,48 @@ map_save save_map[2] = {
 
 #endif /* PAGED_ATTRIB */
 
-UBYTE MEMORY_basic[8192];
-UBYTE MEMORY_os[16384];
-UBYTE MEMORY_xegame[8192];
+THREAD_LOCAL UBYTE MEMORY_basic[8192];
+THREAD_LOCAL UBYTE MEMORY_os[16384];
+THREAD_LOCAL UBYTE MEMORY_xegame[8192];
 
-int MEMORY_xe_bank = 0;
-int MEMORY_selftest_enabled = 0;
+THREAD_LOCAL int MEMORY_xe_bank = 0;
+THREAD_LOCAL int MEMORY_selftest_enabled = 0;
 
-static UBYTE under_atarixl_os[16384];
-static UBYTE under_cart809F[8192];
-static UBYTE under_cartA0BF[8192];
+static THREAD_LOCAL UBYTE under_atarixl_os[16384];
+static THREAD_LOCAL UBYTE under_cart809F[8192];
+static THREAD_LOCAL UBYTE under_cartA0BF[8192];
 
-static int cart809F_enabled = FALSE;
-int MEMORY_cartA0BF_enabled = FALSE;
+static THREAD_LOCAL int cart809F_enabled = FALSE;
+THREAD_LOCAL int MEMORY_cartA0BF_enabled = FALSE;
 
-static UBYTE *atarixe_memory = NULL;
-static ULONG atarixe_memory_size = 0;
+static THREAD_LOCAL UBYTE *atarixe_memory = NULL;
+static THREAD_LOCAL ULONG atarixe_memory_size = 0;
 
 /* RAM shadowed by Self-Test in the XE bank seen by ANTIC, when ANTIC/CPU
    separate XE access is active. */
-static UBYTE antic_bank_under_selftest[0x800];
+static THREAD_LOCAL UBYTE antic_bank_under_selftest[0x800];
 
-int MEMORY_have_basic = FALSE; /* Atari BASIC image has been successfully read (Atari 800 only) */
+THREAD_LOCAL int MEMORY_have_basic = FALSE; /* Atari BASIC image has been successfully read (Atari 800 only) */
 
 /* Axlon and Mosaic RAM expansions for Atari 400/800 only */
 static void MosaicPutByte(UWORD addr, UBYTE byte);
 static UBYTE MosaicGetByte(UWORD addr, int no_side_effects);
 static void AxlonPutByte(UWORD addr, UBYTE byte);
 static UBYTE AxlonGetByte(UWORD addr, int no_side_effects);
-static UBYTE *axlon_ram = NULL;
-static int axlon_current_bankmask = 0;
-int axlon_curbank = 0;
-int MEMORY_axlon_num_banks = 0x00;
-int MEMORY_axlon_0f_mirror = FALSE; /* The real Axlon had a mirror bank register at 0x0fc0-0x0fff, compatibles did not*/
-static UBYTE *mosaic_ram = NULL;
-static int mosaic_current_num_banks = 0;
-static int mosaic_curbank = 0x3f;
-int MEMORY_mosaic_num_banks = 0;
-
-int MEMORY_enable_mapram = FALSE;
+static THREAD_LOCAL UBYTE *axlon_ram = NULL;
+static THREAD_LOCAL int axlon_current_bankmask = 0;
+THREAD_LOCAL int axlon_curbank = 0;
+THREAD_LOCAL int MEMORY_axlon_num_banks = 0x00;
+THREAD_LOCAL int MEMORY_axlon_0f_mirror = FALSE; /* The real Axlon had a mirror bank register at 0x0fc0-0x0fff, compatibles did not*/
+static THREAD_LOCAL UBYTE *mosaic_ram = NULL;
+static THREAD_LOCAL int mosaic_current_num_banks = 0;
+static THREAD_LOCAL int mosaic_curbank = 0x3f;
+THREAD_LOCAL int MEMORY_mosaic_num_banks = 0;
+
+THREAD_LOCAL int MEMORY_enable_mapram = FALSE;
 
 /* Buffer for storing of MapRAM memory. */
-static UBYTE *mapram_memory = NULL;
+static THREAD_LOCAL UBYTE *mapram_memory = NULL;
 
 static void alloc_axlon_memory(void){
 	if (MEMORY_axlon_num_banks > 0 && Atari800_machine_type == Atari800_MACHINE_800) {
@@ -35,7 +35,7 @@
 #define MEMORY_dCopyToMem(from, to, size)		memcpy(MEMORY_mem + (to), from, size)
 #define MEMORY_dFillMem(addr1, value, length)	memset(MEMORY_mem + (addr1), value, length)
 
-extern UBYTE MEMORY_mem[65536 + 2];
+extern THREAD_LOCAL UBYTE MEMORY_mem[65536 + 2];
 
 /* RAM size in kilobytes.
    Valid values for Atari800_MACHINE_800 are: 16, 48, 52.
@@ -44,7 +44,7 @@ extern UBYTE MEMORY_mem[65536 + 2];
    The only valid value for Atari800_MACHINE_5200 is 16. */
 #define MEMORY_RAM_320_RAMBO       320
 #define MEMORY_RAM_320_COMPY_SHOP  321
-extern int MEMORY_ram_size;
+extern THREAD_LOCAL int MEMORY_ram_size;
 
 #define MEMORY_RAM       0
 #define MEMORY_ROM       1
@@ -52,7 +52,7 @@ extern int MEMORY_ram_size;
 
 #ifndef PAGED_ATTRIB
 
-extern UBYTE MEMORY_attrib[65536];
+extern THREAD_LOCAL UBYTE MEMORY_attrib[65536];
 /* Reads a byte from ADDR. Can potentially have side effects, when reading
    from hardware area. */
 #define MEMORY_GetByte(addr)		(MEMORY_attrib[addr] == MEMORY_HARDWARE ? MEMORY_HwGetByte(addr, FALSE) : MEMORY_mem[addr])
@@ -94,15 +94,15 @@ void MEMORY_ROM_PutByte(UWORD addr, UBYTE byte);
 
 #endif /* PAGED_ATTRIB */
 
-extern UBYTE MEMORY_basic[8192];
-extern UBYTE MEMORY_os[16384];
-extern UBYTE MEMORY_xegame[8192];
+extern THREAD_LOCAL UBYTE MEMORY_basic[8192];
+extern THREAD_LOCAL UBYTE MEMORY_os[16384];
+extern THREAD_LOCAL UBYTE MEMORY_xegame[8192];
 
-extern int MEMORY_xe_bank;
-extern int MEMORY_selftest_enabled;
+extern THREAD_LOCAL int MEMORY_xe_bank;
+extern THREAD_LOCAL int MEMORY_selftest_enabled;
 
-extern int MEMORY_have_basic;
-extern int MEMORY_cartA0BF_enabled;
+extern THREAD_LOCAL int MEMORY_have_basic;
+extern THREAD_LOCAL int MEMORY_cartA0BF_enabled;
 
 /* Verifies if SIZE is a correct value for RAM size. */
 int MEMORY_SizeValid(int size);
@@ -120,12 +120,12 @@ void MEMORY_CartA0bfEnable(void);
 void MEMORY_GetCharset(UBYTE *cs);
 
 /* Mosaic and Axlon 400/800 RAM extensions */
-extern int MEMORY_mosaic_num_banks;
-extern int MEMORY_axlon_0f_mirror;
-extern int MEMORY_axlon_num_banks;
+extern THREAD_LOCAL int MEMORY_mosaic_num_banks;
+extern THREAD_LOCAL int MEMORY_axlon_0f_mirror;
+extern THREAD_LOCAL int MEMORY_axlon_num_banks;
 
 /* Controls presence of MapRAM memory modification for XL/XE mode. */
-extern int MEMORY_enable_mapram;
+extern THREAD_LOCAL int MEMORY_enable_mapram;
 
 #ifndef PAGED_MEM
 /* Reads a byte from the specified special address (not RAM or ROM). */
@@ -93,8 +93,8 @@ void monitor_printf(const char *format, ...)
 
 #endif /* __PLUS */
 
-UBYTE *trainer_memory = NULL;
-UBYTE *trainer_flags = NULL;
+THREAD_LOCAL UBYTE *trainer_memory = NULL;
+THREAD_LOCAL UBYTE *trainer_flags = NULL;
 
 #ifdef MONITOR_TRACE
 FILE *MONITOR_trace_file = NULL;
@@ -732,7 +732,7 @@ static int pager(void)
 	return buf[0] == 'q' || buf[0] == 'Q';
 }
 
-static char *token_ptr;
+static THREAD_LOCAL char *token_ptr;
 
 static char *get_token(void)
 {
@@ -2001,7 +2001,7 @@ static void coverage_ranges(UWORD start, UWORD end)
 static void coverage(void)
 {
 	/* save these across calls, to save typing (and remembering) */
-	static UWORD start = 0, end = 0xffff;
+	static THREAD_LOCAL UWORD start = 0, end = 0xffff;
 	static char cc = '?';
 
 	unsigned int i, cov = 0, full = FALSE, hogs = FALSE, hog_count = 0, ranges = FALSE;
@@ -2500,10 +2500,10 @@ static void trainer_print_addresses(void)
 static void monitor_search_mem(void)
 {
 	/* static, so "S" without arguments repeats last search */
-	static int n = 0;
-	static UWORD addr1;
-	static UWORD addr2;
-	static UBYTE tab[64];
+	static THREAD_LOCAL int n = 0;
+	static THREAD_LOCAL UWORD addr1;
+	static THREAD_LOCAL UWORD addr2;
+	static THREAD_LOCAL UBYTE tab[64];
 	UWORD hexval;
 	if (get_hex3(&addr1, &addr2, &hexval)) {
 		n = 0;
@@ -2812,8 +2812,8 @@ static void prompt_for_string(char *buf) {
  */
 static void string_search(int screencodes)
 {
-	static char strbuf[256] = { 0 }; /* default = nothing (always prompt) */
-	static UWORD start = 0, end = 0xffff; /* default = search all 64K */
+	static THREAD_LOCAL char strbuf[256] = { 0 }; /* default = nothing (always prompt) */
+	static THREAD_LOCAL UWORD start = 0, end = 0xffff; /* default = search all 64K */
 	char bytes[256];
 	int i, j, len;
 
@@ -2982,7 +2982,7 @@ static void print_gr_mono(UWORD addr) {
 
 
 static void print_graphics(int want_color) {
-	static UWORD width = 1, height = 8;
+	static THREAD_LOCAL UWORD width = 1, height = 8;
 	UWORD addr;
 	int rows, cols, x, y, row = 0, col = 0;
 	int trows, tcols;
@@ -3556,7 +3556,7 @@ int MONITOR_Run(void)
 
 	for (;;) {
 		char s[128];
-		static char old_s[128];
+		static THREAD_LOCAL char old_s[128];
 		char *t;
 
 		safe_gets(s, sizeof(s), "> ");
@@ -37,6 +37,14 @@
 #include "antic.h"
 #include "gtia.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MZPOKEYSND_HAVE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MZPOKEYSND_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
 #define CONSOLE_VOL 8
 #ifdef NONLINEAR_MIXING
 static const double pokeymix[61+CONSOLE_VOL] = { /* Nonlinear POKEY mixing array */
@@ -69,12 +77,15 @@ static const double pokeymix[61+CONSOLE_VOL] = { /* Nonlinear POKEY mixing array
 # define M_PI 3.141592653589793
 #endif
 
-static int num_cur_pokeys = 0;
+static THREAD_LOCAL int num_cur_pokeys = 0;
 
 /* Filter */
-static int pokey_frq; /* Hz - for easier resampling */
-static int filter_size;
-static double filter_data[SND_FILTER_SIZE];
+static THREAD_LOCAL int pokey_frq; /* Hz - for easier resampling */
+static THREAD_LOCAL int filter_size;
+static THREAD_LOCAL double filter_data[SND_FILTER_SIZE];
+/* Single precision filter for the block resampler, in pairs: the two terms
+   of interp_filter_data(), filter_data[i+1] and filter_data[i] - filter_data[filter_size-1]. */
+static THREAD_LOCAL float filter_pairs[2 * SND_FILTER_SIZE];
 static int audible_frq;
 
 static const int pokey_frq_ideal =  1789790; /* Hz - True */
@@ -94,11 +105,15 @@ static const int filter_size_8_8 = 1214;
 /* Flags and quality */
 static int snd_quality = 0;
 
+THREAD_LOCAL int MZPOKEYSND_resampler = MZPOKEYSND_RESAMPLER_EXACT;
+THREAD_LOCAL int MZPOKEYSND_resampler_check = FALSE;
+THREAD_LOCAL double MZPOKEYSND_resampler_max_error = 0.0;
+
 /* Poly tables */
-static int poly4tbl[15];
-static int poly5tbl[31];
-static unsigned char poly17tbl[131071];
-static int poly9tbl[511];
+static THREAD_LOCAL int poly4tbl[15];
+static THREAD_LOCAL int poly5tbl[31];
+static THREAD_LOCAL unsigned char poly17tbl[131071];
+static THREAD_LOCAL int poly9tbl[511];
 
 
 struct stPokeyState;
@@ -114,8 +129,8 @@ typedef unsigned char qev_t;
 #endif
 
 #ifdef SYNCHRONIZED_SOUND
-static double ticks_per_sample;
-static double samp_pos;
+static THREAD_LOCAL double ticks_per_sample;
+static THREAD_LOCAL double samp_pos;
 #endif /* SYNCHRONIZED_SOUND */
 
 /* State variables for single Pokey Chip */
@@ -134,6 +149,7 @@ typedef struct stPokeyState
     qev_t qev[1322];
     int qebeg;
     int qeend;
+    float qed[1322]; /* volume change at each event, for the block resampler */
 
     /* Main divider (64khz/15khz) */
     int mdivk;    /* 28 for 64khz, 114 for 15khz */
@@ -264,9 +280,9 @@ typedef struct stPokeyState
 
 } PokeyState;
 
-PokeyState pokey_states[NPOKEYS];
+THREAD_LOCAL PokeyState pokey_states[NPOKEYS];
 
-static struct {
+static THREAD_LOCAL struct {
     double s16;
     double s8;
 } volume;
@@ -520,6 +536,10 @@ static double interp_read_resam_all(PokeyState* ps, double frac)
 
 static void add_change(PokeyState* ps, qev_t a)
 {
+    if(ps->qebeg == ps->qeend)
+        ps->qed[ps->qeend] = (float)(ps->ovola - a);
+    else
+        ps->qed[ps->qeend] = (float)(ps->qev[(ps->qeend ? ps->qeend : filter_size) - 1] - a);
     ps->qev[ps->qeend] = a;
     ps->qet[ps->qeend] = ps->curtick; /*0;*/
     ++ps->qeend;
@@ -1307,6 +1327,7 @@ int MZPOKEYSND_Init(ULONG freq17, int playback_freq, UBYTE num_pokeys,
                        )
 {
     double cutoff;
+    int i;
 
     snd_quality = quality;
 
@@ -1409,6 +1430,17 @@ int MZPOKEYSND_Init(ULONG freq17, int playback_freq, UBYTE num_pokeys,
 	audible_frq = (int ) (cutoff * pokey_frq);
     }
 
+    for (i = 0; i < filter_size; i++)
+    {
+        if (i + 1 < filter_size)
+        {
+            filter_pairs[2 * i] = (float)filter_data[i + 1];
+            filter_pairs[2 * i + 1] = (float)(filter_data[i] - filter_data[filter_size - 1]);
+        }
+        else
+            filter_pairs[2 * i] = filter_pairs[2 * i + 1] = 0.0f;
+    }
+
     build_poly4();
     build_poly5();
     build_poly9();
@@ -2316,6 +2348,247 @@ void mzpokeysnd_debugreset(UBYTE chip)
 
 #define MAX_SAMPLE 152
 
+/******************************************************************
+ Block resampler
+
+ read_resam_all() and interp_read_resam_all() walk the whole event
+ queue in double precision for every output sample. The block
+ resampler produces a block of samples per pokey at a time, keeps
+ the volume change of each event in qed[] next to its time, and
+ accumulates the contiguous segments of the queue four events at a
+ time in single precision, using the filter pairs so that both
+ terms of the interpolation come from one load.
+
+ It is selected with MZPOKEYSND_resampler. The samples of a block
+ go to the buffer in the same order, with the same dither, as the
+ exact path; they differ only by the rounding of the sums, which is
+ measured with MZPOKEYSND_resampler_check.
+ ******************************************************************/
+
+#define RESAMPLER_BLOCK 256
+
+/* Adds the events from..to-1 of the queue to sums: sums[0] gets qed times
+   the first filter of the pair at the age of the event, sums[1] the second. */
+static void sum_events(const PokeyState* ps, int from, int to, float sums[2])
+{
+    int i = from;
+    const float *f0, *f1, *f2, *f3;
+#if defined(MZPOKEYSND_HAVE_SSE2)
+    __m128 acc01 = _mm_setzero_ps();
+    __m128 acc23 = _mm_setzero_ps();
+    float lanes[4];
+
+    for (; i + 4 <= to; i += 4)
+    {
+        __m128 d = _mm_loadu_ps(ps->qed + i);
+        __m128 f01, f23;
+
+        f0 = filter_pairs + 2 * (ps->curtick - ps->qet[i]);
+        f1 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 1]);
+        f2 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 2]);
+        f3 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 3]);
+        f01 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)f0), (const __m64 *)f1);
+        f23 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64 *)f2), (const __m64 *)f3);
+        acc01 = _mm_add_ps(acc01, _mm_mul_ps(_mm_unpacklo_ps(d, d), f01));
+        acc23 = _mm_add_ps(acc23, _mm_mul_ps(_mm_unpackhi_ps(d, d), f23));
+    }
+    _mm_storeu_ps(lanes, _mm_add_ps(acc01, acc23));
+    sums[0] += lanes[0] + lanes[2];
+    sums[1] += lanes[1] + lanes[3];
+#elif defined(MZPOKEYSND_HAVE_NEON)
+    float32x4_t acc01 = vdupq_n_f32(0.0f);
+    float32x4_t acc23 = vdupq_n_f32(0.0f);
+    float lanes[4];
+
+    for (; i + 4 <= to; i += 4)
+    {
+        float32x4_t q = vld1q_f32(ps->qed + i);
+        float32x4x2_t d = vzipq_f32(q, q);
+
+        f0 = filter_pairs + 2 * (ps->curtick - ps->qet[i]);
+        f1 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 1]);
+        f2 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 2]);
+        f3 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 3]);
+        acc01 = vmlaq_f32(acc01, d.val[0], vcombine_f32(vld1_f32(f0), vld1_f32(f1)));
+        acc23 = vmlaq_f32(acc23, d.val[1], vcombine_f32(vld1_f32(f2), vld1_f32(f3)));
+    }
+    vst1q_f32(lanes, vaddq_f32(acc01, acc23));
+    sums[0] += lanes[0] + lanes[2];
+    sums[1] += lanes[1] + lanes[3];
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (; i + 4 <= to; i += 4)
+    {
+        f0 = filter_pairs + 2 * (ps->curtick - ps->qet[i]);
+        f1 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 1]);
+        f2 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 2]);
+        f3 = filter_pairs + 2 * (ps->curtick - ps->qet[i + 3]);
+        acc[0] += ps->qed[i] * f0[0] + ps->qed[i + 2] * f2[0];
+        acc[1] += ps->qed[i] * f0[1] + ps->qed[i + 2] * f2[1];
+        acc[2] += ps->qed[i + 1] * f1[0] + ps->qed[i + 3] * f3[0];
+        acc[3] += ps->qed[i + 1] * f1[1] + ps->qed[i + 3] * f3[1];
+    }
+    sums[0] += acc[0] + acc[2];
+    sums[1] += acc[1] + acc[3];
+#endif
+    for (; i < to; i++)
+    {
+        f0 = filter_pairs + 2 * (ps->curtick - ps->qet[i]);
+        sums[0] += ps->qed[i] * f0[0];
+        sums[1] += ps->qed[i] * f0[1];
+    }
+}
+
+/* Block resampler version of interp_read_resam_all() */
+static float block_read_resam(const PokeyState* ps, float frac)
+{
+    float sums[2] = {0.0f, 0.0f};
+    float last;
+
+    if(ps->qebeg == ps->qeend)
+        last = (float)ps->ovola;
+    else
+        last = (float)ps->qev[(ps->qeend ? ps->qeend : filter_size) - 1];
+
+    if(ps->qeend < ps->qebeg)
+    {
+        sum_events(ps, ps->qebeg, filter_size, sums);
+        sum_events(ps, 0, ps->qeend, sums);
+    }
+    else
+        sum_events(ps, ps->qebeg, ps->qeend, sums);
+
+    return frac * (sums[0] + last * filter_pairs[0])
+        + (1.0f - frac) * (sums[1] + last * filter_pairs[1]);
+}
+
+/* Records the difference to the exact sample in 16-bit units at full volume */
+static void check_sample(double exact, float sample)
+{
+    double error = fabs(exact - sample) * (65535.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95);
+
+    if(error > MZPOKEYSND_resampler_max_error)
+        MZPOKEYSND_resampler_max_error = error;
+}
+
+/* Writes n frames of samples of all pokeys, dithered as in the exact path */
+static UBYTE *write_block(UBYTE *buffer, float samples[NPOKEYS][RESAMPLER_BLOCK], int n, int bit16, double scale)
+{
+    int s, i;
+
+    for(s=0; s<n; s++)
+    {
+        for(i=0; i<num_cur_pokeys; i++)
+        {
+            if(bit16)
+            {
+                *((SWORD *)buffer) = (SWORD)floor(samples[i][s] * scale
+                 + 0.5 + 0.5 * rand() / RAND_MAX - 0.25);
+                buffer += 2;
+            }
+            else
+                *buffer++ = (UBYTE)floor(samples[i][s] * scale
+                 + 128 + 0.5 + 0.5 * rand() / RAND_MAX - 0.25);
+        }
+    }
+    return buffer;
+}
+
+#ifndef VOL_ONLY_SOUND
+/* Block resampler version of mzpokeysnd_process_8/16() */
+static void process_block(void* sndbuffer, int sndn, int bit16)
+{
+    float samples[NPOKEYS][RESAMPLER_BLOCK];
+    UBYTE *buffer = (UBYTE *) sndbuffer;
+    int frames = sndn / num_cur_pokeys;
+    int ticks = pokey_frq/POKEYSND_playback_freq;
+    int n, s, i;
+
+    while(frames > 0)
+    {
+        n = frames < RESAMPLER_BLOCK ? frames : RESAMPLER_BLOCK;
+        for(i=0; i<num_cur_pokeys; i++)
+        {
+            PokeyState* ps = pokey_states + i;
+
+            for(s=0; s<n; s++)
+            {
+                advance_ticks(ps, ticks);
+                /* The pairs hold filter_data minus its last value; the events
+                   add up to ovola minus the last volume, so this restores it. */
+                samples[i][s] = block_read_resam(ps, 0.0f)
+                 + (float)(filter_data[filter_size - 1] * ps->ovola);
+                if(MZPOKEYSND_resampler_check)
+                    check_sample(read_resam_all(ps), samples[i][s]);
+            }
+        }
+        buffer = write_block(buffer, samples, n, bit16, bit16
+         ? 65535.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95
+         : 255.0 / 2 / MAX_SAMPLE / 4 * M_PI * 0.95);
+        frames -= n;
+    }
+}
+#endif /* VOL_ONLY_SOUND */
+
+#ifdef SYNCHRONIZED_SOUND
+/* Block resampler version of generate_sync() */
+static void generate_sync_block(unsigned int num_ticks)
+{
+	float samples[NPOKEYS][RESAMPLER_BLOCK];
+	unsigned int ticks[RESAMPLER_BLOCK];
+	float frac[RESAMPLER_BLOCK];
+	int bit16 = POKEYSND_snd_flags & POKEYSND_BIT16;
+	int frame_size = num_cur_pokeys * (bit16 ? 2 : 1);
+	UBYTE *buffer = POKEYSND_process_buffer + POKEYSND_process_buffer_fill;
+	UBYTE *buffer_end = POKEYSND_process_buffer + POKEYSND_process_buffer_length;
+	int more = TRUE;
+	int n, s;
+	unsigned int i;
+
+	while (more) {
+		/* Find the sample points of the block the way generate_sync() does */
+		for (n = 0; n < RESAMPLER_BLOCK; n++) {
+			double int_part;
+			double new_samp_pos = modf(samp_pos + ticks_per_sample, &int_part);
+			ticks[n] = (unsigned int)int_part;
+			if (ticks[n] > num_ticks) {
+				samp_pos -= num_ticks;
+				more = FALSE;
+				break;
+			}
+			if (buffer + n * frame_size >= buffer_end) {
+				more = FALSE;
+				break;
+			}
+			samp_pos = new_samp_pos;
+			frac[n] = (float)samp_pos;
+			num_ticks -= ticks[n];
+		}
+
+		for (i = 0; i < num_cur_pokeys; ++i) {
+			PokeyState *ps = pokey_states + i;
+
+			for (s = 0; s < n; s++) {
+				advance_ticks(ps, ticks[s]);
+				samples[i][s] = block_read_resam(ps, frac[s]);
+				if (MZPOKEYSND_resampler_check)
+					check_sample(interp_read_resam_all(ps, frac[s]), samples[i][s]);
+			}
+		}
+		buffer = write_block(buffer, samples, n, bit16,
+			(bit16 ? volume.s16 : volume.s8) / 2 / MAX_SAMPLE / 4 * M_PI * 0.95);
+	}
+
+	POKEYSND_process_buffer_fill = buffer - POKEYSND_process_buffer;
+	if (num_ticks > 0) {
+		/* remaining ticks */
+		for (i = 0; i < num_cur_pokeys; ++i)
+			advance_ticks(pokey_states + i, num_ticks);
+	}
+}
+#endif /* SYNCHRONIZED_SOUND */
+
 static void mzpokeysnd_process_8(void* sndbuffer, int sndn)
 {
     int i;
@@ -2325,6 +2598,14 @@ static void mzpokeysnd_process_8(void* sndbuffer, int sndn)
     if(num_cur_pokeys<1)
         return; /* module was not initialized */
 
+#ifndef VOL_ONLY_SOUND
+    if(MZPOKEYSND_resampler == MZPOKEYSND_RESAMPLER_BLOCK)
+    {
+        process_block(sndbuffer, sndn, FALSE);
+        return;
+    }
+#endif
+
     /* if there are two pokeys, then the signal is stereo
        we assume even sndn */
     while(nsam >= (int) num_cur_pokeys)
@@ -2374,6 +2655,14 @@ static void mzpokeysnd_process_16(void* sndbuffer, int sndn)
     if(num_cur_pokeys<1)
         return; /* module was not initialized */
 
+#ifndef VOL_ONLY_SOUND
+    if(MZPOKEYSND_resampler == MZPOKEYSND_RESAMPLER_BLOCK)
+    {
+        process_block(sndbuffer, sndn, TRUE);
+        return;
+    }
+#endif
+
     /* if there are two pokeys, then the signal is stereo
        we assume even sndn */
     while(nsam >= (int) num_cur_pokeys)
@@ -2422,6 +2711,11 @@ static void generate_sync(unsigned int num_ticks)
 	UBYTE *buffer_end = POKEYSND_process_buffer + POKEYSND_process_buffer_length;
 	unsigned int i;
 
+	if (MZPOKEYSND_resampler == MZPOKEYSND_RESAMPLER_BLOCK) {
+		generate_sync_block(num_ticks);
+		return;
+	}
+
 	for (;;) {
 		double int_part;
 		new_samp_pos = samp_pos + ticks_per_sample;
@@ -13,4 +13,17 @@ int MZPOKEYSND_Init(ULONG freq17,
 #endif
                        );
 
+/* Resamplers for the output: the exact one computes every sample from the
+   whole event queue in double precision, the block one computes blocks of
+   samples in single precision with SIMD. */
+#define MZPOKEYSND_RESAMPLER_EXACT 0
+#define MZPOKEYSND_RESAMPLER_BLOCK 1
+extern THREAD_LOCAL int MZPOKEYSND_resampler;
+
+/* When TRUE, the block resampler also computes every sample exactly and keeps
+   the largest difference, in 16-bit sample units at full volume, in
+   MZPOKEYSND_resampler_max_error. */
+extern THREAD_LOCAL int MZPOKEYSND_resampler_check;
+extern THREAD_LOCAL double MZPOKEYSND_resampler_max_error;
+
 #endif /* MZPOKEYSND_H_ */
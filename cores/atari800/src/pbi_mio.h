@@ -4,7 +4,7 @@
 #include "atari.h"
 #include <stdio.h>
 
-extern int PBI_MIO_enabled;
+extern THREAD_LOCAL int PBI_MIO_enabled;
 
 int PBI_MIO_Initialise(int *argc, char *argv[]);
 void PBI_MIO_Exit(void);
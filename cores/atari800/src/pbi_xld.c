@@ -44,17 +44,17 @@
 #define MODEM_MASK (1 << MODEM_PBI_NUM)
 #define VOICE_MASK (1 << VOICE_PBI_NUM)
 
-static UBYTE *voicerom;
-static UBYTE *diskrom;
-static char xld_d_rom_filename[FILENAME_MAX];
-static char xld_v_rom_filename[FILENAME_MAX];
+static THREAD_LOCAL UBYTE *voicerom;
+static THREAD_LOCAL UBYTE *diskrom;
+static THREAD_LOCAL char xld_d_rom_filename[FILENAME_MAX];
+static THREAD_LOCAL char xld_v_rom_filename[FILENAME_MAX];
 
-static UBYTE votrax_latch = 0;
-static UBYTE modem_latch = 0;
+static THREAD_LOCAL UBYTE votrax_latch = 0;
+static THREAD_LOCAL UBYTE modem_latch = 0;
 
-int PBI_XLD_enabled = FALSE;
-int PBI_XLD_v_enabled = FALSE;
-static int xld_d_enabled = FALSE;
+THREAD_LOCAL int PBI_XLD_enabled = FALSE;
+THREAD_LOCAL int PBI_XLD_v_enabled = FALSE;
+static THREAD_LOCAL int xld_d_enabled = FALSE;
 
 /* Parallel Disk I/O emulation support */
 #define PIO_NoFrame         (0x00)
@@ -64,12 +64,12 @@ static int xld_d_enabled = FALSE;
 #define PIO_WriteFrame      (0x04)
 #define PIO_FinalStatus     (0x05)
 #define PIO_FormatFrame     (0x06)
-static UBYTE CommandFrame[6];
-static int CommandIndex = 0;
-static UBYTE DataBuffer[256 + 3];
-static int DataIndex = 0;
-static int TransferStatus = PIO_CommandFrame;
-static int ExpectedBytes = 5;
+static THREAD_LOCAL UBYTE CommandFrame[6];
+static THREAD_LOCAL int CommandIndex = 0;
+static THREAD_LOCAL UBYTE DataBuffer[256 + 3];
+static THREAD_LOCAL int DataIndex = 0;
+static THREAD_LOCAL int TransferStatus = PIO_CommandFrame;
+static THREAD_LOCAL int ExpectedBytes = 5;
 static void PIO_PutByte(int byte);
 static int PIO_GetByte(void);
 static UBYTE PIO_Command_Frame(void);
@@ -8,16 +8,16 @@
 #define PIA_OFFSET_PACTL 0x02
 #define PIA_OFFSET_PBCTL 0x03
 
-extern UBYTE PIA_PACTL;
-extern UBYTE PIA_PBCTL;
-extern UBYTE PIA_PORTA;
-extern UBYTE PIA_PORTB;
-extern UBYTE PIA_PORTA_mask;
-extern UBYTE PIA_PORTB_mask;
-extern UBYTE PIA_PORT_input[2];
-extern int PIA_CA2;
-extern int PIA_CB2;
-extern int PIA_IRQ;
+extern THREAD_LOCAL UBYTE PIA_PACTL;
+extern THREAD_LOCAL UBYTE PIA_PBCTL;
+extern THREAD_LOCAL UBYTE PIA_PORTA;
+extern THREAD_LOCAL UBYTE PIA_PORTB;
+extern THREAD_LOCAL UBYTE PIA_PORTA_mask;
+extern THREAD_LOCAL UBYTE PIA_PORTB_mask;
+extern THREAD_LOCAL UBYTE PIA_PORT_input[2];
+extern THREAD_LOCAL int PIA_CA2;
+extern THREAD_LOCAL int PIA_CB2;
+extern THREAD_LOCAL int PIA_IRQ;
 
 int PIA_Initialise(int *argc, char *argv[]);
 void PIA_Reset(void);
@@ -63,29 +63,29 @@
 void pokey_update(void);
 #endif
 
-UBYTE POKEY_KBCODE;
-UBYTE POKEY_SERIN;
-UBYTE POKEY_IRQST;
-UBYTE POKEY_IRQEN;
-UBYTE POKEY_SKSTAT;
-UBYTE POKEY_SKCTL;
-int POKEY_DELAYED_SERIN_IRQ;
-int POKEY_DELAYED_SEROUT_IRQ;
-int POKEY_DELAYED_XMTDONE_IRQ;
+THREAD_LOCAL UBYTE POKEY_KBCODE;
+THREAD_LOCAL UBYTE POKEY_SERIN;
+THREAD_LOCAL UBYTE POKEY_IRQST;
+THREAD_LOCAL UBYTE POKEY_IRQEN;
+THREAD_LOCAL UBYTE POKEY_SKSTAT;
+THREAD_LOCAL UBYTE POKEY_SKCTL;
+THREAD_LOCAL int POKEY_DELAYED_SERIN_IRQ;
+THREAD_LOCAL int POKEY_DELAYED_SEROUT_IRQ;
+THREAD_LOCAL int POKEY_DELAYED_XMTDONE_IRQ;
 
 /* structures to hold the 9 pokey control bytes */
-UBYTE POKEY_AUDF[4 * POKEY_MAXPOKEYS];	/* AUDFx (D200, D202, D204, D206) */
-UBYTE POKEY_AUDC[4 * POKEY_MAXPOKEYS];	/* AUDCx (D201, D203, D205, D207) */
-UBYTE POKEY_AUDCTL[POKEY_MAXPOKEYS];	/* AUDCTL (D208) */
-int POKEY_DivNIRQ[4], POKEY_DivNMax[4];
-int POKEY_Base_mult[POKEY_MAXPOKEYS];		/* selects either 64Khz or 15Khz clock mult */
-
-UBYTE POKEY_POT_input[8] = {228, 228, 228, 228, 228, 228, 228, 228};
-static int pot_scanline;
-
-UBYTE POKEY_poly9_lookup[511];
-UBYTE POKEY_poly17_lookup[16385];
-static ULONG random_scanline_counter;
+THREAD_LOCAL UBYTE POKEY_AUDF[4 * POKEY_MAXPOKEYS];	/* AUDFx (D200, D202, D204, D206) */
+THREAD_LOCAL UBYTE POKEY_AUDC[4 * POKEY_MAXPOKEYS];	/* AUDCx (D201, D203, D205, D207) */
+THREAD_LOCAL UBYTE POKEY_AUDCTL[POKEY_MAXPOKEYS];	/* AUDCTL (D208) */
+THREAD_LOCAL int POKEY_DivNIRQ[4], POKEY_DivNMax[4];
+THREAD_LOCAL int POKEY_Base_mult[POKEY_MAXPOKEYS];		/* selects either 64Khz or 15Khz clock mult */
+
+THREAD_LOCAL UBYTE POKEY_POT_input[8] = {228, 228, 228, 228, 228, 228, 228, 228};
+static THREAD_LOCAL int pot_scanline;
+
+THREAD_LOCAL UBYTE POKEY_poly9_lookup[511];
+THREAD_LOCAL UBYTE POKEY_poly17_lookup[16385];
+static THREAD_LOCAL ULONG random_scanline_counter;
 
 ULONG POKEY_GetRandomCounter(void)
 {
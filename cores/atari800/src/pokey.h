@@ -42,16 +42,16 @@
 
 #ifndef ASAP
 
-extern UBYTE POKEY_KBCODE;
-extern UBYTE POKEY_IRQST;
-extern UBYTE POKEY_IRQEN;
-extern UBYTE POKEY_SKSTAT;
-extern UBYTE POKEY_SKCTL;
-extern int POKEY_DELAYED_SERIN_IRQ;
-extern int POKEY_DELAYED_SEROUT_IRQ;
-extern int POKEY_DELAYED_XMTDONE_IRQ;
+extern THREAD_LOCAL UBYTE POKEY_KBCODE;
+extern THREAD_LOCAL UBYTE POKEY_IRQST;
+extern THREAD_LOCAL UBYTE POKEY_IRQEN;
+extern THREAD_LOCAL UBYTE POKEY_SKSTAT;
+extern THREAD_LOCAL UBYTE POKEY_SKCTL;
+extern THREAD_LOCAL int POKEY_DELAYED_SERIN_IRQ;
+extern THREAD_LOCAL int POKEY_DELAYED_SEROUT_IRQ;
+extern THREAD_LOCAL int POKEY_DELAYED_XMTDONE_IRQ;
 
-extern UBYTE POKEY_POT_input[8];
+extern THREAD_LOCAL UBYTE POKEY_POT_input[8];
 
 ULONG POKEY_GetRandomCounter(void);
 void POKEY_SetRandomCounter(ULONG value);
@@ -109,14 +109,14 @@ void POKEY_StateRead(void);
 #define POKEY_SAMPLE    127
 
 /* structures to hold the 9 pokey control bytes */
-extern UBYTE POKEY_AUDF[4 * POKEY_MAXPOKEYS];	/* AUDFx (D200, D202, D204, D206) */
-extern UBYTE POKEY_AUDC[4 * POKEY_MAXPOKEYS];	/* AUDCx (D201, D203, D205, D207) */
-extern UBYTE POKEY_AUDCTL[POKEY_MAXPOKEYS];		/* AUDCTL (D208) */
+extern THREAD_LOCAL UBYTE POKEY_AUDF[4 * POKEY_MAXPOKEYS];	/* AUDFx (D200, D202, D204, D206) */
+extern THREAD_LOCAL UBYTE POKEY_AUDC[4 * POKEY_MAXPOKEYS];	/* AUDCx (D201, D203, D205, D207) */
+extern THREAD_LOCAL UBYTE POKEY_AUDCTL[POKEY_MAXPOKEYS];		/* AUDCTL (D208) */
 
-extern int POKEY_DivNIRQ[4], POKEY_DivNMax[4];
-extern int POKEY_Base_mult[POKEY_MAXPOKEYS];	/* selects either 64Khz or 15Khz clock mult */
+extern THREAD_LOCAL int POKEY_DivNIRQ[4], POKEY_DivNMax[4];
+extern THREAD_LOCAL int POKEY_Base_mult[POKEY_MAXPOKEYS];	/* selects either 64Khz or 15Khz clock mult */
 
-extern UBYTE POKEY_poly9_lookup[POKEY_POLY9_SIZE];
-extern UBYTE POKEY_poly17_lookup[16385];
+extern THREAD_LOCAL UBYTE POKEY_poly9_lookup[POKEY_POLY9_SIZE];
+extern THREAD_LOCAL UBYTE POKEY_poly17_lookup[16385];
 
 #endif /* POKEY_H_ */
@@ -30,11 +30,11 @@
 #include <string.h>
 #include <stdio.h>
 
-static int enabled, counter, interval;
-static char *filename = "pokeyrec.dat", *fmt = "%c";
-static FILE *fp;
+static THREAD_LOCAL int enabled, counter, interval;
+static THREAD_LOCAL char *filename = "pokeyrec.dat", *fmt = "%c";
+static THREAD_LOCAL FILE *fp;
 #ifdef STEREO_SOUND
-static int stereo;
+static THREAD_LOCAL int stereo;
 #endif
 
 static void output_pokey_values(int pokeynr) {
@@ -77,13 +77,13 @@
 /* GLOBAL VARIABLE DEFINITIONS */
 
 /* number of pokey chips currently emulated */
-static UBYTE Num_pokeys;
+static THREAD_LOCAL UBYTE Num_pokeys;
 
-static UBYTE pokeysnd_AUDV[4 * POKEY_MAXPOKEYS];	/* Channel volume - derived */
+static THREAD_LOCAL UBYTE pokeysnd_AUDV[4 * POKEY_MAXPOKEYS];	/* Channel volume - derived */
 
 static UBYTE Outbit[4 * POKEY_MAXPOKEYS];		/* current state of the output (high or low) */
 
-static UBYTE Outvol[4 * POKEY_MAXPOKEYS];		/* last output volume for each channel */
+static THREAD_LOCAL UBYTE Outvol[4 * POKEY_MAXPOKEYS];		/* last output volume for each channel */
 
 /* Initialize the bit patterns for the polynomials. */
 
@@ -106,28 +106,28 @@ static UBYTE bit5[POKEY_POLY5_SIZE] =
 {0, 0, 1, 1, 0, 0, 0, 1, 1, 1, 1, 0, 0, 1, 0, 1, 0, 1, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 1};
 #endif
 
-static ULONG P4 = 0,			/* Global position pointer for the 4-bit  POLY array */
+static THREAD_LOCAL ULONG P4 = 0,			/* Global position pointer for the 4-bit  POLY array */
  P5 = 0,						/* Global position pointer for the 5-bit  POLY array */
  P9 = 0,						/* Global position pointer for the 9-bit  POLY array */
  P17 = 0;						/* Global position pointer for the 17-bit POLY array */
 
-static ULONG Div_n_cnt[4 * POKEY_MAXPOKEYS],		/* Divide by n counter. one for each channel */
+static THREAD_LOCAL ULONG Div_n_cnt[4 * POKEY_MAXPOKEYS],		/* Divide by n counter. one for each channel */
  Div_n_max[4 * POKEY_MAXPOKEYS];		/* Divide by n maximum, one for each channel */
 
-static ULONG Samp_n_max,		/* Sample max.  For accuracy, it is *256 */
+static THREAD_LOCAL ULONG Samp_n_max,		/* Sample max.  For accuracy, it is *256 */
  Samp_n_cnt[2];					/* Sample cnt. */
 
 #ifdef INTERPOLATE_SOUND
 #ifdef CLIP_SOUND
-static SWORD last_val = 0;		/* last output value */
+static THREAD_LOCAL SWORD last_val = 0;		/* last output value */
 #else
-static UWORD last_val = 0;
+static THREAD_LOCAL UWORD last_val = 0;
 #endif
 #ifdef STEREO_SOUND
 #ifdef CLIP_SOUND
-static SWORD last_val2 = 0;	/* last output value */
+static THREAD_LOCAL SWORD last_val2 = 0;	/* last output value */
 #else
-static UWORD last_val2 = 0;
+static THREAD_LOCAL UWORD last_val2 = 0;
 #endif
 #endif
 #endif
@@ -156,37 +156,37 @@ static int	sampout2;			/* last out volume */
 #endif
 #endif  /* VOL_ONLY_SOUND */
 
-static ULONG snd_freq17 = POKEYSND_FREQ_17_EXACT;
-int POKEYSND_playback_freq = 44100;
-UBYTE POKEYSND_num_pokeys = 1;
-int POKEYSND_snd_flags = 0;
-static int mz_quality = 0;		/* default quality for mzpokeysnd */
+static THREAD_LOCAL ULONG snd_freq17 = POKEYSND_FREQ_17_EXACT;
+THREAD_LOCAL int POKEYSND_playback_freq = 44100;
+THREAD_LOCAL UBYTE POKEYSND_num_pokeys = 1;
+THREAD_LOCAL int POKEYSND_snd_flags = 0;
+static THREAD_LOCAL int mz_quality = 0;		/* default quality for mzpokeysnd */
 #ifdef __PLUS
 int mz_clear_regs = 0;
 #endif
 
-int POKEYSND_enable_new_pokey = TRUE;
-int POKEYSND_bienias_fix = TRUE;  /* when TRUE, high frequencies get emulated: better sound but slower */
+THREAD_LOCAL int POKEYSND_enable_new_pokey = TRUE;
+THREAD_LOCAL int POKEYSND_bienias_fix = TRUE;  /* when TRUE, high frequencies get emulated: better sound but slower */
 #if defined(__PLUS) && !defined(_WX_)
 #define BIENIAS_FIX (g_Sound.nBieniasFix)
 #else
 #define BIENIAS_FIX POKEYSND_bienias_fix
 #endif
 #ifndef ASAP
-int POKEYSND_stereo_enabled = FALSE;
+THREAD_LOCAL int POKEYSND_stereo_enabled = FALSE;
 #endif
 
-int POKEYSND_volume = 0x100;
+THREAD_LOCAL int POKEYSND_volume = 0x100;
 
 /* multiple sound engine interface */
 static void pokeysnd_process_8(void *sndbuffer, int sndn);
 static void pokeysnd_process_16(void *sndbuffer, int sndn);
 static void null_pokey_process(void *sndbuffer, int sndn) {}
-void (*POKEYSND_Process_ptr)(void *sndbuffer, int sndn) = null_pokey_process;
+THREAD_LOCAL void (*POKEYSND_Process_ptr)(void *sndbuffer, int sndn) = null_pokey_process;
 
 static void Update_pokey_sound_rf(UWORD, UBYTE, UBYTE, UBYTE);
 static void null_pokey_sound(UWORD addr, UBYTE val, UBYTE chip, UBYTE gain) {}
-void (*POKEYSND_Update_ptr) (UWORD addr, UBYTE val, UBYTE chip, UBYTE gain)
+THREAD_LOCAL void (*POKEYSND_Update_ptr) (UWORD addr, UBYTE val, UBYTE chip, UBYTE gain)
   = null_pokey_sound;
 
 #ifdef SERIO_SOUND
@@ -199,8 +199,8 @@ int POKEYSND_serio_sound_enabled = 1;
 #ifdef CONSOLE_SOUND
 static void Update_consol_sound_rf(int set);
 static void null_consol_sound(int set) {}
-void (*POKEYSND_UpdateConsol_ptr)(int set) = null_consol_sound;
-int POKEYSND_console_sound_enabled = 1;
+THREAD_LOCAL void (*POKEYSND_UpdateConsol_ptr)(int set) = null_consol_sound;
+THREAD_LOCAL int POKEYSND_console_sound_enabled = 1;
 #endif
 
 #ifdef VOL_ONLY_SOUND
@@ -210,18 +210,18 @@ void (*POKEYSND_UpdateVolOnly)(void) = null_vol_only_sound;
 #endif
 
 #ifdef SYNCHRONIZED_SOUND
-UBYTE *POKEYSND_process_buffer = NULL;
-unsigned int POKEYSND_process_buffer_length;
-unsigned int POKEYSND_process_buffer_fill;
-static unsigned int prev_update_tick;
+THREAD_LOCAL UBYTE *POKEYSND_process_buffer = NULL;
+THREAD_LOCAL unsigned int POKEYSND_process_buffer_length;
+THREAD_LOCAL unsigned int POKEYSND_process_buffer_fill;
+static THREAD_LOCAL unsigned int prev_update_tick;
 
 static void Generate_sync_rf(unsigned int num_ticks);
 static void null_generate_sync(unsigned int num_ticks) {}
-void (*POKEYSND_GenerateSync)(unsigned int num_ticks) = null_generate_sync;
+THREAD_LOCAL void (*POKEYSND_GenerateSync)(unsigned int num_ticks) = null_generate_sync;
 
-static double ticks_per_sample;
-static double samp_pos;
-static int speaker;
+static THREAD_LOCAL double ticks_per_sample;
+static THREAD_LOCAL double samp_pos;
+static THREAD_LOCAL int speaker;
 static int const CONSOLE_VOL = 32;
 #endif /* SYNCHRONIZED_SOUND */
 
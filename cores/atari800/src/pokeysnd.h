@@ -79,21 +79,21 @@ extern "C" {
 /* init flags */
 #define POKEYSND_BIT16	1
 
-extern SLONG POKEYSND_playback_freq;
-extern UBYTE POKEYSND_num_pokeys;
-extern int POKEYSND_snd_flags;
-extern int POKEYSND_volume;
+extern THREAD_LOCAL SLONG POKEYSND_playback_freq;
+extern THREAD_LOCAL UBYTE POKEYSND_num_pokeys;
+extern THREAD_LOCAL int POKEYSND_snd_flags;
+extern THREAD_LOCAL int POKEYSND_volume;
 
-extern int POKEYSND_enable_new_pokey;
-extern int POKEYSND_stereo_enabled;
+extern THREAD_LOCAL int POKEYSND_enable_new_pokey;
+extern THREAD_LOCAL int POKEYSND_stereo_enabled;
 extern int POKEYSND_serio_sound_enabled;
-extern int POKEYSND_console_sound_enabled;
-extern int POKEYSND_bienias_fix;
+extern THREAD_LOCAL int POKEYSND_console_sound_enabled;
+extern THREAD_LOCAL int POKEYSND_bienias_fix;
 
-extern void (*POKEYSND_Process_ptr)(void *sndbuffer, int sndn);
-extern void (*POKEYSND_Update_ptr)(UWORD addr, UBYTE val, UBYTE chip, UBYTE gain);
+extern THREAD_LOCAL void (*POKEYSND_Process_ptr)(void *sndbuffer, int sndn);
+extern THREAD_LOCAL void (*POKEYSND_Update_ptr)(UWORD addr, UBYTE val, UBYTE chip, UBYTE gain);
 extern void (*POKEYSND_UpdateSerio)(int out, UBYTE data);
-extern void (*POKEYSND_UpdateConsol_ptr)(int set);
+extern THREAD_LOCAL void (*POKEYSND_UpdateConsol_ptr)(int set);
 extern void (*POKEYSND_UpdateVolOnly)(void);
 
 int POKEYSND_Init(ULONG freq17, int playback_freq, UBYTE num_pokeys,
@@ -130,10 +130,10 @@ extern int	POKEYSND_samp_consol_val;		/* actual value of console sound */
 #endif  /* VOL_ONLY_SOUND */
 
 #ifdef SYNCHRONIZED_SOUND
-extern UBYTE *POKEYSND_process_buffer;
-extern unsigned int POKEYSND_process_buffer_length;
-extern unsigned int POKEYSND_process_buffer_fill;
-extern void (*POKEYSND_GenerateSync)(unsigned int num_ticks);
+extern THREAD_LOCAL UBYTE *POKEYSND_process_buffer;
+extern THREAD_LOCAL unsigned int POKEYSND_process_buffer_length;
+extern THREAD_LOCAL unsigned int POKEYSND_process_buffer_fill;
+extern THREAD_LOCAL void (*POKEYSND_GenerateSync)(unsigned int num_ticks);
 int POKEYSND_UpdateProcessBuffer(void);
 #endif /* SYNCHRONIZED_SOUND */
 
@@ -33,8 +33,8 @@ extern void RDevice_STAT(void);
 extern void RDevice_SPEC(void);
 extern void RDevice_INIT(void);
 
-extern int RDevice_serial_enabled;
-extern char RDevice_serial_device[];
+extern THREAD_LOCAL int RDevice_serial_enabled;
+extern THREAD_LOCAL char RDevice_serial_device[];
 
 extern void RDevice_Exit(void);
 
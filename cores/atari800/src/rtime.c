@@ -38,16 +38,16 @@
 #include "rtime.h"
 #include "util.h"
 
-int RTIME_enabled = 1;
+THREAD_LOCAL int RTIME_enabled = 1;
 
-static int rtime_state = 0;
+static THREAD_LOCAL int rtime_state = 0;
 				/* 0 = waiting for register # */
 				/* 1 = got register #, waiting for hi nybble */
 				/* 2 = got hi nybble, waiting for lo nybble */
-static int rtime_tmp = 0;
-static int rtime_tmp2 = 0;
+static THREAD_LOCAL int rtime_tmp = 0;
+static THREAD_LOCAL int rtime_tmp2 = 0;
 
-static UBYTE regset[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+static THREAD_LOCAL UBYTE regset[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
 
 int RTIME_ReadConfig(char *string, char *ptr)
 {
@@ -46,7 +46,7 @@
 #define ATARI_VISIBLE_WIDTH 336
 #define ATARI_LEFT_MARGIN 24
 
-ULONG *Screen_atari = NULL;
+THREAD_LOCAL ULONG *Screen_atari = NULL;
 #ifdef DIRTYRECT
 UBYTE *Screen_dirty = NULL;
 #endif
@@ -63,15 +63,15 @@ ULONG *Screen_atari2 = NULL;
    Currently Screen_visible variables are used only to place
    disk led and snailmeter in the corners of the screen.
 */
-int Screen_visible_x1 = 24;				/* 0 .. Screen_WIDTH */
-int Screen_visible_y1 = 0;				/* 0 .. Screen_HEIGHT */
-int Screen_visible_x2 = 360;			/* 0 .. Screen_WIDTH */
-int Screen_visible_y2 = Screen_HEIGHT;	/* 0 .. Screen_HEIGHT */
+THREAD_LOCAL int Screen_visible_x1 = 24;				/* 0 .. Screen_WIDTH */
+THREAD_LOCAL int Screen_visible_y1 = 0;				/* 0 .. Screen_HEIGHT */
+THREAD_LOCAL int Screen_visible_x2 = 360;			/* 0 .. Screen_WIDTH */
+THREAD_LOCAL int Screen_visible_y2 = Screen_HEIGHT;	/* 0 .. Screen_HEIGHT */
 
-int Screen_show_atari_speed = FALSE;
-int Screen_show_disk_led = TRUE;
-int Screen_show_sector_counter = FALSE;
-int Screen_show_1200_leds = TRUE;
+THREAD_LOCAL int Screen_show_atari_speed = FALSE;
+THREAD_LOCAL int Screen_show_disk_led = TRUE;
+THREAD_LOCAL int Screen_show_sector_counter = FALSE;
+THREAD_LOCAL int Screen_show_1200_leds = TRUE;
 
 #ifdef HAVE_LIBPNG
 #define DEFAULT_SCREENSHOT_FILENAME_FORMAT "atari%03d.png"
@@ -79,8 +79,8 @@ int Screen_show_1200_leds = TRUE;
 #define DEFAULT_SCREENSHOT_FILENAME_FORMAT "atari%03d.pcx"
 #endif
 
-static char screenshot_filename_format[FILENAME_MAX] = DEFAULT_SCREENSHOT_FILENAME_FORMAT;
-static int screenshot_no_max = 1000;
+static THREAD_LOCAL char screenshot_filename_format[FILENAME_MAX] = DEFAULT_SCREENSHOT_FILENAME_FORMAT;
+static THREAD_LOCAL int screenshot_no_max = 1000;
 
 /* converts "foo%bar##.pcx" to "foo%%bar%02d.pcx" */
 static void Screen_SetScreenshotFilenamePattern(const char *p)
@@ -382,9 +382,9 @@ static UBYTE *SmallFont_DrawInt(UBYTE *screen, int n, UBYTE color1, UBYTE color2
 void Screen_DrawAtariSpeed(double cur_time)
 {
 	if (Screen_show_atari_speed) {
-		static int percent_display = 100;
-		static int last_updated = 0;
-		static double last_time = 0;
+		static THREAD_LOCAL int percent_display = 100;
+		static THREAD_LOCAL int last_updated = 0;
+		static THREAD_LOCAL double last_time = 0;
 		if ((cur_time - last_time) >= 0.5) {
 			percent_display = (int) (100 * (Atari800_nframes - last_updated) / (cur_time - last_time) / (Atari800_tv_mode == Atari800_TV_PAL ? 50 : 60));
 			last_updated = Atari800_nframes;
@@ -455,8 +455,8 @@ void Screen_Draw1200LED(void)
 
 void Screen_FindScreenshotFilename(char *buffer, unsigned bufsize)
 {
-	static int no = -1;
-	static int overwrite = FALSE;
+	static THREAD_LOCAL int no = -1;
+	static THREAD_LOCAL int overwrite = FALSE;
 
 	for (;;) {
 		if (++no >= screenshot_no_max) {
@@ -64,20 +64,20 @@
 #define BOOT_SECTORS_LOGICAL	0
 #define BOOT_SECTORS_PHYSICAL	1
 #define BOOT_SECTORS_SIO2PC		2
-static int boot_sectors_type[SIO_MAX_DRIVES];
+static THREAD_LOCAL int boot_sectors_type[SIO_MAX_DRIVES];
 
-static int image_type[SIO_MAX_DRIVES];
+static THREAD_LOCAL int image_type[SIO_MAX_DRIVES];
 #define IMAGE_TYPE_XFD  0
 #define IMAGE_TYPE_ATR  1
 #define IMAGE_TYPE_PRO  2
 #define IMAGE_TYPE_VAPI 3
-static FILE *disk[SIO_MAX_DRIVES] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
-static int sectorcount[SIO_MAX_DRIVES];
-static int sectorsize[SIO_MAX_DRIVES];
+static THREAD_LOCAL FILE *disk[SIO_MAX_DRIVES] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+static THREAD_LOCAL int sectorcount[SIO_MAX_DRIVES];
+static THREAD_LOCAL int sectorsize[SIO_MAX_DRIVES];
 /* these two are used by the 1450XLD parallel disk device */
-int SIO_format_sectorcount[SIO_MAX_DRIVES];
-int SIO_format_sectorsize[SIO_MAX_DRIVES];
-static int io_success[SIO_MAX_DRIVES];
+THREAD_LOCAL int SIO_format_sectorcount[SIO_MAX_DRIVES];
+THREAD_LOCAL int SIO_format_sectorsize[SIO_MAX_DRIVES];
+static THREAD_LOCAL int io_success[SIO_MAX_DRIVES];
 /* stores dup sector counter for PRO images */
 typedef struct tagpro_additional_info_t {
 	int max_sector;
@@ -148,18 +148,18 @@ typedef struct tagvapi_sector_header_t {
 #define VAPI_16(x) (x[0] + (x[1] << 8))
 
 /* Additional Info for all copy protected disk types */
-static void *additional_info[SIO_MAX_DRIVES];
+static THREAD_LOCAL void *additional_info[SIO_MAX_DRIVES];
 
-SIO_UnitStatus SIO_drive_status[SIO_MAX_DRIVES];
-char SIO_filename[SIO_MAX_DRIVES][FILENAME_MAX];
+THREAD_LOCAL SIO_UnitStatus SIO_drive_status[SIO_MAX_DRIVES];
+THREAD_LOCAL char SIO_filename[SIO_MAX_DRIVES][FILENAME_MAX];
 
 Util_tmpbufdef(static, sio_tmpbuf[SIO_MAX_DRIVES])
 
-int SIO_last_op;
-int SIO_last_op_time = 0;
-int SIO_last_drive;
-int SIO_last_sector;
-char SIO_status[256];
+THREAD_LOCAL int SIO_last_op;
+THREAD_LOCAL int SIO_last_op_time = 0;
+THREAD_LOCAL int SIO_last_drive;
+THREAD_LOCAL int SIO_last_sector;
+THREAD_LOCAL char SIO_status[256];
 
 /* Serial I/O emulation support */
 #define SIO_NoFrame         (0x00)
@@ -169,14 +169,14 @@ char SIO_status[256];
 #define SIO_WriteFrame      (0x04)
 #define SIO_FinalStatus     (0x05)
 #define SIO_FormatFrame     (0x06)
-static UBYTE CommandFrame[6];
-static int CommandIndex = 0;
-static UBYTE DataBuffer[256 + 3];
-static int DataIndex = 0;
-static int TransferStatus = SIO_NoFrame;
-static int ExpectedBytes = 0;
+static THREAD_LOCAL UBYTE CommandFrame[6];
+static THREAD_LOCAL int CommandIndex = 0;
+static THREAD_LOCAL UBYTE DataBuffer[256 + 3];
+static THREAD_LOCAL int DataIndex = 0;
+static THREAD_LOCAL int TransferStatus = SIO_NoFrame;
+static THREAD_LOCAL int ExpectedBytes = 0;
 
-int ignore_header_writeprotect = FALSE;
+THREAD_LOCAL int ignore_header_writeprotect = FALSE;
 
 int SIO_Initialise(int *argc, char *argv[])
 {
@@ -708,7 +708,7 @@ int SIO_ReadSector(int unit, int sector, UBYTE *buffer)
 		vapi_additional_info_t *info;
 		vapi_sec_info_t *secinfo;
 		ULONG secindex = 0;
-		static int lasttrack = 0;
+		static THREAD_LOCAL int lasttrack = 0;
 		unsigned int currpos, time, delay, rotations, bestdelay;
 /*		unsigned char beststatus;*/
 		int fromtrack, trackstostep, j;
@@ -1103,8 +1103,8 @@ int SIO_DriveStatus(int unit, UBYTE *buffer)
    faster than with a typical disk drive.  We introduce a delay
    of SECTOR_DELAY scanlines between successive reads of sector 1. */
 #define SECTOR_DELAY 3200
-static int delay_counter = 0;
-static int last_ypos = 0;
+static THREAD_LOCAL int delay_counter = 0;
+static THREAD_LOCAL int last_ypos = 0;
 #endif
 
 /* SIO patch emulation routine */
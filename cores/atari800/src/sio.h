@@ -16,16 +16,16 @@ typedef enum SIO_tagUnitStatus {
 	SIO_READ_WRITE
 } SIO_UnitStatus;
 
-extern char SIO_status[256];
-extern SIO_UnitStatus SIO_drive_status[SIO_MAX_DRIVES];
-extern char SIO_filename[SIO_MAX_DRIVES][FILENAME_MAX];
+extern THREAD_LOCAL char SIO_status[256];
+extern THREAD_LOCAL SIO_UnitStatus SIO_drive_status[SIO_MAX_DRIVES];
+extern THREAD_LOCAL char SIO_filename[SIO_MAX_DRIVES][FILENAME_MAX];
 
 #define SIO_LAST_READ 0
 #define SIO_LAST_WRITE 1
-extern int SIO_last_op;
-extern int SIO_last_op_time;
-extern int SIO_last_drive; /* 1 .. 8 */
-extern int SIO_last_sector;
+extern THREAD_LOCAL int SIO_last_op;
+extern THREAD_LOCAL int SIO_last_op_time;
+extern THREAD_LOCAL int SIO_last_drive; /* 1 .. 8 */
+extern THREAD_LOCAL int SIO_last_sector;
 
 int SIO_Mount(int diskno, const char *filename, int b_open_readonly);
 void SIO_Dismount(int diskno);
@@ -47,8 +47,8 @@ void SIO_Exit(void);
 #define SIO_ACK_INTERVAL      36
 
 /* These functions are also used by the 1450XLD Parallel disk device */
-extern int SIO_format_sectorcount[SIO_MAX_DRIVES];
-extern int SIO_format_sectorsize[SIO_MAX_DRIVES];
+extern THREAD_LOCAL int SIO_format_sectorcount[SIO_MAX_DRIVES];
+extern THREAD_LOCAL int SIO_format_sectorsize[SIO_MAX_DRIVES];
 int SIO_ReadStatusBlock(int unit, UBYTE *buffer);
 int SIO_FormatDisk(int unit, UBYTE *buffer, int sectsize, int sectcount);
 void SIO_SizeOfSector(UBYTE unit, int sector, int *sz, ULONG *ofs);
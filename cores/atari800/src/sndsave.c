@@ -27,9 +27,9 @@
 #include "sndsave.h"
 
 /* sndoutput is just the file pointer for the current sound file */
-static FILE *sndoutput = NULL;
+static THREAD_LOCAL FILE *sndoutput = NULL;
 
-static ULONG byteswritten;
+static THREAD_LOCAL ULONG byteswritten;
 
 /* write 32-bit word as little endian */
 static void write32(long x)
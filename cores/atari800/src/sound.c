@@ -29,54 +29,55 @@
 
 #include "atari.h"
 #include "log.h"
+#include "mzpokeysnd.h"
 #include "platform.h"
 #include "pokeysnd.h"
 #include "util.h"
 
 #define DEBUG 0
 
-int Sound_enabled = 1;
+THREAD_LOCAL int Sound_enabled = 1;
 
-Sound_setup_t Sound_desired = {
+THREAD_LOCAL Sound_setup_t Sound_desired = {
 	44100,
 	2,
 	1,
 	0
 };
 
-Sound_setup_t Sound_out;
+THREAD_LOCAL Sound_setup_t Sound_out;
 
-static int paused = TRUE;
+static THREAD_LOCAL int paused = TRUE;
 
 #ifndef SOUND_CALLBACK
-static UBYTE *process_buffer = NULL;
-static unsigned int process_buffer_size;
+static THREAD_LOCAL UBYTE *process_buffer = NULL;
+static THREAD_LOCAL unsigned int process_buffer_size;
 #endif /* !SOUND_CALLBACK */
 
 #ifdef SYNCHRONIZED_SOUND
-static UBYTE *sync_buffer = NULL;
-static unsigned int sync_buffer_size;
+static THREAD_LOCAL UBYTE *sync_buffer = NULL;
+static THREAD_LOCAL unsigned int sync_buffer_size;
 /* Two invariants are held:
    a) 0 <= sync_read_pos < sync_buffer_size
    b) sync_read_pos <= sync_write_pos <= sync_buffer_size + sync_read_pos
    sync_write_pos may be >= sync_buffer_size. In such case the actual write
    position is sync_write_pos % sync_buffer_size. */
-static unsigned int sync_write_pos;
-static unsigned int sync_read_pos;
+static THREAD_LOCAL unsigned int sync_write_pos;
+static THREAD_LOCAL unsigned int sync_read_pos;
 
-unsigned int Sound_latency = 20;
+THREAD_LOCAL unsigned int Sound_latency = 20;
 /* Cumulative audio difference. */
-static double avg_fill;
+static THREAD_LOCAL double avg_fill;
 /* Estimated fill of sync_buffer */
-static unsigned int sync_est_fill;
+static THREAD_LOCAL unsigned int sync_est_fill;
 /* If sync_est_fill goes outside this bounds, emulation speed is adjusted. */
-static unsigned int sync_min_fill;
-static unsigned int sync_max_fill;
+static THREAD_LOCAL unsigned int sync_min_fill;
+static THREAD_LOCAL unsigned int sync_max_fill;
 #ifdef SOUND_CALLBACK
 #endif /* SOUND_CALLBACK */
 /* Time of last write of sudio to output device (either by Sound_Callback or
    WriteOut). */
-double last_audio_write_time;
+THREAD_LOCAL double last_audio_write_time;
 #endif /* SYNCHRONIZED_SOUND */
 
 enum { MAX_SAMPLE_SIZE = 2, /* for 16-bit */
@@ -159,6 +160,18 @@ int Sound_Initialise(int *argc, char *argv[])
 			Sound_desired.sample_size = 2;
 		else if (strcmp(argv[i], "-audio8") == 0)
 			Sound_desired.sample_size = 1;
+		else if (strcmp(argv[i], "-resampler") == 0) {
+			if (i_a) {
+				char *mode = argv[++i];
+				if (strcmp(mode, "exact") == 0)
+					MZPOKEYSND_resampler = MZPOKEYSND_RESAMPLER_EXACT;
+				else if (strcmp(mode, "block") == 0)
+					MZPOKEYSND_resampler = MZPOKEYSND_RESAMPLER_BLOCK;
+				else
+					a_i = TRUE;
+			}
+			else a_m = TRUE;
+		}
 		else if (strcmp(argv[i], "snd-buflen") == 0) {
 			if (i_a) {
 				int val = Util_sscandec(argv[++i]);
@@ -184,6 +197,7 @@ int Sound_Initialise(int *argc, char *argv[])
 				Log_print("\t-volume <0 .. 100>   Set sound output volume");
 				Log_print("\t-audio16             Set sound output format to 16-bit");
 				Log_print("\t-audio8              Set sound output format to 8-bit");
+				Log_print("\t-resampler exact|block  Select the POKEY output resampler");
 				Log_print("\t-snd-buflen <ms>     Set length of the hardware sound buffer in milliseconds");
 #ifdef SYNCHRONIZED_SOUND
 				Log_print("\t-snddelay <ms>       Set sound latency in milliseconds");
@@ -312,7 +326,7 @@ static void FillBuffer(UBYTE *buffer, unsigned int size)
 {
 #ifdef SYNCHRONIZED_SOUND
 	unsigned int new_read_pos;
-	static UBYTE last_frame[MAX_FRAME_SIZE];
+	static THREAD_LOCAL UBYTE last_frame[MAX_FRAME_SIZE];
 	unsigned int bytes_per_frame = Sound_out.channels * Sound_out.sample_size;
 	unsigned int to_write = sync_write_pos - sync_read_pos;
 
@@ -48,15 +48,15 @@ typedef struct Sound_setup_t {
    Set Sound_desired.buffer_frames to 0 if you want the hardware to decide value of this
    parameter automatically.
  */
-extern Sound_setup_t Sound_desired;
+extern THREAD_LOCAL Sound_setup_t Sound_desired;
 
 /* Holds parameters of the currently-opened hardware audio output. Don't change
    it directly - use Sound_Setup instead. */
-extern Sound_setup_t Sound_out;
+extern THREAD_LOCAL Sound_setup_t Sound_out;
 
 /* Indicates whether sound output is enabled. Don't change it directly - use
    Sound_Setup to enable sound, and Sound_Exit to disable it. */
-extern int Sound_enabled;
+extern THREAD_LOCAL int Sound_enabled;
 
 /* Enables hardware audio output with parameters based on those stored in
    Sound_desired. Stores the parameters of the actual opened output in
@@ -81,7 +81,7 @@ void Sound_WriteConfig(FILE *fp);
 
 #ifdef SYNCHRONIZED_SOUND
 /* Sound latency in ms. Don't change directly - use Sound_SetLatency instead. */
-extern unsigned int Sound_latency;
+extern THREAD_LOCAL unsigned int Sound_latency;
 
 void Sound_SetLatency(unsigned int latency);
 
@@ -105,8 +105,8 @@ static size_t mem_write(const void *buf, size_t len, gzFile stream);
 #define Z_OK    0
 #endif
 
-static gzFile StateFile = NULL;
-static int nFileError = Z_OK;
+static THREAD_LOCAL gzFile StateFile = NULL;
+static THREAD_LOCAL int nFileError = Z_OK;
 
 static void GetGZErrorText(void)
 {
@@ -552,9 +552,9 @@ int StateSav_ReadAtariState(const char *filename, const char *mode)
 /* Common definitions for in-memory state save used for DREAMCAST and libatari800
  */
 #if defined(MEMCOMPR) || defined(LIBATARI800)
-static char * plainmembuf;
-static unsigned int plainmemoff;
-static unsigned int unclen;
+static THREAD_LOCAL char * plainmembuf;
+static THREAD_LOCAL unsigned int plainmemoff;
+static THREAD_LOCAL unsigned int unclen;
 
 /* hack to compress in memory before writing
  * - for DREAMCAST only
@@ -47,71 +47,45 @@
 # include "roms/altirra_basic.h"
 #endif /* EMUOS_ALTIRRA */
 
-int SYSROM_os_versions[Atari800_MACHINE_SIZE] = { SYSROM_AUTO, SYSROM_AUTO, SYSROM_AUTO };
-int SYSROM_basic_version = SYSROM_AUTO;
-int SYSROM_xegame_version = SYSROM_AUTO;
-
-static char osa_ntsc_filename[FILENAME_MAX];
-static char osa_pal_filename[FILENAME_MAX];
-static char osb_ntsc_filename[FILENAME_MAX];
-static char osaa00r10_filename[FILENAME_MAX];
-static char osaa01r11_filename[FILENAME_MAX];
-static char osbb00r1_filename[FILENAME_MAX];
-static char osbb01r2_filename[FILENAME_MAX];
-static char osbb02r3_filename[FILENAME_MAX];
-static char osbb02r3v4_filename[FILENAME_MAX];
-static char oscc01r4_filename[FILENAME_MAX];
-static char osbb01r3_filename[FILENAME_MAX];
-static char osbb01r4_filename[FILENAME_MAX];
-static char osbb01r59_filename[FILENAME_MAX];
-static char osbb01r59a_filename[FILENAME_MAX];
-static char os5200a_filename[FILENAME_MAX];
-static char os5200b_filename[FILENAME_MAX];
-static char basica_filename[FILENAME_MAX];
-static char basicb_filename[FILENAME_MAX];
-static char basicc_filename[FILENAME_MAX];
-static char xegame_filename[FILENAME_MAX];
-static char os800_custom_filename[FILENAME_MAX];
-static char osxl_custom_filename[FILENAME_MAX];
-static char os5200_custom_filename[FILENAME_MAX];
-static char basic_custom_filename[FILENAME_MAX];
-static char xegame_custom_filename[FILENAME_MAX];
+THREAD_LOCAL int SYSROM_os_versions[Atari800_MACHINE_SIZE] = { SYSROM_AUTO, SYSROM_AUTO, SYSROM_AUTO };
+THREAD_LOCAL int SYSROM_basic_version = SYSROM_AUTO;
+THREAD_LOCAL int SYSROM_xegame_version = SYSROM_AUTO;
 
 /* Indicates an unknown checksum - an entry with this value will not be tested for checksum.
    Choose a value different than any known checksum in SYSROM_roms. */
 enum { CRC_NULL = 0 };
 
-SYSROM_t SYSROM_roms[SYSROM_SIZE] = {
-	{ osa_ntsc_filename, 0x2800, 0xc1b3bb02, NULL, TRUE }, /* SYSROM_A_NTSC */
-	{ osa_pal_filename, 0x2800, 0x72b3fed4, NULL, TRUE }, /* SYSROM_A_PAL */
-	{ osb_ntsc_filename, 0x2800, 0x0e86d61d, NULL, TRUE }, /* SYSROM_B_NTSC */
-	{ osaa00r10_filename, 0x4000, 0xc5c11546, NULL, TRUE }, /* SYSROM_AA00R10 */
-	{ osaa01r11_filename, 0x4000, 0x1a1d7b1b, NULL, TRUE }, /* SYSROM_AA01R11 */
-	{ osbb00r1_filename, 0x4000, 0x643bcc98, NULL, TRUE }, /* SYSROM_BB00R1 */
-	{ osbb01r2_filename, 0x4000, 0x1f9cd270, NULL, TRUE }, /* SYSROM_BB01R2 */
-	{ osbb02r3_filename, 0x4000, 0x0d477aa1, NULL, TRUE }, /* SYSROM_BB02R3 */
-	{ osbb02r3v4_filename, 0x4000, 0xd425a9cf, NULL, TRUE }, /* SYSROM_BB02R3V4 */
-	{ oscc01r4_filename, 0x4000, 0x0e000b99, NULL, TRUE }, /* SYSROM_CC01R4 */
-	{ osbb01r3_filename, 0x4000, 0x29f133f7, NULL, TRUE }, /* SYSROM_BB01R3 */
-	{ osbb01r4_filename, 0x4000, 0x1eaf4002, NULL, TRUE }, /* SYSROM_BB01R4_OS */
-	{ osbb01r59_filename, 0x4000, 0x45f47988, NULL, TRUE }, /* SYSROM_BB01R59 */
-	{ osbb01r59a_filename, 0x4000, 0xf0a236d3, NULL, TRUE }, /* SYSROM_BB01R59A */
-	{ os5200a_filename, 0x0800, 0x4248d3e3, NULL, TRUE }, /* SYSROM_5200 */
-	{ os5200b_filename, 0x0800, 0xc2ba2613, NULL, TRUE }, /* SYSROM_5200A */
-	{ basica_filename, 0x2000, 0x4bec4de2, NULL, TRUE }, /* SYSROM_BASIC_A */
-	{ basicb_filename, 0x2000, 0xf0202fb3, NULL, TRUE }, /* SYSROM_BASIC_B */
-	{ basicc_filename, 0x2000, 0x7d684184, NULL, TRUE }, /* SYSROM_BASIC_C */
-	{ xegame_filename, 0x2000, 0xbdca01fb, NULL, TRUE }, /* SYSROM_XEGAME */
-	{ os800_custom_filename, 0x2800, CRC_NULL, NULL, TRUE }, /* SYSROM_400800_CUSTOM */
-	{ osxl_custom_filename, 0x4000, CRC_NULL, NULL, TRUE }, /* SYSROM_XL_CUSTOM */
-	{ os5200_custom_filename, 0x0800, CRC_NULL, NULL, TRUE }, /* SYSROM_5200_CUSTOM */
-	{ basic_custom_filename, 0x2000, CRC_NULL, NULL, TRUE }, /* SYSROM_BASIC_CUSTOM */
-	{ xegame_custom_filename, 0x2000, CRC_NULL, NULL, TRUE }, /* SYSROM_XEGAME_CUSTOM */
+THREAD_LOCAL SYSROM_t SYSROM_roms[SYSROM_SIZE] = {
+	{ "", 0x2800, 0xc1b3bb02, NULL, TRUE }, /* SYSROM_A_NTSC */
+	{ "", 0x2800, 0x72b3fed4, NULL, TRUE }, /* SYSROM_A_PAL */
+	{ "", 0x2800, 0x0e86d61d, NULL, TRUE }, /* SYSROM_B_NTSC */
+	{ "", 0x4000, 0xc5c11546, NULL, TRUE }, /* SYSROM_AA00R10 */
+	{ "", 0x4000, 0x1a1d7b1b, NULL, TRUE }, /* SYSROM_AA01R11 */
+	{ "", 0x4000, 0x643bcc98, NULL, TRUE }, /* SYSROM_BB00R1 */
+	{ "", 0x4000, 0x1f9cd270, NULL, TRUE }, /* SYSROM_BB01R2 */
+	{ "", 0x4000, 0x0d477aa1, NULL, TRUE }, /* SYSROM_BB02R3 */
+	{ "", 0x4000, 0xd425a9cf, NULL, TRUE }, /* SYSROM_BB02R3V4 */
+	{ "", 0x4000, 0x0e000b99, NULL, TRUE }, /* SYSROM_CC01R4 */
+	{ "", 0x4000, 0x29f133f7, NULL, TRUE }, /* SYSROM_BB01R3 */
+	{ "", 0x4000, 0x1eaf4002, NULL, TRUE }, /* SYSROM_BB01R4_OS */
+	{ "", 0x4000, 0x45f47988, NULL, TRUE }, /* SYSROM_BB01R59 */
+	{ "", 0x4000, 0xf0a236d3, NULL, TRUE }, /* SYSROM_BB01R59A */
+	{ "", 0x0800, 0x4248d3e3, NULL, TRUE }, /* SYSROM_5200 */
+	{ "", 0x0800, 0xc2ba2613, NULL, TRUE }, /* SYSROM_5200A */
+	{ "", 0x2000, 0x4bec4de2, NULL, TRUE }, /* SYSROM_BASIC_A */
+	{ "", 0x2000, 0xf0202fb3, NULL, TRUE }, /* SYSROM_BASIC_B */
+	{ "", 0x2000, 0x7d684184, NULL, TRUE }, /* SYSROM_BASIC_C */
+	{ "", 0x2000, 0xbdca01fb, NULL, TRUE }, /* SYSROM_XEGAME */
+	{ "", 0x2800, CRC_NULL, NULL, TRUE }, /* SYSROM_400800_CUSTOM */
+	{ "", 0x4000, CRC_NULL, NULL, TRUE }, /* SYSROM_XL_CUSTOM */
+	{ "", 0x0800, CRC_NULL, NULL, TRUE }, /* SYSROM_5200_CUSTOM */
+	{ "", 0x2000, CRC_NULL, NULL, TRUE }, /* SYSROM_BASIC_CUSTOM */
+	{ "", 0x2000, CRC_NULL, NULL, TRUE }, /* SYSROM_XEGAME_CUSTOM */
 #if EMUOS_ALTIRRA
-	{ NULL, 0x2800, CRC_NULL, ROM_altirraos_800, FALSE }, /* SYSROM_ALTIRRA_800 */
-	{ NULL, 0x4000, CRC_NULL, ROM_altirraos_xl, FALSE }, /* SYSROM_ALTIRRA_XL */
-	{ NULL, 0x0800, CRC_NULL, ROM_altirra_5200_os, FALSE }, /* SYSROM_ALTIRRA_5200 */
-	{ NULL, 0x2000, CRC_NULL, ROM_altirra_basic, FALSE }, /* SYSROM_ALTIRRA_BASIC */
+	{ "", 0x2800, CRC_NULL, ROM_altirraos_800, FALSE }, /* SYSROM_ALTIRRA_800 */
+	{ "", 0x4000, CRC_NULL, ROM_altirraos_xl, FALSE }, /* SYSROM_ALTIRRA_XL */
+	{ "", 0x0800, CRC_NULL, ROM_altirra_5200_os, FALSE }, /* SYSROM_ALTIRRA_5200 */
+	{ "", 0x2000, CRC_NULL, ROM_altirra_basic, FALSE }, /* SYSROM_ALTIRRA_BASIC */
 #endif /* EMUOS_ALTIRRA */
 };
 
@@ -181,7 +155,7 @@ static char const * const cfg_strings_rev[SYSROM_SIZE+1] = {
 };
 
 /* Number of ROM paths not set during initialisation. */
-static int num_unset_roms = SYSROM_LOADABLE_SIZE;
+static THREAD_LOCAL int num_unset_roms = SYSROM_LOADABLE_SIZE;
 
 /* Checks if LEN is a correct ROM length. */
 static int IsLengthAllowed(int len)
@@ -71,7 +71,7 @@ enum {
 	SYSROM_AUTO = SYSROM_SIZE /* Use to indicate that OS revision should be chosen automatically */
 };
 typedef struct SYSROM_t {
-	char *filename; /* Path to the ROM image file */
+	char filename[FILENAME_MAX]; /* Path to the ROM image file */
 	size_t size; /* Expected size of the ROM image */
 	ULONG crc32; /* Expected CRC32 of the ROM image */
 	UBYTE const *data; /* Pointer to ROM data in case of built-in ROMs */
@@ -79,18 +79,18 @@ typedef struct SYSROM_t {
 } SYSROM_t;
 
 /* Table of all supported ROM images with their sizes and CRCs, indexed by ROM IDs. */
-extern SYSROM_t SYSROM_roms[SYSROM_SIZE];
+extern THREAD_LOCAL SYSROM_t SYSROM_roms[SYSROM_SIZE];
 
 /* OS version preference chosen by user. Indexed by value of Atari800_machine_type.
    Set these to SYSROM_AUTO to let the emulator choose the OS revision automatically. */
-extern int SYSROM_os_versions[Atari800_MACHINE_SIZE];
+extern THREAD_LOCAL int SYSROM_os_versions[Atari800_MACHINE_SIZE];
 /* BASIC version preference chosen by user. Set this to SYSROM_AUTO to let the emulator
    choose the BASIC revision automatically. */
-extern int SYSROM_basic_version;
+extern THREAD_LOCAL int SYSROM_basic_version;
 
 /* XEGS game version preference chosen by user. Set this to SYSROM_AUTO to let the emulator
    choose the game ROM automatically. */
-extern int SYSROM_xegame_version;
+extern THREAD_LOCAL int SYSROM_xegame_version;
 
 /* Values returned by SYSROM_SetPath(). */
 enum{
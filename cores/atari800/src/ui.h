@@ -33,9 +33,9 @@ int UI_SelectCartType(int k);
 int UI_Initialise(int *argc, char *argv[]);
 void UI_Run(void);
 
-extern int UI_is_active;
-extern int UI_alt_function;
-extern int UI_current_function;
+extern THREAD_LOCAL int UI_is_active;
+extern THREAD_LOCAL int UI_alt_function;
+extern THREAD_LOCAL int UI_current_function;
 
 #ifdef CRASH_MENU
 extern int UI_crash_code;
@@ -45,12 +45,12 @@ extern UWORD UI_crash_afterCIM;
 
 #define UI_MAX_DIRECTORIES 8
 
-extern char UI_atari_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
-extern char UI_saved_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
-extern int UI_n_atari_files_dir;
-extern int UI_n_saved_files_dir;
+extern THREAD_LOCAL char UI_atari_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
+extern THREAD_LOCAL char UI_saved_files_dir[UI_MAX_DIRECTORIES][FILENAME_MAX];
+extern THREAD_LOCAL int UI_n_atari_files_dir;
+extern THREAD_LOCAL int UI_n_saved_files_dir;
 
-extern int UI_show_hidden_files;
+extern THREAD_LOCAL int UI_show_hidden_files;
 
 #ifdef GUI_SDL
 void PLATFORM_SetJoystickKey(int joystick, int direction, int value);
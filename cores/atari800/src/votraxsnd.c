@@ -40,21 +40,21 @@
 
 #define VTRX_RATE 24500
 
-static double ratio;
-static int bit16;
+static THREAD_LOCAL double ratio;
+static THREAD_LOCAL int bit16;
 #define VTRX_BLOCK_SIZE 1024
-SWORD *temp_votrax_buffer = NULL;
-SWORD *votrax_buffer = NULL;
-int VOTRAXSND_busy = FALSE;
-static int votrax_sync_samples;
-static int dsprate;
-static int num_pokeys;
-static int samples_per_frame;
+THREAD_LOCAL SWORD *temp_votrax_buffer = NULL;
+THREAD_LOCAL SWORD *votrax_buffer = NULL;
+THREAD_LOCAL int VOTRAXSND_busy = FALSE;
+static THREAD_LOCAL int votrax_sync_samples;
+static THREAD_LOCAL int dsprate;
+static THREAD_LOCAL int num_pokeys;
+static THREAD_LOCAL int samples_per_frame;
 /*if SYNCHRONIZED_SOUND is not used and the sound generation runs in a
  * separate thread, then these variables are accessed in two different
  * threads: */
-static int votrax_written = FALSE;
-static int votrax_written_byte = 0x3f;
+static THREAD_LOCAL int votrax_written = FALSE;
+static THREAD_LOCAL int votrax_written_byte = 0x3f;
 
 void VOTRAXSND_PutByte(UBYTE byte)
 {
@@ -95,7 +95,7 @@ static int votraxsnd_enabled(void)
 /* called from POKEYSND_Init */
 void VOTRAXSND_Init(int playback_freq, int n_pokeys, int b16)
 {
-	static struct Votrax_interface vi;
+	static THREAD_LOCAL struct Votrax_interface vi;
 	int temp_votrax_buffer_size;
 	bit16 = b16;
 	dsprate = playback_freq;
@@ -139,10 +139,10 @@ void VOTRAXSND_Reinit(void)
 /* process votrax and interpolate samples */
 static void votrax_process(SWORD *v_buffer, int len, SWORD *temp_v_buffer)
 {
-	static SWORD last_sample;
-	static SWORD last_sample2;
-	static double startpos;
-	static int have;
+	static THREAD_LOCAL SWORD last_sample;
+	static THREAD_LOCAL SWORD last_sample2;
+	static THREAD_LOCAL double startpos;
+	static THREAD_LOCAL int have;
 	int max_left_sample_index = (int)(startpos + (double)(len - 1)*ratio);
 	int pos = 0;
 	double fraction = 0;
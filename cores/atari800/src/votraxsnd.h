@@ -8,7 +8,7 @@ void VOTRAXSND_PutByte(UBYTE byte);
 void VOTRAXSND_Init(int playback_freq, int n_pokeys, int b16);
 void VOTRAXSND_Frame(void);
 void VOTRAXSND_Process(void *sndbuffer, int sndn);
-extern int VOTRAXSND_busy;
+extern THREAD_LOCAL int VOTRAXSND_busy;
 void VOTRAXSND_Reinit(void);
 void VOTRAXSND_ModifyRatio(double factor);
 
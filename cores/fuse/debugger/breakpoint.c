@@ -27,6 +27,7 @@
 #include <config.h>
 
 #include <ctype.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <libspectrum.h>
@@ -44,6 +45,15 @@ GSList *debugger_breakpoints;
 /* The next breakpoint ID to use */
 static size_t next_breakpoint_id;
 
+/* Index of the current breakpoints, so debugger_check() walks the list
+   only when some breakpoint may trigger: for each address and port type,
+   one bit per address or port a breakpoint of that type could match, and
+   the number of breakpoints of every type */
+#define BREAKPOINT_BITMAP_TYPES ( DEBUGGER_BREAKPOINT_TYPE_PORT_WRITE + 1 )
+
+static libspectrum_byte breakpoint_bitmap[ BREAKPOINT_BITMAP_TYPES ][ 0x10000 / 8 ];
+static size_t breakpoint_count[ DEBUGGER_BREAKPOINT_TYPE_EVENT + 1 ];
+
 /* Textual representations of the breakpoint types and lifetimes */
 const char *debugger_breakpoint_type_text[] = {
   "Execute", "Read", "Write", "Port Read", "Port Write", "Time", "Event",
@@ -65,6 +75,9 @@ static int breakpoint_add( debugger_breakpoint_type type,
 			   debugger_breakpoint_value value, size_t ignore,
 			   debugger_breakpoint_life life,
 			   debugger_expression *condition );
+static int breakpoint_matches( debugger_breakpoint *bp,
+			       debugger_breakpoint_type type,
+			       libspectrum_dword value );
 static int breakpoint_check( debugger_breakpoint *bp,
 			     debugger_breakpoint_type type,
 			     libspectrum_dword value );
@@ -212,6 +225,7 @@ breakpoint_add( debugger_breakpoint_type type, debugger_breakpoint_value value,
   bp->commands = NULL;
 
   debugger_breakpoints = g_slist_append( debugger_breakpoints, bp );
+  debugger_breakpoint_update_index();
 
   if( debugger_mode == DEBUGGER_MODE_INACTIVE )
     debugger_mode = DEBUGGER_MODE_ACTIVE;
@@ -240,6 +254,14 @@ debugger_check( debugger_breakpoint_type type, libspectrum_dword value )
   case DEBUGGER_MODE_INACTIVE: return 0;
 
   case DEBUGGER_MODE_ACTIVE:
+    if( type < BREAKPOINT_BITMAP_TYPES ) {
+      if( !( breakpoint_bitmap[ type ][ ( value & 0xffff ) >> 3 ] &
+             ( 1 << ( value & 7 ) ) ) )
+        return 0;
+    } else if( !breakpoint_count[ type ] ) {
+      return 0;
+    }
+
     for( ptr = debugger_breakpoints; ptr; ptr = ptr_next ) {
 
       bp = ptr->data;
@@ -257,6 +279,7 @@ debugger_check( debugger_breakpoint_type type, libspectrum_dword value )
       }
 
     }
+    if( signal_breakpoints_updated ) debugger_breakpoint_update_index();
     break;
 
   case DEBUGGER_MODE_HALTED: return 1;
@@ -270,6 +293,63 @@ debugger_check( debugger_breakpoint_type type, libspectrum_dword value )
   return ( debugger_mode == DEBUGGER_MODE_HALTED );
 }
 
+static void
+index_set( debugger_breakpoint_type type, libspectrum_word value )
+{
+  breakpoint_bitmap[ type ][ value >> 3 ] |= 1 << ( value & 7 );
+}
+
+/* Rebuild the index after the list of breakpoints has changed */
+void
+debugger_breakpoint_update_index( void )
+{
+  GSList *ptr;
+  debugger_breakpoint *bp;
+  libspectrum_word bank, port, mask, free_bits, bits;
+
+  memset( breakpoint_bitmap, 0, sizeof( breakpoint_bitmap ) );
+  memset( breakpoint_count, 0, sizeof( breakpoint_count ) );
+
+  for( ptr = debugger_breakpoints; ptr; ptr = ptr->next ) {
+    bp = ptr->data;
+
+    breakpoint_count[ bp->type ]++;
+
+    switch( bp->type ) {
+
+    case DEBUGGER_BREAKPOINT_TYPE_EXECUTE:
+    case DEBUGGER_BREAKPOINT_TYPE_READ:
+    case DEBUGGER_BREAKPOINT_TYPE_WRITE:
+      /* A page-specific breakpoint may match its offset in any 16K bank,
+         depending on what is paged in there */
+      if( bp->value.address.source == memory_source_any ) {
+        index_set( bp->type, bp->value.address.offset );
+      } else if( bp->value.address.offset < 0x4000 ) {
+        for( bank = 0; bank < 4; bank++ )
+          index_set( bp->type, bank * 0x4000 + bp->value.address.offset );
+      }
+      break;
+
+    case DEBUGGER_BREAKPOINT_TYPE_PORT_READ:
+    case DEBUGGER_BREAKPOINT_TYPE_PORT_WRITE:
+      /* Every port which gives the breakpoint's port after masking */
+      port = bp->value.port.port; mask = bp->value.port.mask;
+      if( port & ~mask ) break;
+      free_bits = ~mask; bits = 0;
+      do {
+        index_set( bp->type, port | bits );
+        bits = ( bits - free_bits ) & free_bits;
+      } while( bits );
+      break;
+
+    case DEBUGGER_BREAKPOINT_TYPE_TIME:
+    case DEBUGGER_BREAKPOINT_TYPE_EVENT:
+      break;
+
+    }
+  }
+}
+
 void
 debugger_breakpoint_reduce_tstates( libspectrum_dword tstates )
 {
@@ -324,11 +404,11 @@ debugger_breakpoint_trigger( debugger_breakpoint *bp )
   return 1;
 }
 
-/* Check whether 'bp' should trigger if we're looking for a breakpoint
-   of 'type' with parameter 'value'. Returns non-zero if we should trigger */
+/* Check whether 'bp' matches a breakpoint of 'type' with parameter
+   'value', without counting it as a hit */
 static int
-breakpoint_check( debugger_breakpoint *bp, debugger_breakpoint_type type,
-		  libspectrum_dword value )
+breakpoint_matches( debugger_breakpoint *bp, debugger_breakpoint_type type,
+                    libspectrum_dword value )
 {
   if( bp->type != type ) return 0;
 
@@ -367,7 +447,17 @@ breakpoint_check( debugger_breakpoint *bp, debugger_breakpoint_type type,
 
   }
 
-  return debugger_breakpoint_trigger( bp );
+  return 1;
+}
+
+/* Check whether 'bp' should trigger if we're looking for a breakpoint
+   of 'type' with parameter 'value'. Returns non-zero if we should trigger */
+static int
+breakpoint_check( debugger_breakpoint *bp, debugger_breakpoint_type type,
+		  libspectrum_dword value )
+{
+  return breakpoint_matches( bp, type, value ) &&
+         debugger_breakpoint_trigger( bp );
 }
 
 struct remove_t {
@@ -386,6 +476,7 @@ debugger_breakpoint_remove( size_t id )
   bp = get_breakpoint_by_id( id ); if( !bp ) return 1;
 
   debugger_breakpoints = g_slist_remove( debugger_breakpoints, bp );
+  debugger_breakpoint_update_index();
   if( debugger_mode == DEBUGGER_MODE_ACTIVE && !debugger_breakpoints )
     debugger_mode = DEBUGGER_MODE_INACTIVE;
 
@@ -474,6 +565,8 @@ debugger_breakpoint_clear( libspectrum_word address )
     free_breakpoint( ptr_data, NULL );
   }
 
+  debugger_breakpoint_update_index();
+
   if( !found ) {
     if( debugger_output_base == 10 ) {
       ui_error( UI_ERROR_ERROR, "No breakpoint at %d", address );
@@ -510,6 +603,7 @@ debugger_breakpoint_remove_all( void )
 {
   g_slist_foreach( debugger_breakpoints, free_breakpoint, NULL );
   g_slist_free( debugger_breakpoints ); debugger_breakpoints = NULL;
+  debugger_breakpoint_update_index();
 
   if( debugger_mode == DEBUGGER_MODE_ACTIVE )
     debugger_mode = DEBUGGER_MODE_INACTIVE;
@@ -621,3 +715,100 @@ debugger_breakpoint_time_fn( libspectrum_dword tstates, int type GCC_UNUSED,
 {
   debugger_check( DEBUGGER_BREAKPOINT_TYPE_TIME, 0 );
 }
+
+/* Check the index against the list: every address or port some
+   breakpoint matches must have its bit set, and for breakpoints which
+   do not depend on paging no other bit may be set */
+static int
+index_unittest_check( int exact )
+{
+  GSList *ptr;
+  debugger_breakpoint_type type;
+  libspectrum_dword value;
+  int matched, indexed;
+
+  for( type = 0; type < BREAKPOINT_BITMAP_TYPES; type++ ) {
+    for( value = 0; value < 0x10000; value++ ) {
+      matched = 0;
+      for( ptr = debugger_breakpoints; ptr && !matched; ptr = ptr->next )
+        matched = breakpoint_matches( ptr->data, type, value );
+
+      indexed = !!( breakpoint_bitmap[ type ][ value >> 3 ] &
+                    ( 1 << ( value & 7 ) ) );
+
+      if( ( matched && !indexed ) || ( exact && indexed && !matched ) ) {
+        printf( "%s:%d: breakpoint index wrong for %s 0x%04x\n", __FILE__,
+                __LINE__, debugger_breakpoint_type_text[ type ],
+                (unsigned int)value );
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+int
+debugger_breakpoint_unittest( void )
+{
+  enum debugger_mode_t mode = debugger_mode;
+  size_t i;
+  int r = 0;
+
+  debugger_breakpoint_remove_all();
+
+  for( i = 0; i < 10; i++ ) {
+    debugger_breakpoint_add_address( DEBUGGER_BREAKPOINT_TYPE_EXECUTE,
+                                     memory_source_any, 0, 0x8000 + i * 331,
+                                     0, DEBUGGER_BREAKPOINT_LIFE_PERMANENT,
+                                     NULL );
+    debugger_breakpoint_add_address( DEBUGGER_BREAKPOINT_TYPE_WRITE,
+                                     memory_source_any, 0, 0x4000 + i * 77,
+                                     0, DEBUGGER_BREAKPOINT_LIFE_PERMANENT,
+                                     NULL );
+  }
+  debugger_breakpoint_add_address( DEBUGGER_BREAKPOINT_TYPE_READ,
+                                   memory_source_any, 0, 0xffff, 0,
+                                   DEBUGGER_BREAKPOINT_LIFE_ONESHOT, NULL );
+  debugger_breakpoint_add_port( DEBUGGER_BREAKPOINT_TYPE_PORT_READ,
+                                0x00fe, 0x00ff, 0,
+                                DEBUGGER_BREAKPOINT_LIFE_PERMANENT, NULL );
+  debugger_breakpoint_add_port( DEBUGGER_BREAKPOINT_TYPE_PORT_WRITE,
+                                0x0000, 0x8002, 0,
+                                DEBUGGER_BREAKPOINT_LIFE_PERMANENT, NULL );
+  debugger_breakpoint_add_port( DEBUGGER_BREAKPOINT_TYPE_PORT_WRITE,
+                                0x0001, 0x0000, 0,
+                                DEBUGGER_BREAKPOINT_LIFE_PERMANENT, NULL );
+  r += index_unittest_check( 1 );
+
+  /* A one shot breakpoint leaves the index when it triggers */
+  debugger_mode = DEBUGGER_MODE_ACTIVE;
+  if( !debugger_check( DEBUGGER_BREAKPOINT_TYPE_READ, 0xffff ) ) {
+    printf( "%s:%d: breakpoint did not trigger\n", __FILE__, __LINE__ );
+    r++;
+  }
+  debugger_mode = DEBUGGER_MODE_ACTIVE;
+  if( debugger_check( DEBUGGER_BREAKPOINT_TYPE_READ, 0xffff ) ||
+      debugger_check( DEBUGGER_BREAKPOINT_TYPE_EXECUTE, 0x8001 ) ) {
+    printf( "%s:%d: breakpoint triggered\n", __FILE__, __LINE__ );
+    r++;
+  }
+  r += index_unittest_check( 1 );
+
+  /* Page-specific breakpoints may match in any bank */
+  debugger_breakpoint_add_address( DEBUGGER_BREAKPOINT_TYPE_EXECUTE,
+                                   memory_map_read[0].source,
+                                   memory_map_read[0].page_num, 0x0038, 0,
+                                   DEBUGGER_BREAKPOINT_LIFE_PERMANENT, NULL );
+  r += index_unittest_check( 0 );
+
+  debugger_breakpoint_clear( 0x8000 );
+  r += index_unittest_check( 0 );
+
+  debugger_breakpoint_remove_all();
+  r += index_unittest_check( 1 );
+
+  debugger_mode = mode;
+
+  return r;
+}
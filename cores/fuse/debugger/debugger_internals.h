@@ -43,6 +43,7 @@ int debugger_breakpoint_set_condition( size_t id,
 				       debugger_expression *condition );
 int debugger_breakpoint_set_commands( size_t id, const char *commands );
 int debugger_breakpoint_trigger( debugger_breakpoint *bp );
+void debugger_breakpoint_update_index( void );
 
 int debugger_poke( libspectrum_word address, libspectrum_byte value );
 int debugger_port_write( libspectrum_word address, libspectrum_byte value );
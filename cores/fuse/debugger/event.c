@@ -122,8 +122,10 @@ debugger_event( int event_code )
     }
   }
 
-  if( signal_breakpoints_updated )
-      ui_breakpoints_updated();
+  if( signal_breakpoints_updated ) {
+    debugger_breakpoint_update_index();
+    ui_breakpoints_updated();
+  }
 }
 
 /* Tidy-up function called at end of emulation */
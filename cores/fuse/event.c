@@ -23,6 +23,7 @@
 
 #include <config.h>
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <libspectrum.h>
@@ -39,11 +40,17 @@ static const libspectrum_dword event_no_events = 0xffffffff;
 /* When will the next event happen? */
 libspectrum_dword event_next_event;
 
-/* The actual list of events */
-static GSList *event_list = NULL;
+/* The pending events, kept as a binary min-heap ordered by time, then by
+   type and then most recently added first, as the sorted event list this
+   replaced did, so event_heap[0] is always the next one due. The array doubles
+   as the pool the events live in: adding or doing an event never allocates
+   once it has grown to the largest number of pending events */
+static event_t *event_heap = NULL;
+static size_t event_heap_count = 0;
+static size_t event_heap_size = 0;
 
-/* An event ready to be reused */
-static event_t *event_free = NULL;
+/* Number of events added so far; gives each event its `sequence' */
+static libspectrum_qword event_sequence = 0;
 
 /* A null event */
 int event_type_null;
@@ -80,90 +87,129 @@ event_register( event_fn_t fn, const char *description )
   return registered_events->len - 1;
 }
 
-static gint
-event_add_cmp( gconstpointer a1, gconstpointer b1 )
+static inline int
+event_before( const event_t *a, const event_t *b )
+{
+  if( a->tstates != b->tstates ) return a->tstates < b->tstates;
+  if( a->type != b->type ) return a->type < b->type;
+  return a->sequence > b->sequence;
+}
+
+static int
+event_compare( const void *a1, const void *b1 )
 {
   const event_t *a = a1, *b = b1;
 
-  return a->tstates != b->tstates ? a->tstates - b->tstates
-		                  : a->type - b->type;
+  if( event_before( a, b ) ) return -1;
+  return event_before( b, a );
+}
+
+/* Move `event' up from the hole at `i' to its place in the heap */
+static void
+event_sift_up( size_t i, const event_t *event )
+{
+  while( i > 0 ) {
+    size_t parent = ( i - 1 ) / 2;
+    if( !event_before( event, &event_heap[ parent ] ) ) break;
+    event_heap[i] = event_heap[ parent ];
+    i = parent;
+  }
+  event_heap[i] = *event;
+}
+
+/* Move `event' down from the hole at `i' to its place in the heap */
+static void
+event_sift_down( size_t i, const event_t *event )
+{
+  size_t child;
+
+  while( ( child = 2 * i + 1 ) < event_heap_count ) {
+    if( child + 1 < event_heap_count &&
+        event_before( &event_heap[ child + 1 ], &event_heap[ child ] ) )
+      child++;
+    if( !event_before( &event_heap[ child ], event ) ) break;
+    event_heap[i] = event_heap[ child ];
+    i = child;
+  }
+  event_heap[i] = *event;
+}
+
+static void
+event_update_next( void )
+{
+  event_next_event = event_heap_count ? event_heap[0].tstates
+                                      : event_no_events;
+}
+
+/* Restore the heap order after events have been changed in place */
+static void
+event_heapify( void )
+{
+  size_t i;
+
+  for( i = event_heap_count / 2; i-- > 0; ) {
+    event_t event = event_heap[i];
+    event_sift_down( i, &event );
+  }
+
+  event_update_next();
 }
 
 /* Add an event at the correct place in the event list */
 void
 event_add_with_data( libspectrum_dword event_time, int type, void *user_data )
 {
-  event_t *ptr;
+  event_t event;
 
-  if( event_free ) {
-    ptr = event_free;
-    event_free = NULL;
-  } else {
-    ptr = libspectrum_new( event_t, 1 );
+  if( event_heap_count == event_heap_size ) {
+    event_heap_size = event_heap_size ? 2 * event_heap_size : 64;
+    event_heap = libspectrum_renew( event_t, event_heap, event_heap_size );
   }
 
-  ptr->tstates = event_time;
-  ptr->type =type;
-  ptr->user_data = user_data;
+  event.tstates = event_time;
+  event.type = type;
+  event.user_data = user_data;
+  event.sequence = event_sequence++;
 
-  if( event_time < event_next_event ) {
-    event_next_event = event_time;
-    event_list = g_slist_prepend( event_list, ptr );
-  } else {
-    event_list = g_slist_insert_sorted( event_list, ptr, event_add_cmp );
-  }
+  event_sift_up( event_heap_count++, &event );
+
+  if( event_time < event_next_event ) event_next_event = event_time;
 }
 
 /* Do all events which have passed */
 int
 event_do_events( void )
 {
-  event_t *ptr;
+  event_t event;
 
   while(event_next_event <= tstates) {
     event_descriptor_t descriptor;
-    ptr = event_list->data;
+    event = event_heap[0];
     descriptor =
-      g_array_index( registered_events, event_descriptor_t, ptr->type );
-
-    /* Remove the event from the list *before* processing */
-    event_list = g_slist_remove( event_list, ptr );
+      g_array_index( registered_events, event_descriptor_t, event.type );
 
-    if( event_list == NULL ) {
-      event_next_event = event_no_events;
-    } else {
-      event_next_event = ((event_t*)(event_list->data))->tstates;
-    }
+    /* Remove the event from the heap *before* processing */
+    if( --event_heap_count ) event_sift_down( 0, &event_heap[ event_heap_count ] );
 
-    if( descriptor.fn ) descriptor.fn( ptr->tstates, ptr->type, ptr->user_data );
+    event_update_next();
 
-    if( event_free ) {
-      libspectrum_free( ptr );
-    } else {
-      event_free = ptr;
-    }
+    if( descriptor.fn ) descriptor.fn( event.tstates, event.type, event.user_data );
   }
 
   return 0;
 }
 
-static void
-event_reduce_tstates( gpointer data, gpointer user_data )
-{
-  event_t *ptr = data;
-  libspectrum_dword *tstates_per_frame = user_data;
-
-  ptr->tstates -= *tstates_per_frame;
-}
-
 /* Called at end of frame to reduce T-state count of all entries */
 void
 event_frame( libspectrum_dword tstates_per_frame )
 {
-  g_slist_foreach( event_list, event_reduce_tstates, &tstates_per_frame );
+  size_t i;
+
+  /* Subtracting the same amount from every entry keeps the heap order */
+  for( i = 0; i < event_heap_count; i++ )
+    event_heap[i].tstates -= tstates_per_frame;
 
-  event_next_event = event_list ?
-    ((event_t*)(event_list->data))->tstates : event_no_events;
+  event_update_next();
 }
 
 /* Do all events that would happen between the current time and when
@@ -183,69 +229,62 @@ event_force_events( void )
   }
 }
 
-static void
-set_event_null( gpointer data, gpointer user_data )
-{
-  event_t *ptr = data;
-  int *type = user_data;
-
-  if( ptr->type == *type ) ptr->type = event_type_null;
-}
-
-static void
-set_event_null_with_user_data( gpointer data, gpointer user_data )
-{
-  event_t *event = data;
-  event_t *template = user_data;
-
-  if( event->type == template->type && event->user_data == template->user_data )
-    event->type = event_type_null;
-}
-
 /* Remove all events of a specific type from the stack */
 void
 event_remove_type( int type )
 {
-  g_slist_foreach( event_list, set_event_null, &type );
+  size_t i, n = 0;
+
+  for( i = 0; i < event_heap_count; i++ )
+    if( event_heap[i].type != type ) event_heap[ n++ ] = event_heap[i];
+
+  if( n != event_heap_count ) {
+    event_heap_count = n;
+    event_heapify();
+  }
 }
 
 /* Remove all events of a specific type and user data from the stack */
 void
 event_remove_type_user_data( int type, gpointer user_data )
 {
-  event_t template;
+  size_t i, n = 0;
 
-  template.type = type;
-  template.user_data = user_data;
-  g_slist_foreach( event_list, set_event_null_with_user_data, &template );
-}
+  for( i = 0; i < event_heap_count; i++ )
+    if( event_heap[i].type != type || event_heap[i].user_data != user_data )
+      event_heap[ n++ ] = event_heap[i];
 
-/* Free the memory used by a specific entry */
-static void
-event_free_entry( gpointer data, gpointer user_data GCC_UNUSED )
-{
-  libspectrum_free( data );
+  if( n != event_heap_count ) {
+    event_heap_count = n;
+    event_heapify();
+  }
 }
 
 /* Clear the event stack */
 void
 event_reset( void )
 {
-  g_slist_foreach( event_list, event_free_entry, NULL );
-  g_slist_free( event_list );
-  event_list = NULL;
+  event_heap_count = 0;
 
   event_next_event = event_no_events;
-
-  libspectrum_free( event_free );
-  event_free = NULL;
 }
 
-/* Call a user-supplied function for every event in the current list */
+/* Call a user-supplied function for every event in the current list, in
+   the order they will happen. A sorted array is also a valid heap; the heap
+   is rebuilt afterwards in case `function' changed any event. `function'
+   gets pointers into event_heap, so it must not add or remove events: adding
+   one may move the heap and removing one reorders it */
 void
 event_foreach( GFunc function, gpointer user_data )
 {
-  g_slist_foreach( event_list, function, user_data );
+  size_t i;
+
+  qsort( event_heap, event_heap_count, sizeof( event_t ), event_compare );
+
+  for( i = 0; i < event_heap_count; i++ )
+    function( &event_heap[i], user_data );
+
+  event_heapify();
 }
 
 /* A textual representation of each event type */
@@ -277,6 +316,9 @@ static void
 event_end( void )
 {
   event_reset();
+  libspectrum_free( event_heap );
+  event_heap = NULL;
+  event_heap_size = 0;
   registered_events_free();
 }
 
@@ -35,6 +35,10 @@ typedef struct event_t {
   libspectrum_dword tstates;
   int type;
   void *user_data;
+
+  /* Order in which the event was added, to break ties between events of
+     the same type at the same time */
+  libspectrum_qword sequence;
 } event_t;
 
 /* A null event type */
@@ -77,7 +81,9 @@ void event_remove_type_user_data( int type, gpointer user_data );
 /* Clear the event stack */
 void event_reset( void );
 
-/* Call a user-supplied function for every event in the current list */
+/* Call a user-supplied function for every event in the current list, in
+   the order they will happen. `function' is passed a pointer to each event
+   and may change it, but must not add or remove events */
 void event_foreach( GFunc function, gpointer user_data );
 
 /* A textual representation of each event type */
@@ -27,6 +27,7 @@
 #include <libspectrum.h>
 
 #include "debugger/debugger.h"
+#include "event.h"
 #include "fuse.h"
 #include "machine.h"
 #include "mempool.h"
@@ -47,7 +48,11 @@
 #include "peripherals/ula.h"
 #include "peripherals/usource.h"
 #include "settings.h"
+#include "sound.h"
+#include "spectrum.h"
+#include "timer/timer.h"
 #include "unittests.h"
+#include "z80/z80.h"
 
 static int
 contention_test( void )
@@ -308,6 +313,309 @@ mempool_test( void )
   return 0;
 }
 
+static int event_test_type_a, event_test_type_b, event_test_type_bench;
+static int event_test_done, event_test_in_order;
+static libspectrum_dword event_test_last_tstates;
+static int event_test_last_type;
+static libspectrum_dword event_test_period[256];
+static int event_test_type_order, event_test_order[9];
+static int *event_test_order_seen[9];
+static size_t event_test_order_count;
+
+static void
+event_test_order_fn( libspectrum_dword event_tstates, int type,
+                     void *user_data )
+{
+  if( event_test_order_count < 9 )
+    event_test_order_seen[ event_test_order_count ] = user_data;
+  event_test_order_count++;
+}
+
+static void
+event_test_fn( libspectrum_dword event_tstates, int type, void *user_data )
+{
+  if( event_test_done &&
+      ( event_tstates < event_test_last_tstates ||
+        ( event_tstates == event_test_last_tstates &&
+          type < event_test_last_type ) ) )
+    event_test_in_order = 0;
+
+  event_test_last_tstates = event_tstates;
+  event_test_last_type = type;
+  event_test_done++;
+}
+
+static void
+event_test_count( gpointer data, gpointer user_data )
+{
+  event_t *event = data;
+  int *count = user_data;
+
+  if( event->type == event_test_type_a || event->type == event_test_type_b )
+    (*count)++;
+}
+
+static void
+event_test_sorted( gpointer data, gpointer user_data )
+{
+  event_t *event = data;
+  event_t *last = user_data;
+
+  if( event->tstates < last->tstates ||
+      ( event->tstates == last->tstates && event->type < last->type ) )
+    last->user_data = NULL;
+
+  last->tstates = event->tstates;
+  last->type = event->type;
+}
+
+static int
+event_test( void )
+{
+  static int marker;
+  event_t last;
+  int i, count, expected_a = 0, expected_b = 0, marked = 0;
+  libspectrum_dword seed = 1;
+
+  if( !event_test_type_a ) {
+    event_test_type_a = event_register( event_test_fn, "Test event A" );
+    event_test_type_b = event_register( event_test_fn, "Test event B" );
+    event_test_type_order = event_register( event_test_order_fn,
+                                            "Test event order" );
+  }
+
+  event_reset();
+  tstates = 0;
+
+  for( i = 0; i < 1000; i++ ) {
+    seed = seed * 1103515245 + 12345;
+    if( i & 1 ) {
+      event_add_with_data( 10000 + ( seed >> 8 ) % 60000, event_test_type_a,
+                           NULL );
+      expected_a++;
+    } else {
+      event_add_with_data( 10000 + ( seed >> 8 ) % 60000, event_test_type_b,
+                           ( i & 2 ) ? &marker : NULL );
+      if( i & 2 ) marked++; else expected_b++;
+    }
+  }
+
+  TEST_ASSERT( event_next_event >= 10000 );
+
+  event_remove_type_user_data( event_test_type_b, &marker );
+
+  count = 0;
+  event_foreach( event_test_count, &count );
+  TEST_ASSERT( count == expected_a + expected_b );
+
+  last.tstates = 0; last.type = 0; last.user_data = &last;
+  event_foreach( event_test_sorted, &last );
+  TEST_ASSERT( last.user_data == &last );
+
+  /* Nothing is due before the first event */
+  event_test_done = 0; event_test_in_order = 1;
+  tstates = 9999;
+  event_do_events();
+  TEST_ASSERT( event_test_done == 0 );
+
+  /* Do the first half, then move to the next frame */
+  tstates = 40000;
+  event_do_events();
+  count = event_test_done;
+  TEST_ASSERT( count > 0 && event_test_in_order );
+  TEST_ASSERT( event_next_event > 40000 );
+
+  event_frame( 30000 );
+  TEST_ASSERT( event_next_event > 10000 );
+  event_test_last_tstates = 0;
+
+  tstates = 40000;
+  event_do_events();
+  TEST_ASSERT( event_test_done == expected_a + expected_b );
+  TEST_ASSERT( event_test_in_order );
+  TEST_ASSERT( event_next_event == 0xffffffff );
+
+  /* Removing a type leaves the others alone */
+  event_add( 100, event_test_type_a );
+  event_add( 50, event_test_type_b );
+  event_add( 200, event_test_type_a );
+  event_remove_type( event_test_type_a );
+  TEST_ASSERT( event_next_event == 50 );
+  event_test_done = 0;
+  tstates = 1000;
+  event_do_events();
+  TEST_ASSERT( event_test_done == 1 && event_test_last_type == event_test_type_b );
+
+  /* Events of the same type at the same time happen most recently added
+     first */
+  event_test_order_count = 0;
+  for( i = 0; i < 8; i++ )
+    event_add_with_data( 2000, event_test_type_order,
+                         &event_test_order[ 7 - i ] );
+  event_add_with_data( 1500, event_test_type_order, &event_test_order[ 8 ] );
+  tstates = 2000;
+  event_do_events();
+  TEST_ASSERT( event_test_order_count == 9 );
+  TEST_ASSERT( event_test_order_seen[0] == &event_test_order[ 8 ] );
+  for( i = 0; i < 8; i++ )
+    TEST_ASSERT( event_test_order_seen[ i + 1 ] == &event_test_order[i] );
+
+  event_reset();
+  tstates = 0;
+
+  return 0;
+}
+
+static void
+event_benchmark_fn( libspectrum_dword event_tstates, int type,
+                    void *user_data )
+{
+  event_add_with_data( event_tstates +
+                         event_test_period[ GPOINTER_TO_INT( user_data ) ],
+                       type, user_data );
+  event_test_done++;
+}
+
+/* Not a test: report the cost of the event loop for a growing number of
+   pending events, each rescheduling itself as the ULA, AY and tape do */
+static int
+event_benchmark( void )
+{
+  const libspectrum_dword frame_length = 69888;
+  const int frames = 2000;
+  int i, n, frame;
+  double start, elapsed;
+
+  if( !event_test_type_bench )
+    event_test_type_bench = event_register( event_benchmark_fn,
+                                            "Benchmark event" );
+
+  for( n = 4; n <= 256; n *= 4 ) {
+
+    event_reset();
+    tstates = 0;
+
+    for( i = 0; i < n; i++ ) {
+      event_test_period[i] = 224 + ( i * 7919 ) % 20000;
+      event_add_with_data( event_test_period[i], event_test_type_bench,
+                           GINT_TO_POINTER( i ) );
+    }
+
+    event_test_done = 0;
+    start = timer_get_time();
+
+    for( frame = 0; frame < frames; frame++ ) {
+      while( event_next_event < frame_length ) {
+        tstates = event_next_event;
+        event_do_events();
+      }
+      event_frame( frame_length );
+    }
+
+    elapsed = timer_get_time() - start;
+
+    printf( "Event scheduler: %3d pending, %6d events/frame, %6.1f ns/event\n",
+            n, event_test_done / frames, elapsed * 1e9 / event_test_done );
+  }
+
+  event_reset();
+  tstates = 0;
+
+  return 0;
+}
+
+/* Run the machine until the end of 'frames' frames */
+static void
+run_frames( int frames )
+{
+  libspectrum_dword last;
+  int frame;
+
+  for( frame = 0; frame < frames; frame++ ) {
+    do {
+      last = tstates;
+      z80_do_opcodes();
+      event_do_events();
+    } while( tstates >= last );
+  }
+}
+
+/* Not a test: report the emulated speed of the BASIC idle loop with no
+   breakpoints and with 10 and 100 breakpoints of all types which it never
+   hits */
+static int
+debugger_breakpoint_benchmark( void )
+{
+  static const int counts[] = { 0, 10, 100 };
+  const int frames = 500;
+  int emulation_speed = settings_current.emulation_speed;
+  size_t c;
+  int n;
+  libspectrum_word address;
+  double start, elapsed;
+
+  /* Run as fast as we can */
+  sound_pause();
+  settings_current.emulation_speed = 100000;
+
+  machine_reset( 0 );
+  run_frames( 200 );
+
+  for( c = 0; c < ARRAY_SIZE( counts ); c++ ) {
+
+    debugger_command_evaluate( "delete" );
+
+    for( n = 0; n < counts[c]; n++ ) {
+      address = 0xc000 + n * 61;
+      switch( n % 5 ) {
+      case 0:
+        debugger_breakpoint_add_address( DEBUGGER_BREAKPOINT_TYPE_EXECUTE,
+                                         memory_source_any, 0, address, 1000000,
+                                         DEBUGGER_BREAKPOINT_LIFE_PERMANENT,
+                                         NULL );
+        break;
+      case 1:
+        debugger_breakpoint_add_address( DEBUGGER_BREAKPOINT_TYPE_READ,
+                                         memory_source_any, 0, address, 1000000,
+                                         DEBUGGER_BREAKPOINT_LIFE_PERMANENT,
+                                         NULL );
+        break;
+      case 2:
+        debugger_breakpoint_add_address( DEBUGGER_BREAKPOINT_TYPE_WRITE,
+                                         memory_source_any, 0, address, 1000000,
+                                         DEBUGGER_BREAKPOINT_LIFE_PERMANENT,
+                                         NULL );
+        break;
+      case 3:
+        debugger_breakpoint_add_port( DEBUGGER_BREAKPOINT_TYPE_PORT_READ,
+                                      address | 0x1f, 0xffff, 1000000,
+                                      DEBUGGER_BREAKPOINT_LIFE_PERMANENT, NULL );
+        break;
+      case 4:
+        debugger_breakpoint_add_port( DEBUGGER_BREAKPOINT_TYPE_PORT_WRITE,
+                                      address | 0x1f, 0xffff, 1000000,
+                                      DEBUGGER_BREAKPOINT_LIFE_PERMANENT, NULL );
+        break;
+      }
+    }
+
+    start = timer_get_time();
+    run_frames( frames );
+    elapsed = timer_get_time() - start;
+
+    printf( "Debugger: %3d breakpoints, %7.1f emulated MHz\n", counts[c],
+            (double)frames * machine_current->timings.tstates_per_frame /
+              elapsed / 1e6 );
+  }
+
+  debugger_command_evaluate( "delete" );
+
+  settings_current.emulation_speed = emulation_speed;
+  sound_unpause();
+
+  return 0;
+}
+
 static int
 assert_page( libspectrum_word base, libspectrum_word length, int source, int page )
 {
@@ -784,8 +1092,12 @@ unittests_run( void )
   r += floating_bus_test();
   r += floating_bus_merge_test();
   r += mempool_test();
+  r += event_test();
+  r += event_benchmark();
   r += paging_test();
   r += debugger_disassemble_unittest();
+  r += debugger_breakpoint_unittest();
+  r += debugger_breakpoint_benchmark();
 
   printf("Final return value: %d (should be 0)\n", r);
 
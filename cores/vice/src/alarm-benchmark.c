@@ -0,0 +1,269 @@
+/*
+ * alarm-benchmark.c - Measure alarm dispatch cost versus pending alarms.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: alarm-benchmark [dispatches]
+
+   For a growing number of pending alarms, runs the dispatch loop the way
+   the CPU cores do (dispatch while the next pending clock has passed) with
+   every alarm rescheduling itself from its callback, as CIA and VIC-II
+   alarms do, and reports the time per dispatch.  A second measurement
+   churns alarm_set()/alarm_unset() on random alarms.
+
+   Before measuring, checks that alarms due at the same clock tick are
+   dispatched in the order they were set; exits with status 1 if not.  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "alarm.h"
+#include "archdep.h"
+#include "lib.h"
+#include "log.h"
+#include "types.h"
+
+#define BENCH_ALARMS_MAX 128
+
+static alarm_t *alarms[BENCH_ALARMS_MAX];
+static CLOCK periods[BENCH_ALARMS_MAX];
+static CLOCK bench_clk;
+static unsigned long dispatches;
+
+/* Order check state: when `check_mode' is set the handler records the
+   alarm and unsets it instead of rescheduling.  */
+static int check_mode;
+static int check_fired[BENCH_ALARMS_MAX];
+static int check_num_fired;
+
+/* Stubs for lib.c and alarm.c.  */
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench_alarm_handler(CLOCK offset, void *data)
+{
+    int i = vice_ptr_to_int(data);
+
+    if (check_mode) {
+        check_fired[check_num_fired++] = i;
+        alarm_unset(alarms[i]);
+        return;
+    }
+
+    alarm_set(alarms[i], bench_clk - offset + periods[i]);
+    dispatches++;
+}
+
+/* Set and unset random alarms on a few clock ticks, then dispatch them all
+   and compare the order with the expected one: by clock, then by the time
+   of the last alarm_set().  */
+static int check_order(alarm_context_t *context, int rounds)
+{
+    CLOCK clk[BENCH_ALARMS_MAX];
+    unsigned long set_at[BENCH_ALARMS_MAX];
+    int pending[BENCH_ALARMS_MAX];
+    int expected[BENCH_ALARMS_MAX];
+    unsigned long k;
+    int round, i, j, n;
+
+    check_mode = 1;
+
+    for (round = 0; round < rounds; round++) {
+        for (i = 0; i < BENCH_ALARMS_MAX; i++) {
+            pending[i] = 0;
+        }
+        for (k = 0; k < 4 * BENCH_ALARMS_MAX; k++) {
+            i = rand() % BENCH_ALARMS_MAX;
+            if (rand() % 4 == 0) {
+                alarm_unset(alarms[i]);
+                pending[i] = 0;
+            } else {
+                clk[i] = 100 + (CLOCK)(rand() % 4);
+                set_at[i] = k;
+                pending[i] = 1;
+                alarm_set(alarms[i], clk[i]);
+            }
+        }
+
+        /* Insertion sort of the pending alarms by (clk, set_at).  */
+        n = 0;
+        for (i = 0; i < BENCH_ALARMS_MAX; i++) {
+            if (!pending[i]) {
+                continue;
+            }
+            for (j = n; j > 0; j--) {
+                int e = expected[j - 1];
+
+                if (clk[e] < clk[i]
+                    || (clk[e] == clk[i] && set_at[e] < set_at[i])) {
+                    break;
+                }
+                expected[j] = e;
+            }
+            expected[j] = i;
+            n++;
+        }
+
+        check_num_fired = 0;
+        while (alarm_context_next_pending_clk(context) != (CLOCK)~0L) {
+            alarm_context_dispatch(context,
+                                   alarm_context_next_pending_clk(context));
+        }
+
+        if (check_num_fired != n) {
+            printf("order check: %d alarms fired, %d expected\n",
+                   check_num_fired, n);
+            return -1;
+        }
+        for (i = 0; i < n; i++) {
+            if (check_fired[i] != expected[i]) {
+                printf("order check: round %d position %d: alarm %d fired,"
+                       " %d expected\n", round, i, check_fired[i],
+                       expected[i]);
+                return -1;
+            }
+        }
+    }
+
+    check_mode = 0;
+
+    return 0;
+}
+
+static double bench_dispatch(alarm_context_t *context, int n,
+                             unsigned long count)
+{
+    double t;
+    int i;
+
+    bench_clk = 0;
+    for (i = 0; i < n; i++) {
+        /* Periods between one raster line and a few frames.  */
+        periods[i] = 63 + (CLOCK)(rand() % 60000);
+        alarm_set(alarms[i], periods[i]);
+    }
+
+    dispatches = 0;
+    t = now();
+
+    while (dispatches < count) {
+        bench_clk = alarm_context_next_pending_clk(context);
+        while (bench_clk >= alarm_context_next_pending_clk(context)) {
+            alarm_context_dispatch(context, bench_clk);
+        }
+    }
+
+    t = now() - t;
+
+    for (i = 0; i < n; i++) {
+        alarm_unset(alarms[i]);
+    }
+
+    return t * 1e9 / (double)dispatches;
+}
+
+static double bench_set_unset(alarm_context_t *context, int n,
+                              unsigned long count)
+{
+    unsigned long k;
+    double t;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        alarm_set(alarms[i], (CLOCK)(rand() % 100000));
+    }
+
+    t = now();
+
+    for (k = 0; k < count; k++) {
+        i = rand() % n;
+        if (k & 1) {
+            alarm_unset(alarms[i]);
+        } else {
+            alarm_set(alarms[i], (CLOCK)(rand() % 100000));
+        }
+    }
+
+    t = now() - t;
+
+    for (i = 0; i < n; i++) {
+        alarm_unset(alarms[i]);
+    }
+
+    return t * 1e9 / (double)count;
+}
+
+int main(int argc, char **argv)
+{
+    alarm_context_t *context;
+    unsigned long count = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    int i, n;
+
+    context = alarm_context_new("Benchmark");
+    for (i = 0; i < BENCH_ALARMS_MAX; i++) {
+        alarms[i] = alarm_new(context, "Bench", bench_alarm_handler,
+                              int_to_void_ptr(i));
+    }
+
+    srand(1);
+    if (check_order(context, 1000) < 0) {
+        return 1;
+    }
+    printf("same-clock dispatch order: ok\n");
+
+    printf("%8s %14s %14s\n", "pending", "ns/dispatch", "ns/set+unset");
+
+    for (n = 1; n <= BENCH_ALARMS_MAX; n *= 2) {
+        srand(n);
+        printf("%8d %14.1f %14.1f\n", n,
+               bench_dispatch(context, n, count),
+               bench_set_unset(context, n, count));
+    }
+
+    alarm_context_destroy(context);
+
+    return 0;
+}
@@ -29,6 +29,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "alarm.h"
 #include "lib.h"
@@ -54,6 +55,8 @@ void alarm_context_init(alarm_context_t *context, const char *name)
 
     context->num_pending_alarms = 0;
     context->next_pending_alarm_clk = (CLOCK) ~0L;
+    context->next_pending_alarm_idx = -1;
+    context->set_count = 0;
 }
 
 void alarm_context_destroy(alarm_context_t *context)
@@ -76,6 +79,7 @@ void alarm_context_destroy(alarm_context_t *context)
     lib_free(context);
 }
 
+/* Shifting every pending alarm by the same amount keeps the heap order.  */
 void alarm_context_time_warp(alarm_context_t *context, CLOCK warp_amount,
                              int warp_direction)
 {
@@ -100,6 +104,52 @@ void alarm_context_time_warp(alarm_context_t *context, CLOCK warp_amount,
     }
 }
 
+void alarm_context_save_state(const alarm_context_t *context,
+                              alarm_context_state_t *state)
+{
+    memcpy(state->pending_alarms, context->pending_alarms,
+           context->num_pending_alarms * sizeof(pending_alarms_t));
+    state->num_pending_alarms = context->num_pending_alarms;
+    state->set_count = context->set_count;
+}
+
+/* The heap is copied as it is, so alarms due at the same clock tick are
+   dispatched in the saved order.  Fails if a saved alarm has been
+   destroyed since.  */
+int alarm_context_restore_state(alarm_context_t *context,
+                                const alarm_context_state_t *state)
+{
+    alarm_t *ap;
+    unsigned int i;
+
+    for (i = 0; i < state->num_pending_alarms; i++) {
+        for (ap = context->alarms; ap != NULL; ap = ap->next) {
+            if (ap == state->pending_alarms[i].alarm) {
+                break;
+            }
+        }
+        if (ap == NULL) {
+            return -1;
+        }
+    }
+
+    for (ap = context->alarms; ap != NULL; ap = ap->next) {
+        ap->pending_idx = -1;
+    }
+
+    memcpy(context->pending_alarms, state->pending_alarms,
+           state->num_pending_alarms * sizeof(pending_alarms_t));
+    context->num_pending_alarms = state->num_pending_alarms;
+    for (i = 0; i < context->num_pending_alarms; i++) {
+        context->pending_alarms[i].alarm->pending_idx = (int)i;
+    }
+    context->set_count = state->set_count;
+
+    alarm_context_update_next_pending(context);
+
+    return 0;
+}
+
 /* ------------------------------------------------------------------------ */
 
 static void alarm_init(alarm_t *alarm, alarm_context_t *context,
@@ -168,6 +218,7 @@ void alarm_unset(alarm_t *alarm)
 {
     alarm_context_t *context;
     int idx;
+    int last;
 
     idx = alarm->pending_idx;
 
@@ -176,33 +227,25 @@ void alarm_unset(alarm_t *alarm)
     }
     context = alarm->context;
 
-    if (context->num_pending_alarms > 1) {
-        int last;
+    last = (int)--context->num_pending_alarms;
 
-        last = --context->num_pending_alarms;
+    if (last != idx) {
+        /* Fill the hole with the last heap entry and restore the heap
+           order around it.  */
+        context->pending_alarms[idx] = context->pending_alarms[last];
+        context->pending_alarms[idx].alarm->pending_idx = idx;
 
-        if (last != idx) {
-            /* Let's copy the struct by hand to make sure stupid compilers
-               don't do stupid things.  */
-            context->pending_alarms[idx].alarm
-                = context->pending_alarms[last].alarm;
-            context->pending_alarms[idx].clk
-                = context->pending_alarms[last].clk;
-
-            context->pending_alarms[idx].alarm->pending_idx = idx;
-        }
-
-        if (context->next_pending_alarm_idx == idx) {
-            alarm_context_update_next_pending(context);
-        } else if (context->next_pending_alarm_idx == last) {
-            context->next_pending_alarm_idx = idx;
+        if (idx > 0
+            && alarm_pending_before(&context->pending_alarms[idx],
+                                    &context->pending_alarms[(idx - 1) >> 1])) {
+            alarm_context_heap_up(context, idx);
+        } else {
+            alarm_context_heap_down(context, idx);
         }
-    } else {
-        context->num_pending_alarms = 0;
-        context->next_pending_alarm_clk = (CLOCK) ~0L;
-        context->next_pending_alarm_idx = -1;
     }
 
+    alarm_context_update_next_pending(context);
+
     alarm->pending_idx = -1;
 }
 
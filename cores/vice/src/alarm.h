@@ -45,7 +45,7 @@ struct alarm_s {
     /* Callback to be called when the alarm is dispatched.  */
     alarm_callback_t callback;
 
-    /* Index into the pending alarm list.  If < 0, the alarm is not
+    /* Index into the pending alarm heap.  If < 0, the alarm is not
        pending.  */
     int pending_idx;
 
@@ -63,6 +63,10 @@ struct pending_alarms_s {
 
     /* Clock tick at which this alarm should be activated.  */
     CLOCK clk;
+
+    /* Value of the context's `set_count' when the alarm was last set;
+       orders alarms that are due at the same clock tick.  */
+    uint64_t seq;
 };
 typedef struct pending_alarms_s pending_alarms_t;
 
@@ -74,19 +78,36 @@ struct alarm_context_s {
     /* Alarm list.  */
     struct alarm_s *alarms;
 
-    /* Pending alarm array.  Statically allocated because it's slightly
-       faster this way.  */
+    /* Pending alarms, kept as a binary min-heap ordered by `clk' and then
+       by `seq', so alarms due at the same clock tick are dispatched in the
+       order they were set, whatever the heap layout: the children of entry `i' are `2 * i + 1' and `2 * i + 2', and the next
+       alarm to dispatch is always entry 0.  Statically allocated because
+       it's slightly faster this way.  */
     pending_alarms_t pending_alarms[ALARM_CONTEXT_MAX_PENDING_ALARMS];
     unsigned int num_pending_alarms;
 
     /* Clock tick for the next pending alarm.  */
     CLOCK next_pending_alarm_clk;
 
-    /* Pending alarm number.  */
+    /* Pending alarm number; 0 when any alarm is pending, -1 otherwise.  */
     int next_pending_alarm_idx;
+
+    /* Number of `alarm_set()' calls so far; source of `seq'.  */
+    uint64_t set_count;
 };
 typedef struct alarm_context_s alarm_context_t;
 
+/* Pending alarms of a context, saved with the machine state by netplay
+   rollback: the modules set their alarms again when a snapshot is read,
+   but not necessarily in the same order, and not at all if they have no
+   snapshot support.  */
+struct alarm_context_state_s {
+    pending_alarms_t pending_alarms[ALARM_CONTEXT_MAX_PENDING_ALARMS];
+    unsigned int num_pending_alarms;
+    uint64_t set_count;
+};
+typedef struct alarm_context_state_s alarm_context_state_t;
+
 /* ------------------------------------------------------------------------ */
 
 extern alarm_context_t *alarm_context_new(const char *name);
@@ -94,6 +115,10 @@ extern void alarm_context_init(alarm_context_t *context, const char *name);
 extern void alarm_context_destroy(alarm_context_t *context);
 extern void alarm_context_time_warp(alarm_context_t *context, CLOCK warp_amount,
                                     int warp_direction);
+extern void alarm_context_save_state(const alarm_context_t *context,
+                                     alarm_context_state_t *state);
+extern int alarm_context_restore_state(alarm_context_t *context,
+                                       const alarm_context_state_t *state);
 extern alarm_t *alarm_new(alarm_context_t *context, const char *name,
                           alarm_callback_t callback, void *data);
 extern void alarm_destroy(alarm_t *alarm);
@@ -111,36 +136,83 @@ inline static CLOCK alarm_context_next_pending_clk(alarm_context_t *context)
 
 inline static void alarm_context_update_next_pending(alarm_context_t *context)
 {
-    CLOCK next_pending_alarm_clk = (CLOCK)~0L;
-    int next_pending_alarm_idx;
-    unsigned int i;
+    if (context->num_pending_alarms > 0) {
+        context->next_pending_alarm_clk = context->pending_alarms[0].clk;
+        context->next_pending_alarm_idx = 0;
+    } else {
+        context->next_pending_alarm_clk = (CLOCK)~0L;
+        context->next_pending_alarm_idx = -1;
+    }
+}
 
-    next_pending_alarm_idx = context->next_pending_alarm_idx;
+/* Return nonzero if pending alarm `a' must be dispatched before `b'.  */
+inline static int alarm_pending_before(const pending_alarms_t *a,
+                                       const pending_alarms_t *b)
+{
+    return a->clk < b->clk || (a->clk == b->clk && a->seq < b->seq);
+}
 
-    for (i = 0; i < context->num_pending_alarms; i++) {
-        CLOCK pending_clk = context->pending_alarms[i].clk;
+/* Move the pending alarm at heap index `idx' towards the root until its
+   parent is not later than itself.  */
+inline static void alarm_context_heap_up(alarm_context_t *context, int idx)
+{
+    pending_alarms_t *heap = context->pending_alarms;
+    pending_alarms_t entry = heap[idx];
+
+    while (idx > 0) {
+        int parent = (idx - 1) >> 1;
 
-        if (pending_clk <= next_pending_alarm_clk) {
-            next_pending_alarm_clk = pending_clk;
-            next_pending_alarm_idx = (int)i;
+        if (!alarm_pending_before(&entry, &heap[parent])) {
+            break;
         }
+        heap[idx] = heap[parent];
+        heap[idx].alarm->pending_idx = idx;
+        idx = parent;
     }
 
-    context->next_pending_alarm_clk = next_pending_alarm_clk;
-    context->next_pending_alarm_idx = next_pending_alarm_idx;
+    heap[idx] = entry;
+    entry.alarm->pending_idx = idx;
+}
+
+/* Move the pending alarm at heap index `idx' away from the root until
+   neither of its children is earlier than itself.  */
+inline static void alarm_context_heap_down(alarm_context_t *context, int idx)
+{
+    pending_alarms_t *heap = context->pending_alarms;
+    int num = (int)context->num_pending_alarms;
+    pending_alarms_t entry = heap[idx];
+
+    for (;;) {
+        int child = 2 * idx + 1;
+
+        if (child >= num) {
+            break;
+        }
+        if (child + 1 < num
+            && alarm_pending_before(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!alarm_pending_before(&heap[child], &entry)) {
+            break;
+        }
+        heap[idx] = heap[child];
+        heap[idx].alarm->pending_idx = idx;
+        idx = child;
+    }
+
+    heap[idx] = entry;
+    entry.alarm->pending_idx = idx;
 }
 
 inline static void alarm_context_dispatch(alarm_context_t *context,
                                           CLOCK cpu_clk)
 {
     CLOCK offset;
-    int idx;
     alarm_t *alarm;
 
     offset = (CLOCK)(cpu_clk - context->next_pending_alarm_clk);
 
-    idx = context->next_pending_alarm_idx;
-    alarm = context->pending_alarms[idx].alarm;
+    alarm = context->pending_alarms[0].alarm;
 
     (alarm->callback)(offset, alarm->data);
 }
@@ -166,24 +238,27 @@ inline static void alarm_set(alarm_t *alarm, CLOCK cpu_clk)
 
         context->pending_alarms[new_idx].alarm = alarm;
         context->pending_alarms[new_idx].clk = cpu_clk;
+        context->pending_alarms[new_idx].seq = context->set_count++;
 
         context->num_pending_alarms++;
 
-        if (cpu_clk < context->next_pending_alarm_clk) {
-            context->next_pending_alarm_clk = cpu_clk;
-            context->next_pending_alarm_idx = new_idx;
-        }
-
-        alarm->pending_idx = new_idx;
+        alarm_context_heap_up(context, new_idx);
     } else {
-        /* Already pending: modify.  */
+        /* Already pending: modify.  A re-set alarm is ordered after the
+           alarms already set for the same clock tick.  */
+
+        CLOCK old_clk = context->pending_alarms[idx].clk;
 
         context->pending_alarms[idx].clk = cpu_clk;
-        if (context->next_pending_alarm_clk > cpu_clk
-            || idx == context->next_pending_alarm_idx) {
-            alarm_context_update_next_pending(context);
+        context->pending_alarms[idx].seq = context->set_count++;
+        if (cpu_clk < old_clk) {
+            alarm_context_heap_up(context, idx);
+        } else {
+            alarm_context_heap_down(context, idx);
         }
     }
+
+    alarm_context_update_next_pending(context);
 }
 
 #endif
@@ -0,0 +1,427 @@
+/** \file   benchmark.c
+ * \brief   Headless benchmark mode
+ *
+ * With `-benchmark <frames>' the emulator boots, waits for a `-autostart'
+ * image (if any) to be started, then runs the given number of frames in
+ * warp mode and exits after printing the frame rate, the time spent in
+ * the CPU core, video, sound and drive emulation, and hashes of the
+ * frame buffers and the sound output.
+ *
+ * The run is deterministic: random startup delays are off, the random
+ * seed is fixed and every frame is drawn, so the hashes only change when
+ * the emulation does.  For example:
+ *
+ *   x64sc -benchmark 3000 -autostart game.prg
+ *   x128 -benchmark 3000
+ *   xvic -benchmark 3000 -autostart game.prg
+ *   xplus4 -benchmark 3000
+ *
+ * `-benchmarkwatch <n>' sets <n> checkpoints on the main CPU and on each
+ * enabled drive CPU before measuring, mostly load and store watchpoints
+ * on 16 byte ranges spread over memory, for timing the monitor.  They
+ * are disabled, so hits are checked but neither stop nor print.
+ */
+
+/*
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "archdep.h"
+#include "autostart.h"
+#include "cmdline.h"
+#include "drive.h"
+#include "drivetypes.h"
+#include "lib.h"
+#include "machine.h"
+#include "mon_breakpoint.h"
+#include "monitor.h"
+#include "montypes.h"
+#include "perfstats.h"
+#include "resources.h"
+#include "tick.h"
+#include "types.h"
+#include "video.h"
+#include "videoarch.h"
+#include "viewport.h"
+#include "vsync.h"
+
+#include "benchmark.h"
+
+/* Give up waiting for autostart after this many frames.  */
+#define BENCHMARK_BOOT_FRAMES_MAX   (50 * 60 * 5)
+
+/* The C128 has two canvases.  */
+#define BENCHMARK_CANVASES_MAX  2
+
+/* How finished frames are rendered into a 32 bit target.  */
+enum {
+    BENCHMARK_RENDER_NONE,
+    BENCHMARK_RENDER_SYNC,      /* video_canvas_render() */
+    BENCHMARK_RENDER_QUEUED,    /* video_canvas_render_queue() */
+    BENCHMARK_RENDER_CHECK      /* video_canvas_render(), compared with
+                                   video_canvas_render_full() */
+};
+
+static int benchmark_frames = 0;
+static int benchmark_render = BENCHMARK_RENDER_NONE;
+static int benchmark_watchpoints = 0;
+
+static struct video_canvas_s *canvases[BENCHMARK_CANVASES_MAX];
+static int canvases_num = 0;
+
+static uint8_t *render_targets[BENCHMARK_CANVASES_MAX];
+static uint8_t *check_targets[BENCHMARK_CANVASES_MAX];
+static size_t render_target_sizes[BENCHMARK_CANVASES_MAX];
+static int render_check_failures = 0;
+
+static int measuring = 0;
+static int watchpoint_cpus = 0;
+static int boot_frames = 0;
+static int frames = 0;
+static unsigned long start_tick;
+static unsigned long hash_ticks;
+
+static uint64_t frame_hash;
+static uint64_t last_frame_hash;
+
+
+static int set_benchmark_frames(int val, void *param)
+{
+    benchmark_frames = val < 0 ? 0 : val;
+    return 0;
+}
+
+static int set_benchmark_render(int val, void *param)
+{
+    if (val < BENCHMARK_RENDER_NONE || val > BENCHMARK_RENDER_CHECK) {
+        return -1;
+    }
+    benchmark_render = val;
+    return 0;
+}
+
+static int set_benchmark_watchpoints(int val, void *param)
+{
+    benchmark_watchpoints = val < 0 ? 0 : val;
+    return 0;
+}
+
+static const resource_int_t resources_int[] = {
+    { "BenchmarkFrames", 0, RES_EVENT_NO, NULL,
+      &benchmark_frames, set_benchmark_frames, NULL },
+    { "BenchmarkRender", BENCHMARK_RENDER_NONE, RES_EVENT_NO, NULL,
+      &benchmark_render, set_benchmark_render, NULL },
+    { "BenchmarkWatchpoints", 0, RES_EVENT_NO, NULL,
+      &benchmark_watchpoints, set_benchmark_watchpoints, NULL },
+    RESOURCE_INT_LIST_END
+};
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-benchmark", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "BenchmarkFrames", NULL,
+      "<frames>", "Run <frames> frames in warp mode after autostart, print timings and hashes, and exit" },
+    { "-benchmarkrender", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "BenchmarkRender", NULL,
+      "<mode>", "Render each benchmark frame to 32 bit RGB: (0: no, 1: on the emulation thread, 2: on a render thread, 3: as 1 and check against rendering the whole frame)" },
+    { "-benchmarkwatch", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "BenchmarkWatchpoints", NULL,
+      "<number>", "Set <number> disabled monitor checkpoints on the main CPU and on each drive CPU during the benchmark" },
+    CMDLINE_LIST_END
+};
+
+
+int benchmark_resources_init(void)
+{
+    return resources_register_int(resources_int);
+}
+
+
+int benchmark_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
+
+
+/** \brief  Set up a deterministic run, after the command line is parsed
+ */
+void benchmark_init(void)
+{
+    if (benchmark_frames == 0) {
+        return;
+    }
+
+    srand(1);
+    resources_set_int("AutostartDelayRandom", 0);
+    resources_set_int("WarpMode", 1);
+
+    /* Sound is generated but not played.  */
+    resources_set_int("Sound", 1);
+    resources_set_string("SoundDeviceName", "dummy");
+
+    perfstats_enabled = 1;
+}
+
+
+void benchmark_add_canvas(struct video_canvas_s *canvas)
+{
+    if (canvases_num < BENCHMARK_CANVASES_MAX) {
+        canvases[canvases_num++] = canvas;
+    }
+}
+
+
+static uint64_t hash_canvases(void)
+{
+    uint64_t hash = PERFSTATS_HASH_INIT;
+    int i;
+
+    for (i = 0; i < canvases_num; i++) {
+        draw_buffer_t *db = canvases[i]->draw_buffer;
+        unsigned int y;
+
+        if (db == NULL || db->draw_buffer == NULL) {
+            continue;
+        }
+        for (y = 0; y < db->draw_buffer_height; y++) {
+            hash = perfstats_hash(hash, db->draw_buffer + y * db->draw_buffer_pitch,
+                                  db->draw_buffer_width);
+        }
+    }
+
+    return hash;
+}
+
+
+/* Render the visible part of each canvas, as video_canvas_refresh_all()
+   would, into a target of our own.  */
+static void render_canvases(void)
+{
+    int i;
+
+    for (i = 0; i < canvases_num; i++) {
+        video_canvas_t *canvas = canvases[i];
+        viewport_t *viewport = canvas->viewport;
+        geometry_t *geometry = canvas->geometry;
+        int width, height, pitcht;
+        size_t size;
+
+        if (canvas->draw_buffer->draw_buffer == NULL) {
+            continue;
+        }
+
+        width = (int)geometry->screen_size.width - viewport->first_x;
+        height = (int)(viewport->last_line - viewport->first_line + 1);
+        if (width <= 0 || height <= 0) {
+            continue;
+        }
+        pitcht = width * canvas->videoconfig->scalex * 4;
+        size = (size_t)pitcht * height * canvas->videoconfig->scaley;
+
+        if (size > render_target_sizes[i]) {
+            video_canvas_render_wait(canvas);
+            lib_free(render_targets[i]);
+            lib_free(check_targets[i]);
+            render_targets[i] = lib_malloc(size);
+            check_targets[i] = NULL;
+            render_target_sizes[i] = size;
+        }
+
+        if (benchmark_render == BENCHMARK_RENDER_QUEUED) {
+            video_canvas_render_queue(canvas, render_targets[i], width, height,
+                                      viewport->first_x + geometry->extra_offscreen_border_left,
+                                      viewport->first_line, 0, 0, pitcht, 32);
+        } else {
+            video_canvas_render(canvas, render_targets[i], width, height,
+                                viewport->first_x + geometry->extra_offscreen_border_left,
+                                viewport->first_line, 0, 0, pitcht, 32);
+        }
+
+        if (benchmark_render == BENCHMARK_RENDER_CHECK) {
+            /* Not part of the measured time, like hashing.  */
+            unsigned long tick = tick_now();
+
+            if (check_targets[i] == NULL) {
+                check_targets[i] = lib_malloc(render_target_sizes[i]);
+            }
+            video_canvas_render_full(canvas, check_targets[i], width, height,
+                                     viewport->first_x + geometry->extra_offscreen_border_left,
+                                     viewport->first_line, 0, 0, pitcht, 32);
+            if (memcmp(render_targets[i], check_targets[i], size) != 0) {
+                if (render_check_failures++ == 0) {
+                    printf("benchmark: frame %d of canvas %d differs from the whole frame\n",
+                           frames, i);
+                }
+            }
+            hash_ticks += tick_delta(tick);
+        }
+    }
+}
+
+
+/* Every fourth is an exec breakpoint, the others watch loads and stores
+   on 16 bytes, spread over the address space.  */
+static void add_watchpoints_to(MEMSPACE mem)
+{
+    unsigned int loc;
+    int i, num;
+
+    for (i = 0; i < benchmark_watchpoints; i++) {
+        loc = (i * 0x0a3du) & 0xfff0;
+        if (i % 4 == 3) {
+            num = mon_breakpoint_add_checkpoint(new_addr(mem, loc), new_addr(mem, loc),
+                                                true, e_exec, false, false);
+        } else {
+            num = mon_breakpoint_add_checkpoint(new_addr(mem, loc), new_addr(mem, loc + 15),
+                                                true, e_load | e_store, false, false);
+        }
+        mon_breakpoint_switch_checkpoint(e_OFF, num);
+    }
+}
+
+static int add_watchpoints(void)
+{
+    int dnr, cpus = 1;
+
+    add_watchpoints_to(e_comp_space);
+    for (dnr = 0; dnr < NUM_DISK_UNITS; dnr++) {
+        if (diskunit_context[dnr]->enable) {
+            add_watchpoints_to(monitor_diskspace_mem(dnr));
+            cpus++;
+        }
+    }
+    return cpus;
+}
+
+
+static void report(void)
+{
+    double tps = (double)tick_per_second();
+    double total = (double)(tick_delta(start_tick) - hash_ticks) / tps;
+    double video = perfstats_ticks[PERFSTATS_VIDEO] / tps;
+    double sound = perfstats_ticks[PERFSTATS_SOUND] / tps;
+    double drive = perfstats_ticks[PERFSTATS_DRIVE] / tps;
+    double render = perfstats_ticks[PERFSTATS_RENDER] / tps;
+    double wait = perfstats_ticks[PERFSTATS_RENDER_WAIT] / tps;
+    /* queued frames render alongside the emulation */
+    double render_here = benchmark_render == BENCHMARK_RENDER_QUEUED ? wait : render;
+    double cpu = total - video - sound - drive - render_here;
+    double refresh = vsync_get_refresh_frequency();
+    unsigned long lines_rendered = 0, lines_skipped = 0;
+    int i;
+
+    for (i = 0; i < canvases_num; i++) {
+        lines_rendered += canvases[i]->videoconfig->lines_rendered;
+        lines_skipped += canvases[i]->videoconfig->lines_skipped;
+    }
+
+    printf("benchmark: %s, %d frames after %d boot frames\n",
+           machine_name, frames, boot_frames);
+    if (benchmark_watchpoints > 0) {
+        printf("benchmark: %d monitor checkpoints on each of %d CPUs\n",
+               benchmark_watchpoints, watchpoint_cpus);
+    }
+    printf("benchmark: %.3f s, %.1f fps, %.1fx real time\n",
+           total, frames / total, refresh > 0 ? frames / total / refresh : 0.0);
+    printf("benchmark: cpu   %8.3f s %5.1f%%\n", cpu, 100.0 * cpu / total);
+    printf("benchmark: video %8.3f s %5.1f%%\n", video, 100.0 * video / total);
+    printf("benchmark: sound %8.3f s %5.1f%%\n", sound, 100.0 * sound / total);
+    printf("benchmark: drive %8.3f s %5.1f%%\n", drive, 100.0 * drive / total);
+    if (perfstats_drive_idle_cycles > 0) {
+        printf("benchmark: drive idle loops skipped, %lu cycles\n",
+               perfstats_drive_idle_cycles);
+    }
+    if (benchmark_render != BENCHMARK_RENDER_NONE) {
+        printf("benchmark: render %7.3f s %5.1f%%, %s\n", render, 100.0 * render / total,
+               benchmark_render == BENCHMARK_RENDER_QUEUED ? "render thread" : "emulation thread");
+        printf("benchmark: render wait %.3f s %5.1f%%\n", wait, 100.0 * wait / total);
+        printf("benchmark: %lu lines rendered, %lu unchanged lines skipped\n",
+               lines_rendered, lines_skipped);
+        if (benchmark_render == BENCHMARK_RENDER_CHECK) {
+            printf("benchmark: %d frames differ from the whole frame\n",
+                   render_check_failures);
+        }
+        printf("benchmark: per frame %.3f ms emulation, %.3f ms render, %.3f ms render wait\n",
+               1000.0 * (total - render_here) / frames, 1000.0 * render / frames,
+               1000.0 * wait / frames);
+    }
+    printf("benchmark: frames hash %016llx, last frame hash %016llx\n",
+           (unsigned long long)frame_hash, (unsigned long long)last_frame_hash);
+    printf("benchmark: sound hash %016llx, %lu samples\n",
+           (unsigned long long)perfstats_sound_hash, perfstats_sound_samples);
+    fflush(stdout);
+}
+
+
+/** \brief  Called at the end of every frame
+ */
+void benchmark_vsync(void)
+{
+    unsigned long tick;
+    int i;
+
+    if (benchmark_frames == 0) {
+        return;
+    }
+
+    if (!measuring) {
+        if (autostart_in_progress() && boot_frames < BENCHMARK_BOOT_FRAMES_MAX) {
+            boot_frames++;
+            return;
+        }
+        measuring = 1;
+        if (benchmark_watchpoints > 0) {
+            watchpoint_cpus = add_watchpoints();
+        }
+        perfstats_reset();
+        for (i = 0; i < canvases_num; i++) {
+            canvases[i]->videoconfig->lines_rendered = 0;
+            canvases[i]->videoconfig->lines_skipped = 0;
+        }
+        frame_hash = PERFSTATS_HASH_INIT;
+        hash_ticks = 0;
+        start_tick = tick_now();
+        return;
+    }
+
+    if (benchmark_render != BENCHMARK_RENDER_NONE) {
+        render_canvases();
+    }
+
+    /* Hashing is not part of the measured time.  */
+    tick = tick_now();
+    last_frame_hash = hash_canvases();
+    frame_hash = perfstats_hash(frame_hash, (const uint8_t *)&last_frame_hash, sizeof(last_frame_hash));
+    hash_ticks += tick_delta(tick);
+
+    if (++frames == benchmark_frames) {
+        for (i = 0; i < canvases_num; i++) {
+            video_canvas_render_wait(canvases[i]);
+        }
+        report();
+        archdep_vice_exit(render_check_failures > 0 ? 1 : 0);
+    }
+}
@@ -46,6 +46,7 @@
 #include "archdep.h"
 
 #include "autostart.h"
+#include "benchmark.h"
 #include "cmdline.h"
 #include "drive.h"
 #include "interrupt.h"
@@ -103,6 +104,9 @@ int ui_cmdline_options_init(void)
 {
     /* printf("%s\n", __func__); */
     
+    if (benchmark_cmdline_options_init() < 0) {
+        return -1;
+    }
     return cmdline_register_options(cmdline_options_common);
 }
 
@@ -176,6 +180,7 @@ int ui_init_finalize(void)
 {
     /* printf("%s\n", __func__); */
     
+    benchmark_init();
     return 0;
 }
 
@@ -216,7 +221,7 @@ int ui_resources_init(void)
 {
     /* printf("%s\n", __func__); */
     
-    return 0;
+    return benchmark_resources_init();
 }
 
 
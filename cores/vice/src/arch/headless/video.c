@@ -30,6 +30,7 @@
 
 #include <stdio.h>
 
+#include "benchmark.h"
 #include "cmdline.h"
 #include "machine.h"
 #include "resources.h"
@@ -125,6 +126,7 @@ video_canvas_t *video_canvas_create(video_canvas_t *canvas,
     /* printf("%s\n", __func__); */
 
     canvas->created = 1;
+    benchmark_add_canvas(canvas);
 
     return canvas;
 }
@@ -30,6 +30,7 @@
 
 #include "vice.h"
 
+#include "benchmark.h"
 #include "kbdbuf.h"
 #include "mainlock.h"
 #include "ui.h"
@@ -225,6 +226,8 @@ void vsyncarch_presync(void)
 
 void vsyncarch_postsync(void)
 {
+    benchmark_vsync();
+
     /* this function is called once a frame, so this
        handles single frame advance */
     if (pause_pending) {
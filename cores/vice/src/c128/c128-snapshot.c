@@ -55,15 +55,8 @@
 #define SNAP_MAJOR        0
 #define SNAP_MINOR        0
 
-int c128_snapshot_write(const char *name, int save_roms, int save_disks, int event_mode)
+static int c128_snapshot_write_modules(snapshot_t *s, int save_roms, int save_disks, int event_mode)
 {
-    snapshot_t *s;
-
-    s = snapshot_create(name, ((uint8_t)(SNAP_MAJOR)), ((uint8_t)(SNAP_MINOR)), SNAP_MACHINE_NAME);
-    if (s == NULL) {
-        return -1;
-    }
-
     sound_snapshot_prepare();
 
     if (maincpu_snapshot_write_module(s) < 0
@@ -79,6 +72,22 @@ int c128_snapshot_write(const char *name, int save_roms, int save_disks, int eve
         || joyport_snapshot_write_module(s, JOYPORT_1) < 0
         || joyport_snapshot_write_module(s, JOYPORT_2) < 0
         || userport_snapshot_write_module(s) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int c128_snapshot_write(const char *name, int save_roms, int save_disks, int event_mode)
+{
+    snapshot_t *s;
+
+    s = snapshot_create(name, ((uint8_t)(SNAP_MAJOR)), ((uint8_t)(SNAP_MINOR)), SNAP_MACHINE_NAME);
+    if (s == NULL) {
+        return -1;
+    }
+
+    if (c128_snapshot_write_modules(s, save_roms, save_disks, event_mode) < 0) {
         snapshot_close(s);
         ioutil_remove(name);
         return -1;
@@ -88,16 +97,27 @@ int c128_snapshot_write(const char *name, int save_roms, int save_disks, int eve
     return 0;
 }
 
-int c128_snapshot_read(const char *name, int event_mode)
+int c128_snapshot_write_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode)
 {
     snapshot_t *s;
-    uint8_t minor, major;
 
-    s = snapshot_open(name, &major, &minor, SNAP_MACHINE_NAME);
+    s = snapshot_create_memory(mem, ((uint8_t)(SNAP_MAJOR)), ((uint8_t)(SNAP_MINOR)), SNAP_MACHINE_NAME);
     if (s == NULL) {
         return -1;
     }
 
+    if (c128_snapshot_write_modules(s, save_roms, save_disks, event_mode) < 0) {
+        snapshot_close(s);
+        return -1;
+    }
+
+    snapshot_close(s);
+    return 0;
+}
+
+/* Read the modules and close the snapshot.  */
+static int c128_snapshot_read_modules(snapshot_t *s, uint8_t major, uint8_t minor, int event_mode)
+{
     if (!snapshot_version_is_equal(major, minor, SNAP_MAJOR, SNAP_MINOR)) {
         log_message(LOG_DEFAULT, "Snapshot version (%d.%d) not valid: expecting %d.%d.", major, minor, SNAP_MAJOR, SNAP_MINOR);
         snapshot_set_error(SNAPSHOT_MODULE_INCOMPATIBLE);
@@ -139,3 +159,29 @@ fail:
 
     return -1;
 }
+
+int c128_snapshot_read(const char *name, int event_mode)
+{
+    snapshot_t *s;
+    uint8_t minor, major;
+
+    s = snapshot_open(name, &major, &minor, SNAP_MACHINE_NAME);
+    if (s == NULL) {
+        return -1;
+    }
+
+    return c128_snapshot_read_modules(s, major, minor, event_mode);
+}
+
+int c128_snapshot_read_memory(const uint8_t *data, size_t size, int event_mode)
+{
+    snapshot_t *s;
+    uint8_t minor, major;
+
+    s = snapshot_open_memory(data, size, &major, &minor, SNAP_MACHINE_NAME);
+    if (s == NULL) {
+        return -1;
+    }
+
+    return c128_snapshot_read_modules(s, major, minor, event_mode);
+}
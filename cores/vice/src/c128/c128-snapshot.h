@@ -27,7 +27,11 @@
 #ifndef VICE_C128SNAPSHOT_H
 #define VICE_C128SNAPSHOT_H
 
+#include "snapshot.h"
+
 extern int c128_snapshot_write(const char *name, int save_roms, int save_disks, int event_mode);
 extern int c128_snapshot_read(const char *name, int event_mode);
+extern int c128_snapshot_write_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode);
+extern int c128_snapshot_read_memory(const uint8_t *data, size_t size, int event_mode);
 
 #endif
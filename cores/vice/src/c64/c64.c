@@ -98,6 +98,7 @@
 #include "printer.h"
 #include "psid.h"
 #include "resources.h"
+#include "rewind.h"
 #include "rs232drv.h"
 #include "rsuser.h"
 #include "rushware_keypad.h"
@@ -676,6 +677,10 @@ int machine_resources_init(void)
         return -1;
     }
 #endif
+    if (rewind_resources_init() < 0) {
+        init_resource_fail("rewind");
+        return -1;
+    }
 #ifdef DEBUG
     if (debug_resources_init() < 0) {
         init_resource_fail("debug");
@@ -788,6 +793,7 @@ void machine_resources_shutdown(void)
     joyport_bbrtc_resources_shutdown();
     tapeport_resources_shutdown();
     tapecart_exit();
+    rewind_resources_shutdown();
 }
 
 /* C64-specific command-line option initialization.  */
@@ -903,6 +909,10 @@ int machine_cmdline_options_init(void)
         return -1;
     }
 #endif
+    if (rewind_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("rewind");
+        return -1;
+    }
 #ifdef DEBUG
     if (debug_cmdline_options_init() < 0) {
         init_cmdline_options_fail("debug");
@@ -1256,6 +1266,8 @@ static void machine_vsync_hook(void)
 
     screenshot_record();
 
+    rewind_vsync_hook();
+
     sub = clk_guard_prevent_overflow(maincpu_clk_guard);
 
     /* The drive has to deal both with our overflowing and its own one, so
@@ -1376,6 +1388,24 @@ int machine_read_snapshot(const char *name, int event_mode)
     return err;
 }
 
+int machine_write_snapshot_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode)
+{
+    int err = c64_snapshot_write_memory(mem, save_roms, save_disks, event_mode);
+    if ((err < 0) && (snapshot_get_error() == SNAPSHOT_NO_ERROR)) {
+        snapshot_set_error(SNAPSHOT_CANNOT_WRITE_SNAPSHOT);
+    }
+    return err;
+}
+
+int machine_read_snapshot_memory(const uint8_t *data, size_t size, int event_mode)
+{
+    int err = c64_snapshot_read_memory(data, size, event_mode);
+    if ((err < 0) && (snapshot_get_error() == SNAPSHOT_NO_ERROR)) {
+        snapshot_set_error(SNAPSHOT_CANNOT_READ_SNAPSHOT);
+    }
+    return err;
+}
+
 /* ------------------------------------------------------------------------- */
 /* FIXME: those two shouldnt be here anymore */
 int machine_autodetect_psid(const char *name)
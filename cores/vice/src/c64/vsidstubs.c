@@ -366,6 +366,11 @@ int tap_seek_start(tap_t *tap)
     return 0;
 }
 
+int tap_write(tap_t *tap, const uint8_t *buf, size_t size)
+{
+    return 0;
+}
+
 int tape_image_create(const char *name, unsigned int type)
 {
     return 0;
@@ -924,6 +924,19 @@ int machine_read_snapshot(const char *name, int event_mode)
     return err;
 }
 
+/* Memory snapshots are not implemented for this machine.  */
+int machine_write_snapshot_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode)
+{
+    snapshot_set_error(SNAPSHOT_CANNOT_WRITE_SNAPSHOT);
+    return -1;
+}
+
+int machine_read_snapshot_memory(const uint8_t *data, size_t size, int event_mode)
+{
+    snapshot_set_error(SNAPSHOT_CANNOT_READ_SNAPSHOT);
+    return -1;
+}
+
 /* ------------------------------------------------------------------------- */
 
 int machine_autodetect_psid(const char *name)
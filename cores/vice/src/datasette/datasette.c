@@ -61,7 +61,6 @@
 #endif
 
 #define MOTOR_DELAY         32000
-#define TAP_BUFFER_LENGTH   100000
 
 /* at least every DATASETTE_MAX_GAP cycle there should be an alarm */
 #define DATASETTE_MAX_GAP   100000
@@ -70,10 +69,10 @@
 /* Attached TAP tape image.  */
 static tap_t *current_image = NULL;
 
-/* Buffer for the TAP */
-static uint8_t tap_buffer[TAP_BUFFER_LENGTH];
+/* The pulses of the TAP, in the image in memory */
+static const uint8_t *tap_buffer = NULL;
 
-/* Pointer and length of the tap-buffer */
+/* Pointer and length of the tap-buffer, 0 when it has to be set up again */
 static long next_tap, last_tap;
 
 /* State of the datasette motor.  */
@@ -375,19 +374,27 @@ void datasette_reset_counter(void)
 }
 
 
-inline static int datasette_move_buffer_forward(int offset)
+static void datasette_map_buffer(void)
 {
-    /* reads buffer to fit the next gap-read
+    /* the buffer is all of the pulses in the image in memory
        tap_buffer[next_tap] ~ current_file_seek_position
     */
+    tap_buffer = current_image->data + current_image->offset;
+    last_tap = current_image->data_size - current_image->offset;
+    if (last_tap > current_image->size) {
+        last_tap = current_image->size;
+    }
+    if (last_tap < 0) {
+        last_tap = 0;
+    }
+    next_tap = current_image->current_file_seek_position;
+}
+
+inline static int datasette_move_buffer_forward(int offset)
+{
+    /* sets up the buffer to fit the next gap-read */
     if (next_tap + offset >= last_tap) {
-        if (fseek(current_image->fd, current_image->current_file_seek_position
-                  + current_image->offset, SEEK_SET)) {
-            log_error(datasette_log, "Cannot read in tap-file.");
-            return 0;
-        }
-        last_tap = (long)fread(tap_buffer, 1, TAP_BUFFER_LENGTH, current_image->fd);
-        next_tap = 0;
+        datasette_map_buffer();
         if (next_tap >= last_tap) {
             return 0;
         }
@@ -397,21 +404,10 @@ inline static int datasette_move_buffer_forward(int offset)
 
 inline static int datasette_move_buffer_back(int offset)
 {
-    /* reads buffer to fit the next gap-read at current_file_seek_position-1
-       tap_buffer[next_tap] ~ current_file_seek_position
-    */
+    /* sets up the buffer to fit the next gap-read at
+       current_file_seek_position-1 */
     if (next_tap + offset < 0) {
-        if (current_image->current_file_seek_position >= TAP_BUFFER_LENGTH) {
-            next_tap = TAP_BUFFER_LENGTH;
-        } else {
-            next_tap = current_image->current_file_seek_position;
-        }
-        if (fseek(current_image->fd, current_image->current_file_seek_position
-                  - next_tap + current_image->offset, SEEK_SET)) {
-            log_error(datasette_log, "Cannot read in tap-file.");
-            return 0;
-        }
-        last_tap = (long)fread(tap_buffer, 1, TAP_BUFFER_LENGTH, current_image->fd);
+        datasette_map_buffer();
         if (next_tap > last_tap) {
             return 0;
         }
@@ -1082,14 +1078,14 @@ inline static void bit_write(void)
 
     if (write_time < (CLOCK)(255 * 8 + 7)) {
         write_gap = (uint8_t)(write_time / (CLOCK)8);
-        if (fwrite(&write_gap, 1, 1, current_image->fd) < 1) {
+        if (tap_write(current_image, &write_gap, 1) < 1) {
             datasette_control(DATASETTE_CONTROL_STOP);
             return;
         }
         current_image->current_file_seek_position++;
     } else {
         write_gap = 0;
-        if (fwrite(&write_gap, 1, 1, current_image->fd) != 1) {
+        if (tap_write(current_image, &write_gap, 1) != 1) {
             log_debug("datasette bit_write failed.");
         }
         current_image->current_file_seek_position++;
@@ -1100,7 +1096,7 @@ inline static void bit_write(void)
             long_gap[1] = (uint8_t)((write_time >> 8) & 0xff);
             long_gap[2] = (uint8_t)((write_time >> 16) & 0xff);
             write_time &= 0xffffff;
-            bytes_written = (int)fwrite(long_gap, 1, 3, current_image->fd);
+            bytes_written = tap_write(current_image, long_gap, 3);
             current_image->current_file_seek_position += bytes_written;
             if (bytes_written < 3) {
                 datasette_control(DATASETTE_CONTROL_STOP);
@@ -0,0 +1,448 @@
+/*
+ * diskimage-benchmark.c - Benchmark for reading and writing disk images.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: diskimage-benchmark [rounds]
+
+   Runs two workloads through the disk image layer, each with the images
+   read and written sector by sector (+diskimagecache), kept in memory and
+   written through (DiskImageWriteBackDelay 0), and kept in memory and
+   written back on detach:
+
+   copy    copies every sector of a full D81 to another D81, as the c1541
+           `copy' of a whole disk does.
+   save    saves BENCH_SAVE_FILES files of BENCH_SAVE_BLOCKS blocks to a
+           D64, reading and rewriting the directory sector and the BAM
+           around every file, as the virtual drive does.
+
+   The images are created in the current directory and checked against
+   the data written when they are closed.  Every workload runs `rounds'
+   times (default 5) and the time per run is reported, from attaching the
+   images to detaching them.  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "archdep.h"
+#include "cmdline.h"
+#include "diskconstants.h"
+#include "diskimage.h"
+#include "diskimage/fsimage-dxx.h"
+#include "lib.h"
+#include "log.h"
+#include "machine-drive.h"
+#include "resources.h"
+#include "types.h"
+#include "util.h"
+#include "zfile.h"
+
+#define BENCH_D81_NAME      "diskimage-benchmark.d81"
+#define BENCH_D81_COPY_NAME "diskimage-benchmark-copy.d81"
+#define BENCH_D64_NAME      "diskimage-benchmark.d64"
+
+#define BENCH_SAVE_FILES    64
+#define BENCH_SAVE_BLOCKS   10
+
+static int bench_errors;
+
+/* Stubs for lib.c and the disk image layer.  */
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+log_t log_open(const char *id)
+{
+    return LOG_DEFAULT;
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+int log_message(log_t log, const char *format, ...)
+{
+    return 0;
+}
+
+int log_verbose(const char *format, ...)
+{
+    return 0;
+}
+
+int resources_register_int(const resource_int_t *r)
+{
+    return 0;
+}
+
+int cmdline_register_options(const cmdline_option_t *c)
+{
+    return 0;
+}
+
+int machine_drive_rom_check_loaded(unsigned int type)
+{
+    return 0;
+}
+
+FILE *zfile_fopen(const char *name, const char *mode)
+{
+    return fopen(name, mode);
+}
+
+int zfile_fclose(FILE *stream)
+{
+    return fclose(stream);
+}
+
+size_t util_file_length(FILE *fd)
+{
+    long pos = ftell(fd);
+    long size;
+
+    fseek(fd, 0, SEEK_END);
+    size = ftell(fd);
+    fseek(fd, pos, SEEK_SET);
+    return (size_t)size;
+}
+
+int util_fpread(FILE *fd, void *buf, size_t num, long offset)
+{
+    if (fseek(fd, offset, SEEK_SET) < 0 || fread(buf, num, 1, fd) < 1) {
+        return -1;
+    }
+    return 0;
+}
+
+int util_fpwrite(FILE *fd, const void *buf, size_t num, long offset)
+{
+    if (fseek(fd, offset, SEEK_SET) < 0 || fwrite(buf, num, 1, fd) < 1) {
+        return -1;
+    }
+    return 0;
+}
+
+void util_word_to_le_buf(uint8_t *buf, uint16_t data)
+{
+    buf[0] = (uint8_t)data;
+    buf[1] = (uint8_t)(data >> 8);
+}
+
+void util_dword_to_le_buf(uint8_t *buf, uint32_t data)
+{
+    buf[0] = (uint8_t)data;
+    buf[1] = (uint8_t)(data >> 8);
+    buf[2] = (uint8_t)(data >> 16);
+    buf[3] = (uint8_t)(data >> 24);
+}
+
+uint16_t util_le_buf_to_word(uint8_t *buf)
+{
+    return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+uint32_t util_le_buf_to_dword(uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+char *util_get_extension(const char *filename)
+{
+    char *s = strrchr(filename, '.');
+
+    return s != NULL ? s + 1 : NULL;
+}
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint8_t bench_byte(long offset, int seed)
+{
+    return (uint8_t)((offset * 7 + seed * 13) ^ (offset >> 8));
+}
+
+static void bench_fill(uint8_t *buf, long size, int seed)
+{
+    long i;
+
+    for (i = 0; i < size; i++) {
+        buf[i] = bench_byte(i, seed);
+    }
+}
+
+static int bench_write_file(const char *name, const uint8_t *data, long size)
+{
+    FILE *fd = fopen(name, MODE_WRITE);
+
+    if (fd == NULL) {
+        return -1;
+    }
+    if (fwrite(data, 1, (size_t)size, fd) != (size_t)size) {
+        fclose(fd);
+        return -1;
+    }
+    return fclose(fd) == 0 ? 0 : -1;
+}
+
+static void bench_check_file(const char *name, const uint8_t *data, long size)
+{
+    uint8_t *buf = lib_malloc(size + 1);
+    FILE *fd = fopen(name, MODE_READ);
+    size_t len = 0;
+
+    if (fd != NULL) {
+        len = fread(buf, 1, (size_t)size + 1, fd);
+        fclose(fd);
+    }
+    if (len != (size_t)size || memcmp(buf, data, (size_t)size)) {
+        fprintf(stderr, "%s: contents differ from the sectors written\n", name);
+        bench_errors++;
+    }
+    lib_free(buf);
+}
+
+static disk_image_t *bench_attach(const char *name, unsigned int read_only)
+{
+    disk_image_t *image = disk_image_create();
+
+    image->gcr = NULL;
+    image->read_only = read_only;
+    image->device = DISK_IMAGE_DEVICE_FS;
+    disk_image_media_create(image);
+    disk_image_name_set(image, name);
+    if (disk_image_open(image) < 0) {
+        fprintf(stderr, "%s: cannot open\n", name);
+        exit(1);
+    }
+    return image;
+}
+
+static void bench_detach(disk_image_t *image)
+{
+    disk_image_close(image);
+    disk_image_media_destroy(image);
+    disk_image_destroy(image);
+}
+
+static void bench_copy(void)
+{
+    disk_image_t *source, *dest;
+    disk_addr_t dadr;
+    uint8_t buf[256];
+
+    source = bench_attach(BENCH_D81_NAME, 1);
+    dest = bench_attach(BENCH_D81_COPY_NAME, 0);
+
+    for (dadr.track = 1; dadr.track <= NUM_TRACKS_1581; dadr.track++) {
+        for (dadr.sector = 0; dadr.sector < NUM_SECTORS_1581; dadr.sector++) {
+            if (disk_image_read_sector(source, buf, &dadr) != 0
+                || disk_image_write_sector(dest, buf, &dadr) < 0) {
+                fprintf(stderr, "copy: cannot copy %u/%u\n", dadr.track, dadr.sector);
+                bench_errors++;
+            }
+        }
+    }
+
+    bench_detach(source);
+    bench_detach(dest);
+}
+
+/* The next free sector on the D64, leaving out track 18.  */
+static void bench_next_block(disk_addr_t *dadr)
+{
+    if (++dadr->sector < disk_image_sector_per_track(DISK_IMAGE_TYPE_D64, dadr->track)) {
+        return;
+    }
+    dadr->sector = 0;
+    if (++dadr->track == DIR_TRACK_1541) {
+        dadr->track++;
+    }
+}
+
+static void bench_save(uint8_t *expected)
+{
+    disk_image_t *image;
+    disk_addr_t dadr, dir, bam, next;
+    uint8_t buf[256];
+    int file, block;
+
+    image = bench_attach(BENCH_D64_NAME, 0);
+
+    bam.track = DIR_TRACK_1541;
+    bam.sector = BAM_SECTOR_1541;
+    next.track = 1;
+    next.sector = 0;
+
+    for (file = 0; file < BENCH_SAVE_FILES; file++) {
+        /* the directory entry is made when the file is opened... */
+        dir.track = DIR_TRACK_1541;
+        dir.sector = 1 + file / 8;
+        disk_image_read_sector(image, buf, &dir);
+        buf[(file % 8) * 32 + 2] = 0x01;
+        buf[(file % 8) * 32 + 3] = (uint8_t)next.track;
+        buf[(file % 8) * 32 + 4] = (uint8_t)next.sector;
+        disk_image_write_sector(image, buf, &dir);
+
+        for (block = 0; block < BENCH_SAVE_BLOCKS; block++) {
+            dadr = next;
+            bench_next_block(&next);
+            bench_fill(buf, 256, file * BENCH_SAVE_BLOCKS + block);
+            buf[0] = block < BENCH_SAVE_BLOCKS - 1 ? (uint8_t)next.track : 0;
+            buf[1] = block < BENCH_SAVE_BLOCKS - 1 ? (uint8_t)next.sector : 0xff;
+            disk_image_write_sector(image, buf, &dadr);
+        }
+
+        /* ...and closed, and the BAM is written when the file is closed */
+        disk_image_read_sector(image, buf, &dir);
+        buf[(file % 8) * 32 + 2] = 0x82;
+        buf[(file % 8) * 32 + 30] = BENCH_SAVE_BLOCKS;
+        disk_image_write_sector(image, buf, &dir);
+
+        disk_image_read_sector(image, buf, &bam);
+        buf[4 + next.track * 4] = (uint8_t)file;
+        disk_image_write_sector(image, buf, &bam);
+    }
+
+    /* Build the image as the sectors above leave it, to check against.  */
+    if (expected != NULL) {
+        memset(expected, 0, D64_FILE_SIZE_35);
+        next.track = 1;
+        next.sector = 0;
+        for (file = 0; file < BENCH_SAVE_FILES; file++) {
+            long dir_offset = (357 + 1 + file / 8) * 256L + (file % 8) * 32;
+
+            expected[dir_offset + 2] = 0x82;
+            expected[dir_offset + 3] = (uint8_t)next.track;
+            expected[dir_offset + 4] = (uint8_t)next.sector;
+            expected[dir_offset + 30] = BENCH_SAVE_BLOCKS;
+            for (block = 0; block < BENCH_SAVE_BLOCKS; block++) {
+                long offset = 0;
+                unsigned int track;
+
+                dadr = next;
+                bench_next_block(&next);
+                for (track = 1; track < dadr.track; track++) {
+                    offset += disk_image_sector_per_track(DISK_IMAGE_TYPE_D64, track);
+                }
+                offset = (offset + dadr.sector) * 256;
+                bench_fill(expected + offset, 256, file * BENCH_SAVE_BLOCKS + block);
+                expected[offset] = block < BENCH_SAVE_BLOCKS - 1 ? (uint8_t)next.track : 0;
+                expected[offset + 1] = block < BENCH_SAVE_BLOCKS - 1 ? (uint8_t)next.sector : 0xff;
+            }
+            expected[357 * 256 + 4 + next.track * 4] = (uint8_t)file;
+        }
+    }
+
+    bench_detach(image);
+}
+
+static void bench_mode(const char *mode, int cache, int delay, int rounds,
+                       const uint8_t *d81)
+{
+    uint8_t *empty_d81 = lib_calloc(1, D81_FILE_SIZE);
+    uint8_t *d64 = lib_calloc(1, D64_FILE_SIZE_35);
+    uint8_t *expected = lib_malloc(D64_FILE_SIZE_35);
+    double start, copy_time = 0.0, save_time = 0.0;
+    int round;
+
+    fsimage_dxx_set_cache(cache);
+    fsimage_dxx_set_write_back_delay(delay);
+
+    for (round = 0; round < rounds; round++) {
+        if (bench_write_file(BENCH_D81_COPY_NAME, empty_d81, D81_FILE_SIZE) < 0) {
+            fprintf(stderr, "%s: cannot create\n", BENCH_D81_COPY_NAME);
+            exit(1);
+        }
+        start = bench_now();
+        bench_copy();
+        copy_time += bench_now() - start;
+        if (round == 0) {
+            bench_check_file(BENCH_D81_COPY_NAME, d81, D81_FILE_SIZE);
+        }
+
+        if (bench_write_file(BENCH_D64_NAME, d64, D64_FILE_SIZE_35) < 0) {
+            fprintf(stderr, "%s: cannot create\n", BENCH_D64_NAME);
+            exit(1);
+        }
+        start = bench_now();
+        bench_save(round == 0 ? expected : NULL);
+        save_time += bench_now() - start;
+        if (round == 0) {
+            bench_check_file(BENCH_D64_NAME, expected, D64_FILE_SIZE_35);
+        }
+    }
+
+    printf("%-24s copy %8.3f ms  save %8.3f ms\n", mode,
+           copy_time * 1000.0 / rounds, save_time * 1000.0 / rounds);
+
+    lib_free(expected);
+    lib_free(d64);
+    lib_free(empty_d81);
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 5;
+    uint8_t *d81;
+
+    if (rounds < 1) {
+        rounds = 1;
+    }
+
+    disk_image_init();
+
+    d81 = lib_malloc(D81_FILE_SIZE);
+    bench_fill(d81, D81_FILE_SIZE, 0);
+    if (bench_write_file(BENCH_D81_NAME, d81, D81_FILE_SIZE) < 0) {
+        fprintf(stderr, "%s: cannot create\n", BENCH_D81_NAME);
+        return 1;
+    }
+
+    bench_mode("sector by sector", 0, 0, rounds, d81);
+    bench_mode("in memory, write-through", 1, 0, rounds, d81);
+    bench_mode("in memory, write-back", 1, 1, rounds, d81);
+
+    lib_free(d81);
+
+    if (bench_errors) {
+        printf("%d errors\n", bench_errors);
+        return 1;
+    }
+    return 0;
+}
@@ -112,6 +112,11 @@ extern int disk_image_resources_init(void);
 extern int disk_image_cmdline_options_init(void);
 extern void disk_image_resources_shutdown(void);
 
+/* Write the changed sectors of the images kept in memory back to their
+   files: all of them, or the ones that waited DiskImageWriteBackDelay.  */
+extern void disk_image_flush_all(void);
+extern void disk_image_flush_expired(void);
+
 extern void disk_image_fsimage_name_set(disk_image_t *image, const char *name);
 extern const char *disk_image_fsimage_name_get(const disk_image_t *image);
 extern void *disk_image_fsimage_fd_get(const disk_image_t *image);
@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "cmdline.h"
 #include "diskconstants.h"
 #include "diskimage.h"
 #include "fsimage-check.h"
@@ -49,6 +50,7 @@
 #include "lib.h"
 #include "log.h"
 #include "realimage.h"
+#include "resources.h"
 #include "types.h"
 #include "p64.h"
 
@@ -747,18 +749,74 @@ void disk_image_init(void)
 #endif
 }
 
-int disk_image_resources_init(void)
+static int disk_image_cache;
+static int disk_image_write_back_delay;
+
+static int set_disk_image_cache(int val, void *param)
+{
+    disk_image_cache = val ? 1 : 0;
+    fsimage_dxx_set_cache(disk_image_cache);
+
+    return 0;
+}
+
+static int set_disk_image_write_back_delay(int val, void *param)
 {
+    if (val < 0) {
+        return -1;
+    }
+    disk_image_write_back_delay = val;
+    fsimage_dxx_set_write_back_delay(val);
+
     return 0;
 }
 
+static const resource_int_t resources_int[] = {
+    { "DiskImageCache", 1, RES_EVENT_NO, NULL,
+      &disk_image_cache, set_disk_image_cache, NULL },
+    { "DiskImageWriteBackDelay", 1, RES_EVENT_NO, NULL,
+      &disk_image_write_back_delay, set_disk_image_write_back_delay, NULL },
+    RESOURCE_INT_LIST_END
+};
+
+int disk_image_resources_init(void)
+{
+    return resources_register_int(resources_int);
+}
+
 void disk_image_resources_shutdown(void)
 {
 }
 
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-diskimagecache", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "DiskImageCache", (void *)1,
+      NULL, "Keep D64/D71/D81/D80 style disk images in memory" },
+    { "+diskimagecache", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "DiskImageCache", (void *)0,
+      NULL, "Read and write disk images sector by sector" },
+    { "-diskimagewritebackdelay", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "DiskImageWriteBackDelay", NULL,
+      "<Seconds>", "Write changed sectors of disk images in memory back after this many seconds (0: at once)" },
+    CMDLINE_LIST_END
+};
+
 int disk_image_cmdline_options_init(void)
 {
-    return 0;
+    return cmdline_register_options(cmdline_options);
+}
+
+/*-----------------------------------------------------------------------*/
+
+void disk_image_flush_all(void)
+{
+    fsimage_dxx_flush(0);
+}
+
+void disk_image_flush_expired(void)
+{
+    fsimage_dxx_flush(1);
 }
 
 /*-----------------------------------------------------------------------*/
@@ -28,6 +28,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include "diskconstants.h"
 #include "diskimage.h"
@@ -43,6 +44,259 @@
 
 static log_t fsimage_dxx_log = LOG_ERR;
 
+/* Images of the sector based formats can be kept in memory as a whole
+   (DiskImageCache), so that reading a sector does not take a seek and a
+   read of the file.  Written sectors then go to memory as well.  If
+   DiskImageWriteBackDelay is 0 they are written to the file right away,
+   as without the cache.  Otherwise they are only marked dirty, and
+   written when the image is detached, before another image is opened
+   (which might be the same file, read by name for a directory listing),
+   and once the oldest of them has waited that many seconds.  */
+static int fsimage_dxx_cache_enabled = 1;
+static int fsimage_dxx_write_back_delay = 1;
+
+/* The images kept in memory.  */
+static fsimage_t *fsimage_dxx_cache_list = NULL;
+
+static int fsimage_dxx_cache_type(unsigned int type)
+{
+    switch (type) {
+        case DISK_IMAGE_TYPE_D64:
+        case DISK_IMAGE_TYPE_D67:
+        case DISK_IMAGE_TYPE_D71:
+        case DISK_IMAGE_TYPE_D81:
+        case DISK_IMAGE_TYPE_D80:
+        case DISK_IMAGE_TYPE_D82:
+#ifdef HAVE_X64_IMAGE
+        case DISK_IMAGE_TYPE_X64:
+#endif
+        case DISK_IMAGE_TYPE_D1M:
+        case DISK_IMAGE_TYPE_D2M:
+        case DISK_IMAGE_TYPE_D4M:
+        case DISK_IMAGE_TYPE_D90:
+            return 1;
+        default:
+            /* DHD images can be huge, and the CMD HD uses the file itself */
+            return 0;
+    }
+}
+
+static void fsimage_dxx_cache_grow(fsimage_t *fsimage, long size)
+{
+    long dirty_len = (size + 255) / 256;
+
+    fsimage->cache.data = lib_realloc(fsimage->cache.data, size);
+    memset(fsimage->cache.data + fsimage->cache.size, 0,
+           size - fsimage->cache.size);
+    fsimage->cache.size = size;
+
+    if (dirty_len > fsimage->cache.dirty_len) {
+        fsimage->cache.dirty = lib_realloc(fsimage->cache.dirty, dirty_len);
+        memset(fsimage->cache.dirty + fsimage->cache.dirty_len, 0,
+               dirty_len - fsimage->cache.dirty_len);
+        fsimage->cache.dirty_len = dirty_len;
+    }
+}
+
+/* Read from the image, like util_fpread().  */
+static int fsimage_dxx_pread(fsimage_t *fsimage, uint8_t *buf, size_t num,
+                             long offset)
+{
+    if (fsimage->cache.data == NULL) {
+        return util_fpread(fsimage->fd, buf, num, offset);
+    }
+
+    if (offset < 0 || offset + (long)num > fsimage->cache.size) {
+        return -1;
+    }
+    memcpy(buf, fsimage->cache.data + offset, num);
+    return 0;
+}
+
+/* Write to the image, like util_fpwrite().  */
+static int fsimage_dxx_pwrite(fsimage_t *fsimage, const uint8_t *buf,
+                              size_t num, long offset)
+{
+    long block, last;
+
+    if (fsimage->cache.data == NULL || fsimage_dxx_write_back_delay == 0) {
+        if (util_fpwrite(fsimage->fd, buf, num, offset) < 0) {
+            return -1;
+        }
+        if (fsimage->cache.data == NULL) {
+            return 0;
+        }
+    }
+
+    if (offset < 0) {
+        return -1;
+    }
+    if (num == 0) {
+        return 0;
+    }
+    if (offset + (long)num > fsimage->cache.size) {
+        fsimage_dxx_cache_grow(fsimage, offset + (long)num);
+    }
+    memcpy(fsimage->cache.data + offset, buf, num);
+
+    if (fsimage_dxx_write_back_delay > 0) {
+        last = (offset + (long)num - 1) / 256;
+        for (block = offset / 256; block <= last; block++) {
+            if (!fsimage->cache.dirty[block]) {
+                fsimage->cache.dirty[block] = 1;
+                if (fsimage->cache.dirty_count++ == 0) {
+                    fsimage->cache.dirty_since = time(NULL);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/* Write the dirty parts of the image in memory to the file.  */
+static int fsimage_dxx_cache_flush(fsimage_t *fsimage)
+{
+    long block, end, offset, len;
+    int rc = 0;
+
+    if (fsimage->cache.dirty_count == 0) {
+        return 0;
+    }
+
+    for (block = 0; block < fsimage->cache.dirty_len; block = end) {
+        if (!fsimage->cache.dirty[block]) {
+            end = block + 1;
+            continue;
+        }
+        for (end = block; end < fsimage->cache.dirty_len
+             && fsimage->cache.dirty[end]; end++) {
+            fsimage->cache.dirty[end] = 0;
+        }
+        offset = block * 256;
+        len = end * 256;
+        if (len > fsimage->cache.size) {
+            len = fsimage->cache.size;
+        }
+        len -= offset;
+        if (util_fpwrite(fsimage->fd, fsimage->cache.data + offset,
+                         (size_t)len, offset) < 0) {
+            rc = -1;
+        }
+    }
+    fsimage->cache.dirty_count = 0;
+
+    if (rc < 0) {
+        log_error(fsimage_dxx_log, "Error writing back disk image `%s'.",
+                  fsimage->name);
+    }
+
+    /* Make sure the stream is visible to other readers.  */
+    fflush(fsimage->fd);
+    return rc;
+}
+
+void fsimage_dxx_cache_open(disk_image_t *image)
+{
+    fsimage_t *fsimage = image->media.fsimage;
+    long size;
+
+    if (!fsimage_dxx_cache_enabled || !fsimage_dxx_cache_type(image->type)
+        || fsimage->cache.data != NULL) {
+        return;
+    }
+
+    size = (long)util_file_length(fsimage->fd);
+    if (size <= 0) {
+        return;
+    }
+
+    fsimage->cache.data = lib_malloc(size);
+    if (util_fpread(fsimage->fd, fsimage->cache.data, (size_t)size, 0) < 0) {
+        log_error(fsimage_dxx_log, "Cannot read disk image `%s' into memory.",
+                  fsimage->name);
+        lib_free(fsimage->cache.data);
+        fsimage->cache.data = NULL;
+        return;
+    }
+    fsimage->cache.size = size;
+    fsimage->cache.dirty_len = (size + 255) / 256;
+    fsimage->cache.dirty = lib_calloc(fsimage->cache.dirty_len, 1);
+    fsimage->cache.dirty_count = 0;
+
+    fsimage->cache.next = fsimage_dxx_cache_list;
+    fsimage_dxx_cache_list = fsimage;
+}
+
+void fsimage_dxx_cache_close(disk_image_t *image)
+{
+    fsimage_t *fsimage = image->media.fsimage;
+    fsimage_t **link;
+
+    if (fsimage->cache.data == NULL) {
+        return;
+    }
+
+    fsimage_dxx_cache_flush(fsimage);
+
+    for (link = &fsimage_dxx_cache_list; *link != NULL;
+         link = &(*link)->cache.next) {
+        if (*link == fsimage) {
+            *link = fsimage->cache.next;
+            break;
+        }
+    }
+
+    lib_free(fsimage->cache.data);
+    lib_free(fsimage->cache.dirty);
+    memset(&fsimage->cache, 0, sizeof(fsimage->cache));
+}
+
+/* Size of the image in memory, or -1 if it is not kept there.  */
+long fsimage_dxx_cache_size(const disk_image_t *image)
+{
+    fsimage_t *fsimage = image->media.fsimage;
+
+    return fsimage->cache.data != NULL ? fsimage->cache.size : -1;
+}
+
+/* Write back all images, or only the ones whose oldest dirty sector has
+   waited DiskImageWriteBackDelay seconds.  */
+void fsimage_dxx_flush(int expired_only)
+{
+    fsimage_t *fsimage;
+    time_t now = 0;
+
+    for (fsimage = fsimage_dxx_cache_list; fsimage != NULL;
+         fsimage = fsimage->cache.next) {
+        if (fsimage->cache.dirty_count == 0) {
+            continue;
+        }
+        if (expired_only) {
+            if (now == 0) {
+                now = time(NULL);
+            }
+            if (now - fsimage->cache.dirty_since < fsimage_dxx_write_back_delay) {
+                continue;
+            }
+        }
+        fsimage_dxx_cache_flush(fsimage);
+    }
+}
+
+void fsimage_dxx_set_cache(int enable)
+{
+    /* applies to the images attached from now on */
+    fsimage_dxx_cache_enabled = enable;
+}
+
+void fsimage_dxx_set_write_back_delay(int delay)
+{
+    fsimage_dxx_write_back_delay = delay;
+    if (delay == 0) {
+        fsimage_dxx_flush(0);
+    }
+}
+
 int fsimage_dxx_write_half_track(disk_image_t *image, unsigned int half_track,
                                  const disk_track_t *raw)
 {
@@ -52,6 +306,7 @@ int fsimage_dxx_write_half_track(disk_image_t *image, unsigned int half_track,
     uint8_t *buffer;
     fsimage_t *fsimage = image->media.fsimage;
     fdc_err_t rf;
+    disk_track_t track_copy;
 
     track = half_track / 2;
 
@@ -74,9 +329,12 @@ int fsimage_dxx_write_half_track(disk_image_t *image, unsigned int half_track,
         image->tracks = track;
     }
 
+    /* A copy keeps the sector index built by the reads below.  */
+    track_copy = *raw;
+
     buffer = lib_calloc(max_sector, 256);
     for (sector = 0; sector < max_sector; sector++) {
-        rf = gcr_read_sector(raw, &buffer[sector * 256], (uint8_t)sector);
+        rf = gcr_read_sector(&track_copy, &buffer[sector * 256], (uint8_t)sector);
         if (rf != CBMDOS_FDC_ERR_OK) {
             log_error(fsimage_dxx_log,
                       "Could not find data sector of T:%u S:%u.",
@@ -107,7 +365,7 @@ int fsimage_dxx_write_half_track(disk_image_t *image, unsigned int half_track,
         offset += X64_HEADER_LENGTH;
     }
 #endif
-    if (util_fpwrite(fsimage->fd, buffer, max_sector * 256, offset) < 0) {
+    if (fsimage_dxx_pwrite(fsimage, buffer, max_sector * 256, offset) < 0) {
         log_error(fsimage_dxx_log, "Error writing T:%u to disk image.",
                   track);
         lib_free(buffer);
@@ -125,11 +383,11 @@ int fsimage_dxx_write_half_track(disk_image_t *image, unsigned int half_track,
 #endif
             fsimage->error_info.dirty = 0;
             if (error_info_created) {
-                res = util_fpwrite(fsimage->fd, fsimage->error_info.map,
-                                   fsimage->error_info.len, fsimage->error_info.len * 256);
+                res = fsimage_dxx_pwrite(fsimage, fsimage->error_info.map,
+                                         fsimage->error_info.len, fsimage->error_info.len * 256);
             } else {
-                res = util_fpwrite(fsimage->fd, fsimage->error_info.map + sectors,
-                                   max_sector, offset);
+                res = fsimage_dxx_pwrite(fsimage, fsimage->error_info.map + sectors,
+                                         max_sector, offset);
             }
             if (res < 0) {
                 log_error(fsimage_dxx_log,
@@ -173,7 +431,7 @@ int fsimage_read_dxx_image(const disk_image_t *image)
 
     bam_id[0] = bam_id[1] = 0xa0;
     if (sectors >= 0) {
-        util_fpread(fsimage->fd, buffer, 256, sectors << 8);
+        fsimage_dxx_pread(fsimage, buffer, 256, sectors << 8);
     }
     header.id1 = bam_id[0];
     header.id2 = bam_id[1];
@@ -192,6 +450,7 @@ int fsimage_read_dxx_image(const disk_image_t *image)
         }
         ptr = image->gcr->tracks[half_track].data;
         image->gcr->tracks[half_track].size = track_size;
+        gcr_clear_index(&image->gcr->tracks[half_track]);
 
         if (track <= image->tracks) {
             /* get temp buffer */
@@ -202,7 +461,7 @@ int fsimage_read_dxx_image(const disk_image_t *image)
 
                 buffer[BAM_ID_1571] = buffer[BAM_ID_1571 + 1] = 0xa0;
                 if (sectors >= 0) {
-                    util_fpread(fsimage->fd, buffer, 256, sectors << 8);
+                    fsimage_dxx_pread(fsimage, buffer, 256, sectors << 8);
                 }
                 header.id1 = buffer[BAM_ID_1571]; /* second side, update id and track */
                 header.id2 = buffer[BAM_ID_1571 + 1];
@@ -229,7 +488,7 @@ int fsimage_read_dxx_image(const disk_image_t *image)
 #endif
                 if (sectors >= 0) {
                     rf = CBMDOS_FDC_ERR_DRIVE;
-                    if (util_fpread(fsimage->fd, buffer, 256, offset) >= 0) {
+                    if (fsimage_dxx_pread(fsimage, buffer, 256, offset) >= 0) {
                         if (fsimage->error_info.map != NULL) {
                             rf = fsimage->error_info.map[sectors];
                         }
@@ -274,6 +533,7 @@ int fsimage_read_dxx_image(const disk_image_t *image)
             image->gcr->tracks[half_track].data = lib_realloc(image->gcr->tracks[half_track].data, track_size);
         }
         image->gcr->tracks[half_track].size = track_size;
+        gcr_clear_index(&image->gcr->tracks[half_track]);
         ptr = image->gcr->tracks[half_track].data;
         memset(ptr, 0, track_size);        
 #endif
@@ -305,7 +565,7 @@ int fsimage_dxx_read_sector(const disk_image_t *image, uint8_t *buf, const disk_
     }
 #endif
     if (image->gcr == NULL) {
-        if (util_fpread(fsimage->fd, buf, 256, offset) < 0) {
+        if (fsimage_dxx_pread(fsimage, buf, 256, offset) < 0) {
             log_error(fsimage_dxx_log,
                       "Error reading T:%u S:%u from disk image.",
                       dadr->track, dadr->sector);
@@ -378,7 +638,7 @@ int fsimage_dxx_write_sector(disk_image_t *image, const uint8_t *buf, const disk
         offset += X64_HEADER_LENGTH;
     }
 #endif
-    if (util_fpwrite(fsimage->fd, buf, 256, offset) < 0) {
+    if (fsimage_dxx_pwrite(fsimage, buf, 256, offset) < 0) {
         log_error(fsimage_dxx_log, "Error writing T:%u S:%u to disk image.",
                   dadr->track, dadr->sector);
         return -1;
@@ -397,7 +657,7 @@ int fsimage_dxx_write_sector(disk_image_t *image, const uint8_t *buf, const disk
         }
 #endif
         fsimage->error_info.map[sectors] = CBMDOS_FDC_ERR_OK;
-        if (util_fpwrite(fsimage->fd, &fsimage->error_info.map[sectors], 1, offset) < 0) {
+        if (fsimage_dxx_pwrite(fsimage, &fsimage->error_info.map[sectors], 1, offset) < 0) {
             log_error(fsimage_dxx_log,
                     "Error writing T:%u S:%u error info to disk image.",
                     dadr->track, dadr->sector);
@@ -44,4 +44,12 @@ extern int fsimage_dxx_read_sector(const struct disk_image_s *image, uint8_t *bu
 extern int fsimage_dxx_write_sector(struct disk_image_s *image, const uint8_t *buf,
                                     const struct disk_addr_s *dadr);
 
+/* Keeping the image in memory, see fsimage-dxx.c.  */
+extern void fsimage_dxx_cache_open(struct disk_image_s *image);
+extern void fsimage_dxx_cache_close(struct disk_image_s *image);
+extern long fsimage_dxx_cache_size(const struct disk_image_s *image);
+extern void fsimage_dxx_flush(int expired_only);
+extern void fsimage_dxx_set_cache(int enable);
+extern void fsimage_dxx_set_write_back_delay(int delay);
+
 #endif
@@ -129,6 +129,7 @@ int fsimage_gcr_read_half_track(const disk_image_t *image, unsigned int half_tra
 
     raw->data = NULL;
     raw->size = 0;
+    gcr_clear_index(raw);
 
     offset = fsimage_gcr_seek_half_track(fsimage, half_track, &max_track_length, &num_half_tracks);
 
@@ -124,6 +124,7 @@ int fsimage_p64_read_half_track(const disk_image_t *image, unsigned int half_tra
 
     raw->data = NULL;
     raw->size = 0;
+    gcr_clear_index(raw);
     if (P64Image == NULL) {
         log_error(fsimage_p64_log, "P64 image not loaded.");
         return -1;
@@ -130,6 +130,9 @@ int fsimage_open(disk_image_t *image)
     fsimage = image->media.fsimage;
     fsimage->error_info.map = NULL;
 
+    /* The file might be one of the images kept in memory.  */
+    fsimage_dxx_flush(0);
+
     if (image->read_only) {
         fsimage->fd = zfile_fopen(fsimage->name, MODE_READ);
     } else {
@@ -148,6 +151,7 @@ int fsimage_open(disk_image_t *image)
     }
 
     if (fsimage_probe(image) == 0) {
+        fsimage_dxx_cache_open(image);
         return 0;
     }
 
@@ -171,6 +175,8 @@ int fsimage_close(disk_image_t *image)
         fsimage_write_p64_image(image);
     }*/
 
+    fsimage_dxx_cache_close(image);
+
     if (fsimage->error_info.map) {
         lib_free(fsimage->error_info.map);
         fsimage->error_info.map = NULL;
@@ -288,7 +294,13 @@ void fsimage_init(void)
 uint32_t fsimage_size(const disk_image_t *image)
 {
     fsimage_t *fsimage;
+    long size;
 
     fsimage = image->media.fsimage;
+
+    size = fsimage_dxx_cache_size(image);
+    if (size >= 0) {
+        return (uint32_t)size;
+    }
     return (uint32_t)util_file_length(fsimage->fd);
 }
@@ -28,6 +28,7 @@
 #define VICE_FSIMAGE_H
 
 #include <stdio.h>
+#include <time.h>
 
 #include "types.h"
 
@@ -42,6 +43,17 @@ typedef struct fsimage_s {
         int dirty;
         int len;
     } error_info;
+    /* The whole file in memory, for the sector based formats.  See
+       fsimage-dxx.c.  */
+    struct {
+        uint8_t *data;
+        long size;
+        uint8_t *dirty;         /* one flag per 256 bytes of `data' */
+        long dirty_len;
+        long dirty_count;
+        time_t dirty_since;
+        struct fsimage_s *next;
+    } cache;
 } fsimage_t;
 
 
@@ -53,6 +53,12 @@ static const cmdline_option_t cmdline_options[] =
     { "-drivesoundvolume", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
       NULL, NULL, "DriveSoundEmulationVolume", NULL,
       "<Volume>", "Set volume for disk drive sound emulation (0-4000)" },
+    { "-driveidleloopskip", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "DriveIdleLoopSkip", (void *)1,
+      NULL, "Fast-forward polling loops of the disk drive CPUs" },
+    { "+driveidleloopskip", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "DriveIdleLoopSkip", (void *)0,
+      NULL, "Run polling loops of the disk drive CPUs cycle by cycle" },
     CMDLINE_LIST_END
 };
 
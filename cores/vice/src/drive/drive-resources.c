@@ -55,6 +55,9 @@ int drive_sound_emulation;
 /* volume of the drive sound */
 int drive_sound_emulation_volume;
 
+/* Are idle loops of the drive CPU fast-forwarded?  */
+int drive_idle_loop_skip;
+
 static int set_drive_true_emulation(int val, void *param)
 {
     unsigned int dnr;
@@ -103,6 +106,13 @@ static int set_drive_sound_emulation(int val, void *param)
     return 0;
 }
 
+static int set_drive_idle_loop_skip(int val, void *param)
+{
+    drive_idle_loop_skip = val ? 1 : 0;
+
+    return 0;
+}
+
 static int set_drive_sound_emulation_volume(int val, void *param)
 {
     if ((val < 0) || (val > 4000)) {
@@ -351,6 +361,8 @@ static const resource_int_t resources_int[] = {
       &drive_sound_emulation, set_drive_sound_emulation, NULL },
     { "DriveSoundEmulationVolume", 1000, RES_EVENT_NO, (resource_value_t)1000,
       &drive_sound_emulation_volume, set_drive_sound_emulation_volume, NULL },
+    { "DriveIdleLoopSkip", 0, RES_EVENT_NO, (resource_value_t)0,
+      &drive_idle_loop_skip, set_drive_idle_loop_skip, NULL },
     RESOURCE_INT_LIST_END
 };
 
@@ -1127,6 +1127,7 @@ static int drive_snapshot_read_gcrimage_module(snapshot_t *s, unsigned int dnr)
         }
         data = drive->gcr->tracks[i].data;
         drive->gcr->tracks[i].size = track_size;
+        gcr_clear_index(&drive->gcr->tracks[i]);
 
         if (track_size && SMR_BA(m, data, track_size) < 0) {
             snapshot_module_close(m);
@@ -1139,6 +1140,7 @@ static int drive_snapshot_read_gcrimage_module(snapshot_t *s, unsigned int dnr)
             drive->gcr->tracks[i].data = NULL;
             drive->gcr->tracks[i].size = 0;
         }
+        gcr_clear_index(&drive->gcr->tracks[i]);
     }
     snapshot_module_close(m);
 
@@ -64,6 +64,7 @@
 #include "machine-drive.h"
 #include "machine.h"
 #include "maincpu.h"
+#include "perfstats.h"
 #include "resources.h"
 #include "rotation.h"
 #include "types.h"
@@ -534,6 +535,16 @@ monitor_interface_t *drive_cpu_monitor_interface_get(unsigned int dnr)
     return diskunit_context[dnr]->cpu->monitor_interface;
 }
 
+struct alarm_context_s *drive_cpu_alarm_context_get(unsigned int dnr)
+{
+    return diskunit_context[dnr]->cpu->alarm_context;
+}
+
+struct interrupt_cpu_status_s *drive_cpu_int_status_get(unsigned int dnr)
+{
+    return diskunit_context[dnr]->cpu->int_status;
+}
+
 void drive_cpu_early_init_all(void)
 {
     unsigned int dnr;
@@ -681,6 +692,10 @@ void drive_gcr_data_writeback(drive_t *drive)
         return;
     }
 
+    /* The drive has written to the track, so the sector headers found in
+       it before may have moved.  */
+    gcr_clear_index(&drive->gcr->tracks[half_track - 2]);
+
     if ((drive->image->type == DISK_IMAGE_TYPE_G64)
         || (drive->image->type == DISK_IMAGE_TYPE_G71)) {
         disk_image_write_half_track(drive->image, half_track,
@@ -866,12 +881,16 @@ int drive_num_leds(unsigned int dnr)
 
 void drive_cpu_execute_one(diskunit_context_t *drv, CLOCK clk_value)
 {
+    unsigned long perfstats_start = perfstats_begin();
+
     if (drv->type == DRIVE_TYPE_2000 || drv->type == DRIVE_TYPE_4000 ||
         drv->type == DRIVE_TYPE_CMDHD) {
         drivecpu65c02_execute(drv, clk_value);
     } else {
         drivecpu_execute(drv, clk_value);
     }
+
+    perfstats_end(PERFSTATS_DRIVE, perfstats_start);
 }
 
 void drive_cpu_execute_all(CLOCK clk_value)
@@ -923,6 +942,8 @@ void drive_vsync_hook(void)
             /* printf("drive_vsync_hook drv %d @clk:%d\n", dnr, maincpu_clk); */
         }
     }
+
+    disk_image_flush_expired();
 }
 
 /* ------------------------------------------------------------------------- */
@@ -341,6 +341,7 @@ extern CLOCK diskunit_clk[NUM_DISK_UNITS];
 extern struct diskunit_context_s *diskunit_context[NUM_DISK_UNITS];
 
 extern int rom_loaded;
+extern int drive_idle_loop_skip;
 
 extern int drive_init(void);
 extern int drive_enable(struct diskunit_context_s *drv);
@@ -348,6 +349,8 @@ extern void drive_disable(struct diskunit_context_s *drv);
 extern void drive_move_head(int step, struct drive_s *drive);
 /* Don't use these pointers before the context is set up!  */
 extern struct monitor_interface_s *drive_cpu_monitor_interface_get(unsigned int dnr);
+extern struct alarm_context_s *drive_cpu_alarm_context_get(unsigned int dnr);
+extern struct interrupt_cpu_status_s *drive_cpu_int_status_get(unsigned int dnr);
 extern void drive_cpu_early_init_all(void);
 extern void drive_cpu_prevent_clk_overflow_all(CLOCK sub);
 extern void drive_cpu_trigger_reset(unsigned int dnr);
@@ -51,9 +51,12 @@
 #include "mem.h"
 #include "monitor.h"
 #include "mos6510.h"
+#include "perfstats.h"
 #include "rotation.h"
 #include "snapshot.h"
+#include "traps.h"
 #include "types.h"
+#include "via.h"
 
 
 #define DRIVE_CPU
@@ -129,20 +132,122 @@ void drivecpu_setup_context(struct diskunit_context_s *drv, int i)
 }
 
 /* ------------------------------------------------------------------------- */
+/* Idle loop fast-forward.
 
-#define LOAD(a)           (*drv->cpud->read_func_ptr[(a) >> 8])(drv, (uint16_t)(a))
+   Fastloaders wait for the computer in polling loops of their own, which
+   the ROM idle traps know nothing about.  While the drive catches up with
+   the main CPU nothing outside the drive changes, so once a loop gets back
+   to its start with the same registers, having stored nothing new and read
+   only memory and the serial port, it would keep doing exactly that until
+   the next alarm.  Whole iterations up to the alarm are skipped then,
+   which leaves the clock and everything else where running them would.  */
+
+/* Longest backward branch or jump that makes a loop, in bytes.  */
+#define IDLE_LOOP_BYTES 32
+
+inline static void idle_loop_load(diskunit_context_t *drv, uint16_t addr)
+{
+    drivecpud_context_t *cpud = drv->cpud;
+
+    if (cpud->read_base_tab_ptr[addr >> 8] == NULL) {
+        unsigned int reg = addr & 0x0f;
+
+        if (cpud->read_func_ptr[addr >> 8] != cpud->idle_read_func
+            || (reg != VIA_PRB && reg != VIA_DDRB && reg != VIA_DDRA)) {
+            drv->cpu->idle_loop_tainted = 1;
+        }
+    }
+}
+
+inline static void idle_loop_store(diskunit_context_t *drv, uint16_t addr,
+                                   uint8_t value)
+{
+    uint8_t *base = drv->cpud->read_base_tab_ptr[addr >> 8];
+
+    /* storing what is already there changes nothing, as JSR does in a loop */
+    if (base == NULL || base[addr] != value) {
+        drv->cpu->idle_loop_tainted = 1;
+    }
+}
+
+#define IDLE_LOAD(a)     (drive_idle_loop_skip ? idle_loop_load(drv, (uint16_t)(a)) : (void)0)
+#define IDLE_STORE(a, b) (drive_idle_loop_skip ? idle_loop_store(drv, (uint16_t)(a), (uint8_t)(b)) : (void)0)
+
+/* Called after each instruction.  */
+static void drivecpu_idle_loop(diskunit_context_t *drv)
+{
+    drivecpu_context_t *cpu = drv->cpu;
+    unsigned int pc = cpu->cpu_regs.pc;
+    unsigned int from = cpu->last_opcode_addr;
+    uint8_t *base = drv->cpud->read_base_tab_ptr[from >> 8];
+
+    if (base == NULL) {
+        cpu->idle_loop_tainted = 1;
+    } else {
+        switch (base[from]) {
+            case TRAP_OPCODE:   /* ROM traps may move the clock */
+            case 0x08:          /* PHP, BVC, BVS and CLV see the byte ready line */
+            case 0x50:
+            case 0x70:
+            case 0xb8:
+                cpu->idle_loop_tainted = 1;
+                break;
+        }
+    }
+
+    if (pc > from || from - pc >= IDLE_LOOP_BYTES) {
+        return;
+    }
+
+    /* Back at the start of a loop.  */
+    if (pc == cpu->idle_loop_pc && !cpu->idle_loop_tainted
+        && cpu->cpu_regs.a == cpu->idle_loop_regs.a
+        && cpu->cpu_regs.x == cpu->idle_loop_regs.x
+        && cpu->cpu_regs.y == cpu->idle_loop_regs.y
+        && cpu->cpu_regs.sp == cpu->idle_loop_regs.sp
+        && cpu->cpu_regs.p == cpu->idle_loop_regs.p
+        && cpu->cpu_regs.n == cpu->idle_loop_regs.n
+        && cpu->cpu_regs.z == cpu->idle_loop_regs.z
+        && (cpu->int_status->global_pending_int == IK_NONE
+            || (cpu->int_status->global_pending_int == IK_IRQ
+                && (cpu->cpu_regs.p & P_INTERRUPT)))
+        /* watchpoints must see every access */
+        && drv->cpud->read_func_ptr == drv->cpud->read_tab[0]) {
+        CLOCK period = *(drv->clk_ptr) - cpu->idle_loop_clk;
+        CLOCK next_clk = alarm_context_next_pending_clk(cpu->alarm_context);
+
+        if (next_clk > cpu->stop_clk) {
+            next_clk = cpu->stop_clk;
+        }
+        if (period > 0 && next_clk > *(drv->clk_ptr)) {
+            CLOCK skip = (next_clk - *(drv->clk_ptr)) / period * period;
+
+            *(drv->clk_ptr) += skip;
+            perfstats_drive_idle_cycles += (unsigned long)skip;
+        }
+    }
+
+    cpu->idle_loop_pc = pc;
+    cpu->idle_loop_clk = *(drv->clk_ptr);
+    cpu->idle_loop_regs = cpu->cpu_regs;
+    cpu->idle_loop_tainted = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+#define LOAD(a)           (IDLE_LOAD(a), (*drv->cpud->read_func_ptr[(a) >> 8])(drv, (uint16_t)(a)))
 #define LOAD_ZERO(a)      (*drv->cpud->read_func_ptr[0])(drv, (uint16_t)(a))
 #define LOAD_ADDR(a)      (LOAD((a)) | (LOAD((a) + 1) << 8))
 #define LOAD_ZERO_ADDR(a) (LOAD_ZERO((a)) | (LOAD_ZERO((a) + 1) << 8))
-#define STORE(a, b)       (*drv->cpud->store_func_ptr[(a) >> 8])(drv, (uint16_t)(a), (uint8_t)(b))
-#define STORE_ZERO(a, b)  (*drv->cpud->store_func_ptr[0])(drv, (uint16_t)(a), (uint8_t)(b))
+#define STORE(a, b)       (IDLE_STORE(a, b), (*drv->cpud->store_func_ptr[(a) >> 8])(drv, (uint16_t)(a), (uint8_t)(b)))
+#define STORE_ZERO(a, b)  (IDLE_STORE(a, b), (*drv->cpud->store_func_ptr[0])(drv, (uint16_t)(a), (uint8_t)(b)))
 
-#define LOAD_DUMMY(a)           (*drv->cpud->read_func_ptr_dummy[(a) >> 8])(drv, (uint16_t)(a))
+#define LOAD_DUMMY(a)           (IDLE_LOAD(a), (*drv->cpud->read_func_ptr_dummy[(a) >> 8])(drv, (uint16_t)(a)))
 #define LOAD_ZERO_DUMMY(a)      (*drv->cpud->read_func_ptr_dummy[0])(drv, (uint16_t)(a))
 #define LOAD_ADDR_DUMMY(a)      (LOAD_DUMMY((a)) | (LOAD_DUMMY((a) + 1) << 8))
 #define LOAD_ZERO_ADDR_DUMMY(a) (LOAD_ZERO_DUMMY((a)) | (LOAD_ZERO_DUMMY((a) + 1) << 8))
-#define STORE_DUMMY(a, b)       (*drv->cpud->store_func_ptr_dummy[(a) >> 8])(drv, (uint16_t)(a), (uint8_t)(b))
-#define STORE_ZERO_DUMMY(a, b)  (*drv->cpud->store_func_ptr_dummy[0])(drv, (uint16_t)(a), (uint8_t)(b))
+#define STORE_DUMMY(a, b)       (IDLE_STORE(a, b), (*drv->cpud->store_func_ptr_dummy[(a) >> 8])(drv, (uint16_t)(a), (uint8_t)(b)))
+#define STORE_ZERO_DUMMY(a, b)  (IDLE_STORE(a, b), (*drv->cpud->store_func_ptr_dummy[0])(drv, (uint16_t)(a), (uint8_t)(b)))
 
 #define JUMP(addr)                                                         \
     do {                                                                   \
@@ -197,6 +302,7 @@ void drivecpu_reset(diskunit_context_t *drv)
 
     *(drv->clk_ptr) = 0;
     drivecpu_reset_clk(drv);
+    drv->cpu->idle_loop_tainted = 1;
 
     preserve_monitor = drv->cpu->int_status->global_pending_int & IK_MONITOR;
 
@@ -404,6 +510,9 @@ void drivecpu_execute(diskunit_context_t *drv, CLOCK clk_value)
 
     drivecpu_wake_up(drv);
 
+    /* the main CPU may have changed the bus since the last call */
+    cpu->idle_loop_tainted = 1;
+
     /* Calculate number of main CPU clocks to emulate */
     if (clk_value > cpu->last_clk) {
         cycles = clk_value - cpu->last_clk;
@@ -468,6 +577,10 @@ void drivecpu_execute(diskunit_context_t *drv, CLOCK clk_value)
 #define bank_base (cpu->d_bank_base)
 
 #include "6510core.c"
+
+        if (drive_idle_loop_skip) {
+            drivecpu_idle_loop(drv);
+        }
     }
 
     cpu->last_clk = clk_value;
@@ -688,6 +801,7 @@ int drivecpu_snapshot_read_module(diskunit_context_t *drv, snapshot_t *s)
     MOS6510_REGS_SET_SP(&(cpu->cpu_regs), sp);
     MOS6510_REGS_SET_PC(&(cpu->cpu_regs), pc);
     MOS6510_REGS_SET_STATUS(&(cpu->cpu_regs), status);
+    cpu->idle_loop_tainted = 1;
 
     log_message(drv->log, "RESET (For undump).");
 
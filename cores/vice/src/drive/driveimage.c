@@ -243,6 +243,7 @@ int drive_image_detach(disk_image_t *image, unsigned int unit, unsigned int drv)
             drive->gcr->tracks[i].data = NULL;
             drive->gcr->tracks[i].size = 0;
         }
+        gcr_clear_index(&drive->gcr->tracks[i]);
     }
     drive->detach_clk = diskunit_clk[dnr];
     drive->GCR_image_loaded = 0;
@@ -214,6 +214,7 @@ void drivemem_init(diskunit_context_t *unit)
     }
 
     drivemem_set_func(unit->cpud, 0x00, 0x101, drive_read_free, drive_store_free, drive_peek_free, NULL, 0);
+    unit->cpud->idle_read_func = NULL;
 
     machine_drive_mem_init(unit, unit->type);
 
@@ -103,6 +103,12 @@ typedef struct drivecpu_context_s {
     char *snap_module_name;
 
     char *identification_string;
+
+    /* Idle loop detection, see drivecpu_idle_loop().  */
+    int idle_loop_tainted;          /* the loop may not repeat itself */
+    unsigned int idle_loop_pc;      /* start of the loop being watched */
+    CLOCK idle_loop_clk;            /* clock when it was last there */
+    mos6510_regs_t idle_loop_regs;  /* registers when it was last there */
 } drivecpu_context_t;
 
 
@@ -130,6 +136,11 @@ typedef struct drivecpud_context_s {
     uint32_t read_limit_tab[1][0x101];
 
     int sync_factor;
+
+    /* Read function of the I/O chip whose port B and data direction
+       registers only change with the serial bus or the drive's own
+       stores, so that idle loops may poll them.  */
+    drive_read_func_t *idle_read_func;
 } drivecpud_context_t;
 
 
@@ -0,0 +1,727 @@
+/*
+ * gcr-benchmark.c - Benchmark for the GCR conversion.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: gcr-benchmark [rounds [image.g64 ...]]
+
+   Converts a 35 track disk of random sectors to GCR, as attaching a D64
+   does, then reads every sector of every track back, as writing a track
+   back to a D64 does, and writes every sector in place.  The disk is
+   also read with every track rotated by a few bits, so that the SYNCs do
+   not start on a byte, and with a few sectors missing or damaged.  The
+   tracks of each G64 image given are read the same way.
+
+   Every step runs `rounds' times (default 20) through gcr.c and through
+   the bit by bit code gcr.c used before, which is kept here.  It reports
+   the time per track of both and checks that they give the same sectors,
+   the same errors and the same GCR data.  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "archdep.h"
+#include "cbmdos.h"
+#include "gcr.h"
+#include "lib.h"
+#include "log.h"
+#include "types.h"
+
+#define BENCH_TRACKS        35
+#define BENCH_HEADER_GAP    9
+#define BENCH_SYNC          5
+
+typedef struct bench_disk_s {
+    const char *name;
+    int num_tracks;
+    disk_track_t tracks[MAX_GCR_TRACKS];
+} bench_disk_t;
+
+static int bench_errors;
+
+/* Stubs for lib.c.  */
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+/* The conversion as gcr.c did it before, a nybble or a bit at a time.  */
+static const uint8_t ref_GCR_conv_data[16] =
+{
+    0x0a, 0x0b, 0x12, 0x13,
+    0x0e, 0x0f, 0x16, 0x17,
+    0x09, 0x19, 0x1a, 0x1b,
+    0x0d, 0x1d, 0x1e, 0x15
+};
+
+static const uint8_t ref_From_GCR_conv_data[32] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 8, 0, 1, 0, 12, 4, 5,
+    0, 0, 2, 3, 0, 15, 6, 7,
+    0, 9, 10, 11, 0, 13, 14, 0
+};
+
+static void ref_convert_4bytes_to_GCR(const uint8_t *source, uint8_t *dest)
+{
+    int i;
+    unsigned int tdest = 0;
+
+    for (i = 2; i < 10; i += 2, source++, dest++) {
+        tdest <<= 5;
+        tdest |= ref_GCR_conv_data[(*source) >> 4];
+        tdest <<= 5;
+        tdest |= ref_GCR_conv_data[(*source) & 0x0f];
+        *dest = (uint8_t)(tdest >> i);
+    }
+    *dest = (uint8_t)tdest;
+}
+
+static void ref_convert_GCR_to_4bytes(const uint8_t *source, uint8_t *dest)
+{
+    int i;
+    uint32_t tdest = *source;
+
+    tdest <<= 13;
+    for (i = 5; i < 13; i += 2, dest++) {
+        source++;
+        tdest |= ((uint32_t)(*source)) << i;
+        *dest = ref_From_GCR_conv_data[(tdest >> 16) & 0x1f] << 4;
+        tdest <<= 5;
+        *dest |= ref_From_GCR_conv_data[(tdest >> 16) & 0x1f];
+        tdest <<= 5;
+    }
+}
+
+static void ref_convert_sector_to_GCR(const uint8_t *buffer, uint8_t *data, const gcr_header_t *header,
+                                      int gap, int sync, fdc_err_t error_code)
+{
+    int i;
+    uint8_t buf[4], chksum, idm;
+
+    idm = (error_code == CBMDOS_FDC_ERR_ID) ? 0xff : 0x00;
+
+    memset(data, (error_code == CBMDOS_FDC_ERR_SYNC) ? 0x55 : 0xff, 5);
+    data += 5;
+
+    chksum = (error_code == CBMDOS_FDC_ERR_HCHECK) ? 0xff : 0x00;
+    chksum ^= header->sector ^ header->track ^ header->id2 ^ header->id1 ^ idm;
+    buf[0] = (error_code == CBMDOS_FDC_ERR_HEADER) ? 0xff : 0x08;
+    buf[1] = chksum;
+    buf[2] = header->sector;
+    buf[3] = header->track;
+    ref_convert_4bytes_to_GCR(buf, data);
+    data += 5;
+
+    buf[0] = header->id2;
+    buf[1] = header->id1 ^ idm;
+    buf[2] = buf[3] = 0x0f;
+    ref_convert_4bytes_to_GCR(buf, data);
+    data += 5;
+
+    data += gap;
+
+    memset(data, (error_code == CBMDOS_FDC_ERR_SYNC) ? 0x55 : 0xff, sync);
+    data += sync;
+
+    chksum = (error_code == CBMDOS_FDC_ERR_DCHECK) ? 0xff : 0x00;
+    buf[0] = (error_code == CBMDOS_FDC_ERR_NOBLOCK) ? 0x00 : 0x07;
+    memcpy(buf + 1, buffer, 3);
+    chksum ^= buffer[0] ^ buffer[1] ^ buffer[2];
+    ref_convert_4bytes_to_GCR(buf, data);
+    buffer += 3;
+    data += 5;
+
+    for (i = 0; i < 63; i++) {
+        chksum ^= buffer[0] ^ buffer[1] ^ buffer[2] ^ buffer[3];
+        ref_convert_4bytes_to_GCR(buffer, data);
+        buffer += 4;
+        data += 5;
+    }
+
+    buf[0] = buffer[0];
+    buf[1] = chksum ^ buffer[0];
+    buf[2] = buf[3] = 0;
+    ref_convert_4bytes_to_GCR(buf, data);
+}
+
+static int ref_find_sync(const disk_track_t *raw, int p, int s)
+{
+    unsigned int w;
+    int b;
+
+    if (!raw->data || !raw->size) {
+        return -CBMDOS_FDC_ERR_SYNC;
+    }
+
+    w = 0;
+    b = raw->data[p >> 3] << (p & 7);
+    while (s--) {
+        if (b & 0x80) {
+            w = (w << 1) | 1;
+        } else {
+            if (~w & 0x3ff) {
+                w <<= 1;
+            } else {
+                return p;
+            }
+        }
+        if (~p & 7) {
+            p++;
+            b <<= 1;
+        } else {
+            p++;
+            if (p >= raw->size * 8) {
+                p = 0;
+            }
+            b = raw->data[p >> 3];
+        }
+    }
+    return -CBMDOS_FDC_ERR_SYNC;
+}
+
+static void ref_decode_block(const disk_track_t *raw, int p, uint8_t *buf, int num)
+{
+    int shift, i, j;
+    uint8_t gcr[5], b;
+    uint8_t *offset, *end = raw->data + raw->size;
+
+    shift = p & 7;
+    offset = raw->data + (p >> 3);
+
+    b = offset[0] << shift;
+    for (i = 0; i < num; i++, buf += 4) {
+        for (j = 0; j < 5; j++) {
+            offset++;
+            if (offset >= end) {
+                offset = raw->data;
+            }
+            if (shift) {
+                gcr[j] = b | ((offset[0] << shift) >> 8);
+                b = offset[0] << shift;
+            } else {
+                gcr[j] = b;
+                b = offset[0];
+            }
+        }
+        ref_convert_GCR_to_4bytes(gcr, buf);
+    }
+}
+
+static int ref_find_sector_header(const disk_track_t *raw, uint8_t sector)
+{
+    uint8_t header[4];
+    int p, p2;
+
+    p = 0;
+    p2 = -CBMDOS_FDC_ERR_SYNC;
+    for (;;) {
+        p = ref_find_sync(raw, p, raw->size * 8);
+        if (p2 == p) {
+            break;
+        }
+        if (p2 < 0) {
+            p2 = p;
+        }
+        ref_decode_block(raw, p, header, 1);
+
+        if (header[0] == 0x08 && header[2] == sector) {
+            return p;
+        }
+    }
+    if (p2 < 0) {
+        return p2;
+    }
+    return -CBMDOS_FDC_ERR_HEADER;
+}
+
+static fdc_err_t ref_read_sector(const disk_track_t *raw, uint8_t *data, uint8_t sector)
+{
+    uint8_t buffer[260];
+    uint8_t b;
+    int i, p;
+
+    p = ref_find_sector_header(raw, sector);
+    if (p < 0) {
+        return -p;
+    }
+
+    p = ref_find_sync(raw, p, 500 * 8);
+    if (p < 0) {
+        return -p;
+    }
+
+    ref_decode_block(raw, p, buffer, 65);
+
+    b = buffer[257];
+    for (i = 0; i < 256; i++) {
+        data[i] = buffer[i + 1];
+        b ^= data[i];
+    }
+
+    if (buffer[0] != 0x07) {
+        return CBMDOS_FDC_ERR_NOBLOCK;
+    }
+
+    return b ? CBMDOS_FDC_ERR_DCHECK : CBMDOS_FDC_ERR_OK;
+}
+
+static fdc_err_t ref_write_sector(disk_track_t *raw, const uint8_t *data, uint8_t sector)
+{
+    uint8_t buffer[260], *offset, *buf;
+    uint8_t *end = raw->data + raw->size;
+    uint8_t gcr[5], chksum, b;
+    int i, j, shift, p;
+
+    p = ref_find_sector_header(raw, sector);
+    if (p < 0) {
+        return -p;
+    }
+
+    p = ref_find_sync(raw, p, 500 * 8);
+    if (p < 0) {
+        return -p;
+    }
+
+    shift = p & 7;
+    offset = raw->data + (p >> 3);
+
+    b = offset[0] & (0xff00 >> shift);
+
+    buffer[0] = 0x07;
+    memcpy(buffer + 1, data, 256);
+    chksum = buffer[1];
+    for (i = 2; i < 257; i++) {
+        chksum ^= buffer[i];
+    }
+    buffer[257] = chksum;
+    buffer[258] = buffer[259] = 0;
+
+    buf = buffer;
+
+    for (i = 0; i < 65; i++) {
+        ref_convert_4bytes_to_GCR(buf, gcr);
+        buf += 4;
+        for (j = 0; j < 5; j++) {
+            if (shift) {
+                offset[0] = b | (gcr[j] >> shift);
+                b = (gcr[j] << 8) >> shift;
+            } else {
+                offset[0] = gcr[j];
+            }
+            offset++;
+            if (offset >= end) {
+                offset = raw->data;
+            }
+        }
+    }
+    offset[0] = b | (offset[0] & (0xff >> shift));
+
+    return CBMDOS_FDC_ERR_OK;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* The sectors and the raw size of a track, as in diskimage.c.  */
+static int bench_sectors(int track)
+{
+    return track < 18 ? 21 : track < 25 ? 19 : track < 31 ? 18 : 17;
+}
+
+static int bench_raw_size(int track)
+{
+    return track < 18 ? 7692 : track < 25 ? 7142 : track < 31 ? 6666 : 6250;
+}
+
+static uint8_t bench_sector_data[BENCH_TRACKS][21][256];
+
+static fdc_err_t bench_sector_error(int track, int sector)
+{
+    /* A few damaged sectors, as in D64 images with an error map.  */
+    if (track == 5 && sector == 3) {
+        return CBMDOS_FDC_ERR_DCHECK;
+    }
+    if (track == 9 && sector == 11) {
+        return CBMDOS_FDC_ERR_NOBLOCK;
+    }
+    if (track == 20 && sector == 7) {
+        return CBMDOS_FDC_ERR_HEADER;
+    }
+    if (track == 33 && sector == 0) {
+        return CBMDOS_FDC_ERR_SYNC;
+    }
+    return CBMDOS_FDC_ERR_OK;
+}
+
+/* Lay out the sectors of `track' as fsimage-dxx.c does.  */
+static void bench_convert_track(int track, uint8_t *data, int use_ref)
+{
+    gcr_header_t header;
+    int sectors = bench_sectors(track);
+    int size = bench_raw_size(track);
+    int gap, sector;
+    uint8_t *ptr = data;
+
+    gap = (size - sectors * (SECTOR_GCR_SIZE_WITH_HEADER + BENCH_HEADER_GAP + BENCH_SYNC * 2)) / sectors;
+
+    memset(data, 0x55, size);
+    header.track = (uint8_t)(track + 1);
+    header.id1 = 'A';
+    header.id2 = 'B';
+    for (sector = 0; sector < sectors; sector++) {
+        header.sector = (uint8_t)sector;
+        if (use_ref) {
+            ref_convert_sector_to_GCR(bench_sector_data[track][sector], ptr, &header,
+                                      BENCH_HEADER_GAP, BENCH_SYNC, bench_sector_error(track, sector));
+        } else {
+            gcr_convert_sector_to_GCR(bench_sector_data[track][sector], ptr, &header,
+                                      BENCH_HEADER_GAP, BENCH_SYNC, bench_sector_error(track, sector));
+        }
+        ptr += SECTOR_GCR_SIZE_WITH_HEADER + BENCH_HEADER_GAP + gap + BENCH_SYNC * 2;
+    }
+}
+
+static void bench_make_disk(bench_disk_t *disk, bench_disk_t *rotated, int rounds)
+{
+    uint8_t *ref;
+    double t_new, t_ref;
+    int track, sector, i, r, shift;
+
+    srand(64);
+    for (track = 0; track < BENCH_TRACKS; track++) {
+        for (sector = 0; sector < 21; sector++) {
+            for (i = 0; i < 256; i++) {
+                bench_sector_data[track][sector][i] = (uint8_t)rand();
+            }
+        }
+    }
+
+    disk->name = "D64";
+    rotated->name = "D64 rotated";
+    disk->num_tracks = rotated->num_tracks = BENCH_TRACKS;
+    ref = malloc(NUM_MAX_BYTES_TRACK);
+    for (track = 0; track < BENCH_TRACKS; track++) {
+        disk->tracks[track].size = rotated->tracks[track].size = bench_raw_size(track);
+        disk->tracks[track].data = malloc(NUM_MAX_BYTES_TRACK);
+        rotated->tracks[track].data = malloc(NUM_MAX_BYTES_TRACK);
+    }
+
+    t_ref = now();
+    for (r = 0; r < rounds; r++) {
+        for (track = 0; track < BENCH_TRACKS; track++) {
+            bench_convert_track(track, ref, 1);
+        }
+    }
+    t_ref = now() - t_ref;
+
+    t_new = now();
+    for (r = 0; r < rounds; r++) {
+        for (track = 0; track < BENCH_TRACKS; track++) {
+            bench_convert_track(track, disk->tracks[track].data, 0);
+        }
+    }
+    t_new = now() - t_new;
+
+    for (track = 0; track < BENCH_TRACKS; track++) {
+        bench_convert_track(track, ref, 1);
+        if (memcmp(ref, disk->tracks[track].data, bench_raw_size(track))) {
+            printf("track %d converts differently\n", track + 1);
+            bench_errors++;
+        }
+    }
+    free(ref);
+
+    printf("%-12s %-8s %10.1fus %10.1fus %7.1fx\n", disk->name, "convert",
+           t_ref * 1e6 / rounds / BENCH_TRACKS, t_new * 1e6 / rounds / BENCH_TRACKS, t_ref / t_new);
+
+    /* The same tracks a few bits later.  */
+    for (track = 0; track < BENCH_TRACKS; track++) {
+        const disk_track_t *src = &disk->tracks[track];
+        uint8_t *dst = rotated->tracks[track].data;
+
+        shift = track % 7 + 1;
+        for (i = 0; i < src->size; i++) {
+            dst[i] = (uint8_t)((src->data[(i + src->size - 1) % src->size] << (8 - shift))
+                               | (src->data[i] >> shift));
+        }
+    }
+}
+
+static int bench_load_g64(bench_disk_t *disk, const char *name)
+{
+    FILE *f;
+    uint8_t *image;
+    long size;
+    uint32_t offset;
+    int i, num_half_tracks, track_size;
+
+    f = fopen(name, "rb");
+    if (f == NULL) {
+        perror(name);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    image = malloc(size > 0 ? size : 1);
+    if (size < 12 || fread(image, 1, size, f) != (size_t)size
+        || memcmp(image, "GCR-1541", 8)) {
+        fprintf(stderr, "%s: not a G64 image\n", name);
+        fclose(f);
+        free(image);
+        return -1;
+    }
+    fclose(f);
+
+    disk->name = name;
+    disk->num_tracks = 0;
+    num_half_tracks = image[9];
+    for (i = 0; i < num_half_tracks && i < MAX_GCR_TRACKS && 12 + i * 4 + 4 <= size; i++) {
+        offset = image[12 + i * 4] | (image[13 + i * 4] << 8)
+                 | (image[14 + i * 4] << 16) | ((uint32_t)image[15 + i * 4] << 24);
+        if (offset == 0 || offset + 2 > (uint32_t)size) {
+            continue;
+        }
+        track_size = image[offset] | (image[offset + 1] << 8);
+        if (track_size == 0 || offset + 2 + track_size > (uint32_t)size) {
+            continue;
+        }
+        disk->tracks[disk->num_tracks].size = track_size;
+        disk->tracks[disk->num_tracks].data = malloc(track_size);
+        memcpy(disk->tracks[disk->num_tracks].data, image + offset + 2, track_size);
+        gcr_clear_index(&disk->tracks[disk->num_tracks]);
+        disk->num_tracks++;
+    }
+    free(image);
+
+    return 0;
+}
+
+static void bench_free_disk(bench_disk_t *disk)
+{
+    int track;
+
+    for (track = 0; track < disk->num_tracks; track++) {
+        free(disk->tracks[track].data);
+    }
+}
+
+/* Read sectors 0 to 21 of every track, so that the last is missing on
+   every track.  */
+static void bench_read(bench_disk_t *disk, int rounds)
+{
+    static uint8_t data_new[22][256], data_ref[22][256];
+    fdc_err_t rf_new[22], rf_ref[22];
+    double t_new, t_ref;
+    int track, sector, r;
+
+    t_ref = t_new = 0.0;
+    for (track = 0; track < disk->num_tracks; track++) {
+        disk_track_t *raw = &disk->tracks[track];
+        double t;
+
+        t = now();
+        for (r = 0; r < rounds; r++) {
+            for (sector = 0; sector < 22; sector++) {
+                rf_ref[sector] = ref_read_sector(raw, data_ref[sector], (uint8_t)sector);
+            }
+        }
+        t_ref += now() - t;
+
+        t = now();
+        for (r = 0; r < rounds; r++) {
+            for (sector = 0; sector < 22; sector++) {
+                rf_new[sector] = gcr_read_sector(raw, data_new[sector], (uint8_t)sector);
+            }
+        }
+        t_new += now() - t;
+
+        for (sector = 0; sector < 22; sector++) {
+            if (rf_new[sector] != rf_ref[sector]
+                || (rf_ref[sector] == CBMDOS_FDC_ERR_OK
+                    && memcmp(data_new[sector], data_ref[sector], 256))) {
+                printf("%s: track %d sector %d reads differently (%d, was %d)\n",
+                       disk->name, track + 1, sector, (int)rf_new[sector], (int)rf_ref[sector]);
+                bench_errors++;
+            }
+        }
+    }
+
+    printf("%-12s %-8s %10.1fus %10.1fus %7.1fx\n", disk->name, "read",
+           t_ref * 1e6 / rounds / disk->num_tracks, t_new * 1e6 / rounds / disk->num_tracks,
+           t_ref / t_new);
+}
+
+/* Write every sector of every track in place and read it back.  */
+static void bench_write(const bench_disk_t *disk, int rounds)
+{
+    uint8_t *raw_new, *raw_ref;
+    uint8_t data[256], back[256], back_ref[256];
+    disk_track_t track_new, track_ref;
+    fdc_err_t rf_new, rf_ref;
+    double t_new, t_ref, t;
+    int track, sector, r, i;
+
+    raw_new = malloc(NUM_MAX_MEM_BYTES_TRACK);
+    raw_ref = malloc(NUM_MAX_MEM_BYTES_TRACK);
+
+    t_ref = t_new = 0.0;
+    for (track = 0; track < disk->num_tracks; track++) {
+        track_new.data = raw_new;
+        track_ref.data = raw_ref;
+        track_new.size = track_ref.size = disk->tracks[track].size;
+        memcpy(raw_new, disk->tracks[track].data, track_new.size);
+        memcpy(raw_ref, disk->tracks[track].data, track_ref.size);
+        gcr_clear_index(&track_new);
+
+        for (r = 0; r < rounds; r++) {
+            for (sector = 0; sector < 21; sector++) {
+                for (i = 0; i < 256; i++) {
+                    data[i] = (uint8_t)(track + sector * 7 + r * 13 + i);
+                }
+
+                t = now();
+                rf_ref = ref_write_sector(&track_ref, data, (uint8_t)sector);
+                t_ref += now() - t;
+
+                t = now();
+                rf_new = gcr_write_sector(&track_new, data, (uint8_t)sector);
+                t_new += now() - t;
+
+                if (rf_new != rf_ref) {
+                    printf("%s: track %d sector %d writes differently (%d, was %d)\n",
+                           disk->name, track + 1, sector, (int)rf_new, (int)rf_ref);
+                    bench_errors++;
+                } else if (rf_new == CBMDOS_FDC_ERR_OK
+                           && (gcr_read_sector(&track_new, back, (uint8_t)sector)
+                               != ref_read_sector(&track_ref, back_ref, (uint8_t)sector)
+                               || memcmp(back, back_ref, 256))) {
+                    /* Writing may hit the next header on odd tracks,
+                       so this compares with the bitwise version too.  */
+                    printf("%s: track %d sector %d reads back differently\n",
+                           disk->name, track + 1, sector);
+                    bench_errors++;
+                }
+            }
+        }
+        if (memcmp(raw_new, raw_ref, track_new.size)) {
+            printf("%s: track %d differs after writing\n", disk->name, track + 1);
+            bench_errors++;
+        }
+    }
+
+    free(raw_new);
+    free(raw_ref);
+
+    printf("%-12s %-8s %10.1fus %10.1fus %7.1fx\n", disk->name, "write",
+           t_ref * 1e6 / rounds / disk->num_tracks, t_new * 1e6 / rounds / disk->num_tracks,
+           t_ref / t_new);
+}
+
+/* Overwrite the tracks of `disk', which have been read, with those of
+   `other' without clearing their index, as a drive writing to a track
+   does, and check that reading them finds the moved headers.  */
+static void bench_stale(bench_disk_t *disk, const bench_disk_t *other)
+{
+    uint8_t data_new[256], data_ref[256];
+    fdc_err_t rf_new, rf_ref;
+    int track, sector;
+
+    for (track = 0; track < disk->num_tracks; track++) {
+        disk_track_t *raw = &disk->tracks[track];
+
+        memcpy(raw->data, other->tracks[track].data, raw->size);
+        for (sector = 0; sector < 22; sector++) {
+            rf_ref = ref_read_sector(raw, data_ref, (uint8_t)sector);
+            rf_new = gcr_read_sector(raw, data_new, (uint8_t)sector);
+            if (rf_new != rf_ref
+                || (rf_ref == CBMDOS_FDC_ERR_OK && memcmp(data_new, data_ref, 256))) {
+                printf("%s: track %d sector %d reads differently after changing"
+                       " the track (%d, was %d)\n",
+                       disk->name, track + 1, sector, (int)rf_new, (int)rf_ref);
+                bench_errors++;
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static bench_disk_t disk, rotated, image;
+    int rounds = argc > 1 ? atoi(argv[1]) : 20;
+    int i;
+
+    if (rounds < 1) {
+        fprintf(stderr, "Usage: %s [rounds [image.g64 ...]]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d rounds, time per track\n", rounds);
+    printf("%-12s %-8s %12s %12s %8s\n", "", "", "bitwise", "tables", "speedup");
+
+    bench_make_disk(&disk, &rotated, rounds);
+    bench_read(&disk, rounds);
+    bench_read(&rotated, rounds);
+    bench_write(&disk, rounds);
+    bench_write(&rotated, rounds);
+    bench_stale(&disk, &rotated);
+    bench_free_disk(&disk);
+    bench_free_disk(&rotated);
+
+    for (i = 2; i < argc; i++) {
+        if (bench_load_g64(&image, argv[i]) < 0) {
+            bench_errors++;
+            continue;
+        }
+        bench_read(&image, rounds);
+        bench_write(&image, rounds);
+        bench_free_disk(&image);
+    }
+
+    if (bench_errors) {
+        printf("%d differences from the bitwise version\n", bench_errors);
+        return 1;
+    }
+    printf("no differences\n");
+    return 0;
+}
@@ -48,65 +48,77 @@
 #include "cbmdos.h"
 #include "diskimage.h"
 
-static const uint8_t GCR_conv_data[16] =
-{
-    0x0a, 0x0b, 0x12, 0x13,
-    0x0e, 0x0f, 0x16, 0x17,
-    0x09, 0x19, 0x1a, 0x1b,
-    0x0d, 0x1d, 0x1e, 0x15
+/* The 5 bit GCR code of each nybble:
+
+     0 0x0a   1 0x0b   2 0x12   3 0x13   4 0x0e   5 0x0f   6 0x16   7 0x17
+     8 0x09   9 0x19   a 0x1a   b 0x1b   c 0x0d   d 0x1d   e 0x1e   f 0x15
+
+   packed 5 bits per nybble, and the nybble of each code (0 for codes that
+   are not valid) packed 4 bits per code, for building the tables below at
+   compile time.  */
+#define GCR_CODE(n) \
+    ((unsigned int)((((n) < 8 ? 0xbd9ee9c96aULL : 0xafbaddeb29ULL) >> (5 * ((n) & 7))) & 0x1f))
+#define GCR_NYBBLE(c) \
+    ((unsigned int)((((c) < 16 ? 0x54c0108000000000ULL : 0x0ed0ba9076f03200ULL) >> (4 * ((c) & 15))) & 0x0f))
+
+/* The 10 bit code of each byte.  */
+#define GCR_ENC(b)      ((GCR_CODE((b) >> 4) << 5) | GCR_CODE((b) & 15))
+#define GCR_ENC4(b)     GCR_ENC(b), GCR_ENC((b) + 1), GCR_ENC((b) + 2), GCR_ENC((b) + 3)
+#define GCR_ENC16(b)    GCR_ENC4(b), GCR_ENC4((b) + 4), GCR_ENC4((b) + 8), GCR_ENC4((b) + 12)
+#define GCR_ENC64(b)    GCR_ENC16(b), GCR_ENC16((b) + 16), GCR_ENC16((b) + 32), GCR_ENC16((b) + 48)
+
+static const uint16_t GCR_encode[256] = {
+    GCR_ENC64(0), GCR_ENC64(64), GCR_ENC64(128), GCR_ENC64(192)
 };
 
-static const uint8_t From_GCR_conv_data[32] =
-{
-    0, 0, 0, 0, 0, 0, 0, 0,
-    0, 8, 0, 1, 0, 12, 4, 5,
-    0, 0, 2, 3, 0, 15, 6, 7,
-    0, 9, 10, 11, 0, 13, 14, 0
+/* The byte of each 10 bit code.  */
+#define GCR_DEC(c)      ((GCR_NYBBLE((c) >> 5) << 4) | GCR_NYBBLE((c) & 31))
+#define GCR_DEC4(c)     GCR_DEC(c), GCR_DEC((c) + 1), GCR_DEC((c) + 2), GCR_DEC((c) + 3)
+#define GCR_DEC16(c)    GCR_DEC4(c), GCR_DEC4((c) + 4), GCR_DEC4((c) + 8), GCR_DEC4((c) + 12)
+#define GCR_DEC64(c)    GCR_DEC16(c), GCR_DEC16((c) + 16), GCR_DEC16((c) + 32), GCR_DEC16((c) + 48)
+#define GCR_DEC256(c)   GCR_DEC64(c), GCR_DEC64((c) + 64), GCR_DEC64((c) + 128), GCR_DEC64((c) + 192)
+
+static const uint8_t GCR_decode[1024] = {
+    GCR_DEC256(0), GCR_DEC256(256), GCR_DEC256(512), GCR_DEC256(768)
 };
 
+/* Leading and trailing 1 bits of each byte, for finding SYNCs.  */
+#define GCR_LEAD(b)     ((b) < 0x80 ? 0 : (b) < 0xc0 ? 1 : (b) < 0xe0 ? 2 : (b) < 0xf0 ? 3 \
+                         : (b) < 0xf8 ? 4 : (b) < 0xfc ? 5 : (b) < 0xfe ? 6 : (b) < 0xff ? 7 : 8)
+#define GCR_TRAIL(b)    (GCR_LEAD(((b) & 1) << 7 | ((b) & 2) << 5 | ((b) & 4) << 3 | ((b) & 8) << 1 \
+                                  | ((b) & 16) >> 1 | ((b) & 32) >> 3 | ((b) & 64) >> 5 | ((b) & 128) >> 7))
+#define GCR_RUNS(b)     ((GCR_LEAD(b) << 4) | GCR_TRAIL(b))
+#define GCR_RUNS4(b)    GCR_RUNS(b), GCR_RUNS((b) + 1), GCR_RUNS((b) + 2), GCR_RUNS((b) + 3)
+#define GCR_RUNS16(b)   GCR_RUNS4(b), GCR_RUNS4((b) + 4), GCR_RUNS4((b) + 8), GCR_RUNS4((b) + 12)
+#define GCR_RUNS64(b)   GCR_RUNS16(b), GCR_RUNS16((b) + 16), GCR_RUNS16((b) + 32), GCR_RUNS16((b) + 48)
+
+static const uint8_t GCR_runs[256] = {
+    GCR_RUNS64(0), GCR_RUNS64(64), GCR_RUNS64(128), GCR_RUNS64(192)
+};
 
 static void gcr_convert_4bytes_to_GCR(const uint8_t *source, uint8_t *dest)
 {
-    int i;
-    register unsigned int tdest = 0;    /* at least 16 bits for overflow shifting */
-
-    for (i = 2; i < 10; i += 2, source++, dest++)
-    {
-        tdest <<= 5;  /* make room for the upper nybble */
-        tdest |= GCR_conv_data[(*source) >> 4];
-
-        tdest <<= 5;  /* make room for the lower nybble */
-        tdest |= GCR_conv_data[(*source) & 0x0f];
-
-        *dest = (uint8_t)(tdest >> i);
-    }
-
-    *dest = (uint8_t)tdest;
+    uint64_t tdest;
+
+    tdest = ((uint64_t)GCR_encode[source[0]] << 30)
+            | ((uint64_t)GCR_encode[source[1]] << 20)
+            | ((uint64_t)GCR_encode[source[2]] << 10)
+            | GCR_encode[source[3]];
+
+    dest[0] = (uint8_t)(tdest >> 32);
+    dest[1] = (uint8_t)(tdest >> 24);
+    dest[2] = (uint8_t)(tdest >> 16);
+    dest[3] = (uint8_t)(tdest >> 8);
+    dest[4] = (uint8_t)tdest;
 }
 
-static void gcr_convert_GCR_to_4bytes(const uint8_t *source, uint8_t *dest)
+/* Decode the 40 bits of GCR data in the low bits of `source'.  */
+static void gcr_convert_GCR_to_4bytes(uint64_t source, uint8_t *dest)
 {
-    int i;
-    /* at least 24 bits for shifting into bits 16...20 */
-    register uint32_t tdest = *source;
-
-    tdest <<= 13;
-
-    for (i = 5; i < 13; i += 2, dest++)
-    {
-        source++;
-        tdest |= ((uint32_t)(*source)) << i;
-
-        /*  "tdest >> 16" could be optimized to a word
-         *  aligned access, hopefully the compiler does
-         *  this for us (in a portable way)
-         */
-        *dest = From_GCR_conv_data[(tdest >> 16) & 0x1f] << 4;
-        tdest <<= 5;
-
-        *dest |= From_GCR_conv_data[(tdest >> 16) & 0x1f];
-        tdest <<= 5;
-    }
+    dest[0] = GCR_decode[(source >> 30) & 0x3ff];
+    dest[1] = GCR_decode[(source >> 20) & 0x3ff];
+    dest[2] = GCR_decode[(source >> 10) & 0x3ff];
+    dest[3] = GCR_decode[source & 0x3ff];
 }
 
 void gcr_convert_sector_to_GCR(const uint8_t *buffer, uint8_t *data, const gcr_header_t *header,
@@ -167,100 +179,196 @@ void gcr_convert_sector_to_GCR(const uint8_t *buffer, uint8_t *data, const gcr_h
     gcr_convert_4bytes_to_GCR(buf, data);
 }
 
+/* Return the position of the first bit after a SYNC (10 or more 1 bits)
+   within `s' bits from `p', not counting the 1 bits before `p'.  Whole
+   bytes are handled with `GCR_runs', and 8 bytes at a time are skipped
+   when they hold no nybble of 1 bits, as every SYNC covers one.  */
 static int gcr_find_sync(const disk_track_t *raw, int p, int s)
 {
-    unsigned int w;
-    int b;
+    int ones = 0;
+    int i, lead;
+    uint64_t w;
 
     if (!raw->data || !raw->size) {
         return -CBMDOS_FDC_ERR_SYNC;
     }
 
-    w = 0;
-    b = raw->data[p >> 3] << (p & 7);
-    while (s--) {
-        if (b & 0x80) {
-            w = (w << 1) | 1;
-        } else {
-            if (~w & 0x3ff) {
-                w <<= 1;
-            } else {
+    while (s > 0) {
+        if ((p & 7) || s < 8) {
+            if (raw->data[p >> 3] & (0x80 >> (p & 7))) {
+                ones++;
+            } else if (ones >= 10) {
                 return p;
+            } else {
+                ones = 0;
             }
-        }
-        if (~p & 7) {
-            p++;
-            b <<= 1;
-        } else {
+            s--;
             p++;
             if (p >= raw->size * 8) {
                 p = 0;
             }
-            b = raw->data[p >> 3];
+            continue;
+        }
+
+        i = p >> 3;
+
+        /* With fewer than 7 1 bits in front, a SYNC ending in these bytes
+           would have to cover a nybble of them.  */
+        while (ones < 7 && s >= 64 && i + 8 <= raw->size) {
+            memcpy(&w, raw->data + i, 8);
+            w &= w >> 1;
+            w &= w >> 2;
+            if (w & 0x1111111111111111ULL) {
+                break;
+            }
+            ones = GCR_runs[raw->data[i + 7]] & 15;
+            i += 8;
+            s -= 64;
+        }
+        if (i >= raw->size) {
+            i = 0;
+        }
+        p = i << 3;
+        if (s < 8) {
+            continue;
+        }
+
+        if (raw->data[i] == 0xff) {
+            ones += 8;
+        } else {
+            lead = GCR_runs[raw->data[i]] >> 4;
+            if (ones + lead >= 10) {
+                return p + lead;
+            }
+            /* 1 bits within the byte are too few for a SYNC.  */
+            ones = GCR_runs[raw->data[i]] & 15;
+        }
+        s -= 8;
+        i++;
+        if (i >= raw->size) {
+            i = 0;
         }
+        p = i << 3;
     }
     return -CBMDOS_FDC_ERR_SYNC;
 }
 
 static void gcr_decode_block(const disk_track_t *raw, int p, uint8_t *buf, int num)
 {
-    int shift, i, j;
-    uint8_t gcr[5], b;
-    uint8_t *offset, *end = raw->data + raw->size;
+    int i, bits, offset;
+    uint64_t gcr;
 
-    shift = p & 7;
-    offset = raw->data + (p >> 3);
+    offset = p >> 3;
+    gcr = raw->data[offset] & (0xff >> (p & 7));
+    bits = 8 - (p & 7);
 
-    b = offset[0] << shift;
     for (i = 0; i < num; i++, buf += 4) {
-        /* get 5 bytes of gcr data */
-        for (j = 0; j < 5; j++) {
+        /* get 5 bytes of gcr data; bits above them are ignored */
+        while (bits < 40) {
             offset++;
-            if (offset >= end) {
-                offset = raw->data;
-            }
-            if (shift) {
-                gcr[j] = b | ((offset[0] << shift) >> 8);
-                b = offset[0] << shift;
-            } else {
-                gcr[j] = b;
-                b = offset[0];
+            if (offset >= raw->size) {
+                offset = 0;
             }
+            gcr = (gcr << 8) | raw->data[offset];
+            bits += 8;
         }
-        gcr_convert_GCR_to_4bytes(gcr, buf);
+        bits -= 40;
+        gcr_convert_GCR_to_4bytes(gcr >> bits, buf);
     }
 }
 
-static int gcr_find_sector_header(const disk_track_t *raw, uint8_t sector)
+/* Go round the track once, from SYNC to SYNC, and return the position of
+   the first header of `sector'.  If `index' is not NULL, the first header
+   of each sector it has room for is recorded in it as well.  A SYNC
+   running over the start of the track may only be found the second time
+   round, so the bits gone are counted to stop after one revolution.  */
+static int gcr_scan_track(const disk_track_t *raw, uint8_t sector,
+                          gcr_index_t *index)
 {
     uint8_t header[4];
-    int p, p2;
+    int i, sync, p, next, bits, found;
+
+    sync = gcr_find_sync(raw, 0, raw->size * 8);
+    if (index != NULL) {
+        index->valid = 1;
+        index->sync = sync;
+        for (i = 0; i < GCR_INDEX_SECTORS; i++) {
+            index->header[i] = -1;
+        }
+    }
+    if (sync < 0) {
+        return sync;
+    }
+
+    found = -CBMDOS_FDC_ERR_HEADER;
+    p = sync;
+    bits = 0;
+    for (;;) {
+        gcr_decode_block(raw, p, header, 1);
 
-    p = 0;
-    p2 = -CBMDOS_FDC_ERR_SYNC;
-    for (;; ) {
-        p = gcr_find_sync(raw, p, raw->size * 8);
-        if (p2 == p) {
+        /* Track, checksum or ID's are not checked here */
+        if (header[0] == 0x08) {
+            DBG(("GCR: bit: %d hdr: %02x %02x sec:%02d trk:%02d", p, header[0], header[1], header[2], header[3]));
+            if (header[2] == sector && found < 0) {
+                found = p;
+                if (index == NULL) {
+                    break;
+                }
+            }
+            if (index != NULL && header[2] < GCR_INDEX_SECTORS
+                && index->header[header[2]] < 0) {
+                index->header[header[2]] = p;
+            }
+        }
+
+        next = gcr_find_sync(raw, p, raw->size * 8);
+        if (next < 0 || next == sync) {
             break;
         }
-        if (p2 < 0) {
-            p2 = p;
+        bits += (next > p) ? next - p : next - p + raw->size * 8;
+        if (bits >= raw->size * 8) {
+            break;
         }
-        gcr_decode_block(raw, p, header, 1);
+        p = next;
+    }
 
-        if (header[0] == 0x08 && header[2] == sector) {
-            /* Track, checksum or ID's are not checked here */
-            DBG(("GCR: shift: %d hdr: %02x %02x sec:%02d trk:%02d", shift, header[0], header[1], header[2], header[3]));
-            return p;
-        }
+    return found;
+}
+
+static int gcr_find_sector_header(disk_track_t *raw, uint8_t sector)
+{
+    uint8_t header[4];
+    int p;
+
+    if (!raw->data || !raw->size) {
+        return -CBMDOS_FDC_ERR_SYNC;
+    }
+
+    if (sector >= GCR_INDEX_SECTORS) {
+        return gcr_scan_track(raw, sector, NULL);
+    }
+
+    if (!raw->index.valid) {
+        return gcr_scan_track(raw, sector, &raw->index);
+    }
+    if (raw->index.sync < 0) {
+        return raw->index.sync;
     }
-    if (p2 < 0) {
-        return p2;
+    p = raw->index.header[sector];
+    if (p < 0) {
+        return -CBMDOS_FDC_ERR_HEADER;
+    }
+
+    /* Drives write to their tracks directly and only clear the index when
+       the track is written back, so check the header is still there.  */
+    gcr_decode_block(raw, p, header, 1);
+    if (header[0] != 0x08 || header[2] != sector) {
+        return gcr_scan_track(raw, sector, &raw->index);
     }
-    return -CBMDOS_FDC_ERR_HEADER;
+    return p;
 }
 
-fdc_err_t gcr_read_sector(const disk_track_t *raw, uint8_t *data, uint8_t sector)
+fdc_err_t gcr_read_sector(disk_track_t *raw, uint8_t *data, uint8_t sector)
 {
     uint8_t buffer[260];
     uint8_t b;
@@ -342,9 +450,16 @@ fdc_err_t gcr_write_sector(disk_track_t *raw, const uint8_t *data, uint8_t secto
     }
     offset[0] = b | (offset[0] & (0xff >> shift));
 
+    gcr_clear_index(raw);
+
     return CBMDOS_FDC_ERR_OK;
 }
 
+void gcr_clear_index(disk_track_t *raw)
+{
+    raw->index.valid = 0;
+}
+
 gcr_t *gcr_create_image(void)
 {
     return (gcr_t *)lib_calloc(1, sizeof(gcr_t));
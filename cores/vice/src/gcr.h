@@ -48,9 +48,31 @@
    nor the gaps */
 #define SECTOR_GCR_SIZE_WITH_HEADER 335
 
+/* Number of sectors of a track that gcr_read_sector() keeps the header
+   position of; headers of higher sectors are searched for every time.  */
+#define GCR_INDEX_SECTORS 32
+
+/* Sector headers found in a track, so that reading the sectors of a track
+   one by one scans it only once.  */
+typedef struct gcr_index_s {
+    /* Nonzero if the index below has been built from the track data.  */
+    int valid;
+
+    /* First SYNC of the track, or -CBMDOS_FDC_ERR_SYNC.  */
+    int sync;
+
+    /* Bit position of the first header of each sector, or -1.  */
+    int header[GCR_INDEX_SECTORS];
+} gcr_index_t;
+
 typedef struct disk_track_s {
     uint8_t *data;
     int size;
+
+    /* Built by gcr_read_sector() and gcr_write_sector(); whoever changes
+       or replaces `data' other than through gcr_write_sector() must call
+       gcr_clear_index().  */
+    gcr_index_t index;
 } disk_track_t;
 
 typedef struct gcr_s {
@@ -64,8 +86,9 @@ typedef struct gcr_header_s {
 
 extern void gcr_convert_sector_to_GCR(const uint8_t *buffer, uint8_t *ptr, const gcr_header_t *header,
                                       int gap, int sync, enum fdc_err_e error_code);
-extern enum fdc_err_e gcr_read_sector(const disk_track_t *raw, uint8_t *data, uint8_t sector);
+extern enum fdc_err_e gcr_read_sector(disk_track_t *raw, uint8_t *data, uint8_t sector);
 extern enum fdc_err_e gcr_write_sector(disk_track_t *raw, const uint8_t *data, uint8_t sector);
+extern void gcr_clear_index(disk_track_t *raw);
 
 extern gcr_t *gcr_create_image(void);
 extern void gcr_destroy_image(gcr_t *gcr);
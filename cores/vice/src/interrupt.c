@@ -167,6 +167,68 @@ void interrupt_cpu_status_time_warp(interrupt_cpu_status_t *cs,
     }
 }
 
+void interrupt_cpu_status_save_state(const interrupt_cpu_status_t *cs,
+                                     interrupt_cpu_state_t *state)
+{
+    if (state->num_ints != cs->num_ints) {
+        lib_free(state->pending_int);
+        state->pending_int = lib_malloc(cs->num_ints * sizeof(*(state->pending_int)));
+        state->num_ints = cs->num_ints;
+    }
+    if (cs->num_ints > 0) {
+        memcpy(state->pending_int, cs->pending_int,
+               cs->num_ints * sizeof(*(state->pending_int)));
+    }
+
+    state->nirq = cs->nirq;
+    state->irq_clk = cs->irq_clk;
+    state->nnmi = cs->nnmi;
+    state->nmi_clk = cs->nmi_clk;
+    state->irq_delay_cycles = cs->irq_delay_cycles;
+    state->nmi_delay_cycles = cs->nmi_delay_cycles;
+    state->reset = cs->reset;
+    state->num_last_stolen_cycles = cs->num_last_stolen_cycles;
+    state->last_stolen_cycles_clk = cs->last_stolen_cycles_clk;
+    state->irq_pending_clk = cs->irq_pending_clk;
+    state->global_pending_int = cs->global_pending_int;
+}
+
+/* Pending traps and the monitor are left alone, they are not part of the
+   machine state.  */
+int interrupt_cpu_status_restore_state(interrupt_cpu_status_t *cs,
+                                       const interrupt_cpu_state_t *state)
+{
+    if (state->num_ints != cs->num_ints) {
+        return -1;
+    }
+    if (cs->num_ints > 0) {
+        memcpy(cs->pending_int, state->pending_int,
+               cs->num_ints * sizeof(*(cs->pending_int)));
+    }
+
+    cs->nirq = state->nirq;
+    cs->irq_clk = state->irq_clk;
+    cs->nnmi = state->nnmi;
+    cs->nmi_clk = state->nmi_clk;
+    cs->irq_delay_cycles = state->irq_delay_cycles;
+    cs->nmi_delay_cycles = state->nmi_delay_cycles;
+    cs->reset = state->reset;
+    cs->num_last_stolen_cycles = state->num_last_stolen_cycles;
+    cs->last_stolen_cycles_clk = state->last_stolen_cycles_clk;
+    cs->irq_pending_clk = state->irq_pending_clk;
+    cs->global_pending_int = (state->global_pending_int & (unsigned int)~(IK_TRAP | IK_MONITOR))
+                             | (cs->global_pending_int & (IK_TRAP | IK_MONITOR));
+
+    return 0;
+}
+
+void interrupt_cpu_state_free(interrupt_cpu_state_t *state)
+{
+    lib_free(state->pending_int);
+    state->pending_int = NULL;
+    state->num_ints = 0;
+}
+
 void interrupt_log_wrong_nirq(void)
 {
     log_error(LOG_DEFAULT, "interrupt_set_irq(): wrong nirq!");
@@ -119,6 +119,26 @@ struct interrupt_cpu_status_s {
 };
 typedef struct interrupt_cpu_status_s interrupt_cpu_status_t;
 
+/* Interrupt lines of a CPU, saved with the machine state by netplay
+   rollback: a snapshot only has the summary of them, and the modules
+   raise their lines again when it is read.  */
+struct interrupt_cpu_state_s {
+    unsigned int num_ints;
+    unsigned int *pending_int;
+    int nirq;
+    CLOCK irq_clk;
+    int nnmi;
+    CLOCK nmi_clk;
+    unsigned int irq_delay_cycles;
+    unsigned int nmi_delay_cycles;
+    int reset;
+    int num_last_stolen_cycles;
+    CLOCK last_stolen_cycles_clk;
+    CLOCK irq_pending_clk;
+    unsigned int global_pending_int;
+};
+typedef struct interrupt_cpu_state_s interrupt_cpu_state_t;
+
 /* ------------------------------------------------------------------------- */
 
 extern void interrupt_log_wrong_nirq(void);
@@ -292,6 +312,12 @@ extern void interrupt_cpu_status_time_warp(interrupt_cpu_status_t *cs,
                                            CLOCK warp_amount,
                                            int warp_direction);
 
+extern void interrupt_cpu_status_save_state(const interrupt_cpu_status_t *cs,
+                                            interrupt_cpu_state_t *state);
+extern int interrupt_cpu_status_restore_state(interrupt_cpu_status_t *cs,
+                                              const interrupt_cpu_state_t *state);
+extern void interrupt_cpu_state_free(interrupt_cpu_state_t *state);
+
 extern int interrupt_read_snapshot(interrupt_cpu_status_t *cs,
                                    struct snapshot_module_s *m);
 extern int interrupt_read_new_snapshot(interrupt_cpu_status_t *cs,
@@ -28,6 +28,8 @@
 #ifndef VICE_MACHINE_H
 #define VICE_MACHINE_H
 
+#include <stddef.h>
+
 #include "types.h"
 
 /* The following stuff must be defined once per every emulated CBM machine.  */
@@ -142,6 +144,13 @@ extern int machine_write_snapshot(const char *name, int save_roms,
 /* Read a snapshot.  */
 extern int machine_read_snapshot(const char *name, int even_mode);
 
+/* Write a snapshot into / read a snapshot from memory (see
+   `snapshot_create_memory()').  */
+struct snapshot_memory_s;
+extern int machine_write_snapshot_memory(struct snapshot_memory_s *mem, int save_roms,
+                                         int save_disks, int event_mode);
+extern int machine_read_snapshot_memory(const uint8_t *data, size_t size, int event_mode);
+
 /* handle pending interrupts - needed by libsid.a.  */
 extern void machine_handle_pending_alarms(int num_write_cycles);
 
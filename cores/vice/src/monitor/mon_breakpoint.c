@@ -58,6 +58,11 @@ static checkpoint_list_t *breakpoints[NUM_MEMSPACES];
 static checkpoint_list_t *watchpoints_load[NUM_MEMSPACES];
 static checkpoint_list_t *watchpoints_store[NUM_MEMSPACES];
 
+/* Address maps of the lists above, see mon_breakpoint.h.  */
+uint8_t *mon_breakpoints_map[NUM_MEMSPACES];
+uint8_t *mon_watchpoints_load_map[NUM_MEMSPACES];
+uint8_t *mon_watchpoints_store_map[NUM_MEMSPACES];
+
 
 void mon_breakpoint_init(void)
 {
@@ -198,8 +203,62 @@ mon_checkpoint_t *mon_breakpoint_find_checkpoint(int brknum)
     return NULL;
 }
 
+/* Mark the locations from `start' to `end' (start <= end), folded into
+   64k.  */
+static void map_set_range(uint8_t *map, unsigned int start, unsigned int end)
+{
+    unsigned int loc;
+
+    if (end - start >= 0xffff) {
+        memset(map, 0xff, MON_BREAKPOINT_MAP_SIZE);
+        return;
+    }
+    for (loc = start; loc <= end; loc++) {
+        map[(loc & 0xffff) >> 3] |= 1 << (loc & 7);
+    }
+}
+
+/* Rebuild the map of a checkpoint list, allocating it while the list has
+   entries and freeing it when it gets empty.  */
+static void update_checkpoint_map(uint8_t **map, checkpoint_list_t *head)
+{
+    checkpoint_list_t *ptr;
+    unsigned int start, end;
+
+    if (head == NULL) {
+        lib_free(*map);
+        *map = NULL;
+        return;
+    }
+
+    if (*map == NULL) {
+        *map = lib_malloc(MON_BREAKPOINT_MAP_SIZE);
+    }
+    memset(*map, 0, MON_BREAKPOINT_MAP_SIZE);
+
+    for (ptr = head; ptr; ptr = ptr->next) {
+        start = addr_location(ptr->checkpt->start_addr);
+        if (!mon_is_valid_addr(ptr->checkpt->end_addr)) {
+            map_set_range(*map, start, start);
+            continue;
+        }
+        end = addr_location(ptr->checkpt->end_addr);
+        if (end < start) {
+            /* wraps around, as in mon_is_in_range() */
+            map_set_range(*map, start, addr_mask(0xffffffff));
+            map_set_range(*map, 0, end);
+        } else {
+            map_set_range(*map, start, end);
+        }
+    }
+}
+
 static void update_checkpoint_state(MEMSPACE mem)
 {
+    update_checkpoint_map(&mon_breakpoints_map[mem], breakpoints[mem]);
+    update_checkpoint_map(&mon_watchpoints_load_map[mem], watchpoints_load[mem]);
+    update_checkpoint_map(&mon_watchpoints_store_map[mem], watchpoints_store[mem]);
+
     /* calls mem_toggle_watchpoints() */
     if (watchpoints_load[mem] != NULL || 
         watchpoints_store[mem] != NULL) {
@@ -496,6 +555,7 @@ bool mon_breakpoint_check_checkpoint(MEMSPACE mem, unsigned int addr, unsigned i
     checkpoint_list_t *ptr;
     mon_checkpoint_t *cp;
     checkpoint_list_t *list;
+    const uint8_t *map;
     monitor_cpu_type_t *monitor_cpu;
     bool must_stop = FALSE;
     MON_ADDR instpc;
@@ -503,8 +563,24 @@ bool mon_breakpoint_check_checkpoint(MEMSPACE mem, unsigned int addr, unsigned i
     char is_loadstore = 0;
     const char *op_str;
     const char *action_str;
-    int monbank = mon_interfaces[mem]->current_bank;
+    int monbank;
+
+    switch (op) {
+        case e_load:
+            map = mon_watchpoints_load_map[mem];
+            break;
+        case e_store:
+            map = mon_watchpoints_store_map[mem];
+            break;
+        default: /* e_exec */
+            map = mon_breakpoints_map[mem];
+            break;
+    }
+    if (!mon_breakpoint_map_test(map, addr)) {
+        return FALSE;
+    }
 
+    monbank = mon_interfaces[mem]->current_bank;
     monitor_cpu = monitor_cpu_for_memspace[mem];
     instpc = new_addr(mem, (monitor_cpu->mon_register_get_val)(mem, e_PC));
     loadstorepc = new_addr(mem, lastpc);
@@ -729,6 +805,7 @@ void mon_breakpoint_unset(MON_ADDR address)
     if (ptr) {
         /* there's a breakpoint, so remove it */
         remove_checkpoint_from_list( &breakpoints[mem], ptr->checkpt );
+        update_checkpoint_state(mem);
     }
 }
 
@@ -52,6 +52,21 @@ struct mon_checkpoint_s {
 };
 typedef struct mon_checkpoint_s mon_checkpoint_t;
 
+/* For each memspace, one bit for every address a breakpoint, load or store
+   watchpoint covers (NULL while there is none), so that accesses nothing
+   watches cost a bit test.  24 bit addresses share the bits of their low
+   16 bits.  */
+#define MON_BREAKPOINT_MAP_SIZE (0x10000 / 8)
+
+extern uint8_t *mon_breakpoints_map[NUM_MEMSPACES];
+extern uint8_t *mon_watchpoints_load_map[NUM_MEMSPACES];
+extern uint8_t *mon_watchpoints_store_map[NUM_MEMSPACES];
+
+static inline bool mon_breakpoint_map_test(const uint8_t *map, unsigned int addr)
+{
+    return map != NULL && (map[(addr & 0xffff) >> 3] & (1 << (addr & 7)));
+}
+
 extern void mon_breakpoint_init(void);
 
 extern void mon_breakpoint_switch_checkpoint(int op, int breakpt_num);
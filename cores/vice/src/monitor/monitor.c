@@ -2555,7 +2555,8 @@ int mon_read_snapshot(const char* name, int even_mode)
 
 void monitor_watch_push_load_addr(uint16_t addr, MEMSPACE mem)
 {
-    if (inside_monitor) {
+    /* most accesses are to addresses nothing watches */
+    if (inside_monitor || !mon_breakpoint_map_test(mon_watchpoints_load_map[mem], addr)) {
         return;
     }
 
@@ -2570,7 +2571,8 @@ void monitor_watch_push_load_addr(uint16_t addr, MEMSPACE mem)
 
 void monitor_watch_push_store_addr(uint16_t addr, MEMSPACE mem)
 {
-    if (inside_monitor) {
+    /* most accesses are to addresses nothing watches */
+    if (inside_monitor || !mon_breakpoint_map_test(mon_watchpoints_store_map[mem], addr)) {
         return;
     }
 
@@ -0,0 +1,771 @@
+/*
+ * netplay-benchmark.c - Run two hosts in netplay rollback mode.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: netplay-benchmark [frames] [latency ms] [port]
+
+   Forks a server and a client that connect over the loopback interface
+   with network.c in rollback mode.  Each runs a synthetic machine whose
+   state every frame mixes in the joystick values played at its start,
+   and presses random joystick directions at random frames.  Frames are
+   paced at 50 Hz, except while catching up after a rollback.
+
+   The machine also has a few alarms that change the state and set
+   themselves again at times that depend on it.  Their schedule is not
+   part of the snapshot, so network.c has to restore it on its own for
+   the hosts to stay in sync.
+
+   Both hosts send the checksum of the state after every frame as last
+   emulated to the parent, which compares the frames both had the input
+   of the other for.  A second run has the machine of the client emulate
+   one frame differently every time, which network.c has to report as
+   out of sync.  */
+
+#include "vice.h"
+
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "alarm.h"
+#include "archdep.h"
+#include "cmdline.h"
+#include "drive.h"
+#include "interrupt.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "maincpu.h"
+#include "network.h"
+#include "resources.h"
+#include "signals.h"
+#include "snapshot.h"
+#include "sound.h"
+#include "tick.h"
+#include "types.h"
+#include "uiapi.h"
+#include "vice-event.h"
+#include "vsync.h"
+
+#define BENCH_STATE_SIZE    4096
+#define BENCH_REFRESH       50.0
+
+/* Frames run after the compared ones, so that the input for those has
+   arrived on both hosts.  */
+#define BENCH_MARGIN        60
+
+/* The frame counter and joystick values are part of the state.  */
+#define BENCH_JOY           4
+#define BENCH_ALARM         8
+#define BENCH_RAM           16
+
+#define BENCH_CYCLES        19656
+#define BENCH_ALARMS        3
+
+#define BENCH_TRAPS         8
+
+typedef struct bench_result_s {
+    unsigned long frames;           /* Frames emulated, without repeats.  */
+    unsigned long rollbacks;
+    unsigned long repeated;         /* Frames emulated again.  */
+    int out_of_sync;
+    char error[128];                /* Last error shown.  */
+} bench_result_t;
+
+static uint8_t bench_state[BENCH_STATE_SIZE];
+static uint32_t bench_desync_frame;
+
+/* Checksum of the state after every frame.  */
+static uint32_t *bench_sums;
+static unsigned long bench_max_frames;
+
+static bench_result_t bench_result;
+static int bench_catching_up;
+
+static void (*bench_traps[BENCH_TRAPS])(uint16_t, void *data);
+static int bench_num_traps;
+
+static alarm_t *bench_alarms[BENCH_ALARMS];
+static CLOCK bench_clk;
+
+alarm_context_t *maincpu_alarm_context;
+interrupt_cpu_status_t *maincpu_int_status;
+static alarm_context_t *bench_drive_alarm_context[NUM_DISK_UNITS];
+
+static const resource_int_t *bench_resources_int;
+static const resource_string_t *bench_resources_string;
+
+/* Stubs for lib.c, util.c, socket.c, alarm.c and network.c.  */
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+int archdep_network_init(void)
+{
+    return 0;
+}
+
+char *archdep_tmpnam(void)
+{
+    return lib_msprintf("/tmp/netplay-benchmark-%d", (int)getpid());
+}
+
+FILE *archdep_mkstemp_fd(char **filename, const char *mode)
+{
+    *filename = archdep_tmpnam();
+    return fopen(*filename, mode);
+}
+
+int ioutil_remove(const char *name)
+{
+    return remove(name);
+}
+
+/* As on Unix; a host that finds the states differ disconnects while the
+   other one may still be sending.  */
+static void (*bench_old_pipe_handler)(int);
+
+void signals_pipe_set(void)
+{
+    bench_old_pipe_handler = signal(SIGPIPE, SIG_IGN);
+}
+
+void signals_pipe_unset(void)
+{
+    signal(SIGPIPE, bench_old_pipe_handler);
+}
+
+int log_message(log_t log, const char *format, ...)
+{
+    return 0;
+}
+
+int log_debug(const char *format, ...)
+{
+    return 0;
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+void ui_error(const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vsnprintf(bench_result.error, sizeof(bench_result.error), format, ap);
+    va_end(ap);
+
+    if (strstr(bench_result.error, "out of sync") != NULL) {
+        bench_result.out_of_sync = 1;
+    }
+}
+
+void ui_display_statustext(const char *text, int fade_out)
+{
+}
+
+int cmdline_register_options(const cmdline_option_t *c)
+{
+    return 0;
+}
+
+int resources_register_int(const resource_int_t *r)
+{
+    bench_resources_int = r;
+    for (; r->name != NULL; r++) {
+        r->set_func(r->factory_value, r->param);
+    }
+    return 0;
+}
+
+int resources_register_string(const resource_string_t *r)
+{
+    bench_resources_string = r;
+    for (; r->name != NULL; r++) {
+        r->set_func(r->factory_value, r->param);
+    }
+    return 0;
+}
+
+static int bench_set_int(const char *name, int value)
+{
+    const resource_int_t *r;
+
+    for (r = bench_resources_int; r->name != NULL; r++) {
+        if (!strcmp(r->name, name)) {
+            return r->set_func(value, r->param);
+        }
+    }
+    return -1;
+}
+
+static int bench_set_string(const char *name, const char *value)
+{
+    const resource_string_t *r;
+
+    for (r = bench_resources_string; r->name != NULL; r++) {
+        if (!strcmp(r->name, name)) {
+            return r->set_func(value, r->param);
+        }
+    }
+    return -1;
+}
+
+int resources_set_event_safe(void)
+{
+    return 0;
+}
+
+void resources_get_event_safe_list(event_list_state_t *list)
+{
+}
+
+/* Traps are taken at the start of the next frame.  */
+void interrupt_maincpu_trigger_trap(void (*trap_func)(uint16_t, void *data), void *data)
+{
+    if (bench_num_traps < BENCH_TRAPS) {
+        bench_traps[bench_num_traps++] = trap_func;
+    }
+}
+
+static void bench_run_traps(void)
+{
+    void (*trap_func)(uint16_t, void *data);
+    int i;
+
+    while (bench_num_traps > 0) {
+        trap_func = bench_traps[0];
+        bench_num_traps--;
+        for (i = 0; i < bench_num_traps; i++) {
+            bench_traps[i] = bench_traps[i + 1];
+        }
+        trap_func(0, NULL);
+    }
+}
+
+/* The synthetic machine has no interrupt lines.  */
+void interrupt_cpu_status_save_state(const interrupt_cpu_status_t *cs, interrupt_cpu_state_t *state)
+{
+}
+
+int interrupt_cpu_status_restore_state(interrupt_cpu_status_t *cs, const interrupt_cpu_state_t *state)
+{
+    return 0;
+}
+
+void interrupt_cpu_state_free(interrupt_cpu_state_t *state)
+{
+}
+
+alarm_context_t *drive_cpu_alarm_context_get(unsigned int dnr)
+{
+    return bench_drive_alarm_context[dnr];
+}
+
+interrupt_cpu_status_t *drive_cpu_int_status_get(unsigned int dnr)
+{
+    return NULL;
+}
+
+unsigned int maincpu_get_pc(void)
+{
+    return 0;
+}
+
+unsigned int maincpu_get_a(void)
+{
+    return 0;
+}
+
+unsigned int maincpu_get_x(void)
+{
+    return 0;
+}
+
+unsigned int maincpu_get_y(void)
+{
+    return 0;
+}
+
+unsigned int maincpu_get_sp(void)
+{
+    return 0;
+}
+
+void sound_suspend(void)
+{
+}
+
+unsigned long tick_per_second(void)
+{
+    return 1000000;
+}
+
+unsigned long tick_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+unsigned long tick_delta(unsigned long previous_tick)
+{
+    return tick_now() - previous_tick;
+}
+
+void tick_sleep(unsigned long delay)
+{
+    struct timespec ts;
+
+    ts.tv_sec = delay / 1000000;
+    ts.tv_nsec = (delay % 1000000) * 1000;
+    nanosleep(&ts, NULL);
+}
+
+double vsync_get_refresh_frequency(void)
+{
+    return BENCH_REFRESH;
+}
+
+void vsync_suspend_speed_eval(void)
+{
+}
+
+void vsync_set_catch_up(int enable)
+{
+    bench_catching_up = enable;
+}
+
+/* The parts of event.c used by network.c; only joystick values are
+   played.  */
+void event_register_event_list(event_list_state_t *list)
+{
+    list->base = lib_calloc(1, sizeof(event_list_t));
+    list->current = list->base;
+}
+
+void event_clear_list(event_list_state_t *list)
+{
+    event_list_t *c1, *c2;
+
+    if (list == NULL) {
+        return;
+    }
+    for (c1 = list->base; c1 != NULL; c1 = c2) {
+        c2 = c1->next;
+        lib_free(c1->data);
+        lib_free(c1);
+    }
+}
+
+void event_record_in_list(event_list_state_t *list, unsigned int type,
+                          void *data, unsigned int size)
+{
+    list->current->type = type;
+    list->current->clk = 0;
+    list->current->size = size;
+    list->current->data = NULL;
+    if (size > 0) {
+        list->current->data = lib_malloc(size);
+        memcpy(list->current->data, data, size);
+    }
+    list->current->next = lib_calloc(1, sizeof(event_list_t));
+    list->current = list->current->next;
+    list->current->type = EVENT_LIST_END;
+}
+
+void event_record_attach_in_list(event_list_state_t *list, unsigned int unit,
+                                 unsigned int drive,
+                                 const char *filename, unsigned int read_only)
+{
+}
+
+void event_playback_event_list(event_list_state_t *list)
+{
+    event_list_t *current;
+    uint8_t *data;
+
+    for (current = list->base; current->type != EVENT_LIST_END; current = current->next) {
+        data = current->data;
+        if (current->type == EVENT_JOYSTICK_VALUE && current->size == 2 && data[0] < 4) {
+            bench_state[BENCH_JOY + data[0]] = data[1];
+        }
+    }
+}
+
+void event_init_image_list(void)
+{
+}
+
+void event_destroy_image_list(void)
+{
+}
+
+/* Synthetic machine.  */
+static uint32_t bench_sum(const uint8_t *data, size_t size)
+{
+    uint32_t sum = 0;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        sum = sum * 31 + data[i];
+    }
+    return sum;
+}
+
+static uint32_t bench_frame(void)
+{
+    return (uint32_t)bench_state[0] | ((uint32_t)bench_state[1] << 8)
+           | ((uint32_t)bench_state[2] << 16) | ((uint32_t)bench_state[3] << 24);
+}
+
+/* Steps of a quarter frame, so alarms often fall due at the same tick
+   and their order matters.  */
+static void bench_alarm_handler(CLOCK offset, void *data)
+{
+    int n = vice_ptr_to_int(data);
+    CLOCK clk = bench_clk - offset;
+
+    bench_state[BENCH_ALARM] = (uint8_t)(bench_state[BENCH_ALARM] * 3 + n + 1);
+    alarm_set(bench_alarms[n], clk + (CLOCK)(1 + (bench_state[BENCH_ALARM]
+                                                  + bench_state[BENCH_JOY + 1 + n % 2]) % 4)
+                                     * (BENCH_CYCLES / 4));
+}
+
+static void bench_run_frame(void)
+{
+    uint32_t frame = bench_frame() + 1;
+    uint32_t seed = frame * 2654435761u;
+    CLOCK end = (CLOCK)frame * BENCH_CYCLES;
+    int i;
+
+    while (alarm_context_next_pending_clk(maincpu_alarm_context) < end) {
+        bench_clk = alarm_context_next_pending_clk(maincpu_alarm_context);
+        alarm_context_dispatch(maincpu_alarm_context, bench_clk);
+    }
+
+    bench_state[0] = (uint8_t)frame;
+    bench_state[1] = (uint8_t)(frame >> 8);
+    bench_state[2] = (uint8_t)(frame >> 16);
+    bench_state[3] = (uint8_t)(frame >> 24);
+
+    for (i = 0; i < 64; i++) {
+        seed = seed * 1103515245 + 12345 + bench_state[BENCH_JOY + 1] + 7 * bench_state[BENCH_JOY + 2];
+        bench_state[BENCH_RAM + (seed >> 8) % (BENCH_STATE_SIZE - BENCH_RAM)] += (uint8_t)(seed >> 24);
+    }
+
+    /* A machine that does not emulate the same way every time.  */
+    if (frame == bench_desync_frame) {
+        bench_state[BENCH_RAM] ^= 0x55;
+    }
+
+    if (frame < bench_max_frames) {
+        bench_sums[frame] = bench_sum(bench_state, BENCH_STATE_SIZE);
+    }
+}
+
+int machine_write_snapshot(const char *name, int save_roms, int save_disks, int even_mode)
+{
+    FILE *f = fopen(name, "wb");
+    int ret;
+
+    if (f == NULL) {
+        return -1;
+    }
+    ret = fwrite(bench_state, 1, BENCH_STATE_SIZE, f) == BENCH_STATE_SIZE ? 0 : -1;
+    fclose(f);
+    return ret;
+}
+
+int machine_read_snapshot(const char *name, int even_mode)
+{
+    FILE *f = fopen(name, "rb");
+    int ret;
+
+    if (f == NULL) {
+        return -1;
+    }
+    ret = fread(bench_state, 1, BENCH_STATE_SIZE, f) == BENCH_STATE_SIZE ? 0 : -1;
+    fclose(f);
+    remove(name);
+    return ret;
+}
+
+int machine_write_snapshot_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode)
+{
+    if (mem->capacity < BENCH_STATE_SIZE) {
+        mem->data = lib_realloc(mem->data, BENCH_STATE_SIZE);
+        mem->capacity = BENCH_STATE_SIZE;
+    }
+    memcpy(mem->data, bench_state, BENCH_STATE_SIZE);
+    mem->size = BENCH_STATE_SIZE;
+    return 0;
+}
+
+int machine_read_snapshot_memory(const uint8_t *data, size_t size, int event_mode)
+{
+    if (size != BENCH_STATE_SIZE) {
+        return -1;
+    }
+    memcpy(bench_state, data, size);
+    bench_result.rollbacks++;
+    return 0;
+}
+
+/* Run one host; the results go to `fd'.  */
+static int bench_host(int server, unsigned long frames, int latency, int port, int ready_fd, int fd)
+{
+    unsigned long next, last = 0;
+    uint8_t joy[2];
+    int i;
+
+    srand(server ? 1 : 2);
+
+    maincpu_alarm_context = alarm_context_new("MainCPU");
+    for (i = 0; i < NUM_DISK_UNITS; i++) {
+        bench_drive_alarm_context[i] = alarm_context_new("Drive");
+    }
+    for (i = 0; i < BENCH_ALARMS; i++) {
+        bench_alarms[i] = alarm_new(maincpu_alarm_context, "Bench", bench_alarm_handler,
+                                    int_to_void_ptr(i));
+        alarm_set(bench_alarms[i], BENCH_CYCLES / 2);
+    }
+
+    network_resources_init();
+    bench_set_string("NetworkServerName", "127.0.0.1");
+    bench_set_string("NetworkServerBindAddress", "127.0.0.1");
+    bench_set_int("NetworkServerPort", port);
+    bench_set_int("NetworkControl", NETWORK_CONTROL_JOY1
+                  | (NETWORK_CONTROL_JOY2 << NETWORK_CONTROL_CLIENTOFFSET));
+    bench_set_int("NetworkRollback", 1);
+    bench_set_int("NetworkLatency", latency);
+
+    if (server) {
+        if (network_start_server() < 0) {
+            fprintf(stderr, "cannot listen on port %d\n", port);
+            return 1;
+        }
+        if (write(ready_fd, "", 1) != 1) {
+            return 1;
+        }
+        while (network_get_mode() != NETWORK_SERVER_CONNECTED) {
+            network_hook();
+            bench_run_traps();
+            tick_sleep(1000);
+        }
+    } else if (network_connect_client() < 0) {
+        fprintf(stderr, "cannot connect: %s\n", bench_result.error);
+        return 1;
+    }
+    bench_run_traps();
+
+    next = tick_now();
+    while (bench_result.frames < frames + BENCH_MARGIN && network_connected()) {
+        bench_run_frame();
+        if (bench_frame() > last) {
+            last = bench_frame();
+            bench_result.frames++;
+        } else {
+            bench_result.repeated++;
+        }
+
+        /* Server on port 1, client on port 2.  */
+        if (rand() % 8 == 0) {
+            joy[0] = server ? 1 : 2;
+            joy[1] = (uint8_t)(rand() % 32);
+            network_event_record(EVENT_JOYSTICK_VALUE, joy, sizeof(joy));
+        }
+
+        network_hook();
+        bench_run_traps();
+
+        if (!bench_catching_up) {
+            next += (unsigned long)(tick_per_second() / BENCH_REFRESH);
+            if ((long)(next - tick_now()) > 0) {
+                tick_sleep(next - tick_now());
+            } else {
+                next = tick_now();
+            }
+        }
+    }
+    network_shutdown();
+
+    if (write(fd, &bench_result, sizeof(bench_result)) != sizeof(bench_result)
+        || write(fd, bench_sums, bench_max_frames * sizeof(uint32_t))
+           != (ssize_t)(bench_max_frames * sizeof(uint32_t))) {
+        return 1;
+    }
+    return 0;
+}
+
+static int bench_read(int fd, void *buf, size_t size)
+{
+    uint8_t *p = buf;
+    ssize_t n;
+
+    while (size > 0) {
+        n = read(fd, p, size);
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+/* Run a server and a client, return the number of the first frame their
+   states differ at, 0 if none, -1 on errors.  */
+static long bench_run(unsigned long frames, int latency, int port, uint32_t desync_frame,
+                      bench_result_t *result)
+{
+    int ready[2], out[2][2];
+    pid_t pid[2];
+    uint32_t *sums[2];
+    char c;
+    long differ = 0;
+    unsigned long f;
+    int i, forked, status, failed = 0;
+
+    bench_max_frames = frames + 1;
+    if (pipe(ready) < 0 || pipe(out[0]) < 0 || pipe(out[1]) < 0) {
+        return -1;
+    }
+
+    fflush(stdout);
+    for (forked = 0; forked < 2; forked++) {
+        i = forked;
+        pid[i] = fork();
+        if (pid[i] == 0) {
+            bench_sums = lib_calloc(bench_max_frames, sizeof(uint32_t));
+            /* Only the client emulates a frame differently.  */
+            bench_desync_frame = i ? desync_frame : 0;
+            exit(bench_host(i == 0, frames, latency, port, ready[1], out[i][1]));
+        }
+        close(out[i][1]);
+        if (i == 0) {
+            close(ready[1]);
+        }
+        /* The client connects once the server listens.  */
+        if (i == 0 && read(ready[0], &c, 1) != 1) {
+            failed = 1;
+            forked++;
+            break;
+        }
+    }
+    close(ready[0]);
+
+    sums[0] = lib_malloc(bench_max_frames * sizeof(uint32_t));
+    sums[1] = lib_malloc(bench_max_frames * sizeof(uint32_t));
+    for (i = 0; i < 2 && !failed; i++) {
+        if (bench_read(out[i][0], &result[i], sizeof(bench_result_t)) < 0
+            || bench_read(out[i][0], sums[i], bench_max_frames * sizeof(uint32_t)) < 0) {
+            failed = 1;
+        }
+    }
+    for (i = 0; i < forked; i++) {
+        if (waitpid(pid[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) {
+            failed = 1;
+        }
+    }
+    close(out[0][0]);
+    close(out[1][0]);
+
+    for (f = 1; f <= frames && !differ; f++) {
+        if (sums[0][f] != sums[1][f]) {
+            differ = (long)f;
+        }
+    }
+    lib_free(sums[0]);
+    lib_free(sums[1]);
+
+    return failed ? -1 : differ;
+}
+
+static void bench_print(const char *name, const bench_result_t *r)
+{
+    printf("%-8s %8lu %10lu %10lu  %s\n", name, r->frames, r->rollbacks, r->repeated, r->error);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long frames = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+    int latency = argc > 2 ? atoi(argv[2]) : 60;
+    /* The ports of an earlier run may still be in use.  */
+    int port = argc > 3 ? atoi(argv[3]) : 20000 + (int)(getpid() % 10000) * 2;
+    bench_result_t result[2];
+    long differ;
+    int errors = 0;
+
+    printf("%lu frames, %d ms latency\n", frames, latency);
+    printf("%-8s %8s %10s %10s\n", "host", "frames", "rollbacks", "repeated");
+
+    differ = bench_run(frames, latency, port, 0, result);
+    if (differ < 0) {
+        printf("run failed\n");
+        return 1;
+    }
+    bench_print("server", &result[0]);
+    bench_print("client", &result[1]);
+    if (differ > 0) {
+        printf("states differ at frame %ld\n", differ);
+        errors++;
+    } else {
+        printf("states of all %lu frames are the same\n", frames);
+    }
+    if (result[0].out_of_sync || result[1].out_of_sync) {
+        printf("out of sync reported in sync\n");
+        errors++;
+    }
+
+    printf("client emulating frame %lu differently:\n", frames / 2);
+    differ = bench_run(frames, latency, port + 1, (uint32_t)(frames / 2), result);
+    if (differ < 0) {
+        printf("run failed\n");
+        return 1;
+    }
+    bench_print("server", &result[0]);
+    bench_print("client", &result[1]);
+    if (!result[0].out_of_sync && !result[1].out_of_sync) {
+        printf("out of sync not reported\n");
+        errors++;
+    }
+
+    return errors ? 1 : 0;
+}
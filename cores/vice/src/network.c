@@ -38,8 +38,11 @@
 #include <strings.h>
 #endif
 
+#include "alarm.h"
 #include "archdep.h"
 #include "cmdline.h"
+#include "crc32.h"
+#include "drive.h"
 #include "interrupt.h"
 #include "lib.h"
 #include "log.h"
@@ -48,6 +51,7 @@
 #include "mos6510.h"
 #include "network.h"
 #include "resources.h"
+#include "snapshot.h"
 #include "tick.h"
 #include "types.h"
 #include "uiapi.h"
@@ -79,6 +83,10 @@ static int current_frame, frame_to_play;
 static event_list_state_t *frame_event_list = NULL;
 static char *snapshotfilename;
 
+static int network_rollback;
+static int network_latency;
+static network_mode_t network_autostart = NETWORK_IDLE;
+
 static int set_server_name(const char *val, void *param)
 {
     util_string_set(&server_name, val);
@@ -114,6 +122,29 @@ static int set_network_control(int val, void *param)
     return 0;
 }
 
+static int set_network_rollback(int val, void *param)
+{
+    /* both hosts have to switch at the same frame, which they cannot */
+    if (network_connected()) {
+        return -1;
+    }
+
+    network_rollback = val ? 1 : 0;
+
+    return 0;
+}
+
+static int set_network_latency(int val, void *param)
+{
+    if (val < 0 || val > 1000) {
+        return -1;
+    }
+
+    network_latency = val;
+
+    return 0;
+}
+
 /*---------- Resources ------------------------------------------------*/
 
 static const resource_string_t resources_string[] = {
@@ -129,6 +160,10 @@ static const resource_int_t resources_int[] = {
       &res_server_port, set_server_port, NULL },
     { "NetworkControl", NETWORK_CONTROL_DEFAULT, RES_EVENT_SAME, NULL,
       &network_control, set_network_control, NULL },
+    { "NetworkRollback", 0, RES_EVENT_SAME, NULL,
+      &network_rollback, set_network_rollback, NULL },
+    { "NetworkLatency", 0, RES_EVENT_NO, NULL,
+      &network_latency, set_network_latency, NULL },
     RESOURCE_INT_LIST_END
 };
 
@@ -199,6 +234,13 @@ static int network_control_cmd(const char *param, void *extra_param)
     return 0;
 }
 
+static int network_autostart_cmd(const char *param, void *extra_param)
+{
+    network_autostart = (network_mode_t)vice_ptr_to_int(extra_param);
+
+    return 0;
+}
+
 static const cmdline_option_t cmdline_options[] =
 {
     { "-netplayserver", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
@@ -213,6 +255,21 @@ static const cmdline_option_t cmdline_options[] =
     { "-netplayctrl", CALL_FUNCTION, CMDLINE_ATTRIB_NEED_ARGS,
       network_control_cmd, NULL, NULL, NULL,
       "<key,joy1,joy2,dev,rsrc>", "Set the netplay control elements (keyboard, joystick1, joystick2, devices and resources), each item takes a value (0: None, 1: Server, 2: Client, 3: Both)" },
+    { "-netplayrollback", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "NetworkRollback", (resource_value_t)1,
+      NULL, "Predict the input of the remote host and roll back if wrong" },
+    { "+netplayrollback", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "NetworkRollback", (resource_value_t)0,
+      NULL, "Wait for the input of the remote host every frame" },
+    { "-netplaylatency", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "NetworkLatency", NULL,
+      "<ms>", "Delay the data sent to the remote host in rollback mode, for testing (0..1000)" },
+    { "-netplayhost", CALL_FUNCTION, CMDLINE_ATTRIB_NONE,
+      network_autostart_cmd, (void *)NETWORK_SERVER, NULL, NULL,
+      NULL, "Start a netplay server after startup" },
+    { "-netplayjoin", CALL_FUNCTION, CMDLINE_ATTRIB_NONE,
+      network_autostart_cmd, (void *)NETWORK_CLIENT, NULL, NULL,
+      NULL, "Connect to the netplay server after startup" },
     CMDLINE_LIST_END
 };
 
@@ -344,8 +401,9 @@ static int network_recv_buffer(vice_network_socket_t * s, uint8_t *buf, int len)
     while (received_total < len) {
         t = vice_network_receive(s, buf, len - received_total, 0);
 
-        if (t < 0) {
-            return t;
+        if (t <= 0) {
+            /* 0 if the remote host closed the connection */
+            return -1;
         }
 
         received_total += t;
@@ -450,6 +508,592 @@ static void network_test_delay(void)
     ui_display_statustext(st, 1);
 }
 
+/*-------------------------------------------------------------------------*/
+
+/* Rollback mode.  Instead of waiting for the input of the remote host
+   every frame, the emulation goes on assuming that the remote input did
+   not change, i.e. that the remote host sent an empty event list.  The
+   state at the start of each of the last frames is kept in memory, with
+   the event lists played at that frame.  When a list arrives that is not
+   empty for a frame that has already been emulated, the state of that
+   frame is restored and the frames up to the current one are emulated
+   again as fast as possible, now with the real input.
+
+   The own input is played `NETWORK_ROLLBACK_DELAY' frames after it was
+   recorded, which hides that much of the latency without any rollback.
+   If the remote host falls back more than `NETWORK_ROLLBACK_FRAMES'
+   frames, the emulation waits for it as in lockstep mode.
+
+   A snapshot does not have all of the state that decides how the frames
+   are emulated again: the pending alarms and the interrupt lines of the
+   main and drive CPUs are set up anew by the modules as the snapshot is
+   read.  These are saved with each frame and put back over what the
+   modules did, so that the frames are emulated again the same way.
+
+   Once the input of both hosts is known for all frames before a frame,
+   the state at its start is confirmed and must be the same on both hosts.
+   Each host sends the CRC32 of the snapshot of its latest confirmed frame
+   along with its input, and disconnects if the remote one differs; this
+   catches a state the rollback failed to restore.
+
+   Each frame is sent as frame number, length, number of the latest
+   confirmed frame and its CRC32 (LE dwords) followed by the event buffer;
+   a length of 0 tells that the remote host suspended.  */
+
+#define NETWORK_ROLLBACK_FRAMES     16
+#define NETWORK_ROLLBACK_DELAY      1
+
+/* Lists from the remote host can be up to `NETWORK_ROLLBACK_FRAMES' +
+   `NETWORK_ROLLBACK_DELAY' frames ahead of the own ones.  */
+#define NETWORK_ROLLBACK_RING       (2 * (NETWORK_ROLLBACK_FRAMES + NETWORK_ROLLBACK_DELAY) + 2)
+
+/* Seconds between two reports in the log.  */
+#define NETWORK_ROLLBACK_REPORT     5
+
+#define NETWORK_ROLLBACK_HEADER     16
+
+/* The main CPU and the CPUs of the drives.  */
+#define NETWORK_ROLLBACK_CPUS       (1 + NUM_DISK_UNITS)
+
+typedef struct network_cpu_state_s {
+    alarm_context_state_t alarms;
+    interrupt_cpu_state_t ints;
+} network_cpu_state_t;
+
+typedef struct network_frame_s {
+    unsigned long frame;            /* Frame number, or -1 if unused.  */
+    snapshot_memory_t state;        /* State at the start of the frame.  */
+    int state_valid;
+    network_cpu_state_t cpu[NETWORK_ROLLBACK_CPUS];    /* Not in `state'.  */
+    event_list_state_t local;       /* Own input played at the start.  */
+    event_list_state_t remote;      /* Input of the remote host.  */
+    int remote_valid;               /* Flag: `remote' has been received.  */
+    int predicted;                  /* Flag: played without `remote'.  */
+    uint32_t hash;                  /* CRC32 of `state'.  */
+    int hash_valid;
+    uint32_t remote_hash;           /* CRC32 sent by the remote host.  */
+    int remote_hash_valid;          /* Flag: `remote_hash' not checked yet.  */
+} network_frame_t;
+
+/* Data held back by the latency shim.  */
+typedef struct network_packet_s {
+    unsigned long due;              /* Tick when to send it.  */
+    uint8_t *buf;
+    unsigned int len;
+    struct network_packet_s *next;
+} network_packet_t;
+
+static int rollback_active = 0;
+static network_frame_t *rollback_ring = NULL;
+static event_list_state_t rollback_pending;
+
+/* Frame being emulated; all frames before `rollback_next' have been
+   emulated at least once.  */
+static unsigned long rollback_frame;
+static unsigned long rollback_next;
+
+/* Next frame to send the own input for; input of the remote host has
+   been received for all frames before `rollback_received'.  */
+static unsigned long rollback_send_next;
+static unsigned long rollback_received;
+
+/* Earliest frame played with a wrong prediction.  */
+static int rollback_pending_restore;
+static unsigned long rollback_restore_frame;
+
+/* Frame the trap is triggered for.  */
+static unsigned long rollback_trap_frame;
+
+/* States before this frame are the same on both hosts if in sync.  */
+static unsigned long rollback_confirmed;
+
+/* Flag: re-emulating frames after a rollback.  */
+static int rollback_catching_up = 0;
+
+static network_packet_t *send_queue_first = NULL;
+static network_packet_t *send_queue_last = NULL;
+
+static int rollback_remote_suspended = 0;
+
+/* Statistics since the last report.  */
+static unsigned long rollback_stat_tick;
+static unsigned long rollback_stat_rollbacks;
+static unsigned long rollback_stat_frames;
+static unsigned long rollback_stat_depth;
+static unsigned long rollback_stat_depth_max;
+
+static network_frame_t *network_rollback_entry(unsigned long frame)
+{
+    network_frame_t *e = &rollback_ring[frame % NETWORK_ROLLBACK_RING];
+
+    if (e->frame != frame) {
+        event_clear_list(&(e->local));
+        event_clear_list(&(e->remote));
+        event_register_event_list(&(e->local));
+        event_register_event_list(&(e->remote));
+        e->frame = frame;
+        e->state_valid = 0;
+        e->remote_valid = 0;
+        e->predicted = 0;
+        e->hash_valid = 0;
+        e->remote_hash_valid = 0;
+    }
+    return e;
+}
+
+static void network_send_queue_flush(void)
+{
+    network_packet_t *p;
+    int failed;
+
+    while (send_queue_first != NULL
+           && (long)(tick_now() - send_queue_first->due) >= 0) {
+        p = send_queue_first;
+        send_queue_first = p->next;
+        if (send_queue_first == NULL) {
+            send_queue_last = NULL;
+        }
+        failed = network_send_buffer(network_socket, p->buf, (int)p->len) < 0;
+        lib_free(p->buf);
+        lib_free(p);
+
+        if (failed) {
+            ui_display_statustext("Remote host disconnected.", 1);
+            network_disconnect();
+            return;
+        }
+    }
+}
+
+static void network_send_queue_clear(void)
+{
+    network_packet_t *p;
+
+    while (send_queue_first != NULL) {
+        p = send_queue_first;
+        send_queue_first = p->next;
+        lib_free(p->buf);
+        lib_free(p);
+    }
+    send_queue_last = NULL;
+}
+
+/* Send a frame to the remote host, after `NetworkLatency' ms.  Takes over
+   `buf'.  */
+static void network_send_frame(unsigned long frame, uint8_t *buf, unsigned int len)
+{
+    network_packet_t *p = lib_malloc(sizeof(network_packet_t));
+    network_frame_t *e = &rollback_ring[rollback_confirmed % NETWORK_ROLLBACK_RING];
+    int known = (e->frame == rollback_confirmed && e->hash_valid);
+
+    p->len = NETWORK_ROLLBACK_HEADER + len;
+    p->buf = lib_malloc(p->len);
+    util_dword_to_le_buf(&(p->buf[0]), (uint32_t)frame);
+    util_dword_to_le_buf(&(p->buf[4]), (uint32_t)len);
+    /* Frame 0 has no state, so it means none.  */
+    util_dword_to_le_buf(&(p->buf[8]), known ? (uint32_t)rollback_confirmed : 0);
+    util_dword_to_le_buf(&(p->buf[12]), known ? e->hash : 0);
+    if (len > 0) {
+        memcpy(&(p->buf[NETWORK_ROLLBACK_HEADER]), buf, len);
+    }
+    lib_free(buf);
+
+    p->due = tick_now() + (unsigned long)((double)tick_per_second() * network_latency / 1000.0);
+    p->next = NULL;
+    if (send_queue_last != NULL) {
+        send_queue_last->next = p;
+    } else {
+        send_queue_first = p;
+    }
+    send_queue_last = p;
+
+    network_send_queue_flush();
+}
+
+/* Keep the CRC32 the remote host sent for one of its confirmed frames, if
+   that frame is still in the ring.  */
+static void network_rollback_receive_hash(unsigned long frame, uint32_t hash)
+{
+    network_frame_t *e = &rollback_ring[frame % NETWORK_ROLLBACK_RING];
+
+    if (frame > 0 && e->frame == frame) {
+        e->remote_hash = hash;
+        e->remote_hash_valid = 1;
+    }
+}
+
+/* Receive the next frame from the remote host.  */
+static int network_rollback_receive(void)
+{
+    uint8_t header[NETWORK_ROLLBACK_HEADER];
+    uint8_t *buf;
+    unsigned int len;
+    event_list_state_t *list;
+    network_frame_t *e;
+
+    if (network_recv_buffer(network_socket, header, NETWORK_ROLLBACK_HEADER) < 0) {
+        return -1;
+    }
+
+    network_rollback_receive_hash(util_le_buf_to_dword(&header[8]),
+                                  util_le_buf_to_dword(&header[12]));
+
+    len = util_le_buf_to_dword(&header[4]);
+    if (len == 0) {
+        /* remote host suspended emulation */
+        ui_display_statustext("Remote host suspending...", 0);
+        rollback_remote_suspended = 1;
+        return 0;
+    }
+
+    if (util_le_buf_to_dword(&header[0]) != (uint32_t)rollback_received) {
+        log_error(LOG_DEFAULT, "Netplay: frame %u received, expected %lu.",
+                  util_le_buf_to_dword(&header[0]), rollback_received);
+        return -1;
+    }
+
+    if (rollback_remote_suspended) {
+        ui_display_statustext("", 0);
+        rollback_remote_suspended = 0;
+    }
+
+    buf = lib_malloc(len);
+    if (network_recv_buffer(network_socket, buf, (int)len) < 0) {
+        lib_free(buf);
+        return -1;
+    }
+    list = network_create_event_list(buf);
+    lib_free(buf);
+
+    e = network_rollback_entry(rollback_received);
+    event_clear_list(&(e->remote));
+    e->remote = *list;
+    e->remote_valid = 1;
+    lib_free(list);
+
+    /* An empty list is what has been predicted.  */
+    if (rollback_received <= rollback_frame && e->predicted
+        && e->remote.base->type != EVENT_LIST_END) {
+        if (!rollback_pending_restore || rollback_received < rollback_restore_frame) {
+            rollback_restore_frame = rollback_received;
+        }
+        rollback_pending_restore = 1;
+    }
+
+    rollback_received++;
+
+    return 0;
+}
+
+/* Play the input of a frame; server first, then client.  */
+static void network_rollback_play(network_frame_t *e)
+{
+    e->predicted = !e->remote_valid;
+
+    if (network_mode == NETWORK_SERVER_CONNECTED) {
+        event_playback_event_list(&(e->local));
+    }
+    if (e->remote_valid) {
+        event_playback_event_list(&(e->remote));
+    }
+    if (network_mode == NETWORK_CLIENT) {
+        event_playback_event_list(&(e->local));
+    }
+}
+
+static alarm_context_t *network_rollback_alarm_context(int cpu)
+{
+    return cpu == 0 ? maincpu_alarm_context : drive_cpu_alarm_context_get(cpu - 1);
+}
+
+static interrupt_cpu_status_t *network_rollback_int_status(int cpu)
+{
+    return cpu == 0 ? maincpu_int_status : drive_cpu_int_status_get(cpu - 1);
+}
+
+static void network_rollback_save_cpus(network_frame_t *e)
+{
+    int i;
+
+    for (i = 0; i < NETWORK_ROLLBACK_CPUS; i++) {
+        alarm_context_save_state(network_rollback_alarm_context(i), &(e->cpu[i].alarms));
+        interrupt_cpu_status_save_state(network_rollback_int_status(i), &(e->cpu[i].ints));
+    }
+}
+
+static int network_rollback_restore_cpus(network_frame_t *e)
+{
+    int i;
+
+    for (i = 0; i < NETWORK_ROLLBACK_CPUS; i++) {
+        if (alarm_context_restore_state(network_rollback_alarm_context(i), &(e->cpu[i].alarms)) < 0
+            || interrupt_cpu_status_restore_state(network_rollback_int_status(i), &(e->cpu[i].ints)) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void network_rollback_frame_trap(uint16_t addr, void *data)
+{
+    network_frame_t *e;
+
+    if (!rollback_active) {
+        return;
+    }
+    e = network_rollback_entry(rollback_trap_frame);
+
+    e->state_valid = (machine_write_snapshot_memory(&(e->state), 0, 0, 0) == 0);
+    if (!e->state_valid) {
+        log_error(LOG_DEFAULT, "Netplay: cannot take snapshot of frame %lu.", e->frame);
+    }
+    e->hash_valid = e->state_valid;
+    if (e->hash_valid) {
+        e->hash = crc32_buf((const char *)e->state.data, (unsigned int)e->state.size);
+    }
+    if (e->state_valid) {
+        network_rollback_save_cpus(e);
+    }
+
+    network_rollback_play(e);
+}
+
+static void network_rollback_restore_trap(uint16_t addr, void *data)
+{
+    network_frame_t *e;
+
+    if (!rollback_active) {
+        return;
+    }
+    e = network_rollback_entry(rollback_trap_frame);
+
+    if (!e->state_valid
+        || machine_read_snapshot_memory(e->state.data, e->state.size, 0) < 0
+        || network_rollback_restore_cpus(e) < 0) {
+        ui_error("Cannot roll back to frame %lu - disconnecting.", e->frame);
+        network_disconnect();
+        return;
+    }
+
+    network_rollback_play(e);
+}
+
+/* Compare the states of confirmed frames with those of the remote host.  */
+static int network_rollback_check(void)
+{
+    unsigned long confirmed = rollback_received;
+    network_frame_t *e;
+    int i;
+
+    /* The trap of `rollback_frame' has taken its snapshot by now.  */
+    if (confirmed > rollback_frame) {
+        confirmed = rollback_frame;
+    }
+    if (rollback_pending_restore && confirmed > rollback_restore_frame) {
+        confirmed = rollback_restore_frame;
+    }
+    if (confirmed > rollback_confirmed) {
+        rollback_confirmed = confirmed;
+    }
+
+    for (i = 0; i < NETWORK_ROLLBACK_RING; i++) {
+        e = &rollback_ring[i];
+        if (e->frame > rollback_confirmed || !e->hash_valid || !e->remote_hash_valid) {
+            continue;
+        }
+        if (e->hash != e->remote_hash) {
+            ui_error("Network out of sync at frame %lu - disconnecting.", e->frame);
+            network_disconnect();
+            return -1;
+        }
+        e->remote_hash_valid = 0;
+    }
+    return 0;
+}
+
+static void network_rollback_report(void)
+{
+    double seconds = (double)tick_delta(rollback_stat_tick) / tick_per_second();
+
+    if (seconds < NETWORK_ROLLBACK_REPORT) {
+        return;
+    }
+
+    log_message(LOG_DEFAULT,
+                "Netplay: %.1f frames/s re-emulated, %lu rollbacks, depth %.1f average, %lu max.",
+                rollback_stat_frames / seconds, rollback_stat_rollbacks,
+                rollback_stat_rollbacks ? (double)rollback_stat_depth / rollback_stat_rollbacks : 0.0,
+                rollback_stat_depth_max);
+
+    rollback_stat_tick = tick_now();
+    rollback_stat_rollbacks = 0;
+    rollback_stat_frames = 0;
+    rollback_stat_depth = 0;
+    rollback_stat_depth_max = 0;
+}
+
+static void network_rollback_start(void)
+{
+    unsigned long i;
+    char st[256];
+
+    rollback_ring = lib_calloc(NETWORK_ROLLBACK_RING, sizeof(network_frame_t));
+    for (i = 0; i < NETWORK_ROLLBACK_RING; i++) {
+        rollback_ring[i].frame = (unsigned long)-1;
+    }
+
+    /* Nobody has any input before the first frame sent.  */
+    for (i = 0; i <= NETWORK_ROLLBACK_DELAY; i++) {
+        network_rollback_entry(i)->remote_valid = 1;
+    }
+
+    event_register_event_list(&rollback_pending);
+    event_init_image_list();
+
+    rollback_frame = 0;
+    rollback_next = 1;
+    rollback_send_next = NETWORK_ROLLBACK_DELAY + 1;
+    rollback_received = NETWORK_ROLLBACK_DELAY + 1;
+    rollback_pending_restore = 0;
+    rollback_confirmed = 0;
+    rollback_catching_up = 0;
+
+    rollback_stat_tick = tick_now();
+    rollback_stat_rollbacks = 0;
+    rollback_stat_frames = 0;
+    rollback_stat_depth = 0;
+    rollback_stat_depth_max = 0;
+
+    rollback_active = 1;
+
+    sprintf(st, "Using rollback up to %d frames.", NETWORK_ROLLBACK_FRAMES);
+    log_message(LOG_DEFAULT, "netplay connected with rollback up to %d frames.",
+                NETWORK_ROLLBACK_FRAMES);
+    ui_display_statustext(st, 1);
+}
+
+static void network_rollback_stop(void)
+{
+    int i, j;
+
+    if (!rollback_active) {
+        return;
+    }
+    rollback_active = 0;
+
+    network_send_queue_clear();
+
+    for (i = 0; i < NETWORK_ROLLBACK_RING; i++) {
+        event_clear_list(&(rollback_ring[i].local));
+        event_clear_list(&(rollback_ring[i].remote));
+        lib_free(rollback_ring[i].state.data);
+        for (j = 0; j < NETWORK_ROLLBACK_CPUS; j++) {
+            interrupt_cpu_state_free(&(rollback_ring[i].cpu[j].ints));
+        }
+    }
+    lib_free(rollback_ring);
+    rollback_ring = NULL;
+
+    event_clear_list(&rollback_pending);
+    event_destroy_image_list();
+
+    if (rollback_catching_up) {
+        vsync_set_catch_up(0);
+        rollback_catching_up = 0;
+    }
+}
+
+static void network_hook_rollback(void)
+{
+    unsigned long frame = rollback_frame + 1;
+    network_frame_t *e;
+    uint8_t *buf = NULL;
+    unsigned int len;
+
+    suspended = 0;
+
+    /* Send the input recorded since the last frame.  */
+    if (frame + NETWORK_ROLLBACK_DELAY == rollback_send_next) {
+        e = network_rollback_entry(rollback_send_next++);
+        event_clear_list(&(e->local));
+        e->local = rollback_pending;
+        event_register_event_list(&rollback_pending);
+
+        len = network_create_event_buffer(&buf, &(e->local));
+        network_send_frame(e->frame, buf, len);
+        if (!rollback_active) {
+            return;
+        }
+    }
+    network_send_queue_flush();
+
+    /* Wait if the remote host has fallen back too far.  */
+    while (frame == rollback_next
+           && frame >= rollback_received + NETWORK_ROLLBACK_FRAMES) {
+        if (vice_network_select_poll_one(network_socket) > 0) {
+            if (network_rollback_receive() < 0) {
+                ui_display_statustext("Remote host disconnected.", 1);
+                network_disconnect();
+                return;
+            }
+        } else {
+            tick_sleep(tick_per_second() / 1000);
+            network_send_queue_flush();
+            if (!rollback_active) {
+                return;
+            }
+        }
+    }
+
+    while (vice_network_select_poll_one(network_socket) > 0) {
+        if (network_rollback_receive() < 0) {
+            ui_display_statustext("Remote host disconnected.", 1);
+            network_disconnect();
+            return;
+        }
+    }
+
+    if (network_rollback_check() < 0) {
+        return;
+    }
+
+    if (rollback_pending_restore) {
+        rollback_pending_restore = 0;
+
+        rollback_stat_rollbacks++;
+        rollback_stat_depth += rollback_next - rollback_restore_frame;
+        if (rollback_next - rollback_restore_frame > rollback_stat_depth_max) {
+            rollback_stat_depth_max = rollback_next - rollback_restore_frame;
+        }
+
+        if (!rollback_catching_up) {
+            vsync_set_catch_up(1);
+            rollback_catching_up = 1;
+        }
+
+        frame = rollback_restore_frame;
+        rollback_trap_frame = frame;
+        interrupt_maincpu_trigger_trap(network_rollback_restore_trap, (void *)0);
+    } else {
+        if (frame == rollback_next && rollback_catching_up) {
+            vsync_set_catch_up(0);
+            rollback_catching_up = 0;
+        }
+
+        rollback_trap_frame = frame;
+        interrupt_maincpu_trigger_trap(network_rollback_frame_trap, (void *)0);
+    }
+
+    if (frame < rollback_next) {
+        rollback_stat_frames++;
+    } else {
+        rollback_next = frame + 1;
+    }
+    rollback_frame = frame;
+
+    network_rollback_report();
+}
+
 static void network_server_connect_trap(uint16_t addr, void *data)
 {
     FILE *f;
@@ -508,7 +1152,11 @@ static void network_server_connect_trap(uint16_t addr, void *data)
         current_send_frame = 0;
         last_received_frame = 0;
 
-        network_test_delay();
+        if (network_rollback) {
+            network_rollback_start();
+        } else {
+            network_test_delay();
+        }
     } else {
         ui_error("Cannot create snapshot file %s", snapshotfilename);
     }
@@ -562,7 +1210,11 @@ static void network_client_connect_trap(uint16_t addr, void *data)
 
     network_mode = NETWORK_CLIENT;
 
-    network_test_delay();
+    if (network_rollback) {
+        network_rollback_start();
+    } else {
+        network_test_delay();
+    }
     lib_free(snapshotfilename);
 }
 
@@ -610,6 +1262,19 @@ void network_event_record(unsigned int type, void *data, unsigned int size)
         return;
     }
 
+    if (rollback_active) {
+        /* Latch the keyboard before the next frame starts, the pending
+           latch would not be part of the state kept for that frame.  */
+        if (type == EVENT_KEYBOARD_DELAY && size == sizeof(CLOCK)) {
+            CLOCK delay = 1;
+
+            event_record_in_list(&rollback_pending, type, (void *)&delay, size);
+        } else {
+            event_record_in_list(&rollback_pending, type, data, size);
+        }
+        return;
+    }
+
     event_record_in_list(&(frame_event_list[current_frame]), type, data, size);
 }
 
@@ -628,7 +1293,8 @@ void network_attach_image(unsigned int unit, const char *filename)
         return;
     }
 
-    event_record_attach_in_list(&(frame_event_list[current_frame]), unit, drive, filename, 1);
+    event_record_attach_in_list(rollback_active ? &rollback_pending : &(frame_event_list[current_frame]),
+                                unit, drive, filename, 1);
 }
 
 int network_get_mode(void)
@@ -757,6 +1423,8 @@ int network_connect_client(void)
 
 void network_disconnect(void)
 {
+    network_rollback_stop();
+
     vice_network_socket_close(network_socket);
     if (network_mode == NETWORK_SERVER_CONNECTED) {
         network_mode = NETWORK_SERVER;
@@ -774,6 +1442,12 @@ void network_suspend(void)
         return;
     }
 
+    if (rollback_active) {
+        network_send_frame(rollback_send_next, NULL, 0);
+        suspended = 1;
+        return;
+    }
+
     network_send_buffer(network_socket, (uint8_t *)&dummy_buf_len, sizeof(unsigned int));
 
     suspended = 1;
@@ -899,6 +1573,15 @@ static void network_hook_connected_receive(void)
 
 void network_hook(void)
 {
+    if (network_autostart != NETWORK_IDLE) {
+        if (network_autostart == NETWORK_SERVER) {
+            network_start_server();
+        } else {
+            network_connect_client();
+        }
+        network_autostart = NETWORK_IDLE;
+    }
+
     if (network_mode == NETWORK_IDLE) {
         return;
     }
@@ -914,7 +1597,9 @@ void network_hook(void)
         }
     }
 
-    if (network_connected()) {
+    if (network_connected() && rollback_active) {
+        network_hook_rollback();
+    } else if (network_connected()) {
         network_hook_connected_send();
         network_hook_connected_receive();
 #ifdef NETWORK_DEBUG
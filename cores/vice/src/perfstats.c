@@ -0,0 +1,75 @@
+/*
+ * perfstats.c - Time spent in emulation subsystems.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#include "vice.h"
+
+#include <string.h>
+
+#include "perfstats.h"
+#include "types.h"
+
+#define PERFSTATS_HASH_PRIME 0x100000001b3ULL
+
+int perfstats_enabled = 0;
+unsigned long perfstats_ticks[PERFSTATS_NUM];
+
+uint64_t perfstats_sound_hash = PERFSTATS_HASH_INIT;
+unsigned long perfstats_sound_samples = 0;
+unsigned long perfstats_drive_idle_cycles = 0;
+
+void perfstats_reset(void)
+{
+    memset(perfstats_ticks, 0, sizeof(perfstats_ticks));
+    perfstats_sound_hash = PERFSTATS_HASH_INIT;
+    perfstats_sound_samples = 0;
+    perfstats_drive_idle_cycles = 0;
+}
+
+/* FNV-1a, taking 8 bytes at a time so that hashing whole frame buffers
+   every frame stays cheap.  */
+uint64_t perfstats_hash(uint64_t hash, const uint8_t *data, size_t size)
+{
+    uint64_t word;
+
+    while (size >= 8) {
+        memcpy(&word, data, 8);
+        hash = (hash ^ word) * PERFSTATS_HASH_PRIME;
+        data += 8;
+        size -= 8;
+    }
+    while (size > 0) {
+        hash = (hash ^ *data++) * PERFSTATS_HASH_PRIME;
+        size--;
+    }
+
+    return hash;
+}
+
+void perfstats_add_sound(const int16_t *samples, int nr)
+{
+    if (perfstats_enabled && nr > 0) {
+        perfstats_sound_hash = perfstats_hash(perfstats_sound_hash, (const uint8_t *)samples,
+                                              (size_t)nr * sizeof(int16_t));
+        perfstats_sound_samples += (unsigned long)nr;
+    }
+}
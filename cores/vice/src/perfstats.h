@@ -0,0 +1,77 @@
+/*
+ * perfstats.h - Time spent in emulation subsystems.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_PERFSTATS_H
+#define VICE_PERFSTATS_H
+
+#include <stddef.h>
+
+#include "tick.h"
+#include "types.h"
+
+/* Subsystems timed separately.  Everything else in a frame is the CPU
+   core and the chips it clocks directly.  Frames queued with
+   video_canvas_render_queue() are rendered on their own thread; their
+   render time is added when they are waited for, and only the waiting
+   is part of the emulation thread's time.  */
+enum {
+    PERFSTATS_VIDEO,        /* raster line drawing */
+    PERFSTATS_SOUND,        /* sound chip emulation */
+    PERFSTATS_DRIVE,        /* drive CPUs */
+    PERFSTATS_RENDER,       /* colour conversion and scaling of frames */
+    PERFSTATS_RENDER_WAIT,  /* waiting for the render thread */
+    PERFSTATS_NUM
+};
+
+/* Timing and hashing are off unless a benchmark turns them on.  */
+extern int perfstats_enabled;
+extern unsigned long perfstats_ticks[PERFSTATS_NUM];
+
+/* Hash of all sound samples generated while enabled.  */
+extern uint64_t perfstats_sound_hash;
+extern unsigned long perfstats_sound_samples;
+
+/* Drive CPU cycles skipped by the idle loop fast-forward.  */
+extern unsigned long perfstats_drive_idle_cycles;
+
+static inline unsigned long perfstats_begin(void)
+{
+    return perfstats_enabled ? tick_now() : 0;
+}
+
+static inline void perfstats_end(int subsystem, unsigned long start)
+{
+    if (perfstats_enabled) {
+        perfstats_ticks[subsystem] += tick_delta(start);
+    }
+}
+
+extern void perfstats_reset(void);
+extern void perfstats_add_sound(const int16_t *samples, int nr);
+
+/* Continue the 64 bit hash `hash' over `size' bytes; start with
+   PERFSTATS_HASH_INIT.  */
+#define PERFSTATS_HASH_INIT 0xcbf29ce484222325ULL
+extern uint64_t perfstats_hash(uint64_t hash, const uint8_t *data, size_t size);
+
+#endif
@@ -83,6 +83,7 @@
 #include "plus4tcbm.h"
 #include "plus4ui.h"
 #include "printer.h"
+#include "rewind.h"
 #include "rs232drv.h"
 #include "rushware_keypad.h"
 #include "sampler.h"
@@ -513,6 +514,10 @@ int machine_resources_init(void)
         return -1;
     }
 #endif
+    if (rewind_resources_init() < 0) {
+        init_resource_fail("rewind");
+        return -1;
+    }
 #ifdef DEBUG
     if (debug_resources_init() < 0) {
         init_resource_fail("debug");
@@ -566,6 +571,7 @@ void machine_resources_shutdown(void)
     joyport_bbrtc_resources_shutdown();
     tapeport_resources_shutdown();
     debugcart_resources_shutdown();
+    rewind_resources_shutdown();
 }
 
 /* Plus4-specific command-line option initialization.  */
@@ -692,6 +698,10 @@ int machine_cmdline_options_init(void)
         return -1;
     }
 #endif
+    if (rewind_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("rewind");
+        return -1;
+    }
 #ifdef DEBUG
     if (debug_cmdline_options_init() < 0) {
         init_cmdline_options_fail("debug");
@@ -935,6 +945,8 @@ static void machine_vsync_hook(void)
 
     screenshot_record();
 
+    rewind_vsync_hook();
+
     sub = clk_guard_prevent_overflow(maincpu_clk_guard);
 
     /* The drive has to deal both with our overflowing and its own one, so
@@ -1034,6 +1046,24 @@ int machine_read_snapshot(const char *name, int event_mode)
     return err;
 }
 
+int machine_write_snapshot_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode)
+{
+    int err = plus4_snapshot_write_memory(mem, save_roms, save_disks, event_mode);
+    if ((err < 0) && (snapshot_get_error() == SNAPSHOT_NO_ERROR)) {
+        snapshot_set_error(SNAPSHOT_CANNOT_WRITE_SNAPSHOT);
+    }
+    return err;
+}
+
+int machine_read_snapshot_memory(const uint8_t *data, size_t size, int event_mode)
+{
+    int err = plus4_snapshot_read_memory(data, size, event_mode);
+    if ((err < 0) && (snapshot_get_error() == SNAPSHOT_NO_ERROR)) {
+        snapshot_set_error(SNAPSHOT_CANNOT_READ_SNAPSHOT);
+    }
+    return err;
+}
+
 /* ------------------------------------------------------------------------- */
 
 int machine_autodetect_psid(const char *name)
@@ -33,6 +33,9 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "videoarch.h"
+
+#include "perfstats.h"
 #include "raster-cache.h"
 #include "raster-canvas.h"
 #include "raster-changes.h"
@@ -41,6 +44,7 @@
 #include "raster-sprite-status.h"
 #include "raster-sprite.h"
 #include "raster.h"
+#include "video.h"
 #include "viewport.h"
 
 
@@ -105,6 +109,20 @@ inline static int map_current_line_to_area(raster_t *raster)
             : raster->current_line);
 }
 
+/* Add [xs; xe] at the current line to the area to refresh, and flag the
+   line for the renderer.  */
+inline static void add_current_line_to_area(raster_t *raster,
+                                            unsigned int xs, unsigned int xe)
+{
+    unsigned int y = map_current_line_to_area(raster);
+    uint8_t *dirty_lines = raster->canvas->draw_buffer->dirty_lines;
+
+    add_line_to_area(raster->update_area, y, xs, xe);
+    if (dirty_lines != NULL) {
+        dirty_lines[y] = 1;
+    }
+}
+
 inline static void handle_blank_line_cached(raster_t *raster)
 {
     if (raster->dont_cache
@@ -121,9 +139,7 @@ inline static void handle_blank_line_cached(raster_t *raster)
 
         raster_line_draw_blank(raster, 0,
                                raster->geometry->screen_size.width - 1);
-        add_line_to_area(raster->update_area,
-                         map_current_line_to_area(raster),
-                         0, raster->geometry->screen_size.width - 1);
+        add_current_line_to_area(raster, 0, raster->geometry->screen_size.width - 1);
     }
 }
 
@@ -164,8 +180,7 @@ static void handle_blank_line(raster_t *raster)
 
             raster_changes_remove_all(border_changes);
 
-            add_line_to_area(raster->update_area, map_current_line_to_area(raster),
-                             0, raster->geometry->screen_size.width - 1);
+            add_current_line_to_area(raster, 0, raster->geometry->screen_size.width - 1);
         } else {
             handle_blank_line_cached(raster);
         }
@@ -390,8 +405,7 @@ static void handle_visible_line_with_cache(raster_t *raster)
     }
 
     if (needs_update) {
-        add_line_to_area(raster->update_area, map_current_line_to_area(raster),
-                         changed_start, changed_end);
+        add_current_line_to_area(raster, changed_start, changed_end);
     }
 
     cache->is_dirty = 0;
@@ -434,15 +448,13 @@ static void handle_visible_line_without_cache(raster_t *raster)
         cache->xsmooth_color = raster->xsmooth_color;
         cache->idle_background_color = raster->idle_background_color;
 
-        add_line_to_area(raster->update_area, map_current_line_to_area(raster),
-                         0, raster->geometry->screen_size.width - 1);
+        add_current_line_to_area(raster, 0, raster->geometry->screen_size.width - 1);
     } else {
         /* Still do some minimal caching anyway.  */
         /* Only update the part between the borders.  */
-        add_line_to_area(raster->update_area, map_current_line_to_area(raster),
-                         geometry->gfx_position.x,
-                         geometry->gfx_position.x
-                         + geometry->gfx_size.width - 1);
+        add_current_line_to_area(raster, geometry->gfx_position.x,
+                                 geometry->gfx_position.x
+                                 + geometry->gfx_size.width - 1);
     }
 }
 
@@ -625,8 +637,7 @@ static void handle_visible_line_with_changes(raster_t *raster)
     /* Do not cache this line at all.  */
     raster->cache[raster->current_line].is_dirty = 1;
 
-    add_line_to_area(raster->update_area, map_current_line_to_area(raster),
-                     0, raster->geometry->screen_size.width - 1);
+    add_current_line_to_area(raster, 0, raster->geometry->screen_size.width - 1);
 }
 
 inline static void handle_visible_line(raster_t *raster)
@@ -650,6 +661,8 @@ inline static void handle_visible_line(raster_t *raster)
 
 void raster_line_emulate(raster_t *raster)
 {
+    unsigned long perfstats_start = perfstats_begin();
+
     raster_draw_buffer_ptr_update(raster);
 
     /* Emulate the vertical blank flip-flops.  (Well, sort of.)  */
@@ -666,6 +679,22 @@ void raster_line_emulate(raster_t *raster)
         || (raster->current_line <= raster->geometry->last_displayed_line - raster->geometry->screen_size.height
             && raster->geometry->screen_size.height <= raster->geometry->last_displayed_line)
         ) {
+        uint8_t *dirty_line = NULL;
+
+        /* Lines are redrawn whether they changed or not while the cache is
+           off, so keep the old contents of a line the renderer has seen to
+           check against afterwards.  */
+        if (raster->canvas->draw_buffer->dirty_lines != NULL
+            && raster->previous_line != NULL) {
+            dirty_line = &raster->canvas->draw_buffer->dirty_lines[map_current_line_to_area(raster)];
+            if (*dirty_line) {
+                dirty_line = NULL;
+            } else {
+                memcpy(raster->previous_line, raster->draw_buffer_ptr,
+                       raster->geometry->screen_size.width);
+            }
+        }
+
         /* handle lines with no border or with changes that may affect
            the border as visible lines */
         if (raster->can_disable_border && (raster->border_disable || raster->changes->have_on_this_line)) {
@@ -679,6 +708,12 @@ void raster_line_emulate(raster_t *raster)
             }
         }
 
+        if (dirty_line != NULL && *dirty_line
+            && memcmp(raster->previous_line, raster->draw_buffer_ptr,
+                      raster->geometry->screen_size.width) == 0) {
+            *dirty_line = 0;
+        }
+
         if (++raster->num_cached_lines == (1
                                            + raster->geometry->last_displayed_line
                                            - raster->geometry->first_displayed_line)) {
@@ -735,4 +770,6 @@ void raster_line_emulate(raster_t *raster)
     }
 
     raster->blank_this_line = 0;
+
+    perfstats_end(PERFSTATS_VIDEO, perfstats_start);
 }
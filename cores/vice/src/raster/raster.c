@@ -85,6 +85,9 @@ static int raster_draw_buffer_alloc(video_canvas_t *canvas,
 
 static void raster_draw_buffer_free(video_canvas_t *canvas)
 {
+    lib_free(canvas->draw_buffer->dirty_lines);
+    canvas->draw_buffer->dirty_lines = NULL;
+
     if (canvas->video_draw_buffer_callback) {
         canvas->video_draw_buffer_callback->draw_buffer_free(canvas, canvas->draw_buffer->draw_buffer);
         return;
@@ -144,6 +147,10 @@ static int raster_realize_frame_buffer(raster_t *raster)
 
         raster_draw_buffer_clear(raster->canvas, 0, fb_width, fb_height,
                                  fb_pitch);
+
+        /* nothing rendered from the new buffer yet */
+        raster->canvas->draw_buffer->dirty_lines = lib_malloc(fb_height);
+        memset(raster->canvas->draw_buffer->dirty_lines, 1, fb_height);
     }
 
     raster->fake_draw_buffer_line = lib_realloc(raster->fake_draw_buffer_line,
@@ -151,6 +158,8 @@ static int raster_realize_frame_buffer(raster_t *raster)
 
     memset(raster->fake_draw_buffer_line, 0, fb_width);
 
+    raster->previous_line = lib_realloc(raster->previous_line, fb_width);
+
     return 0;
 }
 
@@ -254,6 +263,7 @@ int raster_init(raster_t *raster,
     raster->num_cached_lines = 0;
 
     raster->fake_draw_buffer_line = NULL;
+    raster->previous_line = NULL;
 
     raster->can_disable_border = 0;
     raster->border_disable = 0;
@@ -581,6 +591,7 @@ void raster_shutdown(raster_t *raster)
     raster_changes_shutdown(raster);
 
     lib_free(raster->fake_draw_buffer_line);
+    lib_free(raster->previous_line);
     raster_canvas_shutdown(raster);
 
 
@@ -84,6 +84,10 @@ struct raster_s {
        checking without drawing to the real frame buffer.  */
     uint8_t *fake_draw_buffer_line;
 
+    /* The current line as it was before it was redrawn, to tell the
+       renderer whether it really changed.  */
+    uint8_t *previous_line;
+
     /* Smooth scroll values for the graphics (not the whole screen).  */
     int xsmooth, ysmooth, sprite_xsmooth;
 
@@ -0,0 +1,596 @@
+/*
+ * render-benchmark.c - Measure the palette expanding renderers.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: render-benchmark [frames [threads]]
+
+   Renders a PAL sized C64 frame with every 1x1, 1x2, 2x2 and 2x4 renderer
+   at 8, 16, 24 and 32 bits per pixel, with the plain C palette expansion
+   and with each SIMD version this CPU supports, and with the 32 bit PAL
+   and CRT emulation renderers, whose "C" column is their per pixel code.
+   It reports the time per frame and compares every output byte against
+   the C version, once with 16 colours and once with 128 (as TED uses),
+   which takes the per pixel path of the SIMD palette expansion.  The
+   target starts at an odd x, so the 2x renderers also draw their half
+   pixels.
+
+   Then it renders the 32 bit frames in horizontal bands on 1 up to
+   `threads' threads (default 4) with the fastest palette expansion, and
+   reports the time per frame, the speedup and whether the output matches
+   the single thread one.
+
+   Last it checks video_render_frame_dirty() for each render mode: it
+   changes a few random source lines per frame, flags them like the raster
+   does, renders only those, and compares the target with a full frame
+   rendered by video_render_frame().  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "render1x1.h"
+#include "render1x1pal.h"
+#include "render1x2.h"
+#include "render1x2crt.h"
+#include "render2x2.h"
+#include "render2x2pal.h"
+#include "render2x4.h"
+#include "render2x4crt.h"
+#include "rendersimd.h"
+#include "log.h"
+#include "machine.h"
+#include "sound.h"
+#include "types.h"
+#include "video-color.h"
+#include "video-render-bands.h"
+#include "video-render.h"
+#include "video.h"
+#include "viewport.h"
+
+#define BENCH_WIDTH     384
+#define BENCH_HEIGHT    272
+#define BENCH_XT        1
+#define BENCH_PITCHS    (BENCH_WIDTH + 16)
+#define BENCH_PITCHT    (BENCH_WIDTH * 2 * 4 + 64)
+#define BENCH_TRG_SIZE  (BENCH_PITCHT * (BENCH_HEIGHT * 4 + 8))
+
+/* Gamma tables for the PAL and CRT renderers, which video-color.c fills
+   from the palette in the emulator.  */
+uint32_t gamma_red[256 * 3];
+uint32_t gamma_grn[256 * 3];
+uint32_t gamma_blu[256 * 3];
+uint32_t gamma_red_fac[256 * 3 * 2];
+uint32_t gamma_grn_fac[256 * 3 * 2];
+uint32_t gamma_blu_fac[256 * 3 * 2];
+uint32_t alpha = 0xff000000;
+
+/* Stubs for lib.c, video-render-bands.c, and video-render.c and the
+   video-sound.c it pulls in.  */
+int machine_class = VICE_MACHINE_C64;
+
+uint16_t sound_chip_register(sound_chip_t *chip)
+{
+    return 0;
+}
+
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+int log_message(log_t log, const char *format, ...)
+{
+    return 0;
+}
+
+int log_debug(const char *format, ...)
+{
+    return 0;
+}
+
+typedef void (*bench_render_t)(const video_render_color_tables_t *color_tab,
+                               const uint8_t *src, uint8_t *trg,
+                               unsigned int width, const unsigned int height,
+                               const unsigned int xs, const unsigned int ys,
+                               const unsigned int xt, const unsigned int yt,
+                               const unsigned int pitchs, const unsigned int pitcht,
+                               const unsigned int doublescan,
+                               video_render_config_t *config);
+
+/* The 1x1 renderers take no doublescan and config.  */
+#define BENCH_1X1(depth)                                                     \
+static void bench_##depth##_1x1(const video_render_color_tables_t *color_tab, \
+                                const uint8_t *src, uint8_t *trg,            \
+                                unsigned int width, const unsigned int height, \
+                                const unsigned int xs, const unsigned int ys, \
+                                const unsigned int xt, const unsigned int yt, \
+                                const unsigned int pitchs,                   \
+                                const unsigned int pitcht,                   \
+                                const unsigned int doublescan,               \
+                                video_render_config_t *config)               \
+{                                                                            \
+    render_##depth##_1x1_04(color_tab, src, trg, width, height,              \
+                            xs, ys, xt, yt, pitchs, pitcht);                 \
+}
+
+BENCH_1X1(08)
+BENCH_1X1(16)
+BENCH_1X1(24)
+BENCH_1X1(32)
+
+static viewport_t bench_viewport;
+
+/* The PAL renderers take a non-const colour table, the 2x ones a viewport.  */
+static void bench_32_1x1_pal(const video_render_color_tables_t *color_tab,
+                             const uint8_t *src, uint8_t *trg,
+                             unsigned int width, const unsigned int height,
+                             const unsigned int xs, const unsigned int ys,
+                             const unsigned int xt, const unsigned int yt,
+                             const unsigned int pitchs, const unsigned int pitcht,
+                             const unsigned int doublescan,
+                             video_render_config_t *config)
+{
+    render_32_1x1_pal(&config->color_tables, src, trg, width, height,
+                      xs, ys, xt, yt, pitchs, pitcht, config);
+}
+
+#define BENCH_YUV(name)                                                      \
+static void bench_##name(const video_render_color_tables_t *color_tab,      \
+                         const uint8_t *src, uint8_t *trg,                   \
+                         unsigned int width, const unsigned int height,      \
+                         const unsigned int xs, const unsigned int ys,       \
+                         const unsigned int xt, const unsigned int yt,       \
+                         const unsigned int pitchs, const unsigned int pitcht, \
+                         const unsigned int doublescan,                      \
+                         video_render_config_t *config)                      \
+{                                                                            \
+    render_##name(&config->color_tables, src, trg, width, height,            \
+                  xs, ys, xt, yt, pitchs, pitcht, &bench_viewport, config);  \
+}
+
+BENCH_YUV(32_2x2_pal)
+BENCH_YUV(32_1x2_crt)
+BENCH_YUV(32_2x4_crt)
+
+typedef struct bench_mode_s {
+    const char *name;
+    int lines;  /* target lines per source line */
+    int yuv;    /* PAL or CRT renderer: 32 bit only, needs source pixels around */
+    bench_render_t render[4];
+} bench_mode_t;
+
+static const bench_mode_t bench_modes[] = {
+    { "1x1", 1, 0, { bench_08_1x1, bench_16_1x1, bench_24_1x1, bench_32_1x1 } },
+    { "1x2", 2, 0, { render_08_1x2_04, render_16_1x2_04, render_24_1x2_04, render_32_1x2_04 } },
+    { "2x2", 2, 0, { render_08_2x2_04, render_16_2x2_04, render_24_2x2_04, render_32_2x2_04 } },
+    { "2x4", 4, 0, { render_08_2x4_04, render_16_2x4_04, render_24_2x4_04, render_32_2x4_04 } },
+    { "1x1 pal", 1, 1, { NULL, NULL, NULL, bench_32_1x1_pal } },
+    { "2x2 pal", 2, 1, { NULL, NULL, NULL, bench_32_2x2_pal } },
+    { "1x2 crt", 2, 1, { NULL, NULL, NULL, bench_32_1x2_crt } },
+    { "2x4 crt", 4, 1, { NULL, NULL, NULL, bench_32_2x4_crt } }
+};
+
+static uint8_t bench_src[BENCH_PITCHS * BENCH_HEIGHT];
+static uint8_t *bench_reference;
+static uint8_t *bench_trg;
+static video_render_config_t bench_config;
+static int bench_errors;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* A border, some text-like 8x8 cells and random colours in the table.  */
+static void bench_make_frame(unsigned int colors)
+{
+    unsigned int seed = 1;
+    int x, y, i;
+
+    for (y = 0; y < BENCH_HEIGHT; y++) {
+        for (x = 0; x < BENCH_PITCHS; x++) {
+            uint8_t c = 14;
+
+            if (x >= 32 && x < 352 && y >= 36 && y < 236) {
+                seed = seed * 1103515245 + 12345;
+                c = ((seed >> 16) & 3) ? 6 : (uint8_t)((x / 8 + y / 8) % colors);
+            }
+            bench_src[y * BENCH_PITCHS + x] = c;
+        }
+    }
+    for (i = 0; i < 256; i++) {
+        seed = seed * 1103515245 + 12345;
+        bench_config.color_tables.physical_colors[i] = seed ^ (seed << 16);
+    }
+
+    /* YCbCr tables scaled as video-color.c does with 50% blur, and gamma
+       tables with arbitrary contents.  */
+    for (i = 0; i < 256; i++) {
+        video_render_color_tables_t *t = &bench_config.color_tables;
+        int32_t luma, cb, cr;
+
+        seed = seed * 1103515245 + 12345;
+        luma = (seed >> 8) & 0xff;
+        cb = (int32_t)((seed >> 16) % 193) - 96;
+        cr = (int32_t)((seed >> 24) % 193) - 96;
+        t->ytablel[i] = luma * 256 * 32;
+        t->ytableh[i] = luma * 256 * 191;
+        t->cbtable[i] = cb * 256;
+        t->crtable[i] = cr * 256;
+        t->cbtable_odd[i] = -cb * 448;
+        t->crtable_odd[i] = -cr * 448;
+        t->ycbcrtable[i * 4 + 0] = t->ycbcrtable_odd[i * 4 + 0] = t->ytablel[i];
+        t->ycbcrtable[i * 4 + 1] = t->ycbcrtable_odd[i * 4 + 1] = t->ytableh[i];
+        t->ycbcrtable[i * 4 + 2] = t->cbtable[i];
+        t->ycbcrtable[i * 4 + 3] = t->crtable[i];
+        t->ycbcrtable_odd[i * 4 + 2] = t->cbtable_odd[i];
+        t->ycbcrtable_odd[i * 4 + 3] = t->crtable_odd[i];
+    }
+    for (i = 0; i < 256 * 3 * 2; i++) {
+        seed = seed * 1103515245 + 12345;
+        if (i < 256 * 3) {
+            gamma_red[i] = seed & 0xff0000;
+            gamma_grn[i] = seed & 0xff00;
+            gamma_blu[i] = seed & 0xff;
+        }
+        gamma_red_fac[i] = (seed << 4) & 0xff0000;
+        gamma_grn_fac[i] = (seed << 4) & 0xff00;
+        gamma_blu_fac[i] = (seed >> 4) & 0xff;
+    }
+}
+
+static void bench_render(const bench_mode_t *mode, int d, uint8_t *trg)
+{
+    unsigned int scale = mode->name[0] == '2' ? 2 : 1;
+
+    if (mode->yuv) {
+        /* these read two pixels left and right and the line above and
+           below, and write the scanline above the first line */
+        mode->render[d](&bench_config.color_tables, bench_src,
+                        trg + BENCH_PITCHT * 4,
+                        (BENCH_WIDTH - 8) * scale - BENCH_XT,
+                        (BENCH_HEIGHT - 2) * mode->lines, 2, 1, BENCH_XT, 0,
+                        BENCH_PITCHS, BENCH_PITCHT, 1, &bench_config);
+    } else {
+        mode->render[d](&bench_config.color_tables, bench_src, trg,
+                        BENCH_WIDTH * scale - BENCH_XT,
+                        BENCH_HEIGHT * mode->lines, 0, 0, BENCH_XT, 0,
+                        BENCH_PITCHS, BENCH_PITCHT, 1, &bench_config);
+    }
+}
+
+/* Render `frames' frames with every level and compare the output.  */
+static void bench_mode(const bench_mode_t *mode, int d, int frames,
+                       const int *levels, int num_levels)
+{
+    static const int depths[] = { 8, 16, 24, 32 };
+    double base = 0.0;
+    int l, f;
+
+    if (mode->render[d] == NULL) {
+        return;
+    }
+
+    printf("%-7s %2d", mode->name, depths[d]);
+    for (l = 0; l < num_levels; l++) {
+        double start, ms;
+
+        render_simd_select(levels[l]);
+        memset(bench_trg, 0x55, BENCH_TRG_SIZE);
+        bench_render(mode, d, bench_trg);
+        if (l == 0) {
+            memcpy(bench_reference, bench_trg, BENCH_TRG_SIZE);
+        } else if (memcmp(bench_reference, bench_trg, BENCH_TRG_SIZE) != 0) {
+            bench_errors++;
+            printf(" %9s", "DIFFERS");
+            continue;
+        }
+
+        start = bench_now();
+        for (f = 0; f < frames; f++) {
+            bench_render(mode, d, bench_trg);
+        }
+        ms = (bench_now() - start) * 1000.0 / frames;
+        if (l == 0) {
+            base = ms;
+            printf(" %9.3f", ms);
+        } else {
+            printf(" %6.3f %4.1fx", ms, base / ms);
+        }
+    }
+    printf("\n");
+}
+
+/* The renderer video_render_bands() calls for each band.  */
+static const bench_mode_t *bench_band_mode;
+
+static void bench_band(video_render_config_t *config, uint8_t *src, uint8_t *trg,
+                       int width, int height, int xs, int ys, int xt, int yt,
+                       int pitchs, int pitcht, int depth, viewport_t *viewport)
+{
+    bench_band_mode->render[3](&config->color_tables, src, trg, width, height,
+                               xs, ys, xt, yt, pitchs, pitcht, 1, config);
+}
+
+static void bench_render_bands(const bench_mode_t *mode, uint8_t *trg)
+{
+    unsigned int scale = mode->name[0] == '2' ? 2 : 1;
+
+    bench_band_mode = mode;
+    if (mode->yuv) {
+        if (video_render_bands(bench_band, &bench_config, bench_src,
+                               trg + BENCH_PITCHT * 4,
+                               (BENCH_WIDTH - 8) * scale - BENCH_XT,
+                               (BENCH_HEIGHT - 2) * mode->lines, 2, 1, BENCH_XT, 0,
+                               BENCH_PITCHS, BENCH_PITCHT, 32, &bench_viewport,
+                               mode->lines) == 0) {
+            return;
+        }
+    } else {
+        if (video_render_bands(bench_band, &bench_config, bench_src, trg,
+                               BENCH_WIDTH * scale - BENCH_XT,
+                               BENCH_HEIGHT * mode->lines, 0, 0, BENCH_XT, 0,
+                               BENCH_PITCHS, BENCH_PITCHT, 32, &bench_viewport,
+                               mode->lines) == 0) {
+            return;
+        }
+    }
+    bench_render(mode, 3, trg);
+}
+
+/* Render `frames' 32 bit frames on 1 to `threads' threads.  */
+static void bench_threads(const bench_mode_t *mode, int frames, int threads)
+{
+    double base = 0.0;
+    int t, f;
+
+    printf("%-7s", mode->name);
+    for (t = 1; t <= threads; t++) {
+        double start, ms;
+
+        if (video_render_bands_set_threads(t) != t) {
+            break;
+        }
+        memset(bench_trg, 0x55, BENCH_TRG_SIZE);
+        bench_render_bands(mode, bench_trg);
+        if (t == 1) {
+            memcpy(bench_reference, bench_trg, BENCH_TRG_SIZE);
+        } else if (memcmp(bench_reference, bench_trg, BENCH_TRG_SIZE) != 0) {
+            bench_errors++;
+            printf(" %10s", "DIFFERS");
+            continue;
+        }
+
+        start = bench_now();
+        for (f = 0; f < frames; f++) {
+            bench_render_bands(mode, bench_trg);
+        }
+        ms = (bench_now() - start) * 1000.0 / frames;
+        if (t == 1) {
+            base = ms;
+            printf(" %10.3f", ms);
+        } else {
+            printf(" %5.3f %3.1fx", ms, base / ms);
+        }
+    }
+    printf("\n");
+}
+
+typedef struct bench_dirty_mode_s {
+    const char *name;
+    int rendermode;
+    int filter;
+    int scale2x;
+    int lines;  /* target lines per source line */
+    int scale;  /* target pixels per source pixel */
+} bench_dirty_mode_t;
+
+static const bench_dirty_mode_t bench_dirty_modes[] = {
+    { "1x1", VIDEO_RENDER_RGB_1X1, VIDEO_FILTER_NONE, 0, 1, 1 },
+    { "1x2", VIDEO_RENDER_RGB_1X2, VIDEO_FILTER_NONE, 0, 2, 1 },
+    { "2x2", VIDEO_RENDER_RGB_2X2, VIDEO_FILTER_NONE, 0, 2, 2 },
+    { "scale2x", VIDEO_RENDER_RGB_2X2, VIDEO_FILTER_SCALE2X, 1, 2, 2 },
+    { "1x1 pal", VIDEO_RENDER_PAL_1X1, VIDEO_FILTER_CRT, 0, 1, 1 },
+    { "2x2 pal", VIDEO_RENDER_PAL_2X2, VIDEO_FILTER_CRT, 0, 2, 2 },
+    { "1x1 crt", VIDEO_RENDER_CRT_1X1, VIDEO_FILTER_CRT, 0, 1, 1 },
+    { "1x2 crt", VIDEO_RENDER_CRT_1X2, VIDEO_FILTER_CRT, 0, 2, 1 },
+    { "2x2 crt", VIDEO_RENDER_CRT_2X2, VIDEO_FILTER_CRT, 0, 2, 2 },
+    { "2x4 crt", VIDEO_RENDER_CRT_2X4, VIDEO_FILTER_CRT, 0, 4, 2 }
+};
+
+/* Change up to three runs of source lines and flag the ones that changed,
+   as the raster does.  */
+static void bench_change_lines(unsigned int *seed, uint8_t *dirty)
+{
+    int runs, r, y, x, n;
+
+    *seed = *seed * 1103515245 + 12345;
+    runs = 1 + (*seed >> 16) % 3;
+    for (r = 0; r < runs; r++) {
+        *seed = *seed * 1103515245 + 12345;
+        y = (*seed >> 8) % BENCH_HEIGHT;
+        n = 1 + (*seed >> 20) % 8;
+        for (; n > 0 && y < BENCH_HEIGHT; n--, y++) {
+            uint8_t *line = bench_src + y * BENCH_PITCHS;
+
+            *seed = *seed * 1103515245 + 12345;
+            x = (*seed >> 8) % BENCH_PITCHS;
+            if (line[x] != (uint8_t)((*seed >> 20) & 15)) {
+                line[x] = (uint8_t)((*seed >> 20) & 15);
+                dirty[y] = 1;
+            }
+        }
+    }
+}
+
+/* Render `frames' changing frames with video_render_frame_dirty(), starting
+   on an even and an odd target line, and compare each with a full frame.
+   The source starts at x 4: the PAL renderers read two pixels to the left,
+   and one more when they move an odd target x back to an even one.  */
+static void bench_dirty(const bench_dirty_mode_t *mode, int frames,
+                        uint8_t *trg_full)
+{
+    static uint8_t dirty[BENCH_HEIGHT];
+    unsigned int seed = 1;
+    int width = (BENCH_WIDTH - 10) * mode->scale - BENCH_XT;
+    int height = (BENCH_HEIGHT - 2) * mode->lines;
+    int yt, f, failed = 0;
+    unsigned long rendered = 0, total = 0;
+
+    bench_config.rendermode = mode->rendermode;
+    bench_config.filter = mode->filter;
+    bench_config.scale2x = mode->scale2x;
+    bench_make_frame(16);
+
+    printf("%-7s", mode->name);
+    for (yt = 0; yt < 2; yt++) {
+        memset(bench_trg, 0x55, BENCH_TRG_SIZE);
+        memset(trg_full, 0x55, BENCH_TRG_SIZE);
+        memset(dirty, 0, sizeof(dirty));
+        video_render_invalidate(&bench_config);
+        bench_config.lines_rendered = 0;
+        bench_config.lines_skipped = 0;
+
+        for (f = 0; f <= frames && !failed; f++) {
+            if (f > 0) {
+                bench_change_lines(&seed, dirty);
+            }
+            video_render_frame_dirty(&bench_config, bench_src,
+                                     bench_trg + BENCH_PITCHT * 4, width,
+                                     height, 4, 1, BENCH_XT, yt,
+                                     BENCH_PITCHS, BENCH_PITCHT, 32,
+                                     &bench_viewport, dirty, BENCH_HEIGHT);
+            memset(dirty, 0, sizeof(dirty));
+            video_render_frame(&bench_config, bench_src,
+                               trg_full + BENCH_PITCHT * 4, width, height,
+                               4, 1, BENCH_XT, yt, BENCH_PITCHS, BENCH_PITCHT,
+                               32, &bench_viewport);
+            if (memcmp(bench_trg, trg_full, BENCH_TRG_SIZE) != 0) {
+                printf(" yt %d frame %d DIFFERS", yt, f);
+                failed = 1;
+            }
+        }
+        rendered += bench_config.lines_rendered;
+        total += bench_config.lines_rendered + bench_config.lines_skipped;
+    }
+    if (failed) {
+        bench_errors++;
+    } else {
+        printf(" same, %4.1f%% of the lines rendered", rendered * 100.0 / total);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned int palettes[] = { 16, 128 };
+    int frames = argc > 1 ? atoi(argv[1]) : 200;
+    int threads = argc > 2 ? atoi(argv[2]) : 4;
+    int levels[4];
+    int num_levels = 0;
+    int level, l, m, d, p;
+
+    if (frames < 1 || threads < 1 || threads > VIDEO_RENDER_BANDS_MAX) {
+        fprintf(stderr, "Usage: %s [frames [threads]]\n", argv[0]);
+        return 1;
+    }
+
+    /* The C version first, then every level this CPU runs.  */
+    levels[num_levels++] = RENDER_SIMD_NONE;
+    for (level = RENDER_SIMD_SSSE3; level <= RENDER_SIMD_NEON; level++) {
+        if (render_simd_select(level) == level) {
+            levels[num_levels++] = level;
+        }
+    }
+
+    bench_reference = malloc(BENCH_TRG_SIZE);
+    bench_trg = malloc(BENCH_TRG_SIZE);
+    bench_config.readable = 0;
+    bench_config.video_resources.pal_oddlines_offset = 1250;
+    bench_config.video_resources.pal_scanlineshade = 667;
+    bench_viewport.first_line = 0;
+    bench_viewport.last_line = BENCH_HEIGHT - 1;
+
+    for (p = 0; p < 2; p++) {
+        bench_make_frame(palettes[p]);
+        printf("%d frames of %dx%d, %u colours, ms per frame\n",
+               frames, BENCH_WIDTH, BENCH_HEIGHT, palettes[p]);
+        printf("mode    bpp");
+        for (l = 0; l < num_levels; l++) {
+            printf(" %*s", l ? 12 : 9, render_simd_name(levels[l]));
+        }
+        printf("\n");
+        for (m = 0; m < (int)(sizeof(bench_modes) / sizeof(bench_modes[0])); m++) {
+            for (d = 0; d < 4; d++) {
+                bench_mode(&bench_modes[m], d, frames, levels, num_levels);
+            }
+        }
+    }
+
+    render_simd_select(levels[num_levels - 1]);
+    printf("%d frames of %dx%d, 32 bpp, %s, ms per frame on 1 to %d threads\n",
+           frames, BENCH_WIDTH, BENCH_HEIGHT, render_simd_name(levels[num_levels - 1]),
+           threads);
+    for (m = 0; m < (int)(sizeof(bench_modes) / sizeof(bench_modes[0])); m++) {
+        bench_threads(&bench_modes[m], frames, threads);
+    }
+
+    video_render_1x2_init();
+    video_render_2x2_init();
+    video_render_pal_init();
+    video_render_crt_init();
+    bench_config.doublescan = 1;
+    bench_viewport.crt_type = 1;    /* PAL */
+    printf("%d changing frames rendered by video_render_frame_dirty()\n", frames);
+    for (m = 0; m < (int)(sizeof(bench_dirty_modes) / sizeof(bench_dirty_modes[0])); m++) {
+        bench_dirty(&bench_dirty_modes[m], frames, bench_reference);
+    }
+    video_render_bands_shutdown();
+
+    free(bench_reference);
+    free(bench_trg);
+
+    if (bench_errors) {
+        printf("%d renderers differ from the C, single thread or full frame version\n",
+               bench_errors);
+        return 1;
+    }
+    return 0;
+}
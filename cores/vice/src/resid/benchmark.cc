@@ -0,0 +1,256 @@
+//  ---------------------------------------------------------------------------
+//  This file is part of reSID, a MOS6581 SID emulator engine.
+//  Copyright (C) 2010  Dag Lem <resid@nimrod.no>
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//  ---------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// Micro-benchmark for the SID sampling methods.
+//
+// A fixed three voice patch is clocked for a number of emulated seconds with
+// every sampling method and every FIR convolution kernel supported by the
+// CPU. For each run the time per output sample and a checksum of the output
+// is reported; all kernels of one sampling method must yield the same
+// checksum.
+//
+// Furthermore the block clocking engine, SID::clock(n, out), is compared
+// sample for sample against single cycle clocking over a pseudo random
+// register write stream, for both chip models.
+//
+// Usage: resid-benchmark [seconds] [sample_freq]
+// ----------------------------------------------------------------------------
+
+#include "sid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define RESID_BENCHMARK_TSC 1
+#endif
+
+using namespace reSID;
+
+static const char* method_names[] = {
+  "fast", "interpolate", "resample", "resample_fastmem"
+};
+
+// A pulse, a sawtooth with filter, and a ring modulated triangle.
+static const reg8 patch[][2] = {
+  { 0x00, 0x25 }, { 0x01, 0x11 }, { 0x02, 0x00 }, { 0x03, 0x08 },
+  { 0x05, 0x09 }, { 0x06, 0xa9 }, { 0x04, 0x41 },
+  { 0x07, 0x6a }, { 0x08, 0x22 }, { 0x0c, 0x1a }, { 0x0d, 0xc8 },
+  { 0x0b, 0x21 },
+  { 0x0e, 0x37 }, { 0x0f, 0x07 }, { 0x13, 0x00 }, { 0x14, 0xf0 },
+  { 0x12, 0x15 },
+  { 0x15, 0x03 }, { 0x16, 0x40 }, { 0x17, 0xf2 }, { 0x18, 0x1f }
+};
+
+// Set up a chip the way VICE does (see sid/resid.cc); some of the filter
+// state is only initialized here.
+static void setup(SID& sid, chip_model model)
+{
+  sid.set_chip_model(model);
+  sid.set_voice_mask(0x07);
+  sid.input(0);
+  sid.enable_filter(true);
+  sid.adjust_filter_bias(0.5);
+  sid.enable_external_filter(true);
+}
+
+static double now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static unsigned long long cycles()
+{
+#if RESID_BENCHMARK_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static unsigned run(sampling_method method, double clock_freq,
+                    double sample_freq, int seconds, int& samples,
+                    double& elapsed, unsigned long long& tsc)
+{
+  SID sid;
+  short buf[4096];
+  unsigned checksum = 0;
+
+  setup(sid, MOS6581);
+  sid.set_sampling_parameters(clock_freq, method, sample_freq);
+  for (unsigned i = 0; i < sizeof(patch)/sizeof(patch[0]); i++) {
+    sid.write(patch[i][0], patch[i][1]);
+  }
+
+  samples = 0;
+  elapsed = now();
+  tsc = cycles();
+
+  // Clock one frame at a time, and sweep the filter cutoff per frame.
+  int frames = seconds*50;
+  for (int f = 0; f < frames; f++) {
+    cycle_count delta_t = int(clock_freq/50);
+    sid.write(0x16, (f*3) & 0xff);
+    while (delta_t) {
+      int n = sid.clock(delta_t, buf, sizeof(buf)/sizeof(buf[0]));
+      for (int i = 0; i < n; i++) {
+        checksum = checksum*31 + (unsigned short)buf[i];
+      }
+      samples += n;
+    }
+  }
+
+  tsc = cycles() - tsc;
+  elapsed = now() - elapsed;
+
+  return checksum;
+}
+
+// Deterministic pseudo random numbers for the register write stream.
+static unsigned lcg(unsigned& seed)
+{
+  seed = seed*1103515245 + 12345;
+  return (seed >> 8) & 0xffffff;
+}
+
+// Random writes, weighted towards the control registers so that gate, sync,
+// ring modulation, test bit and combined waveforms are all exercised.
+static void random_write(SID& sid, unsigned& seed)
+{
+  static const reg8 control[] = { 0x04, 0x0b, 0x12 };
+  unsigned r = lcg(seed);
+  reg8 value = (r >> 8) & 0xff;
+  if (r & 1) {
+    sid.write(control[(r >> 1) % 3], value);
+  }
+  else {
+    sid.write((r >> 1) % 0x19, value);
+  }
+}
+
+static bool verify_block(chip_model model, int writes, double& t_cycle,
+                         double& t_block)
+{
+  SID sid_cycle, sid_block;
+  static short out_cycle[4096], out_block[4096];
+  unsigned seed_cycle = 1, seed_block = 1, seed_delta = 2;
+  bool ok = true;
+
+  setup(sid_cycle, model);
+  setup(sid_block, model);
+  t_cycle = t_block = 0;
+
+  for (int w = 0; w < writes && ok; w++) {
+    random_write(sid_cycle, seed_cycle);
+    random_write(sid_block, seed_block);
+
+    cycle_count n = 1 + lcg(seed_delta) % 4096;
+
+    double t = now();
+    for (int i = 0; i < n; i++) {
+      sid_cycle.clock();
+      int o = sid_cycle.output();
+      out_cycle[i] = o > 32767 ? 32767 : o < -32768 ? -32768 : o;
+    }
+    t_cycle += now() - t;
+
+    t = now();
+    sid_block.clock(n, out_block);
+    t_block += now() - t;
+
+    for (int i = 0; i < n; i++) {
+      if (out_cycle[i] != out_block[i]) {
+        printf("block clocking mismatch at write %d, cycle %d: %d != %d\n",
+               w, i, out_cycle[i], out_block[i]);
+        ok = false;
+        break;
+      }
+    }
+    for (reg8 r = 0x19; r <= 0x1c; r++) {
+      if (ok && sid_cycle.read(r) != sid_block.read(r)) {
+        printf("block clocking mismatch at write %d, register %02x\n", w, r);
+        ok = false;
+      }
+    }
+  }
+
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  int seconds = argc > 1 ? atoi(argv[1]) : 10;
+  double sample_freq = argc > 2 ? atof(argv[2]) : 48000;
+  const double clock_freq = 985248;
+
+  const char* kernels[8];
+  int kernel_count = SID::get_convolution_kernels(kernels, 8);
+  int failed = 0;
+
+  printf("%d s of audio at %.0f Hz, default kernel %s\n",
+         seconds, sample_freq, SID::get_convolution_kernel());
+  for (int model = MOS6581; model <= MOS8580; model++) {
+    double t_cycle, t_block;
+    bool ok = verify_block(chip_model(model), seconds*200, t_cycle, t_block);
+    printf("block clocking %s: %s, %.2fx single cycle speed\n",
+           model == MOS6581 ? "6581" : "8580", ok ? "identical" : "FAILED",
+           t_cycle/t_block);
+    if (!ok) {
+      failed = 1;
+    }
+  }
+
+  printf("%-18s %-8s %12s %12s %10s\n",
+         "method", "kernel", "ns/sample", "cyc/sample", "checksum");
+
+  for (int m = SAMPLE_FAST; m <= SAMPLE_RESAMPLE_FASTMEM; m++) {
+    sampling_method method = sampling_method(m);
+    bool resampling =
+      method == SAMPLE_RESAMPLE || method == SAMPLE_RESAMPLE_FASTMEM;
+    unsigned reference = 0;
+
+    // The kernel only matters for the resampling methods.
+    for (int k = 0; k < (resampling ? kernel_count : 1); k++) {
+      int samples;
+      double elapsed;
+      unsigned long long tsc;
+
+      SID::set_convolution_kernel(kernels[k]);
+      unsigned checksum = run(method, clock_freq, sample_freq, seconds,
+                              samples, elapsed, tsc);
+      if (k == 0) {
+        reference = checksum;
+      }
+
+      printf("%-18s %-8s %12.1f %12.1f %08x%s\n",
+             method_names[m], resampling ? kernels[k] : "-",
+             elapsed*1e9/samples, double(tsc)/samples, checksum,
+             checksum != reference ? " MISMATCH" : "");
+      if (checksum != reference) {
+        failed = 1;
+      }
+    }
+  }
+
+  return failed;
+}
@@ -60,6 +60,13 @@ protected:
 
   void state_change();
 
+  // Single cycle steps, shared by clock() and the block clocking in
+  // SID::clock(cycle_count, short*). E is EnvelopeGenerator or a structure
+  // of references with the same member names.
+  template<class E> static void clock_step(E& e);
+  template<class E> static void state_change_step(E& e);
+  template<class E> static void set_exponential_counter_step(E& e);
+
   reg16 rate_counter;
   reg16 rate_period;
   reg8 exponential_counter;
@@ -111,67 +118,68 @@ friend class SID;
 // ----------------------------------------------------------------------------
 // SID clocking - 1 cycle.
 // ----------------------------------------------------------------------------
+template<class E>
 RESID_INLINE
-void EnvelopeGenerator::clock()
+void EnvelopeGenerator::clock_step(E& e)
 {
   // The ENV3 value is sampled at the first phase of the clock
-  env3 = envelope_counter;
+  e.env3 = e.envelope_counter;
 
-  if (unlikely(state_pipeline)) {
-    state_change();
+  if (unlikely(e.state_pipeline)) {
+    state_change_step(e);
   }
 
   // If the exponential counter period != 1, the envelope decrement is delayed
   // 1 cycle. This is only modeled for single cycle clocking.
-  if (unlikely(envelope_pipeline != 0) && (--envelope_pipeline == 0)) {
-    if (likely(!hold_zero)) {
-      if (state == ATTACK) {
-        ++envelope_counter &= 0xff;
-        if (unlikely(envelope_counter == 0xff)) {
-            state = DECAY_SUSTAIN;
-            rate_period = rate_counter_period[decay];
+  if (unlikely(e.envelope_pipeline != 0) && (--e.envelope_pipeline == 0)) {
+    if (likely(!e.hold_zero)) {
+      if (e.state == ATTACK) {
+        ++e.envelope_counter &= 0xff;
+        if (unlikely(e.envelope_counter == 0xff)) {
+            e.state = DECAY_SUSTAIN;
+            e.rate_period = rate_counter_period[e.decay];
         }
       }
-      else if ((state == DECAY_SUSTAIN) || (state == RELEASE)) {
-        --envelope_counter &= 0xff;
+      else if ((e.state == DECAY_SUSTAIN) || (e.state == RELEASE)) {
+        --e.envelope_counter &= 0xff;
       }
 
-      set_exponential_counter();
+      set_exponential_counter_step(e);
     }
   }
 
-  if (unlikely(exponential_pipeline != 0) && (--exponential_pipeline == 0)) {
-    exponential_counter = 0;
+  if (unlikely(e.exponential_pipeline != 0) && (--e.exponential_pipeline == 0)) {
+    e.exponential_counter = 0;
 
-    if (((state == DECAY_SUSTAIN) && (envelope_counter != sustain_level[sustain]))
-        || (state == RELEASE)) {
+    if (((e.state == DECAY_SUSTAIN) && (e.envelope_counter != sustain_level[e.sustain]))
+        || (e.state == RELEASE)) {
       // The envelope counter can flip from 0x00 to 0xff by changing state to
       // attack, then to release. The envelope counter will then continue
       // counting down in the release state.
       // This has been verified by sampling ENV3.
 
-      envelope_pipeline = 1;
+      e.envelope_pipeline = 1;
     }
   }
-  else if (unlikely(reset_rate_counter)) {
-    rate_counter = 0;
-    reset_rate_counter = false;
+  else if (unlikely(e.reset_rate_counter)) {
+    e.rate_counter = 0;
+    e.reset_rate_counter = false;
 
-    if (state == ATTACK) {
+    if (e.state == ATTACK) {
       // The first envelope step in the attack state also resets the exponential
       // counter. This has been verified by sampling ENV3.
-      exponential_counter = 0; // NOTE this is actually delayed one cycle, not modeled
+      e.exponential_counter = 0; // NOTE this is actually delayed one cycle, not modeled
 
       // The envelope counter can flip from 0xff to 0x00 by changing state to
       // release, then to attack. The envelope counter is then frozen at
       // zero; to unlock this situation the state must be changed to release,
       // then to attack. This has been verified by sampling ENV3.
 
-      envelope_pipeline = 2;
+      e.envelope_pipeline = 2;
     }
     else {
-      if ((!hold_zero) && ++exponential_counter == exponential_counter_period) {
-        exponential_pipeline = exponential_counter_period != 1 ? 2 : 1;
+      if ((!e.hold_zero) && ++e.exponential_counter == e.exponential_counter_period) {
+        e.exponential_pipeline = e.exponential_counter_period != 1 ? 2 : 1;
       }
     }
   }
@@ -183,13 +191,19 @@ void EnvelopeGenerator::clock()
   // envelope can finally be stepped.
   // This has been verified by sampling ENV3.
   //
-  if (likely(rate_counter != rate_period)) {
-    if (unlikely(++rate_counter & 0x8000)) {
-      ++rate_counter &= 0x7fff;
+  if (likely(e.rate_counter != e.rate_period)) {
+    if (unlikely(++e.rate_counter & 0x8000)) {
+      ++e.rate_counter &= 0x7fff;
     }
   }
   else
-    reset_rate_counter = true;
+    e.reset_rate_counter = true;
+}
+
+RESID_INLINE
+void EnvelopeGenerator::clock()
+{
+  clock_step(*this);
 }
 
 
@@ -342,27 +356,28 @@ void EnvelopeGenerator::clock(cycle_count delta_t)
  *  1 - Nothing
  *  2 - Counter is disabled
  */
+template<class E>
 RESID_INLINE
-void EnvelopeGenerator::state_change()
+void EnvelopeGenerator::state_change_step(E& e)
 {
-  state_pipeline--;
+  e.state_pipeline--;
 
-  switch (next_state) {
+  switch (e.next_state) {
     case ATTACK:
-      if (state_pipeline == 0) {
-        state = ATTACK;
+      if (e.state_pipeline == 0) {
+        e.state = ATTACK;
         // The attack register is correctly activated during second cycle of attack phase
-        rate_period = rate_counter_period[attack];
-        hold_zero = false;
+        e.rate_period = rate_counter_period[e.attack];
+        e.hold_zero = false;
       }
       break;
     case DECAY_SUSTAIN:
       break;
     case RELEASE:
-      if (((state == ATTACK) && (state_pipeline == 0))
-          || ((state == DECAY_SUSTAIN) && (state_pipeline == 1))) {
-        state = RELEASE;
-        rate_period = rate_counter_period[release];
+      if (((e.state == ATTACK) && (e.state_pipeline == 0))
+          || ((e.state == DECAY_SUSTAIN) && (e.state_pipeline == 1))) {
+        e.state = RELEASE;
+        e.rate_period = rate_counter_period[e.release];
       }
       break;
     case FREEZED:
@@ -370,6 +385,12 @@ void EnvelopeGenerator::state_change()
   }
 }
 
+RESID_INLINE
+void EnvelopeGenerator::state_change()
+{
+  state_change_step(*this);
+}
+
 
 // ----------------------------------------------------------------------------
 // Read the envelope generator output.
@@ -382,42 +403,49 @@ short EnvelopeGenerator::output()
   return model_dac[sid_model][envelope_counter];
 }
 
+template<class E>
 RESID_INLINE
-void EnvelopeGenerator::set_exponential_counter()
+void EnvelopeGenerator::set_exponential_counter_step(E& e)
 {
   // Check for change of exponential counter period.
-  switch (envelope_counter) {
+  switch (e.envelope_counter) {
   case 0xff:
-    exponential_counter_period = 1;
+    e.exponential_counter_period = 1;
     break;
   case 0x5d:
-    exponential_counter_period = 2;
+    e.exponential_counter_period = 2;
     break;
   case 0x36:
-    exponential_counter_period = 4;
+    e.exponential_counter_period = 4;
     break;
   case 0x1a:
-    exponential_counter_period = 8;
+    e.exponential_counter_period = 8;
     break;
   case 0x0e:
-    exponential_counter_period = 16;
+    e.exponential_counter_period = 16;
     break;
   case 0x06:
-    exponential_counter_period = 30;
+    e.exponential_counter_period = 30;
     break;
   case 0x00:
     // TODO write a test to verify that 0x00 really changes the period
     // e.g. set R = 0xf, gate on to 0x06, gate off to 0x00, gate on to 0x04,
     // gate off, sample.
-    exponential_counter_period = 1;
+    e.exponential_counter_period = 1;
 
     // When the envelope counter is changed to zero, it is frozen at zero.
     // This has been verified by sampling ENV3.
-    hold_zero = true;
+    e.hold_zero = true;
     break;
   }
 }
 
+RESID_INLINE
+void EnvelopeGenerator::set_exponential_counter()
+{
+  set_exponential_counter_step(*this);
+}
+
 #endif // RESID_INLINING || defined(RESID_ENVELOPE_CC)
 
 } // namespace reSID
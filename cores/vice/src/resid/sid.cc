@@ -26,6 +26,24 @@
 
 #include "sid.h"
 #include <math.h>
+#include <string.h>
+
+// SIMD FIR convolution kernels. SSE2 and NEON are part of the base
+// instruction set on x86-64 and AArch64; AVX2 is selected at runtime.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESID_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if RESID_HAVE_SSE2 && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RESID_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define RESID_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
 
 #ifndef round
 #define round(x) (x>=0.0?floor(x+0.5):ceil(x-0.5))
@@ -46,6 +64,195 @@ inline short clip(int input)
     return (short)input;
 }
 
+
+// ----------------------------------------------------------------------------
+// FIR convolution kernels.
+//
+// The convolution is a dot product of 16 bit samples and 16 bit filter
+// coefficients, accumulated in 32 bits. Since the accumulation wraps
+// modulo 2^32 the order of summation does not matter, and the vectorized
+// kernels yield exactly the same result as the scalar loop.
+// ----------------------------------------------------------------------------
+typedef int (*convolve_func)(const short* a, const short* b, int n);
+
+static int convolve_scalar(const short* a, const short* b, int n)
+{
+  int out = 0;
+  for (int i = 0; i < n; i++) {
+    out += a[i]*b[i];
+  }
+  return out;
+}
+
+#if RESID_HAVE_SSE2
+static int convolve_sse2(const short* a, const short* b, int n)
+{
+  __m128i acc = _mm_setzero_si128();
+  int i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(va, vb));
+  }
+
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  int out = _mm_cvtsi128_si32(acc);
+
+  for (; i < n; i++) {
+    out += a[i]*b[i];
+  }
+  return out;
+}
+#endif
+
+#if RESID_HAVE_AVX2
+__attribute__((target("avx2")))
+static int convolve_avx2(const short* a, const short* b, int n)
+{
+  __m256i acc = _mm256_setzero_si256();
+  int i = 0;
+
+  for (; i + 16 <= n; i += 16) {
+    __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+  }
+
+  __m128i acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                                 _mm256_extracti128_si256(acc, 1));
+  if (i + 8 <= n) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+    acc128 = _mm_add_epi32(acc128, _mm_madd_epi16(va, vb));
+    i += 8;
+  }
+
+  acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, _MM_SHUFFLE(2, 3, 0, 1)));
+  int out = _mm_cvtsi128_si32(acc128);
+
+  for (; i < n; i++) {
+    out += a[i]*b[i];
+  }
+  return out;
+}
+#endif
+
+#if RESID_HAVE_NEON
+static int convolve_neon(const short* a, const short* b, int n)
+{
+  int32x4_t acc = vdupq_n_s32(0);
+  int i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    int16x8_t va = vld1q_s16(a + i);
+    int16x8_t vb = vld1q_s16(b + i);
+    acc = vmlal_s16(acc, vget_low_s16(va), vget_low_s16(vb));
+    acc = vmlal_s16(acc, vget_high_s16(va), vget_high_s16(vb));
+  }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+  int out = vaddvq_s32(acc);
+#else
+  int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+  int out = vget_lane_s32(vpadd_s32(sum, sum), 0);
+#endif
+
+  for (; i < n; i++) {
+    out += a[i]*b[i];
+  }
+  return out;
+}
+#endif
+
+static const struct {
+  const char* name;
+  convolve_func func;
+} convolve_kernels[] = {
+#if RESID_HAVE_AVX2
+  { "avx2", convolve_avx2 },
+#endif
+#if RESID_HAVE_SSE2
+  { "sse2", convolve_sse2 },
+#endif
+#if RESID_HAVE_NEON
+  { "neon", convolve_neon },
+#endif
+  { "scalar", convolve_scalar }
+};
+
+static const int convolve_kernel_count =
+  sizeof(convolve_kernels)/sizeof(convolve_kernels[0]);
+
+static bool convolve_kernel_supported(int k)
+{
+#if RESID_HAVE_AVX2
+  if (convolve_kernels[k].func == convolve_avx2) {
+    // The kernel is selected by a static initializer, which may run before
+    // the CPU model data used by __builtin_cpu_supports() is set up.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+  }
+#endif
+  return true;
+}
+
+// The kernels are ordered by preference; pick the first one the CPU runs.
+static int convolve_select()
+{
+  for (int k = 0; k < convolve_kernel_count; k++) {
+    if (convolve_kernel_supported(k)) {
+      return k;
+    }
+  }
+  return convolve_kernel_count - 1;
+}
+
+static int convolve_kernel = convolve_select();
+static convolve_func convolve = convolve_kernels[convolve_kernel].func;
+
+
+// ----------------------------------------------------------------------------
+// Selection of the FIR convolution kernel used for resampling.
+// By default the fastest kernel supported by the CPU is used; the kernels
+// are interchangeable and yield bit identical output.
+// ----------------------------------------------------------------------------
+const char* SID::get_convolution_kernel()
+{
+  return convolve_kernels[convolve_kernel].name;
+}
+
+bool SID::set_convolution_kernel(const char* name)
+{
+  for (int k = 0; k < convolve_kernel_count; k++) {
+    if (!strcmp(convolve_kernels[k].name, name)) {
+      if (!convolve_kernel_supported(k)) {
+        return false;
+      }
+      convolve_kernel = k;
+      convolve = convolve_kernels[k].func;
+      return true;
+    }
+  }
+  return false;
+}
+
+int SID::get_convolution_kernels(const char** names, int n)
+{
+  int count = 0;
+  for (int k = 0; k < convolve_kernel_count; k++) {
+    if (convolve_kernel_supported(k)) {
+      if (count < n) {
+        names[count] = convolve_kernels[k].name;
+      }
+      count++;
+    }
+  }
+  return count;
+}
+
 // ----------------------------------------------------------------------------
 // Constructor.
 // ----------------------------------------------------------------------------
@@ -768,6 +975,347 @@ void SID::clock(cycle_count delta_t)
 }
 
 
+// ----------------------------------------------------------------------------
+// SID clocking - n cycles, cycle exact, with one output sample per cycle.
+//
+// This is equivalent to calling clock() and storing clip(output()) n times,
+// however the three voices are advanced together. For the duration of the
+// call the per-cycle voice state is copied into the structure-of-arrays
+// below, so that each stage of the pipeline is a short loop over the three
+// voices which the compiler can keep in registers and vectorize, rather
+// than a walk through three Voice objects.
+//
+// No register writes can take place during the call; a pending MOS8580
+// write is completed through single cycle clocking before the voice state
+// is gathered.
+// ----------------------------------------------------------------------------
+struct VoiceBlock
+{
+  // Waveform generators.
+  reg24 accumulator[3];
+  reg24 freq[3];
+  reg12 pw[3];
+  reg24 shift_register[3];
+  cycle_count shift_register_reset[3];
+  cycle_count shift_pipeline[3];
+  reg24 ring_msb_mask[3];
+  unsigned short no_noise[3];
+  unsigned short noise_output[3];
+  unsigned short no_noise_or_noise_output[3];
+  unsigned short no_pulse[3];
+  unsigned short pulse_output[3];
+  reg12 tri_saw_pipeline[3];
+  reg12 osc3[3];
+  reg12 waveform_output[3];
+  cycle_count floating_output_ttl[3];
+  reg8 waveform[3];
+  reg8 test[3];
+  reg8 sync[3];
+  bool msb_rising[3];
+  unsigned short* wave[3];
+
+  // Envelope generators.
+  reg16 rate_counter[3];
+  reg16 rate_period[3];
+  reg8 exponential_counter[3];
+  reg8 exponential_counter_period[3];
+  reg8 envelope_counter[3];
+  reg8 env3[3];
+  cycle_count envelope_pipeline[3];
+  cycle_count exponential_pipeline[3];
+  cycle_count state_pipeline[3];
+  bool hold_zero[3];
+  bool reset_rate_counter[3];
+  reg4 attack[3];
+  reg4 decay[3];
+  reg4 sustain[3];
+  reg4 release[3];
+  EnvelopeGenerator::State state[3];
+  EnvelopeGenerator::State next_state[3];
+
+  // Voice DAC zero levels.
+  int wave_zero[3];
+};
+
+// Views of voice i in a VoiceBlock with the member names of the generators,
+// for the single cycle steps in wave.h and envelope.h.
+struct WaveformRef
+{
+  WaveformRef(SID& sid, VoiceBlock& v, int i) :
+    accumulator(v.accumulator[i]),
+    freq(v.freq[i]),
+    pw(v.pw[i]),
+    shift_register(v.shift_register[i]),
+    shift_register_reset(v.shift_register_reset[i]),
+    shift_pipeline(v.shift_pipeline[i]),
+    ring_msb_mask(v.ring_msb_mask[i]),
+    no_noise(v.no_noise[i]),
+    noise_output(v.noise_output[i]),
+    no_noise_or_noise_output(v.no_noise_or_noise_output[i]),
+    no_pulse(v.no_pulse[i]),
+    pulse_output(v.pulse_output[i]),
+    tri_saw_pipeline(v.tri_saw_pipeline[i]),
+    osc3(v.osc3[i]),
+    waveform_output(v.waveform_output[i]),
+    floating_output_ttl(v.floating_output_ttl[i]),
+    waveform(v.waveform[i]),
+    test(v.test[i]),
+    sync(v.sync[i]),
+    msb_rising(v.msb_rising[i]),
+    wave(v.wave[i]),
+    sid(sid), v(v), i(i) {}
+
+  void shiftreg_bitfade() { sid.shiftreg_bitfade(v, i); }
+  void wave_bitfade() { sid.wave_bitfade(v, i); }
+
+  reg24& accumulator;
+  reg24& freq;
+  reg12& pw;
+  reg24& shift_register;
+  cycle_count& shift_register_reset;
+  cycle_count& shift_pipeline;
+  reg24& ring_msb_mask;
+  unsigned short& no_noise;
+  unsigned short& noise_output;
+  unsigned short& no_noise_or_noise_output;
+  unsigned short& no_pulse;
+  unsigned short& pulse_output;
+  reg12& tri_saw_pipeline;
+  reg12& osc3;
+  reg12& waveform_output;
+  cycle_count& floating_output_ttl;
+  reg8& waveform;
+  reg8& test;
+  reg8& sync;
+  bool& msb_rising;
+  unsigned short*& wave;
+
+  SID& sid;
+  VoiceBlock& v;
+  int i;
+};
+
+struct EnvelopeRef
+{
+  EnvelopeRef(VoiceBlock& v, int i) :
+    rate_counter(v.rate_counter[i]),
+    rate_period(v.rate_period[i]),
+    exponential_counter(v.exponential_counter[i]),
+    exponential_counter_period(v.exponential_counter_period[i]),
+    envelope_counter(v.envelope_counter[i]),
+    env3(v.env3[i]),
+    envelope_pipeline(v.envelope_pipeline[i]),
+    exponential_pipeline(v.exponential_pipeline[i]),
+    state_pipeline(v.state_pipeline[i]),
+    hold_zero(v.hold_zero[i]),
+    reset_rate_counter(v.reset_rate_counter[i]),
+    attack(v.attack[i]),
+    decay(v.decay[i]),
+    sustain(v.sustain[i]),
+    release(v.release[i]),
+    state(v.state[i]),
+    next_state(v.next_state[i]) {}
+
+  reg16& rate_counter;
+  reg16& rate_period;
+  reg8& exponential_counter;
+  reg8& exponential_counter_period;
+  reg8& envelope_counter;
+  reg8& env3;
+  cycle_count& envelope_pipeline;
+  cycle_count& exponential_pipeline;
+  cycle_count& state_pipeline;
+  bool& hold_zero;
+  bool& reset_rate_counter;
+  reg4& attack;
+  reg4& decay;
+  reg4& sustain;
+  reg4& release;
+  EnvelopeGenerator::State& state;
+  EnvelopeGenerator::State& next_state;
+};
+
+void SID::gather_voices(VoiceBlock& v)
+{
+  for (int i = 0; i < 3; i++) {
+    WaveformGenerator& w = voice[i].wave;
+    v.accumulator[i] = w.accumulator;
+    v.freq[i] = w.freq;
+    v.pw[i] = w.pw;
+    v.shift_register[i] = w.shift_register;
+    v.shift_register_reset[i] = w.shift_register_reset;
+    v.shift_pipeline[i] = w.shift_pipeline;
+    v.ring_msb_mask[i] = w.ring_msb_mask;
+    v.no_noise[i] = w.no_noise;
+    v.noise_output[i] = w.noise_output;
+    v.no_noise_or_noise_output[i] = w.no_noise_or_noise_output;
+    v.no_pulse[i] = w.no_pulse;
+    v.pulse_output[i] = w.pulse_output;
+    v.tri_saw_pipeline[i] = w.tri_saw_pipeline;
+    v.osc3[i] = w.osc3;
+    v.waveform_output[i] = w.waveform_output;
+    v.floating_output_ttl[i] = w.floating_output_ttl;
+    v.waveform[i] = w.waveform;
+    v.test[i] = w.test;
+    v.sync[i] = w.sync;
+    v.msb_rising[i] = w.msb_rising;
+    v.wave[i] = w.wave;
+
+    EnvelopeGenerator& e = voice[i].envelope;
+    v.rate_counter[i] = e.rate_counter;
+    v.rate_period[i] = e.rate_period;
+    v.exponential_counter[i] = e.exponential_counter;
+    v.exponential_counter_period[i] = e.exponential_counter_period;
+    v.envelope_counter[i] = e.envelope_counter;
+    v.env3[i] = e.env3;
+    v.envelope_pipeline[i] = e.envelope_pipeline;
+    v.exponential_pipeline[i] = e.exponential_pipeline;
+    v.state_pipeline[i] = e.state_pipeline;
+    v.hold_zero[i] = e.hold_zero;
+    v.reset_rate_counter[i] = e.reset_rate_counter;
+    v.attack[i] = e.attack;
+    v.decay[i] = e.decay;
+    v.sustain[i] = e.sustain;
+    v.release[i] = e.release;
+    v.state[i] = e.state;
+    v.next_state[i] = e.next_state;
+
+    v.wave_zero[i] = voice[i].wave_zero;
+  }
+}
+
+void SID::scatter_voices(const VoiceBlock& v)
+{
+  for (int i = 0; i < 3; i++) {
+    WaveformGenerator& w = voice[i].wave;
+    w.accumulator = v.accumulator[i];
+    w.shift_register = v.shift_register[i];
+    w.shift_register_reset = v.shift_register_reset[i];
+    w.shift_pipeline = v.shift_pipeline[i];
+    w.noise_output = v.noise_output[i];
+    w.no_noise_or_noise_output = v.no_noise_or_noise_output[i];
+    w.pulse_output = v.pulse_output[i];
+    w.tri_saw_pipeline = v.tri_saw_pipeline[i];
+    w.osc3 = v.osc3[i];
+    w.waveform_output = v.waveform_output[i];
+    w.floating_output_ttl = v.floating_output_ttl[i];
+    w.msb_rising = v.msb_rising[i];
+
+    EnvelopeGenerator& e = voice[i].envelope;
+    e.rate_counter = v.rate_counter[i];
+    e.rate_period = v.rate_period[i];
+    e.exponential_counter = v.exponential_counter[i];
+    e.exponential_counter_period = v.exponential_counter_period[i];
+    e.envelope_counter = v.envelope_counter[i];
+    e.env3 = v.env3[i];
+    e.envelope_pipeline = v.envelope_pipeline[i];
+    e.exponential_pipeline = v.exponential_pipeline[i];
+    e.state_pipeline = v.state_pipeline[i];
+    e.hold_zero = v.hold_zero[i];
+    e.reset_rate_counter = v.reset_rate_counter[i];
+    e.state = v.state[i];
+  }
+}
+
+// Rare events which are handled by the voice objects themselves.
+void SID::shiftreg_bitfade(VoiceBlock& v, int i)
+{
+  WaveformGenerator& w = voice[i].wave;
+  w.shift_register = v.shift_register[i];
+  w.shift_register_reset = v.shift_register_reset[i];
+  w.shiftreg_bitfade();
+  v.shift_register[i] = w.shift_register;
+  v.shift_register_reset[i] = w.shift_register_reset;
+  v.noise_output[i] = w.noise_output;
+  v.no_noise_or_noise_output[i] = w.no_noise_or_noise_output;
+}
+
+void SID::wave_bitfade(VoiceBlock& v, int i)
+{
+  WaveformGenerator& w = voice[i].wave;
+  w.waveform_output = v.waveform_output[i];
+  w.floating_output_ttl = v.floating_output_ttl[i];
+  w.wave_bitfade();
+  v.waveform_output[i] = w.waveform_output;
+  v.osc3[i] = w.osc3;
+  v.floating_output_ttl[i] = w.floating_output_ttl;
+}
+
+RESID_FLATTEN
+void SID::clock(cycle_count n, short* out)
+{
+  // Complete a pending MOS8580 write, the voice state may change.
+  while (unlikely(write_pipeline) && n > 0) {
+    clock();
+    *out++ = clip(output());
+    n--;
+  }
+
+  if (n <= 0) {
+    return;
+  }
+
+  VoiceBlock v;
+  gather_voices(v);
+
+  const unsigned short* wave_dac = WaveformGenerator::model_dac[sid_model];
+  const unsigned short* env_dac = EnvelopeGenerator::model_dac[sid_model];
+  const bool mos6581 = sid_model == MOS6581;
+  int i;
+
+  for (cycle_count c = 0; c < n; c++) {
+    // Clock amplitude modulators.
+    for (i = 0; i < 3; i++) {
+      EnvelopeRef e(v, i);
+      EnvelopeGenerator::clock_step(e);
+    }
+
+    // Clock oscillators.
+    for (i = 0; i < 3; i++) {
+      WaveformRef w(*this, v, i);
+      WaveformGenerator::clock_step(w);
+    }
+
+    // Synchronize oscillators. Voice i syncs voice i + 1, and is synced
+    // by voice i - 1 (modulo 3), see the constructor.
+    for (i = 0; i < 3; i++) {
+      WaveformRef w(*this, v, i);
+      WaveformRef dest(*this, v, i == 2 ? 0 : i + 1);
+      WaveformRef source(*this, v, i == 0 ? 2 : i - 1);
+      WaveformGenerator::synchronize_step(w, dest, source);
+    }
+
+    // Calculate waveform output.
+    for (i = 0; i < 3; i++) {
+      WaveformRef w(*this, v, i);
+      WaveformRef source(*this, v, i == 0 ? 2 : i - 1);
+      WaveformGenerator::set_waveform_output_step(w, source, mos6581);
+    }
+
+    // Multiply oscillator output with envelope output.
+    int vo[3];
+    for (i = 0; i < 3; i++) {
+      vo[i] = (wave_dac[v.waveform_output[i]] - v.wave_zero[i])*env_dac[v.envelope_counter[i]];
+    }
+
+    // Clock filter.
+    filter.clock(vo[0], vo[1], vo[2]);
+
+    // Clock external filter.
+    extfilt.clock(filter.output());
+
+    out[c] = clip(output());
+
+    // Age bus value.
+    if (unlikely(!--bus_value_ttl)) {
+      bus_value = 0;
+    }
+  }
+
+  scatter_voices(v);
+}
+
+
 // ----------------------------------------------------------------------------
 // SID clocking with audio sampling.
 // Fixed point arithmetics are used.
@@ -888,8 +1436,8 @@ int SID::clock_interpolate(cycle_count& delta_t, short* buf, int n, int interlea
 // By building shifted FIR tables with samples according to the
 // sampling frequency, the implementation below dramatically reduces the
 // computational effort in the filter convolutions, without any loss
-// of accuracy. The filter convolutions are also vectorizable on
-// current hardware.
+// of accuracy. The filter convolutions are vectorized, see convolve()
+// above.
 //
 // Further possible optimizations are:
 // * An equiripple filter design could yield a lower filter order, see
@@ -910,67 +1458,110 @@ int SID::clock_interpolate(cycle_count& delta_t, short* buf, int n, int interlea
 // ----------------------------------------------------------------------------
 int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
 {
-  int s;
-
-  for (s = 0; s < n; s++) {
-    cycle_count next_sample_offset = sample_offset + cycles_per_sample;
-    cycle_count delta_t_sample = next_sample_offset >> FIXP_SHIFT;
+  int s = 0;
+
+  // The chip is clocked with the block engine, SID::clock(n, out), for as
+  // many samples as the ring buffer holds at a time; the samples are then
+  // resampled from the ring buffer. The sample positions do not depend on
+  // the chip, so they are computed twice: once to find the number of
+  // cycles to clock, and once while resampling.
+  const cycle_count cycles_max = RINGSIZE - fir_N - 2;
+
+  while (s < n) {
+    cycle_count offset = sample_offset;
+    cycle_count cycles = 0;
+    cycle_count rest = 0;
+    int samples = 0;
+
+    while (s + samples < n) {
+      cycle_count next_sample_offset = offset + cycles_per_sample;
+      cycle_count delta_t_sample = next_sample_offset >> FIXP_SHIFT;
+
+      if (cycles + delta_t_sample >= delta_t) {
+        // The next sample is not complete within delta_t.
+        rest = delta_t - cycles;
+        break;
+      }
+      if (samples > 0 && cycles + delta_t_sample > cycles_max) {
+        break;
+      }
 
-    if (delta_t_sample > delta_t) {
-      delta_t_sample = delta_t;
+      cycles += delta_t_sample;
+      offset = next_sample_offset & FIXP_MASK;
+      samples++;
     }
 
-    for (int i = 0; i < delta_t_sample; i++) {
-      clock();
-      sample[sample_index] = sample[sample_index + RINGSIZE] = clip(output());
-      ++sample_index &= RINGMASK;
-    }
+    int index = sample_index;
+    clock_ring(cycles);
 
-    if ((delta_t -= delta_t_sample) == 0) {
-      sample_offset -= delta_t_sample << FIXP_SHIFT;
-      break;
-    }
+    for (int i = 0; i < samples; i++, s++) {
+      cycle_count next_sample_offset = sample_offset + cycles_per_sample;
+      index = (index + (next_sample_offset >> FIXP_SHIFT)) & RINGMASK;
+      sample_offset = next_sample_offset & FIXP_MASK;
 
-    sample_offset = next_sample_offset & FIXP_MASK;
+      int fir_offset = sample_offset*fir_RES >> FIXP_SHIFT;
+      int fir_offset_rmd = sample_offset*fir_RES & FIXP_MASK;
+      short* fir_start = fir + fir_offset*fir_N;
+      short* sample_start = sample + index - fir_N - 1 + RINGSIZE;
 
-    int fir_offset = sample_offset*fir_RES >> FIXP_SHIFT;
-    int fir_offset_rmd = sample_offset*fir_RES & FIXP_MASK;
-    short* fir_start = fir + fir_offset*fir_N;
-    short* sample_start = sample + sample_index - fir_N - 1 + RINGSIZE;
+      // Convolution with filter impulse response.
+      int v1 = convolve(sample_start, fir_start, fir_N);
 
-    // Convolution with filter impulse response.
-    int v1 = 0;
-    for (int j = 0; j < fir_N; j++) {
-      v1 += sample_start[j]*fir_start[j];
-    }
+      // Use next FIR table, wrap around to first FIR table using
+      // next sample.
+      if (unlikely(++fir_offset == fir_RES)) {
+        fir_offset = 0;
+        ++sample_start;
+      }
+      fir_start = fir + fir_offset*fir_N;
 
-    // Use next FIR table, wrap around to first FIR table using
-    // next sample.
-    if (unlikely(++fir_offset == fir_RES)) {
-      fir_offset = 0;
-      ++sample_start;
-    }
-    fir_start = fir + fir_offset*fir_N;
+      // Convolution with filter impulse response.
+      int v2 = convolve(sample_start, fir_start, fir_N);
 
-    // Convolution with filter impulse response.
-    int v2 = 0;
-    for (int k = 0; k < fir_N; k++) {
-      v2 += sample_start[k]*fir_start[k];
-    }
+      // Linear interpolation.
+      // fir_offset_rmd is equal for all samples, it can thus be factorized out:
+      // sum(v1 + rmd*(v2 - v1)) = sum(v1) + rmd*(sum(v2) - sum(v1))
+      int v = v1 + int((unsigned(fir_offset_rmd)*unsigned(v2 - v1)) >> FIXP_SHIFT);
 
-    // Linear interpolation.
-    // fir_offset_rmd is equal for all samples, it can thus be factorized out:
-    // sum(v1 + rmd*(v2 - v1)) = sum(v1) + rmd*(sum(v2) - sum(v1))
-    int v = v1 + int((unsigned(fir_offset_rmd)*unsigned(v2 - v1)) >> FIXP_SHIFT);
+      v >>= FIR_SHIFT;
 
-    v >>= FIR_SHIFT;
+      buf[s*interleave] = clip(v);
+    }
 
-    buf[s*interleave] = clip(v);
+    delta_t -= cycles;
+
+    if (rest > 0 || delta_t == 0) {
+      clock_ring(rest);
+      delta_t -= rest;
+      sample_offset -= rest << FIXP_SHIFT;
+      break;
+    }
   }
 
   return s;
 }
 
+// ----------------------------------------------------------------------------
+// Clock the chip for n cycles, storing the clipped output of every cycle in
+// the sample ring buffer.
+// ----------------------------------------------------------------------------
+void SID::clock_ring(cycle_count n)
+{
+  while (n > 0) {
+    cycle_count chunk = RINGSIZE - sample_index;
+    if (chunk > n) {
+      chunk = n;
+    }
+
+    clock(chunk, sample + sample_index);
+    memcpy(sample + sample_index + RINGSIZE, sample + sample_index,
+           chunk*sizeof(*sample));
+
+    sample_index = (sample_index + chunk) & RINGMASK;
+    n -= chunk;
+  }
+}
+
 
 // ----------------------------------------------------------------------------
 // SID clocking with audio sampling - cycle based with audio resampling.
@@ -1005,10 +1596,7 @@ int SID::clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int int
     short* sample_start = sample + sample_index - fir_N + RINGSIZE;
 
     // Convolution with filter impulse response.
-    int v = 0;
-    for (int j = 0; j < fir_N; j++) {
-      v += sample_start[j]*fir_start[j];
-    }
+    int v = convolve(sample_start, fir_start, fir_N);
 
     v >>= FIR_SHIFT;
 
@@ -35,6 +35,9 @@
 namespace reSID
 {
 
+struct VoiceBlock;
+struct WaveformRef;
+
 class SID
 {
 public:
@@ -53,6 +56,7 @@ public:
 
   void clock();
   void clock(cycle_count delta_t);
+  void clock(cycle_count n, short* out);
   int clock(cycle_count& delta_t, short* buf, int n, int interleave = 1);
   void reset();
 
@@ -100,14 +104,27 @@ public:
   // 16-bit output (AUDIO OUT).
   int output();
 
+  // FIR convolution kernel used for resampling ("avx2", "sse2", "neon",
+  // "scalar"). The kernels yield identical output.
+  static const char* get_convolution_kernel();
+  static bool set_convolution_kernel(const char* name);
+  static int get_convolution_kernels(const char** names, int n);
+
  protected:
   static double I0(double x);
   int clock_fast(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_interpolate(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample(cycle_count& delta_t, short* buf, int n, int interleave);
+  void clock_ring(cycle_count n);
   int clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int interleave);
   void write();
 
+  void gather_voices(VoiceBlock& v);
+  void scatter_voices(const VoiceBlock& v);
+  void shiftreg_bitfade(VoiceBlock& v, int i);
+  void wave_bitfade(VoiceBlock& v, int i);
+  friend struct WaveformRef;
+
   chip_model sid_model;
   Voice voice[3];
   Filter filter;
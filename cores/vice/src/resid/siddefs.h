@@ -50,6 +50,14 @@ const bool false = 0;
 #define unlikely(x)    (x)
 #endif
 
+// Inline every call made by a function, used to fold the single cycle voice
+// steps into the block clocking loop.
+#if defined(__GNUC__)
+#define RESID_FLATTEN __attribute__((flatten))
+#else
+#define RESID_FLATTEN
+#endif
+
 namespace reSID {
 
 // We could have used the smallest possible data type for each SID register,
@@ -67,6 +67,16 @@ protected:
   void wave_bitfade();
   void shiftreg_bitfade();
 
+  // Single cycle steps, shared by the member functions above and the block
+  // clocking in SID::clock(cycle_count, short*). W is WaveformGenerator or a
+  // structure of references with the same member names.
+  template<class W> static void clock_step(W& w);
+  template<class W> static void synchronize_step(W& w, W& dest, const W& source);
+  template<class W> static void clock_shift_register_step(W& w);
+  template<class W> static void write_shift_register_step(W& w);
+  template<class W> static void set_noise_output_step(W& w);
+  template<class W> static void set_waveform_output_step(W& w, const W& source, bool mos6581);
+
   const WaveformGenerator* sync_source;
   WaveformGenerator* sync_dest;
 
@@ -138,39 +148,46 @@ friend class SID;
 // ----------------------------------------------------------------------------
 // SID clocking - 1 cycle.
 // ----------------------------------------------------------------------------
+template<class W>
 RESID_INLINE
-void WaveformGenerator::clock()
+void WaveformGenerator::clock_step(W& w)
 {
-  if (unlikely(test)) {
+  if (unlikely(w.test)) {
     // Count down time to fully reset shift register.
-    if (unlikely(shift_register_reset) && unlikely(!--shift_register_reset)) {
-      shiftreg_bitfade();
+    if (unlikely(w.shift_register_reset) && unlikely(!--w.shift_register_reset)) {
+      w.shiftreg_bitfade();
     }
 
     // The test bit sets pulse high.
-    pulse_output = 0xfff;
+    w.pulse_output = 0xfff;
   }
   else {
     // Calculate new accumulator value;
-    reg24 accumulator_next = (accumulator + freq) & 0xffffff;
-    reg24 accumulator_bits_set = ~accumulator & accumulator_next;
-    accumulator = accumulator_next;
+    reg24 accumulator_next = (w.accumulator + w.freq) & 0xffffff;
+    reg24 accumulator_bits_set = ~w.accumulator & accumulator_next;
+    w.accumulator = accumulator_next;
 
     // Check whether the MSB is set high. This is used for synchronization.
-    msb_rising = (accumulator_bits_set & 0x800000) ? true : false;
+    w.msb_rising = (accumulator_bits_set & 0x800000) ? true : false;
 
     // Shift noise register once for each time accumulator bit 19 is set high.
     // The shift is delayed 2 cycles.
     if (unlikely(accumulator_bits_set & 0x080000)) {
       // Pipeline: Detect rising bit, shift phase 1, shift phase 2.
-      shift_pipeline = 2;
+      w.shift_pipeline = 2;
     }
-    else if (unlikely(shift_pipeline) && !--shift_pipeline) {
-      clock_shift_register();
+    else if (unlikely(w.shift_pipeline) && !--w.shift_pipeline) {
+      clock_shift_register_step(w);
     }
   }
 }
 
+RESID_INLINE
+void WaveformGenerator::clock()
+{
+  clock_step(*this);
+}
+
 // ----------------------------------------------------------------------------
 // SID clocking - delta_t cycles.
 // ----------------------------------------------------------------------------
@@ -252,17 +269,24 @@ void WaveformGenerator::clock(cycle_count delta_t)
 // Note that the oscillators must be clocked exactly on the cycle when the
 // MSB is set high for hard sync to operate correctly. See SID::clock().
 // ----------------------------------------------------------------------------
+template<class W>
 RESID_INLINE
-void WaveformGenerator::synchronize()
+void WaveformGenerator::synchronize_step(W& w, W& dest, const W& source)
 {
   // A special case occurs when a sync source is synced itself on the same
   // cycle as when its MSB is set high. In this case the destination will
   // not be synced. This has been verified by sampling OSC3.
-  if (unlikely(msb_rising) && sync_dest->sync && !(sync && sync_source->msb_rising)) {
-    sync_dest->accumulator = 0;
+  if (unlikely(w.msb_rising) && dest.sync && !(w.sync && source.msb_rising)) {
+    dest.accumulator = 0;
   }
 }
 
+RESID_INLINE
+void WaveformGenerator::synchronize()
+{
+  synchronize_step(*this, *sync_dest, *sync_source);
+}
+
 
 // ----------------------------------------------------------------------------
 // Waveform output.
@@ -318,17 +342,27 @@ void WaveformGenerator::synchronize()
 // The low 4 waveform bits are zero (grounded).
 //
 
-RESID_INLINE void WaveformGenerator::clock_shift_register()
+template<class W>
+RESID_INLINE
+void WaveformGenerator::clock_shift_register_step(W& w)
 {
   // bit0 = (bit22 | test) ^ bit17
-  reg24 bit0 = ((shift_register >> 22) ^ (shift_register >> 17)) & 0x1;
-  shift_register = ((shift_register << 1) | bit0) & 0x7fffff;
+  reg24 bit0 = ((w.shift_register >> 22) ^ (w.shift_register >> 17)) & 0x1;
+  w.shift_register = ((w.shift_register << 1) | bit0) & 0x7fffff;
 
   // New noise waveform output.
-  set_noise_output();
+  set_noise_output_step(w);
 }
 
-RESID_INLINE void WaveformGenerator::write_shift_register()
+RESID_INLINE
+void WaveformGenerator::clock_shift_register()
+{
+  clock_shift_register_step(*this);
+}
+
+template<class W>
+RESID_INLINE
+void WaveformGenerator::write_shift_register_step(W& w)
 {
   // Write changes to the shift register output caused by combined waveforms
   // back into the shift register.
@@ -336,34 +370,48 @@ RESID_INLINE void WaveformGenerator::write_shift_register()
   // FIXME: Write test program to check the effect of 1 bits and whether
   // neighboring bits are affected.
 
-  shift_register &=
+  w.shift_register &=
     ~((1<<20)|(1<<18)|(1<<14)|(1<<11)|(1<<9)|(1<<5)|(1<<2)|(1<<0)) |
-    ((waveform_output & 0x800) << 9) |  // Bit 11 -> bit 20
-    ((waveform_output & 0x400) << 8) |  // Bit 10 -> bit 18
-    ((waveform_output & 0x200) << 5) |  // Bit  9 -> bit 14
-    ((waveform_output & 0x100) << 3) |  // Bit  8 -> bit 11
-    ((waveform_output & 0x080) << 2) |  // Bit  7 -> bit  9
-    ((waveform_output & 0x040) >> 1) |  // Bit  6 -> bit  5
-    ((waveform_output & 0x020) >> 3) |  // Bit  5 -> bit  2
-    ((waveform_output & 0x010) >> 4);   // Bit  4 -> bit  0
-
-  noise_output &= waveform_output;
-  no_noise_or_noise_output = no_noise | noise_output;
+    ((w.waveform_output & 0x800) << 9) |  // Bit 11 -> bit 20
+    ((w.waveform_output & 0x400) << 8) |  // Bit 10 -> bit 18
+    ((w.waveform_output & 0x200) << 5) |  // Bit  9 -> bit 14
+    ((w.waveform_output & 0x100) << 3) |  // Bit  8 -> bit 11
+    ((w.waveform_output & 0x080) << 2) |  // Bit  7 -> bit  9
+    ((w.waveform_output & 0x040) >> 1) |  // Bit  6 -> bit  5
+    ((w.waveform_output & 0x020) >> 3) |  // Bit  5 -> bit  2
+    ((w.waveform_output & 0x010) >> 4);   // Bit  4 -> bit  0
+
+  w.noise_output &= w.waveform_output;
+  w.no_noise_or_noise_output = w.no_noise | w.noise_output;
+}
+
+RESID_INLINE
+void WaveformGenerator::write_shift_register()
+{
+  write_shift_register_step(*this);
 }
 
-RESID_INLINE void WaveformGenerator::set_noise_output()
+template<class W>
+RESID_INLINE
+void WaveformGenerator::set_noise_output_step(W& w)
+{
+  w.noise_output =
+    ((w.shift_register & 0x100000) >> 9) |
+    ((w.shift_register & 0x040000) >> 8) |
+    ((w.shift_register & 0x004000) >> 5) |
+    ((w.shift_register & 0x000800) >> 3) |
+    ((w.shift_register & 0x000200) >> 2) |
+    ((w.shift_register & 0x000020) << 1) |
+    ((w.shift_register & 0x000004) << 3) |
+    ((w.shift_register & 0x000001) << 4);
+
+  w.no_noise_or_noise_output = w.no_noise | w.noise_output;
+}
+
+RESID_INLINE
+void WaveformGenerator::set_noise_output()
 {
-  noise_output =
-    ((shift_register & 0x100000) >> 9) |
-    ((shift_register & 0x040000) >> 8) |
-    ((shift_register & 0x004000) >> 5) |
-    ((shift_register & 0x000800) >> 3) |
-    ((shift_register & 0x000200) >> 2) |
-    ((shift_register & 0x000020) << 1) |
-    ((shift_register & 0x000004) << 3) |
-    ((shift_register & 0x000001) << 4);
-
-  no_noise_or_noise_output = no_noise | noise_output;
+  set_noise_output_step(*this);
 }
 
 // Combined waveforms:
@@ -455,51 +503,52 @@ static reg12 noise_pulse8580(reg12 noise)
     return (noise < 0xfc0) ? noise & (noise << 1) : 0xfc0;
 }
 
+template<class W>
 RESID_INLINE
-void WaveformGenerator::set_waveform_output()
+void WaveformGenerator::set_waveform_output_step(W& w, const W& source, bool mos6581)
 {
   // Set output value.
-  if (likely(waveform)) {
+  if (likely(w.waveform)) {
     // The bit masks no_pulse and no_noise are used to achieve branch-free
     // calculation of the output value.
-    int ix = (accumulator ^ (~sync_source->accumulator & ring_msb_mask)) >> 12;
+    int ix = (w.accumulator ^ (~source.accumulator & w.ring_msb_mask)) >> 12;
 
-    waveform_output = wave[ix] & (no_pulse | pulse_output) & no_noise_or_noise_output;
+    w.waveform_output = w.wave[ix] & (w.no_pulse | w.pulse_output) & w.no_noise_or_noise_output;
 
-    if (unlikely((waveform & 0xc) == 0xc))
+    if (unlikely((w.waveform & 0xc) == 0xc))
     {
-        waveform_output = (sid_model == MOS6581) ?
-            noise_pulse6581(waveform_output) : noise_pulse8580(waveform_output);
+        w.waveform_output = mos6581 ?
+            noise_pulse6581(w.waveform_output) : noise_pulse8580(w.waveform_output);
     }
 
     // Triangle/Sawtooth output is delayed half cycle on 8580.
     // This will appear as a one cycle delay on OSC3 as it is
     // latched in the first phase of the clock.
-    if ((waveform & 3) && (sid_model == MOS8580))
+    if ((w.waveform & 3) && !mos6581)
     {
-        osc3 = tri_saw_pipeline & (no_pulse | pulse_output) & no_noise_or_noise_output;
-        tri_saw_pipeline = wave[ix];
+        w.osc3 = w.tri_saw_pipeline & (w.no_pulse | w.pulse_output) & w.no_noise_or_noise_output;
+        w.tri_saw_pipeline = w.wave[ix];
     }
     else
     {
-        osc3 = waveform_output;
+        w.osc3 = w.waveform_output;
     }
 
-    if ((waveform & 0x2) && unlikely(waveform & 0xd) && (sid_model == MOS6581)) {
+    if ((w.waveform & 0x2) && unlikely(w.waveform & 0xd) && mos6581) {
         // In the 6581 the top bit of the accumulator may be driven low by combined waveforms
         // when the sawtooth is selected
-        accumulator &= (waveform_output << 12) | 0x7fffff;
+        w.accumulator &= (w.waveform_output << 12) | 0x7fffff;
     }
 
-    if (unlikely(waveform > 0x8) && likely(!test) && likely(shift_pipeline != 1)) {
+    if (unlikely(w.waveform > 0x8) && likely(!w.test) && likely(w.shift_pipeline != 1)) {
       // Combined waveforms write to the shift register.
-      write_shift_register();
+      write_shift_register_step(w);
     }
   }
   else {
     // Age floating DAC input.
-    if (likely(floating_output_ttl) && unlikely(!--floating_output_ttl)) {
-      wave_bitfade();
+    if (likely(w.floating_output_ttl) && unlikely(!--w.floating_output_ttl)) {
+      w.wave_bitfade();
     }
   }
 
@@ -515,7 +564,13 @@ void WaveformGenerator::set_waveform_output()
 
   // The result of the pulse width compare is delayed one cycle.
   // Push next pulse level into pulse level pipeline.
-  pulse_output = -((accumulator >> 12) >= pw) & 0xfff;
+  w.pulse_output = -((w.accumulator >> 12) >= w.pw) & 0xfff;
+}
+
+RESID_INLINE
+void WaveformGenerator::set_waveform_output()
+{
+  set_waveform_output_step(*this, *sync_source, sid_model == MOS6581);
 }
 
 RESID_INLINE
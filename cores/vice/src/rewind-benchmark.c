@@ -0,0 +1,298 @@
+/*
+ * rewind-benchmark.c - Measure the cost of keeping rewind states.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: rewind-benchmark [frames] [buffer kB]
+
+   Runs rewind.c against a synthetic machine of the size of a C64 snapshot
+   (about 70 kB) that changes a few hundred bytes per frame: a scrolling
+   screen, a moving sprite, the zero page and stack.  For several capture
+   intervals it reports the capture time per frame and per state, the
+   encoded size of the states and the time span held by the buffer, then
+   steps back through the buffer and jumps to random times, checking every
+   restored state against the one taken at that frame.  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "archdep.h"
+#include "cmdline.h"
+#include "interrupt.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "resources.h"
+#include "rewind.h"
+#include "snapshot.h"
+#include "tick.h"
+#include "types.h"
+#include "vsync.h"
+
+#define BENCH_STATE_SIZE    70038
+#define BENCH_REFRESH       50.0
+
+static uint8_t bench_state[BENCH_STATE_SIZE];
+static unsigned long bench_frame;
+
+/* Checksum of the state at every frame.  */
+static uint32_t *bench_sums;
+static unsigned long bench_restored_frame;
+static int bench_errors;
+
+static const resource_int_t *bench_resources;
+
+/* Stubs for lib.c and rewind.c.  */
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+int resources_register_int(const resource_int_t *r)
+{
+    bench_resources = r;
+    return 0;
+}
+
+int resources_set_int(const char *name, int value)
+{
+    const resource_int_t *r;
+
+    for (r = bench_resources; r->name != NULL; r++) {
+        if (!strcmp(r->name, name)) {
+            return r->set_func(value, r->param);
+        }
+    }
+    return -1;
+}
+
+int cmdline_register_options(const cmdline_option_t *c)
+{
+    return 0;
+}
+
+/* Traps are taken right away, as at the end of the frame.  */
+void interrupt_maincpu_trigger_trap(void (*trap_func)(uint16_t, void *data), void *data)
+{
+    trap_func(0, data);
+}
+
+unsigned long tick_per_second(void)
+{
+    return 1000000;
+}
+
+unsigned long tick_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+unsigned long tick_delta(unsigned long previous_tick)
+{
+    return tick_now() - previous_tick;
+}
+
+double vsync_get_refresh_frequency(void)
+{
+    return BENCH_REFRESH;
+}
+
+static uint32_t bench_sum(const uint8_t *data, size_t size)
+{
+    uint32_t sum = 0;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        sum = sum * 31 + data[i];
+    }
+    return sum;
+}
+
+int machine_write_snapshot_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode)
+{
+    if (mem->capacity < BENCH_STATE_SIZE) {
+        mem->data = lib_realloc(mem->data, BENCH_STATE_SIZE);
+        mem->capacity = BENCH_STATE_SIZE;
+    }
+    memcpy(mem->data, bench_state, BENCH_STATE_SIZE);
+    mem->size = BENCH_STATE_SIZE;
+    return 0;
+}
+
+int machine_read_snapshot_memory(const uint8_t *data, size_t size, int event_mode)
+{
+    double oldest, newest;
+
+    rewind_get_span(&oldest, &newest);
+    bench_restored_frame = (unsigned long)(newest * BENCH_REFRESH + 0.5);
+
+    if (size != BENCH_STATE_SIZE
+        || bench_sum(data, size) != bench_sums[bench_restored_frame]) {
+        bench_errors++;
+    }
+    memcpy(bench_state, data, size);
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* One frame of the synthetic machine; RAM starts at offset 200.  */
+static void bench_run_frame(void)
+{
+    uint8_t *ram = bench_state + 200;
+    int i, x;
+
+    bench_frame++;
+
+    /* CPU, CIA and VIC-II registers and clocks.  */
+    for (i = 0; i < 40; i++) {
+        bench_state[i * 4] = (uint8_t)(bench_frame * (i + 1));
+    }
+
+    /* Zero page and stack.  */
+    for (i = 0; i < 24; i++) {
+        ram[rand() & 0x1ff] = (uint8_t)rand();
+    }
+
+    /* A scrolling text line on the screen at $0400.  */
+    if ((bench_frame & 3) == 0) {
+        memmove(ram + 0x0400 + 20 * 40, ram + 0x0400 + 20 * 40 + 1, 39);
+        ram[0x0400 + 20 * 40 + 39] = (uint8_t)(bench_frame >> 2);
+    }
+
+    /* A sprite moving over a bitmap at $2000.  */
+    x = (int)(bench_frame % 280);
+    for (i = 0; i < 21; i++) {
+        ram[0x2000 + i * 320 + x] ^= 0xff;
+    }
+}
+
+static void bench_interval(int interval, unsigned long frames)
+{
+    rewind_stats_t stats;
+    double oldest, newest, t;
+    unsigned long steps = 0, jumps = 0, f;
+
+    resources_set_int("RewindInterval", interval);
+    resources_set_int("RewindEnable", 0);
+    resources_set_int("RewindEnable", 1);
+
+    srand(interval);
+    memset(bench_state, 0, sizeof(bench_state));
+    for (f = 200; f < BENCH_STATE_SIZE; f++) {
+        bench_state[f] = (uint8_t)(f * 7 + (f >> 8));
+    }
+    bench_frame = 0;
+    bench_sums[0] = bench_sum(bench_state, BENCH_STATE_SIZE);
+
+    for (f = 0; f < frames; f++) {
+        bench_run_frame();
+        bench_sums[bench_frame] = bench_sum(bench_state, BENCH_STATE_SIZE);
+        rewind_vsync_hook();
+    }
+
+    rewind_get_stats(&stats);
+    rewind_get_span(&oldest, &newest);
+
+    printf("%8d %8.2f %8.1f %8u %8u %8lu %8.1f",
+           interval, stats.frame_cost_us,
+           stats.frame_cost_us * interval,
+           stats.entries, stats.keyframes,
+           stats.entries ? stats.bytes_used / stats.entries : 0,
+           newest - oldest);
+
+    /* Jump to random times, then step back through the whole buffer.  */
+    t = now();
+    for (jumps = 0; jumps < 100; jumps++) {
+        double when = oldest + (newest - oldest) * (rand() % 1000) / 1000.0;
+
+        rewind_jump_to_time(when);
+        if (bench_restored_frame > (unsigned long)(when * BENCH_REFRESH)) {
+            bench_errors++;
+        }
+        rewind_get_span(&oldest, &newest);
+    }
+    while (rewind_get_span(&oldest, &newest) == 0 && newest > oldest) {
+        rewind_step_back(1);
+        steps++;
+    }
+    t = now() - t;
+
+    printf(" %10.1f\n", t * 1e6 / (jumps + steps));
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long frames = argc > 1 ? strtoul(argv[1], NULL, 10) : 30000;
+    int kb = argc > 2 ? atoi(argv[2]) : 16384;
+    static const int intervals[] = { 1, 2, 5, 10, 25, 0 };
+    int i;
+
+    bench_sums = lib_malloc((frames + 1) * sizeof(uint32_t));
+
+    rewind_resources_init();
+    if (resources_set_int("RewindBufferSize", kb) < 0) {
+        fprintf(stderr, "invalid buffer size %d kB\n", kb);
+        return 1;
+    }
+
+    printf("%lu frames of %d bytes, %d kB buffer\n", frames, BENCH_STATE_SIZE, kb);
+    printf("%8s %8s %8s %8s %8s %8s %8s %10s\n", "interval", "us/frame",
+           "us/state", "states", "keys", "B/state", "span s", "us/restore");
+
+    for (i = 0; intervals[i] != 0; i++) {
+        bench_interval(intervals[i], frames);
+    }
+
+    rewind_resources_shutdown();
+    lib_free(bench_sums);
+
+    if (bench_errors) {
+        printf("%d restored states differ\n", bench_errors);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,674 @@
+/*
+ * rewind.c - Rewind to earlier machine states.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Every `RewindInterval' frames a memory snapshot of the machine is taken
+   and stored in a ring buffer of `RewindBufferSize' kB.  Most states are
+   stored as the difference to the last keyframe: the snapshot XORed with
+   the keyframe, with the runs of zeros (unchanged bytes) left out.  Only
+   keyframes are stored in full (again with runs of zeros left out).  Since
+   a frame changes only a small part of the RAM, a state takes a few kB.
+
+   The encoded data is a sequence of
+
+     n bytes  number of unchanged bytes
+     n bytes  number of changed bytes
+     m bytes  changed bytes, XORed with the keyframe
+
+   with the numbers stored 7 bits per byte, least significant group first,
+   bit 7 set on all but the last byte.
+
+   When the buffer is full the oldest states are dropped, a keyframe
+   together with all the states depending on it.  Snapshots are taken and
+   restored from CPU traps, where the CPU state is consistent.  */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cmdline.h"
+#include "interrupt.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "resources.h"
+#include "rewind.h"
+#include "snapshot.h"
+#include "tick.h"
+#include "types.h"
+#include "vsync.h"
+
+/* Runs of unchanged bytes shorter than this are stored as changed.  */
+#define REWIND_RUN_MIN          4
+
+/* Maximum number of states between two keyframes.  */
+#define REWIND_KEYFRAME_DISTANCE    64
+
+/* Smallest expected size of a state, determines the number of entries.  */
+#define REWIND_ENTRY_SIZE_MIN   512
+
+typedef struct rewind_entry_s {
+    unsigned long frame;    /* Frame the state was taken at.  */
+    size_t offset;          /* Offset of the encoded state in the buffer.  */
+    size_t encoded_size;    /* Size of the encoded state.  */
+    size_t size;            /* Size of the snapshot.  */
+    int keyframe;           /* Flag: stored in full.  */
+} rewind_entry_t;
+
+static int rewind_enabled = 0;
+static int rewind_interval = 1;
+static int rewind_buffer_kb = 0;
+
+/* Ring buffer with the encoded states.  */
+static uint8_t *rewind_buffer = NULL;
+static size_t rewind_buffer_size = 0;
+static size_t rewind_buffer_pos = 0;
+static unsigned long rewind_bytes_used = 0;
+
+/* The states in the buffer, oldest first.  */
+static rewind_entry_t *rewind_entries = NULL;
+static unsigned int rewind_entries_max = 0;
+static unsigned int rewind_entries_first = 0;
+static unsigned int rewind_entries_num = 0;
+static unsigned int rewind_keyframes = 0;
+
+/* Snapshot being taken or restored.  */
+static snapshot_memory_t rewind_snapshot = { NULL, 0, 0 };
+
+/* The last keyframe, unencoded.  */
+static snapshot_memory_t rewind_key = { NULL, 0, 0 };
+static unsigned long rewind_key_frame = 0;
+static size_t rewind_key_encoded_size = 0;
+static int rewind_key_valid = 0;
+static unsigned int rewind_key_distance = 0;
+
+/* Scratch buffer for encoding.  */
+static uint8_t *rewind_encoded = NULL;
+static size_t rewind_encoded_size = 0;
+
+/* Frames since rewind was enabled.  */
+static unsigned long rewind_frame = 0;
+
+static int rewind_capture_pending = 0;
+static int rewind_restore_pending = 0;
+static unsigned long rewind_restore_frame = 0;
+
+/* Capture timings in ticks.  */
+static unsigned long rewind_last_capture_ticks = 0;
+static unsigned long rewind_max_capture_ticks = 0;
+static double rewind_capture_ticks = 0.0;
+static unsigned long rewind_frames_measured = 0;
+
+/* ------------------------------------------------------------------------- */
+
+static uint8_t *rewind_grow(uint8_t *buf, size_t *size, size_t needed)
+{
+    if (needed > *size) {
+        *size = needed + needed / 4;
+        buf = lib_realloc(buf, *size);
+    }
+    return buf;
+}
+
+static size_t rewind_put_number(uint8_t *p, size_t value)
+{
+    size_t n = 0;
+
+    while (value >= 0x80) {
+        p[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (uint8_t)value;
+    return n;
+}
+
+static const uint8_t *rewind_get_number(const uint8_t *p, const uint8_t *end, size_t *value)
+{
+    size_t v = 0;
+    int shift = 0;
+
+    while (p < end && (*p & 0x80)) {
+        v |= (size_t)(*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    if (p == end) {
+        return NULL;
+    }
+    *value = v | ((size_t)*p++ << shift);
+    return p;
+}
+
+/* Byte `i' of the keyframe; the keyframe is padded with zeros.  */
+#define KEY_BYTE(i) ((i) < key_size ? key[i] : 0)
+
+/* Length of the run of bytes equal to the keyframe starting at `i'.  */
+static size_t rewind_equal_run(const uint8_t *data, size_t size,
+                               const uint8_t *key, size_t key_size, size_t i)
+{
+    size_t start = i;
+    size_t common = size < key_size ? size : key_size;
+    uint64_t a, b;
+
+    if (key != NULL) {
+        while (i + 8 <= common) {
+            memcpy(&a, data + i, 8);
+            memcpy(&b, key + i, 8);
+            if (a != b) {
+                break;
+            }
+            i += 8;
+        }
+        while (i < common && data[i] == key[i]) {
+            i++;
+        }
+        if (i < common) {
+            return i - start;
+        }
+    }
+
+    while (i + 8 <= size) {
+        memcpy(&a, data + i, 8);
+        if (a != 0) {
+            break;
+        }
+        i += 8;
+    }
+    while (i < size && data[i] == 0) {
+        i++;
+    }
+    return i - start;
+}
+
+/* Encode `data' against the keyframe `key' (or zeros if NULL).  `out' must
+   hold 2 * size + 16 bytes.  */
+static size_t rewind_encode(uint8_t *out, const uint8_t *data, size_t size,
+                            const uint8_t *key, size_t key_size)
+{
+    size_t i = 0, o = 0;
+
+    if (key == NULL) {
+        key_size = 0;
+    }
+
+    while (i < size) {
+        size_t equal, changed, j;
+        int run = 0;
+
+        equal = rewind_equal_run(data, size, key, key_size, i);
+        i += equal;
+
+        /* Changed bytes up to the next run of REWIND_RUN_MIN equal ones.  */
+        for (j = i; j < size && run < REWIND_RUN_MIN; j++) {
+            run = (data[j] == KEY_BYTE(j)) ? run + 1 : 0;
+        }
+        changed = j - run - i;
+
+        o += rewind_put_number(out + o, equal);
+        o += rewind_put_number(out + o, changed);
+        for (j = 0; j < changed; j++, i++) {
+            out[o++] = data[i] ^ KEY_BYTE(i);
+        }
+    }
+
+    return o;
+}
+
+static int rewind_decode(uint8_t *out, size_t size, const uint8_t *in, size_t in_size,
+                         const uint8_t *key, size_t key_size)
+{
+    const uint8_t *end = in + in_size;
+    size_t i = 0, equal, changed, j;
+
+    if (key == NULL) {
+        key_size = 0;
+    }
+
+    while (in < end) {
+        in = rewind_get_number(in, end, &equal);
+        if (in == NULL || (in = rewind_get_number(in, end, &changed)) == NULL
+            || equal > size - i || changed > size - i - equal
+            || changed > (size_t)(end - in)) {
+            return -1;
+        }
+        for (j = 0; j < equal; j++, i++) {
+            out[i] = KEY_BYTE(i);
+        }
+        for (j = 0; j < changed; j++, i++) {
+            out[i] = *in++ ^ KEY_BYTE(i);
+        }
+    }
+
+    return i == size ? 0 : -1;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static rewind_entry_t *rewind_entry(unsigned int i)
+{
+    return &rewind_entries[(rewind_entries_first + i) % rewind_entries_max];
+}
+
+/* Drop the oldest keyframe and the states depending on it.  */
+static void rewind_drop_oldest(void)
+{
+    rewind_entry_t *e;
+
+    do {
+        e = rewind_entry(0);
+        if (e->keyframe) {
+            if (e->frame == rewind_key_frame) {
+                rewind_key_valid = 0;
+            }
+            rewind_keyframes--;
+        }
+        rewind_bytes_used -= (unsigned long)e->encoded_size;
+        rewind_entries_first = (rewind_entries_first + 1) % rewind_entries_max;
+        rewind_entries_num--;
+    } while (rewind_entries_num > 0 && !rewind_entry(0)->keyframe);
+
+    if (rewind_entries_num == 0) {
+        rewind_buffer_pos = 0;
+    }
+}
+
+/* Make room for `size' bytes and an entry, return the offset or -1.  The
+   states are stored one after the other; states from the previous round
+   through the buffer start at or after the current position.  */
+static long rewind_make_room(size_t size)
+{
+    if (size > rewind_buffer_size) {
+        return -1;
+    }
+
+    if (rewind_entries_num == rewind_entries_max) {
+        rewind_drop_oldest();
+    }
+
+    if (rewind_buffer_pos + size > rewind_buffer_size) {
+        while (rewind_entries_num > 0 && rewind_entry(0)->offset >= rewind_buffer_pos) {
+            rewind_drop_oldest();
+        }
+        rewind_buffer_pos = 0;
+    }
+
+    while (rewind_entries_num > 0
+           && rewind_entry(0)->offset >= rewind_buffer_pos
+           && rewind_entry(0)->offset < rewind_buffer_pos + size) {
+        rewind_drop_oldest();
+    }
+
+    return (long)rewind_buffer_pos;
+}
+
+static void rewind_store(unsigned long frame)
+{
+    const uint8_t *data = rewind_snapshot.data;
+    size_t size = rewind_snapshot.size;
+    size_t n = 0;
+    long offset;
+    int keyframe;
+    rewind_entry_t *e;
+
+    rewind_encoded = rewind_grow(rewind_encoded, &rewind_encoded_size, 2 * size + 16);
+
+    keyframe = !rewind_key_valid || rewind_key_distance >= REWIND_KEYFRAME_DISTANCE;
+    if (!keyframe) {
+        n = rewind_encode(rewind_encoded, data, size, rewind_key.data, rewind_key.size);
+        /* A new keyframe is cheaper once the states drift too far.  */
+        keyframe = n > rewind_key_encoded_size / 2;
+    }
+
+    while (1) {
+        if (keyframe) {
+            n = rewind_encode(rewind_encoded, data, size, NULL, 0);
+        }
+        offset = rewind_make_room(n);
+        if (offset < 0) {
+            log_error(LOG_DEFAULT, "Rewind: state of %lu bytes does not fit into the buffer.",
+                      (unsigned long)n);
+            return;
+        }
+        /* Making room may have dropped the keyframe of this state.  */
+        if (keyframe || rewind_key_valid) {
+            break;
+        }
+        keyframe = 1;
+    }
+
+    memcpy(rewind_buffer + offset, rewind_encoded, n);
+    rewind_buffer_pos = (size_t)offset + n;
+    rewind_bytes_used += (unsigned long)n;
+
+    e = rewind_entry(rewind_entries_num++);
+    e->frame = frame;
+    e->offset = (size_t)offset;
+    e->encoded_size = n;
+    e->size = size;
+    e->keyframe = keyframe;
+
+    if (keyframe) {
+        rewind_key.data = rewind_grow(rewind_key.data, &rewind_key.capacity, size);
+        memcpy(rewind_key.data, data, size);
+        rewind_key.size = size;
+        rewind_key_frame = frame;
+        rewind_key_encoded_size = n;
+        rewind_key_valid = 1;
+        rewind_key_distance = 0;
+        rewind_keyframes++;
+    } else {
+        rewind_key_distance++;
+    }
+}
+
+static void rewind_capture_trap(uint16_t addr, void *data)
+{
+    unsigned long start = tick_now();
+    unsigned long ticks;
+
+    rewind_capture_pending = 0;
+
+    if (!rewind_enabled || rewind_restore_pending) {
+        return;
+    }
+
+    if (machine_write_snapshot_memory(&rewind_snapshot, 0, 0, 0) < 0) {
+        log_error(LOG_DEFAULT, "Rewind: cannot take snapshot, rewind disabled.");
+        resources_set_int("RewindEnable", 0);
+        return;
+    }
+
+    rewind_store(rewind_frame);
+
+    ticks = tick_delta(start);
+    rewind_last_capture_ticks = ticks;
+    if (ticks > rewind_max_capture_ticks) {
+        rewind_max_capture_ticks = ticks;
+    }
+    rewind_capture_ticks += (double)ticks;
+}
+
+static void rewind_restore_trap(uint16_t addr, void *data)
+{
+    rewind_entry_t *e, *k;
+    const uint8_t *state;
+    unsigned int i, key;
+
+    rewind_restore_pending = 0;
+
+    if (!rewind_enabled || rewind_entries_num == 0) {
+        return;
+    }
+
+    /* Newest state not after the target, or the oldest one.  */
+    for (i = rewind_entries_num - 1; i > 0; i--) {
+        if (rewind_entry(i)->frame <= rewind_restore_frame) {
+            break;
+        }
+    }
+    for (key = i; !rewind_entry(key)->keyframe; key--) {
+    }
+    e = rewind_entry(i);
+    k = rewind_entry(key);
+
+    rewind_key.data = rewind_grow(rewind_key.data, &rewind_key.capacity, k->size);
+    rewind_key.size = k->size;
+    if (rewind_decode(rewind_key.data, k->size, rewind_buffer + k->offset, k->encoded_size, NULL, 0) < 0) {
+        goto fail;
+    }
+    state = rewind_key.data;
+
+    if (e != k) {
+        rewind_snapshot.data = rewind_grow(rewind_snapshot.data, &rewind_snapshot.capacity, e->size);
+        rewind_snapshot.size = e->size;
+        if (rewind_decode(rewind_snapshot.data, e->size, rewind_buffer + e->offset, e->encoded_size,
+                          rewind_key.data, rewind_key.size) < 0) {
+            goto fail;
+        }
+        state = rewind_snapshot.data;
+    }
+
+    /* The states after this one belong to a future that did not happen.  */
+    while (rewind_entries_num > i + 1) {
+        rewind_entry_t *last = rewind_entry(--rewind_entries_num);
+
+        rewind_bytes_used -= (unsigned long)last->encoded_size;
+        if (last->keyframe) {
+            rewind_keyframes--;
+        }
+    }
+    rewind_buffer_pos = e->offset + e->encoded_size;
+
+    rewind_key_frame = k->frame;
+    rewind_key_encoded_size = k->encoded_size;
+    rewind_key_valid = 1;
+    rewind_key_distance = i - key;
+    rewind_frame = e->frame;
+
+    if (machine_read_snapshot_memory(state, e->size, 0) < 0) {
+        log_error(LOG_DEFAULT, "Rewind: cannot restore state of frame %lu.", e->frame);
+        rewind_reset();
+    }
+    return;
+
+fail:
+    log_error(LOG_DEFAULT, "Rewind: corrupt state in buffer.");
+    rewind_reset();
+}
+
+static int rewind_request(unsigned long frame)
+{
+    if (!rewind_enabled || rewind_entries_num == 0) {
+        return -1;
+    }
+
+    rewind_restore_frame = frame;
+    if (!rewind_restore_pending) {
+        rewind_restore_pending = 1;
+        interrupt_maincpu_trigger_trap(rewind_restore_trap, NULL);
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void rewind_reset(void)
+{
+    rewind_entries_first = 0;
+    rewind_entries_num = 0;
+    rewind_keyframes = 0;
+    rewind_buffer_pos = 0;
+    rewind_bytes_used = 0;
+    rewind_key_valid = 0;
+    rewind_frame = 0;
+    rewind_last_capture_ticks = 0;
+    rewind_max_capture_ticks = 0;
+    rewind_capture_ticks = 0.0;
+    rewind_frames_measured = 0;
+}
+
+static void rewind_free(void)
+{
+    lib_free(rewind_buffer);
+    rewind_buffer = NULL;
+    rewind_buffer_size = 0;
+    lib_free(rewind_entries);
+    rewind_entries = NULL;
+    rewind_entries_max = 0;
+    lib_free(rewind_snapshot.data);
+    rewind_snapshot.data = NULL;
+    rewind_snapshot.size = rewind_snapshot.capacity = 0;
+    lib_free(rewind_key.data);
+    rewind_key.data = NULL;
+    rewind_key.size = rewind_key.capacity = 0;
+    lib_free(rewind_encoded);
+    rewind_encoded = NULL;
+    rewind_encoded_size = 0;
+    rewind_reset();
+}
+
+static void rewind_alloc(void)
+{
+    rewind_free();
+    rewind_buffer_size = (size_t)rewind_buffer_kb * 1024;
+    rewind_buffer = lib_malloc(rewind_buffer_size);
+    rewind_entries_max = (unsigned int)(rewind_buffer_size / REWIND_ENTRY_SIZE_MIN);
+    rewind_entries = lib_malloc(rewind_entries_max * sizeof(rewind_entry_t));
+}
+
+void rewind_vsync_hook(void)
+{
+    if (!rewind_enabled) {
+        return;
+    }
+
+    rewind_frame++;
+    rewind_frames_measured++;
+
+    if (!rewind_capture_pending && !rewind_restore_pending
+        && rewind_frame % rewind_interval == 0) {
+        rewind_capture_pending = 1;
+        interrupt_maincpu_trigger_trap(rewind_capture_trap, NULL);
+    }
+}
+
+int rewind_step_back(unsigned int frames)
+{
+    unsigned long frame = rewind_restore_pending ? rewind_restore_frame : rewind_frame;
+
+    return rewind_request(frame > frames ? frame - frames : 0);
+}
+
+int rewind_jump_to_time(double seconds)
+{
+    double frame = seconds * vsync_get_refresh_frequency();
+
+    return rewind_request(frame > 0.0 ? (unsigned long)frame : 0);
+}
+
+int rewind_get_span(double *oldest, double *newest)
+{
+    double refresh = vsync_get_refresh_frequency();
+
+    if (rewind_entries_num == 0 || refresh <= 0.0) {
+        return -1;
+    }
+
+    *oldest = rewind_entry(0)->frame / refresh;
+    *newest = rewind_entry(rewind_entries_num - 1)->frame / refresh;
+    return 0;
+}
+
+void rewind_get_stats(rewind_stats_t *stats)
+{
+    double us_per_tick = 1000000.0 / (double)tick_per_second();
+
+    stats->entries = rewind_entries_num;
+    stats->keyframes = rewind_keyframes;
+    stats->bytes_used = rewind_bytes_used;
+    stats->bytes_budget = (unsigned long)rewind_buffer_size;
+    stats->snapshot_size = (unsigned long)rewind_snapshot.size;
+    stats->last_capture_us = rewind_last_capture_ticks * us_per_tick;
+    stats->max_capture_us = rewind_max_capture_ticks * us_per_tick;
+    stats->frame_cost_us = rewind_frames_measured
+                           ? rewind_capture_ticks * us_per_tick / rewind_frames_measured
+                           : 0.0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int set_rewind_enable(int val, void *param)
+{
+    val = val ? 1 : 0;
+
+    if (val && !rewind_enabled) {
+        rewind_alloc();
+    } else if (!val && rewind_enabled) {
+        rewind_free();
+    }
+    rewind_enabled = val;
+    return 0;
+}
+
+static int set_rewind_interval(int val, void *param)
+{
+    if (val < 1 || val > 3000) {
+        return -1;
+    }
+    rewind_interval = val;
+    return 0;
+}
+
+static int set_rewind_buffer_size(int val, void *param)
+{
+    if (val < 256) {
+        return -1;
+    }
+    rewind_buffer_kb = val;
+    if (rewind_enabled) {
+        rewind_alloc();
+    }
+    return 0;
+}
+
+static const resource_int_t resources_int[] = {
+    { "RewindEnable", 0, RES_EVENT_NO, NULL,
+      &rewind_enabled, set_rewind_enable, NULL },
+    { "RewindInterval", 5, RES_EVENT_NO, NULL,
+      &rewind_interval, set_rewind_interval, NULL },
+    { "RewindBufferSize", 16384, RES_EVENT_NO, NULL,
+      &rewind_buffer_kb, set_rewind_buffer_size, NULL },
+    RESOURCE_INT_LIST_END
+};
+
+int rewind_resources_init(void)
+{
+    return resources_register_int(resources_int);
+}
+
+void rewind_resources_shutdown(void)
+{
+    rewind_free();
+}
+
+static const cmdline_option_t cmdline_options[] =
+{
+    { "-rewind", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "RewindEnable", (resource_value_t)1,
+      NULL, "Keep earlier machine states to rewind to" },
+    { "+rewind", SET_RESOURCE, CMDLINE_ATTRIB_NONE,
+      NULL, NULL, "RewindEnable", (resource_value_t)0,
+      NULL, "Do not keep earlier machine states" },
+    { "-rewindinterval", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "RewindInterval", NULL,
+      "<frames>", "Set the number of frames between two rewind states" },
+    { "-rewindbuffer", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "RewindBufferSize", NULL,
+      "<kB>", "Set the size of the rewind buffer in kB" },
+    CMDLINE_LIST_END
+};
+
+int rewind_cmdline_options_init(void)
+{
+    return cmdline_register_options(cmdline_options);
+}
@@ -0,0 +1,63 @@
+/*
+ * rewind.h - Rewind to earlier machine states.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_REWIND_H
+#define VICE_REWIND_H
+
+#include "types.h"
+
+typedef struct rewind_stats_s {
+    unsigned int entries;           /* States in the buffer.  */
+    unsigned int keyframes;         /* Of those, stored in full.  */
+    unsigned long bytes_used;       /* Encoded size of all states.  */
+    unsigned long bytes_budget;     /* Size of the buffer.  */
+    unsigned long snapshot_size;    /* Size of the last state, unencoded.  */
+    double last_capture_us;         /* Time taken by the last capture.  */
+    double max_capture_us;          /* Slowest capture so far.  */
+    double frame_cost_us;           /* Capture time averaged over frames.  */
+} rewind_stats_t;
+
+extern int rewind_resources_init(void);
+extern void rewind_resources_shutdown(void);
+extern int rewind_cmdline_options_init(void);
+
+/* To be called by the machine once per frame.  */
+extern void rewind_vsync_hook(void);
+
+/* Forget all states.  */
+extern void rewind_reset(void);
+
+/* Return to the newest state at least `frames' frames back.  */
+extern int rewind_step_back(unsigned int frames);
+
+/* Return to the newest state not after `seconds', as reported by
+   `rewind_get_span()'.  */
+extern int rewind_jump_to_time(double seconds);
+
+/* Emulated time of the oldest and newest state, in seconds since rewind
+   was enabled.  Returns -1 if there are no states.  */
+extern int rewind_get_span(double *oldest, double *newest);
+
+extern void rewind_get_stats(rewind_stats_t *stats);
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ * resid-replay.cc - Replay sound traces through reSID without the emulator.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: resid-replay [-rate <Hz>] [-model 6581|8580] [-method <n>]
+                       [-block] <trace>
+
+   Replays a trace recorded with `-soundtrace' (see soundtrace.h) through
+   reSID at full speed, for every sampling method and chip model unless
+   restricted, and reports output samples per second, the speed relative to
+   real time and a checksum of the output.  The SIDs are set up with the
+   default reSID resources (see sid/resid.cc).
+
+   With `-block' the block clocking engine is compared sample for sample
+   against single cycle clocking over the trace instead.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "soundtrace.h"
+#include "resid/sid.h"
+
+using namespace reSID;
+
+#define REPLAY_CHIPS_MAX 8
+
+struct trace_write_s {
+    int delta;
+    unsigned char chip;
+    unsigned char reg;
+    unsigned char value;
+};
+
+typedef struct trace_write_s trace_write_t;
+
+static trace_write_t *writes = NULL;
+static int writes_nr = 0;
+static int trace_chips = 1;
+static long cycles_per_sec = 985248;
+
+static const char *method_names[] = {
+    "fast", "interpolating", "resampling", "fast resampling"
+};
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Decode the whole trace up front so that parsing is not measured.  */
+static int trace_load(const char *name)
+{
+    FILE *fd;
+    unsigned char *data;
+    long size, pos;
+    int alloc = 0;
+
+    fd = fopen(name, "rb");
+    if (fd == NULL) {
+        fprintf(stderr, "cannot open %s\n", name);
+        return -1;
+    }
+    fseek(fd, 0, SEEK_END);
+    size = ftell(fd);
+    fseek(fd, 0, SEEK_SET);
+    data = (unsigned char *)malloc(size > 0 ? size : 1);
+    if (fread(data, 1, size, fd) != (size_t)size) {
+        fclose(fd);
+        free(data);
+        return -1;
+    }
+    fclose(fd);
+
+    if (size < SOUND_TRACE_HEADER_SIZE
+        || memcmp(data, SOUND_TRACE_MAGIC, SOUND_TRACE_MAGIC_LEN) != 0
+        || data[8] != SOUND_TRACE_VERSION) {
+        fprintf(stderr, "%s is not a sound trace\n", name);
+        free(data);
+        return -1;
+    }
+
+    trace_chips = data[9] ? data[9] : 1;
+    if (trace_chips > REPLAY_CHIPS_MAX) {
+        trace_chips = REPLAY_CHIPS_MAX;
+    }
+    cycles_per_sec = data[12] | (data[13] << 8) | (data[14] << 16) | ((long)data[15] << 24);
+
+    for (pos = SOUND_TRACE_HEADER_SIZE; pos < size; ) {
+        long delta = 0;
+        int shift = 0;
+
+        while (pos < size && (data[pos] & 0x80)) {
+            delta |= (long)(data[pos++] & 0x7f) << shift;
+            shift += 7;
+        }
+        if (pos + 4 > size) {
+            break;
+        }
+        delta |= (long)data[pos++] << shift;
+
+        if (writes_nr == alloc) {
+            alloc = alloc ? alloc * 2 : 65536;
+            writes = (trace_write_t *)realloc(writes, alloc * sizeof(trace_write_t));
+        }
+        writes[writes_nr].delta = (int)delta;
+        writes[writes_nr].chip = data[pos++];
+        writes[writes_nr].reg = data[pos++];
+        writes[writes_nr].value = data[pos++];
+        writes_nr++;
+    }
+
+    free(data);
+    return 0;
+}
+
+static void sid_setup(SID *sid, chip_model model)
+{
+    sid->set_chip_model(model);
+    sid->set_voice_mask(0x07);
+    sid->input(0);
+    sid->enable_filter(true);
+    sid->adjust_filter_bias(0.5);
+    sid->enable_external_filter(true);
+}
+
+static unsigned int replay(chip_model model, sampling_method method, int rate,
+                           long *samples, double *elapsed)
+{
+    SID *sid[REPLAY_CHIPS_MAX];
+    static short buf[8192];
+    unsigned int checksum = 0;
+    int c, i, n;
+
+    for (c = 0; c < trace_chips; c++) {
+        sid[c] = new SID;
+        sid_setup(sid[c], model);
+        sid[c]->set_sampling_parameters((double)cycles_per_sec, method,
+                                        (double)rate, rate * 90 / 200.0, 0.97);
+    }
+
+    *samples = 0;
+    *elapsed = now();
+
+    for (i = 0; i < writes_nr; i++) {
+        for (c = 0; c < trace_chips; c++) {
+            cycle_count delta_t = writes[i].delta;
+
+            while (delta_t > 0) {
+                n = sid[c]->clock(delta_t, buf, (int)(sizeof(buf) / sizeof(buf[0])));
+                for (int s = 0; s < n; s++) {
+                    checksum = checksum * 31 + (unsigned short)buf[s];
+                }
+                *samples += n;
+            }
+        }
+        if (writes[i].chip < trace_chips && writes[i].reg < 0x20) {
+            sid[writes[i].chip]->write(writes[i].reg, writes[i].value);
+        }
+    }
+
+    *elapsed = now() - *elapsed;
+
+    for (c = 0; c < trace_chips; c++) {
+        delete sid[c];
+    }
+
+    return checksum;
+}
+
+/* Compare SID::clock(n, out) against single cycle clocking.  */
+static int verify_block(chip_model model)
+{
+    SID sid_cycle, sid_block;
+    static short out_cycle[65536], out_block[65536];
+    int i, c;
+
+    sid_setup(&sid_cycle, model);
+    sid_setup(&sid_block, model);
+
+    for (i = 0; i < writes_nr; i++) {
+        int delta = writes[i].delta;
+
+        while (delta > 0) {
+            int n = delta < 65536 ? delta : 65536;
+
+            for (c = 0; c < n; c++) {
+                int o;
+
+                sid_cycle.clock();
+                o = sid_cycle.output();
+                out_cycle[c] = o > 32767 ? 32767 : o < -32768 ? -32768 : o;
+            }
+            sid_block.clock(n, out_block);
+
+            if (memcmp(out_cycle, out_block, n * sizeof(short)) != 0) {
+                printf("mismatch before write %d\n", i);
+                return -1;
+            }
+            delta -= n;
+        }
+        if (writes[i].chip == 0 && writes[i].reg < 0x20) {
+            sid_cycle.write(writes[i].reg, writes[i].value);
+            sid_block.write(writes[i].reg, writes[i].value);
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = NULL;
+    int rate = 48000;
+    int model_only = -1;
+    int method_only = -1;
+    int block = 0;
+    int failed = 0;
+    int i, m, k;
+    double cycles = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-rate") && i + 1 < argc) {
+            rate = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-model") && i + 1 < argc) {
+            model_only = atoi(argv[++i]) == 8580 ? MOS8580 : MOS6581;
+        } else if (!strcmp(argv[i], "-method") && i + 1 < argc) {
+            method_only = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-block")) {
+            block = 1;
+        } else {
+            name = argv[i];
+        }
+    }
+
+    if (name == NULL) {
+        fprintf(stderr, "usage: %s [-rate <Hz>] [-model 6581|8580] [-method <0-3>] [-block] <trace>\n", argv[0]);
+        return 1;
+    }
+
+    if (trace_load(name) < 0) {
+        return 1;
+    }
+
+    for (i = 0; i < writes_nr; i++) {
+        cycles += writes[i].delta;
+    }
+
+    printf("%s: %d writes, %d chip(s), %.1f s at %ld cycles/s, kernel %s\n",
+           name, writes_nr, trace_chips, cycles / cycles_per_sec,
+           cycles_per_sec, SID::get_convolution_kernel());
+
+    for (m = MOS6581; m <= MOS8580; m++) {
+        if (model_only >= 0 && m != model_only) {
+            continue;
+        }
+
+        if (block) {
+            int result = verify_block((chip_model)m);
+
+            printf("%s block clocking: %s\n", m == MOS6581 ? "6581" : "8580",
+                   result < 0 ? "FAILED" : "identical");
+            failed |= result < 0;
+            continue;
+        }
+
+        for (k = SAMPLE_FAST; k <= SAMPLE_RESAMPLE_FASTMEM; k++) {
+            long samples;
+            double elapsed;
+            unsigned int checksum;
+
+            if (method_only >= 0 && k != method_only) {
+                continue;
+            }
+
+            checksum = replay((chip_model)m, (sampling_method)k, rate,
+                              &samples, &elapsed);
+
+            printf("%s %-16s %12.0f samples/s %8.1fx real time  %08x\n",
+                   m == MOS6581 ? "6581" : "8580", method_names[k],
+                   samples / elapsed,
+                   cycles / cycles_per_sec * trace_chips / elapsed,
+                   checksum);
+        }
+    }
+
+    free(writes);
+
+    return failed;
+}
@@ -0,0 +1,364 @@
+/*
+ * snapshot-benchmark.c - Measure snapshot save and restore times.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: snapshot-benchmark [iterations] [file]
+
+   Writes and reads back snapshots with the module layout of the C64, C128
+   and VIC-20 snapshots (without ROMs and disk images) through the file
+   backend and the memory backend of snapshot.c, checks that the data reads
+   back unchanged and that both backends yield the same bytes, and reports
+   the time per snapshot.  The file is written to `file', by default in the
+   current directory.  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "archdep.h"
+#include "ioutil.h"
+#include "lib.h"
+#include "log.h"
+#include "snapshot.h"
+#include "types.h"
+#include "uiapi.h"
+#include "vsync.h"
+#include "zfile.h"
+
+typedef struct bench_module_s {
+    const char *name;
+    unsigned int bytes;         /* registers and flags, written one by one */
+    unsigned int dwords;        /* clocks and counters */
+    unsigned int array;         /* RAM, written as one byte array */
+} bench_module_t;
+
+typedef struct bench_machine_s {
+    const char *name;
+    const bench_module_t *modules;
+} bench_machine_t;
+
+/* Modelled on c64-snapshot.c with one 1541.  */
+static const bench_module_t c64_modules[] = {
+    { "MAINCPU", 16, 4, 0 },
+    { "C64MEM", 12, 2, 0x10000 },
+    { "CIA1", 40, 2, 0 },
+    { "CIA2", 40, 2, 0 },
+    { "SID", 32, 96, 0 },
+    { "DRIVE", 24, 4, 0 },
+    { "DRIVECPU0", 24, 6, 0x800 },
+    { "VIA1D0", 40, 2, 0 },
+    { "VIA2D0", 40, 2, 0 },
+    { "VIC-II", 220, 8, 1024 + 80 },
+    { "GLUE", 4, 2, 0 },
+    { "KEYBOARD", 16, 0, 0 },
+    { NULL, 0, 0, 0 }
+};
+
+/* Modelled on c128-snapshot.c with one 1571.  */
+static const bench_module_t c128_modules[] = {
+    { "MAINCPU", 16, 4, 0 },
+    { "Z80CPU", 32, 2, 0 },
+    { "C128MEM", 24, 2, 0x20000 },
+    { "MMU", 12, 0, 0 },
+    { "CIA1", 40, 2, 0 },
+    { "CIA2", 40, 2, 0 },
+    { "SID", 32, 96, 0 },
+    { "DRIVE", 24, 4, 0 },
+    { "DRIVECPU0", 24, 6, 0x800 },
+    { "VIA1D0", 40, 2, 0 },
+    { "VIA2D0", 40, 2, 0 },
+    { "CIA1571D0", 40, 2, 0 },
+    { "VIC-II", 220, 8, 1024 + 80 },
+    { "VDC", 64, 4, 0x10000 },
+    { "KEYBOARD", 16, 0, 0 },
+    { NULL, 0, 0, 0 }
+};
+
+/* Modelled on vic20-snapshot.c with all RAM blocks and one 1541.  */
+static const bench_module_t vic20_modules[] = {
+    { "MAINCPU", 16, 4, 0 },
+    { "VIC20MEM", 4, 0, 0x0400 + 0x1000 + 0x0c00 + 4 * 0x2000 },
+    { "VIC-I", 80, 4, 0 },
+    { "VIA1", 40, 2, 0 },
+    { "VIA2", 40, 2, 0 },
+    { "DRIVE", 24, 4, 0 },
+    { "DRIVECPU0", 24, 6, 0x800 },
+    { "VIA1D0", 40, 2, 0 },
+    { "VIA2D0", 40, 2, 0 },
+    { "KEYBOARD", 16, 0, 0 },
+    { NULL, 0, 0, 0 }
+};
+
+static const bench_machine_t machines[] = {
+    { "C64", c64_modules },
+    { "C128", c128_modules },
+    { "VIC20", vic20_modules },
+    { NULL, NULL }
+};
+
+static uint8_t *bench_data;
+static uint8_t *bench_read;
+
+/* Stubs for lib.c and snapshot.c.  The file backend opens snapshots with
+   plain fopen(), that is without the compression check of zfile.c.  */
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+int log_warning(log_t log, const char *format, ...)
+{
+    return 0;
+}
+
+void ui_error(const char *format, ...)
+{
+}
+
+int ioutil_remove(const char *name)
+{
+    return remove(name);
+}
+
+void vsync_suspend_speed_eval(void)
+{
+}
+
+FILE *zfile_fopen(const char *name, const char *mode)
+{
+    return fopen(name, mode);
+}
+
+int zfile_fclose(FILE *stream)
+{
+    return fclose(stream);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int bench_write(snapshot_t *s, const bench_machine_t *machine)
+{
+    const bench_module_t *mod;
+    snapshot_module_t *m;
+    unsigned int i;
+
+    for (mod = machine->modules; mod->name != NULL; mod++) {
+        m = snapshot_module_create(s, mod->name, 1, 0);
+        if (m == NULL) {
+            return -1;
+        }
+        for (i = 0; i < mod->bytes; i++) {
+            if (SMW_B(m, bench_data[i]) < 0) {
+                return -1;
+            }
+        }
+        for (i = 0; i < mod->dwords; i++) {
+            if (SMW_DW(m, (uint32_t)i * 0x01010101) < 0) {
+                return -1;
+            }
+        }
+        if (SMW_BA(m, bench_data, mod->array) < 0
+            || snapshot_module_close(m) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int bench_read_modules(snapshot_t *s, const bench_machine_t *machine)
+{
+    const bench_module_t *mod;
+    snapshot_module_t *m;
+    uint8_t major, minor, b;
+    uint32_t dw;
+    unsigned int i;
+
+    for (mod = machine->modules; mod->name != NULL; mod++) {
+        m = snapshot_module_open(s, mod->name, &major, &minor);
+        if (m == NULL) {
+            return -1;
+        }
+        for (i = 0; i < mod->bytes; i++) {
+            if (SMR_B(m, &b) < 0 || b != bench_data[i]) {
+                return -1;
+            }
+        }
+        for (i = 0; i < mod->dwords; i++) {
+            if (SMR_DW(m, &dw) < 0 || dw != (uint32_t)i * 0x01010101) {
+                return -1;
+            }
+        }
+        if (SMR_BA(m, bench_read, mod->array) < 0
+            || memcmp(bench_read, bench_data, mod->array) != 0
+            || snapshot_module_close(m) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int bench_file(const bench_machine_t *machine, const char *filename,
+                      int iterations, double *t_write, double *t_read)
+{
+    snapshot_t *s;
+    uint8_t major, minor;
+    double t;
+    int i;
+
+    *t_write = *t_read = 0.0;
+
+    for (i = 0; i < iterations; i++) {
+        t = now();
+        s = snapshot_create(filename, 1, 0, machine->name);
+        if (s == NULL || bench_write(s, machine) < 0 || snapshot_close(s) < 0) {
+            return -1;
+        }
+        *t_write += now() - t;
+
+        t = now();
+        s = snapshot_open(filename, &major, &minor, machine->name);
+        if (s == NULL || bench_read_modules(s, machine) < 0 || snapshot_close(s) < 0) {
+            return -1;
+        }
+        *t_read += now() - t;
+    }
+
+    return 0;
+}
+
+/* Both backends must produce the same bytes.  */
+static int bench_compare(const char *filename, const snapshot_memory_t *mem)
+{
+    FILE *f;
+    uint8_t *data;
+    size_t size;
+    int result;
+
+    f = fopen(filename, MODE_READ);
+    if (f == NULL) {
+        return -1;
+    }
+    data = lib_malloc(mem->size + 1);
+    size = fread(data, 1, mem->size + 1, f);
+    fclose(f);
+
+    result = (size == mem->size && memcmp(data, mem->data, size) == 0) ? 0 : -1;
+    lib_free(data);
+    return result;
+}
+
+static int bench_memory(const bench_machine_t *machine, snapshot_memory_t *mem,
+                        int iterations, double *t_write, double *t_read)
+{
+    snapshot_t *s;
+    uint8_t major, minor;
+    double t;
+    int i;
+
+    *t_write = *t_read = 0.0;
+
+    for (i = 0; i < iterations; i++) {
+        t = now();
+        s = snapshot_create_memory(mem, 1, 0, machine->name);
+        if (s == NULL || bench_write(s, machine) < 0 || snapshot_close(s) < 0) {
+            return -1;
+        }
+        *t_write += now() - t;
+
+        t = now();
+        s = snapshot_open_memory(mem->data, mem->size, &major, &minor, machine->name);
+        if (s == NULL || bench_read_modules(s, machine) < 0 || snapshot_close(s) < 0) {
+            return -1;
+        }
+        *t_read += now() - t;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 1000;
+    const char *filename = argc > 2 ? argv[2] : "snapshot-benchmark.vsf";
+    const bench_machine_t *machine;
+    snapshot_memory_t mem = { NULL, 0, 0 };
+    double fw, fr, mw, mr;
+    int i, failed = 0;
+
+    if (iterations < 1) {
+        iterations = 1;
+    }
+
+    bench_data = lib_malloc(0x20000);
+    bench_read = lib_malloc(0x20000);
+    for (i = 0; i < 0x20000; i++) {
+        bench_data[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+
+    printf("%-6s %8s %12s %12s %12s %12s %8s\n", "", "size",
+           "file write", "file read", "mem write", "mem read", "speedup");
+
+    for (machine = machines; machine->name != NULL; machine++) {
+        if (bench_file(machine, filename, iterations, &fw, &fr) < 0
+            || bench_memory(machine, &mem, iterations, &mw, &mr) < 0
+            || bench_compare(filename, &mem) < 0) {
+            printf("%-6s FAILED (error %d)\n", machine->name, snapshot_get_error());
+            failed = 1;
+            continue;
+        }
+        printf("%-6s %8lu %10.1fus %10.1fus %10.1fus %10.1fus %7.1fx\n",
+               machine->name, (unsigned long)mem.size,
+               fw * 1e6 / iterations, fr * 1e6 / iterations,
+               mw * 1e6 / iterations, mr * 1e6 / iterations,
+               (fw + fr) / (mw + mr));
+    }
+
+    ioutil_remove(filename);
+    lib_free(mem.data);
+    lib_free(bench_data);
+    lib_free(bench_read);
+
+    return failed;
+}
@@ -57,9 +57,13 @@ static const char snapshot_version_magic_string[] = "VICE Version\032";
 #define SNAPSHOT_MAGIC_LEN              19
 #define SNAPSHOT_VERSION_MAGIC_LEN      13
 
+/* Initial size of the arena of a memory snapshot, enough for snapshots
+   without ROMs and disk images.  */
+#define SNAPSHOT_MEMORY_ARENA_MIN       0x40000
+
 struct snapshot_module_s {
-    /* File descriptor.  */
-    FILE *file;
+    /* Snapshot the module belongs to.  */
+    snapshot_t *snapshot;
 
     /* Flag: are we writing it?  */
     int write_mode;
@@ -75,21 +79,117 @@ struct snapshot_module_s {
 };
 
 struct snapshot_s {
-    /* File descriptor.  */
+    /* File descriptor, NULL for memory snapshots.  */
     FILE *file;
 
+    /* Arena of a memory snapshot being written.  */
+    snapshot_memory_t *mem;
+
+    /* Buffer of a memory snapshot being read, owned by the caller.  */
+    const uint8_t *data;
+    size_t data_size;
+
+    /* Position in a memory snapshot.  */
+    size_t pos;
+
     /* Offset of the first module.  */
     long first_module_offset;
 
     /* Flag: are we writing it?  */
     int write_mode;
+
+    /* Modules are normally accessed one after the other, so the first one
+       open does not need to go through the allocator.  */
+    snapshot_module_t module;
+    int module_in_use;
 };
 
 /* ------------------------------------------------------------------------- */
 
-static int snapshot_write_byte(FILE *f, uint8_t data)
+/* Low level I/O, either on the snapshot file or on the memory buffer.  */
+
+static int snapshot_memory_write(snapshot_t *s, const void *data, size_t num)
+{
+    snapshot_memory_t *mem = s->mem;
+
+    if (s->pos + num > mem->capacity) {
+        size_t capacity = mem->capacity ? mem->capacity : SNAPSHOT_MEMORY_ARENA_MIN;
+
+        while (capacity < s->pos + num) {
+            capacity *= 2;
+        }
+        mem->data = lib_realloc(mem->data, capacity);
+        mem->capacity = capacity;
+    }
+
+    memcpy(mem->data + s->pos, data, num);
+    s->pos += num;
+    if (s->pos > mem->size) {
+        mem->size = s->pos;
+    }
+    return 0;
+}
+
+static int snapshot_memory_read(snapshot_t *s, void *data, size_t num)
+{
+    if (s->pos > s->data_size || num > s->data_size - s->pos) {
+        return -1;
+    }
+
+    memcpy(data, s->data + s->pos, num);
+    s->pos += num;
+    return 0;
+}
+
+static long snapshot_tell(snapshot_t *s)
+{
+    if (s->file != NULL) {
+        return ftell(s->file);
+    }
+    return (long)s->pos;
+}
+
+static int snapshot_seek(snapshot_t *s, long offset)
+{
+    if (s->file != NULL) {
+        return fseek(s->file, offset, SEEK_SET);
+    }
+    if (offset < 0) {
+        return -1;
+    }
+    s->pos = (size_t)offset;
+    return 0;
+}
+
+static snapshot_module_t *snapshot_module_alloc(snapshot_t *s)
+{
+    snapshot_module_t *m;
+
+    if (s->module_in_use) {
+        m = lib_malloc(sizeof(snapshot_module_t));
+    } else {
+        m = &s->module;
+        s->module_in_use = 1;
+    }
+    m->snapshot = s;
+    return m;
+}
+
+static void snapshot_module_free(snapshot_module_t *m)
+{
+    if (m == &m->snapshot->module) {
+        m->snapshot->module_in_use = 0;
+    } else {
+        lib_free(m);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int snapshot_write_byte(snapshot_t *s, uint8_t data)
 {
-    if (fputc(data, f) == EOF) {
+    if (s->file != NULL ? fputc(data, s->file) == EOF
+                        : snapshot_memory_write(s, &data, 1) < 0) {
         snapshot_error = SNAPSHOT_WRITE_EOF_ERROR;
         return -1;
     }
@@ -97,51 +197,51 @@ static int snapshot_write_byte(FILE *f, uint8_t data)
     return 0;
 }
 
-static int snapshot_write_word(FILE *f, uint16_t data)
+static int snapshot_write_word(snapshot_t *s, uint16_t data)
 {
-    if (snapshot_write_byte(f, (uint8_t)(data & 0xff)) < 0
-        || snapshot_write_byte(f, (uint8_t)(data >> 8)) < 0) {
+    if (snapshot_write_byte(s, (uint8_t)(data & 0xff)) < 0
+        || snapshot_write_byte(s, (uint8_t)(data >> 8)) < 0) {
         return -1;
     }
 
     return 0;
 }
 
-static int snapshot_write_dword(FILE *f, uint32_t data)
+static int snapshot_write_dword(snapshot_t *s, uint32_t data)
 {
-    if (snapshot_write_word(f, (uint16_t)(data & 0xffff)) < 0
-        || snapshot_write_word(f, (uint16_t)(data >> 16)) < 0) {
+    if (snapshot_write_word(s, (uint16_t)(data & 0xffff)) < 0
+        || snapshot_write_word(s, (uint16_t)(data >> 16)) < 0) {
         return -1;
     }
 
     return 0;
 }
 
-static int snapshot_write_double(FILE *f, double data)
+static int snapshot_write_double(snapshot_t *s, double data)
 {
     uint8_t *byte_data = (uint8_t *)&data;
     int i;
 
     for (i = 0; i < sizeof(double); i++) {
-        if (snapshot_write_byte(f, byte_data[i]) < 0) {
+        if (snapshot_write_byte(s, byte_data[i]) < 0) {
             return -1;
         }
     }
     return 0;
 }
 
-static int snapshot_write_padded_string(FILE *f, const char *s, uint8_t pad_char,
+static int snapshot_write_padded_string(snapshot_t *s, const char *str, uint8_t pad_char,
                                         int len)
 {
     int i, found_zero;
     uint8_t c;
 
     for (i = found_zero = 0; i < len; i++) {
-        if (!found_zero && s[i] == 0) {
+        if (!found_zero && str[i] == 0) {
             found_zero = 1;
         }
-        c = found_zero ? (uint8_t)pad_char : (uint8_t) s[i];
-        if (snapshot_write_byte(f, c) < 0) {
+        c = found_zero ? (uint8_t)pad_char : (uint8_t) str[i];
+        if (snapshot_write_byte(s, c) < 0) {
             return -1;
         }
     }
@@ -149,9 +249,14 @@ static int snapshot_write_padded_string(FILE *f, const char *s, uint8_t pad_char
     return 0;
 }
 
-static int snapshot_write_byte_array(FILE *f, const uint8_t *data, unsigned int num)
+static int snapshot_write_byte_array(snapshot_t *s, const uint8_t *data, unsigned int num)
 {
-    if (num > 0 && fwrite(data, (size_t)num, 1, f) < 1) {
+    if (num == 0) {
+        return 0;
+    }
+
+    if (s->file != NULL ? fwrite(data, (size_t)num, 1, s->file) < 1
+                        : snapshot_memory_write(s, data, (size_t)num) < 0) {
         snapshot_error = SNAPSHOT_WRITE_BYTE_ARRAY_ERROR;
         return -1;
     }
@@ -159,12 +264,12 @@ static int snapshot_write_byte_array(FILE *f, const uint8_t *data, unsigned int
     return 0;
 }
 
-static int snapshot_write_word_array(FILE *f, const uint16_t *data, unsigned int num)
+static int snapshot_write_word_array(snapshot_t *s, const uint16_t *data, unsigned int num)
 {
     unsigned int i;
 
     for (i = 0; i < num; i++) {
-        if (snapshot_write_word(f, data[i]) < 0) {
+        if (snapshot_write_word(s, data[i]) < 0) {
             return -1;
         }
     }
@@ -172,12 +277,12 @@ static int snapshot_write_word_array(FILE *f, const uint16_t *data, unsigned int
     return 0;
 }
 
-static int snapshot_write_dword_array(FILE *f, const uint32_t *data, unsigned int num)
+static int snapshot_write_dword_array(snapshot_t *s, const uint32_t *data, unsigned int num)
 {
     unsigned int i;
 
     for (i = 0; i < num; i++) {
-        if (snapshot_write_dword(f, data[i]) < 0) {
+        if (snapshot_write_dword(s, data[i]) < 0) {
             return -1;
         }
     }
@@ -186,18 +291,18 @@ static int snapshot_write_dword_array(FILE *f, const uint32_t *data, unsigned in
 }
 
 
-static int snapshot_write_string(FILE *f, const char *s)
+static int snapshot_write_string(snapshot_t *s, const char *str)
 {
     size_t len, i;
 
-    len = s ? (strlen(s) + 1) : 0;      /* length includes nullbyte */
+    len = str ? (strlen(str) + 1) : 0;      /* length includes nullbyte */
 
-    if (snapshot_write_word(f, (uint16_t)len) < 0) {
+    if (snapshot_write_word(s, (uint16_t)len) < 0) {
         return -1;
     }
 
     for (i = 0; i < len; i++) {
-        if (snapshot_write_byte(f, s[i]) < 0) {
+        if (snapshot_write_byte(s, str[i]) < 0) {
             return -1;
         }
     }
@@ -205,11 +310,20 @@ static int snapshot_write_string(FILE *f, const char *s)
     return (int)(len + sizeof(uint16_t));
 }
 
-static int snapshot_read_byte(FILE *f, uint8_t *b_return)
+static int snapshot_read_byte(snapshot_t *s, uint8_t *b_return)
 {
     int c;
 
-    c = fgetc(f);
+    if (s->file == NULL) {
+        if (s->pos >= s->data_size) {
+            snapshot_error = SNAPSHOT_READ_EOF_ERROR;
+            return -1;
+        }
+        *b_return = s->data[s->pos++];
+        return 0;
+    }
+
+    c = fgetc(s->file);
     if (c == EOF) {
         snapshot_error = SNAPSHOT_READ_EOF_ERROR;
         return -1;
@@ -218,11 +332,11 @@ static int snapshot_read_byte(FILE *f, uint8_t *b_return)
     return 0;
 }
 
-static int snapshot_read_word(FILE *f, uint16_t *w_return)
+static int snapshot_read_word(snapshot_t *s, uint16_t *w_return)
 {
     uint8_t lo, hi;
 
-    if (snapshot_read_byte(f, &lo) < 0 || snapshot_read_byte(f, &hi) < 0) {
+    if (snapshot_read_byte(s, &lo) < 0 || snapshot_read_byte(s, &hi) < 0) {
         return -1;
     }
 
@@ -230,11 +344,11 @@ static int snapshot_read_word(FILE *f, uint16_t *w_return)
     return 0;
 }
 
-static int snapshot_read_dword(FILE *f, uint32_t *dw_return)
+static int snapshot_read_dword(snapshot_t *s, uint32_t *dw_return)
 {
     uint16_t lo, hi;
 
-    if (snapshot_read_word(f, &lo) < 0 || snapshot_read_word(f, &hi) < 0) {
+    if (snapshot_read_word(s, &lo) < 0 || snapshot_read_word(s, &hi) < 0) {
         return -1;
     }
 
@@ -242,28 +356,29 @@ static int snapshot_read_dword(FILE *f, uint32_t *dw_return)
     return 0;
 }
 
-static int snapshot_read_double(FILE *f, double *d_return)
+static int snapshot_read_double(snapshot_t *s, double *d_return)
 {
     int i;
-    int c;
     double val;
     uint8_t *byte_val = (uint8_t *)&val;
 
     for (i = 0; i < sizeof(double); i++) {
-        c = fgetc(f);
-        if (c == EOF) {
-            snapshot_error = SNAPSHOT_READ_EOF_ERROR;
+        if (snapshot_read_byte(s, &byte_val[i]) < 0) {
             return -1;
         }
-        byte_val[i] = (uint8_t)c;
     }
     *d_return = val;
     return 0;
 }
 
-static int snapshot_read_byte_array(FILE *f, uint8_t *b_return, unsigned int num)
+static int snapshot_read_byte_array(snapshot_t *s, uint8_t *b_return, unsigned int num)
 {
-    if (num > 0 && fread(b_return, (size_t)num, 1, f) < 1) {
+    if (num == 0) {
+        return 0;
+    }
+
+    if (s->file != NULL ? fread(b_return, (size_t)num, 1, s->file) < 1
+                        : snapshot_memory_read(s, b_return, (size_t)num) < 0) {
         snapshot_error = SNAPSHOT_READ_BYTE_ARRAY_ERROR;
         return -1;
     }
@@ -271,12 +386,12 @@ static int snapshot_read_byte_array(FILE *f, uint8_t *b_return, unsigned int num
     return 0;
 }
 
-static int snapshot_read_word_array(FILE *f, uint16_t *w_return, unsigned int num)
+static int snapshot_read_word_array(snapshot_t *s, uint16_t *w_return, unsigned int num)
 {
     unsigned int i;
 
     for (i = 0; i < num; i++) {
-        if (snapshot_read_word(f, w_return + i) < 0) {
+        if (snapshot_read_word(s, w_return + i) < 0) {
             return -1;
         }
     }
@@ -284,12 +399,12 @@ static int snapshot_read_word_array(FILE *f, uint16_t *w_return, unsigned int nu
     return 0;
 }
 
-static int snapshot_read_dword_array(FILE *f, uint32_t *dw_return, unsigned int num)
+static int snapshot_read_dword_array(snapshot_t *s, uint32_t *dw_return, unsigned int num)
 {
     unsigned int i;
 
     for (i = 0; i < num; i++) {
-        if (snapshot_read_dword(f, dw_return + i) < 0) {
+        if (snapshot_read_dword(s, dw_return + i) < 0) {
             return -1;
         }
     }
@@ -297,17 +412,17 @@ static int snapshot_read_dword_array(FILE *f, uint32_t *dw_return, unsigned int
     return 0;
 }
 
-static int snapshot_read_string(FILE *f, char **s)
+static int snapshot_read_string(snapshot_t *s, char **str)
 {
     int i, len;
     uint16_t w;
     char *p = NULL;
 
     /* first free the previous string */
-    lib_free(*s);
-    *s = NULL;      /* don't leave a bogus pointer */
+    lib_free(*str);
+    *str = NULL;      /* don't leave a bogus pointer */
 
-    if (snapshot_read_word(f, &w) < 0) {
+    if (snapshot_read_word(s, &w) < 0) {
         return -1;
     }
 
@@ -315,10 +430,10 @@ static int snapshot_read_string(FILE *f, char **s)
 
     if (len) {
         p = lib_malloc(len);
-        *s = p;
+        *str = p;
 
         for (i = 0; i < len; i++) {
-            if (snapshot_read_byte(f, (uint8_t *)(p + i)) < 0) {
+            if (snapshot_read_byte(s, (uint8_t *)(p + i)) < 0) {
                 p[0] = 0;
                 return -1;
             }
@@ -332,7 +447,7 @@ static int snapshot_read_string(FILE *f, char **s)
 
 int snapshot_module_write_byte(snapshot_module_t *m, uint8_t b)
 {
-    if (snapshot_write_byte(m->file, b) < 0) {
+    if (snapshot_write_byte(m->snapshot, b) < 0) {
         return -1;
     }
 
@@ -342,7 +457,7 @@ int snapshot_module_write_byte(snapshot_module_t *m, uint8_t b)
 
 int snapshot_module_write_word(snapshot_module_t *m, uint16_t w)
 {
-    if (snapshot_write_word(m->file, w) < 0) {
+    if (snapshot_write_word(m->snapshot, w) < 0) {
         return -1;
     }
 
@@ -352,7 +467,7 @@ int snapshot_module_write_word(snapshot_module_t *m, uint16_t w)
 
 int snapshot_module_write_dword(snapshot_module_t *m, uint32_t dw)
 {
-    if (snapshot_write_dword(m->file, dw) < 0) {
+    if (snapshot_write_dword(m->snapshot, dw) < 0) {
         return -1;
     }
 
@@ -362,7 +477,7 @@ int snapshot_module_write_dword(snapshot_module_t *m, uint32_t dw)
 
 int snapshot_module_write_double(snapshot_module_t *m, double db)
 {
-    if (snapshot_write_double(m->file, db) < 0) {
+    if (snapshot_write_double(m->snapshot, db) < 0) {
         return -1;
     }
 
@@ -372,7 +487,7 @@ int snapshot_module_write_double(snapshot_module_t *m, double db)
 
 int snapshot_module_write_padded_string(snapshot_module_t *m, const char *s, uint8_t pad_char, int len)
 {
-    if (snapshot_write_padded_string(m->file, s, (uint8_t)pad_char, len) < 0) {
+    if (snapshot_write_padded_string(m->snapshot, s, (uint8_t)pad_char, len) < 0) {
         return -1;
     }
 
@@ -382,7 +497,7 @@ int snapshot_module_write_padded_string(snapshot_module_t *m, const char *s, uin
 
 int snapshot_module_write_byte_array(snapshot_module_t *m, const uint8_t *b, unsigned int num)
 {
-    if (snapshot_write_byte_array(m->file, b, num) < 0) {
+    if (snapshot_write_byte_array(m->snapshot, b, num) < 0) {
         return -1;
     }
 
@@ -392,7 +507,7 @@ int snapshot_module_write_byte_array(snapshot_module_t *m, const uint8_t *b, uns
 
 int snapshot_module_write_word_array(snapshot_module_t *m, const uint16_t *w, unsigned int num)
 {
-    if (snapshot_write_word_array(m->file, w, num) < 0) {
+    if (snapshot_write_word_array(m->snapshot, w, num) < 0) {
         return -1;
     }
 
@@ -402,7 +517,7 @@ int snapshot_module_write_word_array(snapshot_module_t *m, const uint16_t *w, un
 
 int snapshot_module_write_dword_array(snapshot_module_t *m, const uint32_t *dw, unsigned int num)
 {
-    if (snapshot_write_dword_array(m->file, dw, num) < 0) {
+    if (snapshot_write_dword_array(m->snapshot, dw, num) < 0) {
         return -1;
     }
 
@@ -413,7 +528,7 @@ int snapshot_module_write_dword_array(snapshot_module_t *m, const uint32_t *dw,
 int snapshot_module_write_string(snapshot_module_t *m, const char *s)
 {
     int len;
-    len = snapshot_write_string(m->file, s);
+    len = snapshot_write_string(m->snapshot, s);
     if (len < 0) {
         snapshot_error = SNAPSHOT_ILLEGAL_STRING_LENGTH_ERROR;
         return -1;
@@ -427,82 +542,82 @@ int snapshot_module_write_string(snapshot_module_t *m, const char *s)
 
 int snapshot_module_read_byte(snapshot_module_t *m, uint8_t *b_return)
 {
-    if (ftell(m->file) + sizeof(uint8_t) > m->offset + m->size) {
+    if (snapshot_tell(m->snapshot) + sizeof(uint8_t) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_byte(m->file, b_return);
+    return snapshot_read_byte(m->snapshot, b_return);
 }
 
 int snapshot_module_read_word(snapshot_module_t *m, uint16_t *w_return)
 {
-    if (ftell(m->file) + sizeof(uint16_t) > m->offset + m->size) {
+    if (snapshot_tell(m->snapshot) + sizeof(uint16_t) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_word(m->file, w_return);
+    return snapshot_read_word(m->snapshot, w_return);
 }
 
 int snapshot_module_read_dword(snapshot_module_t *m, uint32_t *dw_return)
 {
-    if (ftell(m->file) + sizeof(uint32_t) > m->offset + m->size) {
+    if (snapshot_tell(m->snapshot) + sizeof(uint32_t) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_dword(m->file, dw_return);
+    return snapshot_read_dword(m->snapshot, dw_return);
 }
 
 int snapshot_module_read_double(snapshot_module_t *m, double *db_return)
 {
-    if (ftell(m->file) + sizeof(double) > m->offset + m->size) {
+    if (snapshot_tell(m->snapshot) + sizeof(double) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_double(m->file, db_return);
+    return snapshot_read_double(m->snapshot, db_return);
 }
 
 int snapshot_module_read_byte_array(snapshot_module_t *m, uint8_t *b_return, unsigned int num)
 {
-    if ((long)(ftell(m->file) + num) > (long)(m->offset + m->size)) {
+    if ((long)(snapshot_tell(m->snapshot) + num) > (long)(m->offset + m->size)) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_byte_array(m->file, b_return, num);
+    return snapshot_read_byte_array(m->snapshot, b_return, num);
 }
 
 int snapshot_module_read_word_array(snapshot_module_t *m, uint16_t *w_return, unsigned int num)
 {
-    if ((long)(ftell(m->file) + num * sizeof(uint16_t)) > (long)(m->offset + m->size)) {
+    if ((long)(snapshot_tell(m->snapshot) + num * sizeof(uint16_t)) > (long)(m->offset + m->size)) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_word_array(m->file, w_return, num);
+    return snapshot_read_word_array(m->snapshot, w_return, num);
 }
 
 int snapshot_module_read_dword_array(snapshot_module_t *m, uint32_t *dw_return, unsigned int num)
 {
-    if ((long)(ftell(m->file) + num * sizeof(uint32_t)) > (long)(m->offset + m->size)) {
+    if ((long)(snapshot_tell(m->snapshot) + num * sizeof(uint32_t)) > (long)(m->offset + m->size)) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_dword_array(m->file, dw_return, num);
+    return snapshot_read_dword_array(m->snapshot, dw_return, num);
 }
 
 int snapshot_module_read_string(snapshot_module_t *m, char **charp_return)
 {
-    if (ftell(m->file) + sizeof(uint16_t) > m->offset + m->size) {
+    if (snapshot_tell(m->snapshot) + sizeof(uint16_t) > m->offset + m->size) {
         snapshot_error = SNAPSHOT_READ_OUT_OF_BOUNDS_ERROR;
         return -1;
     }
 
-    return snapshot_read_string(m->file, charp_return);
+    return snapshot_read_string(m->snapshot, charp_return);
 }
 
 int snapshot_module_read_byte_into_int(snapshot_module_t *m, int *value_return)
@@ -568,25 +683,24 @@ snapshot_module_t *snapshot_module_create(snapshot_t *s, const char *name, uint8
 
     current_module = (char *)name;
 
-    m = lib_malloc(sizeof(snapshot_module_t));
-    m->file = s->file;
-    m->offset = ftell(s->file);
+    m = snapshot_module_alloc(s);
+    m->offset = snapshot_tell(s);
     if (m->offset == -1) {
         snapshot_error = SNAPSHOT_ILLEGAL_OFFSET_ERROR;
-        lib_free(m);
+        snapshot_module_free(m);
         return NULL;
     }
     m->write_mode = 1;
 
-    if (snapshot_write_padded_string(s->file, name, (uint8_t)0, SNAPSHOT_MODULE_NAME_LEN) < 0
-        || snapshot_write_byte(s->file, major_version) < 0
-        || snapshot_write_byte(s->file, minor_version) < 0
-        || snapshot_write_dword(s->file, 0) < 0) {
+    if (snapshot_write_padded_string(s, name, (uint8_t)0, SNAPSHOT_MODULE_NAME_LEN) < 0
+        || snapshot_write_byte(s, major_version) < 0
+        || snapshot_write_byte(s, minor_version) < 0
+        || snapshot_write_dword(s, 0) < 0) {
         return NULL;
     }
 
-    m->size = (uint32_t)(ftell(s->file) - m->offset);
-    m->size_offset = ftell(s->file) - sizeof(uint32_t);
+    m->size = (uint32_t)(snapshot_tell(s) - m->offset);
+    m->size_offset = snapshot_tell(s) - sizeof(uint32_t);
 
     return m;
 }
@@ -599,13 +713,12 @@ snapshot_module_t *snapshot_module_open(snapshot_t *s, const char *name, uint8_t
 
     current_module = (char *)name;
 
-    if (fseek(s->file, s->first_module_offset, SEEK_SET) < 0) {
+    if (snapshot_seek(s, s->first_module_offset) < 0) {
         snapshot_error = SNAPSHOT_FIRST_MODULE_NOT_FOUND_ERROR;
         return NULL;
     }
 
-    m = lib_malloc(sizeof(snapshot_module_t));
-    m->file = s->file;
+    m = snapshot_module_alloc(s);
     m->write_mode = 0;
 
     m->offset = s->first_module_offset;
@@ -613,11 +726,11 @@ snapshot_module_t *snapshot_module_open(snapshot_t *s, const char *name, uint8_t
     /* Search for the module name.  This is quite inefficient, but I don't
        think we care.  */
     while (1) {
-        if (snapshot_read_byte_array(s->file, (uint8_t *)n,
+        if (snapshot_read_byte_array(s, (uint8_t *)n,
                                      SNAPSHOT_MODULE_NAME_LEN) < 0
-            || snapshot_read_byte(s->file, major_version_return) < 0
-            || snapshot_read_byte(s->file, minor_version_return) < 0
-            || snapshot_read_dword(s->file, &m->size)) {
+            || snapshot_read_byte(s, major_version_return) < 0
+            || snapshot_read_byte(s, minor_version_return) < 0
+            || snapshot_read_dword(s, &m->size)) {
             snapshot_error = SNAPSHOT_MODULE_HEADER_READ_ERROR;
             goto fail;
         }
@@ -629,19 +742,19 @@ snapshot_module_t *snapshot_module_open(snapshot_t *s, const char *name, uint8_t
         }
 
         m->offset += m->size;
-        if (fseek(s->file, m->offset, SEEK_SET) < 0) {
+        if (snapshot_seek(s, m->offset) < 0) {
             snapshot_error = SNAPSHOT_MODULE_NOT_FOUND_ERROR;
             goto fail;
         }
     }
 
-    m->size_offset = ftell(s->file) - sizeof(uint32_t);
+    m->size_offset = snapshot_tell(s) - sizeof(uint32_t);
 
     return m;
 
 fail:
-    fseek(s->file, s->first_module_offset, SEEK_SET);
-    lib_free(m);
+    snapshot_seek(s, s->first_module_offset);
+    snapshot_module_free(m);
     return NULL;
 }
 
@@ -650,129 +763,144 @@ int snapshot_module_close(snapshot_module_t *m)
 
     /* Backpatch module size if writing.  */
     if (m->write_mode
-        && (fseek(m->file, m->size_offset, SEEK_SET) < 0
-            || snapshot_write_dword(m->file, m->size) < 0)) {
+        && (snapshot_seek(m->snapshot, m->size_offset) < 0
+            || snapshot_write_dword(m->snapshot, m->size) < 0)) {
         snapshot_error = SNAPSHOT_MODULE_CLOSE_ERROR;
         return -1;
     }
 
     /* Skip module.  */
-    if (fseek(m->file, m->offset + m->size, SEEK_SET) < 0) {
+    if (snapshot_seek(m->snapshot, m->offset + m->size) < 0) {
         snapshot_error = SNAPSHOT_MODULE_SKIP_ERROR;
         return -1;
     }
 
-    lib_free(m);
+    snapshot_module_free(m);
     return 0;
 }
 
 /* ------------------------------------------------------------------------- */
 
-snapshot_t *snapshot_create(const char *filename, uint8_t major_version, uint8_t minor_version, const char *snapshot_machine_name)
+static int snapshot_write_header(snapshot_t *s, uint8_t major_version, uint8_t minor_version, const char *snapshot_machine_name)
 {
-    FILE *f;
-    snapshot_t *s;
     unsigned char viceversion[4] = { VERSION_RC_NUMBER };
 
-    current_filename = (char *)filename;
-
-    f = fopen(filename, MODE_WRITE);
-    if (f == NULL) {
-        snapshot_error = SNAPSHOT_CANNOT_CREATE_SNAPSHOT_ERROR;
-        return NULL;
-    }
-
     /* Magic string.  */
-    if (snapshot_write_padded_string(f, snapshot_magic_string, (uint8_t)0, SNAPSHOT_MAGIC_LEN) < 0) {
+    if (snapshot_write_padded_string(s, snapshot_magic_string, (uint8_t)0, SNAPSHOT_MAGIC_LEN) < 0) {
         snapshot_error = SNAPSHOT_CANNOT_WRITE_MAGIC_STRING_ERROR;
-        goto fail;
+        return -1;
     }
 
     /* Version number.  */
-    if (snapshot_write_byte(f, major_version) < 0
-        || snapshot_write_byte(f, minor_version) < 0) {
+    if (snapshot_write_byte(s, major_version) < 0
+        || snapshot_write_byte(s, minor_version) < 0) {
         snapshot_error = SNAPSHOT_CANNOT_WRITE_VERSION_ERROR;
-        goto fail;
+        return -1;
     }
 
     /* Machine.  */
-    if (snapshot_write_padded_string(f, snapshot_machine_name, (uint8_t)0, SNAPSHOT_MACHINE_NAME_LEN) < 0) {
+    if (snapshot_write_padded_string(s, snapshot_machine_name, (uint8_t)0, SNAPSHOT_MACHINE_NAME_LEN) < 0) {
         snapshot_error = SNAPSHOT_CANNOT_WRITE_MACHINE_NAME_ERROR;
-        goto fail;
+        return -1;
     }
 
     /* VICE version and revision */
-    if (snapshot_write_padded_string(f, snapshot_version_magic_string, (uint8_t)0, SNAPSHOT_VERSION_MAGIC_LEN) < 0) {
+    if (snapshot_write_padded_string(s, snapshot_version_magic_string, (uint8_t)0, SNAPSHOT_VERSION_MAGIC_LEN) < 0) {
         snapshot_error = SNAPSHOT_CANNOT_WRITE_MAGIC_STRING_ERROR;
-        goto fail;
+        return -1;
     }
 
-    if (snapshot_write_byte(f, viceversion[0]) < 0
-        || snapshot_write_byte(f, viceversion[1]) < 0
-        || snapshot_write_byte(f, viceversion[2]) < 0
-        || snapshot_write_byte(f, viceversion[3]) < 0
+    if (snapshot_write_byte(s, viceversion[0]) < 0
+        || snapshot_write_byte(s, viceversion[1]) < 0
+        || snapshot_write_byte(s, viceversion[2]) < 0
+        || snapshot_write_byte(s, viceversion[3]) < 0
 #ifdef USE_SVN_REVISION
-        || snapshot_write_dword(f, VICE_SVN_REV_NUMBER) < 0) {
+        || snapshot_write_dword(s, VICE_SVN_REV_NUMBER) < 0) {
 #else
-        || snapshot_write_dword(f, 0) < 0) {
+        || snapshot_write_dword(s, 0) < 0) {
 #endif
         snapshot_error = SNAPSHOT_CANNOT_WRITE_VERSION_ERROR;
-        goto fail;
+        return -1;
     }
 
-    s = lib_malloc(sizeof(snapshot_t));
-    s->file = f;
-    s->first_module_offset = ftell(f);
+    s->first_module_offset = snapshot_tell(s);
     s->write_mode = 1;
 
+    return 0;
+}
+
+snapshot_t *snapshot_create(const char *filename, uint8_t major_version, uint8_t minor_version, const char *snapshot_machine_name)
+{
+    FILE *f;
+    snapshot_t *s;
+
+    current_filename = (char *)filename;
+
+    f = fopen(filename, MODE_WRITE);
+    if (f == NULL) {
+        snapshot_error = SNAPSHOT_CANNOT_CREATE_SNAPSHOT_ERROR;
+        return NULL;
+    }
+
+    s = lib_calloc(1, sizeof(snapshot_t));
+    s->file = f;
+
+    if (snapshot_write_header(s, major_version, minor_version, snapshot_machine_name) < 0) {
+        lib_free(s);
+        fclose(f);
+        ioutil_remove(filename);
+        return NULL;
+    }
+
     return s;
+}
 
-fail:
-    fclose(f);
-    ioutil_remove(filename);
-    return NULL;
+snapshot_t *snapshot_create_memory(snapshot_memory_t *mem, uint8_t major_version, uint8_t minor_version, const char *snapshot_machine_name)
+{
+    snapshot_t *s;
+
+    current_filename = (char *)"(memory)";
+
+    s = lib_calloc(1, sizeof(snapshot_t));
+    s->mem = mem;
+    mem->size = 0;
+
+    if (snapshot_write_header(s, major_version, minor_version, snapshot_machine_name) < 0) {
+        lib_free(s);
+        return NULL;
+    }
+
+    return s;
 }
 
 /* informal only, used by the error message created below */
 static unsigned char snapshot_viceversion[4];
 static uint32_t snapshot_vicerevision;
 
-snapshot_t *snapshot_open(const char *filename, uint8_t *major_version_return, uint8_t *minor_version_return, const char *snapshot_machine_name)
+static int snapshot_read_header(snapshot_t *s, uint8_t *major_version_return, uint8_t *minor_version_return, const char *snapshot_machine_name)
 {
-    FILE *f;
     char magic[SNAPSHOT_MAGIC_LEN];
-    snapshot_t *s = NULL;
     int machine_name_len;
-    size_t offs;
-
-    current_machine_name = (char *)snapshot_machine_name;
-    current_filename = (char *)filename;
-    current_module = NULL;
-
-    f = zfile_fopen(filename, MODE_READ);
-    if (f == NULL) {
-        snapshot_error = SNAPSHOT_CANNOT_OPEN_FOR_READ_ERROR;
-        return NULL;
-    }
+    long offs;
 
     /* Magic string.  */
-    if (snapshot_read_byte_array(f, (uint8_t *)magic, SNAPSHOT_MAGIC_LEN) < 0
+    if (snapshot_read_byte_array(s, (uint8_t *)magic, SNAPSHOT_MAGIC_LEN) < 0
         || memcmp(magic, snapshot_magic_string, SNAPSHOT_MAGIC_LEN) != 0) {
         snapshot_error = SNAPSHOT_MAGIC_STRING_MISMATCH_ERROR;
-        goto fail;
+        return -1;
     }
 
     /* Version number.  */
-    if (snapshot_read_byte(f, major_version_return) < 0
-        || snapshot_read_byte(f, minor_version_return) < 0) {
+    if (snapshot_read_byte(s, major_version_return) < 0
+        || snapshot_read_byte(s, minor_version_return) < 0) {
         snapshot_error = SNAPSHOT_CANNOT_READ_VERSION_ERROR;
-        goto fail;
+        return -1;
     }
 
     /* Machine.  */
-    if (snapshot_read_byte_array(f, (uint8_t *)read_name, SNAPSHOT_MACHINE_NAME_LEN) < 0) {
+    if (snapshot_read_byte_array(s, (uint8_t *)read_name, SNAPSHOT_MACHINE_NAME_LEN) < 0) {
         snapshot_error = SNAPSHOT_CANNOT_READ_MACHINE_NAME_ERROR;
-        goto fail;
+        return -1;
     }
 
     /* Check machine name.  */
@@ -781,61 +909,103 @@ snapshot_t *snapshot_open(const char *filename, uint8_t *major_version_return, u
         || (machine_name_len != SNAPSHOT_MODULE_NAME_LEN
             && read_name[machine_name_len] != 0)) {
         snapshot_error = SNAPSHOT_MACHINE_MISMATCH_ERROR;
-        goto fail;
+        return -1;
     }
 
     /* VICE version and revision */
     memset(snapshot_viceversion, 0, 4);
     snapshot_vicerevision = 0;
-    offs = ftell(f);
+    offs = snapshot_tell(s);
 
-    if (snapshot_read_byte_array(f, (uint8_t *)magic, SNAPSHOT_VERSION_MAGIC_LEN) < 0
+    if (snapshot_read_byte_array(s, (uint8_t *)magic, SNAPSHOT_VERSION_MAGIC_LEN) < 0
         || memcmp(magic, snapshot_version_magic_string, SNAPSHOT_VERSION_MAGIC_LEN) != 0) {
         /* old snapshots do not contain VICE version */
-        fseek(f, offs, SEEK_SET);
+        snapshot_seek(s, offs);
         log_warning(LOG_DEFAULT, "attempting to load pre 2.4.30 snapshot");
     } else {
         /* actually read the version */
-        if (snapshot_read_byte(f, &snapshot_viceversion[0]) < 0
-            || snapshot_read_byte(f, &snapshot_viceversion[1]) < 0
-            || snapshot_read_byte(f, &snapshot_viceversion[2]) < 0
-            || snapshot_read_byte(f, &snapshot_viceversion[3]) < 0
-            || snapshot_read_dword(f, &snapshot_vicerevision) < 0) {
+        if (snapshot_read_byte(s, &snapshot_viceversion[0]) < 0
+            || snapshot_read_byte(s, &snapshot_viceversion[1]) < 0
+            || snapshot_read_byte(s, &snapshot_viceversion[2]) < 0
+            || snapshot_read_byte(s, &snapshot_viceversion[3]) < 0
+            || snapshot_read_dword(s, &snapshot_vicerevision) < 0) {
             snapshot_error = SNAPSHOT_CANNOT_READ_VERSION_ERROR;
-            goto fail;
+            return -1;
         }
     }
 
-    s = lib_malloc(sizeof(snapshot_t));
-    s->file = f;
-    s->first_module_offset = ftell(f);
+    s->first_module_offset = snapshot_tell(s);
     s->write_mode = 0;
 
+    return 0;
+}
+
+snapshot_t *snapshot_open(const char *filename, uint8_t *major_version_return, uint8_t *minor_version_return, const char *snapshot_machine_name)
+{
+    FILE *f;
+    snapshot_t *s;
+
+    current_machine_name = (char *)snapshot_machine_name;
+    current_filename = (char *)filename;
+    current_module = NULL;
+
+    f = zfile_fopen(filename, MODE_READ);
+    if (f == NULL) {
+        snapshot_error = SNAPSHOT_CANNOT_OPEN_FOR_READ_ERROR;
+        return NULL;
+    }
+
+    s = lib_calloc(1, sizeof(snapshot_t));
+    s->file = f;
+
+    if (snapshot_read_header(s, major_version_return, minor_version_return, snapshot_machine_name) < 0) {
+        lib_free(s);
+        zfile_fclose(f);
+        return NULL;
+    }
+
     vsync_suspend_speed_eval();
     return s;
+}
 
-fail:
-    fclose(f);
-    return NULL;
+/* Reading works in place on `data', which must stay valid until the
+   snapshot is closed.  Unlike for files the speed evaluation is not
+   suspended, as memory snapshots are restored without noticeable delay.  */
+snapshot_t *snapshot_open_memory(const uint8_t *data, size_t size, uint8_t *major_version_return, uint8_t *minor_version_return, const char *snapshot_machine_name)
+{
+    snapshot_t *s;
+
+    current_machine_name = (char *)snapshot_machine_name;
+    current_filename = (char *)"(memory)";
+    current_module = NULL;
+
+    s = lib_calloc(1, sizeof(snapshot_t));
+    s->data = data;
+    s->data_size = size;
+
+    if (snapshot_read_header(s, major_version_return, minor_version_return, snapshot_machine_name) < 0) {
+        lib_free(s);
+        return NULL;
+    }
+
+    return s;
 }
 
 int snapshot_close(snapshot_t *s)
 {
-    int retval;
+    int retval = 0;
 
-    if (!s->write_mode) {
+    if (s->file == NULL) {
+        /* Memory snapshot, the arena stays with the caller.  */
+    } else if (!s->write_mode) {
         if (zfile_fclose(s->file) == EOF) {
             snapshot_error = SNAPSHOT_READ_CLOSE_EOF_ERROR;
             retval = -1;
-        } else {
-            retval = 0;
         }
     } else {
         if (fclose(s->file) == EOF) {
             snapshot_error = SNAPSHOT_WRITE_CLOSE_EOF_ERROR;
             retval = -1;
-        } else {
-            retval = 0;
         }
     }
 
@@ -28,6 +28,8 @@
 #ifndef SNAPSHOT_H
 #define SNAPSHOT_H
 
+#include <stddef.h>
+
 #include "types.h"
 
 #define SNAPSHOT_MACHINE_NAME_LEN       16
@@ -66,6 +68,15 @@
 typedef struct snapshot_module_s snapshot_module_t;
 typedef struct snapshot_s snapshot_t;
 
+/* Arena for snapshots kept in memory instead of a file.  It is grown as
+   needed while writing and owned by the caller, who can pass it in again
+   for the next snapshot and finally releases `data' with lib_free().  */
+typedef struct snapshot_memory_s {
+    uint8_t *data;      /* Snapshot data.  */
+    size_t size;        /* Bytes used by the last snapshot written.  */
+    size_t capacity;    /* Bytes allocated.  */
+} snapshot_memory_t;
+
 extern void snapshot_display_error(void);
 
 extern int snapshot_module_write_byte(snapshot_module_t *m, uint8_t data);
@@ -146,6 +157,13 @@ extern snapshot_t *snapshot_open(const char *filename,
                                  uint8_t *major_version_return,
                                  uint8_t *minor_version_return,
                                  const char *snapshot_machine_name);
+extern snapshot_t *snapshot_create_memory(snapshot_memory_t *mem,
+                                          uint8_t major_version, uint8_t minor_version,
+                                          const char *snapshot_machine_name);
+extern snapshot_t *snapshot_open_memory(const uint8_t *data, size_t size,
+                                        uint8_t *major_version_return,
+                                        uint8_t *minor_version_return,
+                                        const char *snapshot_machine_name);
 extern int snapshot_close(snapshot_t *s);
 
 extern void snapshot_set_error(int error);
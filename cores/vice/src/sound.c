@@ -50,8 +50,10 @@
 #include "machine.h"
 #include "maincpu.h"
 #include "monitor.h"
+#include "perfstats.h"
 #include "resources.h"
 #include "sound.h"
+#include "soundtrace.h"
 #include "types.h"
 #include "tick.h"
 #include "uiapi.h"
@@ -497,6 +499,93 @@ static int set_volume(int val, void *param)
     return 0;
 }
 
+/* ------------------------------------------------------------------------- */
+
+/* Register write trace, see soundtrace.h.  */
+
+static FILE *trace_fd = NULL;
+static CLOCK trace_clk;
+static int trace_chips;
+
+static void sound_trace_close(void)
+{
+    uint8_t chips = (uint8_t)trace_chips;
+
+    if (trace_fd) {
+        /* The number of chips is only known once the trace is complete. */
+        if (fseek(trace_fd, 9, SEEK_SET) == 0) {
+            fwrite(&chips, 1, 1, trace_fd);
+        }
+        fclose(trace_fd);
+        trace_fd = NULL;
+    }
+}
+
+static int sound_trace_open(const char *name)
+{
+    uint8_t header[SOUND_TRACE_HEADER_SIZE];
+    long cycles_per_sec = machine_get_cycles_per_second();
+
+    sound_trace_close();
+
+    trace_fd = fopen(name, MODE_WRITE);
+    if (trace_fd == NULL) {
+        log_error(LOG_DEFAULT, "Cannot open sound trace file `%s'.", name);
+        return -1;
+    }
+
+    memset(header, 0, sizeof(header));
+    memcpy(header, SOUND_TRACE_MAGIC, SOUND_TRACE_MAGIC_LEN);
+    header[8] = SOUND_TRACE_VERSION;
+    header[12] = (uint8_t)(cycles_per_sec & 0xff);
+    header[13] = (uint8_t)((cycles_per_sec >> 8) & 0xff);
+    header[14] = (uint8_t)((cycles_per_sec >> 16) & 0xff);
+    header[15] = (uint8_t)((cycles_per_sec >> 24) & 0xff);
+
+    if (fwrite(header, sizeof(header), 1, trace_fd) != 1) {
+        sound_trace_close();
+        return -1;
+    }
+
+    trace_clk = maincpu_clk;
+    trace_chips = 1;
+    return 0;
+}
+
+static void sound_trace_store(uint16_t addr, uint8_t val, int chipno)
+{
+    uint8_t record[8];
+    CLOCK delta = maincpu_clk - trace_clk;
+    int n = 0;
+
+    trace_clk = maincpu_clk;
+
+    if (chipno >= trace_chips) {
+        trace_chips = chipno + 1;
+    }
+
+    while (delta >= 0x80) {
+        record[n++] = (uint8_t)((delta & 0x7f) | 0x80);
+        delta >>= 7;
+    }
+    record[n++] = (uint8_t)delta;
+    record[n++] = (uint8_t)chipno;
+    record[n++] = (uint8_t)addr;
+    record[n++] = val;
+
+    if (fwrite(record, 1, (size_t)n, trace_fd) != (size_t)n) {
+        log_error(LOG_DEFAULT, "Error writing sound trace, trace closed.");
+        sound_trace_close();
+    }
+}
+
+/* The trace is started from the command line only, not through a resource,
+   so that it is never saved and a later run can't overwrite it.  */
+static int sound_trace_opt(const char *param, void *extra_param)
+{
+    return sound_trace_open(param);
+}
+
 static const resource_string_t resources_string[] = {
     { "SoundDeviceName", "", RES_EVENT_NO, NULL,
       &device_name, set_device_name, NULL },
@@ -546,6 +635,7 @@ void sound_resources_shutdown(void)
     recorddevice_name = NULL;
     lib_free(recorddevice_arg);
     recorddevice_arg = NULL;
+    sound_trace_close();
     lib_free(playback_devices_cmdline);
     playback_devices_cmdline = NULL;
     lib_free(record_devices_cmdline);
@@ -580,6 +670,9 @@ static const cmdline_option_t cmdline_options[] =
     { "-soundvolume", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
       NULL, NULL, "SoundVolume", NULL,
       "<Volume>", "Specify the sound volume (0..100)" },
+    { "-soundtrace", CALL_FUNCTION, CMDLINE_ATTRIB_NEED_ARGS,
+      sound_trace_opt, NULL, NULL, NULL,
+      "<Name>", "Record all sound chip register writes to trace file <Name>" },
     CMDLINE_LIST_END
 };
 
@@ -1169,6 +1262,7 @@ static int sound_run_sound(void)
     int i;
     int delta_t = 0;
     int16_t *bufferptr;
+    unsigned long perfstats_start;
 
     /* XXX: implement the exact ... */
     if (!playback_enabled || (suspend_time > 0 && disabletime)) {
@@ -1182,6 +1276,8 @@ static int sound_run_sound(void)
         }
     }
 
+    perfstats_start = perfstats_begin();
+
     /* Handling of cycle based sound engines. */
     if (cycle_based) {
         delta_t = maincpu_clk - snddata.lastclk;
@@ -1193,6 +1289,7 @@ static int sound_run_sound(void)
                                              snddata.sound_chip_channels,
                                              &delta_t);
         if (delta_t) {
+            perfstats_end(PERFSTATS_SOUND, perfstats_start);
             sound_error("Sound buffer overflow (cycle based)");
             return -1;
 #if 0
@@ -1212,6 +1309,7 @@ static int sound_run_sound(void)
          nr = (int)((SOUNDCLK_CONSTANT(maincpu_clk) - snddata.fclk)
                     / snddata.clkstep);
          if (!nr) {
+             perfstats_end(PERFSTATS_SOUND, perfstats_start);
              return 0;
          }
          if (nr > snddata.bufsize - snddata.bufptr) {
@@ -1227,6 +1325,8 @@ static int sound_run_sound(void)
          snddata.fclk += nr * snddata.clkstep;
      }
 
+     perfstats_end(PERFSTATS_SOUND, perfstats_start);
+
      if (amp < 4096) {
          if (amp) {
              for (i = 0; i < (nr * snddata.sound_output_channels); i++) {
@@ -1266,6 +1366,7 @@ static void prevent_clk_overflow_callback(CLOCK sub, void *data)
     snddata.lastclk -= sub;
     snddata.fclk -= SOUNDCLK_CONSTANT(sub);
     snddata.wclk -= sub;
+    trace_clk -= sub;
     for (c = 0; c < snddata.sound_chip_channels; c++) {
         if (snddata.psid[c]) {
             sound_machine_prevent_clk_overflow(snddata.psid[c], sub);
@@ -1316,6 +1417,7 @@ bool sound_flush()
     }
 
     if (warp_mode_enabled && snddata.recdev == NULL) {
+        perfstats_add_sound(snddata.buffer, snddata.bufptr * snddata.sound_output_channels);
         snddata.bufptr = 0;
         goto done;
     }
@@ -1584,6 +1686,10 @@ void sound_store(uint16_t addr, uint8_t val, int chipno)
 {
     int i;
 
+    if (trace_fd) {
+        sound_trace_store(addr, val, chipno);
+    }
+
     if (sound_run_sound()) {
         return;
     }
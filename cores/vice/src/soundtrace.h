@@ -0,0 +1,53 @@
+/*
+ * soundtrace.h - Sound chip register write trace format.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_SOUNDTRACE_H
+#define VICE_SOUNDTRACE_H
+
+/* A trace records every store to the sound chips (see `sound_store()'), so
+   that the sound engines can be run and benchmarked without the emulator.
+
+   The file starts with a header of SOUND_TRACE_HEADER_SIZE bytes:
+
+     8 bytes  SOUND_TRACE_MAGIC
+     1 byte   SOUND_TRACE_VERSION
+     1 byte   number of sound chips
+     2 bytes  reserved, zero
+     4 bytes  machine cycles per second, little endian
+
+   followed by one record per register write:
+
+     n bytes  cycles since the previous write, 7 bits per byte, least
+              significant group first, bit 7 set on all but the last byte
+     1 byte   chip number
+     1 byte   register, including the sound chip offset (SID = 0x00-0x1f)
+     1 byte   value
+
+   A typical record is 4 bytes.  */
+
+#define SOUND_TRACE_MAGIC       "VICESNDT"
+#define SOUND_TRACE_MAGIC_LEN   8
+#define SOUND_TRACE_VERSION     1
+#define SOUND_TRACE_HEADER_SIZE 16
+
+#endif
@@ -0,0 +1,440 @@
+/*
+ * tap-benchmark.c - Benchmark for scanning TAP images.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: tap-benchmark [rounds [image.tap ...]]
+
+   Writes a multi-load tape of BENCH_FILES CBM files with full length
+   pilots to tap-benchmark.tap in the current directory, then opens it,
+   lists it as the tape contents do, seeks to the last file of the freshly
+   opened tape as autostart does, seeks to every file of the listed tape
+   and reads every file.  The names and data read are checked against the
+   ones written.  Each TAP image given is opened, listed and seeked through
+   the same way.  Every step runs `rounds' times (default 5) and the time
+   per step is reported.  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "archdep.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "tap.h"
+#include "tape.h"
+#include "types.h"
+#include "util.h"
+#include "zfile.h"
+
+#define BENCH_FILES         32
+#define BENCH_IMAGE_NAME    "tap-benchmark.tap"
+
+#define BENCH_PULSE_SHORT   0x30
+#define BENCH_PULSE_MIDDLE  0x42
+#define BENCH_PULSE_LONG    0x56
+
+static uint8_t *bench_tap;
+static size_t bench_tap_size, bench_tap_alloc;
+static int bench_errors;
+
+/* Stubs for lib.c and tap.c.  */
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+int log_debug(const char *format, ...)
+{
+    return 0;
+}
+
+FILE *zfile_fopen(const char *name, const char *mode)
+{
+    return fopen(name, mode);
+}
+
+int zfile_fclose(FILE *stream)
+{
+    return fclose(stream);
+}
+
+size_t util_file_length(FILE *fd)
+{
+    long pos = ftell(fd);
+    long size;
+
+    fseek(fd, 0, SEEK_END);
+    size = ftell(fd);
+    fseek(fd, pos, SEEK_SET);
+    return (size_t)size;
+}
+
+int util_fpwrite(FILE *fd, const void *buf, size_t num, long offset)
+{
+    if (fseek(fd, offset, SEEK_SET) < 0 || fwrite(buf, num, 1, fd) < 1) {
+        return -1;
+    }
+    return 0;
+}
+
+void util_dword_to_le_buf(uint8_t *buf, uint32_t data)
+{
+    buf[0] = (uint8_t)data;
+    buf[1] = (uint8_t)(data >> 8);
+    buf[2] = (uint8_t)(data >> 16);
+    buf[3] = (uint8_t)(data >> 24);
+}
+
+uint8_t machine_tape_behaviour(void)
+{
+    return TAPE_BEHAVIOUR_NORMAL;
+}
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Writing a tape, as the KERNAL saves it.  */
+static void bench_put(uint8_t value)
+{
+    if (bench_tap_size == bench_tap_alloc) {
+        bench_tap_alloc = bench_tap_alloc ? bench_tap_alloc * 2 : 0x10000;
+        bench_tap = lib_realloc(bench_tap, bench_tap_alloc);
+    }
+    bench_tap[bench_tap_size++] = value;
+}
+
+static void bench_put_pause(uint32_t cycles)
+{
+    bench_put(0);
+    bench_put((uint8_t)cycles);
+    bench_put((uint8_t)(cycles >> 8));
+    bench_put((uint8_t)(cycles >> 16));
+}
+
+static void bench_put_pilot(int pulses)
+{
+    while (pulses--) {
+        bench_put(BENCH_PULSE_SHORT);
+    }
+}
+
+static void bench_put_byte(uint8_t value)
+{
+    int i, parity = 1;
+
+    bench_put(BENCH_PULSE_LONG);
+    bench_put(BENCH_PULSE_MIDDLE);
+    for (i = 0; i < 8; i++, value >>= 1) {
+        if (value & 1) {
+            bench_put(BENCH_PULSE_MIDDLE);
+            bench_put(BENCH_PULSE_SHORT);
+        } else {
+            bench_put(BENCH_PULSE_SHORT);
+            bench_put(BENCH_PULSE_MIDDLE);
+        }
+        parity ^= value & 1;
+    }
+    if (parity) {
+        bench_put(BENCH_PULSE_MIDDLE);
+        bench_put(BENCH_PULSE_SHORT);
+    } else {
+        bench_put(BENCH_PULSE_SHORT);
+        bench_put(BENCH_PULSE_MIDDLE);
+    }
+}
+
+/* A block and its repeat.  */
+static void bench_put_block(const uint8_t *data, int size, int pilot)
+{
+    int pass, i;
+    uint8_t checksum;
+
+    for (pass = 1; pass <= 2; pass++) {
+        bench_put_pilot(pass == 1 ? pilot : 0x4f);
+        for (i = 9; i > 0; i--) {
+            bench_put_byte((uint8_t)(pass == 1 ? 0x80 | i : i));
+        }
+        checksum = 0;
+        for (i = 0; i < size; i++) {
+            bench_put_byte(data[i]);
+            checksum ^= data[i];
+        }
+        bench_put_byte(checksum);
+        bench_put(BENCH_PULSE_LONG);
+        bench_put(BENCH_PULSE_SHORT);
+        bench_put_pilot(pass == 1 ? 0x4e : 0);
+    }
+    bench_put_pause(400000);
+}
+
+static void bench_file_name(uint8_t *name, int file)
+{
+    memset(name, 0x20, 16);
+    sprintf((char *)name, "PART %02d", file + 1);
+    name[strlen((char *)name)] = 0x20;
+}
+
+static int bench_file_size(int file)
+{
+    return 4096 + (file * 2311) % 16384;
+}
+
+static uint8_t bench_file_byte(int file, int i)
+{
+    return (uint8_t)((i * 7 + file * 13) ^ (i >> 5));
+}
+
+static int bench_make_tape(void)
+{
+    uint8_t header[192], *data;
+    int file, size, i;
+    FILE *fd;
+
+    bench_tap_size = 0;
+    for (i = 0; i < 20; i++) {
+        bench_put(0);
+    }
+    memcpy(bench_tap, "C64-TAPE-RAW", 12);
+    bench_tap[TAP_HDR_VERSION] = 1;
+
+    for (file = 0; file < BENCH_FILES; file++) {
+        size = bench_file_size(file);
+        memset(header, 0x20, sizeof(header));
+        header[0] = 3;
+        header[1] = 0x01;
+        header[2] = 0x08;
+        header[3] = (uint8_t)(0x0801 + size);
+        header[4] = (uint8_t)((0x0801 + size) >> 8);
+        bench_file_name(header + 5, file);
+        bench_put_block(header, sizeof(header), 0x6a00);
+
+        data = lib_malloc(size);
+        for (i = 0; i < size; i++) {
+            data[i] = bench_file_byte(file, i);
+        }
+        bench_put_block(data, size, 0x1a00);
+        lib_free(data);
+    }
+    util_dword_to_le_buf(bench_tap + TAP_HDR_LEN, (uint32_t)(bench_tap_size - TAP_HDR_SIZE));
+
+    fd = fopen(BENCH_IMAGE_NAME, MODE_WRITE);
+    if (fd == NULL) {
+        return -1;
+    }
+    if (fwrite(bench_tap, 1, bench_tap_size, fd) != bench_tap_size) {
+        fclose(fd);
+        return -1;
+    }
+    return fclose(fd) == 0 ? 0 : -1;
+}
+
+static tap_t *bench_open(const char *name)
+{
+    unsigned int read_only = 1;
+    tap_t *tap = tap_open(name, &read_only);
+
+    if (tap == NULL) {
+        fprintf(stderr, "%s: cannot open\n", name);
+        bench_errors++;
+    }
+    return tap;
+}
+
+static int bench_list(tap_t *tap)
+{
+    int files = 0;
+
+    tap_seek_start(tap);
+    while (tap_seek_to_next_file(tap, 0) >= 0) {
+        files++;
+    }
+    return files;
+}
+
+static void bench_report(const char *step, double time)
+{
+    printf("  %-24s %10.3f ms\n", step, time * 1000.0);
+}
+
+static void bench_tape(const char *name, int rounds, int check)
+{
+    tap_t *tap;
+    double start, time;
+    int round, files = 0, file, bytes;
+    uint8_t name_expected[16], *buf;
+
+    tap = bench_open(name);
+    if (tap == NULL) {
+        return;
+    }
+    printf("%s: %d bytes\n", name, tap->size);
+    tap_close(tap);
+
+    start = bench_now();
+    for (round = 0; round < rounds; round++) {
+        tap = bench_open(name);
+        if (tap == NULL) {
+            return;
+        }
+        tap_close(tap);
+    }
+    bench_report("open", (bench_now() - start) / rounds);
+
+    tap = bench_open(name);
+    if (tap == NULL) {
+        return;
+    }
+    start = bench_now();
+    for (round = 0; round < rounds; round++) {
+        files = bench_list(tap);
+    }
+    bench_report("list", (bench_now() - start) / rounds);
+    printf("  %-24s %10d\n", "files", files);
+    if (check && files != BENCH_FILES) {
+        fprintf(stderr, "%s: %d files, expected %d\n", name, files, BENCH_FILES);
+        bench_errors++;
+    }
+    if (files == 0) {
+        tap_close(tap);
+        return;
+    }
+
+    time = 0.0;
+    for (round = 0; round < rounds; round++) {
+        tap_t *fresh = bench_open(name);
+
+        if (fresh == NULL) {
+            break;
+        }
+        start = bench_now();
+        if (tap_seek_to_file(fresh, (unsigned int)files - 1) < 0) {
+            fprintf(stderr, "%s: cannot seek to file %d\n", name, files - 1);
+            bench_errors++;
+        }
+        time += bench_now() - start;
+        tap_close(fresh);
+    }
+    bench_report("seek last, not listed", time / rounds);
+
+    start = bench_now();
+    for (round = 0; round < rounds; round++) {
+        for (file = files - 1; file >= 0; file--) {
+            if (tap_seek_to_file(tap, (unsigned int)file) < 0) {
+                fprintf(stderr, "%s: cannot seek to file %d\n", name, file);
+                bench_errors++;
+            }
+        }
+    }
+    bench_report("seek each, listed", (bench_now() - start) / rounds / files);
+
+    buf = lib_malloc(0x10000);
+    time = 0.0;
+    for (round = 0; round < rounds; round++) {
+        for (file = 0; file < files; file++) {
+            int i;
+
+            start = bench_now();
+            tap_seek_to_file(tap, (unsigned int)file);
+            bytes = tap_read(tap, buf, 0x10000);
+            time += bench_now() - start;
+
+            if (!check || round > 0) {
+                continue;
+            }
+            bench_file_name(name_expected, file);
+            if (memcmp(tap_get_current_file_record(tap)->name, name_expected, 16)) {
+                fprintf(stderr, "%s: file %d has the wrong name\n", name, file);
+                bench_errors++;
+            }
+            if (bytes != bench_file_size(file)) {
+                fprintf(stderr, "%s: file %d has %d bytes, expected %d\n",
+                        name, file, bytes, bench_file_size(file));
+                bench_errors++;
+                continue;
+            }
+            for (i = 0; i < bytes; i++) {
+                if (buf[i] != bench_file_byte(file, i)) {
+                    fprintf(stderr, "%s: file %d differs at %d\n", name, file, i);
+                    bench_errors++;
+                    break;
+                }
+            }
+        }
+    }
+    bench_report("seek and read each", time / rounds / files);
+    lib_free(buf);
+
+    tap_close(tap);
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 5;
+    int i;
+
+    if (rounds < 1) {
+        fprintf(stderr, "Usage: %s [rounds [image.tap ...]]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d rounds, time per step\n", rounds);
+
+    if (bench_make_tape() < 0) {
+        fprintf(stderr, "Cannot write %s\n", BENCH_IMAGE_NAME);
+        return 1;
+    }
+    lib_free(bench_tap);
+    bench_tape(BENCH_IMAGE_NAME, rounds, 1);
+    remove(BENCH_IMAGE_NAME);
+
+    for (i = 2; i < argc; i++) {
+        bench_tape(argv[i], rounds, 0);
+    }
+
+    if (bench_errors) {
+        printf("%d errors\n", bench_errors);
+        return 1;
+    }
+    printf("no errors\n");
+    return 0;
+}
@@ -95,6 +95,19 @@ typedef struct tap_s {
 
     /* Has the tap changed? We correct the size then.  */
     int has_changed;
+
+    /* The whole image in memory, header included.  */
+    uint8_t *data;
+    long data_size;
+    long data_alloc;
+
+    /* Read position in `data' of the file scanning functions.  */
+    long data_pos;
+
+    /* Where the search for the header of each file found so far started,
+       so that seeking to a file does not have to skip the ones before.  */
+    long *file_scan_start;
+    int file_scan_start_num;
 } tap_t;
 
 extern void tap_init(const struct tape_init_s *init);
@@ -109,5 +122,6 @@ extern void tap_get_header(tap_t *tap, uint8_t *name);
 extern struct tape_file_record_s *tap_get_current_file_record(tap_t *tap);
 
 extern int tap_read(tap_t *tap, uint8_t *buf, size_t size);
+extern int tap_write(tap_t *tap, const uint8_t *buf, size_t size);
 
 #endif
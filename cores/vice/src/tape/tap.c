@@ -76,11 +76,9 @@ static int tap_pulse_tt_long_min = 0x23;
 static int tap_pulse_tt_long_max = 0x36;
 
 
-static int tap_header_read(tap_t *tap, FILE *fd)
+static int tap_header_read(tap_t *tap, const uint8_t *buf, long size)
 {
-    uint8_t buf[TAP_HDR_SIZE];
-
-    if (fread(buf, TAP_HDR_SIZE, 1, fd) != 1) {
+    if (size < TAP_HDR_SIZE) {
         return -1;
     }
 
@@ -116,10 +114,31 @@ static tap_t *tap_new(void)
     return tap;
 }
 
+/* Read the whole image into memory.  */
+static uint8_t *tap_image_read(FILE *fd, long *size)
+{
+    uint8_t *data;
+
+    *size = (long)util_file_length(fd);
+    if (*size < 0 || fseek(fd, 0, SEEK_SET) != 0) {
+        return NULL;
+    }
+
+    data = lib_malloc(*size > 0 ? *size : 1);
+    if (fread(data, 1, (size_t)*size, fd) != (size_t)*size) {
+        lib_free(data);
+        return NULL;
+    }
+
+    return data;
+}
+
 tap_t *tap_open(const char *name, unsigned int *read_only)
 {
     FILE *fd;
     tap_t *new;
+    uint8_t *data;
+    long data_size;
 
     fd = NULL;
 
@@ -137,10 +156,17 @@ tap_t *tap_open(const char *name, unsigned int *read_only)
         *read_only = 0;
     }
 
+    data = tap_image_read(fd, &data_size);
+    if (data == NULL) {
+        zfile_fclose(fd);
+        return NULL;
+    }
+
     new = tap_new();
 
-    if (tap_header_read(new, fd) < 0) {
+    if (tap_header_read(new, data, data_size) < 0) {
         zfile_fclose(fd);
+        lib_free(data);
         lib_free(new);
         return NULL;
     }
@@ -148,14 +174,20 @@ tap_t *tap_open(const char *name, unsigned int *read_only)
     new->fd = fd;
     new->read_only = *read_only;
 
-    new->size = (int)util_file_length(fd) - TAP_HDR_SIZE;
+    new->size = (int)data_size - TAP_HDR_SIZE;
 
     if (new->size < 3) {
         zfile_fclose(new->fd);
+        lib_free(data);
         lib_free(new);
         return NULL;
     }
 
+    new->data = data;
+    new->data_size = data_size;
+    new->data_alloc = data_size;
+    new->data_pos = TAP_HDR_SIZE;
+
     new->file_name = lib_strdup(name);
     new->tap_file_record = lib_calloc(1, sizeof(tape_file_record_t));
     new->current_file_number = -1;
@@ -184,6 +216,8 @@ int tap_close(tap_t *tap)
     lib_free(tap->current_file_data);
     lib_free(tap->file_name);
     lib_free(tap->tap_file_record);
+    lib_free(tap->data);
+    lib_free(tap->file_scan_start);
     lib_free(tap);
 
     return retval;
@@ -226,6 +260,23 @@ int tap_create(const char *name)
 
 static int tap_find_pilot(tap_t *tap, int type);
 
+/* Read from the image in memory like fread() from the file would.  */
+inline static size_t tap_data_read(tap_t *tap, uint8_t *buf, size_t size)
+{
+    long left = tap->data_size - tap->data_pos;
+
+    if (left <= 0) {
+        return 0;
+    }
+    if (size > (size_t)left) {
+        size = (size_t)left;
+    }
+    memcpy(buf, tap->data + tap->data_pos, size);
+    tap->data_pos += (long)size;
+
+    return size;
+}
+
 inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
 {
     uint8_t data;
@@ -233,21 +284,19 @@ inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
     size_t res;
 
     *pos_advance = 0;
-    res = fread(&data, 1, 1, tap->fd);
-
-    if (res == 0) {
+    if (tap->data_pos >= tap->data_size) {
         return -1;
     }
-
-    *pos_advance += (int)res;
+    data = tap->data[tap->data_pos++];
+    *pos_advance += 1;
 
     if (data == 0) {
         if (tap->version == 0) {
             pulse_length = 256;
         } else if ((tap->version == 1) || (tap->version == 2)) {
             uint8_t size[3];
-            res = fread(size, 3, 1, tap->fd);
-            if (res == 0) {
+            res = tap_data_read(tap, size, 3);
+            if (res < 3) {
                 return -1;
             }
             *pos_advance += 3;
@@ -261,7 +310,7 @@ inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
     if (tap->version == 2) {
         uint32_t pulse_length2;
 
-        res = fread(&data, 1, 1, tap->fd);
+        res = tap_data_read(tap, &data, 1);
 
         if (res == 0) {
             return -1;
@@ -269,8 +318,8 @@ inline static int tap_get_pulse(tap_t *tap, int *pos_advance)
         *pos_advance += (int)res;
         if (data == 0) {
             uint8_t size[3];
-            res = fread(size, 3, 1, tap->fd);
-            if (res == 0) {
+            res = tap_data_read(tap, size, 3);
+            if (res < 3) {
                 return -1;
             }
             *pos_advance += 3;
@@ -382,7 +431,7 @@ static int tap_cbm_skip_pilot(tap_t *tap)
 
     errors = 0;
     counter = 0;
-    current_filepos = ftell(tap->fd);
+    current_filepos = tap->data_pos;
     while (1) {
         /*  Save file position */
         fpos = current_filepos;
@@ -391,7 +440,7 @@ static int tap_cbm_skip_pilot(tap_t *tap)
         fpos2 = current_filepos;
         if (TAP_PULSE_LONG(data)) {
             /* found an L pulse, try to read a byte */
-            fseek(tap->fd, fpos, SEEK_SET);
+            tap->data_pos = fpos;
             current_filepos = fpos;
             data = tap_cbm_read_byte(tap);
             if (data == -1) {
@@ -404,12 +453,12 @@ static int tap_cbm_skip_pilot(tap_t *tap)
                 }
 
                 /* Start over after the L pulse */
-                fseek(tap->fd, fpos2, SEEK_SET);
+                tap->data_pos = fpos2;
                 current_filepos = fpos2;
                 counter = 0;
             } else {
                 /* success.  Go back to start of byte and return */
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 current_filepos = fpos;
                 return 0;
             }
@@ -766,13 +815,13 @@ static int tap_cbm_skip_file(tap_t *tap)
         int ret;
 
         while (1) {
-            fpos = ftell(tap->fd);
+            fpos = tap->data_pos;
 
             /* find next pilot */
             ret = tap_find_pilot(tap, PILOT_TYPE_CBM);
             if (ret < 0) {
                 /* no more pilot found => end of data */
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 break;
             }
 
@@ -780,7 +829,7 @@ static int tap_cbm_skip_file(tap_t *tap)
             ret = tap_cbm_read_block(tap, buffer, 193);
             if (ret < 1 || buffer[0] != 2) {
                 /* next block is not a data continuation block => end of data */
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 break;
             }
         }
@@ -847,7 +896,7 @@ static int tap_tt_skip_pilot(tap_t *tap)
     int data;
 
 #if TAP_DEBUG > 1
-    log_debug("\nTAP_TT_SKIP_PILOT(0x%X", ftell(tap->fd));
+    log_debug("\nTAP_TT_SKIP_PILOT(0x%X", tap->data_pos);
 #endif
 
     /* turbo-tape pilot is just repeats of value 0x02 */
@@ -860,12 +909,12 @@ static int tap_tt_skip_pilot(tap_t *tap)
         if (data != 2) {
             /* value != 0x02, we found the end of the pilot.  Go back
                so byte can be read again */
-            fseek(tap->fd, -8, SEEK_CUR);
+            tap->data_pos -= 8;
         }
     } while (data == 2);
 
 #if TAP_DEBUG > 1
-    log_debug("-0x%X) ", ftell(tap->fd));
+    log_debug("-0x%X) ", tap->data_pos);
 #endif
 
     return 0;
@@ -1087,11 +1136,10 @@ static int tap_determine_pilot_type(tap_t *tap)
 
 static int tap_find_pilot(tap_t *tap, int type)
 {
-    long i, countCBM, countTT, startCBM, startTT, minCBM;
-    int count;
-    int data[256];
-    long pos[257];
-    uint8_t buffer[256];
+    long countCBM, countTT, startCBM, startTT, minCBM;
+    long pos;
+    int data;
+    int pos_advance;
 
     /* when looking for any pilot type, require CBM pilot to be longer
        than when specifically looking for CBM pilot.  A TurboTape L pulse
@@ -1103,7 +1151,7 @@ static int tap_find_pilot(tap_t *tap, int type)
        file */
     minCBM = (type == PILOT_TYPE_ANY) ? 1000 : PILOT_MIN_LENGTH_CBM;
 
-    startCBM = ftell(tap->fd);
+    startCBM = tap->data_pos;
     startTT = startCBM;
     countCBM = 0;
     countTT = 0;
@@ -1112,131 +1160,45 @@ static int tap_find_pilot(tap_t *tap, int type)
     log_debug(" TAP_FIND_PILOT");
 #endif
 
+    /* the image is in memory, so the pulses are read one at a time */
     while ((countCBM < minCBM) && (countTT < PILOT_MIN_LENGTH_TT * 8)) {
-/*        count = fread(&data, 1, 256, tap->fd); */
-        long startpos = ftell(tap->fd);
-        long readlen = fread(buffer, 1, 256, tap->fd);
-        uint32_t pulse_length = 0;
-        int j = 0;
-        long needed;
-        long res;
-        for (i = 0; i < readlen; ) {
-            pos[j] = startpos + i;
-            if (buffer[i] == 0) {
-                if (tap->version == 0) {
-                    pulse_length = 256;
-                    i++;
-                } else if ((tap->version == 1) || (tap->version == 2)) {
-                    long still_in_buffer = readlen - (i + 1);
-                    needed = 3 - still_in_buffer;
-                    if (needed <= 0) {
-                        pulse_length = ((buffer[i + 3] << 16) | (buffer[i + 2] << 8) | buffer[i + 1]) >> 3;
-                        i += 4;
-                    } else {
-                        /* There is not enough in the buffer
-                           Read some more */
-                        memcpy(buffer, buffer + i + 1, still_in_buffer);
-                        res = fread(buffer + still_in_buffer, 1, needed, tap->fd);
-                        i = readlen;
-                        if (res == 0) {
-                            continue;
-                        }
-                        pulse_length = ((buffer[2] << 16) | (buffer[1] << 8) | buffer[0]) >> 3;
-                    }
-                }
-            } else {
-                pulse_length = buffer[i];
-                i++;
-            }
-            data[j] = pulse_length;
-
-            if (tap->version == 2) {
-                uint32_t pulse_length2;
-                /*  Read one more byte if run out of buffer */
-                if (i == readlen) {
-                    readlen = fread(buffer, 1, 1, tap->fd);
-                    if (readlen == 0) {
-                        continue;
-                    }
-                    i = 0;
-                }
-                if (buffer[i] == 0) {
-                    long still_in_buffer = readlen - (i + 1);
-                    needed = 3 - still_in_buffer;
-                    if (needed <= 0) {
-                        pulse_length2 = ((buffer[i + 3] << 16) | (buffer[i + 2] << 8) | buffer[i + 1]) >> 3;
-                        i += 4;
-                    } else {
-                        /* There is not enough in the buffer
-                           Read some more */
-                        memcpy(buffer, buffer + i + 1, still_in_buffer);
-                        res = (int)fread(buffer + still_in_buffer, 1, needed, tap->fd);
-                        i = readlen;
-                        if (res == 0) {
-                            continue;
-                        }
-                        pulse_length2 = ((buffer[2] << 16) | (buffer[1] << 8) | buffer[0]) >> 3;
-                    }
-                } else {
-                    pulse_length2 = buffer[i];
-                    i++;
-                }
-                data[j] += pulse_length2;
-            }
-            j++;
+        pos = tap->data_pos;
+        data = tap_get_pulse(tap, &pos_advance);
+        if (data < 0) {
+            return -1;
         }
-        count = j;
-        pos[j] = ftell(tap->fd);
 
-/*        for (i = 0, count = 0; i < 256; i++, count++) {
-            pos[i] = ftell(tap->fd);
-            data[i] = tap_get_pulse(tap);
-            if (data[i] < 0) break;
-        }
-        pos[i] = ftell(tap->fd);*/
-        if (count < 1) {
-            return -1;
+        if (type == PILOT_TYPE_ANY || type == PILOT_TYPE_CBM) {
+            /* cbm pilot is at least PILOT_MIN_LENGTH_CBM consecutive short pulses */
+            if (TAP_PULSE_SHORT(data)) {
+                countCBM++;
+            } else {
+                startCBM = tap->data_pos;
+                countCBM = 0;
+            }
         }
 
-        for (i = 0; (i < count) && (countCBM < minCBM) && (countTT < PILOT_MIN_LENGTH_TT * 8); i++) {
-            if (type == PILOT_TYPE_ANY || type == PILOT_TYPE_CBM) {
-                /* cbm pilot is at least PILOT_MIN_LENGTH_CBM consecutive short pulses */
-                if (TAP_PULSE_SHORT(data[i])) {
-                    countCBM++;
+        if (type == PILOT_TYPE_ANY || type == PILOT_TYPE_TT) {
+            /* TurboTape pilot is PILOT_MIN_LENGTH_TT or more repeats of the value 0x02.
+               Accept any long bit sequence of 1000000010000000100...
+               Trust that reading the header will fail if we detect a wrong
+               sequence (in that case we come back here) */
+            if ((countTT & 7) == 0) {
+                if (TAP_PULSE_TT_LONG(data)) {
+                    countTT++;
                 } else {
-                    startCBM = pos[i + 1];
-                    countCBM = 0;
+                    startTT = tap->data_pos;
+                    countTT = 0;
                 }
-
-/*                  { startCBM+=countCBM+1; countCBM = 0; } */
-            }
-
-            if (type == PILOT_TYPE_ANY || type == PILOT_TYPE_TT) {
-                /* TurboTape pilot is PILOT_MIN_LENGTH_TT or more repeats of the value 0x02.
-                   Accept any long bit sequence of 1000000010000000100...
-                   Trust that reading the header will fail if we detect a wrong
-                   sequence (in that case we come back here) */
-                if ((countTT & 7) == 0) {
-                    if (TAP_PULSE_TT_LONG(data[i])) {
-                        countTT++;
-                    } else {
-                        startTT = pos[i + 1];
-                        countTT = 0;
-                    }
-/*                      { startTT+=countTT+1; countTT = 0; } */
+            } else {
+                if (TAP_PULSE_TT_SHORT(data)) {
+                    countTT++;
+                } else if (TAP_PULSE_TT_LONG(data)) {
+                    startTT = pos;
+                    countTT = 1;
                 } else {
-                    if (TAP_PULSE_TT_SHORT(data[i])) {
-                        countTT++;
-                    } else if (TAP_PULSE_TT_LONG(data[i])) {
-                        startTT = pos[i];
-                        countTT = 1;
-                    }
-/*                      { startTT+=countTT; countTT = 1; } */
-                    else {
-                        startTT = pos[i + 1];
-                        countTT = 0;
-                    }
-/*                      { startTT+=countTT+1; countTT = 0; } */
+                    startTT = tap->data_pos;
+                    countTT = 0;
                 }
             }
         }
@@ -1254,10 +1216,10 @@ static int tap_find_pilot(tap_t *tap, int type)
         /* startTT points to a '1' bit which we assume to be part of the
            value 00000010.  Skip over the 1 and following 0 so we start
            at the beginning of a 00000010 sequence */
-        fseek(tap->fd, startTT + 2, SEEK_SET);
+        tap->data_pos = startTT + 2;
         return 1;
     } else {
-        fseek(tap->fd, startCBM, SEEK_SET);
+        tap->data_pos = startCBM;
         return 0;
     }
 }
@@ -1277,14 +1239,14 @@ static int tap_find_header(tap_t *tap)
         }
 
         /* store current position in TAP file */
-        fpos = ftell(tap->fd);
+        fpos = tap->data_pos;
 
         /* try to read a header */
         if (type == PILOT_TYPE_CBM) {
             res = tap_cbm_read_header(tap);
             if (res < 0) {
                 int pulse;
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 do {
                     int pos_advance;
                     pulse = tap_get_pulse(tap, &pos_advance);
@@ -1293,7 +1255,7 @@ static int tap_find_header(tap_t *tap)
         } else if (type == PILOT_TYPE_TT) {
             res = tap_tt_read_header(tap);
             if (res < 0) {
-                fseek(tap->fd, fpos, SEEK_SET);
+                tap->data_pos = fpos;
                 tap_tt_skip_pilot(tap);
             }
         } else {
@@ -1307,7 +1269,7 @@ static int tap_find_header(tap_t *tap)
             }
 
             /* success.  Rewind to start of header and return. */
-            fseek(tap->fd, fpos, SEEK_SET);
+            tap->data_pos = fpos;
             tap->current_file_seek_position = (int)fpos;
             return type;
         }
@@ -1325,7 +1287,7 @@ static int tap_read_file(tap_t *tap)
 #endif
 
     /* store current position in TAP file */
-    fpos = ftell(tap->fd);
+    fpos = tap->data_pos;
 
     /* clear old file data */
     tap->current_file_size = 0;
@@ -1351,7 +1313,7 @@ static int tap_read_file(tap_t *tap)
     }
 
     /* go back to previous position in TAP file */
-    fseek(tap->fd, fpos, SEEK_SET);
+    tap->data_pos = fpos;
 
 #if TAP_DEBUG > 0
     log_debug("\nTAP_READ_FILE(END%i)\n", ret);
@@ -1409,13 +1371,25 @@ int tap_seek_start(tap_t *tap)
 
     tap->current_file_number = -1;
     tap->current_file_seek_position = 0;
-    fseek(tap->fd, tap->offset, SEEK_SET);
+    tap->data_pos = tap->offset;
     return 0;
 }
 
 int tap_seek_to_file(tap_t *tap, unsigned int file_number)
 {
     tap_seek_start(tap);
+
+    /* find the header again from where it was searched for before, which
+       leaves everything as skipping the files before it would */
+    if ((int)file_number < tap->file_scan_start_num) {
+        tap->data_pos = tap->file_scan_start[file_number];
+        if (tap_find_header(tap) >= 0) {
+            tap->current_file_number = (int)file_number;
+            return 0;
+        }
+        tap_seek_start(tap);
+    }
+
     while ((int) file_number > tap->current_file_number) {
         if (tap_seek_to_next_file(tap, 0) < 0) {
             return -1;
@@ -1427,6 +1401,8 @@ int tap_seek_to_file(tap_t *tap, unsigned int file_number)
 
 int tap_seek_to_next_file(tap_t *tap, unsigned int allow_rewind)
 {
+    long scan_start;
+
     if (tap == NULL) {
         return -1;
     }
@@ -1442,9 +1418,12 @@ int tap_seek_to_next_file(tap_t *tap, unsigned int allow_rewind)
         tap_skip_file(tap);
     }
 
+    scan_start = tap->data_pos;
+
     if (tap_find_header(tap) < 0) {
         if (allow_rewind) {
             tap_seek_start(tap);
+            scan_start = tap->data_pos;
             if (tap_find_header(tap) < 0) {
                 return -1;
             }
@@ -1454,6 +1433,12 @@ int tap_seek_to_next_file(tap_t *tap, unsigned int allow_rewind)
     }
 
     tap->current_file_number++;
+
+    if (tap->current_file_number == tap->file_scan_start_num) {
+        tap->file_scan_start = lib_realloc(tap->file_scan_start,
+                                           (tap->file_scan_start_num + 1) * sizeof(long));
+        tap->file_scan_start[tap->file_scan_start_num++] = scan_start;
+    }
     return 0;
 }
 
@@ -1493,6 +1478,33 @@ int tap_read(tap_t *tap, uint8_t *buf, size_t size)
     return 0;
 }
 
+/* Write pulses at the current position of the tape, to the file at its
+   current position and to the image in memory.  */
+int tap_write(tap_t *tap, const uint8_t *buf, size_t size)
+{
+    long pos = tap->offset + tap->current_file_seek_position;
+    size_t written;
+
+    written = fwrite(buf, 1, size, tap->fd);
+
+    if (pos + (long)written > tap->data_alloc) {
+        tap->data_alloc = (pos + (long)written) * 2;
+        tap->data = lib_realloc(tap->data, tap->data_alloc);
+    }
+    if (pos > tap->data_size) {
+        memset(tap->data + tap->data_size, 0, pos - tap->data_size);
+    }
+    memcpy(tap->data + pos, buf, written);
+    if (pos + (long)written > tap->data_size) {
+        tap->data_size = pos + (long)written;
+    }
+
+    /* the files may have moved */
+    tap->file_scan_start_num = 0;
+
+    return (int)written;
+}
+
 
 void tap_get_header(tap_t *tap, uint8_t *name)
 {
@@ -69,10 +69,7 @@ static int tape_snapshot_read_t64image_module(snapshot_t *s)
 static int tape_snapshot_write_tapimage_module(snapshot_t *s)
 {
     snapshot_module_t *m;
-    FILE *ftap;
-    long pos, tap_size;
-    uint8_t buffer[256];
-    int i;
+    tap_t *tap;
 
     m = snapshot_module_create(s, "TAPIMAGE", TAPIMAGE_SNAP_MAJOR,
                                TAPIMAGE_SNAP_MINOR);
@@ -80,48 +77,22 @@ static int tape_snapshot_write_tapimage_module(snapshot_t *s)
         return -1;
     }
 
-    /* get the file descriptor */
-    ftap = ((tap_t*)tape_image_dev1->data)->fd;
-    if (!ftap) {
+    /* the whole image is in memory */
+    tap = (tap_t*)tape_image_dev1->data;
+    if (tap == NULL || tap->data == NULL) {
         log_error(tape_snapshot_log, "Cannot open tapfile for reading");
         return -1;
     }
 
-    /* remeber current position */
-    pos = ftell(ftap);
-
-    /* move to end and get size of file */
-    if (fseek(ftap, 0, SEEK_END) != 0) {
-        log_error(tape_snapshot_log, "Cannot move to end of tapfile");
-        return -1;
-    }
-
-    tap_size = ftell(ftap);
-    if (SMW_DW(m, (unsigned int)tap_size)) {
-        fseek(ftap, pos, SEEK_SET);
+    if (SMW_DW(m, (unsigned int)tap->data_size)) {
         log_error(tape_snapshot_log, "Cannot write size of tap image");
     }
 
-    /* move to beginning */
-    if (fseek(ftap, 0, SEEK_SET) != 0) {
-        log_error(tape_snapshot_log, "Cannot move to beginning of tapfile");
+    if (SMW_BA(m, tap->data, (unsigned int)tap->data_size) < 0) {
+        log_error(tape_snapshot_log, "Cannot write tap image");
         return -1;
     }
 
-    /* read every BYTE and write to snapshot module */
-    while (tap_size > 0) {
-        i = (int)fread(buffer, 1, 256, ftap);
-        if (SMW_BA(m, buffer, i) < 0) {
-            log_error(tape_snapshot_log, "Cannot write tap image");
-            fseek(ftap, pos, SEEK_SET);
-            return -1;
-        }
-        tap_size -= i;
-    }
-
-    /* restore position */
-    fseek(ftap, pos, SEEK_SET);
-
     if (snapshot_module_close(m) < 0) {
         return -1;
     }
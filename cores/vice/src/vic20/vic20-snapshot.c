@@ -59,18 +59,10 @@
 #define SNAP_MINOR          0
 
 
-int vic20_snapshot_write(const char *name, int save_roms, int save_disks,
-                         int event_mode)
+static int vic20_snapshot_write_modules(snapshot_t *s, int save_roms, int save_disks, int event_mode)
 {
-    snapshot_t *s;
     int ieee488;
 
-    s = snapshot_create(name, ((uint8_t)(SNAP_MAJOR)), ((uint8_t)(SNAP_MINOR)),
-                        machine_name);
-    if (s == NULL) {
-        return -1;
-    }
-
     sound_snapshot_prepare();
 
     /* FIXME: Missing sound.  */
@@ -85,8 +77,6 @@ int vic20_snapshot_write(const char *name, int save_roms, int save_disks,
         || keyboard_snapshot_write_module(s) < 0
         || joyport_snapshot_write_module(s, JOYPORT_1) < 0
         || userport_snapshot_write_module(s) < 0) {
-        snapshot_close(s);
-        ioutil_remove(name);
         return -1;
     }
 
@@ -94,26 +84,56 @@ int vic20_snapshot_write(const char *name, int save_roms, int save_disks,
     if (ieee488) {
         if (viacore_snapshot_write_module(machine_context.ieeevia1, s) < 0
             || viacore_snapshot_write_module(machine_context.ieeevia2, s) < 0) {
-            snapshot_close(s);
-            ioutil_remove(name);
-            return 1;
+            return -1;
         }
     }
 
+    return 0;
+}
+
+int vic20_snapshot_write(const char *name, int save_roms, int save_disks,
+                         int event_mode)
+{
+    snapshot_t *s;
+
+    s = snapshot_create(name, ((uint8_t)(SNAP_MAJOR)), ((uint8_t)(SNAP_MINOR)),
+                        machine_name);
+    if (s == NULL) {
+        return -1;
+    }
+
+    if (vic20_snapshot_write_modules(s, save_roms, save_disks, event_mode) < 0) {
+        snapshot_close(s);
+        ioutil_remove(name);
+        return -1;
+    }
+
     snapshot_close(s);
     return 0;
 }
 
-int vic20_snapshot_read(const char *name, int event_mode)
+int vic20_snapshot_write_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode)
 {
     snapshot_t *s;
-    uint8_t minor, major;
 
-    s = snapshot_open(name, &major, &minor, machine_name);
+    s = snapshot_create_memory(mem, ((uint8_t)(SNAP_MAJOR)), ((uint8_t)(SNAP_MINOR)),
+                               machine_name);
     if (s == NULL) {
         return -1;
     }
 
+    if (vic20_snapshot_write_modules(s, save_roms, save_disks, event_mode) < 0) {
+        snapshot_close(s);
+        return -1;
+    }
+
+    snapshot_close(s);
+    return 0;
+}
+
+/* Read the modules and close the snapshot.  */
+static int vic20_snapshot_read_modules(snapshot_t *s, uint8_t major, uint8_t minor, int event_mode)
+{
     if (!snapshot_version_is_equal(major, minor, SNAP_MAJOR, SNAP_MINOR)) {
         log_error(LOG_DEFAULT, "Snapshot version (%d.%d) not valid: expecting %d.%d.", major, minor, SNAP_MAJOR, SNAP_MINOR);
         snapshot_set_error(SNAPSHOT_MODULE_INCOMPATIBLE);
@@ -160,3 +180,29 @@ fail:
 
     return -1;
 }
+
+int vic20_snapshot_read(const char *name, int event_mode)
+{
+    snapshot_t *s;
+    uint8_t minor, major;
+
+    s = snapshot_open(name, &major, &minor, machine_name);
+    if (s == NULL) {
+        return -1;
+    }
+
+    return vic20_snapshot_read_modules(s, major, minor, event_mode);
+}
+
+int vic20_snapshot_read_memory(const uint8_t *data, size_t size, int event_mode)
+{
+    snapshot_t *s;
+    uint8_t minor, major;
+
+    s = snapshot_open_memory(data, size, &major, &minor, machine_name);
+    if (s == NULL) {
+        return -1;
+    }
+
+    return vic20_snapshot_read_modules(s, major, minor, event_mode);
+}
@@ -27,8 +27,12 @@
 #ifndef VICE_VIC20_SNAPSHOT_H
 #define VICE_VIC20_SNAPSHOT_H
 
+#include "snapshot.h"
+
 extern int vic20_snapshot_write(const char *name, int save_roms, int save_disks,
                                 int event_mode);
 extern int vic20_snapshot_read(const char *name, int event_mode);
+extern int vic20_snapshot_write_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode);
+extern int vic20_snapshot_read_memory(const uint8_t *data, size_t size, int event_mode);
 
 #endif
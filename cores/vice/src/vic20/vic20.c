@@ -72,6 +72,7 @@
 #include "paperclip64.h"
 #include "parallel.h"
 #include "printer.h"
+#include "rewind.h"
 #include "rs232drv.h"
 #include "rsuser.h"
 #include "rushware_keypad.h"
@@ -595,6 +596,10 @@ int machine_resources_init(void)
         return -1;
     }
 #endif
+    if (rewind_resources_init() < 0) {
+        init_resource_fail("rewind");
+        return -1;
+    }
 #ifdef DEBUG
     if (debug_resources_init() < 0) {
         init_resource_fail("debug");
@@ -687,6 +692,7 @@ void machine_resources_shutdown(void)
     userport_resources_shutdown();
     joyport_bbrtc_resources_shutdown();
     tapeport_resources_shutdown();
+    rewind_resources_shutdown();
 }
 
 /* VIC20-specific command-line option initialization.  */
@@ -786,6 +792,10 @@ int machine_cmdline_options_init(void)
         return -1;
     }
 #endif
+    if (rewind_cmdline_options_init() < 0) {
+        init_cmdline_options_fail("rewind");
+        return -1;
+    }
 #ifdef DEBUG
     if (debug_cmdline_options_init() < 0) {
         init_cmdline_options_fail("debug");
@@ -1093,6 +1103,8 @@ static void machine_vsync_hook(void)
 
     screenshot_record();
 
+    rewind_vsync_hook();
+
     sub = clk_guard_prevent_overflow(maincpu_clk_guard);
 
     /* The drive has to deal both with our overflowing and its own one, so
@@ -1198,6 +1210,24 @@ int machine_read_snapshot(const char *name, int event_mode)
     return err;
 }
 
+int machine_write_snapshot_memory(snapshot_memory_t *mem, int save_roms, int save_disks, int event_mode)
+{
+    int err = vic20_snapshot_write_memory(mem, save_roms, save_disks, event_mode);
+    if ((err < 0) && (snapshot_get_error() == SNAPSHOT_NO_ERROR)) {
+        snapshot_set_error(SNAPSHOT_CANNOT_WRITE_SNAPSHOT);
+    }
+    return err;
+}
+
+int machine_read_snapshot_memory(const uint8_t *data, size_t size, int event_mode)
+{
+    int err = vic20_snapshot_read_memory(data, size, event_mode);
+    if ((err < 0) && (snapshot_get_error() == SNAPSHOT_NO_ERROR)) {
+        snapshot_set_error(SNAPSHOT_CANNOT_READ_SNAPSHOT);
+    }
+    return err;
+}
+
 
 /* ------------------------------------------------------------------------- */
 int machine_autodetect_psid(const char *name)
@@ -57,6 +57,7 @@ struct video_cbm_palette_s;
 struct viewport_s;
 struct geometry_s;
 struct palette_s;
+struct video_render_thread_s;
 
 struct canvas_refresh_s {
     uint8_t *draw_buffer;
@@ -79,6 +80,9 @@ struct draw_buffer_s {
     /* Height of draw_buffer in pixels. Typically same as geometry->screen_size.height */
     unsigned int draw_buffer_height;
     unsigned int draw_buffer_pitch;
+    /* One flag per line of draw_buffer, set by the raster when the line
+       changed and cleared when it has been rendered */
+    uint8_t *dirty_lines;
     /* Width of emulator screen (physical screen on the machine where the emulator runs) in pixels */
     unsigned int canvas_physical_width;
     /* Height of emulator screen (physical screen on the machine where the emulator runs) in pixels */
@@ -154,6 +158,11 @@ struct video_render_color_tables_s {
     int32_t cvtable[256];        /* v component */
     int32_t cvtable_odd[256];    /* v component + phase shift */
 
+    /* ytablel, ytableh, cbtable and crtable (or cbtable_odd and crtable_odd)
+       of each colour next to each other, for render_yuv_line_32() */
+    int32_t ycbcrtable[256 * 4];
+    int32_t ycbcrtable_odd[256 * 4];
+
     /* YUV table for hardware rendering: (Y << 16) | (U << 8) | V */
     int yuv_updated;            /* yuv table updated for packed mode */
     uint32_t yuv_table[512];
@@ -180,6 +189,15 @@ typedef struct video_resources_s {
     int audioleak;              /* flag: enable video->audio leak emulation */
 } video_resources_t;
 
+/* The last frame rendered by video_render_frame_dirty().  While it is
+   valid, the target still holds it and only changed lines are rendered.  */
+typedef struct video_render_last_frame_s {
+    int valid;
+    uint8_t *src, *trg;
+    int width, height, xs, ys, xt, yt, pitchs, pitcht, depth;
+    int rendermode, doublescan, scale2x;
+} video_render_last_frame_t;
+
 /* render config for a specific canvas and video chip */
 struct video_render_config_s {
     char *chip_name;               /* chip name prefix, (use to build resource names) */
@@ -199,6 +217,10 @@ struct video_render_config_s {
     int readable;                  /* reading of frame buffer is safe and fast */
     struct video_cbm_palette_s *cbm_palette; /* Internal palette.  */
     struct video_render_color_tables_s color_tables;
+    struct video_render_thread_s *render_thread; /* Renders frames queued by video_canvas_render_queue() */
+    video_render_last_frame_t last_frame;
+    unsigned long lines_rendered;  /* target lines rendered by video_render_frame_dirty() */
+    unsigned long lines_skipped;   /* target lines it left as they were */
     int fullscreen_enabled;
     int fullscreen_statusbar_enabled;
     char *fullscreen_device;
@@ -245,9 +267,26 @@ extern void video_canvas_destroy(struct video_canvas_s *canvas);
 extern void video_canvas_map(struct video_canvas_s *canvas);
 extern void video_canvas_unmap(struct video_canvas_s *canvas);
 extern void video_canvas_resize(struct video_canvas_s *canvas, char resize_canvas);
+/* Lines that have not changed since the last frame rendered into the same
+   target with the same layout are left as they are.  */
 extern void video_canvas_render(struct video_canvas_s *canvas, uint8_t *trg,
                                 int width, int height, int xs, int ys,
                                 int xt, int yt, int pitcht, int depth);
+/* Like video_canvas_render(), but render the whole frame, whatever changed,
+   and leave the changed line flags alone.  */
+extern void video_canvas_render_full(struct video_canvas_s *canvas, uint8_t *trg,
+                                     int width, int height, int xs, int ys,
+                                     int xt, int yt, int pitcht, int depth);
+/* Like video_canvas_render(), but render on a separate thread from a copy
+   of the draw buffer, so that the emulation can go on with the next frame.
+   The previous frame queued for the canvas is waited for first, so at most
+   one frame is in flight.  `trg' is complete once video_canvas_render_wait()
+   or the next video_canvas_render_queue() returns.  Without threads this
+   renders at once.  Only used by the headless benchmark so far.  */
+extern void video_canvas_render_queue(struct video_canvas_s *canvas, uint8_t *trg,
+                                      int width, int height, int xs, int ys,
+                                      int xt, int yt, int pitcht, int depth);
+extern void video_canvas_render_wait(struct video_canvas_s *canvas);
 extern void video_canvas_refresh_all(struct video_canvas_s *canvas);
 extern char video_canvas_can_resize(struct video_canvas_s *canvas);
 extern void video_viewport_get(struct video_canvas_s *canvas,
@@ -26,7 +26,10 @@
 
 #include "vice.h"
 
+#include <stddef.h>
+
 #include "render1x1pal.h"
+#include "rendersimd.h"
 #include "types.h"
 #include "video-color.h"
 
@@ -159,7 +162,7 @@ render_generic_1x1_pal(video_render_color_tables_t *color_tab, const uint8_t *sr
                        void (*store_func)(uint8_t *trg,
                                           int32_t y1, int32_t u1, int32_t v1,
                                           int32_t y2, int32_t u2, int32_t v2),
-                       int yuvtarget, video_render_config_t *config)
+                       int yuvtarget, int yuv_lines, video_render_config_t *config)
 {
     const int32_t *cbtable = color_tab->cbtable;
     const int32_t *crtable = color_tab->crtable;
@@ -171,6 +174,7 @@ render_generic_1x1_pal(video_render_color_tables_t *color_tab, const uint8_t *sr
     int32_t *line, l1, l2, u1, u2, v1, v2, unew, vnew;
     uint8_t cl0, cl1, cl2, cl3;
     int off, off_flip;
+    render_yuv_line_t yuv_line;
 
     /* ensure starting on even coords */
     if ((xt & 1) && xs > 0) {
@@ -211,6 +215,13 @@ render_generic_1x1_pal(video_render_color_tables_t *color_tab, const uint8_t *sr
     /* Calculate odd line shading */
     off = (int) (((float) config->video_resources.pal_oddlines_offset * (1.5f / 2000.0f) - (1.5f / 2.0f - 1.0f)) * (1 << 5));
 
+    yuv_line.line = color_tab->line_yuv_0;
+    yuv_line.interpolate = 0;
+    yuv_line.trg2 = NULL;
+    yuv_line.scanline = NULL;
+    yuv_line.scanline2 = NULL;
+    yuv_line.prevline = NULL;
+
     for (y = ys; y < height + ys; y++) {
         tmpsrc = src;
         tmptrg = trg;
@@ -227,6 +238,16 @@ render_generic_1x1_pal(video_render_color_tables_t *color_tab, const uint8_t *sr
             crtable = yuvtarget ? color_tab->cvtable : color_tab->crtable;
         }
 
+        if (yuv_lines) {
+            yuv_line.ycbcrtable = (y & 1) ? color_tab->ycbcrtable_odd : color_tab->ycbcrtable;
+            yuv_line.off_flip = off_flip;
+            yuv_line.trg = (uint32_t *)trg;
+            render_yuv_line_32(&yuv_line, src, 0, width * 2);
+            src += pitchs;
+            trg += pitcht;
+            continue;
+        }
+
         /* one scanline */
         for (x = 0; x < width; x++) {
             cl0 = tmpsrc[0];
@@ -276,7 +297,7 @@ render_UYVY_1x1_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_1x1_pal(color_tab, src, trg, width, height, xs, ys, xt, yt,
                            pitchs, pitcht,
-                           4, store_pixel_UYVY, 1, config);
+                           4, store_pixel_UYVY, 1, 0, config);
 }
 
 void
@@ -289,7 +310,7 @@ render_YUY2_1x1_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_1x1_pal(color_tab, src, trg, width, height, xs, ys, xt, yt,
                            pitchs, pitcht,
-                           4, store_pixel_YUY2, 1, config);
+                           4, store_pixel_YUY2, 1, 0, config);
 }
 
 void
@@ -302,7 +323,7 @@ render_YVYU_1x1_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_1x1_pal(color_tab, src, trg, width, height, xs, ys, xt, yt,
                            pitchs, pitcht,
-                           4, store_pixel_YVYU, 1, config);
+                           4, store_pixel_YVYU, 1, 0, config);
 }
 
 void
@@ -315,7 +336,7 @@ render_16_1x1_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_1x1_pal(color_tab, src, trg, width, height, xs, ys, xt, yt,
                            pitchs, pitcht,
-                           4, store_pixel_2, 0, config);
+                           4, store_pixel_2, 0, 0, config);
 }
 
 void
@@ -328,7 +349,7 @@ render_24_1x1_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_1x1_pal(color_tab, src, trg, width, height, xs, ys, xt, yt,
                            pitchs, pitcht,
-                           6, store_pixel_3, 0, config);
+                           6, store_pixel_3, 0, 0, config);
 }
 
 void
@@ -341,5 +362,5 @@ render_32_1x1_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_1x1_pal(color_tab, src, trg, width, height, xs, ys, xt, yt,
                            pitchs, pitcht,
-                           8, store_pixel_4, 0, config);
+                           8, store_pixel_4, 0, render_yuv_simd, config);
 }
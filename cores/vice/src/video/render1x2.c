@@ -27,6 +27,7 @@
 #include "vice.h"
 
 #include "render1x2.h"
+#include "rendersimd.h"
 #include "types.h"
 #include <string.h>
 
@@ -42,22 +43,12 @@ void render_08_1x2_04(const video_render_color_tables_t *color_tab, const uint8_
     const uint32_t *colortab = color_tab->physical_colors;
     const uint8_t *tmpsrc;
     uint8_t *tmptrg;
-    unsigned int x, y, wstart, wfast, wend, yys;
+    unsigned int y, yys;
     int readable = config->readable;
 
     src += pitchs * ys + xs;
     trg += pitcht * yt + xt;
     yys = (ys << 1) | (yt & 1);
-    if (width < 8) {
-        wstart = width;
-        wfast = 0;
-        wend = 0;
-    } else {
-        /* alignment: 8 pixels*/
-        wstart = (unsigned int)(8 - (vice_ptr_to_uint(trg) & 7));
-        wfast = (width - wstart) >> 3; /* fast loop for 8 pixel segments*/
-        wend = (width - wstart) & 0x07; /* do not forget the rest*/
-    }
     for (y = yys; y < (yys + height); y++) {
         tmpsrc = src;
         tmptrg = trg;
@@ -65,24 +56,7 @@ void render_08_1x2_04(const video_render_color_tables_t *color_tab, const uint8_
             if ((y & 1) && readable && y > yys) { /* copy previous line */
                 memcpy(trg, trg - pitcht, width);
             } else {
-                for (x = 0; x < wstart; x++) {
-                    *tmptrg++ = (uint8_t)colortab[*tmpsrc++];
-                }
-                for (x = 0; x < wfast; x++) {
-                    tmptrg[0] = (uint8_t)colortab[tmpsrc[0]];
-                    tmptrg[1] = (uint8_t)colortab[tmpsrc[1]];
-                    tmptrg[2] = (uint8_t)colortab[tmpsrc[2]];
-                    tmptrg[3] = (uint8_t)colortab[tmpsrc[3]];
-                    tmptrg[4] = (uint8_t)colortab[tmpsrc[4]];
-                    tmptrg[5] = (uint8_t)colortab[tmpsrc[5]];
-                    tmptrg[6] = (uint8_t)colortab[tmpsrc[6]];
-                    tmptrg[7] = (uint8_t)colortab[tmpsrc[7]];
-                    tmpsrc += 8;
-                    tmptrg += 8;
-                }
-                for (x = 0; x < wend; x++) {
-                    *tmptrg++ = (uint8_t)colortab[*tmpsrc++];
-                }
+                render_expand_08(colortab, tmpsrc, tmptrg, width);
             }
         } else {
             memset(trg, (uint8_t)colortab[0], width);
@@ -128,24 +102,7 @@ void render_16_1x2_04(const video_render_color_tables_t *color_tab, const uint8_
             if ((y & 1) && readable && y > yys) { /* copy previous line */
                 memcpy(trg, trg - pitcht, width << 1);
             } else {
-                for (x = 0; x < wstart; x++) {
-                    *tmptrg++ = (uint16_t)colortab[*tmpsrc++];
-                }
-                for (x = 0; x < wfast; x++) {
-                    tmptrg[0] = (uint16_t)colortab[tmpsrc[0]];
-                    tmptrg[1] = (uint16_t)colortab[tmpsrc[1]];
-                    tmptrg[2] = (uint16_t)colortab[tmpsrc[2]];
-                    tmptrg[3] = (uint16_t)colortab[tmpsrc[3]];
-                    tmptrg[4] = (uint16_t)colortab[tmpsrc[4]];
-                    tmptrg[5] = (uint16_t)colortab[tmpsrc[5]];
-                    tmptrg[6] = (uint16_t)colortab[tmpsrc[6]];
-                    tmptrg[7] = (uint16_t)colortab[tmpsrc[7]];
-                    tmpsrc += 8;
-                    tmptrg += 8;
-                }
-                for (x = 0; x < wend; x++) {
-                    *tmptrg++ = (uint16_t)colortab[*tmpsrc++];
-                }
+                render_expand_16(colortab, tmpsrc, (uint8_t *)tmptrg, width);
             }
         } else {
             if (readable && y > yys + 1) { /* copy 2 lines before */
@@ -214,52 +171,7 @@ void render_24_1x2_04(const video_render_color_tables_t *color_tab, const uint8_
             if ((y & 1) && readable && y > yys) { /* copy previous line */
                 memcpy(trg, trg - pitcht, width * 3);
             } else {
-                for (x = 0; x < wstart; x++) {
-                    color = colortab[*tmpsrc++];
-                    tmptrg[0] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[1] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[2] = (uint8_t)color;
-                    tmptrg += 3;
-                }
-                for (x = 0; x < wfast; x++) {
-                    color = colortab[tmpsrc[0]];
-                    tmptrg[0] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[1] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[2] = (uint8_t)color;
-                    color = colortab[tmpsrc[1]];
-                    tmptrg[3] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[4] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[5] = (uint8_t)color;
-                    color = colortab[tmpsrc[2]];
-                    tmptrg[6] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[7] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[8] = (uint8_t)color;
-                    color = colortab[tmpsrc[3]];
-                    tmptrg[9] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[10] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[11] = (uint8_t)color;
-                    tmpsrc += 4;
-                    tmptrg += 12;
-                }
-                for (x = 0; x < wend; x++) {
-                    color = colortab[*tmpsrc++];
-                    tmptrg[0] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[1] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[2] = (uint8_t)color;
-                    tmptrg += 3;
-                }
+                render_expand_24(colortab, tmpsrc, tmptrg, width);
             }
         } else {
             if (readable && y > yys + 1) { /* copy 2 lines before */
@@ -355,24 +267,7 @@ void render_32_1x2_04(const video_render_color_tables_t *color_tab, const uint8_
             if ((y & 1) && readable && y > yys) { /* copy previous line */
                 memcpy(trg, trg - pitcht, width << 2);
             } else {
-                for (x = 0; x < wstart; x++) {
-                    *tmptrg++ = colortab[*tmpsrc++];
-                }
-                for (x = 0; x < wfast; x++) {
-                    tmptrg[0] = colortab[tmpsrc[0]];
-                    tmptrg[1] = colortab[tmpsrc[1]];
-                    tmptrg[2] = colortab[tmpsrc[2]];
-                    tmptrg[3] = colortab[tmpsrc[3]];
-                    tmptrg[4] = colortab[tmpsrc[4]];
-                    tmptrg[5] = colortab[tmpsrc[5]];
-                    tmptrg[6] = colortab[tmpsrc[6]];
-                    tmptrg[7] = colortab[tmpsrc[7]];
-                    tmpsrc += 8;
-                    tmptrg += 8;
-                }
-                for (x = 0; x < wend; x++) {
-                    *tmptrg++ = colortab[*tmpsrc++];
-                }
+                render_expand_32(colortab, tmpsrc, (uint8_t *)tmptrg, width);
             }
         } else {
             if (readable && y > yys + 1) { /* copy 2 lines before */
@@ -27,10 +27,11 @@
 
 #include "vice.h"
 
-#include <stdio.h>
+#include <stddef.h>
 
 #include "render1x2.h"
 #include "render1x2crt.h"
+#include "rendersimd.h"
 #include "types.h"
 #include "video-color.h"
 
@@ -315,7 +316,8 @@ void render_generic_1x2_crt(video_render_color_tables_t *color_tab,
                                 uint8_t *const line, uint8_t *const scanline,
                                 int16_t *const prevline, const int shade,
                                 int32_t l1, int32_t u1, int32_t v1, int32_t l2, int32_t u2, int32_t v2),
-                            const int write_interpolated_pixels, video_render_config_t *config)
+                            const int write_interpolated_pixels, const int yuv_lines,
+                            video_render_config_t *config)
 {
     int16_t *prevrgblineptr;
     const int32_t *ytablel = color_tab->ytablel;
@@ -330,6 +332,7 @@ void render_generic_1x2_crt(video_render_color_tables_t *color_tab,
     int32_t v2 = 0;
     int first_line = viewport->first_line * 2;
     int last_line = (viewport->last_line * 2) + 1;
+    render_yuv_line_t yuv_line;
 
     src = src + pitchs * ys + xs - 2;
     trg = trg + pitcht * yt + xt * pixelstride;
@@ -348,6 +351,10 @@ void render_generic_1x2_crt(video_render_color_tables_t *color_tab,
 
     /* Calculate odd line shading */
     shade = (int) ((float) config->video_resources.pal_scanlineshade / 1000.0f * 256.f);
+
+    yuv_line.line = NULL;
+    yuv_line.interpolate = 0;
+
     off_flip = 1 << 6;
 
     /* height & 1 == 0. */
@@ -385,6 +392,20 @@ void render_generic_1x2_crt(video_render_color_tables_t *color_tab,
         cbtable = write_interpolated_pixels ? color_tab->cbtable : color_tab->cutable;
         crtable = write_interpolated_pixels ? color_tab->crtable : color_tab->cvtable;
 
+        if (yuv_lines) {
+            yuv_line.ycbcrtable = color_tab->ycbcrtable;
+            yuv_line.off_flip = off_flip;
+            yuv_line.trg = (uint32_t *)tmptrg;
+            yuv_line.trg2 = NULL;
+            yuv_line.scanline = (uint32_t *)tmptrgscanline;
+            yuv_line.scanline2 = NULL;
+            yuv_line.prevline = &color_tab->prevrgbline[0];
+            render_yuv_line_32(&yuv_line, src, wfirst, width + wlast);
+            src += pitchs;
+            trg += pitcht * 2;
+            continue;
+        }
+
         l = ytablel[tmpsrc[1]] + ytableh[tmpsrc[2]] + ytablel[tmpsrc[3]];
         unew = cbtable[tmpsrc[0]] + cbtable[tmpsrc[1]] + cbtable[tmpsrc[2]] + cbtable[tmpsrc[3]];
         vnew = crtable[tmpsrc[0]] + crtable[tmpsrc[1]] + crtable[tmpsrc[2]] + crtable[tmpsrc[3]];
@@ -478,7 +499,7 @@ void render_UYVY_1x2_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_1x2_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           2, store_line_and_scanline_UYVY, 0, config);
+                           2, store_line_and_scanline_UYVY, 0, 0, config);
 }
 
 void render_YUY2_1x2_crt(video_render_color_tables_t *color_tab,
@@ -491,7 +512,7 @@ void render_YUY2_1x2_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_1x2_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           2, store_line_and_scanline_YUY2, 0, config);
+                           2, store_line_and_scanline_YUY2, 0, 0, config);
 }
 
 void render_YVYU_1x2_crt(video_render_color_tables_t *color_tab,
@@ -504,7 +525,7 @@ void render_YVYU_1x2_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_1x2_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           2, store_line_and_scanline_YVYU, 0, config);
+                           2, store_line_and_scanline_YVYU, 0, 0, config);
 }
 
 void render_16_1x2_crt(video_render_color_tables_t *color_tab,
@@ -517,7 +538,7 @@ void render_16_1x2_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_1x2_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           2, store_line_and_scanline_2, 1, config);
+                           2, store_line_and_scanline_2, 1, 0, config);
 }
 
 void render_24_1x2_crt(video_render_color_tables_t *color_tab,
@@ -530,7 +551,7 @@ void render_24_1x2_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_1x2_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           3, store_line_and_scanline_3, 1, config);
+                           3, store_line_and_scanline_3, 1, 0, config);
 }
 
 void render_32_1x2_crt(video_render_color_tables_t *color_tab,
@@ -543,5 +564,5 @@ void render_32_1x2_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_1x2_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_4, 1, config);
+                           4, store_line_and_scanline_4, 1, render_yuv_simd, config);
 }
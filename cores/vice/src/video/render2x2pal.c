@@ -26,10 +26,11 @@
 
 #include "vice.h"
 
-#include <stdio.h>
+#include <stddef.h>
 
 #include "render2x2.h"
 #include "render2x2pal.h"
+#include "rendersimd.h"
 #include "types.h"
 #include "video-color.h"
 
@@ -279,7 +280,8 @@ void render_generic_2x2_pal(video_render_color_tables_t *color_tab,
                                 uint8_t *const line, uint8_t *const scanline,
                                 int16_t *const prevline, const int shade,
                                 int32_t l, int32_t u, int32_t v),
-                            const int write_interpolated_pixels, video_render_config_t *config)
+                            const int write_interpolated_pixels, const int yuv_lines,
+                            video_render_config_t *config)
 {
     int16_t *prevrgblineptr;
     const int32_t *ytablel = color_tab->ytablel;
@@ -291,6 +293,7 @@ void render_generic_2x2_pal(video_render_color_tables_t *color_tab,
     int32_t l, l2, u, u2, unew, v, v2, vnew, off, off_flip, shade;
     int first_line = viewport->first_line * 2;
     int last_line = (viewport->last_line * 2) + 1;
+    render_yuv_line_t yuv_line;
 
     src = src + pitchs * ys + xs - 2;
     trg = trg + pitcht * yt + xt * pixelstride;
@@ -336,6 +339,9 @@ void render_generic_2x2_pal(video_render_color_tables_t *color_tab,
     off = (int) (((float) config->video_resources.pal_oddlines_offset * (1.5f / 2000.0f) - (1.5f / 2.0f - 1.0f)) * (1 << 5));
     shade = (int) ((float) config->video_resources.pal_scanlineshade / 1000.0f * 256.f);
 
+    yuv_line.line = color_tab->line_yuv_0;
+    yuv_line.interpolate = 1;
+
     /* height & 1 == 0. */
     for (y = yys; y < yys + height + 1; y += 2) {
         /* when we are dealing with the last line, the rules change:
@@ -381,6 +387,20 @@ void render_generic_2x2_pal(video_render_color_tables_t *color_tab,
             crtable = write_interpolated_pixels ? color_tab->crtable : color_tab->cvtable;
         }
 
+        if (yuv_lines) {
+            yuv_line.ycbcrtable = (y & 2) ? color_tab->ycbcrtable_odd : color_tab->ycbcrtable;
+            yuv_line.off_flip = off_flip;
+            yuv_line.trg = (uint32_t *)tmptrg;
+            yuv_line.trg2 = NULL;
+            yuv_line.scanline = (uint32_t *)tmptrgscanline;
+            yuv_line.scanline2 = NULL;
+            yuv_line.prevline = &color_tab->prevrgbline[0];
+            render_yuv_line_32(&yuv_line, src, wfirst, wfirst + width * 2 + wlast);
+            src += pitchs;
+            trg += pitcht * 2;
+            continue;
+        }
+
         l = ytablel[tmpsrc[1]] + ytableh[tmpsrc[2]] + ytablel[tmpsrc[3]];
         unew = cbtable[tmpsrc[0]] + cbtable[tmpsrc[1]] + cbtable[tmpsrc[2]] + cbtable[tmpsrc[3]];
         vnew = crtable[tmpsrc[0]] + crtable[tmpsrc[1]] + crtable[tmpsrc[2]] + crtable[tmpsrc[3]];
@@ -458,7 +478,7 @@ void render_UYVY_2x2_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_2x2_pal(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_UYVY, 0, config);
+                           4, store_line_and_scanline_UYVY, 0, 0, config);
 }
 
 void render_YUY2_2x2_pal(video_render_color_tables_t *color_tab,
@@ -471,7 +491,7 @@ void render_YUY2_2x2_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_2x2_pal(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_YUY2, 0, config);
+                           4, store_line_and_scanline_YUY2, 0, 0, config);
 }
 
 void render_YVYU_2x2_pal(video_render_color_tables_t *color_tab,
@@ -484,7 +504,7 @@ void render_YVYU_2x2_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_2x2_pal(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_YVYU, 0, config);
+                           4, store_line_and_scanline_YVYU, 0, 0, config);
 }
 
 void render_16_2x2_pal(video_render_color_tables_t *color_tab,
@@ -497,7 +517,7 @@ void render_16_2x2_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_2x2_pal(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           2, store_line_and_scanline_2, 1, config);
+                           2, store_line_and_scanline_2, 1, 0, config);
 }
 
 void render_24_2x2_pal(video_render_color_tables_t *color_tab,
@@ -510,7 +530,7 @@ void render_24_2x2_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_2x2_pal(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           3, store_line_and_scanline_3, 1, config);
+                           3, store_line_and_scanline_3, 1, 0, config);
 }
 
 void render_32_2x2_pal(video_render_color_tables_t *color_tab,
@@ -523,5 +543,5 @@ void render_32_2x2_pal(video_render_color_tables_t *color_tab,
 {
     render_generic_2x2_pal(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_4, 1, config);
+                           4, store_line_and_scanline_4, 1, render_yuv_simd, config);
 }
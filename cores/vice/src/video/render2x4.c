@@ -28,6 +28,7 @@
 #include "vice.h"
 
 #include "render2x4.h"
+#include "rendersimd.h"
 #include "types.h"
 #include <string.h>
 
@@ -44,26 +45,16 @@ void render_08_2x4_04(const video_render_color_tables_t *color_tab,
     const uint32_t *colortab = color_tab->physical_colors;
     const uint8_t *tmpsrc;
     uint16_t *tmptrg;
-    unsigned int x, y, wfirst, wstart, wfast, wend, wlast, yys;
+    unsigned int y, wfirst, wlast, yys;
     int readable = config->readable;
 
     src = src + pitchs * ys + xs;
     trg = trg + pitcht * yt + xt;
-    yys = (ys << 1) | (yt & 1);
+    yys = (ys << 2) | (yt & 1);
     wfirst = xt & 1;
     width -= wfirst;
     wlast = width & 1;
     width >>= 1;
-    if (width < 8) {
-        wstart = width;
-        wfast = 0;
-        wend = 0;
-    } else {
-        /* alignment: 8 pixels*/
-        wstart = (unsigned int)(8 - (vice_ptr_to_uint(trg) & 7));
-        wfast = (width - wstart) >> 3; /* fast loop for 8 pixel segments*/
-        wend = (width - wstart) & 0x07; /* do not forget the rest*/
-    }
     for (y = yys; y < (yys + height); y++) {
         tmpsrc = src;
         tmptrg = (uint16_t *)trg;
@@ -75,24 +66,9 @@ void render_08_2x4_04(const video_render_color_tables_t *color_tab,
                     *((uint8_t *)tmptrg) = (uint8_t)colortab[*tmpsrc++];
                     tmptrg = (uint16_t *)(((uint8_t *)tmptrg) + 1);
                 }
-                for (x = 0; x < wstart; x++) {
-                    *tmptrg++ = (uint16_t)colortab[*tmpsrc++];
-                }
-                for (x = 0; x < wfast; x++) {
-                    tmptrg[0] = (uint16_t)colortab[tmpsrc[0]];
-                    tmptrg[1] = (uint16_t)colortab[tmpsrc[1]];
-                    tmptrg[2] = (uint16_t)colortab[tmpsrc[2]];
-                    tmptrg[3] = (uint16_t)colortab[tmpsrc[3]];
-                    tmptrg[4] = (uint16_t)colortab[tmpsrc[4]];
-                    tmptrg[5] = (uint16_t)colortab[tmpsrc[5]];
-                    tmptrg[6] = (uint16_t)colortab[tmpsrc[6]];
-                    tmptrg[7] = (uint16_t)colortab[tmpsrc[7]];
-                    tmpsrc += 8;
-                    tmptrg += 8;
-                }
-                for (x = 0; x < wend; x++) {
-                    *tmptrg++ = (uint16_t)colortab[*tmpsrc++];
-                }
+                render_expand_16(colortab, tmpsrc, (uint8_t *)tmptrg, width);
+                tmpsrc += width;
+                tmptrg += width;
                 if (wlast) {
                     *((uint8_t *)tmptrg) = (uint8_t)colortab[*tmpsrc];
                     tmptrg = (uint16_t *)(((uint8_t *)tmptrg) + 1);
@@ -125,7 +101,7 @@ void render_16_2x4_04(const video_render_color_tables_t *color_tab,
 
     src = src + pitchs * ys + xs;
     trg = trg + pitcht * yt + (xt << 1);
-    yys = (ys << 1) | (yt & 1);
+    yys = (ys << 2) | (yt & 1);
     wfirst = xt & 1;
     width -= wfirst;
     wlast = width & 1;
@@ -151,24 +127,9 @@ void render_16_2x4_04(const video_render_color_tables_t *color_tab,
                     *((uint16_t *)tmptrg) = (uint16_t)colortab[*tmpsrc++];
                     tmptrg = (uint32_t *)(((uint16_t *)tmptrg) + 1);
                 }
-                for (x = 0; x < wstart; x++) {
-                    *tmptrg++ = colortab[*tmpsrc++];
-                }
-                for (x = 0; x < wfast; x++) {
-                    tmptrg[0] = colortab[tmpsrc[0]];
-                    tmptrg[1] = colortab[tmpsrc[1]];
-                    tmptrg[2] = colortab[tmpsrc[2]];
-                    tmptrg[3] = colortab[tmpsrc[3]];
-                    tmptrg[4] = colortab[tmpsrc[4]];
-                    tmptrg[5] = colortab[tmpsrc[5]];
-                    tmptrg[6] = colortab[tmpsrc[6]];
-                    tmptrg[7] = colortab[tmpsrc[7]];
-                    tmpsrc += 8;
-                    tmptrg += 8;
-                }
-                for (x = 0; x < wend; x++) {
-                    *tmptrg++ = colortab[*tmpsrc++];
-                }
+                render_expand_32(colortab, tmpsrc, (uint8_t *)tmptrg, width);
+                tmpsrc += width;
+                tmptrg += width;
                 if (wlast) {
                     *((uint16_t *)tmptrg) = (uint16_t)colortab[*tmpsrc];
                 }
@@ -229,7 +190,7 @@ void render_24_2x4_04(const video_render_color_tables_t *color_tab,
 
     src = src + pitchs * ys + xs;
     trg = trg + pitcht * yt + (xt * 3);
-    yys = (ys << 1) | (yt & 1);
+    yys = (ys << 2) | (yt & 1);
     wlast = width & 1;
     width >>= 1;
     for (y = yys; y < (yys + height); y++) {
@@ -239,16 +200,9 @@ void render_24_2x4_04(const video_render_color_tables_t *color_tab,
             if ((y & 3) && readable && y > yys) { /* copy previous line */
                 memcpy(trg, trg - pitcht, ((width << 1) + wlast) * 3);
             } else {
-                for (x = 0; x < width; x++) {
-                    color = colortab[*tmpsrc++];
-                    tcolor = color;
-                    tmptrg[3] = tmptrg[0] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[4] = tmptrg[1] = (uint8_t)color;
-                    color >>= 8;
-                    tmptrg[5] = tmptrg[2] = (uint8_t)color;
-                    tmptrg += 6;
-                }
+                render_expand_24_2x(colortab, tmpsrc, tmptrg, width);
+                tmpsrc += width;
+                tmptrg += width * 6;
                 if (wlast) {
                     color = colortab[*tmpsrc];
                     tmptrg[0] = (uint8_t)color;
@@ -305,7 +259,7 @@ void render_32_2x4_04(const video_render_color_tables_t *color_tab,
 
     src = src + pitchs * ys + xs;
     trg = trg + pitcht * yt + (xt << 2);
-    yys = (ys << 1) | (yt & 1);
+    yys = (ys << 2) | (yt & 1);
     wfirst = xt & 1;
     width -= wfirst;
     wlast = width & 1;
@@ -330,44 +284,9 @@ void render_32_2x4_04(const video_render_color_tables_t *color_tab,
                 if (wfirst) {
                     *tmptrg++ = colortab[*tmpsrc++];
                 }
-                for (x = 0; x < wstart; x++) {
-                    color = colortab[*tmpsrc++];
-                    *tmptrg++ = color;
-                    *tmptrg++ = color;
-                }
-                for (x = 0; x < wfast; x++) {
-                    color = colortab[tmpsrc[0]];
-                    tmptrg[0] = color;
-                    tmptrg[1] = color;
-                    color = colortab[tmpsrc[1]];
-                    tmptrg[2] = color;
-                    tmptrg[3] = color;
-                    color = colortab[tmpsrc[2]];
-                    tmptrg[4] = color;
-                    tmptrg[5] = color;
-                    color = colortab[tmpsrc[3]];
-                    tmptrg[6] = color;
-                    tmptrg[7] = color;
-                    color = colortab[tmpsrc[4]];
-                    tmptrg[8] = color;
-                    tmptrg[9] = color;
-                    color = colortab[tmpsrc[5]];
-                    tmptrg[10] = color;
-                    tmptrg[11] = color;
-                    color = colortab[tmpsrc[6]];
-                    tmptrg[12] = color;
-                    tmptrg[13] = color;
-                    color = colortab[tmpsrc[7]];
-                    tmptrg[14] = color;
-                    tmptrg[15] = color;
-                    tmpsrc += 8;
-                    tmptrg += 16;
-                }
-                for (x = 0; x < wend; x++) {
-                    color = colortab[*tmpsrc++];
-                    *tmptrg++ = color;
-                    *tmptrg++ = color;
-                }
+                render_expand_32_2x(colortab, tmpsrc, (uint8_t *)tmptrg, width);
+                tmpsrc += width;
+                tmptrg += width << 1;
                 if (wlast) {
                     *tmptrg = colortab[*tmpsrc];
                 }
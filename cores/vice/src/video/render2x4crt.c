@@ -31,6 +31,7 @@
 
 #include "render2x4.h"
 #include "render2x4crt.h"
+#include "rendersimd.h"
 #include "types.h"
 #include "video-color.h"
 
@@ -278,7 +279,8 @@ void render_generic_2x4_crt(video_render_color_tables_t *color_tab,
                                 uint8_t *const line, uint8_t *const scanline,
                                 int16_t *const prevline, const int shade,
                                 int32_t l, int32_t u, int32_t v),
-                            const int write_interpolated_pixels, video_render_config_t *config)
+                            const int write_interpolated_pixels, const int yuv_lines,
+                            video_render_config_t *config)
 {
     int16_t *prevrgblineptr;
     const int32_t *ytablel = color_tab->ytablel;
@@ -289,10 +291,11 @@ void render_generic_2x4_crt(video_render_color_tables_t *color_tab,
     int32_t *cbtable, *crtable;
     uint32_t x, y, wfirst, wlast, yys;
     int32_t l, l2, u, u2, unew, v, v2, vnew, off_flip, shade;
+    render_yuv_line_t yuv_line;
 
     src = src + pitchs * ys + xs - 2;
     trg = trg + pitcht * yt + xt * pixelstride;
-    yys = (ys << 1) | (yt & 1);
+    yys = (ys << 2) | (yt & 1);
     wfirst = xt & 1;
     width -= wfirst;
     wlast = width & 1;
@@ -307,6 +310,10 @@ void render_generic_2x4_crt(video_render_color_tables_t *color_tab,
 
     /* Calculate odd line shading */
     shade = (int) ((float) config->video_resources.pal_scanlineshade / 1000.0f * 256.f);
+
+    yuv_line.line = NULL;
+    yuv_line.interpolate = 1;
+
     off_flip = 1 << 6;
 
     /* height & 1 == 0. */
@@ -359,6 +366,20 @@ void render_generic_2x4_crt(video_render_color_tables_t *color_tab,
         cbtable = write_interpolated_pixels ? color_tab->cbtable : color_tab->cutable;
         crtable = write_interpolated_pixels ? color_tab->crtable : color_tab->cvtable;
 
+        if (yuv_lines) {
+            yuv_line.ycbcrtable = color_tab->ycbcrtable;
+            yuv_line.off_flip = off_flip;
+            yuv_line.trg = (uint32_t *)tmptrg1;
+            yuv_line.trg2 = (uint32_t *)tmptrg2;
+            yuv_line.scanline = (uint32_t *)tmptrgscanline1;
+            yuv_line.scanline2 = (uint32_t *)tmptrgscanline2;
+            yuv_line.prevline = &color_tab->prevrgbline[0];
+            render_yuv_line_32(&yuv_line, src, wfirst, wfirst + width * 2 + wlast);
+            src += pitchs;
+            trg += pitcht * 4;
+            continue;
+        }
+
         l = ytablel[tmpsrc[1]] + ytableh[tmpsrc[2]] + ytablel[tmpsrc[3]];
         unew = cbtable[tmpsrc[0]] + cbtable[tmpsrc[1]] + cbtable[tmpsrc[2]] + cbtable[tmpsrc[3]];
         vnew = crtable[tmpsrc[0]] + crtable[tmpsrc[1]] + crtable[tmpsrc[2]] + crtable[tmpsrc[3]];
@@ -443,7 +464,7 @@ void render_UYVY_2x4_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_2x4_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_UYVY, 0, config);
+                           4, store_line_and_scanline_UYVY, 0, 0, config);
 }
 
 void render_YUY2_2x4_crt(video_render_color_tables_t *color_tab,
@@ -456,7 +477,7 @@ void render_YUY2_2x4_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_2x4_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_YUY2, 0, config);
+                           4, store_line_and_scanline_YUY2, 0, 0, config);
 }
 
 void render_YVYU_2x4_crt(video_render_color_tables_t *color_tab,
@@ -469,7 +490,7 @@ void render_YVYU_2x4_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_2x4_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_YVYU, 0, config);
+                           4, store_line_and_scanline_YVYU, 0, 0, config);
 }
 
 void render_16_2x4_crt(video_render_color_tables_t *color_tab,
@@ -482,7 +503,7 @@ void render_16_2x4_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_2x4_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           2, store_line_and_scanline_2, 1, config);
+                           2, store_line_and_scanline_2, 1, 0, config);
 }
 
 void render_24_2x4_crt(video_render_color_tables_t *color_tab,
@@ -495,7 +516,7 @@ void render_24_2x4_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_2x4_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           3, store_line_and_scanline_3, 1, config);
+                           3, store_line_and_scanline_3, 1, 0, config);
 }
 
 void render_32_2x4_crt(video_render_color_tables_t *color_tab,
@@ -508,5 +529,5 @@ void render_32_2x4_crt(video_render_color_tables_t *color_tab,
 {
     render_generic_2x4_crt(color_tab, src, trg, width, height, xs, ys,
                            xt, yt, pitchs, pitcht, viewport,
-                           4, store_line_and_scanline_4, 1, config);
+                           4, store_line_and_scanline_4, 1, render_yuv_simd, config);
 }
@@ -0,0 +1,988 @@
+/*
+ * rendersimd.c - Palette expansion for the framebuffer renderers
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* The 1x1, 1x2, 2x2 and 2x4 renderers spend their time looking up palette
+   indices.  Most chips use only 16 colours, and a 16 entry table fits in
+   one vector register per colour byte, so the SIMD versions look up 16
+   pixels with one byte shuffle per colour byte and store the bytes
+   interleaved.  Blocks with an index above 15 (TED, 256 colour modes) are
+   looked up one by one, so the output never differs from the plain C
+   version.
+
+   The PAL and CRT renderers look up the packed YCbCr table entries of four
+   source pixels at a time, then do the blur, chroma and delay line sums
+   and the YUV to RGB conversion four pixels at a time; only the gamma
+   tables are looked up per pixel.  The integer arithmetic is the same as
+   in the per pixel renderers.  */
+
+#include "vice.h"
+
+#include <string.h>
+
+#include "rendersimd.h"
+#include "types.h"
+#include "video-color.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RENDER_HAVE_SSSE3 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(__AARCH64EB__)
+#define RENDER_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+
+/* Plain C versions */
+
+static void expand_08_c(const uint32_t *colortab, const uint8_t *src,
+                        uint8_t *trg, unsigned int n)
+{
+    unsigned int x;
+
+    for (x = 0; x < n; x++) {
+        trg[x] = (uint8_t)colortab[src[x]];
+    }
+}
+
+static void expand_16_c(const uint32_t *colortab, const uint8_t *src,
+                        uint8_t *trg, unsigned int n)
+{
+    uint16_t *tmptrg = (uint16_t *)trg;
+    unsigned int x;
+
+    for (x = 0; x < n; x++) {
+        tmptrg[x] = (uint16_t)colortab[src[x]];
+    }
+}
+
+static void expand_24_c(const uint32_t *colortab, const uint8_t *src,
+                        uint8_t *trg, unsigned int n)
+{
+    register uint32_t color;
+    unsigned int x;
+
+    for (x = 0; x < n; x++) {
+        color = colortab[src[x]];
+        trg[0] = (uint8_t)color;
+        color >>= 8;
+        trg[1] = (uint8_t)color;
+        color >>= 8;
+        trg[2] = (uint8_t)color;
+        trg += 3;
+    }
+}
+
+static void expand_32_c(const uint32_t *colortab, const uint8_t *src,
+                        uint8_t *trg, unsigned int n)
+{
+    uint32_t *tmptrg = (uint32_t *)trg;
+    unsigned int x;
+
+    for (x = 0; x < n; x++) {
+        tmptrg[x] = colortab[src[x]];
+    }
+}
+
+static void expand_24_2x_c(const uint32_t *colortab, const uint8_t *src,
+                           uint8_t *trg, unsigned int n)
+{
+    register uint32_t color;
+    unsigned int x;
+
+    for (x = 0; x < n; x++) {
+        color = colortab[src[x]];
+        trg[3] = trg[0] = (uint8_t)color;
+        color >>= 8;
+        trg[4] = trg[1] = (uint8_t)color;
+        color >>= 8;
+        trg[5] = trg[2] = (uint8_t)color;
+        trg += 6;
+    }
+}
+
+static void expand_32_2x_c(const uint32_t *colortab, const uint8_t *src,
+                           uint8_t *trg, unsigned int n)
+{
+    uint32_t *tmptrg = (uint32_t *)trg;
+    register uint32_t color;
+    unsigned int x;
+
+    for (x = 0; x < n; x++) {
+        color = colortab[src[x]];
+        tmptrg[0] = color;
+        tmptrg[1] = color;
+        tmptrg += 2;
+    }
+}
+
+
+
+/* Where render_yuv_line_32() stores its pixels.  */
+typedef struct yuv_out_s {
+    uint32_t *trg;
+    uint32_t *trg2;
+    uint32_t *scanline;
+    uint32_t *scanline2;
+    int16_t *prevline;
+    unsigned int skip;  /* pixels left of `first' still to drop */
+    unsigned int left;  /* pixels still to store */
+} yuv_out_t;
+
+/* Return the number of source pixels needed for pixels `first' to
+   `first' + `n' - 1, the same the per pixel renderers convert.  */
+static unsigned int yuv_out_init(yuv_out_t *o, const render_yuv_line_t *l,
+                                 unsigned int first, unsigned int n)
+{
+    o->trg = l->trg;
+    o->trg2 = l->trg2;
+    o->scanline = l->scanline;
+    o->scanline2 = l->scanline2;
+    o->prevline = l->prevline;
+    o->skip = first;
+    o->left = n;
+    return l->interpolate ? ((first + n) >> 1) + 1 : first + n;
+}
+
+/* Store pixels `i' to `count' - 1 of a block, with red + 256 in rgb[0..7],
+   green + 256 in rgb[8..15] and blue + 256 in rgb[16..23], which index the
+   gamma tables directly.  */
+static inline void yuv_out_block(yuv_out_t *o, const uint32_t *rgb, unsigned int i,
+                                 unsigned int count)
+{
+    uint32_t *trg, *trg2, *scanline, *scanline2;
+    int16_t *prevline;
+    uint32_t red, grn, blu, color;
+
+    for (; i < count && o->skip > 0; i++) {
+        o->skip--;
+    }
+    if (count - i > o->left) {
+        count = i + o->left;
+    }
+    o->left -= count - i;
+
+    trg = o->trg;
+    trg2 = o->trg2;
+    scanline = o->scanline;
+    scanline2 = o->scanline2;
+    prevline = o->prevline;
+    for (; i < count; i++) {
+        red = rgb[i];
+        grn = rgb[i + 8];
+        blu = rgb[i + 16];
+        if (scanline != NULL) {
+            *scanline++ = gamma_red_fac[256 + red + prevline[0]]
+                          | gamma_grn_fac[256 + grn + prevline[1]]
+                          | gamma_blu_fac[256 + blu + prevline[2]]
+                          | alpha;
+            if (scanline2 != NULL) {
+                *scanline2++ = gamma_red_fac[red + red]
+                               | gamma_grn_fac[grn + grn]
+                               | gamma_blu_fac[blu + blu]
+                               | alpha;
+            }
+            prevline[0] = (int16_t)(red - 256);
+            prevline[1] = (int16_t)(grn - 256);
+            prevline[2] = (int16_t)(blu - 256);
+            prevline += 3;
+        }
+        color = gamma_red[red] | gamma_grn[grn] | gamma_blu[blu] | alpha;
+        *trg++ = color;
+        if (trg2 != NULL) {
+            *trg2++ = color;
+        }
+    }
+    o->trg = trg;
+    o->trg2 = trg2;
+    o->scanline = scanline;
+    o->scanline2 = scanline2;
+    o->prevline = prevline;
+}
+
+static void yuv_out(yuv_out_t *o, int32_t y, int32_t u, int32_t v)
+{
+    uint32_t rgb[24];
+
+    rgb[0] = (uint32_t)(((y + v) >> 16) + 256);
+    rgb[8] = (uint32_t)(((y - ((50 * u + 130 * v) >> 8)) >> 16) + 256);
+    rgb[16] = (uint32_t)(((y + u) >> 16) + 256);
+    yuv_out_block(o, rgb, 0, 1);
+}
+
+/* Convert source pixels `x' to `positions' - 1 one by one; `prev' holds
+   the YUV of the pixel before `x'.  */
+static void yuv_line_tail(const render_yuv_line_t *l, const uint8_t *src,
+                          yuv_out_t *o, unsigned int x, unsigned int positions,
+                          int32_t prev[3])
+{
+    const int32_t *t0, *t1, *t2, *t3;
+    int32_t y, u, v, unew, vnew;
+
+    for (; x < positions; x++) {
+        t0 = l->ycbcrtable + src[x] * 4;
+        t1 = l->ycbcrtable + src[x + 1] * 4;
+        t2 = l->ycbcrtable + src[x + 2] * 4;
+        t3 = l->ycbcrtable + src[x + 3] * 4;
+        y = t1[0] + t2[1] + t3[0];
+        unew = t0[2] + t1[2] + t2[2] + t3[2];
+        vnew = t0[3] + t1[3] + t2[3] + t3[3];
+        if (l->line != NULL) {
+            u = (unew + l->line[x * 2]) * l->off_flip;
+            v = (vnew + l->line[x * 2 + 1]) * l->off_flip;
+            l->line[x * 2] = unew;
+            l->line[x * 2 + 1] = vnew;
+        } else {
+            u = unew * l->off_flip;
+            v = vnew * l->off_flip;
+        }
+        if (l->interpolate && x > 0) {
+            yuv_out(o, (prev[0] + y) >> 1, (prev[1] + u) >> 1, (prev[2] + v) >> 1);
+        }
+        yuv_out(o, y, u, v);
+        prev[0] = y;
+        prev[1] = u;
+        prev[2] = v;
+    }
+}
+
+static void yuv_line_c(const render_yuv_line_t *l, const uint8_t *src,
+                       unsigned int first, unsigned int n)
+{
+    yuv_out_t o;
+    int32_t prev[3];
+
+    yuv_line_tail(l, src, &o, 0, yuv_out_init(&o, l, first, n), prev);
+}
+
+
+/* SSSE3 versions */
+
+#ifdef RENDER_HAVE_SSSE3
+
+/* Return how many pixels of `size' bytes to store one by one until `trg' is
+   aligned to `align' bytes; the stores of the SIMD loops are aligned then.  */
+static unsigned int align_head(const uint8_t *trg, unsigned int size,
+                               unsigned int align, unsigned int n)
+{
+    unsigned int head;
+
+    for (head = 0; head < align && head < n; head++) {
+        if (((vice_ptr_to_uint(trg) + head * size) & (align - 1)) == 0) {
+            return head;
+        }
+    }
+    return 0;
+}
+
+/* Split the first 16 colours into one vector per colour byte.  */
+__attribute__((target("ssse3")))
+static void planes_ssse3(const uint32_t *colortab, __m128i planes[4])
+{
+    const __m128i split = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13,
+                                        2, 6, 10, 14, 3, 7, 11, 15);
+    __m128i t0, t1, t2, t3, a, b, c, d;
+
+    t0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)colortab), split);
+    t1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(colortab + 4)), split);
+    t2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(colortab + 8)), split);
+    t3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(colortab + 12)), split);
+    a = _mm_unpacklo_epi32(t0, t1);
+    b = _mm_unpacklo_epi32(t2, t3);
+    c = _mm_unpackhi_epi32(t0, t1);
+    d = _mm_unpackhi_epi32(t2, t3);
+    planes[0] = _mm_unpacklo_epi64(a, b);
+    planes[1] = _mm_unpackhi_epi64(a, b);
+    planes[2] = _mm_unpacklo_epi64(c, d);
+    planes[3] = _mm_unpackhi_epi64(c, d);
+}
+
+/* Load 16 indices; return zero if any of them is above 15.  */
+__attribute__((target("ssse3")))
+static int load_ssse3(const uint8_t *src, __m128i *idx)
+{
+    *idx = _mm_loadu_si128((const __m128i *)src);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(*idx, _mm_set1_epi8((char)0xf0)),
+                                            _mm_setzero_si128())) == 0xffff;
+}
+
+/* Look up 16 indices as four vectors of four 32 bit colours.  */
+__attribute__((target("ssse3")))
+static void lookup_32_ssse3(const __m128i planes[4], __m128i idx, __m128i px[4])
+{
+    __m128i b0 = _mm_shuffle_epi8(planes[0], idx);
+    __m128i b1 = _mm_shuffle_epi8(planes[1], idx);
+    __m128i b2 = _mm_shuffle_epi8(planes[2], idx);
+    __m128i b3 = _mm_shuffle_epi8(planes[3], idx);
+    __m128i lo01 = _mm_unpacklo_epi8(b0, b1);
+    __m128i hi01 = _mm_unpackhi_epi8(b0, b1);
+    __m128i lo23 = _mm_unpacklo_epi8(b2, b3);
+    __m128i hi23 = _mm_unpackhi_epi8(b2, b3);
+
+    px[0] = _mm_unpacklo_epi16(lo01, lo23);
+    px[1] = _mm_unpackhi_epi16(lo01, lo23);
+    px[2] = _mm_unpacklo_epi16(hi01, hi23);
+    px[3] = _mm_unpackhi_epi16(hi01, hi23);
+}
+
+/* Store four vectors of four 32 bit colours as 48 bytes of 24 bit ones.  */
+__attribute__((target("ssse3")))
+static void store_24_ssse3(uint8_t *trg, const __m128i px[4])
+{
+    const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                       -1, -1, -1, -1);
+    __m128i s0 = _mm_shuffle_epi8(px[0], pack);
+    __m128i s1 = _mm_shuffle_epi8(px[1], pack);
+    __m128i s2 = _mm_shuffle_epi8(px[2], pack);
+    __m128i s3 = _mm_shuffle_epi8(px[3], pack);
+
+    _mm_storeu_si128((__m128i *)trg, _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+    _mm_storeu_si128((__m128i *)(trg + 16),
+                     _mm_or_si128(_mm_srli_si128(s1, 4), _mm_slli_si128(s2, 8)));
+    _mm_storeu_si128((__m128i *)(trg + 32),
+                     _mm_or_si128(_mm_srli_si128(s2, 8), _mm_slli_si128(s3, 4)));
+}
+
+__attribute__((target("ssse3")))
+static void expand_08_ssse3(const uint32_t *colortab, const uint8_t *src,
+                            uint8_t *trg, unsigned int n)
+{
+    __m128i planes[4], idx;
+    unsigned int x = 0;
+
+    if (n >= 16) {
+        x = align_head(trg, 1, 16, n);
+        expand_08_c(colortab, src, trg, x);
+        planes_ssse3(colortab, planes);
+        for (; x + 16 <= n; x += 16) {
+            if (load_ssse3(src + x, &idx)) {
+                _mm_storeu_si128((__m128i *)(trg + x), _mm_shuffle_epi8(planes[0], idx));
+            } else {
+                expand_08_c(colortab, src + x, trg + x, 16);
+            }
+        }
+    }
+    expand_08_c(colortab, src + x, trg + x, n - x);
+}
+
+__attribute__((target("ssse3")))
+static void expand_16_ssse3(const uint32_t *colortab, const uint8_t *src,
+                            uint8_t *trg, unsigned int n)
+{
+    __m128i planes[4], idx, b0, b1;
+    unsigned int x = 0;
+
+    if (n >= 16) {
+        x = align_head(trg, 2, 16, n);
+        expand_16_c(colortab, src, trg, x);
+        planes_ssse3(colortab, planes);
+        for (; x + 16 <= n; x += 16) {
+            if (load_ssse3(src + x, &idx)) {
+                b0 = _mm_shuffle_epi8(planes[0], idx);
+                b1 = _mm_shuffle_epi8(planes[1], idx);
+                _mm_storeu_si128((__m128i *)(trg + x * 2), _mm_unpacklo_epi8(b0, b1));
+                _mm_storeu_si128((__m128i *)(trg + x * 2 + 16), _mm_unpackhi_epi8(b0, b1));
+            } else {
+                expand_16_c(colortab, src + x, trg + x * 2, 16);
+            }
+        }
+    }
+    expand_16_c(colortab, src + x, trg + x * 2, n - x);
+}
+
+__attribute__((target("ssse3")))
+static void expand_24_ssse3(const uint32_t *colortab, const uint8_t *src,
+                            uint8_t *trg, unsigned int n)
+{
+    __m128i planes[4], idx, px[4];
+    unsigned int x = 0;
+
+    if (n >= 16) {
+        x = align_head(trg, 3, 16, n);
+        expand_24_c(colortab, src, trg, x);
+        planes_ssse3(colortab, planes);
+        for (; x + 16 <= n; x += 16) {
+            if (load_ssse3(src + x, &idx)) {
+                lookup_32_ssse3(planes, idx, px);
+                store_24_ssse3(trg + x * 3, px);
+            } else {
+                expand_24_c(colortab, src + x, trg + x * 3, 16);
+            }
+        }
+    }
+    expand_24_c(colortab, src + x, trg + x * 3, n - x);
+}
+
+__attribute__((target("ssse3")))
+static void expand_32_ssse3(const uint32_t *colortab, const uint8_t *src,
+                            uint8_t *trg, unsigned int n)
+{
+    __m128i planes[4], idx, px[4];
+    unsigned int x = 0;
+    int i;
+
+    if (n >= 16) {
+        x = align_head(trg, 4, 16, n);
+        expand_32_c(colortab, src, trg, x);
+        planes_ssse3(colortab, planes);
+        for (; x + 16 <= n; x += 16) {
+            if (load_ssse3(src + x, &idx)) {
+                lookup_32_ssse3(planes, idx, px);
+                for (i = 0; i < 4; i++) {
+                    _mm_storeu_si128((__m128i *)(trg + x * 4 + i * 16), px[i]);
+                }
+            } else {
+                expand_32_c(colortab, src + x, trg + x * 4, 16);
+            }
+        }
+    }
+    expand_32_c(colortab, src + x, trg + x * 4, n - x);
+}
+
+__attribute__((target("ssse3")))
+static void expand_24_2x_ssse3(const uint32_t *colortab, const uint8_t *src,
+                               uint8_t *trg, unsigned int n)
+{
+    __m128i planes[4], idx, px[4], dup[4];
+    unsigned int x = 0;
+
+    if (n >= 16) {
+        x = align_head(trg, 6, 16, n);
+        expand_24_2x_c(colortab, src, trg, x);
+        planes_ssse3(colortab, planes);
+        for (; x + 16 <= n; x += 16) {
+            if (load_ssse3(src + x, &idx)) {
+                lookup_32_ssse3(planes, idx, px);
+                dup[0] = _mm_unpacklo_epi32(px[0], px[0]);
+                dup[1] = _mm_unpackhi_epi32(px[0], px[0]);
+                dup[2] = _mm_unpacklo_epi32(px[1], px[1]);
+                dup[3] = _mm_unpackhi_epi32(px[1], px[1]);
+                store_24_ssse3(trg + x * 6, dup);
+                dup[0] = _mm_unpacklo_epi32(px[2], px[2]);
+                dup[1] = _mm_unpackhi_epi32(px[2], px[2]);
+                dup[2] = _mm_unpacklo_epi32(px[3], px[3]);
+                dup[3] = _mm_unpackhi_epi32(px[3], px[3]);
+                store_24_ssse3(trg + x * 6 + 48, dup);
+            } else {
+                expand_24_2x_c(colortab, src + x, trg + x * 6, 16);
+            }
+        }
+    }
+    expand_24_2x_c(colortab, src + x, trg + x * 6, n - x);
+}
+
+__attribute__((target("ssse3")))
+static void expand_32_2x_ssse3(const uint32_t *colortab, const uint8_t *src,
+                               uint8_t *trg, unsigned int n)
+{
+    __m128i planes[4], idx, px[4];
+    unsigned int x = 0;
+    int i;
+
+    if (n >= 16) {
+        x = align_head(trg, 8, 16, n);
+        expand_32_2x_c(colortab, src, trg, x);
+        planes_ssse3(colortab, planes);
+        for (; x + 16 <= n; x += 16) {
+            if (load_ssse3(src + x, &idx)) {
+                lookup_32_ssse3(planes, idx, px);
+                for (i = 0; i < 4; i++) {
+                    _mm_storeu_si128((__m128i *)(trg + x * 8 + i * 32),
+                                     _mm_unpacklo_epi32(px[i], px[i]));
+                    _mm_storeu_si128((__m128i *)(trg + x * 8 + i * 32 + 16),
+                                     _mm_unpackhi_epi32(px[i], px[i]));
+                }
+            } else {
+                expand_32_2x_c(colortab, src + x, trg + x * 8, 16);
+            }
+        }
+    }
+    expand_32_2x_c(colortab, src + x, trg + x * 8, n - x);
+}
+
+/* The low 32 bits of `a' times `off', which is between 0 and 65535 (the
+   renderers use at most 1 << 6); SSE2 has no 32 bit multiply.  The
+   low halves of `a' give the low and high 16 bits of their products, the
+   high halves only the low 16 bits.  */
+__attribute__((target("ssse3")))
+static inline __m128i mul_off_ssse3(__m128i a, __m128i off)
+{
+    return _mm_add_epi32(_mm_mullo_epi16(a, off),
+                         _mm_slli_epi32(_mm_mulhi_epu16(a, off), 16));
+}
+
+/* Look up the colours of four source pixels as vectors of ytablel,
+   ytableh, cbtable and crtable.  */
+__attribute__((target("ssse3")))
+static inline void ycbcr_ssse3(const int32_t *table, const uint8_t *src, __m128i t[4])
+{
+    __m128i a = _mm_loadu_si128((const __m128i *)(table + src[0] * 4));
+    __m128i b = _mm_loadu_si128((const __m128i *)(table + src[1] * 4));
+    __m128i c = _mm_loadu_si128((const __m128i *)(table + src[2] * 4));
+    __m128i d = _mm_loadu_si128((const __m128i *)(table + src[3] * 4));
+    __m128i lo01 = _mm_unpacklo_epi32(a, b);
+    __m128i lo23 = _mm_unpacklo_epi32(c, d);
+    __m128i hi01 = _mm_unpackhi_epi32(a, b);
+    __m128i hi23 = _mm_unpackhi_epi32(c, d);
+
+    t[0] = _mm_unpacklo_epi64(lo01, lo23);
+    t[1] = _mm_unpackhi_epi64(lo01, lo23);
+    t[2] = _mm_unpacklo_epi64(hi01, hi23);
+    t[3] = _mm_unpackhi_epi64(hi01, hi23);
+}
+
+/* Convert four pixels to red, green and blue, each + 256.  */
+__attribute__((target("ssse3")))
+static inline void yuv_rgb_ssse3(__m128i y, __m128i u, __m128i v, __m128i rgb[3])
+{
+    __m128i uv = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(u, 5), _mm_slli_epi32(u, 4)),
+                               _mm_add_epi32(_mm_slli_epi32(u, 1),
+                                             _mm_add_epi32(_mm_slli_epi32(v, 7), _mm_slli_epi32(v, 1))));
+
+    y = _mm_add_epi32(y, _mm_set1_epi32(256 << 16));
+    rgb[0] = _mm_srai_epi32(_mm_add_epi32(y, v), 16);
+    rgb[1] = _mm_srai_epi32(_mm_sub_epi32(y, _mm_srai_epi32(uv, 8)), 16);
+    rgb[2] = _mm_srai_epi32(_mm_add_epi32(y, u), 16);
+}
+
+__attribute__((target("ssse3")))
+static void yuv_line_ssse3(const render_yuv_line_t *l, const uint8_t *src,
+                           unsigned int first, unsigned int n)
+{
+    yuv_out_t o;
+    unsigned int positions = yuv_out_init(&o, l, first, n);
+    __m128i off = _mm_set1_epi16((int16_t)l->off_flip);
+    __m128i t0[4], t1[4], y, u, v, a, b, mid[3], cur[3];
+    __m128i py = _mm_setzero_si128();
+    __m128i pu = _mm_setzero_si128();
+    __m128i pv = _mm_setzero_si128();
+    uint32_t rgb[24];
+    int32_t prev[3];
+    unsigned int x, i;
+
+    /* Four source pixels at a time, using the colours of the next four
+       for the blur and the chroma sums; those are read up to three pixels
+       past the last source pixel, as the C version does.  */
+    ycbcr_ssse3(l->ycbcrtable, src, t0);
+    for (x = 0; x + 5 <= positions; x += 4) {
+        ycbcr_ssse3(l->ycbcrtable, src + x + 4, t1);
+        y = _mm_add_epi32(_mm_add_epi32(_mm_alignr_epi8(t1[0], t0[0], 4),
+                                        _mm_alignr_epi8(t1[1], t0[1], 8)),
+                          _mm_alignr_epi8(t1[0], t0[0], 12));
+        u = _mm_add_epi32(_mm_add_epi32(t0[2], _mm_alignr_epi8(t1[2], t0[2], 4)),
+                          _mm_add_epi32(_mm_alignr_epi8(t1[2], t0[2], 8),
+                                        _mm_alignr_epi8(t1[2], t0[2], 12)));
+        v = _mm_add_epi32(_mm_add_epi32(t0[3], _mm_alignr_epi8(t1[3], t0[3], 4)),
+                          _mm_add_epi32(_mm_alignr_epi8(t1[3], t0[3], 8),
+                                        _mm_alignr_epi8(t1[3], t0[3], 12)));
+        if (l->line != NULL) {
+            /* the delay line holds u and v interleaved */
+            a = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(l->line + x * 2)), _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(l->line + x * 2 + 4)), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128((__m128i *)(l->line + x * 2), _mm_unpacklo_epi32(u, v));
+            _mm_storeu_si128((__m128i *)(l->line + x * 2 + 4), _mm_unpackhi_epi32(u, v));
+            u = _mm_add_epi32(u, _mm_unpacklo_epi64(a, b));
+            v = _mm_add_epi32(v, _mm_unpackhi_epi64(a, b));
+        }
+        u = mul_off_ssse3(u, off);
+        v = mul_off_ssse3(v, off);
+
+        if (l->interpolate) {
+            /* the pixels between x - 1 and x + 3, then x to x + 3 */
+            yuv_rgb_ssse3(_mm_srai_epi32(_mm_add_epi32(_mm_alignr_epi8(y, py, 12), y), 1),
+                          _mm_srai_epi32(_mm_add_epi32(_mm_alignr_epi8(u, pu, 12), u), 1),
+                          _mm_srai_epi32(_mm_add_epi32(_mm_alignr_epi8(v, pv, 12), v), 1), mid);
+            yuv_rgb_ssse3(y, u, v, cur);
+            for (i = 0; i < 3; i++) {
+                _mm_storeu_si128((__m128i *)(rgb + i * 8), _mm_unpacklo_epi32(mid[i], cur[i]));
+                _mm_storeu_si128((__m128i *)(rgb + i * 8 + 4), _mm_unpackhi_epi32(mid[i], cur[i]));
+            }
+            yuv_out_block(&o, rgb, x == 0, 8);
+        } else {
+            yuv_rgb_ssse3(y, u, v, cur);
+            for (i = 0; i < 3; i++) {
+                _mm_storeu_si128((__m128i *)(rgb + i * 8), cur[i]);
+            }
+            yuv_out_block(&o, rgb, 0, 4);
+        }
+        py = y;
+        pu = u;
+        pv = v;
+        memcpy(t0, t1, sizeof(t0));
+    }
+    prev[0] = _mm_cvtsi128_si32(_mm_shuffle_epi32(py, _MM_SHUFFLE(3, 3, 3, 3)));
+    prev[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(pu, _MM_SHUFFLE(3, 3, 3, 3)));
+    prev[2] = _mm_cvtsi128_si32(_mm_shuffle_epi32(pv, _MM_SHUFFLE(3, 3, 3, 3)));
+    yuv_line_tail(l, src, &o, x, positions, prev);
+}
+
+#endif
+
+
+/* NEON versions */
+
+#ifdef RENDER_HAVE_NEON
+
+/* Load 16 indices; return zero if any of them is above 15.  */
+static int load_neon(const uint8_t *src, uint8x16_t *idx)
+{
+    *idx = vld1q_u8(src);
+    return vmaxvq_u8(*idx) < 16;
+}
+
+static void expand_08_neon(const uint32_t *colortab, const uint8_t *src,
+                           uint8_t *trg, unsigned int n)
+{
+    uint8x16x4_t planes;
+    uint8x16_t idx;
+    unsigned int x = 0;
+
+    if (n >= 16) {
+        planes = vld4q_u8((const uint8_t *)colortab);
+        for (; x + 16 <= n; x += 16) {
+            if (load_neon(src + x, &idx)) {
+                vst1q_u8(trg + x, vqtbl1q_u8(planes.val[0], idx));
+            } else {
+                expand_08_c(colortab, src + x, trg + x, 16);
+            }
+        }
+    }
+    expand_08_c(colortab, src + x, trg + x, n - x);
+}
+
+static void expand_16_neon(const uint32_t *colortab, const uint8_t *src,
+                           uint8_t *trg, unsigned int n)
+{
+    uint8x16x4_t planes;
+    uint8x16x2_t out;
+    uint8x16_t idx;
+    unsigned int x = 0;
+
+    if (n >= 16) {
+        planes = vld4q_u8((const uint8_t *)colortab);
+        for (; x + 16 <= n; x += 16) {
+            if (load_neon(src + x, &idx)) {
+                out.val[0] = vqtbl1q_u8(planes.val[0], idx);
+                out.val[1] = vqtbl1q_u8(planes.val[1], idx);
+                vst2q_u8(trg + x * 2, out);
+            } else {
+                expand_16_c(colortab, src + x, trg + x * 2, 16);
+            }
+        }
+    }
+    expand_16_c(colortab, src + x, trg + x * 2, n - x);
+}
+
+static void expand_24_neon(const uint32_t *colortab, const uint8_t *src,
+                           uint8_t *trg, unsigned int n)
+{
+    uint8x16x4_t planes;
+    uint8x16x3_t out;
+    uint8x16_t idx;
+    unsigned int x = 0;
+
+    if (n >= 16) {
+        planes = vld4q_u8((const uint8_t *)colortab);
+        for (; x + 16 <= n; x += 16) {
+            if (load_neon(src + x, &idx)) {
+                out.val[0] = vqtbl1q_u8(planes.val[0], idx);
+                out.val[1] = vqtbl1q_u8(planes.val[1], idx);
+                out.val[2] = vqtbl1q_u8(planes.val[2], idx);
+                vst3q_u8(trg + x * 3, out);
+            } else {
+                expand_24_c(colortab, src + x, trg + x * 3, 16);
+            }
+        }
+    }
+    expand_24_c(colortab, src + x, trg + x * 3, n - x);
+}
+
+static void expand_32_neon(const uint32_t *colortab, const uint8_t *src,
+                           uint8_t *trg, unsigned int n)
+{
+    uint8x16x4_t planes, out;
+    uint8x16_t idx;
+    unsigned int x = 0;
+    int i;
+
+    if (n >= 16) {
+        planes = vld4q_u8((const uint8_t *)colortab);
+        for (; x + 16 <= n; x += 16) {
+            if (load_neon(src + x, &idx)) {
+                for (i = 0; i < 4; i++) {
+                    out.val[i] = vqtbl1q_u8(planes.val[i], idx);
+                }
+                vst4q_u8(trg + x * 4, out);
+            } else {
+                expand_32_c(colortab, src + x, trg + x * 4, 16);
+            }
+        }
+    }
+    expand_32_c(colortab, src + x, trg + x * 4, n - x);
+}
+
+/* The indices are doubled before the lookup, which doubles the pixels.  */
+static void expand_24_2x_neon(const uint32_t *colortab, const uint8_t *src,
+                              uint8_t *trg, unsigned int n)
+{
+    uint8x16x4_t planes;
+    uint8x16x3_t out;
+    uint8x16x2_t dup;
+    uint8x16_t idx;
+    unsigned int x = 0;
+    int h, i;
+
+    if (n >= 16) {
+        planes = vld4q_u8((const uint8_t *)colortab);
+        for (; x + 16 <= n; x += 16) {
+            if (load_neon(src + x, &idx)) {
+                dup = vzipq_u8(idx, idx);
+                for (h = 0; h < 2; h++) {
+                    for (i = 0; i < 3; i++) {
+                        out.val[i] = vqtbl1q_u8(planes.val[i], dup.val[h]);
+                    }
+                    vst3q_u8(trg + x * 6 + h * 48, out);
+                }
+            } else {
+                expand_24_2x_c(colortab, src + x, trg + x * 6, 16);
+            }
+        }
+    }
+    expand_24_2x_c(colortab, src + x, trg + x * 6, n - x);
+}
+
+static void expand_32_2x_neon(const uint32_t *colortab, const uint8_t *src,
+                              uint8_t *trg, unsigned int n)
+{
+    uint8x16x4_t planes, out;
+    uint8x16x2_t dup;
+    uint8x16_t idx;
+    unsigned int x = 0;
+    int h, i;
+
+    if (n >= 16) {
+        planes = vld4q_u8((const uint8_t *)colortab);
+        for (; x + 16 <= n; x += 16) {
+            if (load_neon(src + x, &idx)) {
+                dup = vzipq_u8(idx, idx);
+                for (h = 0; h < 2; h++) {
+                    for (i = 0; i < 4; i++) {
+                        out.val[i] = vqtbl1q_u8(planes.val[i], dup.val[h]);
+                    }
+                    vst4q_u8(trg + x * 8 + h * 64, out);
+                }
+            } else {
+                expand_32_2x_c(colortab, src + x, trg + x * 8, 16);
+            }
+        }
+    }
+    expand_32_2x_c(colortab, src + x, trg + x * 8, n - x);
+}
+
+static inline void ycbcr_neon(const int32_t *table, const uint8_t *src, int32x4_t t[4])
+{
+    int32x4x2_t ab = vtrnq_s32(vld1q_s32(table + src[0] * 4), vld1q_s32(table + src[1] * 4));
+    int32x4x2_t cd = vtrnq_s32(vld1q_s32(table + src[2] * 4), vld1q_s32(table + src[3] * 4));
+
+    t[0] = vcombine_s32(vget_low_s32(ab.val[0]), vget_low_s32(cd.val[0]));
+    t[1] = vcombine_s32(vget_low_s32(ab.val[1]), vget_low_s32(cd.val[1]));
+    t[2] = vcombine_s32(vget_high_s32(ab.val[0]), vget_high_s32(cd.val[0]));
+    t[3] = vcombine_s32(vget_high_s32(ab.val[1]), vget_high_s32(cd.val[1]));
+}
+
+static inline void yuv_rgb_neon(int32x4_t y, int32x4_t u, int32x4_t v, int32x4_t rgb[3])
+{
+    int32x4_t uv = vmlaq_n_s32(vmulq_n_s32(u, 50), v, 130);
+
+    y = vaddq_s32(y, vdupq_n_s32(256 << 16));
+    rgb[0] = vshrq_n_s32(vaddq_s32(y, v), 16);
+    rgb[1] = vshrq_n_s32(vsubq_s32(y, vshrq_n_s32(uv, 8)), 16);
+    rgb[2] = vshrq_n_s32(vaddq_s32(y, u), 16);
+}
+
+static void yuv_line_neon(const render_yuv_line_t *l, const uint8_t *src,
+                          unsigned int first, unsigned int n)
+{
+    yuv_out_t o;
+    unsigned int positions = yuv_out_init(&o, l, first, n);
+    int32x4_t t0[4], t1[4], y, u, v, mid[3], cur[3];
+    int32x4_t py = vdupq_n_s32(0);
+    int32x4_t pu = vdupq_n_s32(0);
+    int32x4_t pv = vdupq_n_s32(0);
+    int32x4x2_t uvline;
+    uint32_t rgb[24];
+    int32_t prev[3];
+    unsigned int x, i;
+
+    ycbcr_neon(l->ycbcrtable, src, t0);
+    for (x = 0; x + 5 <= positions; x += 4) {
+        ycbcr_neon(l->ycbcrtable, src + x + 4, t1);
+        y = vaddq_s32(vaddq_s32(vextq_s32(t0[0], t1[0], 1), vextq_s32(t0[1], t1[1], 2)),
+                      vextq_s32(t0[0], t1[0], 3));
+        u = vaddq_s32(vaddq_s32(t0[2], vextq_s32(t0[2], t1[2], 1)),
+                      vaddq_s32(vextq_s32(t0[2], t1[2], 2), vextq_s32(t0[2], t1[2], 3)));
+        v = vaddq_s32(vaddq_s32(t0[3], vextq_s32(t0[3], t1[3], 1)),
+                      vaddq_s32(vextq_s32(t0[3], t1[3], 2), vextq_s32(t0[3], t1[3], 3)));
+        if (l->line != NULL) {
+            uvline = vld2q_s32(l->line + x * 2);
+            vst2q_s32(l->line + x * 2, (int32x4x2_t){ { u, v } });
+            u = vaddq_s32(u, uvline.val[0]);
+            v = vaddq_s32(v, uvline.val[1]);
+        }
+        u = vmulq_n_s32(u, l->off_flip);
+        v = vmulq_n_s32(v, l->off_flip);
+
+        if (l->interpolate) {
+            yuv_rgb_neon(vshrq_n_s32(vaddq_s32(vextq_s32(py, y, 3), y), 1),
+                         vshrq_n_s32(vaddq_s32(vextq_s32(pu, u, 3), u), 1),
+                         vshrq_n_s32(vaddq_s32(vextq_s32(pv, v, 3), v), 1), mid);
+            yuv_rgb_neon(y, u, v, cur);
+            for (i = 0; i < 3; i++) {
+                vst2q_u32(rgb + i * 8, (uint32x4x2_t){ { vreinterpretq_u32_s32(mid[i]),
+                                                         vreinterpretq_u32_s32(cur[i]) } });
+            }
+            yuv_out_block(&o, rgb, x == 0, 8);
+        } else {
+            yuv_rgb_neon(y, u, v, cur);
+            for (i = 0; i < 3; i++) {
+                vst1q_u32(rgb + i * 8, vreinterpretq_u32_s32(cur[i]));
+            }
+            yuv_out_block(&o, rgb, 0, 4);
+        }
+        py = y;
+        pu = u;
+        pv = v;
+        memcpy(t0, t1, sizeof(t0));
+    }
+    prev[0] = vgetq_lane_s32(py, 3);
+    prev[1] = vgetq_lane_s32(pu, 3);
+    prev[2] = vgetq_lane_s32(pv, 3);
+    yuv_line_tail(l, src, &o, x, positions, prev);
+}
+
+#endif
+
+
+/* Selection */
+
+typedef struct render_simd_s {
+    int level;
+    const char *name;
+    render_expand_func_t expand_08;
+    render_expand_func_t expand_16;
+    render_expand_func_t expand_24;
+    render_expand_func_t expand_32;
+    render_expand_func_t expand_24_2x;
+    render_expand_func_t expand_32_2x;
+    render_yuv_line_func_t yuv_line_32;
+} render_simd_t;
+
+/* Ordered by preference.  */
+static const render_simd_t render_simd[] = {
+#ifdef RENDER_HAVE_SSSE3
+    { RENDER_SIMD_SSSE3, "SSSE3",
+      expand_08_ssse3, expand_16_ssse3, expand_24_ssse3, expand_32_ssse3,
+      expand_24_2x_ssse3, expand_32_2x_ssse3, yuv_line_ssse3 },
+#endif
+#ifdef RENDER_HAVE_NEON
+    { RENDER_SIMD_NEON, "NEON",
+      expand_08_neon, expand_16_neon, expand_24_neon, expand_32_neon,
+      expand_24_2x_neon, expand_32_2x_neon, yuv_line_neon },
+#endif
+    { RENDER_SIMD_NONE, "C",
+      expand_08_c, expand_16_c, expand_24_c, expand_32_c,
+      expand_24_2x_c, expand_32_2x_c, yuv_line_c }
+};
+
+#define RENDER_SIMD_COUNT ((int)(sizeof(render_simd) / sizeof(render_simd[0])))
+
+render_expand_func_t render_expand_08 = expand_08_c;
+render_expand_func_t render_expand_16 = expand_16_c;
+render_expand_func_t render_expand_24 = expand_24_c;
+render_expand_func_t render_expand_32 = expand_32_c;
+render_expand_func_t render_expand_24_2x = expand_24_2x_c;
+render_expand_func_t render_expand_32_2x = expand_32_2x_c;
+
+render_yuv_line_func_t render_yuv_line_32 = yuv_line_c;
+int render_yuv_simd = 0;
+
+static int render_simd_supported(int level)
+{
+#ifdef RENDER_HAVE_SSSE3
+    __builtin_cpu_init();
+    switch (level) {
+        case RENDER_SIMD_SSSE3:
+            return __builtin_cpu_supports("ssse3");
+    }
+#endif
+    return 1;
+}
+
+/* Return the best level this CPU supports.  */
+int render_simd_detect(void)
+{
+    int i;
+
+    for (i = 0; i < RENDER_SIMD_COUNT; i++) {
+        if (render_simd_supported(render_simd[i].level)) {
+            return render_simd[i].level;
+        }
+    }
+    return RENDER_SIMD_NONE;
+}
+
+/* Use the given level, or the plain C versions if it is not available.
+   Return the level used.  */
+int render_simd_select(int level)
+{
+    int i;
+
+    for (i = 0; i < RENDER_SIMD_COUNT - 1; i++) {
+        if (render_simd[i].level == level && render_simd_supported(level)) {
+            break;
+        }
+    }
+    render_expand_08 = render_simd[i].expand_08;
+    render_expand_16 = render_simd[i].expand_16;
+    render_expand_24 = render_simd[i].expand_24;
+    render_expand_32 = render_simd[i].expand_32;
+    render_expand_24_2x = render_simd[i].expand_24_2x;
+    render_expand_32_2x = render_simd[i].expand_32_2x;
+    render_yuv_line_32 = render_simd[i].yuv_line_32;
+    render_yuv_simd = render_simd[i].level != RENDER_SIMD_NONE;
+    return render_simd[i].level;
+}
+
+const char *render_simd_name(int level)
+{
+    int i;
+
+    for (i = 0; i < RENDER_SIMD_COUNT - 1; i++) {
+        if (render_simd[i].level == level) {
+            break;
+        }
+    }
+    return render_simd[i].name;
+}
+
@@ -0,0 +1,82 @@
+/*
+ * rendersimd.h - Palette expansion for the framebuffer renderers
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_RENDERSIMD_H
+#define VICE_RENDERSIMD_H
+
+#include "types.h"
+
+#define RENDER_SIMD_NONE    0
+#define RENDER_SIMD_SSSE3   1
+#define RENDER_SIMD_NEON    2
+
+/* Look up `n' palette indices from `src' in `colortab' and store the low
+   8, 16, 24 or 32 bits of each colour at `trg', which needs no alignment.
+   The _2x versions store every colour twice.  */
+typedef void (*render_expand_func_t)(const uint32_t *colortab,
+                                     const uint8_t *src, uint8_t *trg,
+                                     unsigned int n);
+
+extern render_expand_func_t render_expand_08;
+extern render_expand_func_t render_expand_16;
+extern render_expand_func_t render_expand_24;
+extern render_expand_func_t render_expand_32;
+extern render_expand_func_t render_expand_24_2x;
+extern render_expand_func_t render_expand_32_2x;
+
+/* One line of the PAL and CRT renderers at 32 bits per pixel.  The luma of
+   a source pixel is blurred with its neighbours and the chroma averaged
+   over four pixels (and, with `line', with the previous line, as a PAL
+   delay line does).  With `interpolate' a pixel is put between each two
+   source pixels.  `scanline' gets the average of each pixel with the one
+   in `prevline' (and `scanline2', for 2x4, the pixel itself), and
+   `prevline' is updated.  */
+typedef struct render_yuv_line_s {
+    const int32_t *ycbcrtable;  /* ycbcrtable or ycbcrtable_odd */
+    int32_t *line;          /* chroma of the previous line, or NULL */
+    int32_t off_flip;
+    int interpolate;
+    uint32_t *trg;
+    uint32_t *trg2;         /* a copy of the line, or NULL */
+    uint32_t *scanline;     /* or NULL */
+    uint32_t *scanline2;    /* or NULL */
+    int16_t *prevline;
+} render_yuv_line_t;
+
+/* Nonzero if render_yuv_line_32() uses SIMD code; the renderers keep
+   their per pixel code otherwise.  */
+extern int render_yuv_simd;
+
+/* Render pixels `first' to `first' + `n' - 1 of the line starting with
+   source pixel `src' (two pixels left of the first visible one).  */
+typedef void (*render_yuv_line_func_t)(const render_yuv_line_t *l,
+                                       const uint8_t *src,
+                                       unsigned int first, unsigned int n);
+
+extern render_yuv_line_func_t render_yuv_line_32;
+
+extern int render_simd_detect(void);
+extern int render_simd_select(int level);
+extern const char *render_simd_name(int level);
+
+#endif
@@ -38,13 +38,16 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "lib.h"
 #include "log.h"
 #include "machine.h"
+#include "perfstats.h"
 #include "types.h"
 #include "video-canvas.h"
 #include "video-color.h"
+#include "video-render-thread.h"
 #include "video-render.h"
 #include "video.h"
 #include "viewport.h"
@@ -103,6 +106,7 @@ void video_canvas_shutdown(video_canvas_t *canvas)
             }
         }
 
+        video_render_thread_shutdown(canvas->videoconfig);
         lib_free(canvas->videoconfig);
         lib_free(canvas->draw_buffer);
         video_viewport_title_free(canvas->viewport);
@@ -112,16 +116,11 @@ void video_canvas_shutdown(video_canvas_t *canvas)
     }
 }
 
-void video_canvas_render(video_canvas_t *canvas, uint8_t *trg, int width,
-                         int height, int xs, int ys, int xt, int yt,
-                         int pitcht, int depth)
+/* Called on the emulation thread before each frame is rendered.  */
+static void video_canvas_render_prepare(video_canvas_t *canvas)
 {
     static int lastmode = -1;
     viewport_t *viewport = canvas->viewport;
-#ifdef VIDEO_SCALE_SOURCE
-    xs /= canvas->videoconfig->scalex;
-    ys /= canvas->videoconfig->scaley;
-#endif
 
     /* when the color encoding changed, the palette must be recalculated */
     if (viewport->crt_type != lastmode) {
@@ -132,10 +131,92 @@ void video_canvas_render(video_canvas_t *canvas, uint8_t *trg, int width,
     if (!canvas->videoconfig->color_tables.updated) { /* update colors as necessary */
         video_color_update_palette(canvas);
     }
-    video_render_main(canvas->videoconfig, canvas->draw_buffer->draw_buffer,
-                      trg, width, height, xs, ys, xt, yt,
-                      canvas->draw_buffer->draw_buffer_width, pitcht, depth,
-                      viewport);
+}
+
+/* Called once the changed lines have been rendered, or copied for the
+   render thread.  */
+void video_canvas_render_clean(video_canvas_t *canvas)
+{
+    draw_buffer_t *draw_buffer = canvas->draw_buffer;
+
+    if (draw_buffer->dirty_lines != NULL) {
+        memset(draw_buffer->dirty_lines, 0, draw_buffer->draw_buffer_height);
+    }
+}
+
+void video_canvas_render(video_canvas_t *canvas, uint8_t *trg, int width,
+                         int height, int xs, int ys, int xt, int yt,
+                         int pitcht, int depth)
+{
+    draw_buffer_t *draw_buffer = canvas->draw_buffer;
+    unsigned long perfstats_start;
+#ifdef VIDEO_SCALE_SOURCE
+    xs /= canvas->videoconfig->scalex;
+    ys /= canvas->videoconfig->scaley;
+#endif
+
+    video_render_thread_wait(canvas->videoconfig);
+    video_canvas_render_prepare(canvas);
+
+    if (width <= 0) {
+        return; /* some render routines don't like invalid width */
+    }
+
+    perfstats_start = perfstats_begin();
+    video_render_prepare(canvas->videoconfig, draw_buffer->draw_buffer,
+                         width, height, xs, ys, draw_buffer->draw_buffer_width,
+                         canvas->viewport);
+    video_render_frame_dirty(canvas->videoconfig, draw_buffer->draw_buffer,
+                             trg, width, height, xs, ys, xt, yt,
+                             draw_buffer->draw_buffer_width, pitcht, depth,
+                             canvas->viewport, draw_buffer->dirty_lines,
+                             draw_buffer->draw_buffer_height);
+    video_canvas_render_clean(canvas);
+    perfstats_end(PERFSTATS_RENDER, perfstats_start);
+}
+
+void video_canvas_render_full(video_canvas_t *canvas, uint8_t *trg, int width,
+                              int height, int xs, int ys, int xt, int yt,
+                              int pitcht, int depth)
+{
+    draw_buffer_t *draw_buffer = canvas->draw_buffer;
+#ifdef VIDEO_SCALE_SOURCE
+    xs /= canvas->videoconfig->scalex;
+    ys /= canvas->videoconfig->scaley;
+#endif
+
+    video_render_thread_wait(canvas->videoconfig);
+    video_canvas_render_prepare(canvas);
+
+    if (width <= 0) {
+        return; /* some render routines don't like invalid width */
+    }
+
+    video_render_frame(canvas->videoconfig, draw_buffer->draw_buffer,
+                       trg, width, height, xs, ys, xt, yt,
+                       draw_buffer->draw_buffer_width, pitcht, depth,
+                       canvas->viewport);
+}
+
+void video_canvas_render_queue(video_canvas_t *canvas, uint8_t *trg, int width,
+                               int height, int xs, int ys, int xt, int yt,
+                               int pitcht, int depth)
+{
+#ifdef VIDEO_SCALE_SOURCE
+    xs /= canvas->videoconfig->scalex;
+    ys /= canvas->videoconfig->scaley;
+#endif
+
+    video_render_thread_wait(canvas->videoconfig);
+    video_canvas_render_prepare(canvas);
+
+    video_render_thread_queue(canvas, trg, width, height, xs, ys, xt, yt,
+                              pitcht, depth);
+}
+
+void video_canvas_render_wait(video_canvas_t *canvas)
+{
+    video_render_thread_wait(canvas->videoconfig);
 }
 
 /** \brief Force refresh all tracked canvases.
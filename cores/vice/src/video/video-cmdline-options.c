@@ -49,6 +49,14 @@ static cmdline_option_t cmdline_options[] =
 };
 #endif
 
+static const cmdline_option_t cmdline_options_render_threads[] =
+{
+    { "-renderthreads", SET_RESOURCE, CMDLINE_ATTRIB_NEED_ARGS,
+      NULL, NULL, "RenderThreads", NULL,
+      "<Number>", "Render each frame in horizontal bands on <Number> threads (1: off)" },
+    CMDLINE_LIST_END
+};
+
 int video_cmdline_options_init(void)
 {
 #ifdef HAVE_HWSCALE
@@ -58,6 +66,11 @@ int video_cmdline_options_init(void)
         }
     }
 #endif
+    if (machine_class != VICE_MACHINE_VSID) {
+        if (cmdline_register_options(cmdline_options_render_threads) < 0) {
+            return -1;
+        }
+    }
     return video_arch_cmdline_options_init();
 }
 
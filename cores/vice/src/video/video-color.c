@@ -49,6 +49,8 @@
 #include "viewport.h"
 #include "video-canvas.h"
 #include "video-color.h"
+#include "video-render-thread.h"
+#include "video-render.h"
 #include "video.h"
 
 uint32_t gamma_red[256 * 3];
@@ -667,6 +669,23 @@ static void video_calc_ycbcrtable_oddlines(video_resources_t *video_resources,
     }
 }
 
+/* Interleave the tables of each colour for render_yuv_line_32().  */
+static void video_calc_ycbcrtable_packed(video_render_color_tables_t *color_tab)
+{
+    unsigned int i;
+
+    for (i = 0; i < 256; i++) {
+        color_tab->ycbcrtable[i * 4 + 0] = color_tab->ytablel[i];
+        color_tab->ycbcrtable[i * 4 + 1] = color_tab->ytableh[i];
+        color_tab->ycbcrtable[i * 4 + 2] = color_tab->cbtable[i];
+        color_tab->ycbcrtable[i * 4 + 3] = color_tab->crtable[i];
+        color_tab->ycbcrtable_odd[i * 4 + 0] = color_tab->ytablel[i];
+        color_tab->ycbcrtable_odd[i * 4 + 1] = color_tab->ytableh[i];
+        color_tab->ycbcrtable_odd[i * 4 + 2] = color_tab->cbtable_odd[i];
+        color_tab->ycbcrtable_odd[i * 4 + 3] = color_tab->crtable_odd[i];
+    }
+}
+
 /* Convert an RGB palette to YCbCr. (used when custom palette is loaded) */
 static void video_palette_to_ycbcr(const palette_t *p, video_ycbcr_palette_t* ycbcr, int video)
 {
@@ -858,6 +877,9 @@ int video_color_update_palette(struct video_canvas_s *canvas)
     if (canvas == NULL) {
         return 0;
     }
+    /* the render thread may still be reading the color tables */
+    video_render_thread_wait(canvas->videoconfig);
+    video_render_invalidate(canvas->videoconfig);
     canvas->videoconfig->color_tables.updated = 1;
 
     DBG(("video_color_update_palette cbm palette:%d extern: %d",
@@ -917,6 +939,7 @@ int video_color_update_palette(struct video_canvas_s *canvas)
         video_cbm_palette_to_ycbcr_oddlines(video_resources, canvas->videoconfig->cbm_palette, ycbcr, video);
         video_calc_ycbcrtable_oddlines(video_resources, ycbcr, &canvas->videoconfig->color_tables, video);
     }
+    video_calc_ycbcrtable_packed(&canvas->videoconfig->color_tables);
 
     video_ycbcr_palette_free(ycbcr);
 
@@ -0,0 +1,281 @@
+/*
+ * video-render-bands.c - Render a frame in horizontal bands on several threads.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* The renderers only read the source and write their own target lines, so
+   a frame can be cut into bands of whole source lines.  The PAL and CRT
+   renderers already handle the seams: they seed their line delay from the
+   source line above the rectangle, and after its last line they render the
+   next source line into a scratch line just to write the scanline between
+   the two.  What they share is the scratch lines in the colour tables,
+   which is why every band but the first gets a copy of the config.
+
+   The calling thread renders the first band and a pool of persistent
+   workers the others.  Only one frame is split at a time; a second caller
+   waits for the pool.  */
+
+#include "vice.h"
+
+#include <string.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#include "lib.h"
+#include "log.h"
+#include "types.h"
+#include "video-render-bands.h"
+#include "video.h"
+#include "viewport.h"
+
+/* Bands of fewer target lines are not worth a thread.  */
+#define BAND_LINES_MIN  16
+
+#ifdef HAVE_PTHREAD_H
+
+typedef struct band_s {
+    video_render_config_t *config;
+    int ys, yt, height;
+} band_t;
+
+/* The frame being rendered.  */
+static video_render_band_func_t job_func;
+static uint8_t *job_src, *job_trg;
+static int job_width, job_xs, job_xt, job_pitchs, job_pitcht, job_depth;
+static viewport_t *job_viewport;
+static band_t bands[VIDEO_RENDER_BANDS_MAX];
+static int bands_num;
+
+static pthread_t workers[VIDEO_RENDER_BANDS_MAX - 1];
+static int workers_num = 0;
+
+/* The generation when the workers were started, which they wait past.  */
+static unsigned int workers_generation;
+
+/* Held by the caller for a whole frame, and to start or stop workers.  */
+static pthread_mutex_t frame_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Protects the rest.  */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t start_condition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_condition = PTHREAD_COND_INITIALIZER;
+static unsigned int generation = 0;
+static int pending = 0;
+static int quit = 0;
+
+static void render_band(const band_t *band)
+{
+    job_func(band->config, job_src, job_trg, job_width, band->height,
+             job_xs, band->ys, job_xt, band->yt, job_pitchs, job_pitcht,
+             job_depth, job_viewport);
+}
+
+static void *worker_main(void *arg)
+{
+    int index = vice_ptr_to_int(arg);
+    unsigned int seen = workers_generation;
+
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        while (generation == seen && !quit) {
+            pthread_cond_wait(&start_condition, &lock);
+        }
+        if (quit) {
+            break;
+        }
+        seen = generation;
+        if (index >= bands_num) {
+            continue;
+        }
+        pthread_mutex_unlock(&lock);
+
+        render_band(&bands[index]);
+
+        pthread_mutex_lock(&lock);
+        if (--pending == 0) {
+            pthread_cond_signal(&done_condition);
+        }
+    }
+    pthread_mutex_unlock(&lock);
+
+    return NULL;
+}
+
+static void stop_workers(void)
+{
+    int i;
+
+    pthread_mutex_lock(&lock);
+    quit = 1;
+    pthread_cond_broadcast(&start_condition);
+    pthread_mutex_unlock(&lock);
+
+    for (i = 0; i < workers_num; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    workers_num = 0;
+    quit = 0;
+
+    for (i = 1; i < VIDEO_RENDER_BANDS_MAX; i++) {
+        lib_free(bands[i].config);
+    }
+}
+
+int video_render_bands_set_threads(int threads)
+{
+    int i;
+
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > VIDEO_RENDER_BANDS_MAX) {
+        threads = VIDEO_RENDER_BANDS_MAX;
+    }
+
+    pthread_mutex_lock(&frame_lock);
+    if (threads - 1 != workers_num) {
+        stop_workers();
+
+        workers_generation = generation;
+        for (i = 1; i < threads; i++) {
+            if (pthread_create(&workers[i - 1], NULL, worker_main,
+                               int_to_void_ptr(i)) != 0) {
+                log_error(LOG_DEFAULT, "video: cannot create render band thread %d.", i);
+                break;
+            }
+            workers_num++;
+        }
+        threads = workers_num + 1;
+    }
+    pthread_mutex_unlock(&frame_lock);
+
+    return threads;
+}
+
+void video_render_bands_shutdown(void)
+{
+    pthread_mutex_lock(&frame_lock);
+    stop_workers();
+    pthread_mutex_unlock(&frame_lock);
+}
+
+int video_render_bands(video_render_band_func_t func,
+                       video_render_config_t *config,
+                       uint8_t *src, uint8_t *trg,
+                       int width, int height, int xs, int ys,
+                       int xt, int yt, int pitchs, int pitcht,
+                       int depth, viewport_t *viewport, int lines)
+{
+    int n, i, unit, units, offset;
+
+    /* The 2x renderers draw a line and a scanline per source line, in
+       that order unless yt is odd, so keep the bands even.  */
+    unit = lines < 2 ? 2 : lines;
+
+    pthread_mutex_lock(&frame_lock);
+
+    n = workers_num + 1;
+    if (n > height / BAND_LINES_MIN) {
+        n = height / BAND_LINES_MIN;
+    }
+    units = height / unit;
+    if (n < 2 || units < n) {
+        pthread_mutex_unlock(&frame_lock);
+        return -1;
+    }
+
+    /* Bands of whole units; the last one also takes what is left.  */
+    offset = 0;
+    for (i = 0; i < n; i++) {
+        int band_lines = (units / n + (i < units % n)) * unit;
+
+        if (i == n - 1) {
+            band_lines = height - offset;
+        }
+        bands[i].ys = ys + offset / lines;
+        bands[i].yt = yt + offset;
+        bands[i].height = band_lines;
+        offset += band_lines;
+    }
+
+    bands[0].config = config;
+    for (i = 1; i < n; i++) {
+        if (bands[i].config == NULL) {
+            bands[i].config = lib_malloc(sizeof(video_render_config_t));
+        }
+        *bands[i].config = *config;
+    }
+
+    job_func = func;
+    job_src = src;
+    job_trg = trg;
+    job_width = width;
+    job_xs = xs;
+    job_xt = xt;
+    job_pitchs = pitchs;
+    job_pitcht = pitcht;
+    job_depth = depth;
+    job_viewport = viewport;
+
+    pthread_mutex_lock(&lock);
+    bands_num = n;
+    pending = n - 1;
+    generation++;
+    pthread_cond_broadcast(&start_condition);
+    pthread_mutex_unlock(&lock);
+
+    render_band(&bands[0]);
+
+    pthread_mutex_lock(&lock);
+    while (pending > 0) {
+        pthread_cond_wait(&done_condition, &lock);
+    }
+    pthread_mutex_unlock(&lock);
+
+    pthread_mutex_unlock(&frame_lock);
+
+    return 0;
+}
+
+#else /* !HAVE_PTHREAD_H */
+
+int video_render_bands_set_threads(int threads)
+{
+    return 1;
+}
+
+void video_render_bands_shutdown(void)
+{
+}
+
+int video_render_bands(video_render_band_func_t func,
+                       video_render_config_t *config,
+                       uint8_t *src, uint8_t *trg,
+                       int width, int height, int xs, int ys,
+                       int xt, int yt, int pitchs, int pitcht,
+                       int depth, viewport_t *viewport, int lines)
+{
+    return -1;
+}
+
+#endif
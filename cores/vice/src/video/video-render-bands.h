@@ -0,0 +1,58 @@
+/*
+ * video-render-bands.h - Render a frame in horizontal bands on several threads.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+#ifndef VICE_VIDEO_RENDER_BANDS_H
+#define VICE_VIDEO_RENDER_BANDS_H
+
+#include "types.h"
+#include "viewport.h"
+
+struct video_render_config_s;
+
+#define VIDEO_RENDER_BANDS_MAX  16
+
+typedef void (*video_render_band_func_t)(struct video_render_config_s *config,
+                                         uint8_t *src, uint8_t *trg,
+                                         int width, int height, int xs, int ys,
+                                         int xt, int yt, int pitchs, int pitcht,
+                                         int depth, viewport_t *viewport);
+
+/* Use `threads' threads, the caller's included, for each frame.  1 turns
+   banding off; without thread support it is always off.  Returns the
+   number actually used.  */
+extern int video_render_bands_set_threads(int threads);
+extern void video_render_bands_shutdown(void);
+
+/* Render the rectangle with `func' in as many bands as there are threads.
+   `lines' is the number of target lines per source line; bands start on
+   whole source lines.  Each band but the first renders with a copy of
+   `config', whose scratch lines it may use.  Returns -1 without rendering
+   if banding is off or the rectangle is too small to split.  */
+extern int video_render_bands(video_render_band_func_t func,
+                              struct video_render_config_s *config,
+                              uint8_t *src, uint8_t *trg,
+                              int width, int height, int xs, int ys,
+                              int xt, int yt, int pitchs, int pitcht,
+                              int depth, viewport_t *viewport, int lines);
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ * video-render-thread.c - Render finished frames on a separate thread.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* The emulation thread copies the finished draw buffer and hands it to a
+   worker, which does the colour conversion and scaling into the target
+   while the next frame is emulated.  There is one worker per canvas and
+   at most one frame in flight, so the copy is the second half of a double
+   buffer and a frame is shown at most one frame late.
+
+   Only the headless benchmark (-benchmarkrender 2) queues frames so far.
+   The iOS frontend does not go through video_canvas_render() at all: its
+   video_canvas_refresh() hands the indexed draw buffer to its own
+   Renderer, which does the palette lookup itself.  */
+
+#include "vice.h"
+
+#include <string.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#include "lib.h"
+#include "log.h"
+#include "perfstats.h"
+#include "types.h"
+#include "video-canvas.h"
+#include "video-render-thread.h"
+#include "video-render.h"
+#include "video.h"
+#include "videoarch.h"
+#include "viewport.h"
+
+static void render_synchronous(video_canvas_t *canvas, uint8_t *trg,
+                               int width, int height, int xs, int ys,
+                               int xt, int yt, int pitcht, int depth)
+{
+    draw_buffer_t *draw_buffer = canvas->draw_buffer;
+    unsigned long perfstats_start;
+
+    if (width <= 0) {
+        return; /* some render routines don't like invalid width */
+    }
+
+    perfstats_start = perfstats_begin();
+
+    video_render_prepare(canvas->videoconfig, draw_buffer->draw_buffer,
+                         width, height, xs, ys, draw_buffer->draw_buffer_width,
+                         canvas->viewport);
+    video_render_frame_dirty(canvas->videoconfig, draw_buffer->draw_buffer,
+                             trg, width, height, xs, ys, xt, yt,
+                             draw_buffer->draw_buffer_width, pitcht, depth,
+                             canvas->viewport, draw_buffer->dirty_lines,
+                             draw_buffer->draw_buffer_height);
+    video_canvas_render_clean(canvas);
+    perfstats_end(PERFSTATS_RENDER, perfstats_start);
+}
+
+#ifdef HAVE_PTHREAD_H
+
+/* The CRT and scale2x renderers read a line above and below the frame.  */
+#define RENDER_THREAD_PAD_LINES 2
+
+struct video_render_thread_s {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int busy;                   /* a frame is queued or being rendered */
+    int quit;
+
+    video_render_config_t *config;
+
+    /* Copy of the draw buffer the queued frame is rendered from.  */
+    uint8_t *src_allocation;
+    size_t src_size;
+    uint8_t *src;
+
+    /* Copy of the draw buffer's dirty line flags.  */
+    uint8_t *dirty;
+    int dirty_num;
+
+    uint8_t *trg;
+    int width, height, xs, ys, xt, yt, pitchs, pitcht, depth;
+    viewport_t viewport;
+
+    int timed;                  /* perfstats were enabled when queued */
+    unsigned long render_ticks;
+};
+
+/* Set once a worker could not be started; later frames render in place.  */
+static int render_thread_failed = 0;
+
+static void *render_thread_main(void *arg)
+{
+    video_render_thread_t *rt = arg;
+
+    pthread_mutex_lock(&rt->lock);
+    for (;;) {
+        unsigned long start = 0;
+
+        while (!rt->busy && !rt->quit) {
+            pthread_cond_wait(&rt->cond, &rt->lock);
+        }
+        if (rt->quit) {
+            break;
+        }
+        pthread_mutex_unlock(&rt->lock);
+
+        if (rt->timed) {
+            start = tick_now();
+        }
+        video_render_frame_dirty(rt->config, rt->src, rt->trg, rt->width, rt->height,
+                                 rt->xs, rt->ys, rt->xt, rt->yt, rt->pitchs,
+                                 rt->pitcht, rt->depth, &rt->viewport,
+                                 rt->dirty, rt->dirty_num);
+        if (rt->timed) {
+            rt->render_ticks = tick_delta(start);
+        }
+
+        pthread_mutex_lock(&rt->lock);
+        rt->busy = 0;
+        pthread_cond_broadcast(&rt->cond);
+    }
+    pthread_mutex_unlock(&rt->lock);
+
+    return NULL;
+}
+
+static video_render_thread_t *render_thread_create(video_render_config_t *config)
+{
+    video_render_thread_t *rt = lib_calloc(1, sizeof(video_render_thread_t));
+
+    rt->config = config;
+    pthread_mutex_init(&rt->lock, NULL);
+    pthread_cond_init(&rt->cond, NULL);
+
+    if (pthread_create(&rt->thread, NULL, render_thread_main, rt) != 0) {
+        log_error(LOG_DEFAULT, "video: cannot create render thread, rendering frames synchronously.");
+        pthread_cond_destroy(&rt->cond);
+        pthread_mutex_destroy(&rt->lock);
+        lib_free(rt);
+        return NULL;
+    }
+
+    return rt;
+}
+
+void video_render_thread_queue(video_canvas_t *canvas, uint8_t *trg,
+                               int width, int height, int xs, int ys,
+                               int xt, int yt, int pitcht, int depth)
+{
+    video_render_config_t *config = canvas->videoconfig;
+    draw_buffer_t *draw_buffer = canvas->draw_buffer;
+    video_render_thread_t *rt;
+    size_t pad, size;
+
+    if (width <= 0) {
+        return; /* some render routines don't like invalid width */
+    }
+
+    video_render_thread_wait(config);
+
+    if (config->render_thread == NULL && !render_thread_failed) {
+        config->render_thread = render_thread_create(config);
+        render_thread_failed = config->render_thread == NULL;
+    }
+    rt = config->render_thread;
+
+    if (rt == NULL) {
+        render_synchronous(canvas, trg, width, height, xs, ys, xt, yt,
+                           pitcht, depth);
+        return;
+    }
+
+    pad = (size_t)draw_buffer->draw_buffer_pitch * RENDER_THREAD_PAD_LINES;
+    size = (size_t)draw_buffer->draw_buffer_pitch * draw_buffer->draw_buffer_height;
+    if (rt->src_size != size + 2 * pad) {
+        lib_free(rt->src_allocation);
+        rt->src_size = size + 2 * pad;
+        rt->src_allocation = lib_calloc(1, rt->src_size);
+        rt->src = rt->src_allocation + pad;
+    }
+    memcpy(rt->src, draw_buffer->draw_buffer, size);
+
+    if (draw_buffer->dirty_lines != NULL) {
+        if (rt->dirty_num != (int)draw_buffer->draw_buffer_height) {
+            lib_free(rt->dirty);
+            rt->dirty_num = (int)draw_buffer->draw_buffer_height;
+            rt->dirty = lib_malloc(rt->dirty_num);
+        }
+        memcpy(rt->dirty, draw_buffer->dirty_lines, rt->dirty_num);
+        video_canvas_render_clean(canvas);
+    } else {
+        lib_free(rt->dirty);
+        rt->dirty = NULL;
+        rt->dirty_num = 0;
+    }
+
+    video_render_prepare(config, rt->src, width, height, xs, ys,
+                         draw_buffer->draw_buffer_width, canvas->viewport);
+
+    rt->trg = trg;
+    rt->width = width;
+    rt->height = height;
+    rt->xs = xs;
+    rt->ys = ys;
+    rt->xt = xt;
+    rt->yt = yt;
+    rt->pitchs = draw_buffer->draw_buffer_width;
+    rt->pitcht = pitcht;
+    rt->depth = depth;
+    rt->viewport = *canvas->viewport;
+    rt->timed = perfstats_enabled;
+    rt->render_ticks = 0;
+
+    pthread_mutex_lock(&rt->lock);
+    rt->busy = 1;
+    pthread_cond_signal(&rt->cond);
+    pthread_mutex_unlock(&rt->lock);
+}
+
+void video_render_thread_wait(video_render_config_t *config)
+{
+    video_render_thread_t *rt = config->render_thread;
+    unsigned long perfstats_start;
+
+    if (rt == NULL) {
+        return;
+    }
+
+    perfstats_start = perfstats_begin();
+    pthread_mutex_lock(&rt->lock);
+    while (rt->busy) {
+        pthread_cond_wait(&rt->cond, &rt->lock);
+    }
+    pthread_mutex_unlock(&rt->lock);
+    perfstats_end(PERFSTATS_RENDER_WAIT, perfstats_start);
+
+    /* count each frame's render time once, on the emulation thread */
+    if (rt->timed) {
+        if (perfstats_enabled) {
+            perfstats_ticks[PERFSTATS_RENDER] += rt->render_ticks;
+        }
+        rt->timed = 0;
+    }
+}
+
+void video_render_thread_shutdown(video_render_config_t *config)
+{
+    video_render_thread_t *rt = config->render_thread;
+
+    if (rt == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&rt->lock);
+    while (rt->busy) {
+        pthread_cond_wait(&rt->cond, &rt->lock);
+    }
+    rt->quit = 1;
+    pthread_cond_signal(&rt->cond);
+    pthread_mutex_unlock(&rt->lock);
+    pthread_join(rt->thread, NULL);
+
+    pthread_cond_destroy(&rt->cond);
+    pthread_mutex_destroy(&rt->lock);
+    lib_free(rt->src_allocation);
+    lib_free(rt->dirty);
+    lib_free(rt);
+    config->render_thread = NULL;
+}
+
+#else /* !HAVE_PTHREAD_H */
+
+void video_render_thread_queue(video_canvas_t *canvas, uint8_t *trg,
+                               int width, int height, int xs, int ys,
+                               int xt, int yt, int pitcht, int depth)
+{
+    render_synchronous(canvas, trg, width, height, xs, ys, xt, yt,
+                       pitcht, depth);
+}
+
+void video_render_thread_wait(video_render_config_t *config)
+{
+}
+
+void video_render_thread_shutdown(video_render_config_t *config)
+{
+}
+
+#endif
@@ -38,7 +38,9 @@
 #include "render2x2ntsc.h"
 #include "render2x2pal.h"
 #include "render2x4crt.h"
+#include "rendersimd.h"
 #include "types.h"
+#include "video-render-bands.h"
 #include "video-render.h"
 #include "video-sound.h"
 #include "video.h"
@@ -96,14 +98,60 @@ void video_render_setphysicalcolor(video_render_config_t *config, int index,
 }
 
 static int rendermode_error = -1;
+static int render_simd_level = -1;
 
 void video_render_main(video_render_config_t *config, uint8_t *src, uint8_t *trg,
                        int width, int height, int xs, int ys, int xt, int yt,
                        int pitchs, int pitcht, int depth, viewport_t *viewport)
 {
-    const video_render_color_tables_t *colortab;
-    int rendermode;
+    if (width <= 0) {
+        return; /* some render routines don't like invalid width */
+    }
+
+    video_render_prepare(config, src, width, height, xs, ys, pitchs, viewport);
+    video_render_frame(config, src, trg, width, height, xs, ys, xt, yt,
+                       pitchs, pitcht, depth, viewport);
+}
+
+void video_render_prepare(video_render_config_t *config, uint8_t *src,
+                          int width, int height, int xs, int ys, int pitchs,
+                          viewport_t *viewport)
+{
+    if (render_simd_level < 0) {
+        render_simd_level = render_simd_select(render_simd_detect());
+        log_message(LOG_DEFAULT, "video: using %s palette expansion.",
+                    render_simd_name(render_simd_level));
+    }
+
+    video_sound_update(config, src, width, height, xs, ys, pitchs, viewport);
+}
+
+/* Target lines per source line.  */
+static int render_lines(int rendermode)
+{
+    switch (rendermode) {
+        case VIDEO_RENDER_RGB_2X4:
+        case VIDEO_RENDER_CRT_2X4:
+            return 4;
+        case VIDEO_RENDER_PAL_2X2:
+        case VIDEO_RENDER_RGB_1X2:
+        case VIDEO_RENDER_RGB_2X2:
+        case VIDEO_RENDER_CRT_1X2:
+        case VIDEO_RENDER_CRT_2X2:
+            return 2;
+        default:
+            return 1;
+    }
+}
 
+static void video_render_rect(video_render_config_t *config, uint8_t *src, uint8_t *trg,
+                              int width, int height, int xs, int ys, int xt, int yt,
+                              int pitchs, int pitcht, int depth, viewport_t *viewport);
+
+void video_render_frame(video_render_config_t *config, uint8_t *src, uint8_t *trg,
+                        int width, int height, int xs, int ys, int xt, int yt,
+                        int pitchs, int pitcht, int depth, viewport_t *viewport)
+{
 #if 0
     log_debug("w:%i h:%i xs:%i ys:%i xt:%i yt:%i ps:%i pt:%i d%i",
               width, height, xs, ys, xt, yt, pitchs, pitcht, depth);
@@ -113,7 +161,130 @@ void video_render_main(video_render_config_t *config, uint8_t *src, uint8_t *trg
         return; /* some render routines don't like invalid width */
     }
 
-    video_sound_update(config, src, width, height, xs, ys, pitchs, viewport);
+    if (config->rendermode == VIDEO_RENDER_NULL
+        || video_render_bands(video_render_rect, config, src, trg, width, height,
+                              xs, ys, xt, yt, pitchs, pitcht, depth, viewport,
+                              render_lines(config->rendermode)) < 0) {
+        video_render_rect(config, src, trg, width, height, xs, ys, xt, yt,
+                          pitchs, pitcht, depth, viewport);
+    }
+}
+
+void video_render_invalidate(video_render_config_t *config)
+{
+    config->last_frame.valid = 0;
+}
+
+/* The PAL and CRT renderers blend each line with its neighbours, and so
+   does scale2x.  */
+static int render_reads_neighbours(video_render_config_t *config)
+{
+    switch (config->rendermode) {
+        case VIDEO_RENDER_RGB_1X1:
+        case VIDEO_RENDER_RGB_1X2:
+        case VIDEO_RENDER_RGB_2X4:
+            return 0;
+        case VIDEO_RENDER_RGB_2X2:
+            return config->scale2x;
+        default:
+            return 1;
+    }
+}
+
+static int line_changed(const uint8_t *dirty, int dirty_num, int y, int spread)
+{
+    int i;
+
+    for (i = y - spread; i <= y + spread; i++) {
+        if (i >= 0 && i < dirty_num && dirty[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void video_render_frame_dirty(video_render_config_t *config, uint8_t *src, uint8_t *trg,
+                              int width, int height, int xs, int ys, int xt, int yt,
+                              int pitchs, int pitcht, int depth, viewport_t *viewport,
+                              const uint8_t *dirty, int dirty_num)
+{
+    video_render_last_frame_t *last = &config->last_frame;
+    int lines, spread, rows, row, first, rendered;
+
+    if (width <= 0) {
+        return; /* some render routines don't like invalid width */
+    }
+
+    if (dirty == NULL
+        || !last->valid
+        || last->src != src || last->trg != trg
+        || last->width != width || last->height != height
+        || last->xs != xs || last->ys != ys
+        || last->xt != xt || last->yt != yt
+        || last->pitchs != pitchs || last->pitcht != pitcht
+        || last->depth != depth
+        || last->rendermode != config->rendermode
+        || last->doublescan != config->doublescan
+        || last->scale2x != config->scale2x) {
+        video_render_frame(config, src, trg, width, height, xs, ys, xt, yt,
+                           pitchs, pitcht, depth, viewport);
+        config->lines_rendered += height;
+
+        last->valid = config->rendermode != VIDEO_RENDER_NULL;
+        last->src = src;
+        last->trg = trg;
+        last->width = width;
+        last->height = height;
+        last->xs = xs;
+        last->ys = ys;
+        last->xt = xt;
+        last->yt = yt;
+        last->pitchs = pitchs;
+        last->pitcht = pitcht;
+        last->depth = depth;
+        last->rendermode = config->rendermode;
+        last->doublescan = config->doublescan;
+        last->scale2x = config->scale2x;
+        return;
+    }
+
+    /* Render runs of changed source lines, each of them as a frame of its
+       own; they start on whole source lines like the bands do.  */
+    lines = render_lines(config->rendermode);
+    spread = render_reads_neighbours(config);
+    if ((yt & 1) && lines > 1) {
+        /* the target lines of a source line straddle the next one */
+        spread++;
+    }
+    rows = (height + lines - 1) / lines;
+    rendered = 0;
+    first = -1;
+    for (row = 0; row <= rows; row++) {
+        if (row < rows && line_changed(dirty, dirty_num, ys + row, spread)) {
+            if (first < 0) {
+                first = row;
+            }
+        } else if (first >= 0) {
+            int offset = first * lines;
+            int run = (row == rows ? height : row * lines) - offset;
+
+            video_render_frame(config, src, trg, width, run, xs, ys + first,
+                               xt, yt + offset, pitchs, pitcht, depth, viewport);
+            rendered += run;
+            first = -1;
+        }
+    }
+    config->lines_rendered += rendered;
+    config->lines_skipped += height - rendered;
+}
+
+/* Render the rectangle, or one band of it, on the calling thread.  */
+static void video_render_rect(video_render_config_t *config, uint8_t *src, uint8_t *trg,
+                              int width, int height, int xs, int ys, int xt, int yt,
+                              int pitchs, int pitcht, int depth, viewport_t *viewport)
+{
+    const video_render_color_tables_t *colortab;
+    int rendermode;
 
     rendermode = config->rendermode;
     colortab = &config->color_tables;
@@ -169,7 +340,7 @@ void video_render_main(video_render_config_t *config, uint8_t *src, uint8_t *trg
             return;
     }
     if (rendermode_error != rendermode) {
-        log_error(LOG_DEFAULT, "video_render_main: unsupported rendermode (%d)", rendermode);
+        log_error(LOG_DEFAULT, "video_render_rect: unsupported rendermode (%d)", rendermode);
     }
     rendermode_error = rendermode;
 }
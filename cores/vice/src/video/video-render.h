@@ -39,6 +39,30 @@ extern void video_render_main(struct video_render_config_s *config, uint8_t *src
                               int xs, int ys, int xt, int yt,
                               int pitchs, int pitcht, int depth,
                               viewport_t *viewport);
+/* video_render_main() is video_render_prepare(), which has to run on the
+   emulation thread, followed by video_render_frame(), which may run on
+   another one.  */
+extern void video_render_prepare(struct video_render_config_s *config, uint8_t *src,
+                                 int width, int height, int xs, int ys, int pitchs,
+                                 viewport_t *viewport);
+extern void video_render_frame(struct video_render_config_s *config, uint8_t *src,
+                               uint8_t *trg, int width, int height,
+                               int xs, int ys, int xt, int yt,
+                               int pitchs, int pitcht, int depth,
+                               viewport_t *viewport);
+/* Like video_render_frame(), but if the target still holds the last frame
+   rendered with the same parameters, only render the source lines flagged
+   in `dirty' (`dirty_num' flags, one per line of `src'), and the lines next
+   to them when the renderer reads those.  */
+extern void video_render_frame_dirty(struct video_render_config_s *config, uint8_t *src,
+                                     uint8_t *trg, int width, int height,
+                                     int xs, int ys, int xt, int yt,
+                                     int pitchs, int pitcht, int depth,
+                                     viewport_t *viewport,
+                                     const uint8_t *dirty, int dirty_num);
+/* Render the whole of the next frame, after the colours or the layout
+   changed.  */
+extern void video_render_invalidate(struct video_render_config_s *config);
 extern void video_render_update_palette(struct video_canvas_s *canvas);
 
 extern void video_render_1x2func_set(void (*func)(struct video_render_config_s *,
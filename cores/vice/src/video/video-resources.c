@@ -45,6 +45,8 @@
 #include "machine.h"
 #include "resources.h"
 #include "video-color.h"
+#include "video-render-bands.h"
+#include "video-render-thread.h"
 #include "video.h"
 #include "viewport.h"
 #include "util.h"
@@ -70,6 +72,22 @@ static resource_int_t resources_hwscale_possible[] =
 };
 #endif
 
+static int render_threads;
+
+static int set_render_threads(int val, void *param)
+{
+    render_threads = video_render_bands_set_threads(val);
+
+    return 0;
+}
+
+static resource_int_t resources_render_threads[] =
+{
+    { "RenderThreads", 1, RES_EVENT_NO, NULL,
+      &render_threads, set_render_threads, NULL },
+    RESOURCE_INT_LIST_END
+};
+
 int video_resources_init(void)
 {
 #ifdef HAVE_HWSCALE
@@ -80,11 +98,18 @@ int video_resources_init(void)
     }
 #endif
 
+    if (machine_class != VICE_MACHINE_VSID) {
+        if (resources_register_int(resources_render_threads) < 0) {
+            return -1;
+        }
+    }
+
     return video_arch_resources_init();
 }
 
 void video_resources_shutdown(void)
 {
+    video_render_bands_shutdown();
     video_arch_resources_shutdown();
 }
 
@@ -111,6 +136,8 @@ static int set_double_size_enabled(int value, void *param)
         cap_render = &video_chip_cap->single_mode;
     }
 
+    /* the render mode and scale of a frame in flight must not change */
+    video_render_thread_wait(canvas->videoconfig);
     canvas->videoconfig->rendermode = cap_render->rmode;
 
     old_scalex = canvas->videoconfig->scalex;
@@ -164,6 +191,7 @@ static int set_double_scan_enabled(int val, void *param)
 {
     video_canvas_t *canvas = (video_canvas_t *)param;
 
+    video_render_thread_wait(canvas->videoconfig);
     canvas->videoconfig->doublescan = val ? 1 : 0;
     canvas->videoconfig->color_tables.updated = 0;
 
@@ -233,6 +261,7 @@ static int set_chip_rendermode(int val, void *param)
 
     dsize = util_concat(chip, "DoubleSize", NULL);
 
+    video_render_thread_wait(canvas->videoconfig);
     canvas->videoconfig->filter = val;
     canvas->videoconfig->scale2x = 0; /* FIXME: remove this */
     canvas->videoconfig->color_tables.updated = 0;
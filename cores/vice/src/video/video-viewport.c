@@ -32,6 +32,8 @@
 
 #include "lib.h"
 #include "machine.h"
+#include "video-render-thread.h"
+#include "video-render.h"
 #include "video.h"
 #include "viewport.h"
 
@@ -62,6 +64,10 @@ void video_viewport_resize(video_canvas_t *canvas, char resize_canvas)
     geometry = canvas->geometry;
     viewport = canvas->viewport;
 
+    /* the frame in flight still renders into the old canvas */
+    video_render_thread_wait(canvas->videoconfig);
+    video_render_invalidate(canvas->videoconfig);
+
     screen_size = &geometry->screen_size;
     gfx_size = &geometry->gfx_size;
     gfx_position = &geometry->gfx_position;
@@ -65,6 +65,7 @@
 #include "monitor_binary.h"
 #endif
 #include "network.h"
+#include "perfstats.h"
 #include "resources.h"
 #include "sound.h"
 #include "types.h"
@@ -141,6 +142,10 @@ static int warp_enabled;
 static unsigned long warp_render_tick_interval;
 static unsigned long warp_next_render_tick;
 
+/* Catching up after a netplay rollback; runs as fast as possible like warp
+   mode, but without touching the "WarpMode" resource.  */
+static int catch_up_enabled;
+
 /* Triggers the vice thread to update its priorty */
 static volatile int update_thread_priority = 1;
 
@@ -162,7 +167,7 @@ static int set_warp_mode(int val, void *param)
 {
     warp_enabled = val ? 1 : 0;
 
-    sound_set_warp_mode(warp_enabled);
+    sound_set_warp_mode(warp_enabled || catch_up_enabled);
     vsync_suspend_speed_eval();
     
     if (warp_enabled) {
@@ -314,6 +319,24 @@ void vsync_suspend_speed_eval(void)
     speed_eval_suspended = 1;
 }
 
+/* Emulate the following frames as fast as possible, without sound and
+   without drawing them, until called again with 0.  */
+void vsync_set_catch_up(int enable)
+{
+    enable = enable ? 1 : 0;
+    if (enable == catch_up_enabled) {
+        return;
+    }
+    catch_up_enabled = enable;
+
+    sound_set_warp_mode(warp_enabled || catch_up_enabled);
+
+    /* Not vsync_suspend_speed_eval(), which would tell the remote host that
+       the emulation has been suspended.  */
+    speed_eval_suspended = 1;
+    update_thread_priority = 1;
+}
+
 void vsync_reset_hook(void)
 {
     execute_vsync_callbacks();    
@@ -500,7 +523,7 @@ void vsync_do_end_of_line(void)
         joystick();
                 
         /* Do we need to slow down the emulation here or can we rely on the audio device? */
-        if (tick_based_sync_timing && !warp_enabled) {
+        if (tick_based_sync_timing && !warp_enabled && !catch_up_enabled) {
             
             /* add the emulated clock cycles since last sync. */
             sync_clk_delta = maincpu_clk - last_sync_clk;
@@ -530,7 +553,7 @@ void vsync_do_end_of_line(void)
         update_thread_priority = 0;
 
 #if defined(MACOSX_SUPPORT)
-        vice_macos_set_vice_thread_priority(warp_enabled);
+        vice_macos_set_vice_thread_priority(warp_enabled || catch_up_enabled);
 #elif defined(__linux__)
         /* TODO: Linux thread prio stuff, need root or some 'capability' though */
 #else
@@ -598,7 +621,12 @@ int vsync_do_vsync(struct video_canvas_s *c, int been_skipped)
      * It's ugly enough for dqh to weep but makes warp faster.
      */
     
-    if (warp_enabled) {
+    if (catch_up_enabled) {
+        skip_next_frame = 1;
+        skipped_redraw_count++;
+    } else if (warp_enabled && !perfstats_enabled) {
+        /* Benchmarks draw every frame so their results don't depend on
+           the speed of the host.  */
         if (now < warp_next_render_tick) {
             skip_next_frame = 1;
             skipped_redraw_count++;
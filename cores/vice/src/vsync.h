@@ -51,6 +51,7 @@ extern double vsync_get_refresh_frequency(void);
 extern void vsync_do_end_of_line(void);
 extern int vsync_do_vsync(struct video_canvas_s *c, int been_skipped);
 extern int vsync_disable_timer(void);
+extern void vsync_set_catch_up(int enable);
 extern void vsync_on_vsync_do(vsync_callback_func_t callback_func, void *callback_param);
 
 #endif
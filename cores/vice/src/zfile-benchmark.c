@@ -0,0 +1,302 @@
+/*
+ * zfile-benchmark.c - Measure the cost of opening compressed images.
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/* Usage: zfile-benchmark [opens] [directory]
+
+   Writes a D64 sized image (half of it empty sectors, like most disks) to
+   the directory (default: the current one) as .d64.gz, .zip and, with
+   libbz2, .d64.bz2, and reads each of them completely through zfile as
+   the disk image code would.  For each format it reports the time per open
+   with the data uncompressed in memory and with the temporary file (and
+   unzip or bzip2) path, and checks the data read against the image.  Where
+   archdep_spawn() is not available the second path gets the .zip and .bz2
+   files as they are, which shows as "BAD DATA".  */
+
+#include "vice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LIBBZ2
+#include <bzlib.h>
+#endif
+
+#include "archdep.h"
+#include "lib.h"
+#include "log.h"
+#include "types.h"
+#include "util.h"
+#include "zfile.h"
+
+#define BENCH_IMAGE_SIZE    174848
+#define BENCH_IMAGE_NAME    "zfile-benchmark.d64"
+
+static uint8_t bench_image[BENCH_IMAGE_SIZE];
+static uint8_t bench_read[BENCH_IMAGE_SIZE + 1];
+
+/* Stubs for lib.c and zfile.c.  */
+void archdep_vice_exit(int excode)
+{
+    exit(excode);
+}
+
+log_t log_open(const char *id)
+{
+    return 0;
+}
+
+int log_error(log_t log, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    vfprintf(stderr, format, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    return 0;
+}
+
+int log_debug(const char *format, ...)
+{
+    return 0;
+}
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Sectors of text-like data followed by empty ones.  */
+static void bench_make_image(void)
+{
+    unsigned int seed = 1;
+    size_t i;
+
+    for (i = 0; i < BENCH_IMAGE_SIZE / 2; i++) {
+        seed = seed * 1103515245 + 12345;
+        bench_image[i] = (uint8_t)(0x20 + ((seed >> 16) % 48));
+    }
+}
+
+#ifdef HAVE_ZLIB
+static int bench_write_gzip(const char *name)
+{
+    gzFile fd = gzopen(name, "wb9");
+
+    if (fd == NULL) {
+        return -1;
+    }
+    gzwrite(fd, bench_image, BENCH_IMAGE_SIZE);
+    return gzclose(fd) == Z_OK ? 0 : -1;
+}
+
+static void bench_put16(uint8_t *p, unsigned int value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void bench_put32(uint8_t *p, uint32_t value)
+{
+    bench_put16(p, value & 0xffff);
+    bench_put16(p + 2, value >> 16);
+}
+
+/* Write a ZIP file holding the image as one deflated member.  */
+static int bench_write_zip(const char *name)
+{
+    static const char member[] = BENCH_IMAGE_NAME;
+    size_t member_len = sizeof(member) - 1;
+    uLong csize = compressBound(BENCH_IMAGE_SIZE);
+    uint8_t *data = lib_malloc(csize);
+    uint8_t local[30], central[46], end[22];
+    uint32_t crc = (uint32_t)crc32(crc32(0L, Z_NULL, 0), bench_image, BENCH_IMAGE_SIZE);
+    z_stream stream;
+    FILE *fd;
+
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, 9, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    stream.next_in = bench_image;
+    stream.avail_in = BENCH_IMAGE_SIZE;
+    stream.next_out = data;
+    stream.avail_out = (uInt)csize;
+    deflate(&stream, Z_FINISH);
+    csize = stream.total_out;
+    deflateEnd(&stream);
+
+    memset(local, 0, sizeof(local));
+    bench_put32(local, 0x04034b50);
+    bench_put16(local + 4, 20);
+    bench_put16(local + 8, 8);
+    bench_put32(local + 14, crc);
+    bench_put32(local + 18, (uint32_t)csize);
+    bench_put32(local + 22, BENCH_IMAGE_SIZE);
+    bench_put16(local + 26, (unsigned int)member_len);
+
+    memset(central, 0, sizeof(central));
+    bench_put32(central, 0x02014b50);
+    bench_put16(central + 4, 20);
+    memcpy(central + 6, local + 4, 26);
+    bench_put32(central + 42, 0);
+
+    memset(end, 0, sizeof(end));
+    bench_put32(end, 0x06054b50);
+    bench_put16(end + 8, 1);
+    bench_put16(end + 10, 1);
+    bench_put32(end + 12, (uint32_t)(sizeof(central) + member_len));
+    bench_put32(end + 16, (uint32_t)(sizeof(local) + member_len + csize));
+
+    fd = fopen(name, MODE_WRITE);
+    if (fd == NULL) {
+        lib_free(data);
+        return -1;
+    }
+    fwrite(local, 1, sizeof(local), fd);
+    fwrite(member, 1, member_len, fd);
+    fwrite(data, 1, csize, fd);
+    fwrite(central, 1, sizeof(central), fd);
+    fwrite(member, 1, member_len, fd);
+    fwrite(end, 1, sizeof(end), fd);
+    lib_free(data);
+    return fclose(fd) == 0 ? 0 : -1;
+}
+#endif
+
+#ifdef HAVE_LIBBZ2
+static int bench_write_bzip(const char *name)
+{
+    FILE *fd = fopen(name, MODE_WRITE);
+    BZFILE *bz;
+    int error;
+
+    if (fd == NULL) {
+        return -1;
+    }
+    bz = BZ2_bzWriteOpen(&error, fd, 9, 0, 0);
+    BZ2_bzWrite(&error, bz, bench_image, BENCH_IMAGE_SIZE);
+    BZ2_bzWriteClose(&error, bz, 0, NULL, NULL);
+    fclose(fd);
+    return error == BZ_OK ? 0 : -1;
+}
+#endif
+
+/* Open, read and close `name' `opens' times.  Return the time per open in
+   ms, -1 if the file cannot be opened or -2 if the data read is wrong.  */
+static double bench_open(const char *name, int opens)
+{
+    double start = bench_now();
+    int i;
+
+    for (i = 0; i < opens; i++) {
+        FILE *fd = zfile_fopen(name, MODE_READ);
+        size_t len;
+
+        if (fd == NULL) {
+            return -1.0;
+        }
+        len = fread(bench_read, 1, sizeof(bench_read), fd);
+        zfile_fclose(fd);
+        if (len != BENCH_IMAGE_SIZE
+            || memcmp(bench_read, bench_image, BENCH_IMAGE_SIZE) != 0) {
+            return -2.0;
+        }
+    }
+    return (bench_now() - start) * 1000.0 / opens;
+}
+
+static const char *bench_result(double ms)
+{
+    static char buf[2][16];
+    static int i;
+
+    i ^= 1;
+    if (ms == -1.0) {
+        return "no open";
+    } else if (ms < 0.0) {
+        return "BAD DATA";
+    }
+    sprintf(buf[i], "%.3f", ms);
+    return buf[i];
+}
+
+static void bench_format(const char *directory, const char *extension,
+                         int (*write_func)(const char *name), int opens)
+{
+    char *name = util_concat(directory, "/" BENCH_IMAGE_NAME, extension, NULL);
+    double memory, tmpfile;
+
+    if (write_func(name) < 0) {
+        printf("%-8s cannot write %s\n", extension, name);
+        lib_free(name);
+        return;
+    }
+
+    zfile_set_in_memory(1);
+    memory = bench_open(name, opens);
+    zfile_set_in_memory(0);
+    tmpfile = bench_open(name, opens);
+
+    printf("%-8s %10s %10s", extension, bench_result(memory), bench_result(tmpfile));
+    if (memory > 0.0 && tmpfile > 0.0) {
+        printf(" %8.1fx", tmpfile / memory);
+    }
+    printf("\n");
+
+    remove(name);
+    lib_free(name);
+}
+
+int main(int argc, char **argv)
+{
+    int opens = argc > 1 ? atoi(argv[1]) : 50;
+    const char *directory = argc > 2 ? argv[2] : ".";
+
+    if (opens < 1) {
+        fprintf(stderr, "Usage: %s [opens] [directory]\n", argv[0]);
+        return 1;
+    }
+
+    bench_make_image();
+
+    printf("%d opens of a %d byte image\n", opens, BENCH_IMAGE_SIZE);
+    printf("%-8s %10s %10s %9s\n", "format", "memory ms", "tmpfile ms", "speedup");
+#ifdef HAVE_ZLIB
+    bench_format(directory, ".gz", bench_write_gzip, opens);
+    bench_format(directory, ".zip", bench_write_zip, opens);
+#endif
+#ifdef HAVE_LIBBZ2
+    bench_format(directory, ".bz2", bench_write_bzip, opens);
+#endif
+
+    zfile_shutdown();
+    return 0;
+}
@@ -46,6 +46,9 @@
 #ifdef HAVE_ZLIB
 #include <zlib.h>
 #endif
+#ifdef HAVE_LIBBZ2
+#include <bzlib.h>
+#endif
 
 #ifdef HAVE_STRINGS_H
 #include <strings.h>
@@ -93,6 +96,7 @@ struct zfile_s {
     struct zfile_s *prev, *next; /* Link to the previous and next nodes.  */
     zfile_action_t action;       /* action on close */
     char *request_string;        /* ui string for action=ZFILE_REQUEST */
+    uint8_t *buffer;             /* Memory read by an in-memory stream.  */
 };
 typedef struct zfile_s zfile_t;
 
@@ -136,6 +140,7 @@ static void zfile_list_destroy(void)
 
         lib_free(p->orig_name);
         lib_free(p->tmp_name);
+        lib_free(p->buffer);
         next = p->next;
         lib_free(p);
         p = next;
@@ -162,7 +167,8 @@ static void zfile_list_add(const char *tmp_name,
                            const char *orig_name,
                            enum compression_type type,
                            int write_mode,
-                           FILE *stream, FILE *fd)
+                           FILE *stream, FILE *fd,
+                           uint8_t *buffer)
 {
     zfile_t *new_zfile = lib_malloc(sizeof(zfile_t));
 
@@ -177,6 +183,7 @@ static void zfile_list_add(const char *tmp_name,
     new_zfile->type = type;
     new_zfile->action = ZFILE_KEEP;
     new_zfile->request_string = NULL;
+    new_zfile->buffer = buffer;
     new_zfile->next = zfile_list;
     new_zfile->prev = NULL;
     if (zfile_list != NULL) {
@@ -814,6 +821,397 @@ static enum compression_type try_uncompress(const char *name,
 
 /* ------------------------------------------------------------------------- */
 
+/* In-memory uncompression.
+
+   Files that are only read and are compressed with ZIP, gzip or bzip2 are
+   uncompressed with zlib (or libbz2) into a buffer, and `zfile_fopen()'
+   returns a stream reading that buffer.  This needs neither a temporary
+   file nor an external program.  Anything these readers cannot handle,
+   like other archives or unusual ZIP compression methods, is left to
+   `try_uncompress()'.  */
+
+#if defined(HAVE_FMEMOPEN) && (defined(HAVE_ZLIB) || defined(HAVE_LIBBZ2))
+#define ZFILE_IN_MEMORY
+
+static int zfile_in_memory = 1;
+
+/* Growing buffer for the uncompressed data.  */
+typedef struct zbuffer_s {
+    uint8_t *data;
+    size_t size;
+    size_t allocated;
+} zbuffer_t;
+
+/* Make room for `len' more bytes in `buf' and return where they go.  */
+static uint8_t *zbuffer_reserve(zbuffer_t *buf, size_t len)
+{
+    if (buf->size + len > buf->allocated) {
+        size_t allocated = buf->allocated ? buf->allocated : 0x10000;
+
+        while (allocated < buf->size + len) {
+            allocated *= 2;
+        }
+        buf->data = lib_realloc(buf->data, allocated);
+        buf->allocated = allocated;
+    }
+    return buf->data + buf->size;
+}
+
+#ifdef HAVE_ZLIB
+/* Uncompress the gzip file `name' into `buf'.  Return non-zero on success.  */
+static int uncompress_gzip_to_memory(const char *name, zbuffer_t *buf)
+{
+    FILE *fd;
+    gzFile fdsrc;
+    uint8_t trailer[4];
+    int len;
+
+    if (!file_is_gzip(name)) {
+        return 0;
+    }
+
+    /* The last four bytes of a gzip file hold the uncompressed size, which
+       saves growing the buffer.  It is only a hint: it does not fit files
+       of several members, or files that are not gzipped at all.  */
+    fd = fopen(name, MODE_READ);
+    if (fd == NULL) {
+        return 0;
+    }
+    if (fseek(fd, -4, SEEK_END) == 0 && fread(trailer, 1, 4, fd) == 4) {
+        uint32_t size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16)
+                        | ((uint32_t)trailer[3] << 24);
+
+        if (size < 0x4000000) {
+            zbuffer_reserve(buf, size + 1);
+        }
+    }
+    fclose(fd);
+
+    fdsrc = gzopen(name, MODE_READ);
+    if (fdsrc == NULL) {
+        return 0;
+    }
+
+    do {
+        zbuffer_reserve(buf, 1);
+        len = gzread(fdsrc, buf->data + buf->size,
+                     (unsigned int)(buf->allocated - buf->size));
+        if (len > 0) {
+            buf->size += (size_t)len;
+        }
+    } while (len > 0);
+
+    gzclose(fdsrc);
+    return len == 0;
+}
+
+#define ZIP_LOCAL_SIGNATURE     0x04034b50
+#define ZIP_CENTRAL_SIGNATURE   0x02014b50
+#define ZIP_END_SIGNATURE       0x06054b50
+
+#define ZIP_LOCAL_SIZE          30
+#define ZIP_CENTRAL_SIZE        46
+#define ZIP_END_SIZE            22
+
+#define ZIP_METHOD_STORED       0
+#define ZIP_METHOD_DEFLATED     8
+
+static unsigned int zip_get16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t zip_get32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Append the member of `zip' whose central directory entry is at `entry'
+   to `buf'.  Return non-zero on success.  */
+static int zip_extract(const uint8_t *zip, size_t zip_size,
+                       const uint8_t *entry, zbuffer_t *buf)
+{
+    unsigned int method = zip_get16(entry + 10);
+    uint32_t crc = zip_get32(entry + 16);
+    size_t csize = zip_get32(entry + 20);
+    size_t usize = zip_get32(entry + 24);
+    size_t offset = zip_get32(entry + 42);
+    const uint8_t *data;
+    uint8_t *dest;
+
+    /* Encrypted members are left to unzip, which can ask for a password.  */
+    if (zip_get16(entry + 8) & 1) {
+        return 0;
+    }
+
+    if (zip_size < ZIP_LOCAL_SIZE || offset > zip_size - ZIP_LOCAL_SIZE
+        || zip_get32(zip + offset) != ZIP_LOCAL_SIGNATURE) {
+        return 0;
+    }
+    offset += ZIP_LOCAL_SIZE + zip_get16(zip + offset + 26)
+              + zip_get16(zip + offset + 28);
+    if (offset > zip_size || csize > zip_size - offset) {
+        return 0;
+    }
+    data = zip + offset;
+
+    /* Deflate cannot compress better than about 1:1032, so anything
+       beyond that is a broken entry.  */
+    if ((method == ZIP_METHOD_STORED && csize != usize)
+        || usize / 1032 > csize) {
+        return 0;
+    }
+    dest = zbuffer_reserve(buf, usize);
+
+    if (method == ZIP_METHOD_STORED) {
+        memcpy(dest, data, usize);
+    } else if (method == ZIP_METHOD_DEFLATED) {
+        z_stream stream;
+        int status;
+
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            return 0;
+        }
+        stream.next_in = (Bytef *)data;
+        stream.avail_in = (uInt)csize;
+        stream.next_out = dest;
+        stream.avail_out = (uInt)usize;
+        status = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+        if (status != Z_STREAM_END || stream.total_out != usize) {
+            return 0;
+        }
+    } else {
+        ZDEBUG(("zip_extract: unsupported method %u.", method));
+        return 0;
+    }
+
+    if (crc32(crc32(0L, Z_NULL, 0), dest, (uInt)usize) != crc) {
+        log_error(zlog, "CRC error in ZIP member.");
+        return 0;
+    }
+    buf->size += usize;
+    return 1;
+}
+
+/* Return the central directory entry at `offset' of `zip', which ends at
+   `end', or NULL if it is not complete.  */
+static const uint8_t *zip_entry(const uint8_t *zip, size_t offset, size_t end)
+{
+    if (offset > end || end - offset < ZIP_CENTRAL_SIZE
+        || zip_get32(zip + offset) != ZIP_CENTRAL_SIGNATURE
+        || end - offset - ZIP_CENTRAL_SIZE < zip_get16(zip + offset + 28)) {
+        return NULL;
+    }
+    return zip + offset;
+}
+
+/* Return the offset of the central directory entry following `entry'.  */
+static size_t zip_next_entry(const uint8_t *zip, const uint8_t *entry)
+{
+    return (size_t)(entry - zip) + ZIP_CENTRAL_SIZE + zip_get16(entry + 28)
+           + zip_get16(entry + 30) + zip_get16(entry + 32);
+}
+
+/* Uncompress the first file with a proper extension from the ZIP file
+   `name' into `buf', like `try_uncompress_archive()' does with unzip.
+   Return non-zero on success.  */
+static int uncompress_zip_to_memory(const char *name, zbuffer_t *buf)
+{
+    FILE *fd;
+    uint8_t *zip;
+    const uint8_t *entry;
+    size_t zip_size, end, first, offset, entries, i, l;
+    char found[1024];
+    int zipcode;
+    int ok = 0;
+
+    fd = fopen(name, MODE_READ);
+    if (fd == NULL) {
+        return 0;
+    }
+    zip_size = util_file_length(fd);
+    if (zip_size < ZIP_END_SIZE) {
+        fclose(fd);
+        return 0;
+    }
+    zip = lib_malloc(zip_size);
+    if (fread(zip, 1, zip_size, fd) != zip_size) {
+        fclose(fd);
+        lib_free(zip);
+        return 0;
+    }
+    fclose(fd);
+
+    /* The end of central directory record is followed by a comment of up
+       to 64 kB.  */
+    end = zip_size - ZIP_END_SIZE;
+    while (zip_get32(zip + end) != ZIP_END_SIGNATURE) {
+        if (end == 0 || zip_size - end > ZIP_END_SIZE + 0xffff) {
+            ZDEBUG(("uncompress_zip_to_memory: no central directory."));
+            lib_free(zip);
+            return 0;
+        }
+        end--;
+    }
+    entries = zip_get16(zip + end + 10);
+    first = zip_get32(zip + end + 16);
+
+    /* Search for the first recognizeable file.  */
+    found[0] = 0;
+    offset = first;
+    for (i = 0; i < entries; i++) {
+        entry = zip_entry(zip, offset, end);
+        if (entry == NULL) {
+            break;
+        }
+        l = zip_get16(entry + 28);
+        if (l < sizeof(found)) {
+            memcpy(found, entry + ZIP_CENTRAL_SIZE, l);
+            found[l] = 0;
+            if (is_valid_extension(found, l, 0)) {
+                ZDEBUG(("uncompress_zip_to_memory: found `%s'.", found));
+                break;
+            }
+            found[0] = 0;
+        }
+        offset = zip_next_entry(zip, entry);
+    }
+
+    if (found[0] == 0) {
+        ZDEBUG(("uncompress_zip_to_memory: no valid file found."));
+        lib_free(zip);
+        return 0;
+    }
+
+    /* Extract the file; a zipcode set goes into one file, in archive
+       order.  */
+    zipcode = is_zipcode_name(found);
+    offset = first;
+    for (i = 0; i < entries; i++) {
+        const char *member;
+
+        entry = zip_entry(zip, offset, end);
+        if (entry == NULL) {
+            break;
+        }
+        l = zip_get16(entry + 28);
+        member = (const char *)entry + ZIP_CENTRAL_SIZE;
+        if (l == strlen(found)
+            && (zipcode ? (member[0] >= '1' && member[0] <= '4'
+                           && memcmp(member + 1, found + 1, l - 1) == 0)
+                        : memcmp(member, found, l) == 0)) {
+            ok = zip_extract(zip, zip_size, entry, buf);
+            if (!ok || !zipcode) {
+                break;
+            }
+        }
+        offset = zip_next_entry(zip, entry);
+    }
+
+    lib_free(zip);
+    return ok;
+}
+#endif
+
+#ifdef HAVE_LIBBZ2
+/* Uncompress the bzip2 file `name' into `buf'.  Return non-zero on
+   success.  */
+static int uncompress_bzip_to_memory(const char *name, zbuffer_t *buf)
+{
+    FILE *fd;
+    BZFILE *fdsrc;
+    size_t l = strlen(name);
+    int error, len;
+
+    if (l < 5 || strcasecmp(name + l - 4, ".bz2") != 0) {
+        return 0;
+    }
+
+    fd = fopen(name, MODE_READ);
+    if (fd == NULL) {
+        return 0;
+    }
+    fdsrc = BZ2_bzReadOpen(&error, fd, 0, 0, NULL, 0);
+    if (error != BZ_OK) {
+        fclose(fd);
+        return 0;
+    }
+
+    do {
+        zbuffer_reserve(buf, 1);
+        len = BZ2_bzRead(&error, fdsrc, buf->data + buf->size,
+                         (int)(buf->allocated - buf->size));
+        if (error == BZ_OK || error == BZ_STREAM_END) {
+            buf->size += (size_t)len;
+        }
+    } while (error == BZ_OK);
+
+    BZ2_bzReadClose(&len, fdsrc);
+    fclose(fd);
+    return error == BZ_STREAM_END;
+}
+#endif
+
+/* Try to uncompress file `name' into memory.  If this succeeds, return the
+   type of compression and the data in `buf'; otherwise return `COMPR_NONE'
+   and leave the file to `try_uncompress()'.  */
+static enum compression_type try_uncompress_to_memory(const char *name,
+                                                      zbuffer_t *buf)
+{
+    enum compression_type type = COMPR_NONE;
+    size_t l = strlen(name);
+    size_t len;
+    int i;
+
+    for (i = 0; valid_archives[i].program; i++) {
+        len = strlen(valid_archives[i].extension);
+        if (l > len
+            && strcasecmp(name + l - len, valid_archives[i].extension) == 0) {
+            break;
+        }
+    }
+
+    if (valid_archives[i].program != NULL) {
+        /* Only ZIP files are read here; .tar.gz must not be taken as gzip.  */
+#ifdef HAVE_ZLIB
+        if (strcmp(valid_archives[i].program, "unzip") == 0
+            && uncompress_zip_to_memory(name, buf)) {
+            type = COMPR_ARCHIVE;
+        }
+#endif
+    }
+#ifdef HAVE_ZLIB
+    else if (uncompress_gzip_to_memory(name, buf)) {
+        type = COMPR_GZIP;
+    }
+#endif
+#ifdef HAVE_LIBBZ2
+    else if (uncompress_bzip_to_memory(name, buf)) {
+        type = COMPR_BZIP;
+    }
+#endif
+
+    if (type == COMPR_NONE) {
+        lib_free(buf->data);
+        buf->data = NULL;
+        buf->size = 0;
+        buf->allocated = 0;
+    }
+    return type;
+}
+#endif
+
+void zfile_set_in_memory(int enable)
+{
+#ifdef ZFILE_IN_MEMORY
+    zfile_in_memory = enable;
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* Compression.  */
 
 /* Compress `src' into `dest' using gzip.  */
@@ -1047,13 +1445,30 @@ FILE *zfile_fopen(const char *name, const char *mode)
         return NULL;
     }
 
+#ifdef ZFILE_IN_MEMORY
+    /* Files that are only read do not need a temporary file.  */
+    if (!write_mode && zfile_in_memory) {
+        zbuffer_t buf = { NULL, 0, 0 };
+
+        type = try_uncompress_to_memory(name, &buf);
+        if (type != COMPR_NONE) {
+            stream = fmemopen(buf.data, buf.size, mode);
+            if (stream != NULL) {
+                zfile_list_add(NULL, name, type, 0, stream, NULL, buf.data);
+                return stream;
+            }
+            lib_free(buf.data);
+        }
+    }
+#endif
+
     type = try_uncompress(name, &tmp_name, write_mode);
     if (type == COMPR_NONE) {
         stream = fopen(name, mode);
         if (stream == NULL) {
             return NULL;
         }
-        zfile_list_add(NULL, name, type, write_mode, stream, NULL);
+        zfile_list_add(NULL, name, type, write_mode, stream, NULL, NULL);
         return stream;
     } else if (*tmp_name == '\0') {
         errno = EACCES;
@@ -1066,7 +1481,7 @@ FILE *zfile_fopen(const char *name, const char *mode)
         return NULL;
     }
 
-    zfile_list_add(tmp_name, name, type, write_mode, stream, NULL);
+    zfile_list_add(tmp_name, name, type, write_mode, stream, NULL, NULL);
 
     /* now we don't need the archdep_tmpnam allocation any more */
     lib_free(tmp_name);
@@ -1142,6 +1557,9 @@ static int handle_close(zfile_t *ptr)
     if (ptr->request_string) {
         lib_free(ptr->request_string);
     }
+    if (ptr->buffer) {
+        lib_free(ptr->buffer);
+    }
 
     lib_free(ptr);
 
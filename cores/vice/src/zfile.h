@@ -42,6 +42,10 @@ extern int zfile_fclose(FILE *stream);
 
 extern void zfile_shutdown(void);
 
+/* Uncompress files that are only read into memory (the default) or into
+   temporary files.  */
+extern void zfile_set_in_memory(int enable);
+
 extern int zfile_close_action(const char *filename, zfile_action_t action,
                               const char *request_string);
 